@@ -30,6 +30,7 @@
 #ifndef _OVAL_PROBE_SESSION
 #define _OVAL_PROBE_SESSION
 
+#include <pthread.h>
 #include "public/oval_probe_session.h"
 #include "_oval_probe_handler.h"
 #include "oval_probe_ext.h"
@@ -45,6 +46,7 @@ struct oval_probe_session {
         struct oval_syschar_model *sys_model; /**< system characteristics model */
         char         *dir;  /**< probe session directory */
         uint32_t      flg;  /**< probe session flags */
+        pthread_mutex_t lock; /**< serializes the queries of parallel evaluation jobs (recursive) */
 };
 
 #endif /* _OVAL_PROBE_SESSION */
@@ -33,6 +33,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "oval_adt.h"
 #include "oval_collection_impl.h"
@@ -43,17 +44,24 @@
 /* Variable definitions
  * */
 
-typedef struct _oval_collection_item_frame {
-	struct _oval_collection_item_frame *next;
-	void *item;
-} _oval_collection_item_frame_t;
+/*
+ * Both collections and iterators keep their items in a growable array.
+ * An iterator is a snapshot of the collection it was created from, it hands
+ * out the items from the end of its array: a collection is copied in reverse,
+ * items added by oval_collection_iterator_add() come out last added first.
+ */
+#define OVAL_COLLECTION_MIN_CAPACITY 4
 
 typedef struct oval_collection {
-	struct _oval_collection_item_frame *item_collection_frame;
+	void **items;
+	size_t count;
+	size_t capacity;
 } oval_collection_t;
 
 typedef struct oval_iterator {
-	struct _oval_collection_item_frame *item_iterator_frame;
+	void **items;
+	size_t count;		///< number of items remaining
+	size_t capacity;
 } oval_iterator_t;
 
 static bool debug = true;
@@ -64,13 +72,35 @@ static int iterator_count;
  * */
 /***************************************************************************/
 
+static int _oval_collection_reserve(void ***items, size_t *capacity, size_t count)
+{
+	void **grown;
+	size_t new_capacity;
+
+	if (count <= *capacity)
+		return 0;
+
+	new_capacity = *capacity ? *capacity : OVAL_COLLECTION_MIN_CAPACITY;
+	while (new_capacity < count)
+		new_capacity *= 2;
+	grown = oscap_realloc(*items, new_capacity * sizeof(void *));
+	if (grown == NULL)
+		return -1;
+
+	*items = grown;
+	*capacity = new_capacity;
+	return 0;
+}
+
 struct oval_collection *oval_collection_new()
 {
 	struct oval_collection *collection = (struct oval_collection *)oscap_alloc(sizeof(oval_collection_t));
 	if (collection == NULL)
 		return NULL;
 
-	collection->item_collection_frame = NULL;
+	collection->items = NULL;
+	collection->count = 0;
+	collection->capacity = 0;
 	return collection;
 }
 
@@ -82,19 +112,16 @@ void oval_collection_free(struct oval_collection *collection)
 void oval_collection_free_items(struct oval_collection *collection, oscap_destruct_func free_func)
 {
 	if (collection) {
-		struct _oval_collection_item_frame *frame = collection->item_collection_frame;
-		while (frame != NULL) {
-			if (free_func != NULL) {
-				void *item = frame->item;
+		if (free_func != NULL) {
+			/* the last added item goes first, as it always did */
+			size_t i = collection->count;
+			while (i > 0) {
+				void *item = collection->items[--i];
 				if (item)
 					(*free_func) (item);
-				frame->item = NULL;
 			}
-			struct _oval_collection_item_frame *temp = frame;
-			frame = frame->next;
-			temp->next = NULL;
-			oscap_free(temp);
 		}
+		oscap_free(collection->items);
 		oscap_free(collection);
 	}
 }
@@ -102,57 +129,83 @@ void oval_collection_free_items(struct oval_collection *collection, oscap_destru
 int oval_collection_is_empty(struct oval_collection *collection)
 {
 	__attribute__nonnull__(collection);
-	return collection->item_collection_frame == NULL;
+	return collection->count == 0;
+}
+
+size_t oval_collection_size(struct oval_collection *collection)
+{
+	__attribute__nonnull__(collection);
+	return collection->count;
 }
 
 void oval_collection_add(struct oval_collection *collection, void *item)
 {
 	__attribute__nonnull__(collection);
 
-	struct _oval_collection_item_frame *next = oscap_alloc(sizeof(_oval_collection_item_frame_t));
-	if (next == NULL)
+	if (_oval_collection_reserve(&collection->items, &collection->capacity, collection->count + 1) != 0)
 		return;
 
-	next->next = collection->item_collection_frame;
-	collection->item_collection_frame = next;
-	next->item = item;
+	collection->items[collection->count++] = item;
 }
 
-struct oval_iterator *oval_collection_iterator(struct oval_collection *collection)
+static struct oval_iterator *_oval_iterator_new(size_t capacity)
 {
-	__attribute__nonnull__(collection);
-
 	struct oval_iterator *iterator = (struct oval_iterator *)oscap_alloc(sizeof(oval_iterator_t));
 	if (iterator == NULL)
 		return NULL;
 
-	if ((iterator_count++) < 0) {
+	/* iterators are created by parallel evaluation jobs too */
+	if (__sync_fetch_and_add(&iterator_count, 1) < 0) {
 		_debugStack[iterator_count - 1] = iterator;
 		dW("iterator_count: %d.", iterator_count);
 	}
 
-	iterator->item_iterator_frame = NULL;
-	struct _oval_collection_item_frame *collection_frame = collection->item_collection_frame;
+	iterator->items = NULL;
+	iterator->count = 0;
+	iterator->capacity = 0;
+	if (_oval_collection_reserve(&iterator->items, &iterator->capacity, capacity) != 0) {
+		oscap_free(iterator);
+		return NULL;
+	}
+	return iterator;
+}
 
-	while (collection_frame != NULL) {
-		struct _oval_collection_item_frame *iterator_frame =
-		    (struct _oval_collection_item_frame *)oscap_alloc(sizeof(_oval_collection_item_frame_t));
-		if (iterator_frame == NULL)
-			return NULL;
+struct oval_iterator *oval_collection_iterator(struct oval_collection *collection)
+{
+	__attribute__nonnull__(collection);
 
-		iterator_frame->next = iterator->item_iterator_frame;
-		iterator_frame->item = collection_frame->item;
-		iterator->item_iterator_frame = iterator_frame;
-		collection_frame = collection_frame->next;
-	}
+	struct oval_iterator *iterator = _oval_iterator_new(collection->count);
+	if (iterator == NULL)
+		return NULL;
+
+	size_t i, n = collection->count;
+	for (i = 0; i < n; i++)
+		iterator->items[i] = collection->items[n - 1 - i];
+	iterator->count = n;
 	return iterator;
 }
 
+size_t oval_collection_to_array(struct oval_collection *collection, void ***array, size_t *size)
+{
+	__attribute__nonnull__(collection);
+
+	size_t count = collection->count;
+
+	if (count > *size) {
+		*array = oscap_realloc(*array, count * sizeof(void *));
+		*size = count;
+	}
+	if (count > 0)
+		memcpy(*array, collection->items, count * sizeof(void *));
+
+	return count;
+}
+
 bool oval_collection_iterator_has_more(struct oval_iterator * iterator)
 {
 	__attribute__nonnull__(iterator);
 
-	return iterator->item_iterator_frame != NULL;
+	return iterator->count > 0;
 }
 
 int oval_collection_iterator_remaining(struct oval_iterator *iterator)
@@ -160,83 +213,48 @@ int oval_collection_iterator_remaining(struct oval_iterator *iterator)
 
 	__attribute__nonnull__(iterator);
 
-	int remaining;
-	struct _oval_collection_item_frame *next = iterator->item_iterator_frame;
-
-	for (remaining = 0; next; remaining++)
-		next = next->next;
-
-	return remaining;
+	return iterator->count;
 }
 
 void *oval_collection_iterator_next(struct oval_iterator *iterator)
 {
 	__attribute__nonnull__(iterator);
 
-	struct _oval_collection_item_frame *oc_next = iterator->item_iterator_frame;
-	void *next;
-
-	if (oc_next == NULL) {
-		next = NULL;
-	} else {
-		next = oc_next->item;
-		iterator->item_iterator_frame = oc_next->next;
-		oc_next->item = NULL;
-		oc_next->next = NULL;
-		oscap_free(oc_next);
-	}
-	return next;
+	if (iterator->count == 0)
+		return NULL;
+
+	return iterator->items[--iterator->count];
 }
 
 void oval_collection_iterator_free(struct oval_iterator *iterator)
 {
 	if (iterator) {		//NOOP if iterator is NULL
-		if ((--iterator_count) < 0) {
+		if (__sync_sub_and_fetch(&iterator_count, 1) < 0) {
 			dW("iterator_count: %d.", iterator_count);
 			if (iterator != _debugStack[iterator_count]) {
 				debug = false;
 			}
 		}
 
-		while (iterator->item_iterator_frame) {
-			struct _oval_collection_item_frame *oc_this;
-			oc_this = iterator->item_iterator_frame;
-			iterator->item_iterator_frame = oc_this->next;
-			oc_this->item = NULL;
-			oc_this->next = NULL;
-			oscap_free(oc_this);
-		}
-		iterator->item_iterator_frame = NULL;
+		oscap_free(iterator->items);
 		oscap_free(iterator);
 	}
 }
 
 struct oval_iterator *oval_collection_iterator_new()
 {
-	struct oval_iterator *iterator = (struct oval_iterator *)oscap_alloc(sizeof(oval_iterator_t));
-	if (iterator == NULL)
-		return NULL;
-
-	if ((iterator_count++) < 0) {
-		_debugStack[iterator_count - 1] = iterator;
-		dW("iterator_count: %d.", iterator_count);
-	}
-	iterator->item_iterator_frame = NULL;
-	return iterator;
+	return _oval_iterator_new(0);
 }
 
 void oval_collection_iterator_add(struct oval_iterator *iterator, void *item)
 {
 	__attribute__nonnull__(iterator);
 
-	struct _oval_collection_item_frame *newframe =
-	    (struct _oval_collection_item_frame *)oscap_alloc(sizeof(_oval_collection_item_frame_t));
-	if (newframe == NULL)	/* We don't have any information that error occured ! */
+	/* We don't have any information that error occured ! */
+	if (_oval_collection_reserve(&iterator->items, &iterator->capacity, iterator->count + 1) != 0)
 		return;
 
-	newframe->next = iterator->item_iterator_frame;
-	newframe->item = item;
-	iterator->item_iterator_frame = newframe;
+	iterator->items[iterator->count++] = item;
 }
 
 bool oval_string_iterator_has_more(struct oval_string_iterator * iterator)
@@ -40,6 +40,7 @@ struct oval_collection *oval_collection_new(void);
 void oval_collection_free(struct oval_collection *);
 void oval_collection_free_items(struct oval_collection *, oscap_destruct_func);
 int oval_collection_is_empty(struct oval_collection *collection);
+size_t oval_collection_size(struct oval_collection *collection);
 void oval_collection_add(struct oval_collection *, void *);
 struct oval_iterator *oval_collection_iterator(struct oval_collection *);
 struct oval_iterator *oval_collection_iterator_new(void);
@@ -48,6 +49,13 @@ bool oval_collection_iterator_has_more(struct oval_iterator *);
 int oval_collection_iterator_remaining(struct oval_iterator *);
 void *oval_collection_iterator_next(struct oval_iterator *);
 void oval_collection_iterator_free(struct oval_iterator *);
+/**
+ * Store the items of a collection, in the order they are returned by an
+ * iterator, to an array reallocated as needed. Avoids the copy of the
+ * collection made by oval_collection_iterator().
+ * @return the number of items
+ */
+size_t oval_collection_to_array(struct oval_collection *, void ***array, size_t *size);
 
 struct oval_string_iterator;
 
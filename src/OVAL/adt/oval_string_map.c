@@ -34,183 +34,177 @@
 
 #include <string.h>
 #include <stdlib.h>
-#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include "oval_string_map_impl.h"
 #include "common/util.h"
 #include "common/debug_priv.h"
+#include <assume.h>
 
-#if defined(OVAL_STRINGMAP_OLD)
-struct _oval_string_map_entry_s;
-
-typedef struct _oval_string_map_entry {
-	struct _oval_string_map_entry *next;
-	char *key;
-	void *item;
-} _oval_string_map_entry_t;
+/*
+ * Open addressing hash table with linear probing. The hash of each key is
+ * stored in its slot so that probing compares strings only on a hash match.
+ * Entries are never removed, an empty slot has a NULL key.
+ *
+ * The keys and values are walked in the order of the keys (strcmp), as they
+ * were when the map was a red-black tree. The sorted index is built on first
+ * walk and dropped by the next insertion, which suits the maps here: they are
+ * filled first and walked afterwards.
+ */
 
-typedef struct oval_string_map {
-	struct _oval_string_map_entry *entries;
-} oval_string_map_t;
+#define OVAL_STRING_MAP_MIN_CAPACITY 8
 
-/* failed   - NULL
- * success  - oval_definition_model
- * */
-struct oval_string_map *oval_string_map_new()
+struct oval_string_map_entry {
+	char *key;
+	void *val;
+	uint32_t hash;
+};
+
+struct oval_string_map {
+	pthread_rwlock_t lock;
+	struct oval_string_map_entry *table;
+	size_t capacity;	///< number of slots, a power of two
+	size_t count;
+	struct oval_string_map_entry **order;	///< entries sorted by the key, NULL if not built
+};
+
+/* FNV-1a */
+static uint32_t oval_string_map_hash(const char *key)
 {
-	struct oval_string_map *map = (struct oval_string_map *)oscap_alloc(sizeof(oval_string_map_t));
-	if (map == NULL)
-		return NULL;
+	uint32_t h = 2166136261U;
 
-	map->entries = NULL;
-	return map;
+	for (; *key != '\0'; ++key) {
+		h ^= (unsigned char)*key;
+		h *= 16777619U;
+	}
+	return h;
 }
 
-static struct _oval_string_map_entry *_oval_string_map_entry_new(struct
-								 _oval_string_map_entry
-								 *after, struct
-								 _oval_string_map_entry
-								 *before)
+static struct oval_string_map_entry *oval_string_map_find(const struct oval_string_map *map, const char *key, uint32_t hash)
 {
-	struct _oval_string_map_entry *entry =
-	    (struct _oval_string_map_entry *)oscap_alloc(sizeof(_oval_string_map_entry_t));
-	if (entry == NULL)
+	size_t mask, i;
+
+	if (map->capacity == 0)
 		return NULL;
 
-	entry->next = before;
-	if (after != NULL)
-		after->next = entry;
-	return entry;
+	mask = map->capacity - 1;
+	for (i = hash & mask; map->table[i].key != NULL; i = (i + 1) & mask) {
+		if (map->table[i].hash == hash && strcmp(map->table[i].key, key) == 0)
+			return &map->table[i];
+	}
+	return NULL;
 }
 
-void oval_string_map_put(struct oval_string_map *map, const char *key, void *item)
+static void oval_string_map_insert(struct oval_string_map_entry *table, size_t capacity, char *key, void *val, uint32_t hash)
 {
-	__attribute__nonnull__(map);
-
-	char *temp = (char *)oscap_alloc((strlen(key) + 1) * sizeof(char) + 1);
-	char *usekey = strcpy(temp, key);
-
-	/* SEARCH FOR INSERTION POINT */
-	struct _oval_string_map_entry *insert_before = map->entries, *insert_after = NULL, *insertion;
-	if (insert_before == NULL) {
-		map->entries = insertion = _oval_string_map_entry_new(NULL, NULL);
-	} else {
-		int compare;
-		while (insert_before != NULL && ((compare = strcmp(usekey, insert_before->key)) < 0)) {
-			insert_after = insert_before;
-			insert_before = insert_after->next;
-		}
-		if (insert_before == NULL) {
-			insertion = _oval_string_map_entry_new(insert_after, NULL);
-		} else if (compare == 0) {
-			insertion = insert_before;
-		} else {
-			insertion = _oval_string_map_entry_new(insert_after, insert_before);
-			if (insert_after == NULL)
-				map->entries = insertion;
-		}
-	}
-	if (insertion == NULL) {
-		free(temp);
-		return;
-	}
+	size_t mask = capacity - 1, i;
 
-	insertion->key = usekey;
-	insertion->item = item;
+	for (i = hash & mask; table[i].key != NULL; i = (i + 1) & mask)
+		;
+	table[i].key = key;
+	table[i].val = val;
+	table[i].hash = hash;
 }
 
-void oval_string_map_put_string(struct oval_string_map *map, const char *key, const char *item)
+static int oval_string_map_grow(struct oval_string_map *map)
 {
-	char *temp = (char *)oscap_alloc((strlen(item) + 1) * sizeof(char) + 1);
-	char *useval = strcpy(temp, item);
-	oval_string_map_put(map, key, useval);
-}
+	struct oval_string_map_entry *table;
+	size_t capacity, i;
 
-struct oval_iterator *oval_string_map_keys(struct oval_string_map *map)
-{
-	__attribute__nonnull__(map);
+	capacity = map->capacity ? map->capacity * 2 : OVAL_STRING_MAP_MIN_CAPACITY;
+	table = oscap_calloc(capacity, sizeof(struct oval_string_map_entry));
+	if (table == NULL)
+		return -1;
 
-	struct oval_iterator *iterator = oval_collection_iterator_new();
-	struct _oval_string_map_entry *entry = map->entries;
-	while (entry != NULL) {
-		oval_collection_iterator_add(iterator, (void *)entry->key);
-		entry = entry->next;
+	for (i = 0; i < map->capacity; ++i) {
+		if (map->table[i].key != NULL)
+			oval_string_map_insert(table, capacity, map->table[i].key, map->table[i].val, map->table[i].hash);
 	}
-	return iterator;
+	oscap_free(map->table);
+	map->table = table;
+	map->capacity = capacity;
+	return 0;
 }
 
-struct oval_iterator *oval_string_map_values(struct oval_string_map *map)
+/* Returns 0 if the key was added, 1 if the map already has it, -1 on error. */
+static int oval_string_map_add(struct oval_string_map *map, char *key, void *val)
 {
-	__attribute__nonnull__(map);
-
-	struct oval_iterator *iterator = oval_collection_iterator_new();
-	struct _oval_string_map_entry *entry = map->entries;
-	int count;
-	for (count = 0; entry != NULL; count++) {
-		oval_collection_iterator_add(iterator, entry->item);
-		entry = entry->next;
+	uint32_t hash = oval_string_map_hash(key);
+	int ret = 1;
+
+	pthread_rwlock_wrlock(&map->lock);
+	if (oval_string_map_find(map, key, hash) == NULL) {
+		/* keep the load factor under 3/4 */
+		if (4 * (map->count + 1) > 3 * map->capacity && oval_string_map_grow(map) != 0) {
+			ret = -1;
+		} else {
+			oval_string_map_insert(map->table, map->capacity, key, val, hash);
+			++map->count;
+			oscap_free(map->order);
+			map->order = NULL;
+			ret = 0;
+		}
 	}
-	return iterator;
+	pthread_rwlock_unlock(&map->lock);
+	return ret;
 }
 
-void *oval_string_map_get_value(struct oval_string_map *map, const char *key)
+static int oval_string_map_entry_cmp(const void *a, const void *b)
 {
-	__attribute__nonnull__(map);
-
-	if (key == NULL)
-		return NULL;
-
-	struct _oval_string_map_entry *entry;
-	for (entry = map->entries; (entry != NULL) && (strcmp(key, entry->key) != 0); entry = entry->next) {
-	}
-	return (entry == NULL) ? NULL : entry->item;
+	return strcmp((*(struct oval_string_map_entry **)a)->key, (*(struct oval_string_map_entry **)b)->key);
 }
 
-void oval_string_map_free(struct oval_string_map *map, oscap_destruct_func free_func)
+/*
+ * Lock the map for walking it in the order of the keys. The index is built
+ * under the write lock, there's nothing to build for the next walks.
+ */
+static void oval_string_map_lock_ordered(struct oval_string_map *map)
 {
-	__attribute__nonnull__(map);
-
-	struct _oval_string_map_entry *entry = map->entries;
-	struct _oval_string_map_entry *next;
-	while (entry != NULL) {
-		if (free_func != NULL)
-			if (entry->item)
-				(*free_func) (entry->item);
-		next = entry->next;
-		oscap_free(entry->key);
-		entry->item = NULL;
-		entry->key = NULL;
-		entry->next = NULL;
-		oscap_free(entry);
-		entry = next;
-	}
-	oscap_free(map);
-}
+	size_t i, n;
 
-void oval_string_map_free_string(struct oval_string_map *map)
-{
-	oval_string_map_free(map, oscap_free);
+	pthread_rwlock_rdlock(&map->lock);
+	if (map->order != NULL || map->count == 0)
+		return;
+	pthread_rwlock_unlock(&map->lock);
+
+	pthread_rwlock_wrlock(&map->lock);
+	if (map->order != NULL)
+		return;
+	map->order = oscap_alloc(map->count * sizeof(struct oval_string_map_entry *));
+	for (i = 0, n = 0; i < map->capacity; ++i) {
+		if (map->table[i].key != NULL)
+			map->order[n++] = &map->table[i];
+	}
+	qsort(map->order, n, sizeof(struct oval_string_map_entry *), oval_string_map_entry_cmp);
 }
-#else
-# include <rbt/rbt.h>
-# include <assume.h>
 
 struct oval_string_map *oval_string_map_new(void)
 {
-	return (struct oval_string_map *)(rbt_str_new());
+	struct oval_string_map *map = oscap_alloc(sizeof(struct oval_string_map));
+
+	if (map == NULL)
+		return NULL;
+
+	pthread_rwlock_init(&map->lock, NULL);
+	map->table = NULL;
+	map->capacity = 0;
+	map->count = 0;
+	map->order = NULL;
+	return map;
 }
 
 void oval_string_map_put(struct oval_string_map *map, const char *key, void *val)
 {
-        char *key_copy;
+	char *key_copy;
 
 	assume_d(map != NULL, /* void */);
 	assume_d(key != NULL, /* void */);
 
-	if (rbt_str_add((rbt_t *)map, key_copy = strdup(key), val) != 0) {
-		dD("rbt_str_add: non-zero return code");
-                oscap_free(key_copy);
-        }
+	if (oval_string_map_add(map, key_copy = strdup(key), val) != 0) {
+		dD("oval_string_map_add: non-zero return code");
+		oscap_free(key_copy);
+	}
 }
 
 void oval_string_map_put_string(struct oval_string_map *map, const char *key, const char *val)
@@ -220,41 +214,48 @@ void oval_string_map_put_string(struct oval_string_map *map, const char *key, co
 	assume_d(map != NULL, /* void */);
 	assume_d(key != NULL, /* void */);
 
-	if (rbt_str_add((rbt_t *)map, key_copy = strdup(key), str) == 0)
+	if (oval_string_map_add(map, key_copy = strdup(key), str) == 0)
 		return;
 	else {
 		oscap_free(str);
-                oscap_free(key_copy);
-        }
+		oscap_free(key_copy);
+	}
 	return;
 }
 
 void *oval_string_map_get_value(struct oval_string_map *map, const char *key)
 {
-	void *val = NULL;
+	struct oval_string_map_entry *entry;
+	void *val;
 
 	assume_d(map != NULL, NULL);
 	assume_d(key != NULL, NULL);
 
-	if (rbt_str_get((rbt_t *)map, key, &val) != 0)
-		return (NULL);
-	else
-		return (val);
-}
+	pthread_rwlock_rdlock(&map->lock);
+	entry = oval_string_map_find(map, key, oval_string_map_hash(key));
+	val = entry != NULL ? entry->val : NULL;
+	pthread_rwlock_unlock(&map->lock);
 
-static void __oval_string_map_node_free(struct rbt_str_node *n, oscap_destruct_func destroy)
-{
-	if (destroy != NULL)
-		destroy(n->data);
-	oscap_free(n->key);
+	return val;
 }
 
 void oval_string_map_free(struct oval_string_map *map, oscap_destruct_func destroy)
 {
+	size_t i;
+
 	assume_d(map != NULL, /* void */);
-	rbt_str_free_cb2((rbt_t *)map,
-			 (void(*)(struct rbt_str_node *, void *))__oval_string_map_node_free,
-			 (void *)destroy);
+
+	for (i = 0; i < map->capacity; ++i) {
+		if (map->table[i].key == NULL)
+			continue;
+		if (destroy != NULL)
+			destroy(map->table[i].val);
+		oscap_free(map->table[i].key);
+	}
+	oscap_free(map->table);
+	oscap_free(map->order);
+	pthread_rwlock_destroy(&map->lock);
+	oscap_free(map);
 }
 
 void oval_string_map_free0(struct oval_string_map *map)
@@ -268,41 +269,18 @@ void oval_string_map_free_string(struct oval_string_map *map)
 	oval_string_map_free(map, oscap_free);
 }
 
-static int __oval_iterator_addkey(struct rbt_str_node *n, void *u)
-{
-	struct oval_iterator *it = (struct oval_iterator *)u;
-
-	oval_collection_iterator_add(it, (void *)n->key);
-
-	return (0);
-}
-
-static int __oval_iterator_addval(struct rbt_str_node *n, void *u)
-{
-	struct oval_iterator *it = (struct oval_iterator *)u;
-
-	oval_collection_iterator_add(it, n->data);
-
-	return (0);
-}
-
-static int __oval_collection_addval(struct rbt_str_node *n, void *u)
-{
-	struct oval_collection *c = (struct oval_collection *)u;
-
-	oval_collection_add(c, n->data);
-
-	return (0);
-}
-
 struct oval_iterator *oval_string_map_keys(struct oval_string_map *map)
 {
 	struct oval_iterator *it;
+	size_t i;
 
 	assume_d(map != NULL, NULL);
 
 	it = oval_collection_iterator_new();
-	rbt_str_walk_inorder2((rbt_t *)map, __oval_iterator_addkey, it, 0);
+	oval_string_map_lock_ordered(map);
+	for (i = 0; i < map->count; ++i)
+		oval_collection_iterator_add(it, (void *)map->order[i]->key);
+	pthread_rwlock_unlock(&map->lock);
 
 	return (it);
 }
@@ -310,24 +288,31 @@ struct oval_iterator *oval_string_map_keys(struct oval_string_map *map)
 struct oval_iterator *oval_string_map_values(struct oval_string_map *map)
 {
 	struct oval_iterator *it;
+	size_t i;
 
 	assume_d(map != NULL, NULL);
 
 	it = oval_collection_iterator_new();
-	rbt_str_walk_inorder2((rbt_t *)map, __oval_iterator_addval, it, 0);
+	oval_string_map_lock_ordered(map);
+	for (i = 0; i < map->count; ++i)
+		oval_collection_iterator_add(it, map->order[i]->val);
+	pthread_rwlock_unlock(&map->lock);
 
 	return (it);
 }
 
 struct oval_collection *oval_string_map_collect_values(struct oval_string_map *map, struct oval_collection *collection)
 {
+	size_t i;
+
 	assume_d(map != NULL, NULL);
 
 	if (collection == NULL)
 		collection = oval_collection_new();
-	rbt_str_walk_inorder2((rbt_t *)map, __oval_collection_addval, collection, 0);
+	oval_string_map_lock_ordered(map);
+	for (i = 0; i < map->count; ++i)
+		oval_collection_add(collection, map->order[i]->val);
+	pthread_rwlock_unlock(&map->lock);
 
 	return (collection);
 }
-
-#endif /* OVAL_STRINGMAP_LINEAR */
@@ -185,6 +185,41 @@ void oval_affected_add_product(struct oval_affected *affected, char *product)
 	oval_collection_add(affected->products, (void *)oscap_strdup(product));
 }
 
+void oval_affected_to_image(struct oval_affected *affected, struct oval_image *image)
+{
+	oval_image_put_int(image, affected->family);
+
+	oval_image_put_count(image, oval_collection_size(affected->platforms));
+	struct oval_string_iterator *platforms = oval_affected_get_platforms(affected);
+	while (oval_string_iterator_has_more(platforms))
+		oval_image_put_string(image, oval_string_iterator_next(platforms));
+	oval_string_iterator_free(platforms);
+
+	oval_image_put_count(image, oval_collection_size(affected->products));
+	struct oval_string_iterator *products = oval_affected_get_products(affected);
+	while (oval_string_iterator_has_more(products))
+		oval_image_put_string(image, oval_string_iterator_next(products));
+	oval_string_iterator_free(products);
+}
+
+struct oval_affected *oval_affected_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_affected *affected = oval_affected_new(model);
+	size_t i, count;
+
+	affected->family = oval_image_get_int(image);
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_collection_add(affected->platforms, oval_image_dup_string(image));
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_collection_add(affected->products, oval_image_dup_string(image));
+
+	return affected;
+}
+
 static oval_affected_family_t _odafamily(char *family)
 {
 	return oscap_string_to_enum(OVAL_ODAFAMILY_MAP, family);
@@ -32,8 +32,12 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <assume.h>
 
 #include "oval_agent_api.h"
@@ -49,6 +53,9 @@
 #include "common/debug_priv.h"
 #include "common/_error.h"
 #include "oval_agent_xccdf_api.h"
+#include "partitionDefs_impl.h"
+
+#define OVAL_AGENT_JOBS_ENV "OSCAP_OVAL_JOBS"
 
 struct oval_agent_session {
 	char *filename;
@@ -60,6 +67,7 @@ struct oval_agent_session {
 	struct oval_syschar_model    * sys_models[2];
 	struct oval_results_model    * res_model;
 	oval_probe_session_t  * psess;
+	unsigned int jobs;
 };
 
 
@@ -126,9 +134,22 @@ oval_agent_session_t * oval_agent_new_session(struct oval_definition_model *mode
 
 	ag_sess->product_name = NULL;
 
+	ag_sess->jobs = 1;
+	if (getenv(OVAL_AGENT_JOBS_ENV) != NULL)
+		oval_agent_set_jobs(ag_sess, strtoul(getenv(OVAL_AGENT_JOBS_ENV), NULL, 10));
+
 	return ag_sess;
 }
 
+void oval_agent_set_jobs(oval_agent_session_t *ag_sess, unsigned int jobs)
+{
+	if (jobs == 0) {
+		long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+		jobs = ncpu > 0 ? (unsigned int) ncpu : 1;
+	}
+	ag_sess->jobs = jobs;
+}
+
 struct oval_definition_model* oval_agent_get_definition_model(oval_agent_session_t* ag_sess)
 {
 	return ag_sess->def_model;
@@ -158,12 +179,41 @@ static struct oval_result_system *_oval_agent_get_first_result_system(oval_agent
 	return rsystem;
 }
 
+/*
+ * Order the objects of all the definitions by their dependencies and type
+ * and submit them to the probes, so that they are collected while the
+ * definitions are evaluated one by one.
+ */
+static void _oval_agent_prefetch_definitions(oval_agent_session_t *ag_sess)
+{
+	struct oval_definition_iterator *oval_def_it;
+	oval_probe_order_t *ord;
+
+	ord = oval_probe_order_new();
+
+	oval_def_it = oval_definition_model_get_definitions(ag_sess->def_model);
+	while (oval_definition_iterator_has_more(oval_def_it))
+		oval_probe_order_add_definition(ord, oval_definition_iterator_next(oval_def_it));
+	oval_definition_iterator_free(oval_def_it);
+
+	oval_probe_order_dump(ord);
+	oval_probe_order_submit(ag_sess->psess, ord);
+	oval_probe_order_free(ord);
+}
+
 int oval_agent_eval_definition(oval_agent_session_t *ag_sess, const char *id)
 {
 	int ret;
 	struct oval_result_system *rsystem;
+	struct oval_definition *oval_def;
 
 	rsystem = _oval_agent_get_first_result_system(ag_sess);
+
+	/* submit the objects of the tests at once */
+	oval_def = oval_definition_model_get_definition(ag_sess->def_model, id);
+	if (oval_def != NULL)
+		oval_probe_prefetch_definition(ag_sess->psess, oval_def);
+
 	/* eval */
 	ret = oval_result_system_eval_definition(rsystem, id);
 
@@ -244,6 +294,201 @@ int oval_agent_abort_session(oval_agent_session_t *ag_sess)
 	return oval_probe_session_abort(ag_sess->psess);
 }
 
+/*
+ * Parallel evaluation: the definitions are split into groups which don't
+ * share anything but the collected system characteristics. The jobs take
+ * whole groups and evaluate their definitions in the document order, while
+ * the calling thread reports the results in the document order as well.
+ */
+struct oval_agent_jobs {
+	struct oval_result_definition **rdefs;
+	struct err_queue **errs;   /* errors raised while evaluating each definition */
+	bool    *done;
+	size_t  *first;            /* the first definition of each group */
+	size_t  *next;             /* the next definition of the same group */
+	size_t   count;
+	size_t   ngroups;
+	size_t   next_group;
+	bool     stop;
+
+	pthread_mutex_t lock;
+	pthread_cond_t  cond;
+};
+
+static void *_oval_agent_job(void *arg)
+{
+	struct oval_agent_jobs *jobs = (struct oval_agent_jobs *) arg;
+	size_t group, i;
+
+	pthread_mutex_lock(&jobs->lock);
+	while (!jobs->stop && jobs->next_group < jobs->ngroups) {
+		group = jobs->next_group++;
+		pthread_mutex_unlock(&jobs->lock);
+
+		for (i = jobs->first[group]; i < jobs->count; i = jobs->next[i]) {
+			if (jobs->rdefs[i] != NULL)
+				oval_result_definition_eval(jobs->rdefs[i]);
+
+			pthread_mutex_lock(&jobs->lock);
+			jobs->errs[i] = oscap_err_detach();
+			jobs->done[i] = true;
+			pthread_cond_broadcast(&jobs->cond);
+			if (jobs->stop) {
+				pthread_mutex_unlock(&jobs->lock);
+				return NULL;
+			}
+			pthread_mutex_unlock(&jobs->lock);
+		}
+
+		pthread_mutex_lock(&jobs->lock);
+	}
+	pthread_mutex_unlock(&jobs->lock);
+
+	return NULL;
+}
+
+static int _oval_agent_eval_parallel(oval_agent_session_t *ag_sess, agent_reporter cb, void *arg)
+{
+	struct oval_agent_jobs jobs;
+	struct oval_result_system *rsystem;
+	struct oval_definition **defs;
+	struct oval_definition_iterator *oval_def_it;
+	size_t *groups, *last, i, nthreads, started;
+	pthread_t *threads;
+	int ret = 0;
+
+	rsystem = _oval_agent_get_first_result_system(ag_sess);
+
+	/* collect everything first, the jobs then only read the syschar model */
+	_oval_agent_prefetch_definitions(ag_sess);
+	oval_probe_prefetch_wait(ag_sess->psess);
+
+	jobs.count = 0;
+	oval_def_it = oval_definition_model_get_definitions(ag_sess->def_model);
+	while (oval_definition_iterator_has_more(oval_def_it)) {
+		oval_definition_iterator_next(oval_def_it);
+		++jobs.count;
+	}
+	oval_definition_iterator_free(oval_def_it);
+
+	defs   = oscap_alloc(jobs.count * sizeof(struct oval_definition *));
+	groups = oscap_alloc(jobs.count * sizeof(size_t));
+
+	oval_def_it = oval_definition_model_get_definitions(ag_sess->def_model);
+	for (i = 0; i < jobs.count; ++i)
+		defs[i] = oval_definition_iterator_next(oval_def_it);
+	oval_definition_iterator_free(oval_def_it);
+
+	jobs.ngroups = oval_definitions_partition(defs, jobs.count, groups);
+	jobs.rdefs   = oscap_calloc(jobs.count, sizeof(struct oval_result_definition *));
+	jobs.errs    = oscap_calloc(jobs.count, sizeof(struct err_queue *));
+	jobs.done    = oscap_calloc(jobs.count, sizeof(bool));
+	jobs.first   = oscap_alloc(jobs.ngroups * sizeof(size_t));
+	jobs.next    = oscap_alloc(jobs.count * sizeof(size_t));
+	last         = oscap_alloc(jobs.ngroups * sizeof(size_t));
+	jobs.next_group = 0;
+	jobs.stop       = false;
+
+	/* link the definitions of each group in the document order */
+	for (i = 0; i < jobs.ngroups; ++i)
+		jobs.first[i] = last[i] = jobs.count;
+	for (i = 0; i < jobs.count; ++i) {
+		if (jobs.first[groups[i]] == jobs.count)
+			jobs.first[groups[i]] = i;
+		else
+			jobs.next[last[groups[i]]] = i;
+		last[groups[i]] = i;
+		jobs.next[i] = jobs.count;
+	}
+
+	/* result definitions and tests are created in the document order */
+	for (i = 0; i < jobs.count; ++i) {
+		jobs.rdefs[i] = oval_result_system_prepare_definition(rsystem, oval_definition_get_id(defs[i]));
+		if (jobs.rdefs[i] == NULL) {
+			jobs.errs[i] = oscap_err_detach();
+			jobs.done[i] = true;
+		}
+	}
+
+	pthread_mutex_init(&jobs.lock, NULL);
+	pthread_cond_init(&jobs.cond, NULL);
+
+	nthreads = ag_sess->jobs < jobs.ngroups ? ag_sess->jobs : jobs.ngroups;
+	threads  = oscap_alloc(nthreads * sizeof(pthread_t));
+
+	dI("Evaluating %zu definitions in %zu groups by %zu jobs.", jobs.count, jobs.ngroups, nthreads);
+
+	for (started = 0; started < nthreads; ++started) {
+		int err = pthread_create(&threads[started], NULL, _oval_agent_job, &jobs);
+
+		if (err != 0) {
+			dW("Can't start an evaluation job: %d, %s", err, strerror(err));
+			break;
+		}
+	}
+
+	for (i = 0; i < jobs.count; ++i) {
+		pthread_mutex_lock(&jobs.lock);
+		while (!jobs.done[i]) {
+			if (started == 0) {
+				/* no job could be started, evaluate here */
+				pthread_mutex_unlock(&jobs.lock);
+				if (jobs.rdefs[i] != NULL)
+					oval_result_definition_eval(jobs.rdefs[i]);
+				pthread_mutex_lock(&jobs.lock);
+				jobs.done[i] = true;
+				break;
+			}
+			pthread_cond_wait(&jobs.cond, &jobs.lock);
+		}
+		pthread_mutex_unlock(&jobs.lock);
+
+		if (jobs.errs[i] != NULL) {
+			oscap_err_attach(jobs.errs[i]);
+			jobs.errs[i] = NULL;
+		}
+
+		if (jobs.rdefs[i] == NULL) {
+			ret = -1;
+			break;
+		}
+
+		if (cb != NULL) {
+			ret = cb(jobs.rdefs[i], arg);
+			/* stop? */
+			if (ret != 0)
+				break;
+		}
+	}
+
+	pthread_mutex_lock(&jobs.lock);
+	jobs.stop = true;
+	pthread_mutex_unlock(&jobs.lock);
+
+	while (started > 0)
+		pthread_join(threads[--started], NULL);
+
+	for (i = 0; i < jobs.count; ++i) {
+		if (jobs.errs[i] != NULL)
+			oscap_err_attach(jobs.errs[i]);
+	}
+
+	pthread_cond_destroy(&jobs.cond);
+	pthread_mutex_destroy(&jobs.lock);
+
+	oscap_free(threads);
+	oscap_free(last);
+	oscap_free(jobs.next);
+	oscap_free(jobs.first);
+	oscap_free(jobs.done);
+	oscap_free(jobs.errs);
+	oscap_free(jobs.rdefs);
+	oscap_free(groups);
+	oscap_free(defs);
+
+	return ret;
+}
+
 int oval_agent_eval_system(oval_agent_session_t * ag_sess, agent_reporter cb, void *arg) {
 	struct oval_definition *oval_def;
 	struct oval_definition_iterator *oval_def_it;
@@ -251,6 +496,15 @@ int oval_agent_eval_system(oval_agent_session_t * ag_sess, agent_reporter cb, vo
 	int ret = 0;
 
 	dI("OVAL agent started to evaluate OVAL definitions on your system.");
+
+	if (ag_sess->jobs > 1) {
+		ret = _oval_agent_eval_parallel(ag_sess, cb, arg);
+		dI("OVAL agent finished evaluation.");
+		return ret;
+	}
+
+	_oval_agent_prefetch_definitions(ag_sess);
+
 	oval_def_it = oval_definition_model_get_definitions(ag_sess->def_model);
 	while (oval_definition_iterator_has_more(oval_def_it)) {
 		oval_def = oval_definition_iterator_next(oval_def_it);
@@ -518,6 +772,22 @@ int oval_agent_resolve_variables(struct oval_agent_session * session, struct xcc
     return retval;
 }
 
+/* Applies the XCCDF Truth Table for AND to the results reported by the parallel evaluation */
+static int _oval_agent_and_reporter(const struct oval_result_definition *res_def, void *arg)
+{
+	xccdf_test_result_type_t *final_result = (xccdf_test_result_type_t *) arg;
+	struct oval_definition *oval_def;
+	xccdf_test_result_type_t xccdf_result;
+
+	oval_def = oval_result_definition_get_definition(res_def);
+	xccdf_result = xccdf_get_result_from_oval(oval_definition_get_class(oval_def),
+			oval_result_definition_get_result(res_def));
+	*final_result = (*final_result == 0) ? xccdf_result :
+		xccdf_test_result_resolve_and_operation(*final_result, xccdf_result);
+
+	return 0;
+}
+
 static int
 oval_agent_eval_multi_check(oval_agent_session_t *sess)
 {
@@ -538,6 +808,12 @@ oval_agent_eval_multi_check(oval_agent_session_t *sess)
 		// better to report error.
 		final_result = XCCDF_RESULT_ERROR;
 	}
+	if (sess->jobs > 1) {
+		oval_definition_iterator_free(oval_def_it);
+		assume_r(_oval_agent_eval_parallel(sess, _oval_agent_and_reporter, &final_result) != -1, -1);
+		return final_result;
+	}
+	_oval_agent_prefetch_definitions(sess);
 	while (oval_definition_iterator_has_more(oval_def_it)) {
 		oval_def = oval_definition_iterator_next(oval_def_it);
 		id = oval_definition_get_id(oval_def);
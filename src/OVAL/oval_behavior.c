@@ -132,6 +132,21 @@ void oval_behavior_set_keyval(struct oval_behavior *behavior, const char *key, c
 }
 
 //typedef void (*oval_behavior_consumer)(struct oval_behavior_node *, void*);
+void oval_behavior_to_image(struct oval_behavior *behavior, struct oval_image *image)
+{
+	oval_image_put_string(image, behavior->key);
+	oval_image_put_string(image, behavior->value);
+}
+
+struct oval_behavior *oval_behavior_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_behavior *behavior = oval_behavior_new(model);
+
+	behavior->key = oval_image_dup_string(image);
+	behavior->value = oval_image_dup_string(image);
+	return behavior;
+}
+
 int oval_behavior_parse_tag(xmlTextReaderPtr reader,
 			    struct oval_parser_context *context,
 			    oval_family_t family, oval_behavior_consumer consumer, void *user)
@@ -112,6 +112,7 @@ typedef struct {
 		struct oval_syschar_model *sysmod;
 		oval_probe_session_t *sess;
 	} u;
+	bool values_max_exceeded;	///< a function produced more values than allowed
 } oval_argu_t;
 
 typedef struct oval_component {
@@ -938,6 +939,128 @@ void oval_component_set_variable(struct oval_component *component, struct oval_v
 	}
 }
 
+void oval_component_to_image(struct oval_component *component, struct oval_image *image)
+{
+	oval_image_put_int(image, component->type);
+
+	switch (component->type) {
+	case OVAL_COMPONENT_LITERAL:{
+			struct oval_value *value = ((oval_component_LITERAL_t *) component)->value;
+			oval_image_put_int(image, value != NULL);
+			if (value != NULL)
+				oval_value_to_image(value, image);
+		} return;
+	case OVAL_COMPONENT_OBJECTREF:{
+			oval_component_OBJECTREF_t *objectref = (oval_component_OBJECTREF_t *) component;
+			oval_image_put_string(image, objectref->object ? oval_object_get_id(objectref->object) : NULL);
+			oval_image_put_string(image, objectref->item_field);
+			oval_image_put_string(image, objectref->record_field);
+		} return;
+	case OVAL_COMPONENT_VARREF:{
+			struct oval_variable *variable = ((oval_component_VARREF_t *) component)->variable;
+			oval_image_put_string(image, variable ? oval_variable_get_id(variable) : NULL);
+		} return;
+	case OVAL_FUNCTION_ARITHMETIC:
+		oval_image_put_int(image, ((oval_component_ARITHMETIC_t *) component)->operation);
+		break;
+	case OVAL_FUNCTION_BEGIN:
+	case OVAL_FUNCTION_END:
+		oval_image_put_string(image, ((oval_component_BEGEND_t *) component)->character);
+		break;
+	case OVAL_FUNCTION_SPLIT:
+		oval_image_put_string(image, ((oval_component_SPLIT_t *) component)->delimiter);
+		break;
+	case OVAL_FUNCTION_GLOB_TO_REGEX:
+		oval_image_put_int(image, ((oval_component_GLOB_t *) component)->glob_noescape);
+		break;
+	case OVAL_FUNCTION_SUBSTRING:
+		oval_image_put_int(image, ((oval_component_SUBSTRING_t *) component)->start);
+		oval_image_put_int(image, ((oval_component_SUBSTRING_t *) component)->length);
+		break;
+	case OVAL_FUNCTION_TIMEDIF:
+		oval_image_put_int(image, ((oval_component_TIMEDIF_t *) component)->format_1);
+		oval_image_put_int(image, ((oval_component_TIMEDIF_t *) component)->format_2);
+		break;
+	case OVAL_FUNCTION_REGEX_CAPTURE:
+		oval_image_put_string(image, ((oval_component_REGEX_CAPTURE_t *) component)->pattern);
+		break;
+	default:
+		break;
+	}
+
+	struct oval_collection *subcomps = ((oval_component_FUNCTION_t *) component)->function_components;
+	oval_image_put_count(image, oval_collection_size(subcomps));
+	struct oval_iterator *itr = oval_collection_iterator(subcomps);
+	while (oval_collection_iterator_has_more(itr))
+		oval_component_to_image(oval_collection_iterator_next(itr), image);
+	oval_collection_iterator_free(itr);
+}
+
+struct oval_component *oval_component_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	oval_component_type_t type = oval_image_get_int(image);
+	struct oval_component *component;
+	const char *id;
+	size_t i, count;
+
+	if (type <= OVAL_COMPONENT_UNKNOWN || type == OVAL_COMPONENT_FUNCTION || type >= OVAL_FUNCTION_LAST)
+		return NULL;
+	component = oval_component_new(model, type);
+
+	switch (type) {
+	case OVAL_COMPONENT_LITERAL:
+		if (oval_image_get_int(image))
+			((oval_component_LITERAL_t *) component)->value = oval_value_from_image(image);
+		return component;
+	case OVAL_COMPONENT_OBJECTREF:{
+			oval_component_OBJECTREF_t *objectref = (oval_component_OBJECTREF_t *) component;
+			if ((id = oval_image_get_string(image)) != NULL)
+				objectref->object = oval_definition_model_get_new_object(model, id);
+			objectref->item_field = oval_image_dup_string(image);
+			objectref->record_field = oval_image_dup_string(image);
+		} return component;
+	case OVAL_COMPONENT_VARREF:
+		if ((id = oval_image_get_string(image)) != NULL)
+			((oval_component_VARREF_t *) component)->variable =
+				oval_definition_model_get_new_variable(model, id, OVAL_VARIABLE_UNKNOWN);
+		return component;
+	case OVAL_FUNCTION_ARITHMETIC:
+		((oval_component_ARITHMETIC_t *) component)->operation = oval_image_get_int(image);
+		break;
+	case OVAL_FUNCTION_BEGIN:
+	case OVAL_FUNCTION_END:
+		((oval_component_BEGEND_t *) component)->character = oval_image_dup_string(image);
+		break;
+	case OVAL_FUNCTION_SPLIT:
+		((oval_component_SPLIT_t *) component)->delimiter = oval_image_dup_string(image);
+		break;
+	case OVAL_FUNCTION_GLOB_TO_REGEX:
+		((oval_component_GLOB_t *) component)->glob_noescape = oval_image_get_int(image);
+		break;
+	case OVAL_FUNCTION_SUBSTRING:
+		((oval_component_SUBSTRING_t *) component)->start = oval_image_get_int(image);
+		((oval_component_SUBSTRING_t *) component)->length = oval_image_get_int(image);
+		break;
+	case OVAL_FUNCTION_TIMEDIF:
+		((oval_component_TIMEDIF_t *) component)->format_1 = oval_image_get_int(image);
+		((oval_component_TIMEDIF_t *) component)->format_2 = oval_image_get_int(image);
+		break;
+	case OVAL_FUNCTION_REGEX_CAPTURE:
+		((oval_component_REGEX_CAPTURE_t *) component)->pattern = oval_image_dup_string(image);
+		break;
+	default:
+		break;
+	}
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i) {
+		struct oval_component *subcomp = oval_component_from_image(image, model);
+		if (subcomp != NULL)
+			oval_component_add_function_component(component, subcomp);
+	}
+	return component;
+}
+
 static void oval_value_consume(struct oval_value *value, void *component)
 {
 	oval_component_set_literal_value(component, value);
@@ -1470,6 +1593,9 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_VARREF(oval_argu_
 			return flag;
 	}
 
+	if (oval_variable_values_max_exceeded(variable))
+		argu->values_max_exceeded = true;
+
 	flag = oval_variable_get_collection_flag(variable);
 	if (_HAS_VALUES(flag)) {
 		struct oval_value_iterator *values = oval_variable_get_values(variable);
@@ -1555,6 +1681,101 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_END(oval_argu_t *
 	return flag;
 }
 
+/*
+ * Functions with several arguments (concat, arithmetic) produce a value for
+ * each combination of the argument values. The combinations are walked one
+ * at a time, with the first argument changing fastest, so that only the
+ * produced values are kept in memory. Empty arguments are skipped.
+ */
+struct oval_component_product {
+	int len;
+	struct oval_value ***values;	///< values of each argument
+	size_t *counts;
+	size_t *idx;
+	bool started;
+};
+
+static int oval_component_product_init(struct oval_component_product *prod, oval_argu_t *argu,
+				       struct oval_component *component, struct oval_collection **colls, int len)
+{
+	size_t total = 1, max;
+	int i;
+
+	prod->len = len;
+	prod->values = oscap_alloc(len * sizeof(struct oval_value **));
+	prod->counts = oscap_alloc(len * sizeof(size_t));
+	prod->idx = oscap_alloc(len * sizeof(size_t));
+	prod->started = false;
+
+	max = oval_definition_model_get_component_values_max(component->model);
+	for (i = 0; i < len; i++) {
+		struct oval_value_iterator *val_itr;
+		size_t n = 0;
+
+		val_itr = (struct oval_value_iterator *) oval_collection_iterator(colls[i]);
+		prod->counts[i] = oval_value_iterator_remaining(val_itr);
+		prod->values[i] = oscap_alloc(prod->counts[i] * sizeof(struct oval_value *));
+		while (oval_value_iterator_has_more(val_itr))
+			prod->values[i][n++] = oval_value_iterator_next(val_itr);
+		oval_value_iterator_free(val_itr);
+		prod->idx[i] = 0;
+
+		if (prod->counts[i] == 0)
+			continue;
+		if (max != 0 && total > max / prod->counts[i]) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL, "Combining the function arguments would produce "
+				     "more than %zu values.", max);
+			argu->values_max_exceeded = true;
+			prod->len = i + 1;
+			return -1;
+		}
+		total *= prod->counts[i];
+	}
+
+	return 0;
+}
+
+/* Advance to the next combination, false when there are no more of them. */
+static bool oval_component_product_next(struct oval_component_product *prod)
+{
+	int i;
+
+	if (!prod->started) {
+		prod->started = true;
+		for (i = 0; i < prod->len; i++)
+			if (prod->counts[i])
+				return true;
+		return false;
+	}
+
+	for (i = 0; i < prod->len; i++) {
+		if (prod->counts[i] == 0)
+			continue;
+		if (++prod->idx[i] < prod->counts[i])
+			return true;
+		prod->idx[i] = 0;
+	}
+
+	return false;
+}
+
+/* Value of the i-th argument in the current combination, NULL if it's empty. */
+static struct oval_value *oval_component_product_value(struct oval_component_product *prod, int i)
+{
+	return prod->counts[i] ? prod->values[i][prod->idx[i]] : NULL;
+}
+
+static void oval_component_product_clear(struct oval_component_product *prod)
+{
+	int i;
+
+	for (i = 0; i < prod->len; i++)
+		oscap_free(prod->values[i]);
+	oscap_free(prod->values);
+	oscap_free(prod->counts);
+	oscap_free(prod->idx);
+}
+
 static oval_syschar_collection_flag_t _oval_component_evaluate_CONCAT(oval_argu_t *argu,
 								      struct oval_component *component,
 								      struct oval_collection *value_collection)
@@ -1572,71 +1793,36 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_CONCAT(oval_argu_
 		flag = _AGG_FLAG(flag, subflag);
 		component_colls[idx0] = subcoll;
 	}
-	bool not_finished = (len_subcomps > 0) && _HAS_VALUES(flag);
-	if (not_finished) {
-		struct oval_value_iterator *values[len_subcomps];
-		/* bool has_some[len_subcomps]; <-- unused variable */
-		not_finished = false;
-		char *texts[len_subcomps];
-		int counts[len_subcomps];
-		int catnum = 1;
-		for (idx0 = 0; idx0 < len_subcomps; idx0++) {
-			struct oval_value_iterator *comp_values =
-			    (struct oval_value_iterator *)oval_collection_iterator(component_colls[idx0]);
-			counts[idx0] = oval_value_iterator_remaining(comp_values);
-			if (counts[idx0]) {
-				/* int dbgnum = catnum; <-- unused variable */
-				catnum = catnum * counts[idx0];
-				values[idx0] = comp_values;
-				texts[idx0] = oval_value_get_text(oval_value_iterator_next(comp_values));
-				not_finished = true;
-			} else {
-				oval_collection_free_items(component_colls[idx0],
-							   (oscap_destruct_func) oval_value_free);
-				component_colls[idx0] = NULL;
-				values[idx0] = NULL;
-				texts[idx0] = NULL;
-			}
-		}
-		for (int passnum = 1; passnum - 1 < catnum; passnum++) {
-			int len_cat = 1;
-			for (idx0 = 0; idx0 < len_subcomps; idx0++)
-				if (texts[idx0])
-					len_cat += strlen(texts[idx0]);
-			char concat[len_cat];
-			*concat = '\0';
-			for (idx0 = 0; idx0 < len_subcomps; idx0++)
-				if (texts[idx0])
-					strcat(concat, texts[idx0]);
-			struct oval_value *value = oval_value_new(OVAL_DATATYPE_STRING, concat);
-			oval_collection_add(value_collection, value);
-			bool rotate = true;
-			if (passnum < catnum) {
-				for (idx0 = 0; idx0 < len_subcomps && rotate; idx0++) {
-					if (texts[idx0]) {
-						if (oval_value_iterator_has_more(values[idx0])) {
-							rotate = false;
-						} else {
-							oval_value_iterator_free(values[idx0]);
-							values[idx0] =
-							    (struct oval_value_iterator *)
-							    oval_collection_iterator(component_colls[idx0]);
-						}
-						texts[idx0] =
-						    oval_value_get_text(oval_value_iterator_next(values[idx0]));
-					}
+	oval_component_iterator_free(subcomps);
+
+	if (len_subcomps > 0 && _HAS_VALUES(flag)) {
+		struct oval_component_product prod;
+
+		if (oval_component_product_init(&prod, argu, component, component_colls, len_subcomps) != 0) {
+			flag = SYSCHAR_FLAG_ERROR;
+		} else {
+			while (oval_component_product_next(&prod)) {
+				size_t len_cat = 1;
+				for (idx0 = 0; idx0 < len_subcomps; idx0++) {
+					struct oval_value *val = oval_component_product_value(&prod, idx0);
+					if (val)
+						len_cat += strlen(oval_value_get_text(val));
 				}
+				char concat[len_cat], *end = concat;
+				for (idx0 = 0; idx0 < len_subcomps; idx0++) {
+					struct oval_value *val = oval_component_product_value(&prod, idx0);
+					if (val)
+						end = stpcpy(end, oval_value_get_text(val));
+				}
+				*end = '\0';
+				oval_collection_add(value_collection, oval_value_new(OVAL_DATATYPE_STRING, concat));
 			}
 		}
-		for (idx0 = 0; idx0 < len_subcomps; idx0++) {
-			if (counts[idx0]) {
-				oval_value_iterator_free(values[idx0]);
-				oval_collection_free_items(component_colls[idx0],
-							   (oscap_destruct_func) oval_value_free);
-			}
-		}
+		oval_component_product_clear(&prod);
 	}
-	oval_component_iterator_free(subcomps);
+
+	for (idx0 = 0; idx0 < len_subcomps; idx0++)
+		oval_collection_free_items(component_colls[idx0], (oscap_destruct_func) oval_value_free);
 	return flag;
 }
 
@@ -2261,75 +2447,26 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_REGEX_CAPTURE(ova
 	return flag;
 }
 
-struct val_col_lst_s {
-	void *val_col;
-	struct val_col_lst_s *next;
-};
-
-static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC_rec(struct val_col_lst_s *val_col_lst, double val,
-						    oval_datatype_t datatype, oval_arithmetic_operation_t op,
-						    struct oval_collection *res_val_col)
+static int _oval_component_value_to_double(struct oval_value *ov, double *val)
 {
-	struct oval_value_iterator *val_itr;
-
-	if (val_col_lst == NULL) {
-		struct oval_value *ov;
-		char sv[32];
-
-		if (datatype == OVAL_DATATYPE_INTEGER) {
-			snprintf(sv, sizeof (sv), "%ld", (long int) val);
-		} else if (datatype == OVAL_DATATYPE_FLOAT) {
-			snprintf(sv, sizeof (sv), "%f", val);
-		}
-		ov = oval_value_new(datatype, sv);
-		oval_collection_add(res_val_col, ov);
-
-		return SYSCHAR_FLAG_COMPLETE;
-	}
-
-	val_itr = (struct oval_value_iterator *) oval_collection_iterator(val_col_lst->val_col);
-	while (oval_value_iterator_has_more(val_itr)) {
-		struct oval_value *ov;
-		oval_datatype_t dt;
-		double new_val;
-
-		ov = oval_value_iterator_next(val_itr);
-		dt = oval_value_get_datatype(ov);
-		if (dt == OVAL_DATATYPE_STRING) {
-			errno = 0; // Setting errno to 0 as suggested by strtod() manpage, as 0 is used both on success and failure
-			new_val = strtod(oval_value_get_text(ov), NULL);
-			if (errno) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected content: %s.", oval_value_get_text(ov));
-				oval_value_iterator_free(val_itr);
-				return SYSCHAR_FLAG_ERROR;
-			}
-		} else if (dt == OVAL_DATATYPE_INTEGER) {
-			new_val = (double) oval_value_get_integer(ov);
-		} else if (dt == OVAL_DATATYPE_FLOAT) {
-			new_val = (double) oval_value_get_float(ov);
-		} else {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected value type: %s.", oval_datatype_get_text(dt));
-			oval_value_iterator_free(val_itr);
-			return SYSCHAR_FLAG_ERROR;
-		}
+	oval_datatype_t datatype = oval_value_get_datatype(ov);
 
-		if (op == OVAL_ARITHMETIC_ADD) {
-			new_val += val;
-		} else if (op == OVAL_ARITHMETIC_MULTIPLY) {
-			new_val *= val;
-		} else {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected arithmetic operation: %s.", oval_arithmetic_operation_get_text(op));
-			oval_value_iterator_free(val_itr);
-			return SYSCHAR_FLAG_ERROR;
+	if (datatype == OVAL_DATATYPE_STRING) {
+		errno = 0; // Setting errno to 0 as suggested by strtod() manpage, as 0 is used both on success and failure
+		*val = strtod(oval_value_get_text(ov), NULL);
+		if (errno) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected content: %s.", oval_value_get_text(ov));
+			return -1;
 		}
-
-		if (datatype == OVAL_DATATYPE_FLOAT)
-			dt = OVAL_DATATYPE_FLOAT;
-		_oval_component_evaluate_ARITHMETIC_rec(val_col_lst->next, new_val, dt, op, res_val_col);
+	} else if (datatype == OVAL_DATATYPE_INTEGER) {
+		*val = (double) oval_value_get_integer(ov);
+	} else if (datatype == OVAL_DATATYPE_FLOAT) {
+		*val = (double) oval_value_get_float(ov);
+	} else {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected value type: %s.", oval_datatype_get_text(datatype));
+		return -1;
 	}
-	oval_value_iterator_free(val_itr);
-
-	return SYSCHAR_FLAG_COMPLETE;
+	return 0;
 }
 
 static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC(oval_argu_t *argu,
@@ -2338,9 +2475,9 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC(oval_a
 {
 	oval_syschar_collection_flag_t flag = SYSCHAR_FLAG_UNKNOWN;
 	struct oval_component_iterator *subcomps;
-	struct val_col_lst_s *vcl_root, *vcl_elm;
+	struct oval_component_product prod;
 	oval_arithmetic_operation_t op;
-	struct oval_value_iterator *val_itr;
+	int idx0, len_subcomps;
 
 	op = oval_component_get_arithmetic_operation(component);
 	if (op != OVAL_ARITHMETIC_ADD && op != OVAL_ARITHMETIC_MULTIPLY) {
@@ -2348,60 +2485,82 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_ARITHMETIC(oval_a
 		return SYSCHAR_FLAG_ERROR;
 	}
 
-	vcl_root = NULL;
 	subcomps = oval_component_get_function_components(component);
-	while (oval_component_iterator_has_more(subcomps)) {
-		struct oval_component *subcomp;
-		struct oval_collection *val_col;
+	len_subcomps = oval_component_iterator_remaining(subcomps);
+	if (len_subcomps == 0) {
+		oval_component_iterator_free(subcomps);
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "No components specified for arithmetic function.");
+		return SYSCHAR_FLAG_ERROR;
+	}
 
-		subcomp = oval_component_iterator_next(subcomps);
-		val_col = oval_collection_new();
+	struct oval_collection *component_colls[len_subcomps];
+	double *numbers[len_subcomps];
+	memset(numbers, 0, sizeof(numbers));
+	for (idx0 = 0; oval_component_iterator_has_more(subcomps); idx0++) {
+		struct oval_component *subcomp = oval_component_iterator_next(subcomps);
+
+		component_colls[idx0] = oval_collection_new();
 		// todo: combine flags
-		flag = oval_component_eval_common(argu, subcomp, val_col);
-		vcl_elm = oscap_alloc(sizeof (struct val_col_lst_s));
-		vcl_elm->val_col = val_col;
-		vcl_elm->next = vcl_root;
-		vcl_root = vcl_elm;
+		flag = oval_component_eval_common(argu, subcomp, component_colls[idx0]);
 	}
 	oval_component_iterator_free(subcomps);
 
-	val_itr = (struct oval_value_iterator *) oval_collection_iterator(vcl_root->val_col);
-	while (oval_value_iterator_has_more(val_itr)) {
-		struct oval_value *ov;
-		oval_datatype_t datatype;
-		double val;
-
-		ov = oval_value_iterator_next(val_itr);
-		datatype = oval_value_get_datatype(ov);
-		if (datatype == OVAL_DATATYPE_STRING) {
-			errno = 0; // Setting errno to 0 as suggested by strtod() manpage, as 0 is used both on success and failure
-			val = strtod(oval_value_get_text(ov), NULL);
-			if (errno) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected content: %s.", oval_value_get_text(ov));
+	if (oval_component_product_init(&prod, argu, component, component_colls, len_subcomps) != 0) {
+		flag = SYSCHAR_FLAG_ERROR;
+		goto cleanup;
+	}
+
+	/* An empty argument leaves no combination to compute. */
+	for (idx0 = 0; idx0 < len_subcomps; idx0++)
+		if (prod.counts[idx0] == 0)
+			goto cleanup;
+
+	/* Each argument value is converted only once. */
+	for (idx0 = 0; idx0 < len_subcomps; idx0++) {
+		numbers[idx0] = oscap_alloc(prod.counts[idx0] * sizeof(double));
+		for (size_t i = 0; i < prod.counts[idx0]; i++) {
+			if (_oval_component_value_to_double(prod.values[idx0][i], &numbers[idx0][i]) != 0) {
 				flag = SYSCHAR_FLAG_ERROR;
 				goto cleanup;
 			}
-		} else if (datatype == OVAL_DATATYPE_INTEGER) {
-			val = (double) oval_value_get_integer(ov);
-		} else if (datatype == OVAL_DATATYPE_FLOAT) {
-			val = (double) oval_value_get_float(ov);
-		} else {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Unexpected value type: %s.", oval_datatype_get_text(datatype));
-			flag = SYSCHAR_FLAG_ERROR;
-			goto cleanup;
 		}
+	}
+
+	/* Combined from the last argument to the first one, the result is
+	 * a float if any of the values is a float. */
+	while (oval_component_product_next(&prod)) {
+		oval_datatype_t datatype = OVAL_DATATYPE_INTEGER;
+		double val = 0;
+		char sv[32];
 
-		flag = _oval_component_evaluate_ARITHMETIC_rec(vcl_root->next, val, datatype, op, value_collection);
+		for (idx0 = len_subcomps - 1; idx0 >= 0; idx0--) {
+			double v = numbers[idx0][prod.idx[idx0]];
+			oval_datatype_t dt = oval_value_get_datatype(prod.values[idx0][prod.idx[idx0]]);
+
+			if (idx0 == len_subcomps - 1)
+				val = v;
+			else if (op == OVAL_ARITHMETIC_ADD)
+				val = v + val;
+			else
+				val = v * val;
+			if (datatype != OVAL_DATATYPE_FLOAT)
+				datatype = dt;
+		}
+
+		if (datatype == OVAL_DATATYPE_INTEGER)
+			snprintf(sv, sizeof (sv), "%ld", (long int) val);
+		else
+			snprintf(sv, sizeof (sv), "%f", val);
+		oval_collection_add(value_collection, oval_value_new(datatype, sv));
+		flag = SYSCHAR_FLAG_COMPLETE;
 	}
 
  cleanup:
-	oval_value_iterator_free(val_itr);
-	while (vcl_root != NULL) {
-		oval_collection_free_items(vcl_root->val_col, (oscap_destruct_func) oval_value_free);
-		vcl_elm = vcl_root;
-		vcl_root = vcl_root->next;
-		oscap_free(vcl_elm);
-	}
+	for (idx0 = 0; idx0 < len_subcomps; idx0++)
+		oscap_free(numbers[idx0]);
+	oval_component_product_clear(&prod);
+	for (idx0 = 0; idx0 < len_subcomps; idx0++)
+		oval_collection_free_items(component_colls[idx0], (oscap_destruct_func) oval_value_free);
 
 	return flag;
 }
@@ -2451,24 +2610,36 @@ static oval_syschar_collection_flag_t oval_component_eval_common(oval_argu_t *ar
 
 oval_syschar_collection_flag_t oval_component_compute(struct oval_syschar_model *sysmod,
 						      struct oval_component *component,
-						      struct oval_collection *value_collection)
+						      struct oval_collection *value_collection,
+						      bool *values_max_exceeded)
 {
 	oval_argu_t argu;
+	oval_syschar_collection_flag_t flag;
 
 	argu.mode = OVAL_MODE_COMPUTE;
 	argu.u.sysmod = sysmod;
+	argu.values_max_exceeded = false;
 
-	return oval_component_eval_common(&argu, component, value_collection);
+	flag = oval_component_eval_common(&argu, component, value_collection);
+	*values_max_exceeded = argu.values_max_exceeded;
+
+	return flag;
 }
 
 oval_syschar_collection_flag_t oval_component_query(oval_probe_session_t *sess,
 						    struct oval_component *component,
-						    struct oval_collection *value_collection)
+						    struct oval_collection *value_collection,
+						    bool *values_max_exceeded)
 {
 	oval_argu_t argu;
+	oval_syschar_collection_flag_t flag;
 
 	argu.mode = OVAL_MODE_QUERY;
 	argu.u.sess = sess;
+	argu.values_max_exceeded = false;
 
-	return oval_component_eval_common(&argu, component, value_collection);
+	flag = oval_component_eval_common(&argu, component, value_collection);
+	*values_max_exceeded = argu.values_max_exceeded;
+
+	return flag;
 }
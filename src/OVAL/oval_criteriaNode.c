@@ -358,6 +358,74 @@ void oval_criteria_node_set_definition(struct oval_criteria_node *node, struct o
 	}
 }
 
+void oval_criteria_node_to_image(struct oval_criteria_node *node, struct oval_image *image)
+{
+	oval_image_put_int(image, node->type);
+	oval_image_put_int(image, node->negate);
+	oval_image_put_string(image, node->comment);
+	oval_image_put_int(image, node->applicability_check);
+
+	switch (node->type) {
+	case OVAL_NODETYPE_CRITERIA:{
+			struct oval_criteria_node_CRITERIA *criteria = (struct oval_criteria_node_CRITERIA *)node;
+			oval_image_put_int(image, criteria->operator);
+			oval_image_put_count(image, oval_collection_size(criteria->subnodes));
+			struct oval_criteria_node_iterator *subnodes = oval_criteria_node_get_subnodes(node);
+			while (oval_criteria_node_iterator_has_more(subnodes))
+				oval_criteria_node_to_image(oval_criteria_node_iterator_next(subnodes), image);
+			oval_criteria_node_iterator_free(subnodes);
+		} break;
+	case OVAL_NODETYPE_CRITERION:{
+			struct oval_test *test = ((struct oval_criteria_node_CRITERION *)node)->test;
+			oval_image_put_string(image, test ? oval_test_get_id(test) : NULL);
+		} break;
+	case OVAL_NODETYPE_EXTENDDEF:{
+			struct oval_definition *definition = ((struct oval_criteria_node_EXTENDDEF *)node)->definition;
+			oval_image_put_string(image, definition ? oval_definition_get_id(definition) : NULL);
+		} break;
+	case OVAL_NODETYPE_UNKNOWN:
+		break;
+	}
+}
+
+struct oval_criteria_node *oval_criteria_node_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	oval_criteria_node_type_t type = oval_image_get_int(image);
+	struct oval_criteria_node *node = oval_criteria_node_new(model, type);
+	const char *id;
+
+	if (node == NULL)
+		return NULL;
+
+	node->negate = oval_image_get_int(image);
+	node->comment = oval_image_dup_string(image);
+	node->applicability_check = oval_image_get_int(image);
+
+	switch (type) {
+	case OVAL_NODETYPE_CRITERIA:{
+			struct oval_criteria_node_CRITERIA *criteria = (struct oval_criteria_node_CRITERIA *)node;
+			criteria->operator = oval_image_get_int(image);
+			size_t i, count = oval_image_get_count(image);
+			for (i = 0; i < count; ++i) {
+				struct oval_criteria_node *subnode = oval_criteria_node_from_image(image, model);
+				if (subnode != NULL)
+					oval_collection_add(criteria->subnodes, subnode);
+			}
+		} break;
+	case OVAL_NODETYPE_CRITERION:
+		if ((id = oval_image_get_string(image)) != NULL)
+			((struct oval_criteria_node_CRITERION *)node)->test = oval_definition_model_get_new_test(model, id);
+		break;
+	case OVAL_NODETYPE_EXTENDDEF:
+		if ((id = oval_image_get_string(image)) != NULL)
+			((struct oval_criteria_node_EXTENDDEF *)node)->definition = oval_definition_model_get_new_definition(model, id);
+		break;
+	default:
+		break;
+	}
+	return node;
+}
+
 static void _oval_criteria_subnode_consume(struct oval_criteria_node *subnode, void *criteria)
 {
 	oval_criteria_node_add_subnode((struct oval_criteria_node *) criteria, subnode);
@@ -32,8 +32,11 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <sys/stat.h>
 
 #include "oval_definitions_impl.h"
 #include "oval_agent_api_impl.h"
@@ -41,6 +44,8 @@
 #include "adt/oval_string_map_impl.h"
 #include "oval_system_characteristics_impl.h"
 #include "oval_probe_impl.h"
+#include "oval_xml_stream_impl.h"
+#include "oval_image_impl.h"
 #include "common/util.h"
 #include "common/debug_priv.h"
 #include "common/_error.h"
@@ -58,8 +63,13 @@ typedef struct oval_definition_model {
 	struct oval_collection *bound_variable_models;
         char *schema;
 	struct oval_string_map *vardef_map;		///< look-up table for efficient @variable_instance processing
+	unsigned int variable_generation;		///< bumped whenever values of external variables change
+	size_t component_values_max;			///< limit on the number of values a function may produce
 } oval_definition_model_t;
 
+#define OVAL_COMPONENT_VALUES_MAX_ENV "OSCAP_OVAL_VALUES_MAX"
+#define OVAL_COMPONENT_VALUES_MAX 1000000
+
 /* failed   - NULL
  * success  - oval_definition_model
  * */
@@ -78,6 +88,10 @@ struct oval_definition_model *oval_definition_model_new()
 	newmodel->bound_variable_models = NULL;
         newmodel->schema = strdup(OVAL_DEF_SCHEMA_LOCATION);
 	newmodel->vardef_map = NULL;
+	newmodel->variable_generation = 0;
+	newmodel->component_values_max = OVAL_COMPONENT_VALUES_MAX;
+	if (getenv(OVAL_COMPONENT_VALUES_MAX_ENV) != NULL)
+		newmodel->component_values_max = strtoul(getenv(OVAL_COMPONENT_VALUES_MAX_ENV), NULL, 10);
 
 	return newmodel;
 }
@@ -118,6 +132,7 @@ struct oval_definition_model *oval_definition_model_clone(struct oval_definition
 	    (oldmodel->variable_map, newmodel, (_oval_clone_func) oval_variable_clone);
         newmodel->schema = oscap_strdup(oldmodel->schema);
 	newmodel->vardef_map = NULL;
+	newmodel->component_values_max = oldmodel->component_values_max;
 	return newmodel;
 }
 
@@ -229,7 +244,7 @@ void oval_definition_model_add_variable(struct oval_definition_model *model, str
 	oval_string_map_put(model->variable_map, key, (void *)variable);
 }
 
-static inline int _oval_definition_model_merge_source(struct oval_definition_model *model, struct oscap_source *source)
+static inline int _oval_definition_model_merge_source(struct oval_definition_model *model, struct oscap_source *source, struct oval_parser_selection *selection)
 {
 	/* setup context */
 	struct oval_parser_context context;
@@ -238,7 +253,7 @@ static inline int _oval_definition_model_merge_source(struct oval_definition_mod
 		return -1;
 	}
 	context.definition_model = model;
-	context.user_data = NULL;
+	context.user_data = selection;
 	/* jump into oval_definitions */
 	while (xmlTextReaderRead(context.reader) == 1
 		&& xmlTextReaderNodeType(context.reader) != XML_READER_TYPE_ELEMENT) ;
@@ -250,8 +265,15 @@ static inline int _oval_definition_model_merge_source(struct oval_definition_mod
 
 struct oval_definition_model *oval_definition_model_import_source(struct oscap_source *source)
 {
+	const char *image_dir = getenv(OVAL_IMAGE_DIR_ENV);
+	if (image_dir != NULL) {
+		struct oval_definition_model *model = oval_definition_model_load_image(source, image_dir, NULL);
+		if (model != NULL)
+			return model;
+	}
+
         struct oval_definition_model *model = oval_definition_model_new();
-	int ret = _oval_definition_model_merge_source(model, source);
+	int ret = _oval_definition_model_merge_source(model, source, NULL);
         if (ret == -1 ) {
                 oval_definition_model_free(model);
                 model = NULL;
@@ -259,6 +281,136 @@ struct oval_definition_model *oval_definition_model_import_source(struct oscap_s
 	return model;
 }
 
+struct oval_definition_model *oval_definition_model_import_source_selected(struct oscap_source *source, struct oscap_stringlist *definitions)
+{
+	struct oval_definition_model *model;
+	struct oval_parser_selection *selection;
+	struct oscap_string_iterator *def_it;
+	xmlDoc *doc;
+	int ret;
+
+	__attribute__nonnull__(definitions);
+
+	doc = oscap_source_get_xmlDoc(source);
+	if (doc == NULL)
+		return NULL;
+
+	def_it = oscap_stringlist_get_strings(definitions);
+	selection = oval_definition_model_select(doc, def_it);
+	oscap_string_iterator_free(def_it);
+	if (selection == NULL)
+		return NULL;
+
+	model = oval_definition_model_new();
+	ret = _oval_definition_model_merge_source(model, source, selection);
+	oval_parser_selection_free(selection);
+	if (ret == -1) {
+		oval_definition_model_free(model);
+		model = NULL;
+	}
+	return model;
+}
+
+typedef void (*_oval_image_writer) (void *, struct oval_image *);
+typedef void (*_oval_image_reader) (struct oval_image *, struct oval_definition_model *);
+
+static void _oval_definition_model_to_image(struct oval_string_map *map, struct oval_image *image, _oval_image_writer writer)
+{
+	struct oval_iterator *items = oval_string_map_values(map);
+
+	oval_image_put_count(image, oval_collection_iterator_remaining(items));
+	while (oval_collection_iterator_has_more(items))
+		(*writer) (oval_collection_iterator_next(items), image);
+	oval_collection_iterator_free(items);
+}
+
+static void _oval_definition_model_from_image(struct oval_image *image, struct oval_definition_model *model, _oval_image_reader reader)
+{
+	size_t i, count = oval_image_get_count(image);
+
+	for (i = 0; i < count && oval_image_is_valid(image); ++i)
+		(*reader) (image, model);
+}
+
+int oval_definition_model_save_image(struct oval_definition_model *model, struct oscap_source *source, const char *dir, uint32_t flags)
+{
+	__attribute__nonnull__(model);
+
+	char *path = oval_image_path(source, dir);
+	if (path == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Can't build an OVAL image of '%s', "
+				"only documents read from a file or memory have one.",
+				oscap_source_readable_origin(source));
+		return -1;
+	}
+	if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't create the OVAL image directory '%s': %s", dir, strerror(errno));
+		oscap_free(path);
+		return -1;
+	}
+
+	struct oval_image *image = oval_image_new();
+	oval_generator_to_image(model->generator, image);
+	_oval_definition_model_to_image(model->definition_map, image, (_oval_image_writer) oval_definition_to_image);
+	_oval_definition_model_to_image(model->test_map, image, (_oval_image_writer) oval_test_to_image);
+	_oval_definition_model_to_image(model->object_map, image, (_oval_image_writer) oval_object_to_image);
+	_oval_definition_model_to_image(model->state_map, image, (_oval_image_writer) oval_state_to_image);
+	_oval_definition_model_to_image(model->variable_map, image, (_oval_image_writer) oval_variable_to_image);
+
+	int ret = oval_image_save(image, path, flags);
+	oval_image_free(image);
+	oscap_free(path);
+	return ret;
+}
+
+struct oval_definition_model *oval_definition_model_load_image(struct oscap_source *source, const char *dir, uint32_t *flags)
+{
+	struct oval_definition_model *model;
+	struct oval_image *image;
+	char *path;
+
+	if ((path = oval_image_path(source, dir)) == NULL)
+		return NULL;
+	image = oval_image_open(path);
+	if (image == NULL) {
+		dI("No OVAL image '%s' for '%s'.", path, oscap_source_readable_origin(source));
+		oscap_free(path);
+		return NULL;
+	}
+
+	model = oval_definition_model_new();
+	oval_generator_from_image(model->generator, image);
+	_oval_definition_model_from_image(image, model, oval_definition_from_image);
+	_oval_definition_model_from_image(image, model, oval_test_from_image);
+	_oval_definition_model_from_image(image, model, oval_object_from_image);
+	_oval_definition_model_from_image(image, model, oval_state_from_image);
+	_oval_definition_model_from_image(image, model, oval_variable_from_image);
+
+	if (!oval_image_is_valid(image)) {
+		dW("OVAL image '%s' is corrupted, ignoring it.", path);
+		oval_definition_model_free(model);
+		model = NULL;
+	} else {
+		dI("Loaded the OVAL Definitions of '%s' from the image '%s'.",
+		   oscap_source_readable_origin(source), path);
+		if (flags != NULL)
+			*flags = oval_image_get_flags(image);
+	}
+	oval_image_free(image);
+	oscap_free(path);
+	return model;
+}
+
+int oval_definition_model_export_image(struct oval_definition_model *model, struct oscap_source *source, const char *dir)
+{
+	return oval_definition_model_save_image(model, source, dir, 0);
+}
+
+struct oval_definition_model *oval_definition_model_import_image(struct oscap_source *source, const char *dir)
+{
+	return oval_definition_model_load_image(source, dir, NULL);
+}
+
 struct oval_definition_model * oval_definition_model_import(const char *file)
 {
 	struct oscap_source *source = oscap_source_new_from_file(file);
@@ -274,7 +426,7 @@ int oval_definition_model_merge(struct oval_definition_model *model, const char
 	int ret;
 
 	struct oscap_source *source = oscap_source_new_from_file(file);
-	ret = _oval_definition_model_merge_source(model, source);
+	ret = _oval_definition_model_merge_source(model, source, NULL);
 
 	oscap_source_free(source);
 
@@ -368,6 +520,35 @@ void oval_definition_model_clear_external_variables(struct oval_definition_model
 		oval_variable_clear_values(var);
 	}
 	oval_variable_iterator_free(vars_itr);
+	oval_definition_model_bump_variable_generation(model);
+}
+
+void oval_definition_model_bump_variable_generation(struct oval_definition_model *model)
+{
+	__attribute__nonnull__(model);
+
+	++model->variable_generation;
+}
+
+unsigned int oval_definition_model_get_variable_generation(struct oval_definition_model *model)
+{
+	__attribute__nonnull__(model);
+
+	return model->variable_generation;
+}
+
+void oval_definition_model_set_component_values_max(struct oval_definition_model *model, size_t max)
+{
+	__attribute__nonnull__(model);
+
+	model->component_values_max = max;
+}
+
+size_t oval_definition_model_get_component_values_max(struct oval_definition_model *model)
+{
+	__attribute__nonnull__(model);
+
+	return model->component_values_max;
 }
 
 struct oval_definition_iterator *oval_definition_model_get_definitions(struct oval_definition_model
@@ -506,6 +687,7 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	xmlSetNs(root_node, ns_lin);
 	xmlSetNs(root_node, ns_win);
 	xmlSetNs(root_node, ns_defntns);
+	oval_xml_stream_open(doc, root_node);
 
 	/* Always report the generator */
 	oval_generator_to_dom(definition_model->generator, doc, root_node);
@@ -518,9 +700,12 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 			struct oval_definition *definition = oval_definition_iterator_next(definitions);
 			if (definitions_node == NULL) {
 				definitions_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "definitions", NULL);
+				oval_xml_stream_open(doc, definitions_node);
 			}
 			oval_definition_to_dom(definition, doc, definitions_node);
+			oval_xml_stream_flush(doc, definitions_node);
 		}
+		oval_xml_stream_close(doc, definitions_node);
 	}
         oval_definition_iterator_free(definitions);
 
@@ -528,10 +713,13 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	struct oval_test_iterator *tests = oval_definition_model_get_tests(definition_model);
 	if (oval_test_iterator_has_more(tests)) {
 		xmlNode *tests_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "tests", NULL);
+		oval_xml_stream_open(doc, tests_node);
 		while (oval_test_iterator_has_more(tests)) {
 			struct oval_test *test = oval_test_iterator_next(tests);
 			oval_test_to_dom(test, doc, tests_node);
+			oval_xml_stream_flush(doc, tests_node);
 		}
+		oval_xml_stream_close(doc, tests_node);
 	}
 	oval_test_iterator_free(tests);
 
@@ -539,13 +727,16 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	struct oval_object_iterator *objects = oval_definition_model_get_objects(definition_model);
 	if (oval_object_iterator_has_more(objects)) {
 		xmlNode *objects_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "objects", NULL);
+		oval_xml_stream_open(doc, objects_node);
 		while(oval_object_iterator_has_more(objects)) {
 			struct oval_object *object = oval_object_iterator_next(objects);
 			if (oval_object_get_base_obj(object))
 				/* Skip internal objects */
 				continue;
 			oval_object_to_dom(object, doc, objects_node);
+			oval_xml_stream_flush(doc, objects_node);
 		}
+		oval_xml_stream_close(doc, objects_node);
 	}
 	oval_object_iterator_free(objects);
 
@@ -553,10 +744,13 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	struct oval_state_iterator *states = oval_definition_model_get_states(definition_model);
 	if (oval_state_iterator_has_more(states)) {
 		xmlNode *states_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "states", NULL);
+		oval_xml_stream_open(doc, states_node);
 		while (oval_state_iterator_has_more(states)) {
 			struct oval_state *state = oval_state_iterator_next(states);
 			oval_state_to_dom(state, doc, states_node);
+			oval_xml_stream_flush(doc, states_node);
 		}
+		oval_xml_stream_close(doc, states_node);
 	}
 	oval_state_iterator_free(states);
 
@@ -564,13 +758,17 @@ xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_m
 	struct oval_variable_iterator *variables = oval_definition_model_get_variables(definition_model);
 	if (oval_variable_iterator_has_more(variables)) {
 		xmlNode *variables_node = xmlNewTextChild(root_node, ns_defntns, BAD_CAST "variables", NULL);
+		oval_xml_stream_open(doc, variables_node);
 		while (oval_variable_iterator_has_more(variables)) {
 			struct oval_variable *variable = oval_variable_iterator_next(variables);
 			oval_variable_to_dom(variable, doc, variables_node);
+			oval_xml_stream_flush(doc, variables_node);
 		}
+		oval_xml_stream_close(doc, variables_node);
 	}
 	oval_variable_iterator_free(variables);
 
+	oval_xml_stream_close(doc, root_node);
 	return root_node;
 }
 
@@ -586,9 +784,15 @@ int oval_definition_model_export(struct oval_definition_model *model, const char
 		oscap_setxmlerr(xmlGetLastError());
 		return -1;
 	}
+	if (oval_xml_stream_start(doc, file) != 0) {
+		xmlFreeDoc(doc);
+		return -1;
+	}
 
 	oval_definition_model_to_dom(model, doc, NULL);
-	return oscap_xml_save_filename_free(file, doc);
+	int ret = oval_xml_stream_finish(doc);
+	xmlFreeDoc(doc);
+	return (ret == 0) ? 1 : -1;
 }
 
 static void _fp_set_recurse(struct oval_definition_model *model, struct oval_setobject *set, char *set_id)
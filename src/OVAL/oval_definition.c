@@ -547,6 +547,67 @@ xmlNode *oval_definition_to_dom(struct oval_definition *definition, xmlDoc * doc
 	return definition_node;
 }
 
+void oval_definition_to_image(struct oval_definition *definition, struct oval_image *image)
+{
+	oval_image_put_string(image, definition->id);
+	oval_image_put_int(image, definition->version);
+	oval_image_put_int(image, definition->class);
+	oval_image_put_int(image, definition->deprecated);
+	oval_image_put_string(image, definition->title);
+	oval_image_put_string(image, definition->description);
+
+	oval_image_put_count(image, oval_collection_size(definition->affected));
+	struct oval_affected_iterator *affecteds = oval_definition_get_affected(definition);
+	while (oval_affected_iterator_has_more(affecteds))
+		oval_affected_to_image(oval_affected_iterator_next(affecteds), image);
+	oval_affected_iterator_free(affecteds);
+
+	oval_image_put_count(image, oval_collection_size(definition->reference));
+	struct oval_reference_iterator *references = oval_definition_get_references(definition);
+	while (oval_reference_iterator_has_more(references))
+		oval_reference_to_image(oval_reference_iterator_next(references), image);
+	oval_reference_iterator_free(references);
+
+	oval_image_put_count(image, oval_collection_size(definition->notes));
+	struct oval_string_iterator *notes = oval_definition_get_notes(definition);
+	while (oval_string_iterator_has_more(notes))
+		oval_image_put_string(image, oval_string_iterator_next(notes));
+	oval_string_iterator_free(notes);
+
+	oval_image_put_string(image, definition->anyxml);
+	oval_image_put_int(image, definition->criteria != NULL);
+	if (definition->criteria != NULL)
+		oval_criteria_node_to_image(definition->criteria, image);
+}
+
+void oval_definition_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_definition *definition = oval_definition_model_get_new_definition(model, oval_image_get_string(image));
+	size_t i, count;
+
+	definition->version = oval_image_get_int(image);
+	definition->class = oval_image_get_int(image);
+	definition->deprecated = oval_image_get_int(image);
+	definition->title = oval_image_dup_string(image);
+	definition->description = oval_image_dup_string(image);
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_definition_add_affected(definition, oval_affected_from_image(image, model));
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_definition_add_reference(definition, oval_reference_from_image(image, model));
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_definition_add_note(definition, oval_image_dup_string(image));
+
+	definition->anyxml = oval_image_dup_string(image);
+	if (oval_image_get_int(image))
+		definition->criteria = oval_criteria_node_from_image(image, model);
+}
+
 const char * oval_definition_model_supported(void)
 {
         return OVAL_SUPPORTED;
@@ -35,6 +35,7 @@
 #include "public/oval_system_characteristics.h"
 #include "oval_parser_impl.h"
 #include "adt/oval_string_map_impl.h"
+#include "oval_image_impl.h"
 #include "../common/util.h"
 
 OSCAP_HIDDEN_START;
@@ -69,23 +70,35 @@ const char *oval_definition_class_text(oval_definition_class_t);
 
 typedef void (*oval_affected_consumer) (struct oval_affected *, void *);
 int oval_affected_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, oval_affected_consumer, void *);
+void oval_affected_to_image(struct oval_affected *, struct oval_image *);
+struct oval_affected *oval_affected_from_image(struct oval_image *, struct oval_definition_model *);
 
 char *oval_test_get_state_names(struct oval_test *test);
 int oval_test_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, void *);
 xmlNode *oval_test_to_dom(struct oval_test *, xmlDoc *, xmlNode *);
+void oval_test_to_image(struct oval_test *, struct oval_image *);
+void oval_test_from_image(struct oval_image *, struct oval_definition_model *);
 
 typedef void (*oval_criteria_consumer) (struct oval_criteria_node *, void *);
 xmlNode *oval_criteria_node_to_dom(struct oval_criteria_node *, xmlDoc *, xmlNode *);
 int oval_criteria_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_criteria_consumer, void *);
+void oval_criteria_node_to_image(struct oval_criteria_node *, struct oval_image *);
+struct oval_criteria_node *oval_criteria_node_from_image(struct oval_image *, struct oval_definition_model *);
 
 typedef void (*oval_reference_consumer) (struct oval_reference *, void *);
 int oval_reference_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_reference_consumer, void *);
+void oval_reference_to_image(struct oval_reference *, struct oval_image *);
+struct oval_reference *oval_reference_from_image(struct oval_image *, struct oval_definition_model *);
 
 int oval_definition_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, void *);
 xmlNode *oval_definition_to_dom(struct oval_definition *, xmlDoc *, xmlNode *);
+void oval_definition_to_image(struct oval_definition *, struct oval_image *);
+void oval_definition_from_image(struct oval_image *, struct oval_definition_model *);
 
 int oval_object_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, void *);
 xmlNode *oval_object_to_dom(struct oval_object *, xmlDoc *, xmlNode *);
+void oval_object_to_image(struct oval_object *, struct oval_image *);
+void oval_object_from_image(struct oval_image *, struct oval_definition_model *);
 struct oval_object *oval_object_clone2(struct oval_definition_model *, struct oval_object *, char *);
 struct oval_object *oval_object_create_internal(struct oval_object *, char *);
 struct oval_object *oval_object_get_base_obj(struct oval_object *);
@@ -94,9 +107,13 @@ OSCAP_DEPRECATED(oval_version_t oval_state_get_schema_version(const struct oval_
 oval_schema_version_t oval_state_get_platform_schema_version(const struct oval_state *state);
 int oval_state_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, void *);
 xmlNode *oval_state_to_dom(struct oval_state *, xmlDoc *, xmlNode *);
+void oval_state_to_image(struct oval_state *, struct oval_image *);
+void oval_state_from_image(struct oval_image *, struct oval_definition_model *);
 
 int oval_variable_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, void *);
 xmlNode *oval_variable_to_dom(struct oval_variable *, xmlDoc *, xmlNode *);
+void oval_variable_to_image(struct oval_variable *, struct oval_image *);
+void oval_variable_from_image(struct oval_image *, struct oval_definition_model *);
 
 typedef void (*oval_variable_binding_consumer) (struct oval_variable_binding *, void *);
 void oval_variable_binding_to_dom(struct oval_variable_binding *, xmlDoc *, xmlNode *);
@@ -107,45 +124,65 @@ const char *oval_variable_type_get_text(oval_variable_type_t);
 typedef void (*oval_filter_consumer) (struct oval_filter *, void *);
 int oval_filter_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_filter_consumer, void *);
 xmlNode *oval_filter_to_dom(struct oval_filter *, xmlDoc *, xmlNode *);
+void oval_filter_to_image(struct oval_filter *, struct oval_image *);
+struct oval_filter *oval_filter_from_image(struct oval_image *, struct oval_definition_model *);
 
 typedef void (*oval_object_content_consumer) (struct oval_object_content *, void *);
 xmlNode *oval_object_content_to_dom(struct oval_object_content *, xmlDoc *, xmlNode *);
 int oval_object_content_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_object_content_consumer, void *);
+void oval_object_content_to_image(struct oval_object_content *, struct oval_image *);
+struct oval_object_content *oval_object_content_from_image(struct oval_image *, struct oval_definition_model *);
 
 int oval_state_content_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oscap_consumer_func, void *);
 xmlNode *oval_state_content_to_dom(struct oval_state_content *, xmlDoc *, xmlNode *);
+void oval_state_content_to_image(struct oval_state_content *, struct oval_image *);
+struct oval_state_content *oval_state_content_from_image(struct oval_image *, struct oval_definition_model *);
 
 typedef void (*oval_behavior_consumer) (struct oval_behavior *, void *);
 int oval_behavior_parse_tag(xmlTextReaderPtr, struct oval_parser_context *,
 			    oval_family_t, oval_behavior_consumer, void *);
+void oval_behavior_to_image(struct oval_behavior *, struct oval_image *);
+struct oval_behavior *oval_behavior_from_image(struct oval_image *, struct oval_definition_model *);
 
 int oval_entity_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oscap_consumer_func, void *);
 xmlNode *oval_entity_to_dom(struct oval_entity *, xmlDoc *, xmlNode *);
+void oval_entity_to_image(struct oval_entity *, struct oval_image *);
+struct oval_entity *oval_entity_from_image(struct oval_image *, struct oval_definition_model *);
 
 int oval_record_field_parse_tag(xmlTextReaderPtr, struct oval_parser_context *,
 				oscap_consumer_func, void *, oval_record_field_type_t);
 xmlNode *oval_record_field_to_dom(struct oval_record_field *, bool, xmlDoc *, xmlNode *, xmlNs *);
+void oval_record_field_to_image(struct oval_record_field *, struct oval_image *);
+struct oval_record_field *oval_record_field_from_image(struct oval_image *, struct oval_definition_model *);
 
 typedef void (*oval_set_consumer) (struct oval_setobject *, void *);
 int oval_set_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_set_consumer, void *);
 xmlNode *oval_set_to_dom(struct oval_setobject *, xmlDoc *, xmlNode *);
+void oval_setobject_to_image(struct oval_setobject *, struct oval_image *);
+struct oval_setobject *oval_setobject_from_image(struct oval_image *, struct oval_definition_model *);
 void oval_set_propagate_filters(struct oval_definition_model *, struct oval_setobject *, char *);
 
 typedef void (*oval_value_consumer) (struct oval_value *, void *);
 int oval_value_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_value_consumer, void *);
 xmlNode *oval_value_to_dom(struct oval_value *, xmlDoc *, xmlNode *);
+void oval_value_to_image(struct oval_value *, struct oval_image *);
+struct oval_value *oval_value_from_image(struct oval_image *);
 int oval_value_cast(struct oval_value *value, oval_datatype_t new_dt);
 
 oval_syschar_collection_flag_t oval_component_compute(struct oval_syschar_model *sysmod, struct oval_component *component,
-						      struct oval_collection *value_collection);
+						      struct oval_collection *value_collection, bool *values_max_exceeded);
 oval_syschar_collection_flag_t oval_component_query(oval_probe_session_t *sess, struct oval_component *component,
-						    struct oval_collection *value_collection);
+						    struct oval_collection *value_collection, bool *values_max_exceeded);
+/* True if a function of the local variable exceeded the component values limit. */
+bool oval_variable_values_max_exceeded(struct oval_variable *variable);
 
 int oval_probe_session_query_object(oval_probe_session_t *sess, struct oval_object *object);
 
 typedef void (*oval_component_consumer) (struct oval_component *, void *);
 int oval_component_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_component_consumer, void *);
 xmlNode *oval_component_to_dom(struct oval_component *, xmlDoc *, xmlNode *);
+void oval_component_to_image(struct oval_component *, struct oval_image *);
+struct oval_component *oval_component_from_image(struct oval_image *, struct oval_definition_model *);
 
 /* message */
 typedef void (*oval_message_consumer) (struct oval_message *, void *);
@@ -155,10 +192,15 @@ void oval_message_to_dom(struct oval_message *, xmlDoc *, xmlNode *);
 /* generator */
 int oval_generator_parse_tag(xmlTextReader *, struct oval_parser_context *, void *user);
 xmlNode *oval_generator_to_dom(struct oval_generator *, xmlDocPtr, xmlNode *);
+void oval_generator_to_image(struct oval_generator *, struct oval_image *);
+void oval_generator_from_image(struct oval_generator *, struct oval_image *);
 
 /* definition_model */
 xmlNode *oval_definition_model_to_dom(struct oval_definition_model *definition_model, xmlDocPtr doc, xmlNode * parent);
 void oval_definition_model_optimize_by_filter_propagation(struct oval_definition_model *);
+/* OVAL images, see oval_image_impl.h */
+int oval_definition_model_save_image(struct oval_definition_model *model, struct oscap_source *source, const char *dir, uint32_t flags);
+struct oval_definition_model *oval_definition_model_load_image(struct oscap_source *source, const char *dir, uint32_t *flags);
 
 struct oval_definition *oval_definition_model_get_new_definition(struct oval_definition_model *, const char *);
 struct oval_test       *oval_definition_model_get_new_test(struct oval_definition_model *, const char *);
@@ -179,6 +221,11 @@ oval_schema_version_t oval_definition_model_get_platform_schema_version(struct o
 
 struct oval_string_map *oval_definition_model_build_vardef_mapping(struct oval_definition_model *model);
 struct oval_string_iterator *oval_definition_model_get_definitions_dependent_on_variable(struct oval_definition_model *model, struct oval_variable *variable);
+/* Values of local variables are memoized per generation of the external
+ * variable bindings, a new generation starts when the bindings change. */
+void oval_definition_model_bump_variable_generation(struct oval_definition_model *model);
+unsigned int oval_definition_model_get_variable_generation(struct oval_definition_model *model);
+size_t oval_definition_model_get_component_values_max(struct oval_definition_model *model);
 
 /* variable model */
 struct oval_collection *oval_variable_model_get_values_ref(struct oval_variable_model *, char *);
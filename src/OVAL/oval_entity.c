@@ -274,6 +274,40 @@ void oval_entity_set_name(struct oval_entity *entity, char *name)
 	entity->name = (name == NULL) ? NULL : oscap_strdup(name);
 }
 
+void oval_entity_to_image(struct oval_entity *entity, struct oval_image *image)
+{
+	oval_image_put_int(image, entity->type);
+	oval_image_put_int(image, entity->datatype);
+	oval_image_put_int(image, entity->operation);
+	oval_image_put_int(image, entity->mask);
+	oval_image_put_int(image, entity->varref_type);
+	oval_image_put_int(image, entity->xsi_nil);
+	oval_image_put_string(image, entity->name);
+	oval_image_put_string(image, entity->variable ? oval_variable_get_id(entity->variable) : NULL);
+	oval_image_put_int(image, entity->value != NULL);
+	if (entity->value != NULL)
+		oval_value_to_image(entity->value, image);
+}
+
+struct oval_entity *oval_entity_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_entity *entity = oval_entity_new(model);
+	const char *varref;
+
+	entity->type = oval_image_get_int(image);
+	entity->datatype = oval_image_get_int(image);
+	entity->operation = oval_image_get_int(image);
+	entity->mask = oval_image_get_int(image);
+	entity->varref_type = oval_image_get_int(image);
+	entity->xsi_nil = oval_image_get_int(image);
+	entity->name = oval_image_dup_string(image);
+	if ((varref = oval_image_get_string(image)) != NULL)
+		entity->variable = oval_definition_model_get_new_variable(model, varref, OVAL_VARIABLE_UNKNOWN);
+	if (oval_image_get_int(image))
+		entity->value = oval_value_from_image(image);
+	return entity;
+}
+
 static void oval_consume_varref(char *varref, void *user)
 {
 
@@ -86,6 +86,23 @@ struct oval_filter *oval_filter_clone(struct oval_definition_model *new_model,
 	return new_filter;
 }
 
+void oval_filter_to_image(struct oval_filter *filter, struct oval_image *image)
+{
+	oval_image_put_string(image, filter->state ? oval_state_get_id(filter->state) : NULL);
+	oval_image_put_int(image, filter->action);
+}
+
+struct oval_filter *oval_filter_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_filter *filter = oval_filter_new(model);
+	const char *state_ref = oval_image_get_string(image);
+
+	if (state_ref != NULL)
+		filter->state = oval_definition_model_get_new_state(model, state_ref);
+	filter->action = oval_image_get_int(image);
+	return filter;
+}
+
 bool oval_filter_iterator_has_more(struct oval_filter_iterator *oc_filter)
 {
 	return oval_collection_iterator_has_more((struct oval_iterator *) oc_filter);
@@ -176,6 +176,47 @@ void oval_generator_add_platform_schema_version(struct oval_generator *generator
 }
 
 
+void oval_generator_to_image(struct oval_generator *generator, struct oval_image *image)
+{
+	struct oscap_htable_iterator *sv_itr;
+
+	oval_image_put_string(image, generator->product_name);
+	oval_image_put_string(image, generator->product_version);
+	oval_image_put_string(image, generator->core_schema_version);
+	oval_image_put_string(image, generator->timestamp);
+	oval_image_put_string(image, generator->anyxml);
+
+	oval_image_put_count(image, generator->platform_schema_versions->itemcount);
+	sv_itr = oscap_htable_iterator_new(generator->platform_schema_versions);
+	while (oscap_htable_iterator_has_more(sv_itr)) {
+		const char *platform, *version;
+		oscap_htable_iterator_next_kv(sv_itr, &platform, (void **) &version);
+		oval_image_put_string(image, platform);
+		oval_image_put_string(image, version);
+	}
+	oscap_htable_iterator_free(sv_itr);
+}
+
+void oval_generator_from_image(struct oval_generator *generator, struct oval_image *image)
+{
+	size_t i, count;
+
+	oval_generator_set_product_name(generator, oval_image_get_string(image));
+	oval_generator_set_product_version(generator, oval_image_get_string(image));
+	oval_generator_set_core_schema_version(generator, oval_image_get_string(image));
+	oval_generator_set_timestamp(generator, oval_image_get_string(image));
+	oscap_free(generator->anyxml);
+	generator->anyxml = oval_image_dup_string(image);
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i) {
+		const char *platform = oval_image_get_string(image);
+		const char *version = oval_image_get_string(image);
+		if (platform != NULL)
+			oval_generator_add_platform_schema_version(generator, platform, version);
+	}
+}
+
 xmlNode *oval_generator_to_dom(struct oval_generator *generator, xmlDocPtr doc, xmlNode *parent)
 {
 	struct oscap_htable_iterator *sv_itr;
@@ -0,0 +1,398 @@
+/**
+ * @file oval_image.c
+ * \brief Open Vulnerability and Assessment Language
+ *
+ * See more details at http://oval.mitre.org/
+ */
+
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common/util.h"
+#include "common/_error.h"
+#include "common/debug_priv.h"
+#include "oscap.h"
+#include "source/oscap_source_priv.h"
+#include "adt/oval_string_map_impl.h"
+#include "probes/SEAP/MurmurHash3.h"
+#include "oval_image_impl.h"
+
+#define OVAL_IMAGE_MAGIC      "OSCAPOI"
+#define OVAL_IMAGE_VERSION    1
+#define OVAL_IMAGE_BYTE_ORDER 0x01020304
+
+/* MurmurHash3 takes an int length, longer buffers are hashed by blocks */
+#define OVAL_IMAGE_HASH_BLOCK (1 << 24)
+
+/*
+ * Image file layout: header, string table (NUL terminated strings),
+ * entity data.
+ */
+struct oval_image_hdr {
+	char     magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t flags;
+	uint32_t pad;
+	uint64_t string_count;
+	uint64_t strings_len;
+	uint64_t data_len;
+	uint64_t checksum[2];	///< hash of the string table and the data
+	char     oscap_version[32];
+};
+
+struct oval_image_buf {
+	char *mem;
+	size_t len;
+	size_t size;
+};
+
+struct oval_image {
+	/* writing */
+	struct oval_image_buf strings;
+	struct oval_image_buf data;
+	struct oval_string_map *index;	///< indices (+1) of the strings in the table
+	/* reading */
+	char *map;
+	size_t map_len;
+	const char **string_table;
+	const unsigned char *pos;
+	const unsigned char *end;
+	uint32_t flags;
+	bool error;
+
+	size_t string_count;
+};
+
+/*
+ * Running hash of a sequence of buffers, the first two words of the state
+ * hold the result.
+ */
+static void _oval_image_hash(uint64_t state[4], const void *buf, size_t len)
+{
+	const char *p = buf;
+
+	do {
+		size_t n = len < OVAL_IMAGE_HASH_BLOCK ? len : OVAL_IMAGE_HASH_BLOCK;
+
+		MurmurHash3_x64_128(p, (int) n, 0x0FA1, state + 2);
+		MurmurHash3_x64_128(state, 4 * sizeof(uint64_t), (uint32_t) n, state);
+		p += n;
+		len -= n;
+	} while (len > 0);
+}
+
+char *oval_image_path(struct oscap_source *source, const char *dir)
+{
+	uint64_t state[4] = { 0, 0, 0, 0 };
+	char *buffer;
+	size_t size;
+
+	if (oscap_source_get_origin_memory(source, &buffer, &size) != 0)
+		return NULL;
+
+	_oval_image_hash(state, buffer, size);
+	oscap_free(buffer);
+
+	return oscap_sprintf("%s/oval-%016"PRIx64"%016"PRIx64".img", dir, state[1], state[0]);
+}
+
+struct oval_image *oval_image_new(void)
+{
+	struct oval_image *image = oscap_calloc(1, sizeof(struct oval_image));
+
+	image->index = oval_string_map_new();
+	return image;
+}
+
+static void _oval_image_buf_append(struct oval_image_buf *buf, const void *mem, size_t len)
+{
+	if (buf->len + len > buf->size) {
+		buf->size = buf->size == 0 ? 4096 : buf->size;
+		while (buf->len + len > buf->size)
+			buf->size *= 2;
+		buf->mem = oscap_realloc(buf->mem, buf->size);
+	}
+	memcpy(buf->mem + buf->len, mem, len);
+	buf->len += len;
+}
+
+static void _oval_image_put_uint(struct oval_image *image, uint64_t value)
+{
+	unsigned char bytes[10];
+	size_t n = 0;
+
+	while (value >= 0x80) {
+		bytes[n++] = (unsigned char) (value | 0x80);
+		value >>= 7;
+	}
+	bytes[n++] = (unsigned char) value;
+	_oval_image_buf_append(&image->data, bytes, n);
+}
+
+void oval_image_put_int(struct oval_image *image, long value)
+{
+	int64_t v = value;
+
+	/* zigzag, so that small negative numbers are short as well */
+	_oval_image_put_uint(image, ((uint64_t) v << 1) ^ (uint64_t) (v >> 63));
+}
+
+void oval_image_put_count(struct oval_image *image, size_t count)
+{
+	_oval_image_put_uint(image, count);
+}
+
+void oval_image_put_string(struct oval_image *image, const char *string)
+{
+	uintptr_t idx;
+
+	if (string == NULL) {
+		_oval_image_put_uint(image, 0);
+		return;
+	}
+
+	idx = (uintptr_t) oval_string_map_get_value(image->index, string);
+	if (idx == 0) {
+		_oval_image_buf_append(&image->strings, string, strlen(string) + 1);
+		idx = ++image->string_count;
+		oval_string_map_put(image->index, string, (void *) idx);
+	}
+	_oval_image_put_uint(image, idx);
+}
+
+int oval_image_save(struct oval_image *image, const char *path, uint32_t flags)
+{
+	struct oval_image_hdr hdr;
+	uint64_t state[4] = { 0, 0, 0, 0 };
+	char *tmp;
+	int fd, ret = -1;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, OVAL_IMAGE_MAGIC, sizeof(OVAL_IMAGE_MAGIC));
+	snprintf(hdr.oscap_version, sizeof(hdr.oscap_version), "%s", oscap_get_version());
+	hdr.version = OVAL_IMAGE_VERSION;
+	hdr.byte_order = OVAL_IMAGE_BYTE_ORDER;
+	hdr.flags = flags;
+	hdr.string_count = image->string_count;
+	hdr.strings_len = image->strings.len;
+	hdr.data_len = image->data.len;
+	_oval_image_hash(state, image->strings.mem, image->strings.len);
+	_oval_image_hash(state, image->data.mem, image->data.len);
+	hdr.checksum[0] = state[0];
+	hdr.checksum[1] = state[1];
+
+	/* readers never see a partially written image */
+	tmp = oscap_sprintf("%s.XXXXXX", path);
+	if ((fd = mkstemp(tmp)) < 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't create the OVAL image '%s': %s", tmp, strerror(errno));
+		oscap_free(tmp);
+		return -1;
+	}
+	fchmod(fd, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+
+	if (write(fd, &hdr, sizeof(hdr)) != (ssize_t) sizeof(hdr) ||
+	    write(fd, image->strings.mem, image->strings.len) != (ssize_t) image->strings.len ||
+	    write(fd, image->data.mem, image->data.len) != (ssize_t) image->data.len) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't write the OVAL image '%s': %s", tmp, strerror(errno));
+		goto out;
+	}
+
+	if (rename(tmp, path) != 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Can't rename '%s' to '%s': %s", tmp, path, strerror(errno));
+		goto out;
+	}
+
+	dI("Stored the OVAL image '%s' (%zu strings, %zu bytes).", path,
+	   image->string_count, sizeof(hdr) + image->strings.len + image->data.len);
+	ret = 0;
+out:
+	close(fd);
+	if (ret != 0)
+		unlink(tmp);
+	oscap_free(tmp);
+	return ret;
+}
+
+struct oval_image *oval_image_open(const char *path)
+{
+	struct oval_image *image;
+	struct oval_image_hdr *hdr;
+	uint64_t state[4] = { 0, 0, 0, 0 };
+	struct stat st;
+	const char *strings, *p;
+	char *map;
+	size_t i;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return NULL;
+
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(*hdr)) {
+		close(fd);
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	hdr = (struct oval_image_hdr *) map;
+	if (memcmp(hdr->magic, OVAL_IMAGE_MAGIC, sizeof(OVAL_IMAGE_MAGIC)) != 0 ||
+	    hdr->version != OVAL_IMAGE_VERSION ||
+	    hdr->byte_order != OVAL_IMAGE_BYTE_ORDER ||
+	    strncmp(hdr->oscap_version, oscap_get_version(), sizeof(hdr->oscap_version)) != 0 ||
+	    hdr->strings_len > (uint64_t) st.st_size ||
+	    hdr->data_len > (uint64_t) st.st_size ||
+	    sizeof(*hdr) + hdr->strings_len + hdr->data_len != (uint64_t) st.st_size ||
+	    hdr->string_count > hdr->strings_len) {
+		dI("OVAL image '%s': invalid header.", path);
+		munmap(map, st.st_size);
+		return NULL;
+	}
+
+	strings = map + sizeof(*hdr);
+	_oval_image_hash(state, strings, hdr->strings_len);
+	_oval_image_hash(state, strings + hdr->strings_len, hdr->data_len);
+	if (state[0] != hdr->checksum[0] || state[1] != hdr->checksum[1]) {
+		dW("OVAL image '%s': checksum mismatch.", path);
+		munmap(map, st.st_size);
+		return NULL;
+	}
+
+	image = oscap_calloc(1, sizeof(struct oval_image));
+	image->map = map;
+	image->map_len = st.st_size;
+	image->flags = hdr->flags;
+	image->string_count = hdr->string_count;
+	image->string_table = oscap_alloc((hdr->string_count + 1) * sizeof(char *));
+
+	p = strings;
+	for (i = 0; i < hdr->string_count; ++i) {
+		const char *nul = memchr(p, '\0', strings + hdr->strings_len - p);
+
+		if (nul == NULL)
+			break;
+		image->string_table[i] = p;
+		p = nul + 1;
+	}
+	if (i != hdr->string_count || p != strings + hdr->strings_len) {
+		dW("OVAL image '%s': invalid string table.", path);
+		oval_image_free(image);
+		return NULL;
+	}
+
+	image->pos = (const unsigned char *) strings + hdr->strings_len;
+	image->end = image->pos + hdr->data_len;
+	return image;
+}
+
+uint32_t oval_image_get_flags(const struct oval_image *image)
+{
+	return image->flags;
+}
+
+bool oval_image_is_valid(const struct oval_image *image)
+{
+	return !image->error;
+}
+
+void oval_image_free(struct oval_image *image)
+{
+	if (image == NULL)
+		return;
+
+	oscap_free(image->strings.mem);
+	oscap_free(image->data.mem);
+	if (image->index != NULL)
+		oval_string_map_free(image->index, NULL);
+	if (image->map != NULL)
+		munmap(image->map, image->map_len);
+	oscap_free(image->string_table);
+	oscap_free(image);
+}
+
+static uint64_t _oval_image_get_uint(struct oval_image *image)
+{
+	uint64_t value = 0;
+	int shift = 0;
+
+	while (image->pos < image->end && shift < 64) {
+		unsigned char byte = *image->pos++;
+
+		value |= (uint64_t) (byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+			return value;
+		shift += 7;
+	}
+	image->error = true;
+	return 0;
+}
+
+long oval_image_get_int(struct oval_image *image)
+{
+	uint64_t value = _oval_image_get_uint(image);
+
+	return (long) ((int64_t) (value >> 1) ^ -(int64_t) (value & 1));
+}
+
+size_t oval_image_get_count(struct oval_image *image)
+{
+	uint64_t count = _oval_image_get_uint(image);
+
+	/* every item takes a byte at least */
+	if (count > (uint64_t) (image->end - image->pos)) {
+		image->error = true;
+		return 0;
+	}
+	return count;
+}
+
+const char *oval_image_get_string(struct oval_image *image)
+{
+	uint64_t idx = _oval_image_get_uint(image);
+
+	if (idx == 0)
+		return NULL;
+	if (idx > image->string_count) {
+		image->error = true;
+		return NULL;
+	}
+	return image->string_table[idx - 1];
+}
+
+char *oval_image_dup_string(struct oval_image *image)
+{
+	return oscap_strdup(oval_image_get_string(image));
+}
@@ -0,0 +1,111 @@
+/**
+ * @file oval_image_impl.h
+ * \brief Open Vulnerability and Assessment Language
+ *
+ * See more details at http://oval.mitre.org/
+ */
+
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OVAL_IMAGE_IMPL_H
+#define OVAL_IMAGE_IMPL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "oscap_source.h"
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * Binary images of definition models.
+ *
+ * An image holds the entities of a definition model as they come out of the
+ * parser, so that the model can be rebuilt without parsing (and validating)
+ * the OVAL document again. Images are stored in a directory, named by the
+ * fingerprint of the document they were built from. An image is valid only
+ * for the same document and the same version of the library and the image
+ * format.
+ *
+ * The entities write and read their attributes by the *_to_image() and
+ * *_from_image() functions, in the same order. Integers are stored as
+ * variable length numbers, strings are stored once in a string table and
+ * referenced by their index. The image file is mapped to memory when read.
+ */
+
+/**
+ * Environment variable holding the image directory. Images are not looked
+ * up if it isn't set.
+ */
+#define OVAL_IMAGE_DIR_ENV "OSCAP_OVAL_IMAGE_DIR"
+
+/** The document was validated when the image was built */
+#define OVAL_IMAGE_VALIDATED 0x1
+
+struct oval_image;
+
+/**
+ * Compute the path of the image of a document.
+ * @return the path or NULL if the document has no fingerprint, which is
+ * the case of documents which don't originate from a file or a memory buffer
+ */
+char *oval_image_path(struct oscap_source *source, const char *dir);
+
+/**
+ * Start a new image to be written.
+ */
+struct oval_image *oval_image_new(void);
+
+/**
+ * Store the image to the file of given path, see oval_image_path().
+ * @param flags OVAL_IMAGE_* flags
+ * @return 0 on success, -1 on failure
+ */
+int oval_image_save(struct oval_image *image, const char *path, uint32_t flags);
+
+/**
+ * Open the image of given path for reading.
+ * @return the image or NULL if it doesn't exist or it isn't valid
+ */
+struct oval_image *oval_image_open(const char *path);
+
+uint32_t oval_image_get_flags(const struct oval_image *image);
+
+/**
+ * Check that everything read from the image was in bounds.
+ */
+bool oval_image_is_valid(const struct oval_image *image);
+
+void oval_image_free(struct oval_image *image);
+
+void oval_image_put_int(struct oval_image *image, long value);
+void oval_image_put_count(struct oval_image *image, size_t count);
+void oval_image_put_string(struct oval_image *image, const char *string);
+
+long oval_image_get_int(struct oval_image *image);
+/* Number of items which follow, bounded by the size of the image */
+size_t oval_image_get_count(struct oval_image *image);
+/* The string is owned by the image */
+const char *oval_image_get_string(struct oval_image *image);
+char *oval_image_dup_string(struct oval_image *image);
+
+OSCAP_HIDDEN_END;
+
+#endif
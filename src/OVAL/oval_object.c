@@ -305,6 +305,63 @@ void oval_object_add_behavior(struct oval_object *object, struct oval_behavior *
 	oval_collection_add(object->behaviors, (void *)behavior);
 }
 
+void oval_object_to_image(struct oval_object *object, struct oval_image *image)
+{
+	oval_image_put_string(image, object->id);
+	oval_image_put_int(image, object->subtype);
+	oval_image_put_string(image, object->base_obj_ref ? object->base_obj_ref->id : NULL);
+	oval_image_put_string(image, object->comment);
+	oval_image_put_int(image, object->deprecated);
+	oval_image_put_int(image, object->version);
+
+	oval_image_put_count(image, oval_collection_size(object->notes));
+	struct oval_string_iterator *notes = oval_object_get_notes(object);
+	while (oval_string_iterator_has_more(notes))
+		oval_image_put_string(image, oval_string_iterator_next(notes));
+	oval_string_iterator_free(notes);
+
+	oval_image_put_count(image, oval_collection_size(object->object_content));
+	struct oval_object_content_iterator *contents = oval_object_get_object_contents(object);
+	while (oval_object_content_iterator_has_more(contents))
+		oval_object_content_to_image(oval_object_content_iterator_next(contents), image);
+	oval_object_content_iterator_free(contents);
+
+	oval_image_put_count(image, oval_collection_size(object->behaviors));
+	struct oval_behavior_iterator *behaviors = oval_object_get_behaviors(object);
+	while (oval_behavior_iterator_has_more(behaviors))
+		oval_behavior_to_image(oval_behavior_iterator_next(behaviors), image);
+	oval_behavior_iterator_free(behaviors);
+}
+
+void oval_object_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_object *object = oval_definition_model_get_new_object(model, oval_image_get_string(image));
+	const char *base_id;
+	size_t i, count;
+
+	object->subtype = oval_image_get_int(image);
+	if ((base_id = oval_image_get_string(image)) != NULL)
+		object->base_obj_ref = oval_definition_model_get_new_object(model, base_id);
+	object->comment = oval_image_dup_string(image);
+	object->deprecated = oval_image_get_int(image);
+	object->version = oval_image_get_int(image);
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_collection_add(object->notes, oval_image_dup_string(image));
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i) {
+		struct oval_object_content *content = oval_object_content_from_image(image, model);
+		if (content != NULL)
+			oval_object_add_object_content(object, content);
+	}
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_object_add_behavior(object, oval_behavior_from_image(image, model));
+}
+
 static void oval_note_consume(char *text, void *object)
 {
 	oval_object_add_note(object, text);
@@ -314,6 +314,67 @@ void oval_object_content_set_filter(struct oval_object_content *content, struct
 }
 
 /*typedef void (*oval_object_content_consumer)(struct oval_object_content*,void*);*/
+void oval_object_content_to_image(struct oval_object_content *content, struct oval_image *image)
+{
+	oval_image_put_int(image, content->type);
+	oval_image_put_string(image, content->fieldName);
+
+	switch (content->type) {
+	case OVAL_OBJECTCONTENT_ENTITY:{
+			struct oval_object_content_ENTITY *entity = (oval_object_content_ENTITY_t *) content;
+			oval_image_put_int(image, entity->varCheck);
+			oval_image_put_int(image, entity->entity != NULL);
+			if (entity->entity != NULL)
+				oval_entity_to_image(entity->entity, image);
+		} break;
+	case OVAL_OBJECTCONTENT_SET:{
+			struct oval_object_content_SET *set = (oval_object_content_SET_t *) content;
+			oval_image_put_int(image, set->set != NULL);
+			if (set->set != NULL)
+				oval_setobject_to_image(set->set, image);
+		} break;
+	case OVAL_OBJECTCONTENT_FILTER:{
+			struct oval_object_content_FILTER *filter = (oval_object_content_FILTER_t *) content;
+			oval_image_put_int(image, filter->filter != NULL);
+			if (filter->filter != NULL)
+				oval_filter_to_image(filter->filter, image);
+		} break;
+	default:
+		break;
+	}
+}
+
+struct oval_object_content *oval_object_content_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	oval_object_content_type_t type = oval_image_get_int(image);
+	struct oval_object_content *content = oval_object_content_new(model, type);
+
+	if (content == NULL)
+		return NULL;
+
+	content->fieldName = oval_image_dup_string(image);
+
+	switch (type) {
+	case OVAL_OBJECTCONTENT_ENTITY:{
+			struct oval_object_content_ENTITY *entity = (oval_object_content_ENTITY_t *) content;
+			entity->varCheck = oval_image_get_int(image);
+			if (oval_image_get_int(image))
+				entity->entity = oval_entity_from_image(image, model);
+		} break;
+	case OVAL_OBJECTCONTENT_SET:
+		if (oval_image_get_int(image))
+			((oval_object_content_SET_t *) content)->set = oval_setobject_from_image(image, model);
+		break;
+	case OVAL_OBJECTCONTENT_FILTER:
+		if (oval_image_get_int(image))
+			((oval_object_content_FILTER_t *) content)->filter = oval_filter_from_image(image, model);
+		break;
+	default:
+		break;
+	}
+	return content;
+}
+
 static void oval_consume_entity(struct oval_entity *entity, void *content_entity)
 {
 	__attribute__nonnull__(entity);
@@ -31,6 +31,7 @@
 #include <config.h>
 #endif
 
+#include <ctype.h>
 #include <string.h>
 #include <libxml/xmlreader.h>
 #include <stddef.h>
@@ -147,6 +148,65 @@ char *oval_determine_document_schema_version(const char *document, oscap_documen
 	return ret;
 }
 
+/* The ID of an entity, without copying it */
+static const char *_oval_entity_id(const xmlNode *node)
+{
+	for (const xmlAttr *attr = node->properties; attr != NULL; attr = attr->next) {
+		if (attr->ns == NULL && strcmp((const char *) attr->name, "id") == 0)
+			return attr->children != NULL ? (const char *) attr->children->content : NULL;
+	}
+	return NULL;
+}
+
+/* The entities of a definitions document to be parsed */
+struct oval_parser_selection {
+	struct oval_string_map *index;	///< positions (+1) of the entities by their IDs
+	xmlNode **entities;		///< entities (elements in the sections) in document order
+	size_t count;			///< number of entities
+	bool *selected;			///< which entities, in document order, are to be parsed
+	size_t position;		///< position of the next entity to be parsed
+};
+
+/*
+ * Parse the entities of a definitions, tests, objects, states or variables
+ * section. When the context carries a selection, the entities which are not
+ * selected are skipped without being looked into.
+ * -1 error; 0 OK; 1 warning
+ */
+static int _oval_definition_model_parse_section(xmlTextReaderPtr reader, struct oval_parser_context *context, oval_xml_tag_parser tag_parser)
+{
+	struct oval_parser_selection *selection = (struct oval_parser_selection *) context->user_data;
+	int ret = 0;
+	int depth;
+
+	if (selection == NULL)
+		return oval_parser_parse_tag(reader, context, tag_parser, NULL);
+
+	depth = xmlTextReaderDepth(reader);
+	xmlTextReaderRead(reader);
+	while ((ret != -1) && (xmlTextReaderDepth(reader) > depth)) {
+		int next;
+
+		if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT) {
+			size_t position = selection->position++;
+
+			if (position < selection->count && selection->selected[position]) {
+				ret = (*tag_parser) (reader, context, NULL);
+				next = xmlTextReaderRead(reader);
+			} else {
+				next = xmlTextReaderNext(reader);
+			}
+		} else {
+			next = xmlTextReaderRead(reader);
+		}
+		if (next != 1) {
+			ret = -1;
+			break;
+		}
+	}
+	return ret;
+}
+
 /*
  * -1 error; 0 OK; 1 warning
  */
@@ -170,15 +230,15 @@ int oval_definition_model_parse(xmlTextReaderPtr reader, struct oval_parser_cont
 
 			int is_oval = strcmp((const char *)OVAL_DEFINITIONS_NAMESPACE, namespace) == 0;
 			if (is_oval && (strcmp(tagname, tagname_definitions) == 0)) {
-				ret = oval_parser_parse_tag(reader, context, &oval_definition_parse_tag, NULL);
+				ret = _oval_definition_model_parse_section(reader, context, &oval_definition_parse_tag);
 			} else if (is_oval && strcmp(tagname, tagname_tests) == 0) {
-				ret = oval_parser_parse_tag(reader, context, &oval_test_parse_tag, NULL);
+				ret = _oval_definition_model_parse_section(reader, context, &oval_test_parse_tag);
 			} else if (is_oval && strcmp(tagname, tagname_objects) == 0) {
-				ret =  oval_parser_parse_tag(reader, context, &oval_object_parse_tag, NULL);
+				ret = _oval_definition_model_parse_section(reader, context, &oval_object_parse_tag);
 			} else if (is_oval && strcmp(tagname, tagname_states) == 0) {
-				ret =  oval_parser_parse_tag(reader, context, &oval_state_parse_tag, NULL);
+				ret = _oval_definition_model_parse_section(reader, context, &oval_state_parse_tag);
 			} else if (is_oval && strcmp(tagname, tagname_variables) == 0) {
-				ret =  oval_parser_parse_tag(reader, context, &oval_variable_parse_tag, NULL);
+				ret = _oval_definition_model_parse_section(reader, context, &oval_variable_parse_tag);
 			} else if (is_oval && strcmp(tagname, tagname_generator) == 0) {
 				struct oval_generator *gen;
 				gen = oval_definition_model_get_generator(context->definition_model);
@@ -201,6 +261,141 @@ int oval_definition_model_parse(xmlTextReaderPtr reader, struct oval_parser_cont
 	return ret;
 }
 
+/* Is the text an OVAL ID of a definition, test, object, state or variable? */
+static bool _oval_is_entity_id(const char *text, size_t len)
+{
+	static const char *types[] = { "def", "tst", "obj", "ste", "var", NULL };
+	const char *num = text + len;
+
+	/* oval:<namespace>:<type>:<number> */
+	while (num > text && isdigit(num[-1]))
+		--num;
+	if (num == text + len || num - text < 11 || num[-1] != ':' || num[-5] != ':')
+		return false;
+	if (strncmp(text, "oval:", 5) != 0 || memchr(text + 5, ':', num - text - 10) != NULL)
+		return false;
+	for (int i = 0; types[i] != NULL; ++i) {
+		if (strncmp(num - 4, types[i], 3) == 0)
+			return true;
+	}
+	return false;
+}
+
+static void _oval_definition_model_select(struct oval_parser_selection *selection, const char *id);
+
+/* Select the entities referenced by the text of an attribute or text node */
+static void _oval_definition_model_select_text(struct oval_parser_selection *selection, const xmlChar *content)
+{
+	const char *text = (const char *) content;
+	size_t len;
+	char *id;
+
+	if (text == NULL)
+		return;
+	while (isspace(*text))
+		++text;
+	len = strlen(text);
+	while (len > 0 && isspace(text[len - 1]))
+		--len;
+	if (!_oval_is_entity_id(text, len))
+		return;
+
+	id = strndup(text, len);
+	_oval_definition_model_select(selection, id);
+	oscap_free(id);
+}
+
+/* Select the entities referenced from anywhere within the element */
+static void _oval_definition_model_select_refs(struct oval_parser_selection *selection, xmlNode *node)
+{
+	for (xmlAttr *attr = node->properties; attr != NULL; attr = attr->next) {
+		if (attr->children != NULL && attr->children->type == XML_TEXT_NODE)
+			_oval_definition_model_select_text(selection, attr->children->content);
+	}
+	for (xmlNode *child = node->children; child != NULL; child = child->next) {
+		if (child->type == XML_ELEMENT_NODE)
+			_oval_definition_model_select_refs(selection, child);
+		else if (child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE)
+			_oval_definition_model_select_text(selection, child->content);
+	}
+}
+
+static void _oval_definition_model_select(struct oval_parser_selection *selection, const char *id)
+{
+	size_t position = (size_t) oval_string_map_get_value(selection->index, id);
+
+	if (position == 0 || selection->selected[position - 1])
+		return;
+	selection->selected[position - 1] = true;
+	_oval_definition_model_select_refs(selection, selection->entities[position - 1]);
+}
+
+struct oval_parser_selection *oval_definition_model_select(xmlDoc *doc, struct oscap_string_iterator *definitions)
+{
+	static const char *sections[] = { "definitions", "tests", "objects", "states", "variables", NULL };
+	struct oval_parser_selection *selection;
+	xmlNode *root = xmlDocGetRootElement(doc);
+	size_t size = 0;
+
+	if (root == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Empty OVAL definitions document.");
+		return NULL;
+	}
+
+	/*
+	 * Index the entities by their IDs, in the order oval_definition_model_parse()
+	 * gets to them. Their content is not looked at.
+	 */
+	selection = oscap_calloc(1, sizeof(struct oval_parser_selection));
+	selection->index = oval_string_map_new();
+	for (xmlNode *section = root->children; section != NULL; section = section->next) {
+		int i;
+
+		if (section->type != XML_ELEMENT_NODE || section->ns == NULL ||
+		    strcmp((const char *) section->ns->href, (const char *) OVAL_DEFINITIONS_NAMESPACE) != 0)
+			continue;
+		for (i = 0; sections[i] != NULL && strcmp(sections[i], (const char *) section->name) != 0; ++i) ;
+		if (sections[i] == NULL)
+			continue;
+
+		for (xmlNode *entity = section->children; entity != NULL; entity = entity->next) {
+			const char *id;
+
+			if (entity->type != XML_ELEMENT_NODE)
+				continue;
+			if (selection->count == size) {
+				size = size ? 2 * size : 1024;
+				selection->entities = oscap_realloc(selection->entities, size * sizeof(xmlNode *));
+			}
+			selection->entities[selection->count++] = entity;
+			id = _oval_entity_id(entity);
+			if (id != NULL)
+				oval_string_map_put(selection->index, id, (void *) selection->count);
+		}
+	}
+	selection->selected = oscap_calloc(selection->count + 1, sizeof(bool));
+
+	/* only the requested definitions and what they depend on are looked into */
+	while (oscap_string_iterator_has_more(definitions)) {
+		const char *id = oscap_string_iterator_next(definitions);
+
+		if (oval_string_map_get_value(selection->index, id) == NULL)
+			dW("Definition '%s' is not in the OVAL document.", id);
+		_oval_definition_model_select(selection, id);
+	}
+	return selection;
+}
+
+void oval_parser_selection_free(struct oval_parser_selection *selection)
+{
+	if (selection == NULL)
+		return;
+	oval_string_map_free(selection->index, NULL);
+	oscap_free(selection->entities);
+	oscap_free(selection->selected);
+	oscap_free(selection);
+}
+
 /* -1 error; 0 OK */
 int oval_parser_skip_tag(xmlTextReaderPtr reader, struct oval_parser_context *context)
 {
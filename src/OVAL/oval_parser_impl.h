@@ -42,6 +42,8 @@ OSCAP_HIDDEN_START;
 #define OVAL_ROOT_ELM_SYSCHARS "oval_system_characteristics"
 #define OVAL_ROOT_ELM_VARIABLES "oval_variables"
 
+struct oval_parser_selection;
+
 struct oval_parser_context {
 	struct oval_definition_model *definition_model;
 	struct oval_syschar_model *syschar_model;
@@ -53,6 +55,17 @@ struct oval_parser_context {
 };
 
 int oval_definition_model_parse(xmlTextReaderPtr, struct oval_parser_context *);
+
+/**
+ * Find the given definitions and the tests, objects, states and variables
+ * they depend on, transitively, in a parsed OVAL definitions document.
+ * The selection, passed in the user_data of the context, makes
+ * oval_definition_model_parse() parse only these entities of the document.
+ * It is good for one parse.
+ */
+struct oval_parser_selection *oval_definition_model_select(xmlDoc *doc, struct oscap_string_iterator *definitions);
+void oval_parser_selection_free(struct oval_parser_selection *selection);
+
 int oval_syschar_model_parse(xmlTextReaderPtr, struct oval_parser_context *);
 int oval_results_model_parse(xmlTextReaderPtr , struct oval_parser_context *);
 
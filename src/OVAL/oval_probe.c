@@ -120,7 +120,12 @@ static int __n2s_tbl_cmp(const char *name, oval_subtypedsc_t *dsc)
  * registered with atexit().
  */
 probe_ncache_t  *OSCAP_GSYM(ncache) = NULL;
-struct id_desc_t OSCAP_GSYM(id_desc);
+struct id_desc_t OSCAP_GSYM(id_desc) = {
+#if !defined(HAVE_ATOMIC_FUNCTIONS)
+	.item_id_ctr_lock = PTHREAD_MUTEX_INITIALIZER,
+#endif
+	.item_id_ctr = 0
+};
 
 #if defined(OSCAP_THREAD_SAFE)
 # include <pthread.h>
@@ -227,23 +232,21 @@ static void _syschar_add_bindings(struct oval_syschar *sc, struct oval_string_ma
 	oval_collection_iterator_free(var_itr);
 }
 
-int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *object, int flags, struct oval_syschar **out_syschar)
+/*
+ * Find or create the syschar for the object. Returns 1 if the object
+ * doesn't need to be collected again, 2 if it was already sent to the
+ * probe but the probe may still be working on it, 0 otherwise.
+ */
+static int oval_probe_get_syschar(oval_probe_session_t *psess, struct oval_object *object, int flags, struct oval_syschar **out_syschar)
 {
 	char *oid;
 	struct oval_syschar *sysc;
-        oval_subtype_t type;
 	const char *type_name;
-        oval_ph_t *ph;
-	struct oval_string_map *vm;
 	struct oval_syschar_model *model;
-	int ret;
 
 	oid = oval_object_get_id(object);
 	model = psess->sys_model;
-
-	type = oval_object_get_subtype(object);
-	type_name = oval_subtype_get_text(type);
-	dI("Querying %s object '%s', flags: %u.", type_name, oid, flags);
+	type_name = oval_subtype_get_text(oval_object_get_subtype(object));
 
 	sysc = oval_syschar_model_get_syschar(model, oid);
 	if (sysc != NULL) {
@@ -259,10 +262,14 @@ int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *obj
 			const char *flag_text = oval_syschar_collection_flag_get_text(sc_flg);
 			dI("System characteristics for %s_object '%s' already exist, flag: %s.", type_name, oid, flag_text);
 
-			if (sc_flg != SYSCHAR_FLAG_UNKNOWN || (flags & OVAL_PDFLAG_NOREPLY)) {
-				if (out_syschar)
-					*out_syschar = sysc;
-				return 0;
+			if (sc_flg != SYSCHAR_FLAG_UNKNOWN) {
+				*out_syschar = sysc;
+				return 1;
+			}
+
+			if (flags & OVAL_PDFLAG_NOREPLY) {
+				*out_syschar = sysc;
+				return 2;
 			}
 		}
 	} else {
@@ -270,6 +277,40 @@ int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *obj
 		sysc = oval_syschar_new(model, object);
 	}
 
+	*out_syschar = sysc;
+	return 0;
+}
+
+static void oval_probe_add_bindings(struct oval_syschar *sysc)
+{
+	struct oval_string_map *vm;
+
+	vm = oval_string_map_new();
+	oval_obj_collect_var_refs(oval_syschar_get_object(sysc), vm);
+	_syschar_add_bindings(sysc, vm);
+	oval_string_map_free(vm, NULL);
+}
+
+static int _oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *object, int flags, struct oval_syschar **out_syschar)
+{
+	struct oval_syschar *sysc;
+        oval_subtype_t type;
+        oval_ph_t *ph;
+	int ret;
+
+	type = oval_object_get_subtype(object);
+	dI("Querying %s object '%s', flags: %u.", oval_subtype_get_text(type), oval_object_get_id(object), flags);
+
+	switch (oval_probe_get_syschar(psess, object, flags, &sysc)) {
+	case 1:
+		if (out_syschar)
+			*out_syschar = sysc;
+		return 0;
+	case 2:
+		flags |= OVAL_PDFLAG_INFLIGHT;
+		break;
+	}
+
 	if (out_syschar)
 		*out_syschar = sysc;
 
@@ -289,16 +330,106 @@ int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *obj
 		return ret;
 	}
 
-	if (!(flags & OVAL_PDFLAG_NOREPLY)) {
-		vm = oval_string_map_new();
-		oval_obj_collect_var_refs(object, vm);
-		_syschar_add_bindings(sysc, vm);
-		oval_string_map_free(vm, NULL);
-	}
+	if (!(flags & OVAL_PDFLAG_NOREPLY))
+		oval_probe_add_bindings(sysc);
 
 	return 0;
 }
 
+int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *object, int flags, struct oval_syschar **out_syschar)
+{
+	int ret;
+
+	pthread_mutex_lock(&psess->lock);
+	ret = _oval_probe_query_object(psess, object, flags, out_syschar);
+	pthread_mutex_unlock(&psess->lock);
+
+	return ret;
+}
+
+static int _oval_probe_query_object_async(oval_probe_session_t *psess, struct oval_object *object, int flags)
+{
+	struct oval_syschar *sysc;
+        oval_subtype_t type;
+        oval_ph_t *ph;
+	int ret;
+
+	type = oval_object_get_subtype(object);
+	dI("Submitting %s object '%s', flags: %u.", oval_subtype_get_text(type), oval_object_get_id(object), flags);
+
+	if (oval_probe_get_syschar(psess, object, flags, &sysc) != 0)
+		return 0;
+
+	ph = oval_probe_handler_get(psess->ph, type);
+
+        if (ph == NULL) {
+                char *msg = "OVAL object not supported.";
+
+		dW("%s", msg);
+		oval_syschar_add_new_message(sysc, msg, OVAL_MESSAGE_LEVEL_WARNING);
+		oval_syschar_set_flag(sysc, SYSCHAR_FLAG_NOT_COLLECTED);
+
+		return 1;
+        }
+
+	ret = ph->func(type, ph->uptr, PROBE_HANDLER_ACT_SUBMIT, sysc, flags);
+
+	switch (ret) {
+	case OVAL_PROBE_SUBMITTED:
+		return 0;
+	case 0:
+		if (!(flags & OVAL_PDFLAG_NOREPLY))
+			oval_probe_add_bindings(sysc);
+		return 0;
+	default:
+		return ret;
+	}
+}
+
+int oval_probe_query_object_async(oval_probe_session_t *psess, struct oval_object *object, int flags)
+{
+	int ret;
+
+	pthread_mutex_lock(&psess->lock);
+	ret = _oval_probe_query_object_async(psess, object, flags);
+	pthread_mutex_unlock(&psess->lock);
+
+	return ret;
+}
+
+static int _oval_probe_query_wait(oval_probe_session_t *psess, struct oval_syschar **out_syschar)
+{
+        oval_ph_t *ph;
+	struct oval_syschar *sysc = NULL;
+	int ret;
+
+	if ((ph = oval_probe_handler_get(psess->ph, OVAL_SUBTYPE_ALL)) == NULL) {
+		dE("No probe handler for OVAL_SUBTYPE_ALL");
+		return (-1);
+	}
+
+	ret = ph->func(OVAL_SUBTYPE_ALL, ph->uptr, PROBE_HANDLER_ACT_WAIT, &sysc, 0);
+
+	if (ret == 0)
+		oval_probe_add_bindings(sysc);
+
+	if (out_syschar)
+		*out_syschar = sysc;
+
+	return ret;
+}
+
+int oval_probe_query_wait(oval_probe_session_t *psess, struct oval_syschar **out_syschar)
+{
+	int ret;
+
+	pthread_mutex_lock(&psess->lock);
+	ret = _oval_probe_query_wait(psess, out_syschar);
+	pthread_mutex_unlock(&psess->lock);
+
+	return ret;
+}
+
 int oval_probe_query_sysinfo(oval_probe_session_t *sess, struct oval_sysinfo **out_sysinfo)
 {
 	struct oval_sysinfo *sysinf;
@@ -350,6 +481,8 @@ int oval_probe_query_definition(oval_probe_session_t *sess, const char *id) {
 	if (cnode == NULL)
 		return -1;
 
+	oval_probe_prefetch_definition(sess, definition);
+
 	ret = oval_probe_query_criteria(sess, cnode);
 
 	return ret;
@@ -491,6 +624,58 @@ static int oval_probe_query_criteria(oval_probe_session_t *sess, struct oval_cri
         return -1;
 }
 
+/**
+ * Submit the objects of the definition to the probes without waiting
+ * for the results, so that the probes can collect them while the
+ * library is busy with other work. The results are picked up by
+ * @ref oval_probe_query_object or @ref oval_probe_query_wait.
+ * @returns 0 on success; -1 on error
+ */
+int oval_probe_prefetch_definition(oval_probe_session_t *sess, struct oval_definition *definition)
+{
+	oval_probe_order_t *ord;
+	int ret;
+
+	if (definition == NULL)
+		return -1;
+
+	ord = oval_probe_order_new();
+	oval_probe_order_add_definition(ord, definition);
+	ret = oval_probe_order_submit(sess, ord);
+	oval_probe_order_free(ord);
+
+	return ret;
+}
+
+/**
+ * Wait until all the objects submitted by @ref oval_probe_prefetch_definition
+ * are collected. Objects which failed to be collected are left to be
+ * queried, and reported, again by @ref oval_probe_query_object.
+ * @returns 0 on success; -1 on error
+ */
+int oval_probe_prefetch_wait(oval_probe_session_t *sess)
+{
+	oval_ph_t *ph;
+	struct oval_syschar *sysc;
+	int ret;
+
+	if ((ph = oval_probe_handler_get(sess->ph, OVAL_SUBTYPE_ALL)) == NULL) {
+		dE("No probe handler for OVAL_SUBTYPE_ALL");
+		return (-1);
+	}
+
+	pthread_mutex_lock(&sess->lock);
+	do {
+		sysc = NULL;
+		ret = ph->func(OVAL_SUBTYPE_ALL, ph->uptr, PROBE_HANDLER_ACT_WAIT, &sysc, OVAL_PDFLAG_PREFETCH);
+		if (ret == 0 && sysc != NULL)
+			oval_probe_add_bindings(sysc);
+	} while (ret != 1);
+	pthread_mutex_unlock(&sess->lock);
+
+	return (0);
+}
+
 #if 0
 const oval_probe_meta_t * const oval_probe_meta_get(void)
 {
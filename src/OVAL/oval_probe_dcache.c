@@ -0,0 +1,580 @@
+/**
+ * @file   oval_probe_dcache.c
+ * @brief  Persistent (on-disk) cache of collected objects
+ */
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <seap.h>
+#include <strbuf.h>
+
+#include "common/alloc.h"
+#include "common/assume.h"
+#include "common/debug_priv.h"
+#include "oscap.h"
+#include "probes/public/probe-api.h"
+#include "oval_probe_dcache.h"
+
+#define OVAL_DCACHE_MAGIC   "OSCAPDC"
+#define OVAL_DCACHE_VERSION 1
+
+struct oval_dcache {
+	char *dir;      /**< cache directory */
+	char *rootdir;  /**< OSCAP_PROBE_ROOT or NULL */
+};
+
+struct oval_dcache_key {
+	oval_subtype_t type;
+	char   name[33];  /**< hex encoded fingerprint of the object */
+	char  *obj;       /**< textual form of the object */
+	size_t obj_len;
+	char  *tok;       /**< validity tokens */
+	size_t tok_len;
+};
+
+/*
+ * On-disk entry layout: header, object text, tokens, collected object text.
+ */
+struct oval_dcache_hdr {
+	char     magic[8];
+	uint32_t version;
+	uint32_t type;
+	uint64_t obj_len;
+	uint64_t tok_len;
+	uint64_t cobj_len;
+	char     oscap_version[32];
+};
+
+/*
+ * A validity token, followed by the NUL terminated path padded
+ * to a multiple of 8 bytes.
+ */
+struct oval_dcache_tok {
+	struct {
+		uint64_t dev;
+		uint64_t ino;
+		uint64_t size;
+		int64_t  mtime_sec;
+		int64_t  mtime_nsec;
+		int64_t  ctime_sec;
+		int64_t  ctime_nsec;
+		uint32_t mode;
+		uint32_t uid;
+		uint32_t gid;
+		int32_t  err;
+	} st[2]; /**< lstat and stat data */
+	uint32_t path_len;
+	uint32_t pad;
+};
+
+#define OVAL_DCACHE_ALIGN(n) (((n) + 7) & ~((size_t)7))
+
+oval_dcache_t *oval_dcache_new(const char *dir)
+{
+	oval_dcache_t *cache;
+	const char *root;
+	struct stat st;
+
+	if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+		dW("Can't create the probe cache directory %s: %s", dir, strerror(errno));
+		return (NULL);
+	}
+
+	/* only the user may replace the entries */
+	if (lstat(dir, &st) != 0 || !S_ISDIR(st.st_mode) ||
+	    st.st_uid != geteuid() || (st.st_mode & (S_IWGRP|S_IWOTH)) != 0)
+	{
+		dW("Can't use the probe cache directory %s: not a directory owned by the user and writable only by the user", dir);
+		return (NULL);
+	}
+
+	if (access(dir, R_OK|W_OK|X_OK) != 0) {
+		dW("Can't use the probe cache directory %s: %s", dir, strerror(errno));
+		return (NULL);
+	}
+
+	cache = oscap_talloc(oval_dcache_t);
+	cache->dir = oscap_strdup(dir);
+	root = getenv("OSCAP_PROBE_ROOT");
+	cache->rootdir = (root != NULL && *root != '\0') ? oscap_strdup(root) : NULL;
+
+	dI("Using the probe cache directory %s", dir);
+
+	return (cache);
+}
+
+void oval_dcache_free(oval_dcache_t *cache)
+{
+	if (cache == NULL)
+		return;
+
+	oscap_free(cache->dir);
+	oscap_free(cache->rootdir);
+	oscap_free(cache);
+}
+
+static void oval_dcache_tok_stat(struct oval_dcache_tok *tok, int i, int ret, const struct stat *st)
+{
+	memset(&tok->st[i], 0, sizeof tok->st[i]);
+
+	if (ret != 0) {
+		tok->st[i].err = errno;
+		return;
+	}
+
+	tok->st[i].dev  = st->st_dev;
+	tok->st[i].ino  = st->st_ino;
+	tok->st[i].size = st->st_size;
+	tok->st[i].mtime_sec  = st->st_mtim.tv_sec;
+	tok->st[i].mtime_nsec = st->st_mtim.tv_nsec;
+	tok->st[i].ctime_sec  = st->st_ctim.tv_sec;
+	tok->st[i].ctime_nsec = st->st_ctim.tv_nsec;
+	tok->st[i].mode = st->st_mode;
+	tok->st[i].uid  = st->st_uid;
+	tok->st[i].gid  = st->st_gid;
+}
+
+/*
+ * Append a token describing the current state of a file.
+ */
+static void oval_dcache_tok_add(oval_dcache_t *cache, oval_dcache_key_t *key, const char *path)
+{
+	struct oval_dcache_tok tok;
+	char   fullpath[PATH_MAX];
+	struct stat st;
+	size_t path_len, size;
+	int ret;
+
+	if (cache->rootdir != NULL)
+		snprintf(fullpath, sizeof fullpath, "%s/%s", cache->rootdir, path);
+	else
+		snprintf(fullpath, sizeof fullpath, "%s", path);
+
+	memset(&tok, 0, sizeof tok);
+
+	ret = lstat(fullpath, &st);
+	oval_dcache_tok_stat(&tok, 0, ret, &st);
+	ret = stat(fullpath, &st);
+	oval_dcache_tok_stat(&tok, 1, ret, &st);
+
+	path_len = strlen(path) + 1;
+	tok.path_len = path_len;
+	size = sizeof tok + OVAL_DCACHE_ALIGN(path_len);
+
+	key->tok = oscap_realloc(key->tok, key->tok_len + size);
+	memset(key->tok + key->tok_len, 0, size);
+	memcpy(key->tok + key->tok_len, &tok, sizeof tok);
+	memcpy(key->tok + key->tok_len + sizeof tok, path, path_len);
+	key->tok_len += size;
+}
+
+/*
+ * Get the single value of an entity which has to be compared using
+ * the "equals" operation. Returns NULL if the entity doesn't exist or
+ * if it doesn't fulfill the constraints.
+ */
+static char *oval_dcache_ent_cstr(SEXP_t *obj, const char *name, bool *nil)
+{
+	SEXP_t *ent, *val;
+	char *str = NULL;
+
+	*nil = false;
+	ent  = probe_obj_getent(obj, name, 1);
+
+	if (ent == NULL)
+		return (NULL);
+
+	if (probe_ent_attrexists(ent, "var_ref") ||
+	    probe_ent_getoperation(ent, OVAL_OPERATION_EQUALS) != OVAL_OPERATION_EQUALS) {
+		SEXP_free(ent);
+		return (NULL);
+	}
+
+	val = probe_ent_getval(ent);
+
+	if (val == NULL)
+		*nil = true;
+	else
+		str = SEXP_string_cstr(val);
+
+	SEXP_vfree(ent, val, NULL);
+
+	return (str);
+}
+
+/*
+ * Objects of the file family which refer to exactly one file or directory.
+ */
+static int oval_dcache_file_tokens(oval_dcache_t *cache, oval_dcache_key_t *key, SEXP_t *obj)
+{
+	SEXP_t *behaviors;
+	char *filepath, *path, *filename;
+	bool nil;
+	int ret = -1;
+
+	behaviors = probe_obj_getent(obj, "behaviors", 1);
+
+	if (behaviors != NULL) {
+		SEXP_t *r0 = probe_ent_getattrval(behaviors, "recurse_direction");
+
+		SEXP_free(behaviors);
+
+		if (r0 != NULL && SEXP_strcmp(r0, "none") != 0) {
+			SEXP_free(r0);
+			return (-1);
+		}
+		SEXP_free(r0);
+	}
+
+	filepath = oval_dcache_ent_cstr(obj, "filepath", &nil);
+
+	if (filepath != NULL) {
+		oval_dcache_tok_add(cache, key, filepath);
+		oscap_free(filepath);
+		return (0);
+	}
+
+	path = oval_dcache_ent_cstr(obj, "path", &nil);
+
+	if (path == NULL)
+		return (-1);
+
+	filename = oval_dcache_ent_cstr(obj, "filename", &nil);
+
+	if (filename != NULL) {
+		char buf[PATH_MAX];
+
+		snprintf(buf, sizeof buf, "%s/%s", path, filename);
+		oval_dcache_tok_add(cache, key, buf);
+		ret = 0;
+	} else if (nil) {
+		oval_dcache_tok_add(cache, key, path);
+		ret = 0;
+	}
+
+	oscap_free(path);
+	oscap_free(filename);
+
+	return (ret);
+}
+
+/*
+ * Package database files. Missing files are recorded too.
+ */
+static int oval_dcache_rpmdb_tokens(oval_dcache_t *cache, oval_dcache_key_t *key)
+{
+	const char *dbpath[] = { "/var/lib/rpm", "/usr/lib/sysimage/rpm" };
+	const char *dbfile[] = { "", "/Packages", "/Packages.db", "/rpmdb.sqlite" };
+	char buf[PATH_MAX];
+	size_t i, j;
+
+	if (getenv("OSCAP_PROBE_RPMDB_PATH") != NULL)
+		return (-1);
+
+	for (i = 0; i < sizeof dbpath / sizeof dbpath[0]; ++i) {
+		for (j = 0; j < sizeof dbfile / sizeof dbfile[0]; ++j) {
+			snprintf(buf, sizeof buf, "%s%s", dbpath[i], dbfile[j]);
+			oval_dcache_tok_add(cache, key, buf);
+		}
+	}
+
+	return (0);
+}
+
+static int oval_dcache_tokens(oval_dcache_t *cache, oval_dcache_key_t *key, SEXP_t *obj)
+{
+	SEXP_t *r0;
+
+	/* set objects depend on other objects */
+	if ((r0 = probe_obj_getent(obj, "set", 1)) != NULL) {
+		SEXP_free(r0);
+		return (-1);
+	}
+
+	/* variable values are not part of the entities */
+	if ((r0 = probe_obj_getent(obj, "varrefs", 1)) != NULL) {
+		SEXP_free(r0);
+		return (-1);
+	}
+
+	switch ((int)key->type) {
+	case OVAL_UNIX_FILE:
+	case OVAL_INDEPENDENT_FILE_HASH:
+	case OVAL_INDEPENDENT_FILE_HASH58:
+	case OVAL_INDEPENDENT_TEXT_FILE_CONTENT:
+	case OVAL_INDEPENDENT_TEXT_FILE_CONTENT_54:
+	case OVAL_INDEPENDENT_XML_FILE_CONTENT:
+		return oval_dcache_file_tokens(cache, key, obj);
+	case OVAL_LINUX_RPM_INFO:
+		return oval_dcache_rpmdb_tokens(cache, key);
+	case OVAL_LINUX_DPKG_INFO:
+		oval_dcache_tok_add(cache, key, "/var/lib/dpkg/status");
+		return (0);
+	default:
+		return (-1);
+	}
+}
+
+static pthread_mutex_t oval_dcache_id_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t oval_dcache_id = 0;
+
+/*
+ * Item IDs assigned by a probe in a previous run are unique only within
+ * that run. Give the loaded items new IDs which can't collide with the
+ * IDs assigned by the probes ("1<pid><n>").
+ */
+static void oval_dcache_cobj_setids(SEXP_t *cobj)
+{
+	SEXP_t *items, *item;
+
+	items = probe_cobj_get_items(cobj);
+
+	SEXP_list_foreach(item, items) {
+		SEXP_t *name_ref, *prev_id, uniq_id;
+		uint32_t local_id;
+
+		pthread_mutex_lock(&oval_dcache_id_lock);
+		local_id = ++oval_dcache_id;
+		pthread_mutex_unlock(&oval_dcache_id_lock);
+
+		SEXP_string_newf_r(&uniq_id, "2%05u%u", getpid(), local_id);
+
+		name_ref = SEXP_listref_first(item);
+		prev_id  = SEXP_list_replace(name_ref, 3, &uniq_id);
+
+		SEXP_free(prev_id);
+		SEXP_free_r(&uniq_id);
+		SEXP_free(name_ref);
+	}
+
+	SEXP_free(items);
+}
+
+static char *oval_dcache_sexp_cstr(SEXP_t *s_exp, size_t *len)
+{
+	strbuf_t *sb;
+	char *str = NULL;
+
+	sb = strbuf_new(SEAP_STRBUF_MAX);
+
+	if (SEXP_sbprintf_t(s_exp, sb) == 0) {
+		*len = strbuf_length(sb);
+		str  = strbuf_cstr(sb);
+	}
+
+	strbuf_free(sb);
+
+	return (str);
+}
+
+oval_dcache_key_t *oval_dcache_key_new(oval_dcache_t *cache, oval_subtype_t type, SEXP_t *obj)
+{
+	oval_dcache_key_t *key;
+	SEXP_FP_t fp;
+
+	key = oscap_talloc(oval_dcache_key_t);
+	key->type    = type;
+	key->obj     = NULL;
+	key->tok     = NULL;
+	key->tok_len = 0;
+
+	if (oval_dcache_tokens(cache, key, obj) != 0) {
+		oval_dcache_key_free(key);
+		return (NULL);
+	}
+
+	key->obj = oval_dcache_sexp_cstr(obj, &key->obj_len);
+
+	if (key->obj == NULL) {
+		oval_dcache_key_free(key);
+		return (NULL);
+	}
+
+	SEXP_ID_fp(obj, &fp);
+	snprintf(key->name, sizeof key->name, "%016"PRIx64"%016"PRIx64, fp.hi, fp.lo);
+
+	return (key);
+}
+
+void oval_dcache_key_free(oval_dcache_key_t *key)
+{
+	if (key == NULL)
+		return;
+
+	free(key->obj);
+	oscap_free(key->tok);
+	oscap_free(key);
+}
+
+SEXP_t *oval_dcache_get(oval_dcache_t *cache, const oval_dcache_key_t *key)
+{
+	char path[PATH_MAX];
+	struct oval_dcache_hdr *hdr;
+	struct stat st;
+	SEXP_psetup_t *psetup;
+	SEXP_pstate_t *pstate;
+	SEXP_t *list, *cobj = NULL;
+	char *data;
+	int fd;
+
+	snprintf(path, sizeof path, "%s/%s", cache->dir, key->name);
+
+	if ((fd = open(path, O_RDONLY|O_NOFOLLOW)) < 0)
+		return (NULL);
+
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid() ||
+	    (size_t)st.st_size < sizeof *hdr)
+	{
+		close(fd);
+		return (NULL);
+	}
+
+	data = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return (NULL);
+
+	hdr = (struct oval_dcache_hdr *)data;
+
+	if (memcmp(hdr->magic, OVAL_DCACHE_MAGIC, sizeof OVAL_DCACHE_MAGIC) != 0 ||
+	    hdr->version != OVAL_DCACHE_VERSION ||
+	    hdr->type    != (uint32_t)key->type ||
+	    strncmp(hdr->oscap_version, oscap_get_version(), sizeof hdr->oscap_version) != 0 ||
+	    hdr->obj_len != key->obj_len ||
+	    hdr->tok_len != key->tok_len ||
+	    sizeof *hdr + hdr->obj_len + hdr->tok_len + hdr->cobj_len != (uint64_t)st.st_size)
+	{
+		dD("Probe cache entry %s: invalid header", key->name);
+		goto out;
+	}
+
+	if (memcmp(data + sizeof *hdr, key->obj, key->obj_len) != 0) {
+		dD("Probe cache entry %s: object mismatch", key->name);
+		goto out;
+	}
+
+	if (memcmp(data + sizeof *hdr + key->obj_len, key->tok, key->tok_len) != 0) {
+		dD("Probe cache entry %s: stale", key->name);
+		goto out;
+	}
+
+	psetup = SEXP_psetup_new();
+	pstate = NULL;
+	list   = SEXP_parse(psetup, data + sizeof *hdr + key->obj_len + key->tok_len, hdr->cobj_len, &pstate);
+
+	if (list == NULL || pstate != NULL) {
+		dW("Probe cache entry %s: can't parse the collected object", key->name);
+		if (pstate != NULL)
+			SEXP_pstate_free(pstate);
+	} else {
+		cobj = SEXP_list_first(list);
+		oval_dcache_cobj_setids(cobj);
+	}
+
+	SEXP_free(list);
+	SEXP_psetup_free(psetup);
+out:
+	munmap(data, st.st_size);
+
+	if (cobj != NULL)
+		dI("Probe cache hit: %s", key->name);
+
+	return (cobj);
+}
+
+int oval_dcache_put(oval_dcache_t *cache, const oval_dcache_key_t *key, SEXP_t *cobj)
+{
+	char path[PATH_MAX], tmp[PATH_MAX];
+	struct oval_dcache_hdr hdr;
+	oval_syschar_collection_flag_t flag;
+	strbuf_t *sb;
+	int fd, ret = -1;
+
+	flag = probe_cobj_get_flag(cobj);
+
+	if (flag != SYSCHAR_FLAG_COMPLETE && flag != SYSCHAR_FLAG_DOES_NOT_EXIST)
+		return (0);
+
+	sb = strbuf_new(SEAP_STRBUF_MAX);
+
+	if (SEXP_sbprintf_t(cobj, sb) != 0) {
+		strbuf_free(sb);
+		return (-1);
+	}
+
+	memset(&hdr, 0, sizeof hdr);
+	memcpy(hdr.magic, OVAL_DCACHE_MAGIC, sizeof OVAL_DCACHE_MAGIC);
+	snprintf(hdr.oscap_version, sizeof hdr.oscap_version, "%s", oscap_get_version());
+	hdr.version  = OVAL_DCACHE_VERSION;
+	hdr.type     = key->type;
+	hdr.obj_len  = key->obj_len;
+	hdr.tok_len  = key->tok_len;
+	hdr.cobj_len = strbuf_length(sb);
+
+	snprintf(path, sizeof path, "%s/%s", cache->dir, key->name);
+	snprintf(tmp,  sizeof tmp,  "%s/.%s.XXXXXX", cache->dir, key->name);
+
+	if ((fd = mkstemp(tmp)) < 0) {
+		dW("Can't create a probe cache entry: %s", strerror(errno));
+		strbuf_free(sb);
+		return (-1);
+	}
+
+	if (write(fd, &hdr, sizeof hdr) != (ssize_t)sizeof hdr ||
+	    write(fd, key->obj, key->obj_len) != (ssize_t)key->obj_len ||
+	    write(fd, key->tok, key->tok_len) != (ssize_t)key->tok_len ||
+	    strbuf_write(sb, fd) != (ssize_t)hdr.cobj_len)
+	{
+		dW("Can't write the probe cache entry %s: %s", tmp, strerror(errno));
+		goto out;
+	}
+
+	if (rename(tmp, path) != 0) {
+		dW("Can't rename %s to %s: %s", tmp, path, strerror(errno));
+		goto out;
+	}
+
+	ret = 0;
+out:
+	close(fd);
+
+	if (ret != 0)
+		unlink(tmp);
+
+	strbuf_free(sb);
+
+	return (ret);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file   oval_probe_dcache.h
+ * @brief  Persistent (on-disk) cache of collected objects
+ *
+ * @addtogroup PROBEOVALSEXP
+ * @{
+ */
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef OVAL_PROBE_DCACHE_H
+#define OVAL_PROBE_DCACHE_H
+
+#include <seap.h>
+#include "public/oval_types.h"
+#include "../common/util.h"
+
+/*
+ * The cache stores collected objects in files named by the fingerprint
+ * of the object S-exp. Each entry carries validity tokens (stat data of
+ * the files the result depends on) which are taken before the object is
+ * collected and compared when the entry is looked up. Only object types
+ * with a known set of such files are cached.
+ */
+
+/**
+ * Environment variable holding the cache directory. The cache is disabled
+ * if it isn't set.
+ */
+#define OVAL_DCACHE_DIR_ENV "OSCAP_PROBE_CACHE_DIR"
+
+typedef struct oval_dcache oval_dcache_t;
+typedef struct oval_dcache_key oval_dcache_key_t;
+
+/**
+ * Open the cache in the given directory. The directory is created if
+ * it doesn't exist. It has to be owned by the user and writable only by
+ * the user, a symlink isn't followed.
+ * @return the cache or NULL if the directory can't be used
+ */
+oval_dcache_t *oval_dcache_new(const char *dir);
+
+void oval_dcache_free(oval_dcache_t *cache);
+
+/**
+ * Compute the key and the validity tokens of an object. This has to be
+ * done before the object is collected.
+ * @param type object type
+ * @param obj the object S-exp sent to the probe
+ * @return the key or NULL if objects of this kind are not cached
+ */
+oval_dcache_key_t *oval_dcache_key_new(oval_dcache_t *cache, oval_subtype_t type, SEXP_t *obj);
+
+void oval_dcache_key_free(oval_dcache_key_t *key);
+
+/**
+ * Look up a collected object.
+ * @return the collected object or NULL if there's no valid entry
+ */
+SEXP_t *oval_dcache_get(oval_dcache_t *cache, const oval_dcache_key_t *key);
+
+/**
+ * Store a collected object. Objects which weren't collected completely
+ * are not stored.
+ * @retval 0 on success or if the object was not stored
+ * @retval -1 on failure
+ */
+int oval_dcache_put(oval_dcache_t *cache, const oval_dcache_key_t *key, SEXP_t *cobj);
+
+#endif /* OVAL_PROBE_DCACHE_H */
+/// @}
@@ -26,6 +26,7 @@
 #include <seap.h>
 #include <stdarg.h>
 #include <string.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <limits.h>
 #include <sys/types.h>
@@ -43,6 +44,7 @@
 #include "oval_probe_ext.h"
 #include "oval_sexp.h"
 #include "oval_probe_meta.h"
+#include "probes/oval_fts_snapshot.h"
 
 #define __ERRBUF_SIZE 128
 
@@ -50,10 +52,58 @@
 #define __STRING(x)     #x
 #endif
 
+struct oval_pext_follow;
+struct oval_pext_done;
+
 static oval_pdtbl_t *oval_pdtbl_new(void);
 static void          oval_pdtbl_free(oval_pdtbl_t *table);
-static int           oval_pdtbl_add(oval_pdtbl_t *table, oval_subtype_t type, int sd, const char *uri);
+static int           oval_pdtbl_add(oval_pdtbl_t *table, oval_subtype_t type, int sd, const char *uri, const char *uri_fallback);
 static oval_pd_t    *oval_pdtbl_get(oval_pdtbl_t *table, oval_subtype_t type);
+static void          oval_pext_discard(oval_pext_t *pext);
+static void          oval_pext_cobj_reset(oval_pext_t *pext);
+static void          oval_pext_follow_free(struct oval_pext_follow *follow);
+static void          oval_pext_done_free(struct oval_pext_done *done);
+static int           oval_pdreq_wait(oval_pext_t *pext, oval_pdreq_t *req, int flags);
+
+/*
+ * The content of an object: the object S-exp without the id and its
+ * fingerprint, which is the key of the content tables of the session.
+ * Objects with the same fingerprint are only shared if their S-exps are
+ * equal, too.
+ */
+typedef struct {
+	char   *key;
+	SEXP_t *sexp;
+} oval_pext_cobj_t;
+
+static void          oval_pext_cobj_free(oval_pext_cobj_t *cobj);
+
+/*
+ * A request sent by oval_probe_ext_submit(). The reply is received
+ * either by oval_probe_ext_wait() or while waiting for the reply to
+ * another request sent to the same probe.
+ */
+struct oval_pdreq {
+	SEAP_msgid_t         id;
+	oval_pd_t           *pd;
+	struct oval_syschar *syschar;
+	int                  flags;
+	oval_dcache_key_t   *dkey;
+	oval_pext_cobj_t    *cobj;   /* content of the object or NULL */
+	int                  state;
+	int                  sync;   /* owned by oval_probe_comm() */
+	SEXP_t              *reply;  /* OVAL_PDREQ_REPLIED */
+	SEAP_err_t          *err;    /* OVAL_PDREQ_FAILED, NULL if the connection failed */
+	int                  waiters; /* oval_pdreq_wait() calls waiting for the request */
+	int                  result;  /* OVAL_PDREQ_DONE */
+	oval_pdreq_t        *prev;
+	oval_pdreq_t        *next;
+};
+
+#define OVAL_PDREQ_PENDING 0
+#define OVAL_PDREQ_REPLIED 1
+#define OVAL_PDREQ_FAILED  2
+#define OVAL_PDREQ_DONE    3
 
 /*
  * oval_pext_
@@ -75,13 +125,71 @@ oval_pext_t *oval_pext_new(void)
         if (pext->probe_dir == NULL)
                 pext->probe_dir = OVAL_PROBE_DIR;
 
+#if defined(OVAL_PROBEDIR_ENV)
+        pext->module_dir = getenv("OVAL_PROBE_MODULE_DIR");
+#else
+        pext->module_dir = NULL;
+#endif
+        if (pext->module_dir == NULL)
+                pext->module_dir = pext->probe_dir;
+
+        if (oval_pext_set_scheme(pext, getenv(OVAL_PROBE_SCHEME_ENV)) != 0) {
+                dW("Unknown probe scheme \"%s\", using \"%s\"", getenv(OVAL_PROBE_SCHEME_ENV), OVAL_PROBE_SCHEME);
+                pext->probe_scheme = OVAL_PROBE_SCHEME;
+        }
+
         pext->pdtbl     = NULL;
         pext->pdsc      = NULL;
         pext->pdsc_cnt  = 0;
 
+        if (getenv(OVAL_DCACHE_DIR_ENV) != NULL)
+                pext->dcache = oval_dcache_new(getenv(OVAL_DCACHE_DIR_ENV));
+        else
+                pext->dcache = NULL;
+
+        pext->dcache_served = oscap_htable_new();
+
+        /*
+         * The snapshots of the file probes taken before this session are
+         * stale. The probes get the time when they are connected.
+         */
+        if (getenv(OVAL_FTS_SNAPSHOT_DIR_ENV) != NULL)
+                pext->fts_since = oval_fts_snapshot_now();
+        else
+                pext->fts_since = 0;
+
+        pext->req_head = NULL;
+        pext->req_tail = NULL;
+
+        pext->cobj_done    = oscap_htable_new();
+        pext->cobj_pending = oscap_htable_new();
+        pext->cobj_follow  = oscap_htable_new();
+        pext->cobj_dups    = 0;
+
         return(pext);
 }
 
+int oval_pext_set_scheme(oval_pext_t *pext, const char *scheme)
+{
+        static const char *schemes[] = { "pipe", "shm", "thread" };
+        register size_t i;
+
+        if (scheme == NULL) {
+                pext->probe_scheme = OVAL_PROBE_SCHEME;
+                return (0);
+        }
+
+        for (i = 0; i < sizeof schemes / sizeof schemes[0]; ++i) {
+                if (strcmp(scheme, schemes[i]) == 0) {
+                        pext->probe_scheme = schemes[i];
+                        return (0);
+                }
+        }
+
+        errno = EINVAL;
+        return (-1);
+}
+
 void oval_pext_free(oval_pext_t *pext)
 {
         if (!pext->do_init) {
@@ -89,9 +197,17 @@ void oval_pext_free(oval_pext_t *pext)
 		oscap_free(pext->pdsc);
 		pext->pdsc     = NULL;
 		pext->pdsc_cnt = 0;
+                oval_pext_discard(pext);
                 oval_pdtbl_free(pext->pdtbl);
         }
 
+        oval_pext_cobj_reset(pext);
+        oscap_htable_free(pext->cobj_done, (oscap_destruct_func) oval_pext_done_free);
+        oscap_htable_free(pext->cobj_pending, NULL);
+        oscap_htable_free(pext->cobj_follow, (oscap_destruct_func) oval_pext_follow_free);
+
+        oval_dcache_free(pext->dcache);
+        oscap_htable_free(pext->dcache_served, NULL);
         pthread_mutex_destroy(&pext->lock);
         oscap_free(pext);
 }
@@ -118,6 +234,7 @@ static void oval_pdtbl_free(oval_pdtbl_t *tbl)
         for (i = 0; i < tbl->count; ++i) {
                 SEAP_close(tbl->ctx, tbl->memb[i]->sd);
                 oscap_free(tbl->memb[i]->uri);
+                oscap_free(tbl->memb[i]->uri_fallback);
 		oscap_free(tbl->memb[i]);
         }
 
@@ -142,7 +259,7 @@ static int oval_pdtbl_typecmp(oval_subtype_t *a, oval_pd_t **b)
         return (*a - (*b)->subtype);
 }
 
-static int oval_pdtbl_add(oval_pdtbl_t *tbl, oval_subtype_t type, int sd, const char *uri)
+static int oval_pdtbl_add(oval_pdtbl_t *tbl, oval_subtype_t type, int sd, const char *uri, const char *uri_fallback)
 {
 	oval_pd_t *pd;
 
@@ -153,6 +270,8 @@ static int oval_pdtbl_add(oval_pdtbl_t *tbl, oval_subtype_t type, int sd, const
 	pd->subtype = type;
 	pd->sd      = sd;
 	pd->uri     = strdup(uri);
+	pd->uri_fallback = uri_fallback != NULL ? strdup(uri_fallback) : NULL;
+	pd->pending = 0;
 
 	tbl->memb = oscap_realloc(tbl->memb, sizeof(oval_pd_t *) * (++tbl->count));
 
@@ -176,6 +295,41 @@ static oval_pd_t *oval_pdtbl_get(oval_pdtbl_t * tbl, oval_subtype_t type)
 	return (pdp == NULL ? NULL : *pdp);
 }
 
+/*
+ * Build the URI of the probe described by dsc. With the thread scheme the
+ * probe module is used if there's one and the probe doesn't have to run
+ * offline; the out-of-process URI is then written to fallback in case the
+ * module can't be loaded. Otherwise fallback is set to an empty string.
+ */
+static int oval_probe_uri(oval_pext_t *pext, const oval_pdsc_t *dsc,
+                          char *uri, size_t urilen, char *fallback, size_t fallbacklen)
+{
+        const char *scheme;
+        size_t      len;
+
+        scheme = pext->probe_scheme;
+        fallback[0] = '\0';
+
+        if (strcmp(scheme, "thread") == 0) {
+                scheme = OVAL_PROBE_SCHEME_FALLBACK;
+
+                if (getenv("OSCAP_PROBE_ROOT") == NULL &&
+                    getenv("OSCAP_PROBE_RPMDB_PATH") == NULL) {
+                        len = snprintf(uri, urilen, "thread://%s/%s.so", pext->module_dir, dsc->file);
+
+                        if (len < urilen && access(uri + strlen("thread://"), R_OK) == 0) {
+                                len = snprintf(fallback, fallbacklen, "%s://%s/%s",
+                                               scheme, pext->probe_dir, dsc->file);
+                                return (len < fallbacklen ? 0 : -1);
+                        }
+                }
+        }
+
+        len = snprintf(uri, urilen, "%s://%s/%s", scheme, pext->probe_dir, dsc->file);
+
+        return (len < urilen ? 0 : -1);
+}
+
 /*
  * oval_probe_cmd_
  */
@@ -241,6 +395,24 @@ static SEXP_t *oval_probe_cmd_obj_eval(SEXP_t *sexp, void *arg)
 
 	oscap_clearerr();
 	r = oval_probe_query_object(pext->sess_ptr, obj, OVAL_PDFLAG_NOREPLY|OVAL_PDFLAG_SLAVE, &res);
+
+	if (r == 0 && oscap_htable_get(pext->dcache_served, id_str) != NULL) {
+		oval_pd_t *pd;
+		/*
+		 * The result was loaded from the persistent cache, so the probe
+		 * doesn't have it. Let the probe collect the object, it has it
+		 * for the next requests then.
+		 */
+		pd = oval_pdtbl_get(pext->pdtbl, oval_object_get_subtype(obj));
+
+		if (pd != NULL) {
+			dI("Object '%s' wasn't collected by the probe, sending it.", id_str);
+			r = oval_probe_ext_eval(pext->pdtbl->ctx, pd, pext, res, OVAL_PDFLAG_NOREPLY|OVAL_PDFLAG_SLAVE);
+
+			if (r >= 0)
+				oscap_htable_detach(pext->dcache_served, id_str);
+		}
+	}
 	if (r < 0)
 		ret_code = SEXP_number_newu((unsigned int) SYSCHAR_FLAG_COMPLETE);
 	else
@@ -359,6 +531,24 @@ static inline const char *_probe_strerror(uint32_t error_code)
 	return codemsg;
 }
 
+static void _handle_SEAP_error(oval_pd_t *pd, SEAP_err_t *err)
+{
+	/*
+	 * decide what to do based on the error code/type
+	 */
+	switch (err->type) {
+	case SEAP_ETYPE_USER:
+	{
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Probe at sd=%d (%s) reported an error: %s",
+				pd->sd, oval_subtype_to_str(pd->subtype), _probe_strerror(err->code));
+		break;
+	}
+	case SEAP_ETYPE_INT:
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Internal error");
+		break;
+	}
+}
+
 static inline int _handle_SEAP_receive_failure(SEAP_CTX_t *ctx, oval_pd_t *pd, SEAP_msg_t *s_omsg, int flags)
 {
 	protect_errno {
@@ -383,21 +573,7 @@ static inline int _handle_SEAP_receive_failure(SEAP_CTX_t *ctx, oval_pd_t *pd, S
 			return (-1);
 		}
 
-		/*
-		 * decide what to do based on the error code/type
-		 */
-		switch (err->type) {
-		case SEAP_ETYPE_USER:
-		{
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Probe at sd=%d (%s) reported an error: %s",
-					pd->sd, oval_subtype_to_str(pd->subtype), _probe_strerror(err->code));
-			break;
-		}
-		case SEAP_ETYPE_INT:
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Internal error");
-			break;
-		}
-
+		_handle_SEAP_error(pd, err);
 		SEAP_error_free(err);
 		return (-1);
 	}
@@ -430,50 +606,532 @@ static inline int _handle_SEAP_receive_failure(SEAP_CTX_t *ctx, oval_pd_t *pd, S
 	return (-1);
 }
 
-static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj, int flags, SEXP_t **out_sexp)
+/*
+ * Pass the start of the session to a newly connected probe, the
+ * snapshots of the file probes taken before it are stale.
+ */
+static void oval_pd_fts_since(SEAP_CTX_t *ctx, oval_pext_t *pext, oval_pd_t *pd)
 {
-	int retry, ret;
+	SEXP_t *since, *res;
 
-	SEAP_msg_t *s_imsg, *s_omsg;
-	SEXP_t *s_oobj;
+	/* the system info is queried without a session */
+	if (pext == NULL || pext->fts_since == 0)
+		return;
 
-	assume_d (pd != NULL, -1);
-        assume_d (s_iobj != NULL, -1);
+	since = SEXP_number_newi_64(pext->fts_since);
+	errno = 0;
+	res = SEAP_cmd_exec(ctx, pd->sd, SEAP_EXEC_RECV, PROBECMD_FTS_SINCE, since,
+	                    SEAP_CMDTYPE_SYNC, NULL, NULL);
 
-	for (retry = 0;;) {
-		/*
-		 * Establish connection to probe. The connection may be
-		 * already set up by previous calls to this function or
-		 * by the probe context handling functions.
-		 */
-		if (pd->sd == -1) {
-			pd->sd = SEAP_connect(ctx, pd->uri, 0);
+	if (res == NULL && errno != 0)
+		dW("Can't pass the start of the session to the probe: %u, %s.", errno, strerror(errno));
 
-			if (pd->sd < 0) {
-                                protect_errno {
-                                        dW("Can't connect: %u, %s.", errno, strerror(errno));
-                                }
+	SEXP_vfree(since, res, NULL);
+}
 
-				if (++retry <= OVAL_PROBE_MAXRETRY) {
-					dI("Connect: retry %u/%u.", retry, OVAL_PROBE_MAXRETRY);
-					continue;
-				} else {
-                                        char errbuf[__ERRBUF_SIZE];
+/*
+ * Establish connection to probe. The connection may be already set up
+ * by previous calls to this function or by the probe context handling
+ * functions.
+ */
+static int oval_pd_connect(SEAP_CTX_t *ctx, oval_pext_t *pext, oval_pd_t *pd, int flags)
+{
+	int retry;
 
-                                        protect_errno {
-                                                dE("Connect: retry limit (%u) reached.", OVAL_PROBE_MAXRETRY);
-                                        }
+	for (retry = 0; pd->sd == -1;) {
+		pd->sd = SEAP_connect(ctx, pd->uri, 0);
 
-                                        if (strerror_r (errno, errbuf, sizeof errbuf - 1) != 0)
-                                                oscap_seterr (OSCAP_EFAMILY_OVAL, "Can't connect to the probe");
-                                        else
-                                                oscap_seterr (OSCAP_EFAMILY_OVAL, errbuf);
+		if (pd->sd < 0) {
+			protect_errno {
+				dW("Can't connect: %u, %s.", errno, strerror(errno));
+			}
+
+			if (pd->uri_fallback != NULL) {
+				dI("Using the fallback URI '%s'.", pd->uri_fallback);
+				oscap_free(pd->uri);
+				pd->uri = pd->uri_fallback;
+				pd->uri_fallback = NULL;
+				pd->sd = -1;
+				continue;
+			}
 
-					return (-1);
+			if (++retry <= OVAL_PROBE_MAXRETRY) {
+				dI("Connect: retry %u/%u.", retry, OVAL_PROBE_MAXRETRY);
+				pd->sd = -1;
+				continue;
+			} else {
+				char errbuf[__ERRBUF_SIZE];
+
+				protect_errno {
+					dE("Connect: retry limit (%u) reached.", OVAL_PROBE_MAXRETRY);
+				}
+
+				if (!(flags & OVAL_PDFLAG_PREFETCH)) {
+					if (strerror_r (errno, errbuf, sizeof errbuf - 1) != 0)
+						oscap_seterr (OSCAP_EFAMILY_OVAL, "Can't connect to the probe");
+					else
+						oscap_seterr (OSCAP_EFAMILY_OVAL, errbuf);
 				}
+
+				pd->sd = -1;
+				return (-1);
 			}
 		}
 
+		oval_pd_fts_since(ctx, pext, pd);
+	}
+
+	return (0);
+}
+
+/*
+ * oval_pdreq_
+ */
+static void oval_pdreq_free(oval_pdreq_t *req)
+{
+	SEXP_free(req->reply);
+
+	if (req->err != NULL)
+		SEAP_error_free(req->err);
+
+	oval_dcache_key_free(req->dkey);
+	oval_pext_cobj_free(req->cobj);
+	oscap_free(req);
+}
+
+static void oval_pdreq_unlink(oval_pext_t *pext, oval_pdreq_t *req)
+{
+	if (req->prev != NULL)
+		req->prev->next = req->next;
+	else
+		pext->req_head = req->next;
+
+	if (req->next != NULL)
+		req->next->prev = req->prev;
+	else
+		pext->req_tail = req->prev;
+
+	if (req->state == OVAL_PDREQ_PENDING)
+		--req->pd->pending;
+
+	if (req->cobj != NULL && oscap_htable_get(pext->cobj_pending, req->cobj->key) == req)
+		oscap_htable_detach(pext->cobj_pending, req->cobj->key);
+
+	req->prev = req->next = NULL;
+}
+
+static oval_pdreq_t *oval_pdreq_find(oval_pext_t *pext, oval_pd_t *pd, SEAP_msgid_t id)
+{
+	oval_pdreq_t *req;
+
+	for (req = pext->req_head; req != NULL; req = req->next) {
+		if (req->pd == pd && req->id == id && req->state == OVAL_PDREQ_PENDING)
+			return (req);
+	}
+
+	return (NULL);
+}
+
+static oval_pdreq_t *oval_pdreq_find_syschar(oval_pext_t *pext, struct oval_syschar *syschar)
+{
+	oval_pdreq_t *req;
+
+	for (req = pext->req_head; req != NULL; req = req->next) {
+		if (req->syschar == syschar)
+			return (req);
+	}
+
+	return (NULL);
+}
+
+/*
+ * Free all submitted requests; used when the probe descriptors are freed.
+ */
+static void oval_pext_discard(oval_pext_t *pext)
+{
+	oval_pdreq_t *req;
+
+	while ((req = pext->req_head) != NULL) {
+		oval_pdreq_unlink(pext, req);
+		oval_pdreq_free(req);
+	}
+}
+
+/*
+ * The connection to the probe failed, so the pending requests won't
+ * get a reply.
+ */
+static void oval_pd_fail(oval_pext_t *pext, oval_pd_t *pd)
+{
+	oval_pdreq_t *req;
+
+	for (req = pext->req_head; req != NULL && pd->pending > 0; req = req->next) {
+		if (req->pd == pd && req->state == OVAL_PDREQ_PENDING) {
+			req->state = OVAL_PDREQ_FAILED;
+			--pd->pending;
+		}
+	}
+}
+
+/*
+ * Find the pending request which caused the error received from the
+ * probe. Returns 1 if the request was found, 0 otherwise.
+ */
+static int oval_pd_recverr(SEAP_CTX_t *ctx, oval_pext_t *pext, oval_pd_t *pd)
+{
+	oval_pdreq_t *req;
+	SEAP_err_t   *err;
+
+	for (req = pext->req_head; req != NULL; req = req->next) {
+		if (req->pd != pd || req->state != OVAL_PDREQ_PENDING)
+			continue;
+
+		err = NULL;
+
+		if (SEAP_recverr_byid(ctx, pd->sd, &err, req->id) == 0) {
+			req->err   = err;
+			req->state = OVAL_PDREQ_FAILED;
+			--pd->pending;
+
+			return (1);
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Receive one message from the probe. Replies to the submitted requests
+ * (and errors caused by them) are stored in the requests as they arrive,
+ * so that they can be completed in any order.
+ */
+static int oval_pd_recvmsg(SEAP_CTX_t *ctx, oval_pext_t *pext, oval_pd_t *pd)
+{
+	SEAP_msg_t   *s_imsg = NULL;
+	SEAP_msgid_t  id;
+	oval_pdreq_t *req;
+
+	if (SEAP_recvmsg(ctx, pd->sd, &s_imsg) != 0) {
+		if (errno == ECANCELED) {
+			if (oval_pd_recverr(ctx, pext, pd) != 1)
+				dW("Unexpected error from the probe at sd=%d.", pd->sd);
+			return (0);
+		}
+
+		protect_errno {
+			oval_pd_fail(pext, pd);
+		}
+
+		return (-1);
+	}
+
+	if (SEAP_msg_reply_id(s_imsg, &id) == 0 &&
+	    (req = oval_pdreq_find(pext, pd, id)) != NULL)
+	{
+		req->reply = SEAP_msg_get(s_imsg);
+		req->state = OVAL_PDREQ_REPLIED;
+		--pd->pending;
+	} else
+		dW("Unexpected message from the probe at sd=%d.", pd->sd);
+
+	SEAP_msg_free(s_imsg);
+
+	return (0);
+}
+
+static oval_pdreq_t *oval_pdreq_add(oval_pext_t *pext, oval_pd_t *pd, SEAP_msgid_t id,
+				    struct oval_syschar *syschar, int flags, oval_dcache_key_t *dkey,
+				    oval_pext_cobj_t *cobj)
+{
+	oval_pdreq_t *req;
+
+	req = oscap_talloc(oval_pdreq_t);
+	req->id      = id;
+	req->pd      = pd;
+	req->syschar = syschar;
+	req->flags   = flags;
+	req->dkey    = dkey;
+	req->cobj    = cobj;
+	req->state   = OVAL_PDREQ_PENDING;
+	req->sync    = 0;
+	req->reply   = NULL;
+	req->err     = NULL;
+	req->waiters = 0;
+	req->result  = 0;
+	req->prev    = pext->req_tail;
+	req->next    = NULL;
+
+	if (pext->req_tail != NULL)
+		pext->req_tail->next = req;
+	else
+		pext->req_head = req;
+
+	pext->req_tail = req;
+	++pd->pending;
+
+	if (cobj != NULL)
+		oscap_htable_add(pext->cobj_pending, cobj->key, req);
+
+	return (req);
+}
+
+/*
+ * Objects which differ only in their id are collected once. The other
+ * objects get a copy of the flag, messages and items of the collected
+ * one. Objects sent with the no-reply flag are left alone, the probes
+ * need to collect them.
+ */
+static oval_pext_cobj_t *oval_pext_cobj_new(const SEXP_t *s_obj)
+{
+	oval_pext_cobj_t *cobj;
+	SEXP_FP_t fp;
+	char key[33];
+
+	cobj = oscap_talloc(oval_pext_cobj_t);
+	cobj->sexp = oval_object_sexp_content(s_obj);
+
+	SEXP_ID_fp(cobj->sexp, &fp);
+	snprintf(key, sizeof key, "%016"PRIx64"%016"PRIx64, fp.hi, fp.lo);
+	cobj->key = oscap_strdup(key);
+
+	return (cobj);
+}
+
+static void oval_pext_cobj_free(oval_pext_cobj_t *cobj)
+{
+	if (cobj == NULL)
+		return;
+
+	SEXP_free(cobj->sexp);
+	oscap_free(cobj->key);
+	oscap_free(cobj);
+}
+
+/*
+ * A collected object in the content table, with the S-exp it was
+ * collected for.
+ */
+struct oval_pext_done {
+	struct oval_syschar *syschar;
+	SEXP_t              *sexp;
+};
+
+static void oval_pext_done_free(struct oval_pext_done *done)
+{
+	/* oscap_htable_detach() leaves NULL values behind */
+	if (done == NULL)
+		return;
+
+	SEXP_free(done->sexp);
+	oscap_free(done);
+}
+
+static void oval_pext_cobj_copy(struct oval_syschar *dst, struct oval_syschar *src)
+{
+	struct oval_message_iterator *msg_itr;
+	struct oval_sysitem_iterator *itm_itr;
+
+	oval_syschar_set_flag(dst, oval_syschar_get_flag(src));
+
+	msg_itr = oval_syschar_get_messages(src);
+	while (oval_message_iterator_has_more(msg_itr))
+		oval_syschar_add_message(dst, oval_message_clone(oval_message_iterator_next(msg_itr)));
+	oval_message_iterator_free(msg_itr);
+
+	/* items are shared with the syschar model */
+	itm_itr = oval_syschar_get_sysitem(src);
+	while (oval_sysitem_iterator_has_more(itm_itr))
+		oval_syschar_add_sysitem(dst, oval_sysitem_iterator_next(itm_itr));
+	oval_sysitem_iterator_free(itm_itr);
+}
+
+/*
+ * Fill the syschar from an already collected object with the same content,
+ * waiting for the reply if the object was submitted. Returns 1 if the
+ * syschar was filled, 0 if the object has to be collected.
+ */
+static int oval_pext_cobj_get(oval_pext_t *pext, oval_pext_cobj_t *cobj, struct oval_syschar *syschar)
+{
+	struct oval_pext_done *done;
+	struct oval_syschar *src;
+	oval_pdreq_t *req;
+	const char *id;
+
+	done = oscap_htable_get(pext->cobj_done, cobj->key);
+	req  = oscap_htable_get(pext->cobj_pending, cobj->key);
+
+	if (done != NULL && done->syschar != syschar && SEXP_deepcmp(done->sexp, cobj->sexp)) {
+		src = done->syschar;
+		oval_pext_cobj_copy(syschar, src);
+	} else if (req != NULL && req->syschar != syschar && SEXP_deepcmp(req->cobj->sexp, cobj->sexp)) {
+		while (req->state == OVAL_PDREQ_PENDING) {
+			if (oval_pd_recvmsg(pext->pdtbl->ctx, pext, req->pd) != 0)
+				break;
+		}
+
+		if (req->state != OVAL_PDREQ_REPLIED
+		    || oval_sexp_to_sysch(req->reply, syschar) != 0)
+			return (0);
+
+		src = req->syschar;
+	} else
+		return (0);
+
+	id = oval_object_get_id(oval_syschar_get_object(syschar));
+	dI("Object '%s' has the same content as '%s', not collecting it again.",
+	   id, oval_object_get_id(oval_syschar_get_object(src)));
+
+	/* the probe doesn't have the result */
+	oscap_htable_add(pext->dcache_served, id, (void *)1);
+	++pext->cobj_dups;
+
+	return (1);
+}
+
+static void oval_pext_cobj_put(oval_pext_t *pext, oval_pext_cobj_t *cobj, struct oval_syschar *syschar)
+{
+	oval_syschar_collection_flag_t flag;
+	struct oval_pext_done *done;
+
+	if (cobj == NULL)
+		return;
+
+	flag = oval_syschar_get_flag(syschar);
+
+	if (flag == SYSCHAR_FLAG_UNKNOWN || flag == SYSCHAR_FLAG_ERROR)
+		return;
+
+	done = oscap_talloc(struct oval_pext_done);
+	done->syschar = syschar;
+	done->sexp    = SEXP_ref(cobj->sexp);
+
+	/* the first object with the fingerprint keeps the entry */
+	if (!oscap_htable_add(pext->cobj_done, cobj->key, done))
+		oval_pext_done_free(done);
+}
+
+/*
+ * An object submitted while another object with the same content was
+ * waiting for the reply. It isn't sent to the probe.
+ */
+struct oval_pext_follow {
+	struct oval_syschar *syschar;
+	oval_pext_cobj_t    *cobj;
+};
+
+static void oval_pext_follow_free(struct oval_pext_follow *follow)
+{
+	/* oscap_htable_detach() leaves NULL values behind */
+	if (follow == NULL)
+		return;
+
+	oval_pext_cobj_free(follow->cobj);
+	oscap_free(follow);
+}
+
+static void oval_pext_follow_add(oval_pext_t *pext, struct oval_syschar *syschar, oval_pext_cobj_t *cobj)
+{
+	struct oval_pext_follow *follow;
+
+	follow = oscap_talloc(struct oval_pext_follow);
+	follow->syschar  = syschar;
+	follow->cobj     = cobj;
+
+	if (!oscap_htable_add(pext->cobj_follow, oval_object_get_id(oval_syschar_get_object(syschar)), follow))
+		oval_pext_follow_free(follow);
+}
+
+/*
+ * Fill the syschar of an object added by oval_pext_follow_add().
+ * Returns 1 if the syschar was filled, 0 otherwise.
+ */
+static int oval_pext_follow_get(oval_pext_t *pext, struct oval_syschar *syschar)
+{
+	struct oval_pext_follow *follow;
+	int ret = 0;
+
+	follow = oscap_htable_detach(pext->cobj_follow, oval_object_get_id(oval_syschar_get_object(syschar)));
+
+	if (follow == NULL)
+		return (0);
+	if (follow->syschar == syschar)
+		ret = oval_pext_cobj_get(pext, follow->cobj, syschar);
+
+	oval_pext_follow_free(follow);
+
+	return (ret);
+}
+
+/*
+ * Forget the collected objects; the syschar model may be replaced.
+ */
+static void oval_pext_cobj_reset(oval_pext_t *pext)
+{
+	if (pext->cobj_dups > 0)
+		dI("%zu objects were not collected again, they had the same content as other objects.", pext->cobj_dups);
+
+	oscap_htable_free(pext->cobj_done, (oscap_destruct_func) oval_pext_done_free);
+	oscap_htable_free(pext->cobj_follow, (oscap_destruct_func) oval_pext_follow_free);
+	pext->cobj_done   = oscap_htable_new();
+	pext->cobj_follow = oscap_htable_new();
+	pext->cobj_dups   = 0;
+}
+
+/*
+ * Wait for the reply to a request sent by oval_probe_comm(). While
+ * waiting, the probe may send commands which cause other requests to be
+ * sent to the same probe, so the reply is looked up by its ID.
+ */
+static int oval_pd_recvreply(SEAP_CTX_t *ctx, oval_pext_t *pext, oval_pd_t *pd, SEAP_msg_t *s_omsg,
+			     struct oval_syschar *syschar, SEXP_t **out_sexp)
+{
+	oval_pdreq_t *req;
+	int ret = 0;
+
+	req = oval_pdreq_add(pext, pd, SEAP_msg_id(s_omsg), syschar, 0, NULL, NULL);
+	req->sync = 1;
+
+	while (req->state == OVAL_PDREQ_PENDING) {
+		if (oval_pd_recvmsg(ctx, pext, pd) != 0)
+			break;
+	}
+
+	protect_errno {
+		oval_pdreq_unlink(pext, req);
+
+		if (req->state == OVAL_PDREQ_REPLIED)
+			*out_sexp = SEXP_ref(req->reply);
+		else if (req->err != NULL) {
+			_handle_SEAP_error(pd, req->err);
+			ret = -1;
+		}
+		else
+			ret = -2;
+
+		oval_pdreq_free(req);
+	}
+
+	if (ret == -1)
+		errno = ECANCELED;
+
+	return (ret);
+}
+
+static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pext_t *pext, oval_pd_t *pd, struct oval_syschar *syschar,
+			   const SEXP_t *s_iobj, int flags, SEXP_t **out_sexp)
+{
+	int retry, ret;
+
+	SEAP_msg_t *s_imsg, *s_omsg;
+	SEXP_t *s_oobj;
+
+	assume_d (pd != NULL, -1);
+        assume_d (s_iobj != NULL, -1);
+
+	for (retry = 0;;) {
+		if (oval_pd_connect(ctx, pext, pd, flags) != 0)
+			return (-1);
+
 		s_omsg = SEAP_msg_new();
 		SEAP_msg_set(s_omsg, (SEXP_t *) s_iobj);
 
@@ -510,6 +1168,12 @@ static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj,
 				return (-1);
 			}
 
+			if (pext != NULL) {
+				protect_errno {
+					oval_pd_fail(pext, pd);
+				}
+			}
+
 			if (SEAP_close(ctx, pd->sd) != 0) {
                                 char errbuf[__ERRBUF_SIZE];
 
@@ -553,11 +1217,20 @@ static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj,
 
 		/* recv_retry: */
 		s_imsg = NULL;
+		s_oobj = NULL;
+
+		if (pext != NULL)
+			ret = oval_pd_recvreply(ctx, pext, pd, s_omsg, syschar, &s_oobj);
+		else if ((ret = SEAP_recvmsg(ctx, pd->sd, &s_imsg)) == 0) {
+			s_oobj = SEAP_msg_get(s_imsg);
+			SEAP_msg_free(s_imsg);
+		}
 
-		ret = SEAP_recvmsg(ctx, pd->sd, &s_imsg);
 		if (ret != 0) {
 			protect_errno {
-				ret = _handle_SEAP_receive_failure(ctx, pd, s_omsg, flags);
+				/* errors reported by the probe were handled by oval_pd_recvreply() */
+				if (pext == NULL || ret != -1)
+					ret = _handle_SEAP_receive_failure(ctx, pd, s_omsg, flags);
 				SEAP_msg_free(s_imsg);
 				SEAP_msg_free(s_omsg);
 			}
@@ -587,9 +1260,6 @@ static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj,
 		break;
 	}
 
-	s_oobj = SEAP_msg_get(s_imsg);
-
-	SEAP_msg_free(s_imsg);
 	SEAP_msg_free(s_omsg);
 
 	*out_sexp = s_oobj;
@@ -637,7 +1307,7 @@ static int oval_probe_sys_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, struct oval_sysch
                 SEXP_free (r0);
         }
 
-        ret = oval_probe_comm(ctx, pd, s_obj, 0, &r0);
+        ret = oval_probe_comm(ctx, NULL, pd, NULL, s_obj, 0, &r0);
         SEXP_free(s_obj);
 
 	if (ret != 0)
@@ -773,11 +1443,9 @@ int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...)
         case PROBE_HANDLER_ACT_OPEN:
         {
                 char         probe_uri[PATH_MAX + 1];
-                size_t       probe_urilen;
-                char        *probe_dir;
+                char         probe_fallback[PATH_MAX + 1];
                 oval_pdsc_t *probe_dsc;
 
-                probe_dir = pext->probe_dir;
                 probe_dsc = oval_pdsc_lookup(pext->pdsc, pext->pdsc_cnt, type);
 
 		if (probe_dsc == NULL) {
@@ -787,17 +1455,16 @@ int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...)
 			break;
 		}
 
-                probe_urilen = snprintf(probe_uri, sizeof probe_uri,
-                                        "%s://%s/%s", OVAL_PROBE_SCHEME, probe_dir, probe_dsc->file);
-
-                if (probe_urilen >= sizeof probe_uri) {
+                if (oval_probe_uri(pext, probe_dsc, probe_uri, sizeof probe_uri,
+                                   probe_fallback, sizeof probe_fallback) != 0) {
                         oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
 
                         ret = -1;
                 } else {
                         dI("Starting probe on URI '%s'.", probe_uri);
 
-                        if (oval_pdtbl_add(pext->pdtbl, type, -1, probe_uri) != 0) {
+                        if (oval_pdtbl_add(pext->pdtbl, type, -1, probe_uri,
+                                           probe_fallback[0] != '\0' ? probe_fallback : NULL) != 0) {
                                 oscap_seterr (OSCAP_EFAMILY_OVAL, "%s probe not supported", probe_dsc->name);
 
                                 ret = -1;
@@ -817,6 +1484,58 @@ int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...)
         return(ret);
 }
 
+/*
+ * Find the probe descriptor for the object of the syschar, starting the
+ * probe if needed. Returns 1 if the object isn't supported.
+ */
+static int oval_pext_getpd(oval_pext_t *pext, struct oval_syschar *sys, oval_pd_t **out_pd)
+{
+	struct oval_object *obj;
+	oval_pd_t *pd;
+
+	obj = oval_syschar_get_object(sys);
+	pd = oval_pdtbl_get(pext->pdtbl, oval_object_get_subtype(obj));
+
+	if (pd == NULL) {
+		char         probe_uri[PATH_MAX + 1];
+		char         probe_fallback[PATH_MAX + 1];
+		oval_pdsc_t *probe_dsc;
+
+		probe_dsc = oval_pdsc_lookup(pext->pdsc, pext->pdsc_cnt, oval_object_get_subtype(obj));
+
+		if (probe_dsc == NULL) {
+			oval_syschar_add_new_message(sys, "OVAL object not supported", OVAL_MESSAGE_LEVEL_WARNING);
+			oval_syschar_set_flag(sys, SYSCHAR_FLAG_NOT_COLLECTED);
+			return (1);
+		}
+
+		if (oval_probe_uri(pext, probe_dsc, probe_uri, sizeof probe_uri,
+				   probe_fallback, sizeof probe_fallback) != 0) {
+			oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
+			return (-1);
+		}
+
+		dI("Starting probe on URI '%s'.", probe_uri);
+
+		if (oval_pdtbl_add(pext->pdtbl, oval_object_get_subtype(obj), -1, probe_uri,
+				   probe_fallback[0] != '\0' ? probe_fallback : NULL) != 0) {
+			oval_syschar_add_new_message(sys, "OVAL object not supported", OVAL_MESSAGE_LEVEL_WARNING);
+			oval_syschar_set_flag(sys, SYSCHAR_FLAG_NOT_COLLECTED);
+			return (1);
+		}
+
+		pd = oval_pdtbl_get(pext->pdtbl, oval_object_get_subtype(obj));
+
+		if (pd == NULL) {
+			oscap_seterr (OSCAP_EFAMILY_OVAL, "internal error");
+			return (-1);
+		}
+	}
+
+	*out_pd = pd;
+	return (0);
+}
+
 int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 {
         int          ret = 0;
@@ -829,57 +1548,63 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
         switch(act) {
         case PROBE_HANDLER_ACT_EVAL:
         {
-		struct oval_object *obj;
 		struct oval_syschar *sys;
+		oval_pdreq_t *req;
 		int flags;
 
 		sys = va_arg(ap, struct oval_syschar *);
 		flags = va_arg(ap, int);
-		obj = oval_syschar_get_object(sys);
-                pd = oval_pdtbl_get(pext->pdtbl, oval_object_get_subtype(obj));
 
-                if (pd == NULL) {
-                        char         probe_uri[PATH_MAX + 1];
-                        size_t       probe_urilen;
-                        char        *probe_dir;
-                        oval_pdsc_t *probe_dsc;
-
-                        probe_dir = pext->probe_dir;
-                        probe_dsc = oval_pdsc_lookup(pext->pdsc, pext->pdsc_cnt, oval_object_get_subtype(obj));
-
-			if (probe_dsc == NULL) {
-				oval_syschar_add_new_message(sys, "OVAL object not supported", OVAL_MESSAGE_LEVEL_WARNING);
-				oval_syschar_set_flag(sys, SYSCHAR_FLAG_NOT_COLLECTED);
+		/*
+		 * The object wasn't sent to the probe because another object
+		 * with the same content was. If that one failed, the object
+		 * is collected now.
+		 */
+		if (oscap_htable_get(pext->cobj_follow, oval_object_get_id(oval_syschar_get_object(sys))) != NULL) {
+			if (oval_pext_follow_get(pext, sys) == 1) {
 				va_end(ap);
-				return (1);
+				return (0);
 			}
+			flags &= ~OVAL_PDFLAG_INFLIGHT;
+		}
 
-                        probe_urilen = snprintf(probe_uri, sizeof probe_uri,
-                                                "%s://%s/%s", OVAL_PROBE_SCHEME, probe_dir, probe_dsc->file);
-
-                        if (probe_urilen >= sizeof probe_uri) {
-                                oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
+		/*
+		 * The object was already submitted, so just wait for the reply
+		 * instead of sending the request again.
+		 */
+		if ((req = oval_pdreq_find_syschar(pext, sys)) != NULL) {
+			if (!req->sync) {
 				va_end(ap);
-                                return (-1);
-                        }
+				return oval_pdreq_wait(pext, req, flags) == 0 ? 0 : -1;
+			}
 
-                        dI("Starting probe on URI '%s'.", probe_uri);
+			/*
+			 * The request is being waited for by oval_probe_comm()
+			 * deeper in the stack; the probe has the result once
+			 * the reply arrives.
+			 */
+			while (req->state == OVAL_PDREQ_PENDING) {
+				if (oval_pd_recvmsg(pext->pdtbl->ctx, pext, req->pd) != 0)
+					break;
+			}
 
-                        if (oval_pdtbl_add(pext->pdtbl, oval_object_get_subtype(obj), -1, probe_uri) != 0) {
-				oval_syschar_add_new_message(sys, "OVAL object not supported", OVAL_MESSAGE_LEVEL_WARNING);
-				oval_syschar_set_flag(sys, SYSCHAR_FLAG_NOT_COLLECTED);
+			if (flags & OVAL_PDFLAG_INFLIGHT) {
 				va_end(ap);
-                                return (1);
+				return (req->state == OVAL_PDREQ_REPLIED ? 0 : -1);
 			}
+		}
 
-			pd = oval_pdtbl_get(pext->pdtbl, oval_object_get_subtype(obj));
+		if (flags & OVAL_PDFLAG_INFLIGHT) {
+			va_end(ap);
+			return (0);
+		}
 
-                        if (pd == NULL) {
-                                oscap_seterr (OSCAP_EFAMILY_OVAL, "internal error");
-				va_end(ap);
-                                return (-1);
-                        }
-                }
+		ret = oval_pext_getpd(pext, sys, &pd);
+
+		if (ret != 0) {
+			va_end(ap);
+			return (ret);
+		}
 
 		ret = oval_probe_ext_eval(pext->pdtbl->ctx, pd, pext, sys, flags);
 
@@ -889,6 +1614,7 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 		if (ret < 0 && errno == ECONNABORTED) {
 			if (!(flags & OVAL_PDFLAG_SLAVE)) {
 				if (!pext->do_init) {
+					oval_pext_discard(pext);
 					oval_pdtbl_free(pext->pdtbl);
 				}
 
@@ -906,6 +1632,38 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 		va_end(ap);
 		return ret;
         }
+	case PROBE_HANDLER_ACT_SUBMIT:
+	{
+		struct oval_syschar *sys;
+		int flags;
+
+		sys = va_arg(ap, struct oval_syschar *);
+		flags = va_arg(ap, int);
+		va_end(ap);
+
+		if (oval_pdreq_find_syschar(pext, sys) != NULL)
+			return (OVAL_PROBE_SUBMITTED);
+
+		ret = oval_pext_getpd(pext, sys, &pd);
+
+		if (ret != 0)
+			return (ret);
+
+		ret = oval_probe_ext_submit(pext->pdtbl->ctx, pd, pext, sys, flags);
+
+		return (ret == 1 ? 0 : ret);
+	}
+	case PROBE_HANDLER_ACT_WAIT:
+	{
+		struct oval_syschar **out_sys;
+		int flags;
+
+		out_sys = va_arg(ap, struct oval_syschar **);
+		flags = va_arg(ap, int);
+		va_end(ap);
+
+		return oval_probe_ext_wait(pext, out_sys, flags);
+	}
         case PROBE_HANDLER_ACT_OPEN:
                 break;
         case PROBE_HANDLER_ACT_INIT:
@@ -914,6 +1672,15 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
         case PROBE_HANDLER_ACT_RESET:
 	case PROBE_HANDLER_ACT_ABORT:
         {
+		if (act == PROBE_HANDLER_ACT_RESET) {
+			/*
+			 * Replies to the submitted requests have to be received
+			 * before the probes are reset.
+			 */
+			while (oval_probe_ext_wait(pext, NULL, OVAL_PDFLAG_PREFETCH) != 1);
+			oval_pext_cobj_reset(pext);
+		}
+
                 if (type == OVAL_SUBTYPE_ALL) {
                         /*
                          * Iterate thru probe descriptor table and execute the reset operation
@@ -1051,6 +1818,8 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 {
         SEXP_t *s_obj, *s_sys;
 	struct oval_object *object;
+	oval_dcache_key_t *dkey = NULL;
+	oval_pext_cobj_t *cobj = NULL;
 	int ret;
 
 	if (syschar == NULL) {
@@ -1064,7 +1833,32 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 	if (ret != 0)
 		return (1);
 
-	ret = oval_probe_comm(ctx, pd, s_obj, flags, &s_sys);
+	/*
+	 * Results of requests made by the probes have to be stored in the
+	 * probe, so only the other ones are shared or looked up in the
+	 * persistent cache.
+	 */
+	if (!(flags & OVAL_PDFLAG_NOREPLY)) {
+		cobj = oval_pext_cobj_new(s_obj);
+
+		if (oval_pext_cobj_get(pext, cobj, syschar) == 1) {
+			oval_pext_cobj_free(cobj);
+			SEXP_free(s_obj);
+			return (0);
+		}
+	}
+
+	if (pext->dcache != NULL && !(flags & OVAL_PDFLAG_NOREPLY))
+		dkey = oval_dcache_key_new(pext->dcache, oval_object_get_subtype(object), s_obj);
+
+	if (dkey != NULL && (s_sys = oval_dcache_get(pext->dcache, dkey)) != NULL) {
+		oscap_htable_add(pext->dcache_served, oval_object_get_id(object), (void *)1);
+		oval_dcache_key_free(dkey);
+		SEXP_free(s_obj);
+		goto convert;
+	}
+
+	ret = oval_probe_comm(ctx, pext, pd, syschar, s_obj, flags, &s_sys);
 	SEXP_free(s_obj);
 
 	if (ret != 0) {
@@ -1076,6 +1870,8 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 			pd->sd = -1;
 			errno  = ECONNABORTED;
 		}
+		oval_dcache_key_free(dkey);
+		oval_pext_cobj_free(cobj);
 		return (ret);
 	}
 
@@ -1091,15 +1887,244 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 		return (0);
 	}
 
+	if (dkey != NULL) {
+		oval_dcache_put(pext->dcache, dkey, s_sys);
+		oval_dcache_key_free(dkey);
+	}
+convert:
         /*
 	 * Convert the received S-exp to OVAL system characteristic.
 	 */
 	ret = oval_sexp_to_sysch(s_sys, syschar);
 	SEXP_free(s_sys);
 
+	if (ret == 0)
+		oval_pext_cobj_put(pext, cobj, syschar);
+	oval_pext_cobj_free(cobj);
+
+	return (ret);
+}
+
+int oval_probe_ext_submit(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struct oval_syschar *syschar, int flags)
+{
+	SEXP_t *s_obj, *s_sys;
+	SEAP_msg_t *s_omsg;
+	struct oval_object *object;
+	oval_dcache_key_t *dkey = NULL;
+	oval_pext_cobj_t *cobj = NULL;
+	int ret;
+
+	if (syschar == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Internal error: syschar == NULL");
+		return (-1);
+	}
+
+	object = oval_syschar_get_object(syschar);
+	ret = oval_object_to_sexp(pext->sess_ptr, oval_subtype_to_str(oval_object_get_subtype(object)), syschar, &s_obj);
+
+	if (ret != 0)
+		return (1);
+
+	if (!(flags & OVAL_PDFLAG_NOREPLY)) {
+		oval_pdreq_t *req;
+
+		cobj = oval_pext_cobj_new(s_obj);
+
+		if (oscap_htable_get(pext->cobj_done, cobj->key) != NULL
+		    && oval_pext_cobj_get(pext, cobj, syschar) == 1) {
+			oval_pext_cobj_free(cobj);
+			SEXP_free(s_obj);
+			return (0);
+		}
+
+		/*
+		 * The same content was already submitted; the syschar is
+		 * filled from its reply when the object is queried.
+		 */
+		req = oscap_htable_get(pext->cobj_pending, cobj->key);
+		if (req != NULL && SEXP_deepcmp(req->cobj->sexp, cobj->sexp)) {
+			oval_pext_follow_add(pext, syschar, cobj);
+			SEXP_free(s_obj);
+			return (OVAL_PROBE_SUBMITTED);
+		}
+	}
+
+	if (pext->dcache != NULL && !(flags & OVAL_PDFLAG_NOREPLY))
+		dkey = oval_dcache_key_new(pext->dcache, oval_object_get_subtype(object), s_obj);
+
+	if (dkey != NULL && (s_sys = oval_dcache_get(pext->dcache, dkey)) != NULL) {
+		oscap_htable_add(pext->dcache_served, oval_object_get_id(object), (void *)1);
+		oval_dcache_key_free(dkey);
+		SEXP_free(s_obj);
+
+		ret = oval_sexp_to_sysch(s_sys, syschar);
+		SEXP_free(s_sys);
+
+		if (ret == 0)
+			oval_pext_cobj_put(pext, cobj, syschar);
+		oval_pext_cobj_free(cobj);
+
+		return (ret);
+	}
+
+	/*
+	 * Keep the number of requests the probe has to queue bounded
+	 */
+	while (pd->sd != -1 && pd->pending >= OVAL_PROBE_MAXPENDING) {
+		if (oval_pd_recvmsg(ctx, pext, pd) != 0) {
+			dW("Can't receive a message from sd=%d: %u, %s.", pd->sd, errno, strerror(errno));
+			SEAP_close(ctx, pd->sd);
+			pd->sd = -1;
+		}
+	}
+
+	if (oval_pd_connect(ctx, pext, pd, flags) != 0) {
+		oval_dcache_key_free(dkey);
+		oval_pext_cobj_free(cobj);
+		SEXP_free(s_obj);
+		return (-1);
+	}
+
+	s_omsg = SEAP_msg_new();
+	SEAP_msg_set(s_omsg, s_obj);
+	SEXP_free(s_obj);
+
+	if (flags & OVAL_PDFLAG_NOREPLY) {
+		if (SEAP_msgattr_set(s_omsg, "no-reply", NULL) != 0) {
+			dE("Can't set no-reply attribute.");
+			SEAP_msg_free(s_omsg);
+			oval_dcache_key_free(dkey);
+			oval_pext_cobj_free(cobj);
+			oscap_seterr (OSCAP_EFAMILY_OVAL, "OVAL_EPROBEUNKNOWN");
+
+			return (-1);
+		}
+	}
+
+	if (SEAP_sendmsg(ctx, pd->sd, s_omsg) != 0) {
+		protect_errno {
+			dW("Can't send message: %u, %s.", errno, strerror(errno));
+			SEAP_msg_free(s_omsg);
+			oval_dcache_key_free(dkey);
+			oval_pext_cobj_free(cobj);
+		}
+
+		if (!(flags & OVAL_PDFLAG_PREFETCH))
+			oscap_seterr (OSCAP_EFAMILY_OVAL, "Unable to send a message to probe");
+
+		if (!(flags & OVAL_PDFLAG_SLAVE)) {
+			oval_pd_fail(pext, pd);
+			SEAP_close(ctx, pd->sd);
+			pd->sd = -1;
+		}
+
+		return (-1);
+	}
+
+	oval_pdreq_add(pext, pd, SEAP_msg_id(s_omsg), syschar, flags, dkey, cobj);
+
+	SEAP_msg_free(s_omsg);
+
+	return (OVAL_PROBE_SUBMITTED);
+}
+
+static int oval_pdreq_complete(oval_pext_t *pext, oval_pdreq_t *req, int flags)
+{
+	int ret = 0;
+
+	oval_pdreq_unlink(pext, req);
+
+	if (req->state == OVAL_PDREQ_FAILED) {
+		if (!(flags & OVAL_PDFLAG_PREFETCH)) {
+			if (req->err == NULL)
+				oscap_seterr(OSCAP_EFAMILY_OVAL, "Unable to receive a message from probe");
+			else if (req->err->type == SEAP_ETYPE_USER)
+				oscap_seterr(OSCAP_EFAMILY_OVAL, "Probe at sd=%d (%s) reported an error: %s",
+					     req->pd->sd, oval_subtype_to_str(req->pd->subtype), _probe_strerror(req->err->code));
+			else
+				oscap_seterr(OSCAP_EFAMILY_OVAL, "Internal error");
+		}
+
+		ret = -1;
+	} else if (!(req->flags & OVAL_PDFLAG_NOREPLY)) {
+		if (req->dkey != NULL)
+			oval_dcache_put(pext->dcache, req->dkey, req->reply);
+
+		ret = oval_sexp_to_sysch(req->reply, req->syschar);
+
+		if (ret == 0)
+			oval_pext_cobj_put(pext, req->cobj, req->syschar);
+	} else if (req->reply != NULL) {
+		dW("Obtrusive data from probe!");
+	}
+
+	req->state  = OVAL_PDREQ_DONE;
+	req->result = ret;
+
 	return (ret);
 }
 
+/*
+ * A command sent by the probe while the reply is being waited for may
+ * query the same object again, so the request can be completed by a
+ * nested call. It's freed by the outermost one.
+ */
+static int oval_pdreq_wait(oval_pext_t *pext, oval_pdreq_t *req, int flags)
+{
+	oval_pd_t *pd = req->pd;
+	int ret;
+
+	++req->waiters;
+
+	while (req->state == OVAL_PDREQ_PENDING) {
+		if (oval_pd_recvmsg(pext->pdtbl->ctx, pext, pd) != 0) {
+			dW("Can't receive a message from sd=%d: %u, %s.", pd->sd, errno, strerror(errno));
+			oval_pd_fail(pext, pd);
+			SEAP_close(pext->pdtbl->ctx, pd->sd);
+			pd->sd = -1;
+		}
+	}
+
+	if (req->state != OVAL_PDREQ_DONE)
+		ret = oval_pdreq_complete(pext, req, flags);
+	else
+		ret = req->result;
+
+	if (--req->waiters == 0)
+		oval_pdreq_free(req);
+
+	return (ret);
+}
+
+int oval_probe_ext_wait(oval_pext_t *pext, struct oval_syschar **out_syschar, int flags)
+{
+	oval_pdreq_t *req, *oldest = NULL;
+
+	/*
+	 * Complete the oldest submitted request which already has a reply,
+	 * or wait for the oldest one.
+	 */
+	for (req = pext->req_head; req != NULL; req = req->next) {
+		if (req->sync)
+			continue;
+		if (req->state != OVAL_PDREQ_PENDING)
+			break;
+		if (oldest == NULL)
+			oldest = req;
+	}
+
+	if (req == NULL)
+		req = oldest;
+
+	if (req == NULL)
+		return (1);
+
+	if (out_syschar != NULL)
+		*out_syschar = req->syschar;
+
+	return oval_pdreq_wait(pext, req, flags);
+}
+
 int oval_probe_ext_reset(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext)
 {
         SEAP_cmd_exec(ctx, pd->sd, SEAP_EXEC_RECV, PROBECMD_RESET, NULL, SEAP_CMDTYPE_SYNC, NULL, NULL);
@@ -1112,6 +2137,8 @@ int oval_probe_ext_reset(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext)
 #include "SEAP/seap-descriptor.h"
 #include "SEAP/_seap-scheme.h"
 #include "SEAP/sch_pipe.h"
+#include "SEAP/sch_shm.h"
+#include "SEAP/sch_thread.h"
 
 int oval_probe_ext_abort(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext)
 {
@@ -1139,10 +2166,30 @@ int oval_probe_ext_abort(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext)
 		dI("Sending SIGUSR1 to pid=%u", pipeinfo->pid);
 
 		if (kill(pipeinfo->pid, SIGUSR1) != 0)
-			dW("kill(SIGUSR1, %u): %u, %s", errno, strerror(errno));
+			dW("kill(SIGUSR1, %u): %u, %s", pipeinfo->pid, errno, strerror(errno));
 
 		break;
 	}
+	case SCH_SHM:
+	{
+		sch_pipedata_t *pipeinfo = &((sch_shmdata_t *)dsc->scheme_data)->pipe;
+
+		dI("Sending SIGUSR1 to pid=%u", pipeinfo->pid);
+
+		if (kill(pipeinfo->pid, SIGUSR1) != 0)
+			dW("kill(SIGUSR1, %u): %u, %s", pipeinfo->pid, errno, strerror(errno));
+
+		break;
+	}
+	case SCH_THREAD:
+		dI("Canceling the threads of the probe module");
+
+		if (sch_thread_abort(dsc) != 0) {
+			dW("sch_thread_abort: %u, %s", errno, strerror(errno));
+			return (-1);
+		}
+
+		break;
 	default:
 		return (-1);
 	}
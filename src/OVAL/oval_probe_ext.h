@@ -27,12 +27,17 @@
 #include <stdbool.h>
 #include "oval_probe_impl.h"
 #include "oval_system_characteristics_impl.h"
+#include "oval_probe_dcache.h"
+#include "adt/oval_string_map_impl.h"
+#include "common/list.h"
 #include "common/util.h"
 
 typedef struct {
 	oval_subtype_t subtype;
 	int sd;
 	char *uri;
+	char *uri_fallback; /**< URI used if the connect to uri fails or NULL */
+	size_t pending;     /**< number of submitted requests without a reply */
 } oval_pd_t;
 
 typedef struct {
@@ -49,6 +54,8 @@ struct oval_pdsc {
 
 typedef struct oval_pdsc oval_pdsc_t;
 
+typedef struct oval_pdreq oval_pdreq_t;
+
 struct oval_pext {
         pthread_mutex_t lock;
         bool            do_init;
@@ -58,17 +65,34 @@ struct oval_pext {
         size_t        pdsc_cnt;
         oval_pdtbl_t *pdtbl;
         char         *probe_dir;
+        char         *module_dir;   /**< directory with the probe modules */
+        const char   *probe_scheme;
 
         void *sess_ptr;
         struct oval_syschar_model **model;
+
+        oval_dcache_t *dcache;   /**< persistent result cache or NULL */
+        struct oscap_htable *dcache_served; /**< ids of objects not collected by the probes */
+        int64_t fts_since; /**< start of the session for the file probe snapshots or 0 */
+
+        oval_pdreq_t *req_head; /**< submitted requests, oldest first */
+        oval_pdreq_t *req_tail;
+
+        struct oscap_htable *cobj_done;    /**< content fingerprint -> collected syschar and object S-exp */
+        struct oscap_htable *cobj_pending; /**< content fingerprint -> submitted request */
+        struct oscap_htable *cobj_follow;  /**< object id -> syschar waiting for a submitted request */
+        size_t               cobj_dups;    /**< objects not collected again because of the above */
 };
 
 typedef struct oval_pext oval_pext_t;
 
 oval_pext_t *oval_pext_new(void);
 void oval_pext_free(oval_pext_t *pext);
+int oval_pext_set_scheme(oval_pext_t *pext, const char *scheme);
 int oval_probe_ext_init(oval_pext_t *pext);
 int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struct oval_syschar *syschar, int flags);
+int oval_probe_ext_submit(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struct oval_syschar *syschar, int flags);
+int oval_probe_ext_wait(oval_pext_t *pext, struct oval_syschar **out_syschar, int flags);
 int oval_probe_ext_reset(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext);
 int oval_probe_ext_abort(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext);
 
@@ -49,12 +49,39 @@ OSCAP_HIDDEN_START;
 
 #define OVAL_PROBE_SCHEME "pipe"
 
+/*
+ * Environment variable selecting the SEAP scheme used to talk to the
+ * probes: "pipe" (default), "shm" (shared memory) or "thread" (probe
+ * modules loaded into the library process where available).
+ */
+#define OVAL_PROBE_SCHEME_ENV "OSCAP_PROBE_SCHEME"
+
 #ifndef OVAL_PROBE_DIR
 # define OVAL_PROBE_DIR    "/usr/libexec/openscap"
 #endif
 
 #define OVAL_PROBE_MAXRETRY 0
 
+/*
+ * Maximum number of submitted requests waiting for a reply from one probe.
+ * The limit keeps the probe from blocking on a reply the library doesn't
+ * read because it's blocked on sending another request.
+ */
+#define OVAL_PROBE_MAXPENDING 32
+
+/* the request was sent, its result is collected by oval_probe_ext_wait() */
+#define OVAL_PROBE_SUBMITTED 2
+
+/* don't report failed submitted requests, leave them for a synchronous query */
+#define OVAL_PDFLAG_PREFETCH 0x0100
+
+/* don't send the request, only wait for the one which is already in progress */
+#define OVAL_PDFLAG_INFLIGHT 0x0200
+
+/* scheme of the probes which can't be loaded as modules */
+#define OVAL_PROBE_SCHEME_FALLBACK "pipe"
+
+
 int oval_probe_query_test(oval_probe_session_t *sess, struct oval_test *test);
 
 OSCAP_HIDDEN_END;
@@ -70,6 +97,16 @@ void oval_probe_tblinit(void);
 const char *oval_subtype_to_str(oval_subtype_t subtype);
 oval_subtype_t oval_str_to_subtype(const char *str);
 
+int oval_probe_prefetch_definition(oval_probe_session_t *sess, struct oval_definition *definition);
+int oval_probe_prefetch_wait(oval_probe_session_t *sess);
+
+typedef struct oval_probe_order oval_probe_order_t;
+
+oval_probe_order_t *oval_probe_order_new(void);
+void oval_probe_order_free(oval_probe_order_t *ord);
+int oval_probe_order_add_definition(oval_probe_order_t *ord, struct oval_definition *definition);
+void oval_probe_order_dump(oval_probe_order_t *ord);
+int oval_probe_order_submit(oval_probe_session_t *sess, oval_probe_order_t *ord);
 int oval_probe_hint_definition(oval_probe_session_t *sess, struct oval_definition *definition, int variable_instance_hint);
 
 #endif /* OVAL_PROBE_IMPL_H */
@@ -0,0 +1,450 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "public/oval_definitions.h"
+#include "oval_definitions_impl.h"
+#include "oval_system_characteristics_impl.h"
+#include "oval_probe_impl.h"
+#include "_oval_probe_session.h"
+#include "common/list.h"
+#include "common/alloc.h"
+#include "common/debug_priv.h"
+
+/*
+ * Request order
+ *
+ * The objects of the ordered definitions are gathered before anything is
+ * sent to the probes: the objects of the tests, and the objects which the
+ * variables used by the objects, their sets and filters, and the states of
+ * the tests depend on. Every object is queued once. The objects of a set
+ * are collected by the probe together with the set, only the objects their
+ * variables depend on are queued.
+ *
+ * An object gets a stage one higher than the objects its variables depend
+ * on, so the values are known by the time it is sent. The objects of one
+ * stage are sent ordered by their type. Every object is still a request of
+ * its own, the order only lets a probe handle the requests of its type one
+ * after another.
+ */
+
+struct oval_probe_order_node {
+	struct oval_object *object;
+	size_t  seq;      /* queueing order */
+	int     stage;
+	bool    visiting; /* for breaking reference cycles */
+};
+
+struct oval_probe_order {
+	struct oscap_htable *nodes;     /* object id -> node */
+	struct oscap_htable *variables; /* variable id -> stage + 1 of its values */
+	struct oscap_htable *defs;      /* ordered definitions */
+	struct oval_probe_order_node **queue;
+	size_t  count;
+	size_t  size;
+	bool    sorted;
+};
+
+static int _order_object(oval_probe_order_t *ord, struct oval_object *object);
+static int _order_contents(oval_probe_order_t *ord, struct oval_object *object);
+static int _order_variable(oval_probe_order_t *ord, struct oval_variable *variable);
+static int _order_state(oval_probe_order_t *ord, struct oval_state *state);
+
+oval_probe_order_t *oval_probe_order_new(void)
+{
+	oval_probe_order_t *ord;
+
+	ord = oscap_talloc(oval_probe_order_t);
+	ord->nodes     = oscap_htable_new();
+	ord->variables = oscap_htable_new();
+	ord->defs      = oscap_htable_new();
+	ord->queue     = NULL;
+	ord->count     = 0;
+	ord->size      = 0;
+	ord->sorted    = true;
+
+	return ord;
+}
+
+void oval_probe_order_free(oval_probe_order_t *ord)
+{
+	if (ord == NULL)
+		return;
+
+	oscap_htable_free(ord->nodes, (oscap_destruct_func) oscap_free);
+	oscap_htable_free(ord->variables, NULL);
+	oscap_htable_free(ord->defs, NULL);
+	oscap_free(ord->queue);
+	oscap_free(ord);
+}
+
+static inline int _max(int a, int b)
+{
+	return a > b ? a : b;
+}
+
+/* Returns the stage which has to be finished before the values are known */
+static int _order_component(oval_probe_order_t *ord, struct oval_component *component)
+{
+	struct oval_component_iterator *cmp_itr;
+	int stage = 0;
+
+	if (component == NULL)
+		return 0;
+
+	switch (oval_component_get_type(component)) {
+	case OVAL_COMPONENT_OBJECTREF:
+		if (oval_component_get_object(component) != NULL)
+			stage = _order_object(ord, oval_component_get_object(component)) + 1;
+		break;
+	case OVAL_COMPONENT_VARREF:
+		stage = _order_variable(ord, oval_component_get_variable(component));
+		break;
+	case OVAL_FUNCTION_ARITHMETIC:
+	case OVAL_FUNCTION_BEGIN:
+	case OVAL_FUNCTION_CONCAT:
+	case OVAL_FUNCTION_END:
+	case OVAL_FUNCTION_ESCAPE_REGEX:
+	case OVAL_FUNCTION_REGEX_CAPTURE:
+	case OVAL_FUNCTION_SPLIT:
+	case OVAL_FUNCTION_SUBSTRING:
+	case OVAL_FUNCTION_TIMEDIF:
+	case OVAL_FUNCTION_COUNT:
+	case OVAL_FUNCTION_UNIQUE:
+	case OVAL_FUNCTION_GLOB_TO_REGEX:
+		cmp_itr = oval_component_get_function_components(component);
+		while (oval_component_iterator_has_more(cmp_itr))
+			stage = _max(stage, _order_component(ord, oval_component_iterator_next(cmp_itr)));
+		oval_component_iterator_free(cmp_itr);
+		break;
+	default:
+		break;
+	}
+
+	return stage;
+}
+
+static int _order_variable(oval_probe_order_t *ord, struct oval_variable *variable)
+{
+	const char *id;
+	void *known;
+	int stage;
+
+	if (variable == NULL || oval_variable_get_type(variable) != OVAL_VARIABLE_LOCAL)
+		return 0;
+
+	id = oval_variable_get_id(variable);
+	known = oscap_htable_get(ord->variables, id);
+	if (known != NULL)
+		return (int)(uintptr_t) known - 1;
+
+	/* a variable referencing itself is resolved as if it had no objects */
+	oscap_htable_add(ord->variables, id, (void *) 1);
+	stage = _order_component(ord, oval_variable_get_component(variable));
+	oscap_htable_detach(ord->variables, id);
+	oscap_htable_add(ord->variables, id, (void *)(uintptr_t)(stage + 1));
+
+	return stage;
+}
+
+static int _order_entity(oval_probe_order_t *ord, struct oval_entity *entity)
+{
+	oval_entity_varref_type_t vrt;
+
+	if (entity == NULL)
+		return 0;
+
+	vrt = oval_entity_get_varref_type(entity);
+	if (vrt != OVAL_ENTITY_VARREF_ATTRIBUTE && vrt != OVAL_ENTITY_VARREF_ELEMENT)
+		return 0;
+
+	return _order_variable(ord, oval_entity_get_variable(entity));
+}
+
+static int _order_state(oval_probe_order_t *ord, struct oval_state *state)
+{
+	struct oval_state_content_iterator *cont_itr;
+	int stage = 0;
+
+	if (state == NULL)
+		return 0;
+
+	cont_itr = oval_state_get_contents(state);
+	while (oval_state_content_iterator_has_more(cont_itr)) {
+		struct oval_state_content *content = oval_state_content_iterator_next(cont_itr);
+		stage = _max(stage, _order_entity(ord, oval_state_content_get_entity(content)));
+	}
+	oval_state_content_iterator_free(cont_itr);
+
+	return stage;
+}
+
+static int _order_set(oval_probe_order_t *ord, struct oval_setobject *set)
+{
+	struct oval_setobject_iterator *subset_itr;
+	struct oval_object_iterator *obj_itr;
+	struct oval_filter_iterator *fil_itr;
+	int stage = 0;
+
+	switch (oval_setobject_get_type(set)) {
+	case OVAL_SET_AGGREGATE:
+		subset_itr = oval_setobject_get_subsets(set);
+		while (oval_setobject_iterator_has_more(subset_itr))
+			stage = _max(stage, _order_set(ord, oval_setobject_iterator_next(subset_itr)));
+		oval_setobject_iterator_free(subset_itr);
+		break;
+	case OVAL_SET_COLLECTIVE:
+		obj_itr = oval_setobject_get_objects(set);
+		while (oval_object_iterator_has_more(obj_itr))
+			stage = _max(stage, _order_contents(ord, oval_object_iterator_next(obj_itr)));
+		oval_object_iterator_free(obj_itr);
+		fil_itr = oval_setobject_get_filters(set);
+		while (oval_filter_iterator_has_more(fil_itr))
+			stage = _max(stage, _order_state(ord, oval_filter_get_state(oval_filter_iterator_next(fil_itr))));
+		oval_filter_iterator_free(fil_itr);
+		break;
+	default:
+		break;
+	}
+
+	return stage;
+}
+
+/* Returns the stage which has to be finished before the object can be sent */
+static int _order_contents(oval_probe_order_t *ord, struct oval_object *object)
+{
+	struct oval_object_content_iterator *cont_itr;
+	int stage = 0;
+
+	cont_itr = oval_object_get_object_contents(object);
+	while (oval_object_content_iterator_has_more(cont_itr)) {
+		struct oval_object_content *content = oval_object_content_iterator_next(cont_itr);
+
+		switch (oval_object_content_get_type(content)) {
+		case OVAL_OBJECTCONTENT_ENTITY:
+			stage = _max(stage, _order_entity(ord, oval_object_content_get_entity(content)));
+			break;
+		case OVAL_OBJECTCONTENT_SET:
+			stage = _max(stage, _order_set(ord, oval_object_content_get_setobject(content)));
+			break;
+		case OVAL_OBJECTCONTENT_FILTER:
+			stage = _max(stage, _order_state(ord, oval_filter_get_state(oval_object_content_get_filter(content))));
+			break;
+		default:
+			break;
+		}
+	}
+	oval_object_content_iterator_free(cont_itr);
+
+	return stage;
+}
+
+static int _order_object(oval_probe_order_t *ord, struct oval_object *object)
+{
+	struct oval_probe_order_node *node;
+	const char *id;
+	int stage;
+
+	id = oval_object_get_id(object);
+	node = oscap_htable_get(ord->nodes, id);
+	if (node != NULL)
+		return node->visiting ? 0 : node->stage;
+
+	node = oscap_talloc(struct oval_probe_order_node);
+	node->object   = object;
+	node->visiting = true;
+	node->stage    = 0;
+	oscap_htable_add(ord->nodes, id, node);
+
+	stage = _order_contents(ord, object);
+
+	node->stage    = stage;
+	node->visiting = false;
+
+	/* the dependencies are queued first */
+	if (ord->count == ord->size) {
+		ord->size  = ord->size ? 2 * ord->size : 64;
+		ord->queue = oscap_realloc(ord->queue, ord->size * sizeof(struct oval_probe_order_node *));
+	}
+	node->seq = ord->count;
+	ord->queue[ord->count++] = node;
+	ord->sorted = false;
+
+	return stage;
+}
+
+static void _order_test(oval_probe_order_t *ord, struct oval_test *test)
+{
+	struct oval_object *object;
+	struct oval_state_iterator *ste_itr;
+
+	object = oval_test_get_object(test);
+	if (object == NULL)
+		return;
+	/* reported by oval_probe_query_test() */
+	if (oval_test_get_subtype(test) != oval_object_get_subtype(object))
+		return;
+
+	_order_object(ord, object);
+
+	/* objects referenced like this: test->state->variable->object */
+	ste_itr = oval_test_get_states(test);
+	while (oval_state_iterator_has_more(ste_itr))
+		_order_state(ord, oval_state_iterator_next(ste_itr));
+	oval_state_iterator_free(ste_itr);
+}
+
+static void _order_criteria(oval_probe_order_t *ord, struct oval_criteria_node *cnode)
+{
+	struct oval_criteria_node_iterator *cnode_itr;
+
+	if (cnode == NULL)
+		return;
+
+	switch (oval_criteria_node_get_type(cnode)) {
+	case OVAL_NODETYPE_CRITERION:
+		if (oval_criteria_node_get_test(cnode) != NULL)
+			_order_test(ord, oval_criteria_node_get_test(cnode));
+		break;
+	case OVAL_NODETYPE_CRITERIA:
+		cnode_itr = oval_criteria_node_get_subnodes(cnode);
+		if (cnode_itr == NULL)
+			break;
+		while (oval_criteria_node_iterator_has_more(cnode_itr))
+			_order_criteria(ord, oval_criteria_node_iterator_next(cnode_itr));
+		oval_criteria_node_iterator_free(cnode_itr);
+		break;
+	case OVAL_NODETYPE_EXTENDDEF:
+		oval_probe_order_add_definition(ord, oval_criteria_node_get_definition(cnode));
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Add the objects of the definition, including the objects of the extended
+ * definitions and the objects the variables depend on, to the request order.
+ * @returns 0 on success; -1 on error
+ */
+int oval_probe_order_add_definition(oval_probe_order_t *ord, struct oval_definition *definition)
+{
+	const char *id;
+
+	if (definition == NULL)
+		return -1;
+
+	id = oval_definition_get_id(definition);
+	if (oscap_htable_get(ord->defs, id) != NULL)
+		return 0;
+	oscap_htable_add(ord->defs, id, definition);
+
+	_order_criteria(ord, oval_definition_get_criteria(definition));
+
+	return 0;
+}
+
+static int _node_cmp(const void *a, const void *b)
+{
+	const struct oval_probe_order_node *na = *(struct oval_probe_order_node * const *) a;
+	const struct oval_probe_order_node *nb = *(struct oval_probe_order_node * const *) b;
+	oval_subtype_t ta, tb;
+
+	if (na->stage != nb->stage)
+		return na->stage < nb->stage ? -1 : 1;
+
+	ta = oval_object_get_subtype(na->object);
+	tb = oval_object_get_subtype(nb->object);
+	if (ta != tb)
+		return ta < tb ? -1 : 1;
+
+	return na->seq < nb->seq ? -1 : (na->seq > nb->seq);
+}
+
+static void _order_sort(oval_probe_order_t *ord)
+{
+	if (ord->sorted)
+		return;
+
+	qsort(ord->queue, ord->count, sizeof(struct oval_probe_order_node *), _node_cmp);
+	ord->sorted = true;
+}
+
+/**
+ * Log the runs of requests of one stage and type (verbosity INFO) and the
+ * objects in them (verbosity DEVEL).
+ */
+void oval_probe_order_dump(oval_probe_order_t *ord)
+{
+	size_t i, start;
+
+	_order_sort(ord);
+	dI("Request order: %zu objects, %d stages.", ord->count,
+	   ord->count > 0 ? ord->queue[ord->count - 1]->stage + 1 : 0);
+
+	for (start = 0; start < ord->count; start = i) {
+		struct oval_probe_order_node *first = ord->queue[start];
+		oval_subtype_t type = oval_object_get_subtype(first->object);
+
+		for (i = start; i < ord->count; ++i) {
+			if (ord->queue[i]->stage != first->stage
+			    || oval_object_get_subtype(ord->queue[i]->object) != type)
+				break;
+			dD("  %s", oval_object_get_id(ord->queue[i]->object));
+		}
+		dI("Stage %d, %s_object: %zu requests.", first->stage, oval_subtype_get_text(type), i - start);
+	}
+}
+
+/**
+ * Submit the queued objects to the probes without waiting for the results,
+ * one request per object. The objects of a stage are collected before the
+ * next stage is submitted. Objects which already have a syschar are left to
+ * @ref oval_probe_query_object.
+ * @returns 0 on success; -1 on error
+ */
+int oval_probe_order_submit(oval_probe_session_t *sess, oval_probe_order_t *ord)
+{
+	size_t i;
+
+	_order_sort(ord);
+
+	for (i = 0; i < ord->count; ++i) {
+		struct oval_object *object = ord->queue[i]->object;
+
+		if (i > 0 && ord->queue[i]->stage != ord->queue[i - 1]->stage) {
+			if (oval_probe_prefetch_wait(sess) != 0)
+				return -1;
+		}
+
+		if (oval_syschar_model_get_syschar(sess->sys_model, oval_object_get_id(object)) != NULL)
+			continue;
+		if (oval_probe_query_object_async(sess, object, OVAL_PDFLAG_PREFETCH) == -1)
+			return -1;
+	}
+
+	return 0;
+}
@@ -122,6 +122,16 @@ static void oval_probe_session_init(oval_probe_session_t *sess, struct oval_sysc
 {
         void *handler_arg;
         register size_t i;
+        pthread_mutexattr_t attr;
+
+        /*
+         * Probe commands sent back by the probes are handled while
+         * waiting for a reply and may query other objects.
+         */
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&sess->lock, &attr);
+        pthread_mutexattr_destroy(&attr);
 
         sess->ph = oval_phtbl_new();
         sess->sys_model = model;
@@ -164,6 +174,7 @@ static void oval_probe_session_free(oval_probe_session_t *sess)
 
 	oval_phtbl_free(sess->ph);
 	oval_pext_free(sess->pext);
+	pthread_mutex_destroy(&sess->lock);
 }
 
 void oval_probe_session_reinit(oval_probe_session_t *sess, struct oval_syschar_model *model)
@@ -221,6 +232,21 @@ int oval_probe_session_sethandler(oval_probe_session_t *sess, oval_subtype_t typ
         return(-1);
 }
 
+int oval_probe_session_set_scheme(oval_probe_session_t *sess, const char *scheme)
+{
+	if (sess == NULL) {
+		dE("Invalid session (NULL)");
+		return (-1);
+	}
+
+	if (oval_pext_set_scheme(sess->pext, scheme) != 0) {
+		dE("Unknown probe scheme \"%s\"", scheme);
+		return (-1);
+	}
+
+	return (0);
+}
+
 struct oval_syschar_model *oval_probe_session_getmodel(oval_probe_session_t *sess)
 {
 	if (sess == NULL) {
@@ -334,6 +334,61 @@ oval_syschar_status_t oval_record_field_get_status(struct oval_record_field *rf)
 	return ((struct oval_record_field_ITEM *) rf)->status;
 }
 
+void oval_record_field_to_image(struct oval_record_field *rf, struct oval_image *image)
+{
+	oval_image_put_int(image, rf->record_field_type);
+	oval_image_put_string(image, rf->name);
+	oval_image_put_string(image, rf->value);
+	oval_image_put_int(image, rf->datatype);
+	oval_image_put_int(image, rf->mask);
+
+	switch (rf->record_field_type) {
+	case OVAL_RECORD_FIELD_STATE:{
+			struct oval_record_field_STATE *rfs = (struct oval_record_field_STATE *) rf;
+			oval_image_put_int(image, rfs->operation);
+			oval_image_put_string(image, rfs->variable ? oval_variable_get_id(rfs->variable) : NULL);
+			oval_image_put_int(image, rfs->var_check);
+			oval_image_put_int(image, rfs->ent_check);
+		} break;
+	case OVAL_RECORD_FIELD_ITEM:
+		oval_image_put_int(image, ((struct oval_record_field_ITEM *) rf)->status);
+		break;
+	default:
+		break;
+	}
+}
+
+struct oval_record_field *oval_record_field_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_record_field *rf = oval_record_field_new(oval_image_get_int(image));
+
+	if (rf == NULL)
+		return NULL;
+
+	rf->name = oval_image_dup_string(image);
+	rf->value = oval_image_dup_string(image);
+	rf->datatype = oval_image_get_int(image);
+	rf->mask = oval_image_get_int(image);
+
+	switch (rf->record_field_type) {
+	case OVAL_RECORD_FIELD_STATE:{
+			struct oval_record_field_STATE *rfs = (struct oval_record_field_STATE *) rf;
+			const char *var_ref;
+			rfs->operation = oval_image_get_int(image);
+			if ((var_ref = oval_image_get_string(image)) != NULL)
+				rfs->variable = oval_definition_model_get_new_variable(model, var_ref, OVAL_VARIABLE_UNKNOWN);
+			rfs->var_check = oval_image_get_int(image);
+			rfs->ent_check = oval_image_get_int(image);
+		} break;
+	case OVAL_RECORD_FIELD_ITEM:
+		((struct oval_record_field_ITEM *) rf)->status = oval_image_get_int(image);
+		break;
+	default:
+		break;
+	}
+	return rf;
+}
+
 static void _oval_record_field_value_consumer(char *value, void *rf)
 {
 	oval_record_field_set_value(rf, value);
@@ -155,6 +155,23 @@ void oval_reference_set_url(struct oval_reference *ref, char *url)
 	ref->url = (url == NULL) ? NULL : oscap_strdup(url);
 }
 
+void oval_reference_to_image(struct oval_reference *ref, struct oval_image *image)
+{
+	oval_image_put_string(image, ref->source);
+	oval_image_put_string(image, ref->id);
+	oval_image_put_string(image, ref->url);
+}
+
+struct oval_reference *oval_reference_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_reference *ref = oval_reference_new(model);
+
+	ref->source = oval_image_dup_string(image);
+	ref->id = oval_image_dup_string(image);
+	ref->url = oval_image_dup_string(image);
+	return ref;
+}
+
 /*typedef void (*oval_reference_consumer)(struct oval_reference*, void*);*/
 int oval_reference_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *context, oval_reference_consumer consumer, void *user)
 {
@@ -25,6 +25,7 @@
 #endif
 
 #include <libgen.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <linux/limits.h>
@@ -37,6 +38,7 @@
 #include "source/xslt_priv.h"
 #include "public/oval_agent_api.h"
 #include "public/oval_session.h"
+#include "oval_definitions_impl.h"
 #include "../DS/public/ds_sds_session.h"
 #include "oscap_source.h"
 
@@ -47,6 +49,9 @@ struct oval_session {
 	/* Main source assigned with the main file (SDS or OVAL) */
 	struct oscap_source *source;
 	struct oval_definition_model *def_model;
+	/* the definitions were loaded from an image, OVAL_IMAGE_* flags of the image */
+	bool def_model_from_image;
+	uint32_t image_flags;
 	struct oval_variable_model *var_model;
 	struct oval_results_model *res_model;
 
@@ -78,6 +83,8 @@ struct oval_session {
 	bool full_validation;
 	bool fetch_remote_resources;
 	download_progress_calllback_t progress;
+	/* number of parallel evaluation jobs, -1 keeps the agent default */
+	int jobs;
 };
 
 struct oval_session *oval_session_new(const char *filename)
@@ -88,6 +95,21 @@ struct oval_session *oval_session_new(const char *filename)
 	session = (struct oval_session *) oscap_calloc(1, sizeof(struct oval_session));
 
 	session->source = oscap_source_new_from_file(filename);
+	session->export_sys_chars = true;
+	session->jobs = -1;
+
+	/* A valid image spares the parsing of the document, even the one which
+	 * recognizes its type. */
+	const char *image_dir = getenv(OVAL_IMAGE_DIR_ENV);
+	if (image_dir != NULL) {
+		session->def_model = oval_definition_model_load_image(session->source, image_dir, &session->image_flags);
+		if (session->def_model != NULL) {
+			session->def_model_from_image = true;
+			dI("Created a new OVAL session from the image of input file '%s'.", filename);
+			return session;
+		}
+	}
+
 	if ((scap_type = oscap_source_get_scap_type(session->source)) == OSCAP_DOCUMENT_UNKNOWN) {
 		oval_session_free(session);
 		return NULL;
@@ -100,8 +122,6 @@ struct oval_session *oval_session_new(const char *filename)
 		return NULL;
 	}
 
-	session->export_sys_chars = true;
-
 	dI("Created a new OVAL session from input file '%s'.", filename);
 	return session;
 }
@@ -199,6 +219,15 @@ static int oval_session_load_definitions(struct oval_session *session)
 	__attribute__nonnull__(session);
 	__attribute__nonnull__(session->source);
 
+	if (session->def_model_from_image) {
+		/* the image has been built from a valid document */
+		if (session->validation && !(session->image_flags & OVAL_IMAGE_VALIDATED) &&
+		    !oval_session_validate(session, session->source, OSCAP_DOCUMENT_OVAL_DEFINITIONS))
+			return 1;
+		session->oval.definitions = session->source;
+		return 0;
+	}
+
 	oscap_document_type_t type = oscap_source_get_scap_type(session->source);
 	if (type != OSCAP_DOCUMENT_OVAL_DEFINITIONS && type != OSCAP_DOCUMENT_SDS) {
 		oscap_seterr(OSCAP_EFAMILY_OVAL, "Type mismatch: %s. Expecting %s "
@@ -324,6 +353,8 @@ static int oval_session_setup_agent(struct oval_session *session)
 	oscap_free(path_clone);
 
 	oval_agent_set_product_name(session->sess, (char *)oscap_productname);
+	if (session->jobs >= 0)
+		oval_agent_set_jobs(session->sess, session->jobs);
 	return 0;
 }
 
@@ -409,8 +440,15 @@ int oval_session_export(struct oval_session *session)
 	 * directives to them */
 	if (session->res_model && (session->export.results || session->export.report)) {
 		oval_results_model_set_export_system_characteristics(session->res_model, session->export_sys_chars);
-		result = oval_results_model_export_source(session->res_model, dir_model, NULL);
 		filename = session->export.results;
+		if (!session->export.report && !(session->validation && session->full_validation)) {
+			/* Nothing else needs the document, write it out while it is
+			 * serialized instead of building it in memory first */
+			if (oval_results_model_export(session->res_model, dir_model, filename) != 0)
+				goto cleanup;
+		} else {
+			result = oval_results_model_export_source(session->res_model, dir_model, NULL);
+		}
 	}
 
 	/* Validate OVAL Results. The 'result' in condition will make sure that there is
@@ -464,6 +502,31 @@ void oval_session_set_remote_resources(struct oval_session *session, bool allowe
 	session->progress = callback;
 }
 
+void oval_session_set_jobs(struct oval_session *session, unsigned int jobs)
+{
+	session->jobs = jobs;
+}
+
+int oval_session_export_image(struct oval_session *session, const char *dir)
+{
+	__attribute__nonnull__(session);
+
+	if (session->def_model == NULL || session->oval.definitions != session->source) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Images can be built only of loaded OVAL Definitions "
+				"files, '%s' isn't one.", oscap_source_readable_origin(session->source));
+		return 1;
+	}
+
+	uint32_t flags = session->def_model_from_image ? session->image_flags : 0;
+	if (session->validation)
+		flags |= OVAL_IMAGE_VALIDATED;
+	if (oval_definition_model_save_image(session->def_model, session->source, dir, flags) != 0)
+		return 1;
+
+	dI("Exported the image of '%s' to '%s'.", oscap_source_readable_origin(session->source), dir);
+	return 0;
+}
+
 void oval_session_free(struct oval_session *session)
 {
 	if (session == NULL)
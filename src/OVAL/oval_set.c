@@ -267,6 +267,70 @@ void oval_setobject_add_filter(struct oval_setobject *set, struct oval_filter *f
 }
 
 //typedef int (*oval_xml_tag_parser)(xmlTextReaderPtr, struct oval_parser_context*, void*);
+void oval_setobject_to_image(struct oval_setobject *set, struct oval_image *image)
+{
+	oval_image_put_int(image, set->type);
+	oval_image_put_int(image, set->operation);
+
+	switch (set->type) {
+	case OVAL_SET_AGGREGATE:{
+			oval_set_AGGREGATE_t *aggregate = (oval_set_AGGREGATE_t *) set->extension;
+			oval_image_put_count(image, oval_collection_size(aggregate->subsets));
+			struct oval_setobject_iterator *subsets = oval_setobject_get_subsets(set);
+			while (oval_setobject_iterator_has_more(subsets))
+				oval_setobject_to_image(oval_setobject_iterator_next(subsets), image);
+			oval_setobject_iterator_free(subsets);
+		} break;
+	case OVAL_SET_COLLECTIVE:{
+			oval_set_COLLECTIVE_t *collective = (oval_set_COLLECTIVE_t *) set->extension;
+			oval_image_put_count(image, oval_collection_size(collective->objects));
+			struct oval_object_iterator *objects = oval_setobject_get_objects(set);
+			while (oval_object_iterator_has_more(objects))
+				oval_image_put_string(image, oval_object_get_id(oval_object_iterator_next(objects)));
+			oval_object_iterator_free(objects);
+			oval_image_put_count(image, oval_collection_size(collective->filters));
+			struct oval_filter_iterator *filters = oval_setobject_get_filters(set);
+			while (oval_filter_iterator_has_more(filters))
+				oval_filter_to_image(oval_filter_iterator_next(filters), image);
+			oval_filter_iterator_free(filters);
+		} break;
+	case OVAL_SET_UNKNOWN:
+		break;
+	}
+}
+
+struct oval_setobject *oval_setobject_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_setobject *set = oval_setobject_new(model);
+	size_t i, count;
+
+	oval_setobject_set_type(set, oval_image_get_int(image));
+	set->operation = oval_image_get_int(image);
+
+	switch (set->type) {
+	case OVAL_SET_AGGREGATE:
+		count = oval_image_get_count(image);
+		for (i = 0; i < count; ++i)
+			oval_setobject_add_subset(set, oval_setobject_from_image(image, model));
+		break;
+	case OVAL_SET_COLLECTIVE:
+		count = oval_image_get_count(image);
+		for (i = 0; i < count; ++i) {
+			const char *id = oval_image_get_string(image);
+			if (id != NULL)
+				oval_setobject_add_object(set, oval_definition_model_get_new_object(model, id));
+		}
+		count = oval_image_get_count(image);
+		for (i = 0; i < count; ++i)
+			oval_setobject_add_filter(set, oval_filter_from_image(image, model));
+		break;
+	default:
+		set->type = OVAL_SET_UNKNOWN;
+		break;
+	}
+	return set;
+}
+
 static void oval_set_consume(struct oval_setobject *subset, void *set)
 {
 	oval_setobject_add_subset(set, subset);
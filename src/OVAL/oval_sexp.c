@@ -251,6 +251,16 @@ static int oval_varref_elm_to_sexp(void *sess, struct oval_variable *var, oval_d
 		}
 		return 1;
 	}
+	if (flag == SYSCHAR_FLAG_ERROR && oval_variable_values_max_exceeded(var)) {
+		char msg[100];
+		snprintf(msg, sizeof(msg), "Referenced variable has too many values (%s).", oval_variable_get_id(var));
+		dW("%s", msg);
+		if (syschar != NULL)  {
+			oval_syschar_add_new_message(syschar, msg, OVAL_MESSAGE_LEVEL_ERROR);
+			oval_syschar_set_flag(syschar, SYSCHAR_FLAG_ERROR);
+		}
+		return 1;
+	}
 	if (flag != SYSCHAR_FLAG_COMPLETE
 	    && flag != SYSCHAR_FLAG_INCOMPLETE) {
 		*out_sexp = SEXP_list_new(NULL);
@@ -514,7 +524,8 @@ int oval_object_to_sexp(void *sess, const char *typestr, struct oval_syschar *sy
 
 			if (ret != 0) {
 				SEXP_t s_flag;
-				SEXP_number_newi_32_r(&s_flag, SYSCHAR_FLAG_DOES_NOT_EXIST);
+				SEXP_number_newi_32_r(&s_flag, oval_syschar_get_flag(syschar) == SYSCHAR_FLAG_ERROR ?
+						      SYSCHAR_FLAG_ERROR : SYSCHAR_FLAG_DOES_NOT_EXIST);
 				probe_item_attr_add(obj_sexp, "skip_eval", &s_flag);
 				SEXP_free_r(&s_flag);
 
@@ -664,6 +675,61 @@ static struct oval_record_field *oval_record_field_ITEM_from_sexp(SEXP_t *sexp)
 	return rf;
 }
 
+SEXP_t *oval_object_sexp_content(const SEXP_t *s_obj)
+{
+	SEXP_t *head, *attr, *name, *canon, *rest, *r0;
+	uint32_t i, len;
+
+	head = SEXP_list_first(s_obj);
+
+	if (head == NULL || !SEXP_listp(head)) {
+		SEXP_free(head);
+		return SEXP_ref(s_obj);
+	}
+
+	/*
+	 * Copy the name and the attributes except the id; the names of the
+	 * attributes with a value start with a colon.
+	 */
+	len   = SEXP_list_length(head);
+	name  = SEXP_list_first(head);
+	canon = SEXP_list_new(name, NULL);
+	SEXP_free(name);
+
+	for (i = 2; i <= len; ++i) {
+		bool has_value;
+
+		attr = SEXP_list_nth(head, i);
+		has_value = SEXP_stringp(attr) && SEXP_strncmp(attr, ":", 1) == 0;
+
+		if (has_value && SEXP_strcmp(attr, ":id") == 0) {
+			SEXP_free(attr);
+			++i;
+			continue;
+		}
+
+		SEXP_list_add(canon, attr);
+		SEXP_free(attr);
+
+		if (has_value && i < len) {
+			attr = SEXP_list_nth(head, ++i);
+			SEXP_list_add(canon, attr);
+			SEXP_free(attr);
+		}
+	}
+
+	r0   = SEXP_list_new(canon, NULL);
+	rest = SEXP_list_rest(s_obj);
+	SEXP_free(canon);
+	canon = rest != NULL ? SEXP_list_join(r0, rest) : SEXP_ref(r0);
+
+	SEXP_free(head);
+	SEXP_free(r0);
+	SEXP_free(rest);
+
+	return canon;
+}
+
 int oval_state_to_sexp(void *sess, struct oval_state *state, SEXP_t **out_sexp)
 {
 	SEXP_t *ste, *ste_name, *ste_ent;
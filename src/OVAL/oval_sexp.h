@@ -48,6 +48,12 @@ SEXP_t *oval_value_to_sexp(struct oval_value *val, oval_datatype_t dtype);
 int oval_object_to_sexp(void *sess, const char *typestr, struct oval_syschar *syschar, SEXP_t **out_sexp);
 int oval_state_to_sexp(void *sess, struct oval_state *state, SEXP_t **out_sexp);
 
+/*
+ * Copy of an object S-exp without the id of the object, so that the
+ * copies of objects with the same content are equal.
+ */
+SEXP_t *oval_object_sexp_content(const SEXP_t *s_obj);
+
 /*
  * S-exp -> OVAL
  */
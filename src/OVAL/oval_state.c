@@ -270,6 +270,48 @@ oval_schema_version_t oval_state_get_platform_schema_version(const struct oval_s
 	return oval_definition_model_get_platform_schema_version(state->model, platform);
 }
 
+void oval_state_to_image(struct oval_state *state, struct oval_image *image)
+{
+	oval_image_put_string(image, state->id);
+	oval_image_put_int(image, state->subtype);
+	oval_image_put_string(image, state->comment);
+	oval_image_put_int(image, state->deprecated);
+	oval_image_put_int(image, state->version);
+	oval_image_put_int(image, state->operator);
+
+	oval_image_put_count(image, oval_collection_size(state->notes));
+	struct oval_string_iterator *notes = oval_state_get_notes(state);
+	while (oval_string_iterator_has_more(notes))
+		oval_image_put_string(image, oval_string_iterator_next(notes));
+	oval_string_iterator_free(notes);
+
+	oval_image_put_count(image, oval_collection_size(state->contents));
+	struct oval_state_content_iterator *contents = oval_state_get_contents(state);
+	while (oval_state_content_iterator_has_more(contents))
+		oval_state_content_to_image(oval_state_content_iterator_next(contents), image);
+	oval_state_content_iterator_free(contents);
+}
+
+void oval_state_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_state *state = oval_definition_model_get_new_state(model, oval_image_get_string(image));
+	size_t i, count;
+
+	state->subtype = oval_image_get_int(image);
+	state->comment = oval_image_dup_string(image);
+	state->deprecated = oval_image_get_int(image);
+	state->version = oval_image_get_int(image);
+	state->operator = oval_image_get_int(image);
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_collection_add(state->notes, oval_image_dup_string(image));
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_state_add_content(state, oval_state_content_from_image(image, model));
+}
+
 static void _oval_note_consumer(char *text, void *state)
 {
 	oval_state_add_note(state, text);
@@ -185,6 +185,42 @@ void oval_state_content_set_check_existence(struct oval_state_content *content,
 	content->check_existence = existence;
 }
 
+void oval_state_content_to_image(struct oval_state_content *content, struct oval_image *image)
+{
+	oval_image_put_int(image, content->ent_check);
+	oval_image_put_int(image, content->var_check);
+	oval_image_put_int(image, content->check_existence);
+	oval_image_put_int(image, content->entity != NULL);
+	if (content->entity != NULL)
+		oval_entity_to_image(content->entity, image);
+
+	oval_image_put_count(image, oval_collection_size(content->record_fields));
+	struct oval_record_field_iterator *rf_itr = oval_state_content_get_record_fields(content);
+	while (oval_record_field_iterator_has_more(rf_itr))
+		oval_record_field_to_image(oval_record_field_iterator_next(rf_itr), image);
+	oval_record_field_iterator_free(rf_itr);
+}
+
+struct oval_state_content *oval_state_content_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_state_content *content = oval_state_content_new(model);
+	size_t i, count;
+
+	content->ent_check = oval_image_get_int(image);
+	content->var_check = oval_image_get_int(image);
+	content->check_existence = oval_image_get_int(image);
+	if (oval_image_get_int(image))
+		content->entity = oval_entity_from_image(image, model);
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i) {
+		struct oval_record_field *rf = oval_record_field_from_image(image, model);
+		if (rf != NULL)
+			oval_state_content_add_record_field(content, rf);
+	}
+	return content;
+}
+
 static void _oval_state_content_entity_consumer(struct oval_entity *entity, struct oval_state_content *content) {
 	oval_state_content_set_entity(content, entity);
 }
@@ -40,6 +40,7 @@
 #include "adt/oval_collection_impl.h"
 #include "oval_parser_impl.h"
 #include "oval_definitions_impl.h"
+#include "results/oval_cmp_evr_string_impl.h"
 
 #include "common/util.h"
 #include "common/debug_priv.h"
@@ -53,8 +54,31 @@ typedef struct oval_sysent {
 	int mask;
 	oval_datatype_t datatype;
 	oval_syschar_status_t status;
+	struct oval_sysent_parsed *parsed;	///< cache of oval_sysent_get_evr() and oval_sysent_get_versiontype()
 } oval_sysent_t;
 
+/* The value of a sysent parsed for comparisons */
+struct oval_sysent_parsed {
+	oval_datatype_t datatype;	///< OVAL_DATATYPE_EVR_STRING or OVAL_DATATYPE_VERSION
+	union {
+		struct oval_evr evr;
+		struct oval_versiontype version;
+	} u;
+};
+
+static void oval_sysent_parsed_free(struct oval_sysent_parsed *parsed)
+{
+	if (parsed == NULL)
+		return;
+
+	if (parsed->datatype == OVAL_DATATYPE_EVR_STRING)
+		oval_evr_clear(&parsed->u.evr);
+	else
+		oval_versiontype_clear(&parsed->u.version);
+
+	oscap_free(parsed);
+}
+
 struct oval_sysent *oval_sysent_new(struct oval_syschar_model *model)
 {
 	oval_sysent_t *sysent = (oval_sysent_t *) oscap_alloc(sizeof(oval_sysent_t));
@@ -67,6 +91,7 @@ struct oval_sysent *oval_sysent_new(struct oval_syschar_model *model)
 	sysent->status = SYSCHAR_STATUS_UNKNOWN;
 	sysent->datatype = OVAL_DATATYPE_UNKNOWN;
 	sysent->mask = 0;
+	sysent->parsed = NULL;
 	sysent->model = model;
 	return sysent;
 }
@@ -103,6 +128,7 @@ void oval_sysent_free(struct oval_sysent *sysent)
 		oscap_free(sysent->value);
 	if (sysent->record_fields)
 		oval_collection_free_items(sysent->record_fields, (oscap_destruct_func) oval_record_field_free);
+	oval_sysent_parsed_free(sysent->parsed);
 
 	sysent->name = NULL;
 	sysent->value = NULL;
@@ -203,6 +229,51 @@ void oval_sysent_set_value(struct oval_sysent *sysent, char *value)
 	if (sysent->value != NULL)
 		oscap_free(sysent->value);
 	sysent->value = oscap_strdup(value);
+
+	oval_sysent_parsed_free(sysent->parsed);
+	sysent->parsed = NULL;
+}
+
+static struct oval_sysent_parsed *oval_sysent_get_parsed(struct oval_sysent *sysent, oval_datatype_t datatype)
+{
+	struct oval_sysent_parsed *parsed = sysent->parsed;
+
+	if (parsed == NULL) {
+		if (sysent->value == NULL)
+			return NULL;
+
+		parsed = oscap_talloc(struct oval_sysent_parsed);
+		parsed->datatype = datatype;
+		if (datatype == OVAL_DATATYPE_EVR_STRING)
+			oval_evr_parse(sysent->value, &parsed->u.evr);
+		else
+			oval_versiontype_parse(sysent->value, &parsed->u.version);
+
+		/* items are shared by objects evaluated in parallel, keep the first one */
+		if (!__sync_bool_compare_and_swap(&sysent->parsed, NULL, parsed)) {
+			oval_sysent_parsed_free(parsed);
+			parsed = sysent->parsed;
+		}
+	}
+
+	/* the same value compared as another datatype isn't cached */
+	return parsed->datatype == datatype ? parsed : NULL;
+}
+
+const struct oval_evr *oval_sysent_get_evr(struct oval_sysent *sysent)
+{
+	struct oval_sysent_parsed *parsed;
+
+	parsed = oval_sysent_get_parsed(sysent, OVAL_DATATYPE_EVR_STRING);
+	return parsed != NULL ? &parsed->u.evr : NULL;
+}
+
+const struct oval_versiontype *oval_sysent_get_versiontype(struct oval_sysent *sysent)
+{
+	struct oval_sysent_parsed *parsed;
+
+	parsed = oval_sysent_get_parsed(sysent, OVAL_DATATYPE_VERSION);
+	return parsed != NULL ? &parsed->u.version : NULL;
 }
 
 void oval_sysent_add_record_field(struct oval_sysent *sysent, struct oval_record_field *rf)
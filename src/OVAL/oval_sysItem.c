@@ -49,9 +49,15 @@ typedef struct oval_sysitem {
 	char *id;
 	struct oval_collection *messages;
 	struct oval_collection *sysents;
+	struct oval_sysent_array *sysent_array;	///< cache of oval_sysitem_get_sysent_array()
 	oval_syschar_status_t status;
 } oval_sysitem_t;				///< Represents a single <*_item> element
 
+struct oval_sysent_array {
+	size_t count;
+	struct oval_sysent *sysents[];
+};
+
 struct oval_sysitem *oval_sysitem_new(struct oval_syschar_model *model, const char *id)
 {
 	__attribute__nonnull__(model);
@@ -66,6 +72,7 @@ struct oval_sysitem *oval_sysitem_new(struct oval_syschar_model *model, const ch
 	sysitem->status = SYSCHAR_STATUS_UNKNOWN;
 	sysitem->messages = oval_collection_new();
 	sysitem->sysents = oval_collection_new();
+	sysitem->sysent_array = NULL;
 	sysitem->model = model;
 
 	oval_syschar_model_add_sysitem(model, sysitem);
@@ -106,6 +113,7 @@ void oval_sysitem_free(struct oval_sysitem *sysitem)
 
 	oval_collection_free_items(sysitem->messages, (oscap_destruct_func) oval_message_free);
 	oval_collection_free_items(sysitem->sysents, (oscap_destruct_func) oval_sysent_free);
+	oscap_free(sysitem->sysent_array);
 	oscap_free(sysitem->id);
 
 	sysitem->id = NULL;
@@ -170,10 +178,40 @@ struct oval_sysent_iterator *oval_sysitem_get_sysents(struct oval_sysitem *sysit
 	return (struct oval_sysent_iterator *)oval_collection_iterator(sysitem->sysents);
 }
 
+size_t oval_sysitem_get_sysent_array(struct oval_sysitem *sysitem, struct oval_sysent * const **array)
+{
+	__attribute__nonnull__(sysitem);
+
+	struct oval_sysent_array *sa = sysitem->sysent_array;
+
+	if (sa == NULL) {
+		void **items = NULL;
+		size_t size = 0, count;
+
+		count = oval_collection_to_array(sysitem->sysents, &items, &size);
+		sa = oscap_alloc(sizeof(struct oval_sysent_array) + count * sizeof(struct oval_sysent *));
+		sa->count = count;
+		if (count > 0)
+			memcpy(sa->sysents, items, count * sizeof(struct oval_sysent *));
+		oscap_free(items);
+
+		/* items are shared by objects evaluated in parallel, keep the first array */
+		if (!__sync_bool_compare_and_swap(&sysitem->sysent_array, NULL, sa)) {
+			oscap_free(sa);
+			sa = sysitem->sysent_array;
+		}
+	}
+
+	*array = sa->sysents;
+	return sa->count;
+}
+
 void oval_sysitem_add_sysent(struct oval_sysitem *sysitem, struct oval_sysent *sysent)
 {
 	__attribute__nonnull__(sysitem);
 	oval_collection_add(sysitem->sysents, sysent);
+	oscap_free(sysitem->sysent_array);
+	sysitem->sysent_array = NULL;
 }
 
 oval_syschar_status_t oval_sysitem_get_status(struct oval_sysitem *data)
@@ -34,6 +34,7 @@
 
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "oval_definitions_impl.h"
 #include "oval_agent_api_impl.h"
@@ -43,6 +44,7 @@
 #include "adt/oval_smc_iterator_impl.h"
 #include "oval_system_characteristics_impl.h"
 #include "oval_probe_impl.h"
+#include "oval_xml_stream_impl.h"
 #include "common/util.h"
 #include "common/debug_priv.h"
 #include "common/_error.h"
@@ -58,6 +60,7 @@ typedef struct oval_syschar_model {
 	struct oval_smc *syschar_map;				///< Represents objects within <collected_objects> element
 	struct oval_string_map *sysitem_map;			///< Represents items within <system_data> element
         char *schema;
+	pthread_rwlock_t lock;					///< Guards the maps against parallel evaluation jobs
 } oval_syschar_model_t;						///< Represents <oval_system_characteristics> element
 
 
@@ -79,6 +82,7 @@ struct oval_syschar_model *oval_syschar_model_new(struct oval_definition_model *
 	newmodel->syschar_map = oval_smc_new();
 	newmodel->sysitem_map = oval_string_map_new();
         newmodel->schema = oscap_strdup(OVAL_SYS_SCHEMA_LOCATION);
+	pthread_rwlock_init(&newmodel->lock, NULL);
 
 	/* check possible allocation problems */
 	if ((newmodel->syschar_map == NULL) || (newmodel->sysitem_map == NULL) ) {
@@ -143,18 +147,21 @@ void oval_syschar_model_free(struct oval_syschar_model *model)
 			oval_string_map_free(model->sysitem_map, (oscap_destruct_func) oval_sysitem_free);
 		oscap_free(model->schema);
 		oval_generator_free(model->generator);
+		pthread_rwlock_destroy(&model->lock);
 		oscap_free(model);
 	}
 }
 
 void oval_syschar_model_reset(struct oval_syschar_model *model) 
 {
+	pthread_rwlock_wrlock(&model->lock);
         if (model->syschar_map)
                 oval_smc_free(model->syschar_map, (oscap_destruct_func) oval_syschar_free);
         if (model->sysitem_map)
                 oval_string_map_free(model->sysitem_map, (oscap_destruct_func) oval_sysitem_free);
         model->syschar_map = oval_smc_new();
         model->sysitem_map = oval_string_map_new();
+	pthread_rwlock_unlock(&model->lock);
 }
 
 struct oval_generator *oval_syschar_model_get_generator(struct oval_syschar_model *model)
@@ -215,8 +222,11 @@ void oval_syschar_model_add_syschar(struct oval_syschar_model *model, struct ova
 {
 	__attribute__nonnull__(model);
 	const char *id = oval_syschar_get_id(syschar);
-	if (id != NULL)
+	if (id != NULL) {
+		pthread_rwlock_wrlock(&model->lock);
 		oval_smc_put_last(model->syschar_map, id, syschar);
+		pthread_rwlock_unlock(&model->lock);
+	}
 }
 
 void oval_syschar_model_add_sysitem(struct oval_syschar_model *model, struct oval_sysitem *sysitem)
@@ -224,7 +234,9 @@ void oval_syschar_model_add_sysitem(struct oval_syschar_model *model, struct ova
 	__attribute__nonnull__(model);
 	char *id = oval_sysitem_get_id(sysitem);
 	if (id != NULL) {
+		pthread_rwlock_wrlock(&model->lock);
 		oval_string_map_put(model->sysitem_map, id, sysitem);
+		pthread_rwlock_unlock(&model->lock);
 	}
 }
 
@@ -284,16 +296,28 @@ int oval_syschar_model_bind_variable_model(struct oval_syschar_model *sysmodel,
 
 struct oval_syschar *oval_syschar_model_get_syschar(struct oval_syschar_model *model, const char *object_id)
 {
+	struct oval_syschar *syschar;
+
 	__attribute__nonnull__(model);
 
-	return (struct oval_syschar *)oval_smc_get_last(model->syschar_map, object_id);
+	pthread_rwlock_rdlock(&model->lock);
+	syschar = oval_smc_get_last(model->syschar_map, object_id);
+	pthread_rwlock_unlock(&model->lock);
+
+	return syschar;
 }
 
 struct oval_sysitem *oval_syschar_model_get_sysitem(struct oval_syschar_model *model, const char *id)
 {
+	struct oval_sysitem *sysitem;
+
 	__attribute__nonnull__(model);
 
-	return (struct oval_sysitem *)oval_string_map_get_value(model->sysitem_map, id);
+	pthread_rwlock_rdlock(&model->lock);
+	sysitem = oval_string_map_get_value(model->sysitem_map, id);
+	pthread_rwlock_unlock(&model->lock);
+
+	return sysitem;
 }
 
 
@@ -343,6 +367,7 @@ xmlNode *oval_syschar_model_to_dom(struct oval_syschar_model * syschar_model, xm
 	xmlSetNs(root_node, ns_lin);
 	xmlSetNs(root_node, ns_win);
 	xmlSetNs(root_node, ns_syschar);
+	oval_xml_stream_open(doc, root_node);
 
         /* Always report the generator */
 	oval_generator_to_dom(syschar_model->generator, doc, root_node);
@@ -351,6 +376,7 @@ xmlNode *oval_syschar_model_to_dom(struct oval_syschar_model * syschar_model, xm
 	oval_sysinfo_to_dom(oval_syschar_model_get_sysinfo(syschar_model), doc, root_node);
 
 	if (!export_syschar) {
+		oval_xml_stream_close(doc, root_node);
 		return root_node;
 	}
 
@@ -371,6 +397,7 @@ xmlNode *oval_syschar_model_to_dom(struct oval_syschar_model * syschar_model, xm
 	struct oval_string_map *sysitem_map = oval_string_map_new();
 	if (oval_syschar_iterator_has_more(syschars)) {
 		xmlNode *tag_objects = xmlNewTextChild(root_node, ns_syschar, BAD_CAST "collected_objects", NULL);
+		oval_xml_stream_open(doc, tag_objects);
 
 		while (oval_syschar_iterator_has_more(syschars)) {
 			struct oval_syschar *syschar = oval_syschar_iterator_next(syschars);
@@ -379,6 +406,7 @@ xmlNode *oval_syschar_model_to_dom(struct oval_syschar_model * syschar_model, xm
 			    || oval_object_get_base_obj(object)) /* Skip internal objects */
 				continue;
 			oval_syschar_to_dom(syschar, doc, tag_objects);
+			oval_xml_stream_flush(doc, tag_objects);
 			struct oval_sysitem_iterator *sysitems = oval_syschar_get_sysitem(syschar);
 			while (oval_sysitem_iterator_has_more(sysitems)) {
 				struct oval_sysitem *sysitem = oval_sysitem_iterator_next(sysitems);
@@ -386,6 +414,7 @@ xmlNode *oval_syschar_model_to_dom(struct oval_syschar_model * syschar_model, xm
 			}
 			oval_sysitem_iterator_free(sysitems);
 		}
+		oval_xml_stream_close(doc, tag_objects);
 	}
 	oval_smc_free0(resolved_smc);
 	oval_syschar_iterator_free(syschars);
@@ -393,15 +422,19 @@ xmlNode *oval_syschar_model_to_dom(struct oval_syschar_model * syschar_model, xm
 	struct oval_iterator *sysitems = oval_string_map_values(sysitem_map);
 	if (oval_collection_iterator_has_more(sysitems)) {
 		xmlNode *tag_items = xmlNewTextChild(root_node, ns_syschar, BAD_CAST "system_data", NULL);
+		oval_xml_stream_open(doc, tag_items);
 		while (oval_collection_iterator_has_more(sysitems)) {
 			struct oval_sysitem *sysitem = (struct oval_sysitem *)
 			    oval_collection_iterator_next(sysitems);
 			oval_sysitem_to_dom(sysitem, doc, tag_items);
+			oval_xml_stream_flush(doc, tag_items);
 		}
+		oval_xml_stream_close(doc, tag_items);
 	}
 	oval_collection_iterator_free(sysitems);
 	oval_string_map_free(sysitem_map, NULL);
 
+	oval_xml_stream_close(doc, root_node);
 	return root_node;
 }
 
@@ -417,8 +450,14 @@ int oval_syschar_model_export(struct oval_syschar_model *model, const char *file
 		oscap_setxmlerr(xmlGetLastError());
 		return -1;
 	}
+	if (oval_xml_stream_start(doc, file) != 0) {
+		xmlFreeDoc(doc);
+		return -1;
+	}
 
 	oval_syschar_model_to_dom(model, doc, NULL, NULL, NULL, true);
-	return oscap_xml_save_filename_free(file, doc);
+	int ret = oval_xml_stream_finish(doc);
+	xmlFreeDoc(doc);
+	return (ret == 0) ? 1 : -1;
 }
 
@@ -50,6 +50,8 @@ int oval_sysinfo_parse_tag(xmlTextReaderPtr reader, struct oval_parser_context *
 /* sysitem */
 void oval_sysitem_to_dom(struct oval_sysitem *, xmlDoc *, xmlNode *);
 int oval_sysitem_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, void *usr);
+/* sysents of an item without an iterator, the array is kept by the item until a sysent is added */
+size_t oval_sysitem_get_sysent_array(struct oval_sysitem *, struct oval_sysent * const **array);
 
 /* syschar */
 void oval_syschar_to_dom(struct oval_syschar *, xmlDoc *, xmlNode *);
@@ -63,6 +65,9 @@ typedef void (*oval_sysent_consumer) (struct oval_sysent *, void *client);
 int oval_sysent_parse_tag(xmlTextReaderPtr, struct oval_parser_context *, oval_sysent_consumer, void *);
 void oval_sysent_to_dom(struct oval_sysent *sysent, xmlDoc * doc, xmlNode * tag_parent);
 void oval_sysent_to_print(struct oval_sysent *, char *, int);
+/* the value parsed on first use and kept by the sysent, NULL if there's no value */
+const struct oval_evr *oval_sysent_get_evr(struct oval_sysent *);
+const struct oval_versiontype *oval_sysent_get_versiontype(struct oval_sysent *);
 
 /* syschar_model */
 typedef bool oval_syschar_resolver(struct oval_syschar *, void *);
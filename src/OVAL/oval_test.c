@@ -337,6 +337,58 @@ void oval_test_add_note(struct oval_test *test, char *note)
 	oval_collection_add(test->notes, (void *)oscap_strdup(note));
 }
 
+void oval_test_to_image(struct oval_test *test, struct oval_image *image)
+{
+	oval_image_put_string(image, test->id);
+	oval_image_put_int(image, test->subtype);
+	oval_image_put_string(image, test->comment);
+	oval_image_put_int(image, test->deprecated);
+	oval_image_put_int(image, test->version);
+	oval_image_put_int(image, test->existence);
+	oval_image_put_int(image, test->check);
+	oval_image_put_int(image, test->state_operator);
+	oval_image_put_string(image, test->object ? oval_object_get_id(test->object) : NULL);
+
+	oval_image_put_count(image, oval_collection_size(test->states));
+	struct oval_state_iterator *states = oval_test_get_states(test);
+	while (oval_state_iterator_has_more(states))
+		oval_image_put_string(image, oval_state_get_id(oval_state_iterator_next(states)));
+	oval_state_iterator_free(states);
+
+	oval_image_put_count(image, oval_collection_size(test->notes));
+	struct oval_string_iterator *notes = oval_test_get_notes(test);
+	while (oval_string_iterator_has_more(notes))
+		oval_image_put_string(image, oval_string_iterator_next(notes));
+	oval_string_iterator_free(notes);
+}
+
+void oval_test_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	struct oval_test *test = oval_definition_model_get_new_test(model, oval_image_get_string(image));
+	const char *id;
+	size_t i, count;
+
+	test->subtype = oval_image_get_int(image);
+	test->comment = oval_image_dup_string(image);
+	test->deprecated = oval_image_get_int(image);
+	test->version = oval_image_get_int(image);
+	test->existence = oval_image_get_int(image);
+	test->check = oval_image_get_int(image);
+	test->state_operator = oval_image_get_int(image);
+	if ((id = oval_image_get_string(image)) != NULL)
+		test->object = oval_definition_model_get_new_object(model, id);
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i) {
+		if ((id = oval_image_get_string(image)) != NULL)
+			oval_test_add_state(test, oval_definition_model_get_new_state(model, id));
+	}
+
+	count = oval_image_get_count(image);
+	for (i = 0; i < count; ++i)
+		oval_collection_add(test->notes, oval_image_dup_string(image));
+}
+
 static void _oval_test_parse_notes_consumer(char *text, void *test)
 {
 	oval_test_add_note(test, text);
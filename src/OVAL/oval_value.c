@@ -145,6 +145,21 @@ void oval_value_free(struct oval_value *value)
 	}
 }
 
+void oval_value_to_image(struct oval_value *value, struct oval_image *image)
+{
+	oval_image_put_int(image, value->datatype);
+	oval_image_put_string(image, value->text);
+}
+
+struct oval_value *oval_value_from_image(struct oval_image *image)
+{
+	oval_value_t *value = (oval_value_t *) oscap_alloc(sizeof(oval_value_t));
+
+	value->datatype = oval_image_get_int(image);
+	value->text = oval_image_dup_string(image);
+	return value;
+}
+
 int oval_value_cast(struct oval_value *value, oval_datatype_t new_dt)
 {
 	/*
@@ -33,7 +33,9 @@ static void _oval_object_fill_vardef(struct oval_object *object, struct oval_str
 static void _oval_setobject_fill_vardef(struct oval_setobject *set, struct oval_string_map *vardef, const char *definition_id);
 static void _oval_state_fill_vardef(struct oval_state *state, struct oval_string_map *vardef, const char *definition_id);
 static void _oval_entity_fill_vardef(struct oval_entity *entity, struct oval_string_map *vardef, const char *definition_id);
-static void _vardef_insert(struct oval_string_map *vardef, const char *definition_id, const char *variable_id);
+static void _oval_variable_fill_vardef(struct oval_variable *variable, struct oval_string_map *vardef, const char *definition_id);
+static void _oval_component_fill_vardef(struct oval_component *component, struct oval_string_map *vardef, const char *definition_id);
+static bool _vardef_insert(struct oval_string_map *vardef, const char *definition_id, const char *variable_id);
 
 struct oval_string_map *oval_definition_model_build_vardef_mapping(struct oval_definition_model *model)
 {
@@ -173,16 +175,60 @@ void _oval_entity_fill_vardef(struct oval_entity *entity, struct oval_string_map
 		oval_entity_get_varref_type(entity) == OVAL_ENTITY_VARREF_ELEMENT) {
 		struct oval_variable *variable = oval_entity_get_variable(entity);
 		if (variable != NULL)
-			_vardef_insert(vardef, definition_id, oval_variable_get_id(variable));
+			_oval_variable_fill_vardef(variable, vardef, definition_id);
 	}
 }
 
-void _vardef_insert(struct oval_string_map *vardef, const char *definition_id, const char *variable_id)
+void _oval_variable_fill_vardef(struct oval_variable *variable, struct oval_string_map *vardef, const char *definition_id)
+{
+	if (!_vardef_insert(vardef, definition_id, oval_variable_get_id(variable)))
+		return;
+	/* The definition also depends on whatever the local variable is computed from. */
+	if (oval_variable_get_type(variable) == OVAL_VARIABLE_LOCAL) {
+		struct oval_component *component = oval_variable_get_component(variable);
+		if (component != NULL)
+			_oval_component_fill_vardef(component, vardef, definition_id);
+	}
+}
+
+void _oval_component_fill_vardef(struct oval_component *component, struct oval_string_map *vardef, const char *definition_id)
+{
+	switch (oval_component_get_type(component)) {
+	case OVAL_COMPONENT_LITERAL:
+		break;
+	case OVAL_COMPONENT_OBJECTREF:{
+		struct oval_object *object = oval_component_get_object(component);
+		if (object != NULL)
+			_oval_object_fill_vardef(object, vardef, definition_id);
+		} break;
+	case OVAL_COMPONENT_VARREF:{
+		struct oval_variable *variable = oval_component_get_variable(component);
+		if (variable != NULL)
+			_oval_variable_fill_vardef(variable, vardef, definition_id);
+		} break;
+	default:{
+		struct oval_component_iterator *subcomp_it = oval_component_get_function_components(component);
+		if (subcomp_it == NULL)
+			break;
+		while (oval_component_iterator_has_more(subcomp_it)) {
+			struct oval_component *subcomp = oval_component_iterator_next(subcomp_it);
+			_oval_component_fill_vardef(subcomp, vardef, definition_id);
+		}
+		oval_component_iterator_free(subcomp_it);
+		} break;
+	}
+}
+
+/* Returns false if the variable was already known to the definition. */
+bool _vardef_insert(struct oval_string_map *vardef, const char *definition_id, const char *variable_id)
 {
 	struct oval_string_map *def_list = (struct oval_string_map *) oval_string_map_get_value(vardef, variable_id);
 	if (def_list == NULL) {
 		def_list = oval_string_map_new();
 		oval_string_map_put(vardef, variable_id, def_list);
 	}
+	if (oval_string_map_get_value(def_list, definition_id) != NULL)
+		return false;
 	oval_string_map_put(def_list, definition_id, (void *) "");
+	return true;
 }
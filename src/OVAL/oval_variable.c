@@ -76,6 +76,8 @@ typedef struct {
 	VAR_BASE;
 	struct oval_component *component;
 	struct oval_collection *values;
+	unsigned int generation;
+	bool values_max_exceeded;
 } oval_variable_LOCAL_t;
 
 typedef struct {
@@ -313,6 +315,39 @@ oval_syschar_collection_flag_t oval_variable_get_collection_flag(struct oval_var
 	return variable->flag;
 }
 
+bool oval_variable_values_max_exceeded(struct oval_variable *variable)
+{
+	__attribute__nonnull__(variable);
+
+	if (variable->type != OVAL_VARIABLE_LOCAL)
+		return false;
+
+	return ((oval_variable_LOCAL_t *) variable)->values_max_exceeded;
+}
+
+/*
+ * The values of a local variable are computed once for each generation of the
+ * external variable bindings (see oval_definition_model_bump_variable_generation).
+ * Returns true if the variable has values of the current generation, otherwise
+ * drops the stale ones so that the caller computes the variable again.
+ */
+static bool oval_variable_LOCAL_is_current(oval_variable_LOCAL_t *var)
+{
+	unsigned int generation = oval_definition_model_get_variable_generation(var->model);
+
+	if (var->flag != SYSCHAR_FLAG_UNKNOWN && var->generation == generation)
+		return true;
+
+	if (var->values) {
+		oval_collection_free_items(var->values, (oscap_destruct_func) oval_value_free);
+		var->values = NULL;
+	}
+	var->flag = SYSCHAR_FLAG_UNKNOWN;
+	var->generation = generation;
+	var->values_max_exceeded = false;
+	return false;
+}
+
 int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struct oval_variable *variable)
 {
 	oval_variable_LOCAL_t *var;
@@ -325,14 +360,14 @@ int oval_syschar_model_compute_variable(struct oval_syschar_model *sysmod, struc
 		return 0;
 
 	var = (oval_variable_LOCAL_t *) variable;
-	if (var->flag != SYSCHAR_FLAG_UNKNOWN)
+	if (oval_variable_LOCAL_is_current(var))
 		return 0;
 
 	component = var->component;
         if (component) {
 		if (!var->values)
 			var->values = oval_collection_new();
-		var->flag = oval_component_compute(sysmod, component, var->values);
+		var->flag = oval_component_compute(sysmod, component, var->values, &var->values_max_exceeded);
 	} else {
 		dW("NULL component bound to a variable, id: %s.", var->id);
 		return -1;
@@ -367,7 +402,7 @@ int oval_probe_query_variable(oval_probe_session_t *sess, struct oval_variable *
 		return 0;
 
 	var = (oval_variable_LOCAL_t *) variable;
-	if (var->flag != SYSCHAR_FLAG_UNKNOWN)
+	if (oval_variable_LOCAL_is_current(var))
 		return 0;
 
 	dI("Querying variable '%s'.", var->id);
@@ -375,7 +410,7 @@ int oval_probe_query_variable(oval_probe_session_t *sess, struct oval_variable *
         if (component) {
 		if (!var->values)
 			var->values = oval_collection_new();
-		var->flag = oval_component_query(sess, component, var->values);
+		var->flag = oval_component_query(sess, component, var->values, &var->values_max_exceeded);
 	} else {
 		dW("NULL component bound to a variable, id: %s.", var->id);
 		return -1;
@@ -481,6 +516,8 @@ struct oval_variable *oval_variable_new(struct oval_definition_model *model, con
 			lvar->component = NULL;
 			lvar->values = NULL;
 			lvar->flag = SYSCHAR_FLAG_UNKNOWN;
+			lvar->generation = 0;
+			lvar->values_max_exceeded = false;
 		}
 		break;
 	case OVAL_VARIABLE_UNKNOWN:{
@@ -598,6 +635,7 @@ struct oval_variable *oval_variable_clone(struct oval_definition_model *new_mode
 
 			old_lvar = (oval_variable_LOCAL_t *) old_variable;
 			lvar->component = oval_component_clone(new_model, old_lvar->component);
+			lvar->values_max_exceeded = old_lvar->values_max_exceeded;
 
 			break;
 		}
@@ -700,6 +738,8 @@ void oval_variable_set_type(struct oval_variable *variable, oval_variable_type_t
 		lvar->component = NULL;
 		lvar->values = NULL;
 		lvar->flag = SYSCHAR_FLAG_UNKNOWN;
+		lvar->generation = 0;
+		lvar->values_max_exceeded = false;
 
 		break;
 	}
@@ -865,6 +905,8 @@ int oval_variable_bind_ext_var(struct oval_variable *var, struct oval_variable_m
 
 	evar = (oval_variable_EXTERNAL_t *) var;
 	struct oval_collection *values_ref = oval_variable_model_get_values_ref(varmod, extvar_id);
+	/* local variables computed from the unbound variable are stale now */
+	oval_definition_model_bump_variable_generation(var->model);
 	if (oval_variable_validate_ext_var(evar, values_ref)) {
 		evar->flag = SYSCHAR_FLAG_DOES_NOT_EXIST;
 		return 1;
@@ -885,6 +927,117 @@ void oval_variable_set_component(struct oval_variable *variable, struct oval_com
 	}
 }
 
+void oval_variable_to_image(struct oval_variable *variable, struct oval_image *image)
+{
+	struct oval_iterator *itr;
+
+	oval_image_put_string(image, variable->id);
+	oval_image_put_int(image, variable->type);
+	oval_image_put_int(image, variable->version);
+	oval_image_put_int(image, variable->datatype);
+	oval_image_put_string(image, variable->comment);
+	oval_image_put_int(image, variable->deprecated);
+
+	switch (variable->type) {
+	case OVAL_VARIABLE_CONSTANT:{
+			oval_variable_CONSTANT_t *cvar = (oval_variable_CONSTANT_t *) variable;
+			oval_image_put_count(image, cvar->values ? oval_collection_size(cvar->values) : 0);
+			if (cvar->values == NULL)
+				break;
+			itr = oval_collection_iterator(cvar->values);
+			while (oval_collection_iterator_has_more(itr))
+				oval_value_to_image(oval_collection_iterator_next(itr), image);
+			oval_collection_iterator_free(itr);
+		} break;
+	case OVAL_VARIABLE_EXTERNAL:{
+			oval_variable_EXTERNAL_t *evar = (oval_variable_EXTERNAL_t *) variable;
+			oval_image_put_count(image, oval_collection_size(evar->possible_values));
+			itr = oval_collection_iterator(evar->possible_values);
+			while (oval_collection_iterator_has_more(itr)) {
+				struct oval_variable_possible_value *pv = oval_collection_iterator_next(itr);
+				oval_image_put_string(image, pv->hint);
+				oval_image_put_string(image, pv->value);
+			}
+			oval_collection_iterator_free(itr);
+			oval_image_put_count(image, oval_collection_size(evar->possible_restrictions));
+			itr = oval_collection_iterator(evar->possible_restrictions);
+			while (oval_collection_iterator_has_more(itr)) {
+				struct oval_variable_possible_restriction *pr = oval_collection_iterator_next(itr);
+				oval_image_put_int(image, pr->operator);
+				oval_image_put_string(image, pr->hint);
+				oval_image_put_count(image, oval_collection_size(pr->restrictions));
+				struct oval_iterator *r_itr = oval_collection_iterator(pr->restrictions);
+				while (oval_collection_iterator_has_more(r_itr)) {
+					struct oval_variable_restriction *r = oval_collection_iterator_next(r_itr);
+					oval_image_put_int(image, r->operation);
+					oval_image_put_string(image, r->value);
+				}
+				oval_collection_iterator_free(r_itr);
+			}
+			oval_collection_iterator_free(itr);
+		} break;
+	case OVAL_VARIABLE_LOCAL:{
+			oval_variable_LOCAL_t *lvar = (oval_variable_LOCAL_t *) variable;
+			oval_image_put_int(image, lvar->component != NULL);
+			if (lvar->component != NULL)
+				oval_component_to_image(lvar->component, image);
+		} break;
+	default:
+		break;
+	}
+}
+
+void oval_variable_from_image(struct oval_image *image, struct oval_definition_model *model)
+{
+	const char *id = oval_image_get_string(image);
+	oval_variable_type_t type = oval_image_get_int(image);
+	struct oval_variable *variable = oval_definition_model_get_new_variable(model, id, type);
+	size_t i, j, count;
+
+	if (variable == NULL)
+		return;
+
+	variable->version = oval_image_get_int(image);
+	variable->datatype = oval_image_get_int(image);
+	variable->comment = oval_image_dup_string(image);
+	variable->deprecated = oval_image_get_int(image);
+
+	switch (variable->type) {
+	case OVAL_VARIABLE_CONSTANT:
+		count = oval_image_get_count(image);
+		for (i = 0; i < count; ++i)
+			oval_variable_add_value(variable, oval_value_from_image(image));
+		break;
+	case OVAL_VARIABLE_EXTERNAL:
+		count = oval_image_get_count(image);
+		for (i = 0; i < count; ++i) {
+			const char *hint = oval_image_get_string(image);
+			const char *value = oval_image_get_string(image);
+			oval_variable_add_possible_value(variable, oval_variable_possible_value_new(hint, value));
+		}
+		count = oval_image_get_count(image);
+		for (i = 0; i < count; ++i) {
+			oval_operator_t operator = oval_image_get_int(image);
+			struct oval_variable_possible_restriction *pr =
+				oval_variable_possible_restriction_new(operator, oval_image_get_string(image));
+			size_t r_count = oval_image_get_count(image);
+			for (j = 0; j < r_count; ++j) {
+				oval_operation_t operation = oval_image_get_int(image);
+				oval_variable_possible_restriction_add_restriction(pr,
+					oval_variable_restriction_new(operation, oval_image_get_string(image)));
+			}
+			oval_variable_add_possible_restriction(variable, pr);
+		}
+		break;
+	case OVAL_VARIABLE_LOCAL:
+		if (oval_image_get_int(image))
+			oval_variable_set_component(variable, oval_component_from_image(image, model));
+		break;
+	default:
+		break;
+	}
+}
+
 static void _oval_variable_parse_local_tag_component_consumer(struct oval_component *component, void *variable)
 {
 	oval_variable_set_component(variable, component);
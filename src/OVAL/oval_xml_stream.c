@@ -0,0 +1,330 @@
+/**
+ * @file oval_xml_stream.c
+ * \brief Open Vulnerability and Assessment Language
+ *
+ * See more details at http://oval.mitre.org/
+ */
+
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <libxml/xmlsave.h>
+#include <libxml/xmlwriter.h>
+
+#include "common/util.h"
+#include "common/_error.h"
+#include "common/debug_priv.h"
+#include "oval_xml_stream_impl.h"
+
+/* containers are nested only a few levels deep (results/system/syschar/items) */
+#define OVAL_XML_STREAM_DEPTH 16
+/* names tried for the temporary file */
+#define OVAL_XML_STREAM_TMP_TRIES 100
+
+struct oval_xml_stream {
+	xmlTextWriterPtr writer;
+	xmlOutputBufferPtr out;		///< owned by the writer
+	int fd;				///< -1 for stdout
+	char *file;
+	char *tmp_file;			///< written instead of file until finish, NULL for stdout
+	xmlNode *open[OVAL_XML_STREAM_DEPTH];	///< open container at each depth
+	bool content[OVAL_XML_STREAM_DEPTH];	///< has the container any children written
+	xmlNode *closed;		///< closed containers are kept until finish
+	bool error;
+};
+
+static inline struct oval_xml_stream *_stream(xmlDocPtr doc)
+{
+	return doc != NULL ? (struct oval_xml_stream *) doc->_private : NULL;
+}
+
+static int _depth(xmlNode *node)
+{
+	int depth = -1;
+
+	for (; node != NULL && node->type == XML_ELEMENT_NODE; node = node->parent)
+		++depth;
+	return depth;
+}
+
+static void _check(struct oval_xml_stream *stream, int ret)
+{
+	if (ret < 0 || stream->out->error != 0)
+		stream->error = true;
+}
+
+/* What xmlSaveFormatFileTo() writes in front of an element at given depth */
+static void _indent(struct oval_xml_stream *stream, int depth)
+{
+	static const char spaces[] = "                                ";
+	int n = depth * 2;
+
+	_check(stream, xmlTextWriterWriteRaw(stream->writer, BAD_CAST "\n"));
+	while (n > 0) {
+		int len = n < (int) sizeof(spaces) - 1 ? n : (int) sizeof(spaces) - 1;
+
+		_check(stream, xmlTextWriterWriteRawLen(stream->writer, BAD_CAST spaces, len));
+		n -= len;
+	}
+}
+
+static char *_qname(const xmlNs *ns, const xmlChar *name)
+{
+	if (ns == NULL || ns->prefix == NULL)
+		return oscap_strdup((const char *) name);
+	return oscap_sprintf("%s:%s", (const char *) ns->prefix, (const char *) name);
+}
+
+/* Serialize and free the children of parent up to stop (excluded) */
+static void _flush_until(struct oval_xml_stream *stream, xmlDocPtr doc, xmlNode *parent, xmlNode *stop)
+{
+	int depth = _depth(parent) + 1;
+	xmlNode *child = parent->children;
+
+	while (child != NULL && child != stop) {
+		xmlNode *next = child->next;
+
+		if (depth < OVAL_XML_STREAM_DEPTH && child == stream->open[depth])
+			break;
+		_indent(stream, depth);
+		stream->content[depth - 1] = true;
+		xmlNodeDumpOutput(stream->out, doc, child, depth, 1, "UTF-8");
+		_check(stream, 0);
+		xmlUnlinkNode(child);
+		xmlFreeNode(child);
+		child = next;
+	}
+}
+
+/*
+ * Create a temporary file next to a regular file, so that it can be renamed
+ * to the file once the document is complete. The mode is the one of the
+ * existing file. Anything else, like a symlink, a pipe or a device, is
+ * written directly.
+ */
+static int _open_tmp(struct oval_xml_stream *stream, const char *file)
+{
+	struct stat st;
+	bool exists;
+	unsigned int i;
+
+	exists = lstat(file, &st) == 0;
+	if (exists && !S_ISREG(st.st_mode)) {
+		stream->fd = open(file, O_WRONLY|O_TRUNC);
+		if (stream->fd < 0) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "%s '%s'", strerror(errno), file);
+			return -1;
+		}
+		return 0;
+	}
+
+	for (i = 0; i < OVAL_XML_STREAM_TMP_TRIES; ++i) {
+		stream->tmp_file = oscap_sprintf("%s.%ld.%u.tmp", file, (long) getpid(), i);
+		stream->fd = open(stream->tmp_file, O_CREAT|O_EXCL|O_WRONLY,
+				S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH);
+		if (stream->fd >= 0) {
+			if (exists)
+				fchmod(stream->fd, st.st_mode & 07777);
+			return 0;
+		}
+		if (errno != EEXIST || i == OVAL_XML_STREAM_TMP_TRIES - 1) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "%s '%s'", strerror(errno), stream->tmp_file);
+			break;
+		}
+		oscap_free(stream->tmp_file);
+	}
+	oscap_free(stream->tmp_file);
+	stream->tmp_file = NULL;
+	return -1;
+}
+
+static void _discard(struct oval_xml_stream *stream)
+{
+	if (stream->fd >= 0)
+		close(stream->fd);
+	if (stream->tmp_file != NULL)
+		unlink(stream->tmp_file);
+	oscap_free(stream->tmp_file);
+	oscap_free(stream);
+}
+
+int oval_xml_stream_start(xmlDocPtr doc, const char *file)
+{
+	struct oval_xml_stream *stream;
+
+	__attribute__nonnull__(doc);
+	__attribute__nonnull__(file);
+
+	stream = oscap_calloc(1, sizeof(struct oval_xml_stream));
+	if (strcmp(file, "-") == 0) {
+		stream->fd = -1;
+		stream->out = xmlOutputBufferCreateFile(stdout, NULL);
+	} else {
+		if (_open_tmp(stream, file) != 0) {
+			oscap_free(stream);
+			return -1;
+		}
+		stream->out = xmlOutputBufferCreateFd(stream->fd, NULL);
+	}
+	if (stream->out == NULL) {
+		oscap_setxmlerr(xmlGetLastError());
+		_discard(stream);
+		return -1;
+	}
+	stream->writer = xmlNewTextWriter(stream->out);
+	if (stream->writer == NULL) {
+		oscap_setxmlerr(xmlGetLastError());
+		xmlOutputBufferClose(stream->out);
+		_discard(stream);
+		return -1;
+	}
+	stream->file = oscap_strdup(file);
+	stream->closed = xmlNewDocNode(doc, NULL, BAD_CAST "closed", NULL);
+	_check(stream, xmlTextWriterStartDocument(stream->writer, NULL, "UTF-8", NULL));
+
+	doc->_private = stream;
+	return 0;
+}
+
+int oval_xml_stream_finish(xmlDocPtr doc)
+{
+	struct oval_xml_stream *stream = _stream(doc);
+	int ret;
+
+	if (stream == NULL)
+		return -1;
+
+	_check(stream, xmlTextWriterEndDocument(stream->writer));
+	_check(stream, xmlTextWriterFlush(stream->writer));
+	xmlFreeTextWriter(stream->writer);
+	if (stream->fd >= 0 && close(stream->fd) != 0)
+		stream->error = true;
+	stream->fd = -1;
+	xmlFreeNode(stream->closed);
+	doc->_private = NULL;
+
+	ret = 0;
+	if (stream->error) {
+		oscap_seterr(OSCAP_EFAMILY_XML, "Failed to write the document to '%s'.", stream->file);
+		ret = -1;
+	} else if (stream->tmp_file != NULL) {
+		/* the file is replaced by the complete document only */
+		if (rename(stream->tmp_file, stream->file) != 0) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "%s '%s'", strerror(errno), stream->file);
+			ret = -1;
+		} else {
+			oscap_free(stream->tmp_file);
+			stream->tmp_file = NULL;
+		}
+	}
+	oscap_free(stream->file);
+	_discard(stream);
+	return ret;
+}
+
+void oval_xml_stream_open(xmlDocPtr doc, xmlNode *node)
+{
+	struct oval_xml_stream *stream = _stream(doc);
+	int depth;
+	char *name;
+
+	if (stream == NULL)
+		return;
+
+	depth = _depth(node);
+	if (depth >= OVAL_XML_STREAM_DEPTH) {
+		dE("Element <%s> is nested too deep to be streamed.", (const char *) node->name);
+		stream->error = true;
+		return;
+	}
+	if (depth > 0) {
+		_flush_until(stream, doc, node->parent, node);
+		_indent(stream, depth);
+		stream->content[depth - 1] = true;
+	}
+
+	name = _qname(node->ns, node->name);
+	_check(stream, xmlTextWriterStartElement(stream->writer, BAD_CAST name));
+	oscap_free(name);
+
+	/* namespace declarations go first, like in xmlSaveFormatFileTo() */
+	for (xmlNs *ns = node->nsDef; ns != NULL; ns = ns->next) {
+		name = ns->prefix != NULL ? oscap_sprintf("xmlns:%s", (const char *) ns->prefix) : oscap_strdup("xmlns");
+		_check(stream, xmlTextWriterWriteAttribute(stream->writer, BAD_CAST name, ns->href));
+		oscap_free(name);
+	}
+	for (xmlAttr *attr = node->properties; attr != NULL; attr = attr->next) {
+		xmlChar *value = xmlNodeGetContent((xmlNode *) attr);
+
+		name = _qname(attr->ns, attr->name);
+		_check(stream, xmlTextWriterWriteAttribute(stream->writer, BAD_CAST name, value != NULL ? value : BAD_CAST ""));
+		oscap_free(name);
+		xmlFree(value);
+	}
+
+	stream->open[depth] = node;
+	stream->content[depth] = false;
+}
+
+void oval_xml_stream_flush(xmlDocPtr doc, xmlNode *node)
+{
+	struct oval_xml_stream *stream = _stream(doc);
+
+	if (stream == NULL)
+		return;
+
+	_flush_until(stream, doc, node, NULL);
+}
+
+void oval_xml_stream_close(xmlDocPtr doc, xmlNode *node)
+{
+	struct oval_xml_stream *stream = _stream(doc);
+	int depth;
+
+	if (stream == NULL)
+		return;
+
+	depth = _depth(node);
+	if (depth >= OVAL_XML_STREAM_DEPTH || stream->open[depth] != node) {
+		dE("Element <%s> is closed without being opened.", (const char *) node->name);
+		stream->error = true;
+		return;
+	}
+
+	_flush_until(stream, doc, node, NULL);
+	if (stream->content[depth])
+		_indent(stream, depth);
+	_check(stream, xmlTextWriterEndElement(stream->writer));
+	stream->open[depth] = NULL;
+
+	/* callers may still hold the node, it is freed in oval_xml_stream_finish() */
+	xmlUnlinkNode(node);
+	xmlAddChild(stream->closed, node);
+}
@@ -0,0 +1,82 @@
+/**
+ * @file oval_xml_stream_impl.h
+ * \brief Open Vulnerability and Assessment Language
+ *
+ * See more details at http://oval.mitre.org/
+ */
+
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OVAL_XML_STREAM_IMPL_H
+#define OVAL_XML_STREAM_IMPL_H
+
+#include <libxml/tree.h>
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * Streaming export of documents built by the *_to_dom() functions.
+ *
+ * Once oval_xml_stream_start() attaches a stream to a document, the *_to_dom()
+ * functions write each container element (root, definitions, tests, items...)
+ * through an xmlTextWriter as soon as it is opened, and serialize and free the
+ * elements created under it whenever it is flushed. Only the containers and
+ * the element being exported live in memory at any time. The output is the
+ * same as xmlSaveFormatFileTo() would produce for the whole document.
+ *
+ * Without an attached stream, open, flush and close are no-ops, so the very
+ * same code builds the complete DOM.
+ */
+
+/**
+ * Attach a stream writing to file (or stdout for "-") to an empty document.
+ * A regular file is written as a temporary file in the same directory and
+ * replaced by it when the stream finishes.
+ * @return 0 on success, -1 on error (oscap error is set)
+ */
+int oval_xml_stream_start(xmlDocPtr doc, const char *file);
+
+/**
+ * Finish the document and detach the stream. The file is left as it was if
+ * anything failed to be written.
+ * @return 0 on success, -1 if anything failed to be written (oscap error is set)
+ */
+int oval_xml_stream_finish(xmlDocPtr doc);
+
+/**
+ * Write the start tag of a container element. Its attributes and namespace
+ * declarations must be complete; earlier siblings are written first.
+ */
+void oval_xml_stream_open(xmlDocPtr doc, xmlNode *node);
+
+/**
+ * Write and free all elements created so far under an open container.
+ */
+void oval_xml_stream_flush(xmlDocPtr doc, xmlNode *node);
+
+/**
+ * Flush and write the end tag of an open container.
+ */
+void oval_xml_stream_close(xmlDocPtr doc, xmlNode *node);
+
+OSCAP_HIDDEN_END;
+
+#endif				/* OVAL_XML_STREAM_IMPL_H */
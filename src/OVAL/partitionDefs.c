@@ -0,0 +1,304 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include "partitionDefs_impl.h"
+#include "oval_definitions_impl.h"
+#include "common/list.h"
+#include "common/alloc.h"
+
+/*
+ * Every node (definition, test, object, state, variable) is owned by
+ * the first definition which reaches it. A definition reaching a node
+ * owned by another definition joins its group; the rest of the graph
+ * below that node was already walked.
+ */
+struct partition_ctx {
+	struct oscap_htable *owners; /* node id -> owner index + 1 */
+	size_t *parent;              /* union-find forest of the definitions */
+	size_t  cur;                 /* the definition being walked */
+};
+
+static size_t _find(size_t *parent, size_t i)
+{
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+/* Returns true if the node wasn't reached before and has to be walked */
+static bool _visit(struct partition_ctx *ctx, const char *id)
+{
+	void *owner;
+	size_t a, b;
+
+	if (id == NULL)
+		return false;
+
+	owner = oscap_htable_get(ctx->owners, id);
+	if (owner == NULL) {
+		oscap_htable_add(ctx->owners, id, (void *)(uintptr_t)(ctx->cur + 1));
+		return true;
+	}
+
+	/* keep the earliest definition as the root of a group */
+	a = _find(ctx->parent, ctx->cur);
+	b = _find(ctx->parent, (uintptr_t)owner - 1);
+	if (a < b)
+		ctx->parent[b] = a;
+	else
+		ctx->parent[a] = b;
+
+	return false;
+}
+
+static void _walk_object(struct partition_ctx *ctx, struct oval_object *obj);
+static void _walk_state(struct partition_ctx *ctx, struct oval_state *ste);
+static void _walk_definition(struct partition_ctx *ctx, struct oval_definition *def);
+static void _walk_variable(struct partition_ctx *ctx, struct oval_variable *var);
+
+static void _walk_component(struct partition_ctx *ctx, struct oval_component *comp)
+{
+	struct oval_component_iterator *cmp_itr;
+
+	if (comp == NULL)
+		return;
+
+	switch (oval_component_get_type(comp)) {
+	case OVAL_COMPONENT_OBJECTREF:
+		_walk_object(ctx, oval_component_get_object(comp));
+		break;
+	case OVAL_COMPONENT_VARREF:
+		_walk_variable(ctx, oval_component_get_variable(comp));
+		break;
+	case OVAL_FUNCTION_ARITHMETIC:
+	case OVAL_FUNCTION_BEGIN:
+	case OVAL_FUNCTION_CONCAT:
+	case OVAL_FUNCTION_END:
+	case OVAL_FUNCTION_ESCAPE_REGEX:
+	case OVAL_FUNCTION_REGEX_CAPTURE:
+	case OVAL_FUNCTION_SPLIT:
+	case OVAL_FUNCTION_SUBSTRING:
+	case OVAL_FUNCTION_TIMEDIF:
+	case OVAL_FUNCTION_COUNT:
+	case OVAL_FUNCTION_UNIQUE:
+	case OVAL_FUNCTION_GLOB_TO_REGEX:
+		cmp_itr = oval_component_get_function_components(comp);
+		while (oval_component_iterator_has_more(cmp_itr))
+			_walk_component(ctx, oval_component_iterator_next(cmp_itr));
+		oval_component_iterator_free(cmp_itr);
+		break;
+	default:
+		break;
+	}
+}
+
+static void _walk_variable(struct partition_ctx *ctx, struct oval_variable *var)
+{
+	if (var == NULL || !_visit(ctx, oval_variable_get_id(var)))
+		return;
+
+	if (oval_variable_get_type(var) == OVAL_VARIABLE_LOCAL)
+		_walk_component(ctx, oval_variable_get_component(var));
+}
+
+static void _walk_entity(struct partition_ctx *ctx, struct oval_entity *ent)
+{
+	oval_entity_varref_type_t vrt;
+
+	if (ent == NULL)
+		return;
+
+	vrt = oval_entity_get_varref_type(ent);
+	if (vrt == OVAL_ENTITY_VARREF_ATTRIBUTE
+	    || vrt == OVAL_ENTITY_VARREF_ELEMENT)
+		_walk_variable(ctx, oval_entity_get_variable(ent));
+}
+
+static void _walk_state(struct partition_ctx *ctx, struct oval_state *ste)
+{
+	struct oval_state_content_iterator *cont_itr;
+
+	if (ste == NULL || !_visit(ctx, oval_state_get_id(ste)))
+		return;
+
+	cont_itr = oval_state_get_contents(ste);
+	while (oval_state_content_iterator_has_more(cont_itr)) {
+		struct oval_state_content *cont;
+		struct oval_record_field_iterator *rf_itr;
+
+		cont = oval_state_content_iterator_next(cont_itr);
+		_walk_entity(ctx, oval_state_content_get_entity(cont));
+
+		rf_itr = oval_state_content_get_record_fields(cont);
+		while (oval_record_field_iterator_has_more(rf_itr))
+			_walk_variable(ctx, oval_record_field_get_variable(oval_record_field_iterator_next(rf_itr)));
+		oval_record_field_iterator_free(rf_itr);
+	}
+	oval_state_content_iterator_free(cont_itr);
+}
+
+static void _walk_set(struct partition_ctx *ctx, struct oval_setobject *set)
+{
+	struct oval_setobject_iterator *subset_itr;
+	struct oval_object_iterator *obj_itr;
+	struct oval_filter_iterator *fil_itr;
+
+	switch (oval_setobject_get_type(set)) {
+	case OVAL_SET_AGGREGATE:
+		subset_itr = oval_setobject_get_subsets(set);
+		while (oval_setobject_iterator_has_more(subset_itr))
+			_walk_set(ctx, oval_setobject_iterator_next(subset_itr));
+		oval_setobject_iterator_free(subset_itr);
+		break;
+	case OVAL_SET_COLLECTIVE:
+		obj_itr = oval_setobject_get_objects(set);
+		while (oval_object_iterator_has_more(obj_itr))
+			_walk_object(ctx, oval_object_iterator_next(obj_itr));
+		oval_object_iterator_free(obj_itr);
+		fil_itr = oval_setobject_get_filters(set);
+		while (oval_filter_iterator_has_more(fil_itr))
+			_walk_state(ctx, oval_filter_get_state(oval_filter_iterator_next(fil_itr)));
+		oval_filter_iterator_free(fil_itr);
+		break;
+	default:
+		break;
+	}
+}
+
+static void _walk_object(struct partition_ctx *ctx, struct oval_object *obj)
+{
+	struct oval_object_content_iterator *cont_itr;
+
+	if (obj == NULL || !_visit(ctx, oval_object_get_id(obj)))
+		return;
+
+	cont_itr = oval_object_get_object_contents(obj);
+	while (oval_object_content_iterator_has_more(cont_itr)) {
+		struct oval_object_content *cont;
+
+		cont = oval_object_content_iterator_next(cont_itr);
+
+		switch (oval_object_content_get_type(cont)) {
+		case OVAL_OBJECTCONTENT_ENTITY:
+			_walk_entity(ctx, oval_object_content_get_entity(cont));
+			break;
+		case OVAL_OBJECTCONTENT_SET:
+			_walk_set(ctx, oval_object_content_get_setobject(cont));
+			break;
+		case OVAL_OBJECTCONTENT_FILTER:
+			_walk_state(ctx, oval_filter_get_state(oval_object_content_get_filter(cont)));
+			break;
+		default:
+			break;
+		}
+	}
+	oval_object_content_iterator_free(cont_itr);
+}
+
+static void _walk_test(struct partition_ctx *ctx, struct oval_test *tst)
+{
+	struct oval_state_iterator *ste_itr;
+
+	if (tst == NULL || !_visit(ctx, oval_test_get_id(tst)))
+		return;
+
+	_walk_object(ctx, oval_test_get_object(tst));
+
+	ste_itr = oval_test_get_states(tst);
+	while (oval_state_iterator_has_more(ste_itr))
+		_walk_state(ctx, oval_state_iterator_next(ste_itr));
+	oval_state_iterator_free(ste_itr);
+}
+
+static void _walk_criteria(struct partition_ctx *ctx, struct oval_criteria_node *cnode)
+{
+	struct oval_criteria_node_iterator *cnode_itr;
+
+	if (cnode == NULL)
+		return;
+
+	switch (oval_criteria_node_get_type(cnode)) {
+	case OVAL_NODETYPE_CRITERION:
+		_walk_test(ctx, oval_criteria_node_get_test(cnode));
+		break;
+	case OVAL_NODETYPE_CRITERIA:
+		cnode_itr = oval_criteria_node_get_subnodes(cnode);
+		if (cnode_itr == NULL)
+			break;
+		while (oval_criteria_node_iterator_has_more(cnode_itr))
+			_walk_criteria(ctx, oval_criteria_node_iterator_next(cnode_itr));
+		oval_criteria_node_iterator_free(cnode_itr);
+		break;
+	case OVAL_NODETYPE_EXTENDDEF:
+		_walk_definition(ctx, oval_criteria_node_get_definition(cnode));
+		break;
+	default:
+		break;
+	}
+}
+
+static void _walk_definition(struct partition_ctx *ctx, struct oval_definition *def)
+{
+	if (def == NULL || !_visit(ctx, oval_definition_get_id(def)))
+		return;
+
+	_walk_criteria(ctx, oval_definition_get_criteria(def));
+}
+
+size_t oval_definitions_partition(struct oval_definition **defs, size_t count, size_t *groups)
+{
+	struct partition_ctx ctx;
+	size_t i, ngroups;
+
+	if (count == 0)
+		return 0;
+
+	ctx.owners = oscap_htable_new1(strcmp, 8 * count + 1);
+	ctx.parent = oscap_alloc(count * sizeof(size_t));
+
+	for (i = 0; i < count; ++i)
+		ctx.parent[i] = i;
+
+	for (i = 0; i < count; ++i) {
+		ctx.cur = i;
+		_walk_definition(&ctx, defs[i]);
+	}
+
+	/* roots are the first definitions of their groups */
+	ngroups = 0;
+	for (i = 0; i < count; ++i) {
+		size_t root = _find(ctx.parent, i);
+
+		groups[i] = (root == i) ? ngroups++ : groups[root];
+	}
+
+	oscap_free(ctx.parent);
+	oscap_htable_free(ctx.owners, NULL);
+
+	return ngroups;
+}
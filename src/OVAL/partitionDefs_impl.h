@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OVAL_PARTITIONDEFS_IMPL
+#define OVAL_PARTITIONDEFS_IMPL
+
+#include <stddef.h>
+#include "public/oval_definitions.h"
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/* Split the definitions into groups which don't share any definition,
+ * test, object, state or variable, directly or through extend_definition,
+ * set objects, filters and variable references. Definitions of different
+ * groups can be evaluated independently of each other.
+ *
+ * The group of defs[i] is stored in groups[i]. Groups are numbered in the
+ * order of their first definition. Returns the number of groups.
+ */
+size_t oval_definitions_partition(struct oval_definition **defs, size_t count, size_t *groups);
+
+OSCAP_HIDDEN_END;
+
+#endif
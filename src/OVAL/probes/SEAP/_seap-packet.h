@@ -47,6 +47,19 @@ struct SEAP_packet {
         } data;
 };
 
+/**
+ * Accept the binary wire format offered by the peer. Everything sent
+ * after this call is binary encoded.
+ */
+int SEAP_packet_hello_send (SEAP_CTX_t *ctx, int sd);
+
+/**
+ * Wait for the peer to accept the offered binary wire format. If there's
+ * no answer within SEAP_WIRE_HELLO_TIMEOUT seconds, the text format is
+ * used for sending.
+ */
+int SEAP_packet_hello_recv (SEAP_CTX_t *ctx, int sd);
+
 OSCAP_HIDDEN_END;
 
 #endif /* _SEAP_PACKET_H */
@@ -45,6 +45,7 @@ typedef struct {
         int     (*sch_close)    (SEAP_desc_t *, uint32_t);
         ssize_t (*sch_sendsexp) (SEAP_desc_t *, SEXP_t *, uint32_t);
         int     (*sch_select)   (SEAP_desc_t *, int, uint16_t, uint32_t);
+        int     (*sch_recvsexp) (SEAP_desc_t *, SEXP_t **, uint32_t); /* optional */
 } SEAP_schemefn_t;
 
 extern const SEAP_schemefn_t __schtbl[];
@@ -57,6 +58,7 @@ extern const SEAP_schemefn_t __schtbl[];
 #define SCH_CLOSE(idx, ...)    __schtbl[idx].sch_close (__VA_ARGS__)
 #define SCH_SENDSEXP(idx, ...) __schtbl[idx].sch_sendsexp (__VA_ARGS__)
 #define SCH_SELECT(idx, ...)   __schtbl[idx].sch_select (__VA_ARGS__)
+#define SCH_RECVSEXP(idx, ...) __schtbl[idx].sch_recvsexp (__VA_ARGS__)
 
 #define SEAP_IO_EVREAD  0x01
 #define SEAP_IO_EVWRITE 0x02
@@ -83,6 +85,14 @@ SEAP_scheme_t SEAP_scheme_search (const SEAP_schemefn_t fntable[], const char *s
 #include "sch_pipe.h"
 #define SCH_PIPE    3
 
+/* shared memory */
+#include "sch_shm.h"
+#define SCH_SHM     4
+
+/* probe module running in the same process */
+#include "sch_thread.h"
+#define SCH_THREAD  5
+
 #define SCH_NONE    255
 
 OSCAP_HIDDEN_END;
@@ -8,4 +8,9 @@ typedef struct {
 	int       part;
 } __IDres_pair;
 
+typedef struct {
+	SEXP_FP_t *fp;
+	uint32_t   count;
+} __IDres_fp;
+
 #endif /* _SEXP_ID_H */
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#pragma once
+#ifndef _SEXP_BINARY_H
+#define _SEXP_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "public/sexp-types.h"
+#include "public/strbuf.h"
+#include "../../../common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * Binary S-exp encoding
+ *
+ * A frame consists of a marker byte, a 32-bit little-endian payload
+ * length and the payload. The payload is one S-exp encoded as a tag
+ * byte followed by the value:
+ *
+ *   list     element count (varint), elements
+ *   string   length (varint), bytes
+ *   uint     value (varint)
+ *   int      -(value + 1) (varint), used for negative values only
+ *   double   IEEE 754 bits (8 bytes, little-endian)
+ *   true     -
+ *   false    -
+ *
+ * If the datatype bit is set in the tag, the datatype name (encoded
+ * as a string without the tag) precedes the value. A frame with zero
+ * payload length carries no S-exp and is used as the handshake.
+ *
+ * The marker can't start a text S-exp so the receiver can detect the
+ * encoding from the first byte of the stream.
+ */
+#define SEXP_BINFRAME_MARK   0xb5
+#define SEXP_BINFRAME_HDRLEN 5
+
+/**
+ * Append a binary frame holding the S-exp to the buffer.
+ * @return 0 on success, -1 on failure
+ */
+int SEXP_binframe_add (SEXP_t *s_exp, strbuf_t *sb);
+
+/**
+ * Append an empty (handshake) frame to the buffer.
+ */
+int SEXP_binframe_add_hello (strbuf_t *sb);
+
+/**
+ * Get the payload length from a frame header.
+ * @return 0 on success, -1 if the header is not valid
+ */
+int SEXP_binframe_hdr (const uint8_t *hdr, uint32_t *length);
+
+/**
+ * Decode the payload of a frame.
+ * @return the S-exp or NULL if the payload is not valid
+ */
+SEXP_t *SEXP_binframe_parse (const uint8_t *buf, size_t len);
+
+OSCAP_HIDDEN_END;
+
+#endif /* _SEXP_BINARY_H */
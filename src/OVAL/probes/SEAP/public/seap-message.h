@@ -46,6 +46,7 @@ SEAP_msg_t *SEAP_msg_clone (SEAP_msg_t *msg);
 void        SEAP_msg_free (SEAP_msg_t *msg);
 
 SEAP_msgid_t SEAP_msg_id (SEAP_msg_t *msg);
+int          SEAP_msg_reply_id (SEAP_msg_t *msg, SEAP_msgid_t *id);
 
 int     SEAP_msg_set (SEAP_msg_t *msg, SEXP_t *sexp);
 void    SEAP_msg_unset (SEAP_msg_t *msg);
@@ -60,9 +60,26 @@ SEXP_t *SEAP_read  (SEAP_CTX_t *ctx, int sd);
 int     SEAP_write (SEAP_CTX_t *ctx, int sd, SEXP_t *sexp);
 int     SEAP_close (SEAP_CTX_t *ctx, int sd);
 
+/*
+ * The pipe and shm schemes pass SEAP_WIRE_BINARY_ARG to the peer they
+ * start when they offer the binary wire format. The peer accepts the
+ * offer by opening its descriptors with the SEAP_OPENFD_WIRE_BINARY flag.
+ */
+#define SEAP_WIRE_BINARY_ARG    "--seap-wire=binary"
+#define SEAP_OPENFD_WIRE_BINARY 0x80000000
+
 int SEAP_openfd (SEAP_CTX_t *ctx, int fd, uint32_t flags);
 int SEAP_openfd2 (SEAP_CTX_t *ctx, int ifd, int ofd, uint32_t flags);
 
+/*
+ * The shm scheme passes the shared memory descriptors to the peer it
+ * starts by an argument beginning with SEAP_SHM_ARG. The peer opens them
+ * together with its input and output descriptors by SEAP_openshm().
+ */
+#define SEAP_SHM_ARG "--seap-shm="
+
+int SEAP_openshm (SEAP_CTX_t *ctx, int ifd, int ofd, const char *fdstr, uint32_t flags);
+
 SEAP_msg_t *SEAP_msg_new (void);
 void        SEAP_msg_free (SEAP_msg_t *msg);
 int         SEAP_msg_set (SEAP_msg_t *msg, SEXP_t *sexp);
@@ -33,4 +33,25 @@ typedef uint64_t SEXP_ID_t;
 SEXP_ID_t SEXP_ID_v(const SEXP_t *s);
 SEXP_ID_t SEXP_ID_v2(const SEXP_t *s);
 
+/**
+ * 128-bit S-exp value fingerprint
+ */
+typedef struct {
+        uint64_t lo;
+        uint64_t hi;
+} SEXP_FP_t;
+
+/**
+ * Compute a 128-bit fingerprint of an S-exp value. Values with
+ * different content have different fingerprints with a very high
+ * probability.
+ */
+void SEXP_ID_fp(const SEXP_t *s, SEXP_FP_t *fp);
+
+/**
+ * Compare two fingerprints
+ * @return true if the fingerprints are equal
+ */
+#define SEXP_ID_fp_eq(a, b) ((a)->lo == (b)->lo && (a)->hi == (b)->hi)
+
 #endif /* SEXP_ID_H */
@@ -297,7 +297,10 @@ char  *SEXP_string_cstrp (const SEXP_t *s_exp);
  * Get a C substring from a sexp object.
  * @param s_sexp the queried sexp object
  * @param beg the position of the fisrt character of the substring
- * @param len the length of the substring
+ * @param len the maximal length of the substring or 0 for the rest of the string
+ * @return the substring, which has to be freed by the caller, or NULL
+ * if the object isn't a string, beg lies beyond its end or the substring
+ * would be empty
  */
 char *SEXP_string_subcstr (const SEXP_t *s_exp, size_t beg, size_t len);
 
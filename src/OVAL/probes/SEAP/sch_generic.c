@@ -95,20 +95,7 @@ ssize_t sch_generic_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t fla
 
 ssize_t sch_generic_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
 {
-        ssize_t   ret;
-        strbuf_t *sb;
-
-        ret = 0;
-        sb  = strbuf_new (SEAP_STRBUF_MAX);
-
-        if (SEXP_sbprintf_t (sexp, sb) != 0)
-                ret = -1;
-        else
-                ret = strbuf_write (sb, DATA(desc->scheme_data)->ofd);
-
-        strbuf_free (sb);
-
-        return (ret);
+        return SEAP_desc_writesexp (desc, sexp, DATA(desc->scheme_data)->ofd);
 }
 
 int sch_generic_close (SEAP_desc_t *desc, uint32_t flags)
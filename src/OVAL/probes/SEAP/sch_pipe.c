@@ -45,6 +45,7 @@
 #include "generic/common.h"
 #include "public/sm_alloc.h"
 #include "public/strbuf.h"
+#include "public/seap.h"
 #include "_sexp-types.h"
 #include "_seap-types.h"
 #include "_sexp-output.h"
@@ -184,17 +185,16 @@ static int check_child (pid_t pid, int waitf)
         return (1);
 }
 
-int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+int sch_pipe_spawn (sch_pipedata_t *data, const char *uri, uint32_t flags,
+                    const char *xarg, const int *xfds, int xfdcnt)
 {
-        sch_pipedata_t *data;
         pid_t pid;
         int   pfd[2] = { -1, -1 };
+        const char *argv[4];
+        int   argc = 0, i;
 
-        assume_r (desc != NULL, -1, errno = EFAULT;);
-        assume_r (uri  != NULL, -1, errno = EFAULT;);
-        assume_r (desc->scheme_data == NULL, -1, errno = EALREADY;);
-
-        data = (sch_pipedata_t *) sm_talloc (sch_pipedata_t);
+        data->pfd = -1;
+        data->pid = -1;
         data->execpath = get_exec_path (uri, flags);
 
         if (data->execpath == NULL) {
@@ -212,6 +212,20 @@ int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
         if (socketpair (AF_UNIX, SOCK_STREAM, 0, pfd) < 0)
                 goto fail1;
 
+        /*
+         * The arguments are prepared before fork because memory must not
+         * be allocated in the child of a multithreaded process.
+         */
+        argv[argc++] = data->execpath;
+
+        /* The binary wire format is offered unless the user turned it off */
+        if (SEAP_wire_binary_requested ())
+                argv[argc++] = SEAP_WIRE_BINARY_ARG;
+        if (xarg != NULL)
+                argv[argc++] = xarg;
+
+        argv[argc] = NULL;
+
         switch (pid = fork ()) {
         case -1: /* error */
                 goto fail1;
@@ -225,7 +239,13 @@ int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
                         _exit (errno);
                 if (dup2 (pfd[1], STDOUT_FILENO) != STDOUT_FILENO)
                         _exit (errno);
-                execl (data->execpath, data->execpath, NULL);
+
+                /* descriptors passed to the probe are created close-on-exec */
+                for (i = 0; i < xfdcnt; ++i)
+                        if (fcntl (xfds[i], F_SETFD, 0) != 0)
+                                _exit (errno);
+
+                execv (data->execpath, (char * const *)argv);
                 _exit (errno);
         default: /* parent */
                 close (pfd[1]);
@@ -237,8 +257,6 @@ int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
                         goto fail2;
         }
 
-        desc->scheme_data = (void *)data;
-
         return (0);
 fail2:
         protect_errno {
@@ -248,11 +266,37 @@ fail1:
         protect_errno {
                 if (data->execpath != NULL)
                         sm_free (data->execpath);
-                sm_free (data);
         }
         return (-1);
 }
 
+int sch_pipe_alive (sch_pipedata_t *data)
+{
+        return (check_child (data->pid, 0) == 0);
+}
+
+int sch_pipe_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+{
+        sch_pipedata_t *data;
+
+        assume_r (desc != NULL, -1, errno = EFAULT;);
+        assume_r (uri  != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data == NULL, -1, errno = EALREADY;);
+
+        data = (sch_pipedata_t *) sm_talloc (sch_pipedata_t);
+
+        if (sch_pipe_spawn (data, uri, flags, NULL, NULL, 0) != 0) {
+                protect_errno {
+                        sm_free (data);
+                }
+                return (-1);
+        }
+
+        desc->scheme_data = (void *)data;
+
+        return (0);
+}
+
 int sch_pipe_openfd (SEAP_desc_t *desc, int fd, uint32_t flags)
 {
         errno = EOPNOTSUPP;
@@ -317,34 +361,13 @@ ssize_t sch_pipe_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
 
         if (check_child (data->pid, 0) != 0)
                 return (-1);
-        else {
-                ssize_t ret;
-		strbuf_t *sb;
-
-                ret = 0;
-                sb  = strbuf_new (SEAP_STRBUF_MAX);
-
-                if (SEXP_sbprintf_t (sexp, sb) != 0)
-                        ret = -1;
-                else
-                        ret = strbuf_write (sb, data->pfd);
-
-                strbuf_free (sb);
-
-                return (ret);
-        }
+        else
+                return SEAP_desc_writesexp (desc, sexp, data->pfd);
 }
 
-int sch_pipe_close (SEAP_desc_t *desc, uint32_t flags)
+int sch_pipe_reap (sch_pipedata_t *data)
 {
         int try;
-        sch_pipedata_t *data;
-
-        assume_d (desc != NULL, -1, errno = EFAULT;);
-
-        data = (sch_pipedata_t *)desc->scheme_data;
-
-        assume_r (data != NULL, -1, errno = EBADF;);
 
         kill (data->pid, SIGTERM);
 
@@ -373,10 +396,25 @@ int sch_pipe_close (SEAP_desc_t *desc, uint32_t flags)
         }
 clean:
         close (data->pfd);
-
         sm_free (data->execpath);
-        sm_free (data);
 
+        return (0);
+}
+
+int sch_pipe_close (SEAP_desc_t *desc, uint32_t flags)
+{
+        sch_pipedata_t *data;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+
+        data = (sch_pipedata_t *)desc->scheme_data;
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        if (sch_pipe_reap (data) != 0)
+                return (-1);
+
+        sm_free (data);
         desc->scheme_data = NULL;
 
         return (0);
@@ -45,6 +45,15 @@ ssize_t sch_pipe_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags);
 int sch_pipe_close (SEAP_desc_t *desc, uint32_t flags);
 int sch_pipe_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags);
 
+/*
+ * Helpers for schemes which start the probe the same way. The extra
+ * argument and descriptors are passed to the probe.
+ */
+int sch_pipe_spawn (sch_pipedata_t *data, const char *uri, uint32_t flags,
+                    const char *xarg, const int *xfds, int xfdcnt);
+int sch_pipe_alive (sch_pipedata_t *data);
+int sch_pipe_reap (sch_pipedata_t *data);
+
 OSCAP_HIDDEN_END;
 
 #endif /* SCH_PIPE_H */
@@ -0,0 +1,660 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#if defined(HAVE_SYS_EVENTFD_H)
+# include <sys/eventfd.h>
+#endif
+#include <common/assume.h>
+
+#include "generic/common.h"
+#include "public/sm_alloc.h"
+#include "public/strbuf.h"
+#include "public/seap.h"
+#include "_sexp-types.h"
+#include "_seap-types.h"
+#include "_seap-scheme.h"
+#include "sch_shm.h"
+#include "seap-descriptor.h"
+
+#if defined(HAVE_MEMFD_CREATE) && defined(HAVE_SYS_EVENTFD_H)
+
+#define DATA(ptr) ((sch_shmdata_t *)(ptr))
+
+static uint64_t sch_shm_avail (sch_shmring_t *ring)
+{
+        return __atomic_load_n (&ring->head, __ATOMIC_SEQ_CST)
+                - __atomic_load_n (&ring->tail, __ATOMIC_SEQ_CST);
+}
+
+static uint64_t sch_shm_space (sch_shmring_t *ring)
+{
+        return ring->size - sch_shm_avail (ring);
+}
+
+static void sch_shm_notify (int efd, uint32_t *waitp)
+{
+        uint64_t one = 1;
+
+        if (__atomic_load_n (waitp, __ATOMIC_SEQ_CST) != 0) {
+                if (write (efd, &one, sizeof one) != sizeof one)
+                        dD("eventfd write failed: errno=%u, %s.", errno, strerror (errno));
+        }
+}
+
+/*
+ * Copy as much data as fits into the ring.
+ * @return number of bytes copied
+ */
+static size_t sch_shm_put (sch_shmring_t *ring, const uint8_t *buf, size_t len)
+{
+        uint64_t head, off;
+        size_t   n, part;
+
+        head = ring->head;
+        n    = (size_t)sch_shm_space (ring);
+
+        if (n > len)
+                n = len;
+
+        off  = head % ring->size;
+        part = (size_t)(ring->size - off);
+
+        if (part > n)
+                part = n;
+
+        memcpy (ring->data + off, buf, part);
+        memcpy (ring->data, buf + part, n - part);
+
+        __atomic_store_n (&ring->head, head + n, __ATOMIC_SEQ_CST);
+
+        return (n);
+}
+
+static size_t sch_shm_get (sch_shmring_t *ring, uint8_t *buf, size_t len)
+{
+        uint64_t tail, off;
+        size_t   n, part;
+
+        tail = ring->tail;
+        n    = (size_t)sch_shm_avail (ring);
+
+        if (n > len)
+                n = len;
+
+        off  = tail % ring->size;
+        part = (size_t)(ring->size - off);
+
+        if (part > n)
+                part = n;
+
+        memcpy (buf, ring->data + off, part);
+        memcpy (buf + part, ring->data, n - part);
+
+        __atomic_store_n (&ring->tail, tail + n, __ATOMIC_SEQ_CST);
+
+        return (n);
+}
+
+static int sch_shm_ready (sch_shmdata_t *data, int ev)
+{
+        if (ev == SEAP_IO_EVWRITE)
+                return (sch_shm_space (data->out) > 0);
+        else
+                return (sch_shm_avail (data->in) > 0);
+}
+
+static int sch_shm_timeleft (const struct timespec *deadline)
+{
+        struct timespec now;
+        long ms;
+
+        if (deadline == NULL)
+                return (-1);
+
+        clock_gettime (CLOCK_MONOTONIC, &now);
+
+        ms = (deadline->tv_sec - now.tv_sec) * 1000
+                + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+
+        return (ms > 0 ? (int)ms : 0);
+}
+
+/*
+ * Wait until there's data in the in ring (EVREAD) or space in the out
+ * ring (EVWRITE).
+ * @param timeout in seconds, 0 means no timeout
+ * @return 0 on success, 1 if the other side has exited, -1 on failure
+ */
+static int sch_shm_wait (sch_shmdata_t *data, int ev, uint16_t timeout)
+{
+        pthread_mutex_t *lock;
+        uint32_t        *waitp;
+        struct pollfd    pfd[2];
+        struct timespec  deadline, *dp;
+        uint64_t         cnt;
+        int ret;
+
+        if (sch_shm_ready (data, ev))
+                return (0);
+
+        if (ev == SEAP_IO_EVWRITE) {
+                lock  = &data->wr_lock;
+                waitp = &data->out->wwait;
+                pfd[0].fd = data->efd_wr;
+        } else {
+                lock  = &data->rd_lock;
+                waitp = &data->in->rwait;
+                pfd[0].fd = data->efd_rd;
+        }
+
+        pfd[0].events = POLLIN;
+        pfd[1].fd     = data->pipe.pfd;
+        pfd[1].events = 0; /* POLLHUP and POLLERR are always reported */
+
+        dp = NULL;
+
+        if (timeout > 0) {
+                clock_gettime (CLOCK_MONOTONIC, &deadline);
+                deadline.tv_sec += timeout;
+                dp = &deadline;
+        }
+
+        pthread_mutex_lock (lock);
+
+        for (;;) {
+                /*
+                 * The flag is set before the last check so that the other
+                 * side either sees it or changes the ring before the check.
+                 */
+                __atomic_store_n (waitp, 1, __ATOMIC_SEQ_CST);
+
+                if (sch_shm_ready (data, ev)) {
+                        ret = 0;
+                        break;
+                }
+
+                ret = poll (pfd, 2, sch_shm_timeleft (dp));
+                __atomic_store_n (waitp, 0, __ATOMIC_SEQ_CST);
+
+                if (ret < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        ret = -1;
+                        break;
+                } else if (ret == 0) {
+                        errno = ETIMEDOUT;
+                        ret = -1;
+                        break;
+                }
+
+                if (pfd[0].revents & POLLIN) {
+                        if (read (pfd[0].fd, &cnt, sizeof cnt) < 0 && errno != EAGAIN) {
+                                ret = -1;
+                                break;
+                        }
+                }
+
+                if (pfd[1].revents & (POLLHUP | POLLERR)) {
+                        ret = sch_shm_ready (data, ev) ? 0 : 1;
+                        break;
+                }
+        }
+
+        __atomic_store_n (waitp, 0, __ATOMIC_SEQ_CST);
+
+        protect_errno {
+                pthread_mutex_unlock (lock);
+        }
+
+        return (ret);
+}
+
+static ssize_t sch_shm_write (sch_shmdata_t *data, const void *buf, size_t len)
+{
+        size_t off, n;
+
+        for (off = 0; off < len; off += n) {
+                n = sch_shm_put (data->out, (const uint8_t *)buf + off, len - off);
+
+                if (n > 0) {
+                        sch_shm_notify (data->efd_peer_rd, &data->out->rwait);
+                        continue;
+                }
+
+                switch (sch_shm_wait (data, SEAP_IO_EVWRITE, 0)) {
+                case 0:
+                        break;
+                case 1:
+                        errno = EPIPE;
+                        /* FALLTHROUGH */
+                default:
+                        return (-1);
+                }
+        }
+
+        return ((ssize_t)len);
+}
+
+static sch_shmdata_t *sch_shm_data_new (void)
+{
+        sch_shmdata_t *data;
+
+        data = sm_talloc (sch_shmdata_t);
+        memset (data, 0, sizeof (sch_shmdata_t));
+
+        data->pipe.pfd = -1;
+        data->pipe.pid = -1;
+        data->ofd      = -1;
+        data->map      = MAP_FAILED;
+        data->efd_rd   = -1;
+        data->efd_wr   = -1;
+        data->efd_peer_rd = -1;
+        data->efd_peer_wr = -1;
+
+        pthread_mutex_init (&data->rd_lock, NULL);
+        pthread_mutex_init (&data->wr_lock, NULL);
+
+        return (data);
+}
+
+static void sch_shm_data_free (sch_shmdata_t *data)
+{
+        if (data->map != MAP_FAILED)
+                munmap (data->map, data->maplen);
+        if (data->efd_rd != -1)
+                close (data->efd_rd);
+        if (data->efd_wr != -1)
+                close (data->efd_wr);
+        if (data->efd_peer_rd != -1)
+                close (data->efd_peer_rd);
+        if (data->efd_peer_wr != -1)
+                close (data->efd_peer_wr);
+
+        pthread_mutex_destroy (&data->rd_lock);
+        pthread_mutex_destroy (&data->wr_lock);
+
+        sm_free (data);
+}
+
+int sch_shm_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+{
+        sch_shmdata_t *data;
+        int  mfd, efd[4], i;
+        char xarg[128];
+
+        assume_r (desc != NULL, -1, errno = EFAULT;);
+        assume_r (uri  != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data == NULL, -1, errno = EALREADY;);
+
+        data = sch_shm_data_new ();
+        data->maplen = 2 * (sizeof (sch_shmring_t) + SCH_SHM_RINGSIZE);
+
+        mfd = memfd_create ("seap", MFD_CLOEXEC);
+
+        if (mfd < 0)
+                goto fail;
+
+        if (ftruncate (mfd, (off_t)data->maplen) != 0)
+                goto fail;
+
+        data->map = mmap (NULL, data->maplen, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0);
+
+        if (data->map == MAP_FAILED)
+                goto fail;
+
+        /* the file is zero-filled so only the sizes have to be set */
+        data->out = (sch_shmring_t *)data->map;
+        data->out->size = SCH_SHM_RINGSIZE;
+        data->in  = (sch_shmring_t *)((uint8_t *)data->map + sizeof (sch_shmring_t) + SCH_SHM_RINGSIZE);
+        data->in->size  = SCH_SHM_RINGSIZE;
+
+        for (i = 0; i < 4; ++i) {
+                efd[i] = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+                if (efd[i] < 0) {
+                        protect_errno {
+                                while (--i >= 0)
+                                        close (efd[i]);
+                        }
+                        goto fail;
+                }
+        }
+
+        data->efd_rd      = efd[0];
+        data->efd_wr      = efd[1];
+        data->efd_peer_rd = efd[2];
+        data->efd_peer_wr = efd[3];
+
+        snprintf (xarg, sizeof xarg, "%s%d,%d,%d,%d,%d",
+                  SEAP_SHM_ARG, mfd, efd[2], efd[3], efd[0], efd[1]);
+
+        {
+                const int xfds[5] = { mfd, efd[0], efd[1], efd[2], efd[3] };
+
+                if (sch_pipe_spawn (&data->pipe, uri, flags, xarg, xfds, 5) != 0)
+                        goto fail;
+        }
+
+        close (mfd);
+        desc->scheme_data = (void *)data;
+
+        return (0);
+fail:
+        protect_errno {
+                if (mfd >= 0)
+                        close (mfd);
+                sch_shm_data_free (data);
+        }
+        return (-1);
+}
+
+int sch_shm_openfd (SEAP_desc_t *desc, int fd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_shm_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_shm_openfds (SEAP_desc_t *desc, int ifd, int ofd, const char *fdstr, uint32_t flags)
+{
+        sch_shmdata_t *data;
+        struct stat    st;
+        int mfd, fds[4], i;
+
+        assume_r (desc  != NULL, -1, errno = EFAULT;);
+        assume_r (fdstr != NULL, -1, errno = EFAULT;);
+
+        if (sscanf (fdstr, "%d,%d,%d,%d,%d",
+                    &mfd, &fds[0], &fds[1], &fds[2], &fds[3]) != 5)
+        {
+                errno = EINVAL;
+                return (-1);
+        }
+
+        data = sch_shm_data_new ();
+        data->efd_rd      = fds[0];
+        data->efd_wr      = fds[1];
+        data->efd_peer_rd = fds[2];
+        data->efd_peer_wr = fds[3];
+
+        /* don't pass the descriptors to the processes started by the probe */
+        for (i = 0; i < 4; ++i)
+                fcntl (fds[i], F_SETFD, FD_CLOEXEC);
+
+        if (fstat (mfd, &st) != 0)
+                goto fail;
+
+        data->maplen = (size_t)st.st_size;
+        data->map    = mmap (NULL, data->maplen, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0);
+
+        close (mfd);
+
+        if (data->map == MAP_FAILED)
+                goto fail;
+
+        data->in  = (sch_shmring_t *)data->map;
+
+        if (data->maplen < 2 * sizeof (sch_shmring_t)
+            || data->in->size > data->maplen - 2 * sizeof (sch_shmring_t))
+        {
+                errno = EINVAL;
+                goto fail;
+        }
+
+        data->out = (sch_shmring_t *)((uint8_t *)data->map + sizeof (sch_shmring_t) + data->in->size);
+
+        if (data->in->size == 0
+            || data->out->size != data->maplen - 2 * sizeof (sch_shmring_t) - data->in->size)
+        {
+                errno = EINVAL;
+                goto fail;
+        }
+
+        data->pipe.pfd = ifd;
+        data->ofd      = ofd;
+        desc->scheme_data = (void *)data;
+
+        return (0);
+fail:
+        protect_errno {
+                sch_shm_data_free (data);
+        }
+        return (-1);
+}
+
+ssize_t sch_shm_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        sch_shmdata_t *data;
+        size_t n;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_d (buf  != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        switch (sch_shm_wait (data, SEAP_IO_EVREAD, 0)) {
+        case 0:
+                break;
+        case 1:
+                /* EOF */
+                return (0);
+        default:
+                return (-1);
+        }
+
+        n = sch_shm_get (data->in, (uint8_t *)buf, len);
+        sch_shm_notify (data->efd_peer_wr, &data->in->wwait);
+
+        return ((ssize_t)n);
+}
+
+ssize_t sch_shm_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        sch_shmdata_t *data;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_d (buf  != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        if (data->pipe.pid != -1 && !sch_pipe_alive (&data->pipe))
+                return (-1);
+
+        return sch_shm_write (data, buf, len);
+}
+
+ssize_t sch_shm_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
+{
+        sch_shmdata_t *data;
+        strbuf_t      *sb;
+        struct strblk *blk;
+        ssize_t        ret;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_d (sexp != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        if (data->pipe.pid != -1 && !sch_pipe_alive (&data->pipe))
+                return (-1);
+
+        ret = 0;
+        sb  = strbuf_new (SEAP_STRBUF_MAX);
+
+        if (SEAP_desc_sbprintf (desc, sexp, sb) != 0)
+                ret = -1;
+        else {
+                /* the blocks are copied straight into the ring */
+                for (blk = sb->beg; blk != NULL; blk = blk->next) {
+                        if (sch_shm_write (data, blk->data, blk->size) < 0) {
+                                ret = -1;
+                                break;
+                        }
+
+                        ret += (ssize_t)blk->size;
+                }
+        }
+
+        protect_errno {
+                strbuf_free (sb);
+        }
+
+        return (ret);
+}
+
+int sch_shm_close (SEAP_desc_t *desc, uint32_t flags)
+{
+        sch_shmdata_t *data;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        if (data->pipe.pid != -1) {
+                if (sch_pipe_reap (&data->pipe) != 0)
+                        return (-1);
+        } else {
+                if (data->pipe.pfd != -1)
+                        close (data->pipe.pfd);
+                if (data->ofd != -1)
+                        close (data->ofd);
+        }
+
+        sch_shm_data_free (data);
+        desc->scheme_data = NULL;
+
+        return (0);
+}
+
+int sch_shm_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags)
+{
+        sch_shmdata_t *data;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+        assume_d (ev == SEAP_IO_EVREAD || ev == SEAP_IO_EVWRITE, -1, errno = EINVAL;);
+
+        if (data->pipe.pid != -1 && !sch_pipe_alive (&data->pipe))
+                return (-1);
+
+        switch (sch_shm_wait (data, ev, timeout)) {
+        case 0:
+                return (0);
+        case 1:
+                /* EOF is reported by the following recv */
+                if (ev == SEAP_IO_EVREAD)
+                        return (0);
+
+                errno = EPIPE;
+                /* FALLTHROUGH */
+        default:
+                return (-1);
+        }
+}
+
+#else /* HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H */
+
+int sch_shm_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_shm_openfd (SEAP_desc_t *desc, int fd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_shm_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_shm_openfds (SEAP_desc_t *desc, int ifd, int ofd, const char *fdstr, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+ssize_t sch_shm_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+ssize_t sch_shm_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+ssize_t sch_shm_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_shm_close (SEAP_desc_t *desc, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_shm_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+#endif /* HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H */
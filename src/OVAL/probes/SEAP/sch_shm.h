@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#pragma once
+#ifndef SCH_SHM_H
+#define SCH_SHM_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include "sch_pipe.h"
+#include "../../../common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * Shared memory scheme
+ *
+ * The probe is started the same way as with the pipe scheme, but the
+ * data is exchanged through two ring buffers (one per direction) in a
+ * memfd mapped by both processes. A side which waits for data or for
+ * space in a ring sets a flag in the ring and sleeps on an eventfd; the
+ * other side writes to the eventfd only if the flag is set. The socket
+ * from the pipe scheme is kept to detect that the other side has exited.
+ *
+ * The library passes the descriptors to the probe by the SEAP_SHM_ARG
+ * argument as "<memfd>,<rd>,<wr>,<peer rd>,<peer wr>" and the probe opens
+ * them by sch_shm_openfds(). They aren't passed in the environment, which
+ * the environment probes would report.
+ */
+
+#define SCH_SHM_RINGSIZE (4 * 1024 * 1024)
+
+typedef struct {
+        /* producer's position, written by the producer only */
+        uint64_t head;
+        uint32_t wwait; /* the producer waits for space */
+        uint8_t  _pad1[64 - sizeof (uint64_t) - sizeof (uint32_t)];
+        /* consumer's position, written by the consumer only */
+        uint64_t tail;
+        uint32_t rwait; /* the consumer waits for data */
+        uint8_t  _pad2[64 - sizeof (uint64_t) - sizeof (uint32_t)];
+        uint64_t size;
+        uint8_t  _pad3[64 - sizeof (uint64_t)];
+        uint8_t  data[];
+} sch_shmring_t;
+
+typedef struct {
+        sch_pipedata_t pipe; /* pid is -1 on the probe side */
+        int            ofd;  /* output descriptor on the probe side */
+
+        void  *map;
+        size_t maplen;
+
+        sch_shmring_t *in;
+        sch_shmring_t *out;
+
+        int efd_rd;      /* the in ring got data */
+        int efd_wr;      /* the out ring got space */
+        int efd_peer_rd; /* the other side's efd_rd */
+        int efd_peer_wr; /* the other side's efd_wr */
+
+        /* only one thread at a time waits on each eventfd */
+        pthread_mutex_t rd_lock;
+        pthread_mutex_t wr_lock;
+} sch_shmdata_t;
+
+int sch_shm_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags);
+int sch_shm_openfd (SEAP_desc_t *desc, int fd, uint32_t flags);
+int sch_shm_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags);
+int sch_shm_openfds (SEAP_desc_t *desc, int ifd, int ofd, const char *fdstr, uint32_t flags);
+ssize_t sch_shm_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags);
+ssize_t sch_shm_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags);
+ssize_t sch_shm_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags);
+int sch_shm_close (SEAP_desc_t *desc, uint32_t flags);
+int sch_shm_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags);
+
+OSCAP_HIDDEN_END;
+
+#endif /* SCH_SHM_H */
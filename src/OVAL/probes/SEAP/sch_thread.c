@@ -0,0 +1,492 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <common/assume.h>
+
+#include "generic/common.h"
+#include "public/sm_alloc.h"
+#include "public/seap.h"
+#include "_sexp-types.h"
+#include "_seap-types.h"
+#include "_seap-scheme.h"
+#include "sch_thread.h"
+#include "seap-descriptor.h"
+
+#define DATA(ptr) ((sch_threaddata_t *)(ptr))
+
+#define STRINGIZE_NX(A) #A
+#define STRINGIZE(A) STRINGIZE_NX(A)
+
+#ifndef RTLD_NODELETE
+# define RTLD_NODELETE 0
+#endif
+
+/*
+ * Modules which are currently running
+ */
+typedef struct sch_threadmod sch_threadmod_t;
+
+struct sch_threadmod {
+        void            *module;
+        sch_threadmod_t *next;
+};
+
+static pthread_mutex_t  __sch_thread_modlock = PTHREAD_MUTEX_INITIALIZER;
+static sch_threadmod_t *__sch_thread_modules = NULL;
+
+static int sch_thread_acquire (void *module)
+{
+        sch_threadmod_t *m;
+
+        pthread_mutex_lock (&__sch_thread_modlock);
+
+        for (m = __sch_thread_modules; m != NULL; m = m->next) {
+                if (m->module == module) {
+                        pthread_mutex_unlock (&__sch_thread_modlock);
+                        errno = EBUSY;
+                        return (-1);
+                }
+        }
+
+        m = sm_talloc (sch_threadmod_t);
+        m->module = module;
+        m->next   = __sch_thread_modules;
+        __sch_thread_modules = m;
+
+        pthread_mutex_unlock (&__sch_thread_modlock);
+
+        return (0);
+}
+
+static void sch_thread_release (void *module)
+{
+        sch_threadmod_t **mp, *m;
+
+        pthread_mutex_lock (&__sch_thread_modlock);
+
+        for (mp = &__sch_thread_modules; *mp != NULL; mp = &(*mp)->next) {
+                if ((*mp)->module == module) {
+                        m   = *mp;
+                        *mp = m->next;
+                        sm_free (m);
+                        break;
+                }
+        }
+
+        pthread_mutex_unlock (&__sch_thread_modlock);
+}
+
+static void sch_threadq_init (sch_threadq_t *q)
+{
+        pthread_mutex_init (&q->lock, NULL);
+        pthread_cond_init (&q->cond, NULL);
+        q->head   = NULL;
+        q->tail   = NULL;
+        q->closed = false;
+}
+
+static void sch_threadq_destroy (sch_threadq_t *q)
+{
+        sch_threadpkt_t *pkt;
+
+        while ((pkt = q->head) != NULL) {
+                q->head = pkt->next;
+                SEXP_free (pkt->sexp);
+                sm_free (pkt);
+        }
+
+        pthread_cond_destroy (&q->cond);
+        pthread_mutex_destroy (&q->lock);
+}
+
+static void sch_threadq_close (sch_threadq_t *q)
+{
+        pthread_mutex_lock (&q->lock);
+        q->closed = true;
+        pthread_cond_broadcast (&q->cond);
+        pthread_mutex_unlock (&q->lock);
+}
+
+static sch_threadpair_t *sch_threadpair_new (void)
+{
+        sch_threadpair_t *pair;
+
+        pair = sm_talloc (sch_threadpair_t);
+        sch_threadq_init (&pair->q[0]);
+        sch_threadq_init (&pair->q[1]);
+        pthread_mutex_init (&pair->lock, NULL);
+        pair->refs = 2;
+
+        return (pair);
+}
+
+static void sch_threadpair_unref (sch_threadpair_t *pair)
+{
+        uint32_t refs;
+
+        pthread_mutex_lock (&pair->lock);
+        refs = --pair->refs;
+        pthread_mutex_unlock (&pair->lock);
+
+        if (refs == 0) {
+                sch_threadq_destroy (&pair->q[0]);
+                sch_threadq_destroy (&pair->q[1]);
+                pthread_mutex_destroy (&pair->lock);
+                sm_free (pair);
+        }
+}
+
+static void sch_threadq_unlock (void *arg)
+{
+        pthread_mutex_unlock ((pthread_mutex_t *)arg);
+}
+
+/*
+ * Wait until there's a packet in the queue or until the queue
+ * is closed. Must be called with q->lock held.
+ */
+static int sch_threadq_wait (sch_threadq_t *q, uint16_t timeout)
+{
+        struct timespec deadline;
+        volatile int ret = 0;
+
+        if (timeout > 0) {
+                clock_gettime (CLOCK_REALTIME, &deadline);
+                deadline.tv_sec += timeout;
+        }
+
+        pthread_cleanup_push (sch_threadq_unlock, &q->lock);
+
+        while (q->head == NULL && !q->closed && ret == 0) {
+                if (timeout > 0)
+                        ret = pthread_cond_timedwait (&q->cond, &q->lock, &deadline);
+                else
+                        ret = pthread_cond_wait (&q->cond, &q->lock);
+        }
+
+        pthread_cleanup_pop (0);
+
+        if (ret != 0) {
+                errno = ret;
+                return (-1);
+        }
+
+        return (0);
+}
+
+int sch_thread_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+{
+        sch_threaddata_t    *data, *peer;
+        sch_threadpair_t    *pair;
+        sch_thread_startfn_t start;
+        sch_thread_stopfn_t  stop;
+        sch_thread_abortfn_t abortfn;
+        const char *path, *name;
+        void       *module;
+
+        assume_r (desc != NULL, -1, errno = EFAULT;);
+        assume_r (uri  != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data == NULL, -1, errno = EALREADY;);
+
+        if (strncmp (uri, "//", 2) != 0 || uri[2] != '/') {
+                errno = EINVAL;
+                return (-1);
+        }
+
+        path = uri + 2;
+        name = strrchr (path, '/') + 1;
+
+        module = dlopen (path, RTLD_NOW | RTLD_LOCAL | RTLD_NODELETE);
+
+        if (module == NULL) {
+                dI("Can't load the probe module: %s", dlerror ());
+                errno = ENOENT;
+                return (-1);
+        }
+
+        *(void **)(&start)   = dlsym (module, STRINGIZE(SCH_THREAD_START));
+        *(void **)(&stop)    = dlsym (module, STRINGIZE(SCH_THREAD_STOP));
+        *(void **)(&abortfn) = dlsym (module, STRINGIZE(SCH_THREAD_ABORT));
+
+        if (start == NULL || stop == NULL || abortfn == NULL) {
+                dI("%s: not a probe module", path);
+                dlclose (module);
+                errno = ENOEXEC;
+                return (-1);
+        }
+
+        if (sch_thread_acquire (module) != 0) {
+                dI("%s: the module is already running", path);
+                dlclose (module);
+                errno = EBUSY;
+                return (-1);
+        }
+
+        pair = sch_threadpair_new ();
+
+        data = sm_talloc (sch_threaddata_t);
+        data->pair   = pair;
+        data->in     = &pair->q[0];
+        data->out    = &pair->q[1];
+        data->module = module;
+        data->stop   = stop;
+        data->abort  = abortfn;
+
+        peer = sm_talloc (sch_threaddata_t);
+        peer->pair   = pair;
+        peer->in     = &pair->q[1];
+        peer->out    = &pair->q[0];
+        peer->module = NULL;
+        peer->probe  = NULL;
+        peer->stop   = NULL;
+        peer->abort  = NULL;
+        peer->peer_ctx = NULL;
+        peer->peer_sd  = -1;
+
+        data->peer_ctx = SEAP_CTX_new ();
+        data->peer_sd  = SEAP_desc_add (data->peer_ctx->sd_table, NULL, SCH_THREAD, peer);
+
+        if (data->peer_sd < 0) {
+                sm_free (peer);
+                sch_threadpair_unref (pair);
+                goto fail;
+        }
+
+        data->probe = start (data->peer_ctx, data->peer_sd, name);
+
+        if (data->probe == NULL) {
+                protect_errno {
+                        dI("%s: the probe failed to start", path);
+                        SEAP_close (data->peer_ctx, data->peer_sd);
+                }
+                goto fail;
+        }
+
+        desc->scheme_data = (void *)data;
+
+        return (0);
+fail:
+        protect_errno {
+                SEAP_CTX_free (data->peer_ctx);
+                sch_threadpair_unref (pair);
+                sm_free (data);
+                sch_thread_release (module);
+                dlclose (module);
+        }
+        return (-1);
+}
+
+int sch_thread_openfd (SEAP_desc_t *desc, int fd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_thread_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+ssize_t sch_thread_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+ssize_t sch_thread_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+/*
+ * The receiver gets a reference to the S-exp. S-exps are copied on
+ * write, so the sender may keep using it.
+ */
+ssize_t sch_thread_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
+{
+        sch_threaddata_t *data = DATA(desc->scheme_data);
+        sch_threadpkt_t  *pkt;
+        bool peer_closed;
+
+        pthread_mutex_lock (&data->in->lock);
+        peer_closed = data->in->closed;
+        pthread_mutex_unlock (&data->in->lock);
+
+        if (peer_closed) {
+                errno = EPIPE;
+                return (-1);
+        }
+
+        pkt = sm_talloc (sch_threadpkt_t);
+        pkt->sexp = SEXP_ref (sexp);
+        pkt->next = NULL;
+
+        pthread_mutex_lock (&data->out->lock);
+
+        if (data->out->tail != NULL)
+                data->out->tail->next = pkt;
+        else
+                data->out->head = pkt;
+
+        data->out->tail = pkt;
+
+        pthread_cond_signal (&data->out->cond);
+        pthread_mutex_unlock (&data->out->lock);
+
+        return (0);
+}
+
+int sch_thread_recvsexp (SEAP_desc_t *desc, SEXP_t **sexp, uint32_t flags)
+{
+        sch_threaddata_t *data = DATA(desc->scheme_data);
+        sch_threadpkt_t  *pkt;
+
+        pthread_mutex_lock (&data->in->lock);
+
+        if (sch_threadq_wait (data->in, 0) != 0) {
+                pthread_mutex_unlock (&data->in->lock);
+                return (-1);
+        }
+
+        if ((pkt = data->in->head) == NULL) {
+                pthread_mutex_unlock (&data->in->lock);
+                errno = ECONNABORTED;
+                return (-1);
+        }
+
+        data->in->head = pkt->next;
+
+        if (data->in->head == NULL)
+                data->in->tail = NULL;
+
+        pthread_mutex_unlock (&data->in->lock);
+
+        /* the receiver expects a list of packets */
+        *sexp = SEXP_list_new (pkt->sexp, NULL);
+        SEXP_free (pkt->sexp);
+        sm_free (pkt);
+
+        return (0);
+}
+
+int sch_thread_close (SEAP_desc_t *desc, uint32_t flags)
+{
+        sch_threaddata_t *data = DATA(desc->scheme_data);
+
+        if (data == NULL)
+                return (0);
+
+        sch_threadq_close (data->out);
+
+        if (data->module != NULL) {
+                /*
+                 * Library side: the probe sees the end of its input and
+                 * finishes. Its descriptor is closed after that.
+                 */
+                if (data->stop (data->probe) == 0) {
+                        SEAP_close (data->peer_ctx, data->peer_sd);
+                        SEAP_CTX_free (data->peer_ctx);
+
+                        sch_thread_release (data->module);
+                        dlclose (data->module);
+                } else {
+                        /*
+                         * Some of the probe threads still run and use
+                         * the peer context. Leak it and keep the module
+                         * marked as running, so that it isn't started
+                         * again over its global state.
+                         */
+                        dW("The probe module didn't stop, leaving it loaded");
+                }
+        }
+
+        sch_threadpair_unref (data->pair);
+        sm_free (data);
+        desc->scheme_data = NULL;
+
+        return (0);
+}
+
+/*
+ * Library side: cancel the probe threads. The probe doesn't reply to the
+ * pending requests, so its side of the channel is closed for it and the
+ * readers get ECONNABORTED.
+ */
+int sch_thread_abort (SEAP_desc_t *desc)
+{
+        sch_threaddata_t *data = DATA(desc->scheme_data);
+
+        if (data == NULL || data->module == NULL) {
+                errno = EINVAL;
+                return (-1);
+        }
+
+        if (data->abort (data->probe) != 0)
+                return (-1);
+
+        sch_threadq_close (data->in);
+
+        return (0);
+}
+
+int sch_thread_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags)
+{
+        sch_threaddata_t *data = DATA(desc->scheme_data);
+        int ret = 0;
+
+        switch (ev) {
+        case SEAP_IO_EVREAD:
+                /* the end of the input is reported by recvsexp */
+                pthread_mutex_lock (&data->in->lock);
+
+                if (sch_threadq_wait (data->in, timeout) != 0)
+                        ret = -1;
+
+                pthread_mutex_unlock (&data->in->lock);
+                break;
+        case SEAP_IO_EVWRITE:
+                pthread_mutex_lock (&data->in->lock);
+
+                if (data->in->closed) {
+                        errno = EPIPE;
+                        ret   = -1;
+                }
+
+                pthread_mutex_unlock (&data->in->lock);
+                break;
+        default:
+                abort ();
+        }
+
+        return (ret);
+}
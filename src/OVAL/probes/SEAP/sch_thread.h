@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#pragma once
+#ifndef SCH_THREAD_H
+#define SCH_THREAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include "public/seap-types.h"
+#include "../../../common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * Thread scheme
+ *
+ * The probe is loaded from a shared object (thread://<path to the module>)
+ * into the calling process and runs in its own threads. Both sides get a
+ * SEAP descriptor and the packets are passed between them as S-exps, i.e.
+ * they're neither encoded nor copied.
+ *
+ * The module has to export the following entry points:
+ *
+ *   void *SCH_THREAD_START(SEAP_CTX_t *ctx, int sd, const char *name)
+ *     start the probe on the descriptor sd and return a handle or NULL
+ *
+ *   int SCH_THREAD_STOP(void *handle)
+ *     wait until the probe threads finish and free the probe; called
+ *     after the library side of the channel was closed. Returns -1 if
+ *     some of the threads didn't finish, the module stays loaded then
+ *
+ *   int SCH_THREAD_ABORT(void *handle)
+ *     cancel the probe threads like SIGUSR1 does in a probe process; the
+ *     probe doesn't reply anymore and is stopped when the channel is closed
+ *
+ * The probe module keeps its state in global variables, so a module can
+ * be started only once at a time. Connecting to a module which is already
+ * running fails with EBUSY.
+ */
+#define SCH_THREAD_START probe_thread_start
+#define SCH_THREAD_STOP  probe_thread_stop
+#define SCH_THREAD_ABORT probe_thread_abort
+
+typedef void *(*sch_thread_startfn_t) (SEAP_CTX_t *, int, const char *);
+typedef int (*sch_thread_stopfn_t) (void *);
+typedef int (*sch_thread_abortfn_t) (void *);
+
+typedef struct sch_threadpkt sch_threadpkt_t;
+
+struct sch_threadpkt {
+        SEXP_t          *sexp;
+        sch_threadpkt_t *next;
+};
+
+/* one direction of the channel */
+typedef struct {
+        pthread_mutex_t  lock;
+        pthread_cond_t   cond;  /* signaled when a packet is queued or the queue is closed */
+        sch_threadpkt_t *head;
+        sch_threadpkt_t *tail;
+        bool             closed; /* the sending side was closed */
+} sch_threadq_t;
+
+typedef struct {
+        sch_threadq_t   q[2];
+        pthread_mutex_t lock;
+        uint32_t        refs;   /* number of open descriptors */
+} sch_threadpair_t;
+
+typedef struct {
+        sch_threadpair_t *pair;
+        sch_threadq_t    *in;
+        sch_threadq_t    *out;
+
+        /* library side only */
+        void                *module; /* dlopen handle */
+        void                *probe;  /* handle returned by the start function */
+        sch_thread_stopfn_t  stop;
+        sch_thread_abortfn_t abort;
+        SEAP_CTX_t          *peer_ctx;
+        int                  peer_sd;
+} sch_threaddata_t;
+
+int sch_thread_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags);
+int sch_thread_openfd (SEAP_desc_t *desc, int fd, uint32_t flags);
+int sch_thread_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags);
+ssize_t sch_thread_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags);
+ssize_t sch_thread_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags);
+ssize_t sch_thread_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags);
+int sch_thread_close (SEAP_desc_t *desc, uint32_t flags);
+int sch_thread_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags);
+int sch_thread_recvsexp (SEAP_desc_t *desc, SEXP_t **sexp, uint32_t flags);
+int sch_thread_abort (SEAP_desc_t *desc);
+
+OSCAP_HIDDEN_END;
+
+#endif /* SCH_THREAD_H */
@@ -27,11 +27,13 @@
 #include <pthread.h>
 
 #include "public/sm_alloc.h"
+#include "public/strbuf.h"
 #include "generic/bitmap.h"
 #include "_sexp-parser.h"
 #include "_seap-scheme.h"
 #include "seap-descriptor.h"
 #include "_sexp-atomic.h"
+#include "_sexp-binary.h"
 
 SEAP_desctable_t *SEAP_desctable_new (void)
 {
@@ -76,6 +78,8 @@ int SEAP_desc_add (SEAP_desctable_t *sd_table, SEXP_pstate_t *pstate,
 		sd_dsc->msg_queue = NULL;
 		sd_dsc->err_queue = rbt_i32_new();
 		sd_dsc->cmd_queue = NULL;
+                sd_dsc->wire_in  = SEAP_WIRE_UNKNOWN;
+                sd_dsc->wire_out = SEAP_WIRE_TEXT;
 
 		SEAP_packetq_init(&sd_dsc->pck_queue);
 
@@ -203,3 +207,28 @@ SEAP_cmdid_t SEAP_desc_gencmdid (SEAP_desctable_t *sd_table, int sd)
 
         return (id);
 }
+
+int SEAP_desc_sbprintf (SEAP_desc_t *dsc, SEXP_t *sexp, strbuf_t *sb)
+{
+        if (dsc->wire_out == SEAP_WIRE_BINARY)
+                return SEXP_binframe_add (sexp, sb);
+        else
+                return SEXP_sbprintf_t (sexp, sb);
+}
+
+ssize_t SEAP_desc_writesexp (SEAP_desc_t *dsc, SEXP_t *sexp, int fd)
+{
+        ssize_t   ret;
+        strbuf_t *sb;
+
+        sb = strbuf_new (SEAP_STRBUF_MAX);
+
+        if (SEAP_desc_sbprintf (dsc, sexp, sb) != 0)
+                ret = -1;
+        else
+                ret = strbuf_write (sb, fd);
+
+        strbuf_free (sb);
+
+        return (ret);
+}
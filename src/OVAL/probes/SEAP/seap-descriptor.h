@@ -27,6 +27,7 @@
 #include <errno.h>
 #include <pthread.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "generic/bitmap.h"
 #include "generic/rbt/rbt.h"
 #include "_sexp-types.h"
@@ -38,10 +39,30 @@
 #include "public/seap-message.h"
 #include "public/seap-command.h"
 #include "public/seap-error.h"
+#include "public/strbuf.h"
 #include "../../../common/util.h"
 
 OSCAP_HIDDEN_START;
 
+/*
+ * Encoding of the S-exps sent over the descriptor. The binary encoding
+ * is negotiated when a probe is started: the library offers it to the
+ * probe by the SEAP_WIRE_BINARY_ARG argument and the probe accepts the
+ * offer by sending an empty binary frame before anything else. Setting
+ * SEAP_WIRE_ENV in the environment of the library to any other value
+ * than "binary" turns the offer off.
+ */
+typedef enum {
+        SEAP_WIRE_UNKNOWN = 0, /* detected from the first received byte */
+        SEAP_WIRE_TEXT,
+        SEAP_WIRE_BINARY
+} SEAP_wire_t;
+
+#define SEAP_WIRE_ENV "SEAP_WIRE_FORMAT"
+#define SEAP_WIRE_HELLO_TIMEOUT 5 /* seconds */
+
+bool SEAP_wire_binary_requested (void);
+
 /*
  * Descriptor table + related stuff
  */
@@ -64,6 +85,9 @@ typedef struct {
         SEAP_cmdid_t   next_cid;
         SEAP_cmdtbl_t *cmd_c_table; /* Local SEAP commands */
         SEAP_cmdtbl_t *cmd_w_table; /* Waiting SEAP commands */
+
+        SEAP_wire_t wire_in;  /* encoding of received S-exps */
+        SEAP_wire_t wire_out; /* encoding of sent S-exps */
 } SEAP_desc_t;
 
 #define SEAP_DESC_FDIN  0x00000001
@@ -133,6 +157,18 @@ static inline int SEAP_desc_unlock (pthread_mutex_t *m)
 #define DESC_WUNLOCK(d)  SEAP_desc_unlock (&((d)->w_lock))
 
 SEAP_msgid_t SEAP_desc_genmsgid (SEAP_desctable_t *sd_table, int sd);
+
+/**
+ * Append the S-exp to the buffer using the output encoding of the SEAP
+ * descriptor.
+ */
+int SEAP_desc_sbprintf (SEAP_desc_t *dsc, SEXP_t *sexp, strbuf_t *sb);
+
+/**
+ * Write the S-exp to the file descriptor using the output encoding
+ * of the SEAP descriptor.
+ */
+ssize_t SEAP_desc_writesexp (SEAP_desc_t *dsc, SEXP_t *sexp, int fd);
 SEAP_cmdid_t SEAP_desc_gencmdid (SEAP_desctable_t *sd_table, int sd);
 
 OSCAP_HIDDEN_END;
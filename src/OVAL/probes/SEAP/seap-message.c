@@ -25,6 +25,7 @@
 #endif
 
 #include <string.h>
+#include <errno.h>
 
 #include "_sexp-types.h"
 #include "_seap-types.h"
@@ -112,6 +113,31 @@ SEAP_msgid_t SEAP_msg_id (SEAP_msg_t *msg)
         return (msg->id);
 }
 
+/**
+ * Get the ID of the message to which `msg' is a reply.
+ * Returns zero and stores the ID at `*id' or -1 if `msg' isn't a reply.
+ */
+int SEAP_msg_reply_id (SEAP_msg_t *msg, SEAP_msgid_t *id)
+{
+        SEXP_t *r0;
+
+        _A(msg != NULL);
+        _A(id  != NULL);
+
+        if ((r0 = SEAP_msgattr_get (msg, "reply-id")) == NULL) {
+                errno = ENOENT;
+                return (-1);
+        }
+#if SEAP_MSGID_BITS == 64
+        *id = SEXP_number_getu_64 (r0);
+#else
+        *id = SEXP_number_getu_32 (r0);
+#endif
+        SEXP_free (r0);
+
+        return (0);
+}
+
 int SEAP_msgattr_set (SEAP_msg_t *msg, const char *attr, SEXP_t *value)
 {
         _A(msg != NULL);
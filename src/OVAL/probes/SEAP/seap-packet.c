@@ -25,12 +25,15 @@
 #endif
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
+#include <inttypes.h>
 #include <errno.h>
 
 #include "generic/common.h"
 #include "public/sexp-manip.h"
 #include "_sexp-parser.h"
+#include "_sexp-binary.h"
 #include "_seap-packetq.h"
 #include "_seap-packet.h"
 #include "_seap-scheme.h"
@@ -39,6 +42,7 @@
 #include "public/seap-command.h"
 #include "public/seap-error.h"
 #include "public/sm_alloc.h"
+#include "public/strbuf.h"
 
 SEAP_packet_t *SEAP_packet_new (void)
 {
@@ -589,6 +593,94 @@ static SEXP_t *SEAP_packet2sexp (SEAP_packet_t *packet)
         return (sexp);
 }
 
+/*
+ * Read exactly len bytes. The timeout applies to the wait for each
+ * chunk of the data after the first one, the same as in the text
+ * receive loop.
+ */
+static int SEAP_packet_recvn (SEAP_CTX_t *ctx, SEAP_desc_t *dsc, void *buf, size_t len)
+{
+        ssize_t ret;
+
+        while (len > 0) {
+                ret = SCH_RECV(dsc->scheme, dsc, buf, len, 0);
+
+                if (ret < 0) {
+                        protect_errno {
+                                dI("FAIL: recv failed: dsc=%p, errno=%u, %s.", dsc, errno, strerror (errno));
+                        }
+                        return (-1);
+                } else if (ret == 0) {
+                        dI("zero bytes received -> EOF");
+                        errno = ECONNABORTED;
+                        return (-1);
+                }
+
+                buf  = (uint8_t *)buf + ret;
+                len -= (size_t)ret;
+
+                if (len > 0 && SCH_SELECT(dsc->scheme, dsc, SEAP_IO_EVREAD, ctx->recv_timeout, 0) != 0) {
+                        protect_errno {
+                                dI("FAIL: recv failed: dsc=%p, errno=%u, %s.", dsc, errno, strerror (errno));
+                        }
+                        return (-1);
+                }
+        }
+
+        return (0);
+}
+
+/*
+ * Receive one binary frame and return the S-exp it carries wrapped in
+ * a list, as if it was returned by the text parser. Empty (handshake)
+ * frames are skipped.
+ */
+static int SEAP_packet_recvframe (SEAP_CTX_t *ctx, SEAP_desc_t *dsc, bool marked, SEXP_t **sexp_buffer)
+{
+        uint8_t  hdr[SEXP_BINFRAME_HDRLEN];
+        uint32_t length;
+        uint8_t *data;
+        SEXP_t  *sexp;
+        size_t   off;
+
+        hdr[0] = SEXP_BINFRAME_MARK;
+        off    = marked ? 1 : 0;
+
+        do {
+                if (SEAP_packet_recvn (ctx, dsc, hdr + off, sizeof hdr - off) != 0)
+                        return (-1);
+                if (SEXP_binframe_hdr (hdr, &length) != 0) {
+                        dI("FAIL: invalid binary frame header");
+                        return (-1);
+                }
+
+                off = 0;
+        } while (length == 0);
+
+        data = sm_alloc (length);
+
+        if (SEAP_packet_recvn (ctx, dsc, data, length) != 0) {
+                protect_errno {
+                        sm_free (data);
+                }
+                return (-1);
+        }
+
+        sexp = SEXP_binframe_parse (data, length);
+        sm_free (data);
+
+        if (sexp == NULL) {
+                dI("FAIL: invalid binary frame: length=%"PRIu32, length);
+                errno = EILSEQ;
+                return (-1);
+        }
+
+        *sexp_buffer = SEXP_list_new (sexp, NULL);
+        SEXP_free (sexp);
+
+        return (0);
+}
+
 int SEAP_packet_recv (SEAP_CTX_t *ctx, int sd, SEAP_packet_t **packet)
 {
         SEAP_desc_t *dsc;
@@ -606,6 +698,7 @@ int SEAP_packet_recv (SEAP_CTX_t *ctx, int sd, SEAP_packet_t **packet)
         char       *psym_cstr;
 
 	SEAP_packet_t *_packet;
+        bool           marked;
 
         dsc = SEAP_desc_get (ctx->sd_table, sd);
 
@@ -663,6 +756,69 @@ eloop_start:
                 }
         }
 eloop_exit:
+        /* Schemes which pass S-exps directly skip the decoding */
+        if (__schtbl[dsc->scheme].sch_recvsexp != NULL) {
+                if (SCH_RECVSEXP(dsc->scheme, dsc, &sexp_buffer, 0) != 0) {
+                        protect_errno {
+                                dI("FAIL: recv failed: dsc=%p, errno=%u, %s.", dsc, errno, strerror (errno));
+                                DESC_RUNLOCK(dsc);
+                        }
+                        return (-1);
+                }
+
+                DESC_RUNLOCK(dsc);
+                goto packet_loop;
+        }
+
+        data_buffer = NULL;
+        data_buflen = 0;
+        data_length = 0;
+        marked      = false;
+
+        /*
+         * The encoding of the stream is detected from its first byte
+         * unless it was negotiated. A text S-exp can't start with the
+         * binary frame marker.
+         */
+        if (dsc->wire_in == SEAP_WIRE_UNKNOWN) {
+                data_buffer = sm_alloc (1);
+                data_buflen = 1;
+                data_length = SCH_RECV(dsc->scheme, dsc, data_buffer, data_buflen, 0);
+
+                if (data_length <= 0) {
+                        protect_errno {
+                                dI("FAIL: recv failed: dsc=%p, errno=%u, %s.", dsc, errno, strerror (errno));
+                                sm_free (data_buffer);
+                                DESC_RUNLOCK(dsc);
+                        }
+
+                        if (data_length == 0)
+                                errno = ECONNABORTED;
+
+                        return (-1);
+                }
+
+                if (*(uint8_t *)data_buffer == SEXP_BINFRAME_MARK) {
+                        dsc->wire_in = SEAP_WIRE_BINARY;
+                        marked = true;
+
+                        sm_free (data_buffer);
+                        data_buffer = NULL;
+                } else
+                        dsc->wire_in = SEAP_WIRE_TEXT;
+        }
+
+        if (dsc->wire_in == SEAP_WIRE_BINARY) {
+                if (SEAP_packet_recvframe (ctx, dsc, marked, &sexp_buffer) != 0) {
+                        protect_errno {
+                                DESC_RUNLOCK(dsc);
+                        }
+                        return (-1);
+                }
+
+                DESC_RUNLOCK(dsc);
+                goto packet_loop;
+        }
 
         /*
          * Receive loop
@@ -681,9 +837,12 @@ eloop_exit:
         SEXP_psetup_setflags(psetup, SEXP_PFLAG_FREEBUF);
 
         for (;;) {
-                data_buffer = sm_alloc (SEAP_RECVBUF_SIZE);
-                data_buflen = SEAP_RECVBUF_SIZE;
-                data_length = SCH_RECV(dsc->scheme, dsc, data_buffer, data_buflen, 0);
+                /* the first byte might have been read by the detection above */
+                if (data_buffer == NULL) {
+                        data_buffer = sm_alloc (SEAP_RECVBUF_SIZE);
+                        data_buflen = SEAP_RECVBUF_SIZE;
+                        data_length = SCH_RECV(dsc->scheme, dsc, data_buffer, data_buflen, 0);
+                }
 
                 if (data_length < 0) {
                         protect_errno {
@@ -747,6 +906,8 @@ eloop_exit:
 			}
 		}
 
+                data_buffer = NULL;
+
                 if (SCH_SELECT(dsc->scheme, dsc, SEAP_IO_EVREAD, ctx->recv_timeout, 0) != 0) {
                         switch (errno) {
                         case ETIMEDOUT:
@@ -770,6 +931,7 @@ eloop_exit:
         }
 
         SEXP_psetup_free (psetup);
+packet_loop:
 	SEXP_VALIDATE(sexp_buffer);
 	(*packet) = NULL;
 
@@ -992,6 +1154,70 @@ int SEAP_packet_send (SEAP_CTX_t *ctx, int sd, SEAP_packet_t *packet)
         return (ret);
 }
 
+int SEAP_packet_hello_send (SEAP_CTX_t *ctx, int sd)
+{
+        SEAP_desc_t *dsc;
+        strbuf_t    *sb;
+        int ret;
+
+        dsc = SEAP_desc_get (ctx->sd_table, sd);
+
+        if (dsc == NULL)
+                return (-1);
+
+        ret = -1;
+        sb  = strbuf_new (SEAP_STRBUF_MAX);
+
+        if (SEXP_binframe_add_hello (sb) == 0 && DESC_WLOCK (dsc)) {
+                if (SCH_SEND(dsc->scheme, dsc, sb->beg->data, strbuf_length (sb), 0) == (ssize_t)strbuf_length (sb)) {
+                        dsc->wire_out = SEAP_WIRE_BINARY;
+                        ret = 0;
+                }
+
+                DESC_WUNLOCK(dsc);
+        }
+
+        strbuf_free (sb);
+
+        return (ret);
+}
+
+int SEAP_packet_hello_recv (SEAP_CTX_t *ctx, int sd)
+{
+        SEAP_desc_t *dsc;
+        uint8_t  hdr[SEXP_BINFRAME_HDRLEN];
+        uint32_t length;
+
+        dsc = SEAP_desc_get (ctx->sd_table, sd);
+
+        if (dsc == NULL)
+                return (-1);
+
+        if (SCH_SELECT(dsc->scheme, dsc, SEAP_IO_EVREAD, SEAP_WIRE_HELLO_TIMEOUT, 0) != 0) {
+                if (errno != ETIMEDOUT)
+                        return (-1);
+
+                dI("The binary wire format wasn't accepted: dsc=%p", dsc);
+                return (0);
+        }
+
+        if (SEAP_packet_recvn (ctx, dsc, hdr, sizeof hdr) != 0)
+                return (-1);
+
+        if (SEXP_binframe_hdr (hdr, &length) != 0 || length != 0) {
+                dW("Unexpected data received instead of the wire format handshake: dsc=%p", dsc);
+                errno = EILSEQ;
+                return (-1);
+        }
+
+        dI("Using the binary wire format: dsc=%p", dsc);
+
+        dsc->wire_in  = SEAP_WIRE_BINARY;
+        dsc->wire_out = SEAP_WIRE_BINARY;
+
+        return (0);
+}
+
 int SEAP_packet_enqueue (SEAP_CTX_t *ctx, int sd, SEAP_packet_t *packet)
 {
         return (-1);
@@ -36,22 +36,38 @@ const SEAP_schemefn_t __schtbl[] = {
           sch_cons_connect, sch_cons_openfd,
           sch_cons_openfd2, sch_cons_recv,
           sch_cons_send, sch_cons_close,
-          sch_cons_sendsexp, sch_cons_select },
+          sch_cons_sendsexp, sch_cons_select,
+          NULL },
         { "dummy",
           sch_dummy_connect, sch_dummy_openfd,
           sch_dummy_openfd2, sch_dummy_recv,
           sch_dummy_send, sch_dummy_close,
-          sch_dummy_sendsexp, sch_dummy_select },
+          sch_dummy_sendsexp, sch_dummy_select,
+          NULL },
         { "generic",
           sch_generic_connect, sch_generic_openfd,
           sch_generic_openfd2, sch_generic_recv,
           sch_generic_send, sch_generic_close,
-          sch_generic_sendsexp, sch_generic_select },
+          sch_generic_sendsexp, sch_generic_select,
+          NULL },
         { "pipe",    /* This schem is used from libopenscap to talk to probes */
           sch_pipe_connect, sch_pipe_openfd,
           sch_pipe_openfd2, sch_pipe_recv,
           sch_pipe_send, sch_pipe_close,
-          sch_pipe_sendsexp, sch_pipe_select }
+          sch_pipe_sendsexp, sch_pipe_select,
+          NULL },
+        { "shm",     /* Like pipe, but the data is passed through shared memory */
+          sch_shm_connect, sch_shm_openfd,
+          sch_shm_openfd2, sch_shm_recv,
+          sch_shm_send, sch_shm_close,
+          sch_shm_sendsexp, sch_shm_select,
+          NULL },
+        { "thread",  /* Probe module loaded into the library process */
+          sch_thread_connect, sch_thread_openfd,
+          sch_thread_openfd2, sch_thread_recv,
+          sch_thread_send, sch_thread_close,
+          sch_thread_sendsexp, sch_thread_select,
+          sch_thread_recvsexp }
 };
 
 #define SCHTBLSIZE ((sizeof __schtbl)/sizeof (SEAP_schemefn_t))
@@ -25,6 +25,7 @@
 #endif
 
 #include <stddef.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -91,6 +92,13 @@ void SEAP_CTX_free (SEAP_CTX_t *ctx)
         return;
 }
 
+bool SEAP_wire_binary_requested (void)
+{
+        const char *wire = getenv (SEAP_WIRE_ENV);
+
+        return (wire == NULL || strcmp (wire, "binary") == 0);
+}
+
 int SEAP_connect (SEAP_CTX_t *ctx, const char *uri, uint32_t flags)
 {
         SEAP_desc_t  *dsc;
@@ -134,6 +142,18 @@ int SEAP_connect (SEAP_CTX_t *ctx, const char *uri, uint32_t flags)
                 return (-1);
         }
 
+        /* The pipe and shm schemes offer the binary wire format to the probe */
+        if ((scheme == SCH_PIPE || scheme == SCH_SHM) && SEAP_wire_binary_requested ()) {
+                if (SEAP_packet_hello_recv (ctx, sd) != 0) {
+                        protect_errno {
+                                dI("FAIL: handshake: errno=%u, %s.", errno, strerror (errno));
+                                SEAP_close (ctx, sd);
+                        }
+
+                        return (-1);
+                }
+        }
+
         return (sd);
 }
 
@@ -149,12 +169,14 @@ int SEAP_openfd (SEAP_CTX_t *ctx, int fd, uint32_t flags)
         return (-1);
 }
 
-int SEAP_openfd2 (SEAP_CTX_t *ctx, int ifd, int ofd, uint32_t flags)
+static int __SEAP_openfd2 (SEAP_CTX_t *ctx, int ifd, int ofd, const char *fdstr, uint32_t flags)
 {
-        SEAP_desc_t *dsc;
-        int sd;
+        SEAP_desc_t  *dsc;
+        SEAP_scheme_t scheme;
+        int sd, ret;
 
-        sd = SEAP_desc_add (ctx->sd_table, NULL, SCH_GENERIC, NULL);
+        scheme = fdstr != NULL ? SCH_SHM : SCH_GENERIC;
+        sd = SEAP_desc_add (ctx->sd_table, NULL, scheme, NULL);
 
         if (sd < 0) {
                 dI("Can't create/add new SEAP descriptor");
@@ -168,14 +190,41 @@ int SEAP_openfd2 (SEAP_CTX_t *ctx, int ifd, int ofd, uint32_t flags)
                 return(-1);
         }
 
-        if (SCH_OPENFD2(SCH_GENERIC, dsc, ifd, ofd, flags) != 0) {
+        if (fdstr != NULL)
+                ret = sch_shm_openfds (dsc, ifd, ofd, fdstr, flags & ~SEAP_OPENFD_WIRE_BINARY);
+        else
+                ret = SCH_OPENFD2(scheme, dsc, ifd, ofd, flags & ~SEAP_OPENFD_WIRE_BINARY);
+
+        if (ret != 0) {
                 dI("FAIL: errno=%u, %s.", errno, strerror (errno));
                 return (-1);
         }
 
+        if (flags & SEAP_OPENFD_WIRE_BINARY) {
+                if (SEAP_packet_hello_send (ctx, sd) != 0) {
+                        dI("FAIL: handshake: errno=%u, %s.", errno, strerror (errno));
+                        return (-1);
+                }
+        }
+
         return (sd);
 }
 
+int SEAP_openfd2 (SEAP_CTX_t *ctx, int ifd, int ofd, uint32_t flags)
+{
+        return __SEAP_openfd2 (ctx, ifd, ofd, NULL, flags);
+}
+
+int SEAP_openshm (SEAP_CTX_t *ctx, int ifd, int ofd, const char *fdstr, uint32_t flags)
+{
+        if (fdstr == NULL) {
+                errno = EFAULT;
+                return (-1);
+        }
+
+        return __SEAP_openfd2 (ctx, ifd, ofd, fdstr, flags);
+}
+
 int SEAP_recvsexp (SEAP_CTX_t *ctx, int sd, SEXP_t **sexp)
 {
         SEAP_msg_t *msg = NULL;
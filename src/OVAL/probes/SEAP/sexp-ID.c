@@ -124,4 +124,81 @@ SEXP_ID_t SEXP_ID_v2(const SEXP_t *s)
         return (pair.hash);
 }
 
+/*
+ * Mix a memory block into the fingerprint. The block is hashed first and
+ * then the fingerprint state and the block hash are hashed together, so
+ * the whole 128 bits of the state are carried over to the next block.
+ */
+static void SEXP_ID_fp_mix(SEXP_FP_t *fp, const void *buf, size_t len, uint32_t seed)
+{
+        uint64_t mixbuf[4];
+
+        MurmurHash3_x64_128(buf, (int)len, seed, mixbuf + 2);
+
+        mixbuf[0] = fp->lo;
+        mixbuf[1] = fp->hi;
+
+        MurmurHash3_x64_128(mixbuf, sizeof mixbuf, 0x7C0FFEE7, mixbuf);
+
+        fp->lo = mixbuf[0];
+        fp->hi = mixbuf[1];
+}
+
+static int SEXP_ID_fp_callback(const SEXP_t *sexp, __IDres_fp *res)
+{
+        SEXP_val_t v_dsc;
+
+        assume_d(sexp != NULL, -1);
+        assume_d(res  != NULL, -1);
+
+        SEXP_val_dsc(&v_dsc, sexp->s_valp);
+        ++res->count;
+
+        switch (v_dsc.type) {
+        case SEXP_VALTYPE_NUMBER:
+        case SEXP_VALTYPE_STRING:
+                SEXP_ID_fp_mix(res->fp, v_dsc.mem, v_dsc.hdr->size, v_dsc.type);
+                break;
+        case SEXP_VALTYPE_LIST:
+        {
+                __IDres_fp lres;
+
+                lres.fp    = res->fp;
+                lres.count = 0;
+
+                SEXP_rawval_lblk_cb ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr,
+                                     (int (*)(SEXP_t *, void *)) SEXP_ID_fp_callback,
+                                     (void *) &lres,
+                                     SEXP_LCASTP(v_dsc.mem)->offset + 1);
+                /*
+                 * Terminate the list with its length so that nested
+                 * and flat lists with the same atoms differ.
+                 */
+                SEXP_ID_fp_mix(res->fp, &lres.count, sizeof lres.count, v_dsc.type);
+                break;
+        }
+        case SEXP_VALTYPE_EMPTY:
+                SEXP_ID_fp_mix(res->fp, res, 0, v_dsc.type);
+                break;
+        default:
+                /* Unknown S-exp value type */
+                abort ();
+        }
+
+        return (0);
+}
+
+void SEXP_ID_fp(const SEXP_t *s, SEXP_FP_t *fp)
+{
+        __IDres_fp res;
+
+        fp->lo = 0xAD30917100C0FFEE;
+        fp->hi = 0xAD309171FFC0FFEE;
+
+        res.fp    = fp;
+        res.count = 0;
+
+        SEXP_ID_fp_callback(s, &res);
+}
+
 /// @}
@@ -0,0 +1,452 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "generic/common.h"
+#include "public/strbuf.h"
+#include "public/sm_alloc.h"
+#include "public/sexp-manip.h"
+#include "_sexp-types.h"
+#include "_sexp-binary.h"
+#include "_sexp-value.h"
+#include "_sexp-datatype.h"
+#include "_sexp-rawptr.h"
+
+#define SEXP_BIN_LIST   0x01
+#define SEXP_BIN_STRING 0x02
+#define SEXP_BIN_UINT   0x03
+#define SEXP_BIN_INT    0x04
+#define SEXP_BIN_DOUBLE 0x05
+#define SEXP_BIN_TRUE   0x06
+#define SEXP_BIN_FALSE  0x07
+#define SEXP_BIN_DTYPE  0x80
+
+#define SEXP_BIN_MAXDEPTH 1024
+
+static size_t SEXP_bin_varint (uint8_t *buf, uint64_t n)
+{
+        size_t i = 0;
+
+        while (n >= 0x80) {
+                buf[i++] = (uint8_t)(n | 0x80);
+                n >>= 7;
+        }
+        buf[i++] = (uint8_t)n;
+
+        return (i);
+}
+
+static int SEXP_bin_addatom (strbuf_t *sb, uint8_t tag, uint64_t n)
+{
+        uint8_t buffer[1 + 10];
+
+        buffer[0] = tag;
+
+        return strbuf_add (sb, (const char *)buffer, 1 + SEXP_bin_varint (buffer + 1, n));
+}
+
+static int SEXP_bin_add (SEXP_t *s_exp, strbuf_t *sb)
+{
+        SEXP_val_t v_dsc;
+
+        if (SEXP_rawptr_mask(s_exp->s_type, SEXP_DATATYPEPTR_MASK) != NULL) {
+                const char *name;
+                size_t      nlen;
+
+                name = SEXP_datatype_name(s_exp->s_type);
+                nlen = strlen (name);
+
+                if (SEXP_bin_addatom (sb, SEXP_BIN_DTYPE, nlen) != 0)
+                        return (-1);
+                if (strbuf_add (sb, name, nlen) != 0)
+                        return (-1);
+        }
+
+        SEXP_val_dsc (&v_dsc, s_exp->s_valp);
+
+        switch (v_dsc.type) {
+        case SEXP_VALTYPE_NUMBER:
+        {
+                int64_t i;
+
+                switch (SEXP_NTYPEP(v_dsc.hdr->size, v_dsc.mem)) {
+                case SEXP_NUM_BOOL:
+                        return strbuf_addc (sb, SEXP_NCASTP(b, v_dsc.mem)->n ? SEXP_BIN_TRUE : SEXP_BIN_FALSE);
+                case SEXP_NUM_UINT8:
+                        return SEXP_bin_addatom (sb, SEXP_BIN_UINT, SEXP_NCASTP(u8, v_dsc.mem)->n);
+                case SEXP_NUM_UINT16:
+                        return SEXP_bin_addatom (sb, SEXP_BIN_UINT, SEXP_NCASTP(u16, v_dsc.mem)->n);
+                case SEXP_NUM_UINT32:
+                        return SEXP_bin_addatom (sb, SEXP_BIN_UINT, SEXP_NCASTP(u32, v_dsc.mem)->n);
+                case SEXP_NUM_UINT64:
+                        return SEXP_bin_addatom (sb, SEXP_BIN_UINT, SEXP_NCASTP(u64, v_dsc.mem)->n);
+                case SEXP_NUM_INT8:
+                        i = SEXP_NCASTP(i8, v_dsc.mem)->n;
+                        break;
+                case SEXP_NUM_INT16:
+                        i = SEXP_NCASTP(i16, v_dsc.mem)->n;
+                        break;
+                case SEXP_NUM_INT32:
+                        i = SEXP_NCASTP(i32, v_dsc.mem)->n;
+                        break;
+                case SEXP_NUM_INT64:
+                        i = SEXP_NCASTP(i64, v_dsc.mem)->n;
+                        break;
+                case SEXP_NUM_DOUBLE:
+                {
+                        uint8_t  buffer[1 + 8];
+                        char     text[66 + 1];
+                        uint64_t bits;
+                        double   f;
+                        int      b;
+
+                        /*
+                         * Send the value the text parser would get from the
+                         * text output so the results don't depend on the
+                         * encoding. Integral values become integers.
+                         */
+                        snprintf (text, sizeof text, "%g", SEXP_NCASTP(f, v_dsc.mem)->n);
+
+                        if (strpbrk (text, ".eEnN") == NULL) {
+                                if (text[0] == '-') {
+                                        i = strtoll (text, NULL, 10);
+                                        break;
+                                }
+
+                                return SEXP_bin_addatom (sb, SEXP_BIN_UINT, strtoull (text, NULL, 10));
+                        }
+
+                        f = strtod (text, NULL);
+                        memcpy (&bits, &f, sizeof bits);
+                        buffer[0] = SEXP_BIN_DOUBLE;
+
+                        for (b = 0; b < 8; ++b)
+                                buffer[1 + b] = (uint8_t)(bits >> (8 * b));
+
+                        return strbuf_add (sb, (const char *)buffer, sizeof buffer);
+                }
+                default:
+                        abort ();
+                }
+
+                /*
+                 * Signed numbers which aren't negative are sent as unsigned
+                 * ones. The text parser doesn't distinguish them either.
+                 */
+                if (i >= 0)
+                        return SEXP_bin_addatom (sb, SEXP_BIN_UINT, (uint64_t)i);
+                else
+                        return SEXP_bin_addatom (sb, SEXP_BIN_INT, (uint64_t)(-(i + 1)));
+        }
+        case SEXP_VALTYPE_STRING:
+                if (SEXP_bin_addatom (sb, SEXP_BIN_STRING, v_dsc.hdr->size / sizeof (char)) != 0)
+                        return (-1);
+
+                return strbuf_add (sb, (const char *)v_dsc.mem, v_dsc.hdr->size / sizeof (char));
+        case SEXP_VALTYPE_LIST:
+                if (SEXP_bin_addatom (sb, SEXP_BIN_LIST,
+                                      SEXP_rawval_list_length (SEXP_LCASTP(v_dsc.mem))) != 0)
+                        return (-1);
+
+                return SEXP_rawval_lblk_cb ((uintptr_t)SEXP_LCASTP(v_dsc.mem)->b_addr,
+                                            (int (*)(SEXP_t *, void *)) SEXP_bin_add, (void *)sb,
+                                            SEXP_LCASTP(v_dsc.mem)->offset + 1) != 0 ? -1 : 0;
+        default:
+                abort ();
+        }
+
+        return (0);
+}
+
+int SEXP_binframe_add (SEXP_t *s_exp, strbuf_t *sb)
+{
+        size_t   size;
+        uint32_t length;
+        uint8_t *hdr;
+
+        _A(sb != NULL && sb->beg == NULL);
+
+        if (SEXP_binframe_add_hello (sb) != 0)
+                return (-1);
+        if (SEXP_bin_add (s_exp, sb) != 0)
+                return (-1);
+
+        size = strbuf_length (sb) - SEXP_BINFRAME_HDRLEN;
+
+        if (size > UINT32_MAX) {
+                errno = EMSGSIZE;
+                return (-1);
+        }
+
+        /*
+         * The header was added to an empty buffer so it's at the start
+         * of the first block.
+         */
+        length = (uint32_t)size;
+        hdr    = (uint8_t *)sb->beg->data;
+
+        hdr[1] = (uint8_t)(length);
+        hdr[2] = (uint8_t)(length >> 8);
+        hdr[3] = (uint8_t)(length >> 16);
+        hdr[4] = (uint8_t)(length >> 24);
+
+        return (0);
+}
+
+int SEXP_binframe_add_hello (strbuf_t *sb)
+{
+        const uint8_t hdr[SEXP_BINFRAME_HDRLEN] = { SEXP_BINFRAME_MARK, 0, 0, 0, 0 };
+
+        return strbuf_add (sb, (const char *)hdr, sizeof hdr);
+}
+
+int SEXP_binframe_hdr (const uint8_t *hdr, uint32_t *length)
+{
+        if (hdr[0] != SEXP_BINFRAME_MARK) {
+                errno = EILSEQ;
+                return (-1);
+        }
+
+        *length = (uint32_t)hdr[1]
+                | (uint32_t)hdr[2] << 8
+                | (uint32_t)hdr[3] << 16
+                | (uint32_t)hdr[4] << 24;
+
+        return (0);
+}
+
+struct SEXP_bin_pstate {
+        const uint8_t *buf;
+        size_t         len;
+        size_t         off;
+};
+
+static int SEXP_bin_getvarint (struct SEXP_bin_pstate *ps, uint64_t *n)
+{
+        uint64_t v = 0;
+        unsigned s;
+
+        for (s = 0; s < 64; s += 7) {
+                uint8_t b;
+
+                if (ps->off >= ps->len)
+                        return (-1);
+
+                b  = ps->buf[ps->off++];
+                v |= (uint64_t)(b & 0x7f) << s;
+
+                if (!(b & 0x80)) {
+                        *n = v;
+                        return (0);
+                }
+        }
+
+        return (-1);
+}
+
+static int SEXP_bin_getblob (struct SEXP_bin_pstate *ps, const uint8_t **blob, size_t *size)
+{
+        uint64_t n;
+
+        if (SEXP_bin_getvarint (ps, &n) != 0)
+                return (-1);
+        if (n > ps->len - ps->off)
+                return (-1);
+
+        *blob = ps->buf + ps->off;
+        *size = (size_t)n;
+        ps->off += (size_t)n;
+
+        return (0);
+}
+
+/*
+ * Numbers are created with the smallest type which can hold them, the
+ * same way as the text parser does it.
+ */
+static SEXP_t *SEXP_bin_newu (uint64_t n)
+{
+        if (n > UINT16_MAX) {
+                if (n > UINT32_MAX)
+                        return SEXP_number_newu_64 (n);
+                else
+                        return SEXP_number_newu_32 ((uint32_t)n);
+        } else {
+                if (n > UINT8_MAX)
+                        return SEXP_number_newu_16 ((uint16_t)n);
+                else
+                        return SEXP_number_newu_8 ((uint8_t)n);
+        }
+}
+
+static SEXP_t *SEXP_bin_newi (int64_t n)
+{
+        if (n < INT16_MIN) {
+                if (n < INT32_MIN)
+                        return SEXP_number_newi_64 (n);
+                else
+                        return SEXP_number_newi_32 ((int32_t)n);
+        } else {
+                if (n < INT8_MIN)
+                        return SEXP_number_newi_16 ((int16_t)n);
+                else
+                        return SEXP_number_newi_8 ((int8_t)n);
+        }
+}
+
+static SEXP_t *SEXP_bin_parse (struct SEXP_bin_pstate *ps, unsigned int depth)
+{
+        SEXP_t  *s_exp;
+        uint8_t  tag;
+        uint64_t n;
+        char     dtype[256];
+
+        const uint8_t *blob;
+        size_t         size;
+
+        if (ps->off >= ps->len || depth > SEXP_BIN_MAXDEPTH)
+                return (NULL);
+
+        tag = ps->buf[ps->off++];
+        dtype[0] = '\0';
+
+        if (tag == SEXP_BIN_DTYPE) {
+                if (SEXP_bin_getblob (ps, &blob, &size) != 0)
+                        return (NULL);
+                if (size == 0 || size >= sizeof dtype)
+                        return (NULL);
+
+                memcpy (dtype, blob, size);
+                dtype[size] = '\0';
+
+                if (ps->off >= ps->len)
+                        return (NULL);
+
+                tag = ps->buf[ps->off++];
+        }
+
+        switch (tag) {
+        case SEXP_BIN_LIST:
+                if (SEXP_bin_getvarint (ps, &n) != 0)
+                        return (NULL);
+                /* every element takes at least one byte */
+                if (n > ps->len - ps->off)
+                        return (NULL);
+
+                s_exp = SEXP_list_new (NULL);
+
+                while (n-- > 0) {
+                        SEXP_t *memb = SEXP_bin_parse (ps, depth + 1);
+
+                        if (memb == NULL) {
+                                SEXP_free (s_exp);
+                                return (NULL);
+                        }
+
+                        SEXP_list_add (s_exp, memb);
+                        SEXP_free (memb);
+                }
+                break;
+        case SEXP_BIN_STRING:
+                if (SEXP_bin_getblob (ps, &blob, &size) != 0)
+                        return (NULL);
+
+                s_exp = SEXP_string_new (blob, size);
+                break;
+        case SEXP_BIN_UINT:
+                if (SEXP_bin_getvarint (ps, &n) != 0)
+                        return (NULL);
+
+                s_exp = SEXP_bin_newu (n);
+                break;
+        case SEXP_BIN_INT:
+                if (SEXP_bin_getvarint (ps, &n) != 0 || n > INT64_MAX)
+                        return (NULL);
+
+                s_exp = SEXP_bin_newi (-(int64_t)n - 1);
+                break;
+        case SEXP_BIN_DOUBLE:
+        {
+                uint64_t bits = 0;
+                double   f;
+                int      b;
+
+                if (ps->len - ps->off < 8)
+                        return (NULL);
+
+                for (b = 0; b < 8; ++b)
+                        bits |= (uint64_t)ps->buf[ps->off + b] << (8 * b);
+
+                ps->off += 8;
+                memcpy (&f, &bits, sizeof f);
+                s_exp = SEXP_number_newf (f);
+                break;
+        }
+        case SEXP_BIN_TRUE:
+                s_exp = SEXP_number_newb (true);
+                break;
+        case SEXP_BIN_FALSE:
+                s_exp = SEXP_number_newb (false);
+                break;
+        default:
+                return (NULL);
+        }
+
+        if (s_exp != NULL && dtype[0] != '\0') {
+                if (SEXP_datatype_set (s_exp, dtype) != 0) {
+                        SEXP_free (s_exp);
+                        return (NULL);
+                }
+        }
+
+        return (s_exp);
+}
+
+SEXP_t *SEXP_binframe_parse (const uint8_t *buf, size_t len)
+{
+        struct SEXP_bin_pstate ps;
+        SEXP_t *s_exp;
+
+        ps.buf = buf;
+        ps.len = len;
+        ps.off = 0;
+
+        s_exp = SEXP_bin_parse (&ps, 0);
+
+        if (s_exp != NULL && ps.off != ps.len) {
+                SEXP_free (s_exp);
+                s_exp = NULL;
+        }
+
+        if (s_exp == NULL)
+                errno = EILSEQ;
+
+        return (s_exp);
+}
@@ -842,11 +842,10 @@ char *SEXP_string_subcstr (const SEXP_t *s_exp, size_t beg, size_t len)
 
         s_len -= beg;
 
-        if (s_len > len)
+        if (len > 0 && s_len > len)
                 s_len = len;
 
         if (s_len > 0) {
-                s_len = v_dsc.hdr->size / sizeof (char);
                 s_str = sm_alloc (sizeof (char) * (s_len + 1));
 
                 memcpy (s_str, ((char *) v_dsc.mem) + beg, sizeof (char) * s_len);
@@ -220,7 +220,7 @@ struct pfdata {
 #endif
 };
 
-static int process_file(const char *path, const char *file, void *arg)
+static int process_file(const char *path, const char *file, const struct stat *statp, void *arg)
 {
 	struct pfdata *pfd = (struct pfdata *) arg;
 	int ret = 0, path_len, file_len, cur_inst = 0, fd = -1, substr_cnt,
@@ -252,9 +252,12 @@ static int process_file(const char *path, const char *file, void *arg)
 	 * upon a symlink without a target would cause fts_read() to return
 	 * the 'FTS_SLNONE' flag, but the 'FTS_PHYSICAL' option causes it
 	 * to return 'FTS_SL' and the presence of a valid target has to
-	 * be determined with stat().
+	 * be determined with stat(). The lstat() from the walk does for
+	 * anything but a symlink.
 	 */
-	if (stat(whole_path, &st) == -1)
+	if (statp != NULL && !S_ISLNK(statp->st_mode))
+		st = *statp;
+	else if (stat(whole_path, &st) == -1)
 		goto cleanup;
 	if (!S_ISREG(st.st_mode))
 		goto cleanup;
@@ -350,6 +353,7 @@ static int process_file(const char *path, const char *file, void *arg)
 void *probe_init(void)
 {
   probe_setoption(PROBEOPT_OFFLINE_MODE_SUPPORTED, PROBE_OFFLINE_CHROOT);
+  probe_setoption(PROBEOPT_MULTITHREADED, true);
   return NULL;
 }
 
@@ -488,7 +492,7 @@ int probe_main(probe_ctx *ctx, void *arg)
 			if (ofts_ent->fts_info == FTS_F
 			    || ofts_ent->fts_info == FTS_SL) {
 				// todo: handle return code
-				process_file(ofts_ent->path, ofts_ent->file, &pfd);
+				process_file(ofts_ent->path, ofts_ent->file, ofts_ent->fts_statp, &pfd);
 			}
 			oval_ftsent_free(ofts_ent);
 		}
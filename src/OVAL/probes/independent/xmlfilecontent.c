@@ -56,6 +56,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
 
 #include <libxml/tree.h>
 #include <libxml/parser.h>
@@ -193,7 +194,15 @@ static int process_file(const char *path, const char *filename, void *arg)
 		double d;
 
 		d = xmlXPathCastToNumber(xpath_obj);
-		val = SEXP_number_newf(d);
+		/*
+		 * Integral values (e.g. the result of count()) are
+		 * reported as integers, the same way the S-exp
+		 * encoding used to pass them to the library does.
+		 */
+		if (d > -9.2e18 && d < 9.2e18 && d == (double)(int64_t)d)
+			val = SEXP_number_newi_64((int64_t)d);
+		else
+			val = SEXP_number_newf(d);
 		probe_item_ent_add(item, "value_of", NULL, val);
 		SEXP_free(val);
 		break;
@@ -27,6 +27,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -35,8 +36,8 @@
 #include <assume.h>
 #include <pcre.h>
 #include <libgen.h>
+#include <unistd.h>
 
-#include "fsdev.h"
 #include "_probe-api.h"
 #include "probe/entcmp.h"
 #include "alloc.h"
@@ -73,6 +74,10 @@ static void OVAL_FTS_free(OVAL_FTS *ofts)
 		fts_close(ofts->ofts_match_path_fts);
 	if (ofts->ofts_recurse_path_fts != NULL)
 		fts_close(ofts->ofts_recurse_path_fts);
+	if (ofts->ofts_recurse_path_walk != NULL)
+		oval_fts_walk_close(ofts->ofts_recurse_path_walk);
+	oval_fts_snapshot_put(ofts->ofts_recurse_path_snapshot);
+	oval_fts_pattern_free(ofts->ofts_path_pattern);
 
 	oscap_free(ofts);
 	return;
@@ -93,24 +98,31 @@ static int pathlen_from_ftse(int fts_pathlen, int fts_namelen)
 	return pathlen;
 }
 
-static OVAL_FTSENT *OVAL_FTSENT_new(OVAL_FTS *ofts, FTSENT *fts_ent)
+static OVAL_FTSENT *OVAL_FTSENT_new(OVAL_FTS *ofts, unsigned int info, const char *path, size_t path_len,
+				    const char *name, size_t name_len, const struct stat *statp)
 {
 	OVAL_FTSENT *ofts_ent;
 
 	ofts_ent = oscap_talloc(OVAL_FTSENT);
 
-	ofts_ent->fts_info = fts_ent->fts_info;
+	ofts_ent->fts_info = info;
+	if (statp != NULL) {
+		ofts_ent->fts_stat = *statp;
+		ofts_ent->fts_statp = &ofts_ent->fts_stat;
+	} else {
+		ofts_ent->fts_statp = NULL;
+	}
 	if (ofts->ofts_sfilename || ofts->ofts_sfilepath) {
-		ofts_ent->path_len = pathlen_from_ftse(fts_ent->fts_pathlen, fts_ent->fts_namelen);
+		ofts_ent->path_len = pathlen_from_ftse(path_len, name_len);
 		ofts_ent->path = oscap_alloc(ofts_ent->path_len + 1);
-		strncpy(ofts_ent->path, fts_ent->fts_path, ofts_ent->path_len);
+		strncpy(ofts_ent->path, path, ofts_ent->path_len);
 		ofts_ent->path[ofts_ent->path_len] = '\0';
 
-		ofts_ent->file_len = fts_ent->fts_namelen;
-		ofts_ent->file = strdup(fts_ent->fts_name);
+		ofts_ent->file_len = name_len;
+		ofts_ent->file = strdup(name);
 	} else {
-		ofts_ent->path_len = fts_ent->fts_pathlen;
-		ofts_ent->path = strdup(fts_ent->fts_path);
+		ofts_ent->path_len = path_len;
+		ofts_ent->path = strdup(path);
 
 		ofts_ent->file_len = -1;
 		ofts_ent->file = NULL;
@@ -122,6 +134,12 @@ static OVAL_FTSENT *OVAL_FTSENT_new(OVAL_FTS *ofts, FTSENT *fts_ent)
 	return (ofts_ent);
 }
 
+static OVAL_FTSENT *OVAL_FTSENT_from_fts(OVAL_FTS *ofts, FTSENT *fts_ent)
+{
+	return OVAL_FTSENT_new(ofts, fts_ent->fts_info, fts_ent->fts_path, fts_ent->fts_pathlen,
+			       fts_ent->fts_name, fts_ent->fts_namelen, NULL);
+}
+
 static void OVAL_FTSENT_free(OVAL_FTSENT *ofts_ent)
 {
 	oscap_free(ofts_ent->path);
@@ -280,234 +298,29 @@ static bool OVAL_FTS_localp(OVAL_FTS *ofts, const char *path, void *id)
 		return (false);
 	}
 #else
+	struct stat st;
+
+	dD("Looking up the filesystem of '%s'.", path != NULL ? path : "");
+
 	if (id != NULL)
-		return (fsdev_search(ofts->localdevs, id) == 1 ? true : false);
-	else if (path != NULL)
-		return (fsdev_path(ofts->localdevs, path) == 1 ? true : false);
+		return oval_fts_mounts_local(ofts->localdevs, *(dev_t *) id);
+	else if (path != NULL && stat(path, &st) == 0)
+		return oval_fts_mounts_local(ofts->localdevs, st.st_dev);
 	else
 		return (false);
 #endif
 }
 
-static char *__regex_locate(char *str)
-{
-    char *regex_sch = "^*?$.(["; /*<< regex start chars */
-    bool  escaped = false;
-
-    while (*str != '\0') {
-	if (*str == '\\')
-	    escaped = !escaped;
-	else if (strchr(regex_sch, *str) != NULL) {
-	    if (!escaped)
-		return (str);
-	    else
-		escaped = false;
-	}
-	++str;
-    }
-
-    return (str);
-}
-
-static char *__string_unescape(char *str, size_t len)
-{
-    char *ret_str;
-    size_t i, j;
-
-    if (str == NULL || len == 0)
-        return NULL;
-
-    ret_str = strndup(str, len);
-
-    if (ret_str == NULL)
-        return NULL;
-
-    for (i = j = 0; i < len && j <= i; ++i) {
-        if (str[i] == '\\') {
-            if (str[i+1] == '\0') {
-                free(ret_str);
-                return NULL;
-            }
-            ret_str[j] = str[i+1];
-            ++j;
-            ++i;
-        } else {
-            ret_str[j] = str[i];
-            ++j;
-        }
-    }
-
-    ret_str[j] = '\0';
-
-    return ret_str;
-}
-
-static char *extract_fixed_path_prefix(char *path)
-{
-	char *s;
-
-	if (path[0] == '^')
-		path++;
-
-	s = __regex_locate(path);
-	if (*s != '\0')
-		for (s--; s > (path + 1) && *s != '/'; s--);
-	if (s > (path + 1)) {
-		s = __string_unescape(path, (size_t) (s - path));
-		if (s != NULL) {
-			if (s[0] == '/')
-				return s;
-			free(s);
-		}
-	}
-
-	return strdup("/");
-}
-
-static int badpartial_check_slash(const char *pattern)
-{
-	pcre *regex;
-	const char *errptr = NULL;
-	int errofs = 0, fb, ret;
-
-	regex = pcre_compile(pattern + 1 /* skip '^' */, 0, &errptr, &errofs, NULL);
-	if (regex == NULL) {
-		dE("Failed to validate the pattern: pcre_compile(): "
-		   "error: '%s', error offset: %d, pattern: '%s'.\n",
-		   errofs, errptr, pattern);
-		return -1;
-	}
-	ret = pcre_fullinfo(regex, NULL, PCRE_INFO_FIRSTBYTE, &fb);
-	pcre_free(regex);
-	regex = NULL;
-	if (ret != 0) {
-		dE("Failed to validate the pattern: pcre_fullinfo(): "
-		   "return code: %d, pattern: '%s'.\n", ret, pattern);
-		return -1;
-	}
-	if (fb != '/') {
-		dE("Failed to validate the pattern: pcre_fullinfo(): "
-		   "first byte: %d '%c', pattern: '%s' - the first "
-		   "byte should be a '/'.\n", fb, fb, pattern);
-		return -2;
-	}
-
-	return 0;
-}
-
-#define TEST_PATH1 "/"
-#define TEST_PATH2 "x"
-
-static int badpartial_transform_pattern(char *pattern, pcre **regex_out)
+/* Verify that the path pattern is usable and compile it to prune the
+   filesystem traversal. Returns the directory to start the traversal from,
+   or NULL if the pattern is invalid. */
+static char *process_pattern_match(const char *path, OVAL_FTS_PATTERN **pattern_out)
 {
-	/*
-	  PCREPARTIAL(3)
-	  http://pcre.org/pcre.txt
-	  Last updated: 21 January 2012
-
-	  For releases of PCRE prior to 8.00, because of the way
-	  certain internal optimizations were implemented in the
-	  pcre_exec() function, the PCRE_PARTIAL option (predecessor
-	  of PCRE_PARTIAL_SOFT) could not be used with all patterns.
-
-	  Items that were formerly restricted were repeated single
-	  characters and repeated metasequences. If PCRE_PARTIAL was
-	  set for a pattern that did not conform to the restrictions,
-	  pcre_exec() returned the error code PCRE_ERROR_BADPARTIAL
-	  (-13).
-	*/
-
-	int ret, brkt_lvl = 0, errofs = 0;
-	const char *rchars = "\\[]()*+{"; /* probably incomplete */
-	const char *test_path1 = TEST_PATH1;
-	const char *errptr = NULL;
-	char *s, *brkt_mark;
-	bool bracketed = false, found_regex = false;
-	pcre *regex;
-
-	/* The processing bellow builds upon the assumption that
-	   the pattern has been validated by pcre_compile() */
-	for (s = brkt_mark = pattern; (s = strpbrk(s, rchars)) != NULL; s++) {
-		switch (*s) {
-		case '\\':
-			s++;
-			break;
-		case '[':
-			if (!bracketed) {
-				bracketed = true;
-				if (s[1] == ']')
-					s++;
-			}
-			break;
-		case ']':
-			bracketed = false;
-			break;
-		case '(':
-			if (!bracketed) {
-				if (brkt_lvl++ == 0)
-					brkt_mark = s;
-			}
-			break;
-		case ')':
-			if (!bracketed)
-				brkt_lvl--;
-			break;
-		default:
-			if (!bracketed)
-				found_regex = true;
-			break;
-		}
-		if (found_regex)
-			break;
-	}
-
-	if (s == NULL) {
-		dW("Nonfatal failure: can't transform the pattern for partial "
-		   "match optimization: none of the suspected culprits found, "
-		   "pattern: '%s'.", pattern);
-		return -1;
-	}
-
-	if (brkt_lvl > 0)
-		*brkt_mark = '\0';
-	else
-		*s = '\0';
-
-	regex = pcre_compile(pattern, 0, &errptr, &errofs, NULL);
-	if (regex == NULL) {
-		dW("Nonfatal failure: can't transform the pattern for partial "
-		   "match optimization, error: '%s', error offset: %d, "
-		   "pattern: '%s'.", errptr, errofs, pattern);
-		return -1;
-	}
-
-	ret = pcre_exec(regex, NULL, test_path1, strlen(test_path1), 0,
-		PCRE_PARTIAL, NULL, 0);
-	if (ret != PCRE_ERROR_PARTIAL && ret < 0) {
-		pcre_free(regex);
-		dW("Nonfatal failure: can't transform the pattern for partial "
-		   "match optimization, pcre_exec() return code: %d, pattern: "
-		   "'%s'.", ret, pattern);
-		return -1;
-	}
-
-	if (regex_out != NULL)
-		*regex_out = regex;
-
-	return 0;
-}
-
-/* Verify that the path is usable and try to craft a regex to speed up
-   the filesystem traversal. If the path to match is ill-designed, an
-   ugly heuristic is employed to obtain something meaningfull. */
-static int process_pattern_match(const char *path, pcre **regex_out)
-{
-	int ret, errofs = 0;
-	char *pattern;
-	const char *test_path1 = TEST_PATH1;
-	//const char *test_path2 = TEST_PATH2;
+	int errofs = 0;
+	char *pattern, *prefix;
 	const char *errptr = NULL;
 	pcre *regex;
+	OVAL_FTS_PATTERN *pat;
 
 	if (path[0] != '^') {
 		/* Matching has to have a fixed starting point and thus
@@ -531,119 +344,46 @@ static int process_pattern_match(const char *path, pcre **regex_out)
 		   "error offset: %d, error: '%s', pattern: '%s'.\n",
 		   errofs, errptr, pattern);
 		free(pattern);
-		return -1;
-	}
-	ret = pcre_exec(regex, NULL, test_path1, strlen(test_path1), 0,
-		PCRE_PARTIAL, NULL, 0);
-
-	switch (ret) {
-	case PCRE_ERROR_PARTIAL:
-		/* The pattern has matched a prefix of the test path
-		   and probably begins with a slash. Make sure that it
-		   doesn't match an arbitrary prefix. */
-
-		/* todo:
-		   Convince folks that they should really fix their
-		   OVAL definitions that use ".*" as 'path' and then
-		   uncomment this.
-
-		dI("pcre_exec() returned PCRE_ERROR_PARTIAL for pattern '%s' "
-		   "and test path '%s'.\n", pattern, test_path1);
-		ret = pcre_exec(regex, NULL, test_path2, strlen(test_path2),
-			0, PCRE_PARTIAL, NULL, 0);
-		if (ret == PCRE_ERROR_PARTIAL || ret >= 0) {
-			dE("Failed to validate the pattern: test path '%s' "
-			   "matched by pattern '%s' - the pattern is too "
-			   "general, i.e. inefficient. This could take a "
-			   "lifetime to complete.\n", test_path2, pattern);
-			pcre_free(regex);
-			free(pattern);
-			return -2;
-		}
-		*/
-		break;
-	case PCRE_ERROR_BADPARTIAL:
-		dI("pcre_exec() returned PCRE_ERROR_BADPARTIAL for pattern "
-		   "'%s' and a test path '%s'. Falling back to "
-		   "pcre_fullinfo().\n", pattern, test_path1);
-		pcre_free(regex);
-		regex = NULL;
-
-		/* Fallback to first byte check to determin if
-		   the pattern begins with a slash. */
-		ret = badpartial_check_slash((const char *) pattern);
-		if (ret != 0) {
-			free(pattern);
-			return ret;
-		}
-		/* The pattern contains features that this version of
-		   PCRE can't handle for partial matching. At least
-		   try to find the longest well-bracketed prefix that
-		   can be handled. */
-		badpartial_transform_pattern(pattern, &regex);
-		break;
-	case PCRE_ERROR_NOMATCH:
-		/* The pattern doesn't contain a leading slash (or
-		   some part of this code is broken). Apologise to the
-		   user and fail. */
-		dE("Failed to validate the pattern: pcre_exec() returned "
-		   "PCRE_ERROR_NOMATCH for pattern '%s' and a test path '%s'. "
-		   "This indicates the pattern doesn't match a leading '/'.\n",
-		   pattern, test_path1);
-		pcre_free(regex);
-		free(pattern);
-		return -2;
-	default:
-		if (ret >= 0) {
-			/* The pattern actually matches the test
-			   path. Iteresting… Make sure that it doesn't
-			   match an arbitrary prefix. */
-
-			/* todo:
-			   Convince folks that they should really fix
-			   their OVAL definitions that use ".*" as
-			   'path' and then uncomment this.
-
-			ret = pcre_exec(regex, NULL, test_path2, strlen(test_path2),
-					0, PCRE_PARTIAL, NULL, 0);
-			if (ret == PCRE_ERROR_PARTIAL || ret >= 0) {
-				dE("Failed to validate the pattern: test path '%s' "
-				   "matched by pattern '%s' - the pattern is too "
-				   "general, i.e. inefficient. This could take a "
-				   "lifetime to complete.\n", test_path2, pattern);
-				pcre_free(regex);
-				free(pattern);
-				return -2;
-			}
-			*/
-			break;
-		}
-		/* Some other error. */
-		dE("Failed to validate the pattern: pcre_exec() return "
-		   "code: %d, pattern '%s', test path '%s'.\n", ret,
-		   pattern, test_path1);
-		pcre_free(regex);
-		free(pattern);
-		return -1;
+		return NULL;
 	}
+	pcre_free(regex);
 
-	if (regex == NULL) {
+	pat = oval_fts_pattern_new(pattern);
+	if (pat == NULL) {
 		dI("Disabling partial match optimization.");
-	} else {
-		dI("Enabling partial match optimization using "
-		   "pattern: '%s'.", pattern);
-		if (regex_out != NULL)
-			*regex_out = regex;
+		free(pattern);
+		return strdup("/");
+	}
+	if (oval_fts_pattern_step(pat, oval_fts_pattern_start(pat), "/", 1) == OVAL_FTS_PATTERN_DEAD) {
+		/* Apologise to the user and fail. */
+		dE("Failed to validate the pattern: the pattern '%s' "
+		   "doesn't match a leading '/'.\n", pattern);
+		oval_fts_pattern_free(pat);
+		free(pattern);
+		return NULL;
 	}
 
+	dI("Enabling partial match optimization using pattern: '%s'.", pattern);
+	prefix = oval_fts_pattern_prefix(pat);
+	*pattern_out = pat;
 	free(pattern);
 
-	return 0;
+	return prefix;
 }
 
+static unsigned int oval_fts_walk_jobs(void)
+{
+	const char *jobs = getenv(OVAL_FTS_JOBS_ENV);
+	long n;
+
+	if (jobs == NULL)
+		return 1;
+	n = strtol(jobs, NULL, 10);
+	if (n == 0)
+		n = sysconf(_SC_NPROCESSORS_ONLN);
 
-#undef TEST_PATH1
-#undef TEST_PATH2
+	return n > 0 ? n : 1;
+}
 
 OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t *behaviors, SEXP_t* result)
 {
@@ -665,7 +405,7 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 
 	uint32_t path_op;
 	bool nilfilename = false;
-	pcre *regex = NULL;
+	OVAL_FTS_PATTERN *pattern = NULL;
 	struct stat st;
 
 	assume_d((path == NULL && filename == NULL && filepath != NULL)
@@ -798,9 +538,9 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 	if (path_op == OVAL_OPERATION_EQUALS) {
 		paths[0] = strdup(cstr_path);
 	} else if (path_op == OVAL_OPERATION_PATTERN_MATCH) {
-		if (process_pattern_match(cstr_path, &regex) != 0)
+		paths[0] = process_pattern_match(cstr_path, &pattern);
+		if (paths[0] == NULL)
 			return NULL;
-		paths[0] = extract_fixed_path_prefix(cstr_path);
 		dI("Extracted fixed path: '%s'.", paths[0]);
 	} else {
 		paths[0] = strdup("/");
@@ -814,12 +554,14 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 			   errno, strerror(errno));
 		}
 		free((void *) paths[0]);
+		oval_fts_pattern_free(pattern);
 		return NULL;
 	}
 
 	dI("Opening file '%s'.", paths[0]);
 
 	ofts = OVAL_FTS_new();
+	ofts->ofts_path_pattern = pattern;
 	/* reset errno as fts_open() doesn't do it itself. */
 	errno = 0;
 	ofts->ofts_match_path_fts = fts_open((char * const *) paths, mtc_fts_options, NULL);
@@ -834,20 +576,14 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 
 	ofts->ofts_recurse_path_fts_opts = rec_fts_options;
 	ofts->ofts_path_op = path_op;
-	if (regex != NULL) {
-		const char *errptr = NULL;
-
-		ofts->ofts_path_regex = regex;
-		ofts->ofts_path_regex_extra = pcre_study(regex, 0, &errptr);
-	}
 
 	if (filesystem == OVAL_RECURSE_FS_LOCAL) {
 #if   defined(__SVR4) && defined(__sun)
 		ofts->localdevs = NULL;
 #else
-		ofts->localdevs = fsdev_init(NULL, 0);
+		ofts->localdevs = oval_fts_mounts_get();
 		if (ofts->localdevs == NULL) {
-			dE("fsdev_init() failed.");
+			dE("Can't read the local filesystems.");
 			/* One dummy read to get rid of an uninitialized
 			 * value in the FTS data before calling
 			 * fts_close() on it. */
@@ -869,6 +605,8 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 
 	ofts->recurse = recurse;
 	ofts->filesystem = filesystem;
+	ofts->ofts_recurse_path_walk_jobs = oval_fts_walk_jobs();
+	ofts->ofts_recurse_path_walk_ordered = getenv(OVAL_FTS_UNORDERED_ENV) == NULL;
 
 	if (path) { /* filepath == NULL */
 		ofts->ofts_spath = SEXP_ref(path); /* path entity */
@@ -893,24 +631,55 @@ OVAL_FTS *oval_fts_open(SEXP_t *path, SEXP_t *filename, SEXP_t *filepath, SEXP_t
 	return (ofts);
 }
 
-static inline int _oval_fts_is_local(OVAL_FTS *ofts, FTSENT *fts_ent) {
+static inline int _oval_fts_is_local(OVAL_FTS *ofts, int level, unsigned int info, const char *path,
+				     const struct stat *statp, dev_t dir_dev) {
 # if defined (__SVR4) && defined(__sun)
 	/* pseudo filesystems will be skipped */
 	/* don't recurse into remote fs if local is specified */
-	return ((fts_ent->fts_info == FTS_D || fts_ent->fts_info == FTS_SL)
-	    && (!OVAL_FTS_localp(ofts, fts_ent->fts_path,
-	    (fts_ent->fts_statp != NULL) ?
-	    &fts_ent->fts_statp->st_fstype : NULL)));
+	return ((info == FTS_D || info == FTS_SL)
+	    && (!OVAL_FTS_localp(ofts, path,
+	    (statp != NULL) ?
+	    (void *) &statp->st_fstype : NULL)));
 #else
-	/* don't recurse into non-local filesystems */
+	/* don't recurse into non-local filesystems, the directory of the
+	   entry is local so only a change of the device is looked up */
 	return (ofts->filesystem == OVAL_RECURSE_FS_LOCAL
-	    && (fts_ent->fts_info == FTS_D || fts_ent->fts_info == FTS_SL)
-	    && (!OVAL_FTS_localp(ofts, fts_ent->fts_path,
-				 (fts_ent->fts_statp != NULL) ?
-				 &fts_ent->fts_statp->st_dev : NULL)));
+	    && (info == FTS_D || info == FTS_SL)
+	    && (level == FTS_ROOTLEVEL || statp == NULL || statp->st_dev != dir_dev)
+	    && (!OVAL_FTS_localp(ofts, path,
+				 (statp != NULL) ?
+				 (void *) &statp->st_dev : NULL)));
 #endif
 }
 
+/* length of the path of the entry extended by the paths below it, without
+   the trailing slash of a root like "/" */
+static size_t oval_fts_match_path_dirlen(const FTSENT *fts_ent)
+{
+	size_t len = fts_ent->fts_pathlen;
+
+	if (len > 0 && fts_ent->fts_path[len - 1] == '/')
+		len--;
+
+	return len;
+}
+
+/* state of the path pattern after the path of the entry, without the trailing slash */
+static int oval_fts_match_path_state(OVAL_FTS *ofts, FTSENT *fts_ent)
+{
+	size_t len = oval_fts_match_path_dirlen(fts_ent), plen;
+
+	if (fts_ent->fts_level == FTS_ROOTLEVEL)
+		return oval_fts_pattern_step(ofts->ofts_path_pattern,
+					     oval_fts_pattern_start(ofts->ofts_path_pattern),
+					     fts_ent->fts_path, len);
+
+	/* the path of an entry extends the path of its directory */
+	plen = oval_fts_match_path_dirlen(fts_ent->fts_parent);
+	return oval_fts_pattern_step(ofts->ofts_path_pattern, fts_ent->fts_parent->fts_number,
+				     fts_ent->fts_path + plen, len - plen);
+}
+
 /* find the first matching path or filepath */
 static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 {
@@ -939,47 +708,45 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 		   fts_ent->fts_name, fts_ent->fts_namelen, fts_ent->fts_info);
 #endif
 
-		if (fts_ent->fts_info == FTS_SL) {
-#if defined(OSCAP_FTS_DEBUG)
-			dI("Only the target of a symlink gets reported, skipping '%s'.", fts_ent->fts_path, fts_ent->fts_name);
-#endif
-			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_FOLLOW);
-			continue;
-		}
-		if (_oval_fts_is_local(ofts, fts_ent)) {
+		/* the directories are pruned before the path is matched */
+		if (_oval_fts_is_local(ofts, fts_ent->fts_level, fts_ent->fts_info, fts_ent->fts_path, fts_ent->fts_statp,
+				       fts_ent->fts_level == FTS_ROOTLEVEL ? 0 : fts_ent->fts_parent->fts_statp->st_dev)) {
 			dI("Don't recurse into non-local filesystems, skipping '%s'.", fts_ent->fts_path);
-			fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
 			continue;
 		}
 		/* don't recurse beyond the initial filesystem */
 		if (ofts->filesystem == OVAL_RECURSE_FS_DEFINED
 		    && (fts_ent->fts_info == FTS_D || fts_ent->fts_info == FTS_SL)
 		    && ofts->ofts_recurse_path_devid != fts_ent->fts_statp->st_dev) {
-			fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
+			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
 			continue;
 		}
 
 		/* partial match optimization for OVAL_OPERATION_PATTERN_MATCH operation on path and filepath */
-		if (ofts->ofts_path_regex != NULL && fts_ent->fts_info == FTS_D) {
-			int ret, svec[3];
-
-			ret = pcre_exec(ofts->ofts_path_regex, ofts->ofts_path_regex_extra,
-					fts_ent->fts_path, fts_ent->fts_pathlen, 0, PCRE_PARTIAL,
-					svec, sizeof(svec) / sizeof(svec[0]));
-			if (ret < 0) {
-				switch (ret) {
-				case PCRE_ERROR_NOMATCH:
-					dD("Partial match optimization: PCRE_ERROR_NOMATCH, skipping.");
-					fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
-					continue;
-				case PCRE_ERROR_PARTIAL:
-					dD("Partial match optimization: PCRE_ERROR_PARTIAL, continuing.");
-					continue;
-				default:
-					dE("pcre_exec() error: %d.", ret);
-					return NULL;
-				}
+		if (ofts->ofts_path_pattern != NULL) {
+			bool match, descend;
+			int state;
+
+			state = fts_ent->fts_number = oval_fts_match_path_state(ofts, fts_ent);
+			if (oval_fts_match_path_dirlen(fts_ent) < (size_t) fts_ent->fts_pathlen)
+				state = oval_fts_pattern_step(ofts->ofts_path_pattern, state, "/", 1);
+			match = oval_fts_pattern_match(ofts->ofts_path_pattern, state);
+			descend = oval_fts_pattern_descend(ofts->ofts_path_pattern, fts_ent->fts_number);
+			if (!descend && fts_ent->fts_info == FTS_D) {
+				dD("Partial match optimization: no path below '%s' can match, skipping.", fts_ent->fts_path);
+				fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_SKIP);
 			}
+			if (!match && !(descend && fts_ent->fts_info == FTS_SL))
+				continue;
+		}
+
+		if (fts_ent->fts_info == FTS_SL) {
+#if defined(OSCAP_FTS_DEBUG)
+			dI("Only the target of a symlink gets reported, skipping '%s'.", fts_ent->fts_path, fts_ent->fts_name);
+#endif
+			fts_set(ofts->ofts_match_path_fts, fts_ent, FTS_FOLLOW);
+			continue;
 		}
 
 		if ((ofts->ofts_sfilepath && fts_ent->fts_info == FTS_D)
@@ -1015,152 +782,164 @@ static FTSENT *oval_fts_read_match_path(OVAL_FTS *ofts)
 	return fts_ent;
 }
 
-/* find the first matching file or directory */
-static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
+/* is the entry the target of the recursion */
+static bool oval_fts_recurse_match(OVAL_FTS *ofts, bool collect_dirs, int level, unsigned int info, const char *name)
 {
-	FTSENT *out_fts_ent = NULL;
-	/* the condition below is correct because ofts_sfilepath is NULL here */
-	bool collect_dirs = (ofts->ofts_sfilename == NULL);
+	SEXP_t *stmp;
+	oval_result_t result;
 
-	switch (ofts->direction) {
+	if (collect_dirs)
+		return info == FTS_D && (ofts->max_depth == -1 || level <= ofts->max_depth);
+	if (info == FTS_D)
+		return false;
 
-	case OVAL_RECURSE_DIRECTION_DOWN:
-	case OVAL_RECURSE_DIRECTION_NONE:
+	stmp = SEXP_string_newf("%s", name);
+	result = probe_entobj_cmp(ofts->ofts_sfilename, stmp);
+	if (result == OVAL_RESULT_ERROR)
+		probe_cobj_set_flag(ofts->result, SYSCHAR_FLAG_ERROR);
+	SEXP_free(stmp);
+
+	return result == OVAL_RESULT_TRUE;
+}
+
+/* where to go from the entry in the downward recursion, FTS_SKIP, FTS_FOLLOW or 0 */
+static int oval_fts_recurse_instr(OVAL_FTS *ofts, int level, unsigned int info, const char *path, const struct stat *statp,
+				  dev_t dir_dev)
+{
+	int instr = 0;
+
+	if (level > 0) { /* don't skip fts root */
+		/* limit recursion depth */
 		if (ofts->direction == OVAL_RECURSE_DIRECTION_NONE
-		    && collect_dirs) {
-			/* the target is the directory itself */
-			out_fts_ent = ofts->ofts_match_path_fts_ent;
-			ofts->ofts_match_path_fts_ent = NULL;
+		    || (ofts->max_depth != -1 && level > ofts->max_depth))
+			return FTS_SKIP;
+
+		/* limit recursion only to selected file types */
+		switch (info) {
+		case FTS_D:
+			if (!(ofts->recurse & OVAL_RECURSE_DIRS))
+				return FTS_SKIP;
+			break;
+		case FTS_SL:
+			if (!(ofts->recurse & OVAL_RECURSE_SYMLINKS))
+				return FTS_SKIP;
+			instr = FTS_FOLLOW;
 			break;
+		default:
+			return 0;
 		}
+	}
+	if (_oval_fts_is_local(ofts, level, info, path, statp, dir_dev))
+		return FTS_SKIP;
+	/* don't recurse beyond the initial filesystem */
+	if (ofts->filesystem == OVAL_RECURSE_FS_DEFINED
+	    && (info == FTS_D || info == FTS_SL)
+	    && ofts->ofts_recurse_path_devid != statp->st_dev)
+		return FTS_SKIP;
+
+	return instr;
+}
 
-		/* initialize separate fts for recursion */
-		if (ofts->ofts_recurse_path_fts == NULL) {
-			char * const paths[2] = { ofts->ofts_match_path_fts_ent->fts_path, NULL };
-
-#if defined(OSCAP_FTS_DEBUG)
-			dI("fts_open args: path: \"%s\", options: %d.",
-				paths[0], ofts->ofts_recurse_path_fts_opts);
-#endif
-			/* reset errno as fts_open() doesn't do it itself. */
-			errno = 0;
-			ofts->ofts_recurse_path_fts = fts_open(paths,
-				ofts->ofts_recurse_path_fts_opts, NULL);
-			/* fts_open() doesn't return NULL for all errors
-			   (e.g. nonexistent paths), so check errno to detect it.
-			   Far from being perfect. */
-			if (ofts->ofts_recurse_path_fts == NULL || errno != 0) {
-				dE("fts_open() failed, errno: %d \"%s\".",
-					errno, strerror(errno));
-#if !defined(OSCAP_FTS_DEBUG)
-				dE("fts_open args: path: \"%s\", options: %d.",
-					paths[0], ofts->ofts_recurse_path_fts_opts);
-#endif
-				if (ofts->ofts_recurse_path_fts != NULL) {
-					fts_close(ofts->ofts_recurse_path_fts);
-					ofts->ofts_recurse_path_fts = NULL;
-				}
-				return (NULL);
-			}
-		}
+static int oval_fts_walk_instr(const OVAL_FTS_WALK_ENT *ent, void *arg)
+{
+	return oval_fts_recurse_instr((OVAL_FTS *) arg, ent->level, ent->info, ent->path, &ent->st, ent->dir_dev);
+}
 
-		/* iterate until a match is found or all elements have been traversed */
-		while (out_fts_ent == NULL) {
-			FTSENT *fts_ent;
+/* match the files which aren't directories nor symlinks before they are stat-ed */
+static int oval_fts_walk_filter(const char *name, void *arg)
+{
+	OVAL_FTS *ofts = (OVAL_FTS *) arg;
+	SEXP_t *stmp;
+	oval_result_t result;
 
-			fts_ent = fts_read(ofts->ofts_recurse_path_fts);
-			if (fts_ent == NULL) {
-				fts_close(ofts->ofts_recurse_path_fts);
-				ofts->ofts_recurse_path_fts = NULL;
+	/* only directories are collected */
+	if (ofts->ofts_sfilename == NULL)
+		return OVAL_FTS_WALK_DROP;
 
-				return NULL;
-			}
+	stmp = SEXP_string_newf("%s", name);
+	result = probe_entobj_cmp(ofts->ofts_sfilename, stmp);
+	SEXP_free(stmp);
 
-			switch (fts_ent->fts_info) {
-			case FTS_DP:
-				continue;
-			case FTS_DC:
-				dW("Filesystem tree cycle detected at '%s'.", fts_ent->fts_path);
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
-				continue;
-			}
+	switch (result) {
+	case OVAL_RESULT_TRUE:
+		return OVAL_FTS_WALK_MATCH;
+	case OVAL_RESULT_FALSE:
+		return OVAL_FTS_WALK_DROP;
+	default:
+		/* the reader compares it again and records the error */
+		return OVAL_FTS_WALK_KEEP;
+	}
+}
 
-#if defined(OSCAP_FTS_DEBUG)
-			dI("fts_path: '%s' (l=%d)."
-			   "fts_name: '%s' (l=%d).\n"
-			   "fts_info: %u.\n", fts_ent->fts_path, fts_ent->fts_pathlen,
-			   fts_ent->fts_name, fts_ent->fts_namelen, fts_ent->fts_info);
-#endif
+/* the downward recursion, see oval_fts_walk.h */
+static OVAL_FTSENT *oval_fts_walk_recurse_path(OVAL_FTS *ofts, bool collect_dirs)
+{
+	const OVAL_FTS_WALK_ENT *ent;
+
+	if (ofts->ofts_recurse_path_walk == NULL) {
+		const char *path = ofts->ofts_match_path_fts_ent->fts_path;
+		/* only a walk of the whole tree takes a snapshot of it */
+		bool take = ofts->direction == OVAL_RECURSE_DIRECTION_DOWN && ofts->max_depth == -1
+			&& (ofts->recurse & OVAL_RECURSE_DIRS);
+
+		ofts->ofts_recurse_path_snapshot = oval_fts_snapshot_get(path, take,
+			ofts->ofts_recurse_path_walk_jobs);
+		ofts->ofts_recurse_path_walk = oval_fts_walk_open(path,
+			ofts->ofts_recurse_path_walk_jobs, ofts->ofts_recurse_path_walk_ordered,
+			oval_fts_walk_instr, oval_fts_walk_filter, ofts, ofts->ofts_recurse_path_snapshot);
+		if (ofts->ofts_recurse_path_walk == NULL) {
+			dE("oval_fts_walk_open() failed, errno: %d \"%s\", path: \"%s\".",
+			   errno, strerror(errno), path);
+			oval_fts_snapshot_put(ofts->ofts_recurse_path_snapshot);
+			ofts->ofts_recurse_path_snapshot = NULL;
+			return (NULL);
+		}
+	}
 
-			/* collect matching target */
-			if (collect_dirs) {
-				if (fts_ent->fts_info == FTS_D
-				    && (ofts->max_depth == -1 || fts_ent->fts_level <= ofts->max_depth))
-					out_fts_ent = fts_ent;
-			} else {
-				if (fts_ent->fts_info != FTS_D) {
-					SEXP_t *stmp;
-
-					stmp = SEXP_string_newf("%s", fts_ent->fts_name);
-					oval_result_t result = probe_entobj_cmp(ofts->ofts_sfilename, stmp);
-					switch (result){
-						case OVAL_RESULT_TRUE:
-							out_fts_ent = fts_ent;
-							break;
+	while ((ent = oval_fts_walk_read(ofts->ofts_recurse_path_walk)) != NULL) {
+		if (ent->info == FTS_DC) {
+			dW("Filesystem tree cycle detected at '%s'.", ent->path);
+			continue;
+		}
+		if ((ent->matched && ent->info != FTS_D)
+		    || oval_fts_recurse_match(ofts, collect_dirs, ent->level, ent->info, ent->name)) {
+			/* the probes get the lstat() of the entries below the root */
+			const struct stat *statp = (ent->level > 0 && !ent->followed
+						    && ent->info != FTS_NS) ? &ent->st : NULL;
+
+			return OVAL_FTSENT_new(ofts, ent->info, ent->path, ent->path_len,
+					       ent->name, ent->name_len, statp);
+		}
+	}
 
-						case OVAL_RESULT_ERROR:
-							probe_cobj_set_flag(ofts->result, SYSCHAR_FLAG_ERROR);
-							break;
+	oval_fts_walk_close(ofts->ofts_recurse_path_walk);
+	ofts->ofts_recurse_path_walk = NULL;
+	oval_fts_snapshot_put(ofts->ofts_recurse_path_snapshot);
+	ofts->ofts_recurse_path_snapshot = NULL;
 
-						default:
-							break;
-					}
+	return (NULL);
+}
 
-					SEXP_free(stmp);
-				}
-			}
+/* find the first matching file or directory */
+static OVAL_FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
+{
+	FTSENT *out_fts_ent = NULL;
+	/* the condition below is correct because ofts_sfilepath is NULL here */
+	bool collect_dirs = (ofts->ofts_sfilename == NULL);
 
-			if (fts_ent->fts_level > 0) { /* don't skip fts root */
-				/* limit recursion depth */
-				if (ofts->direction == OVAL_RECURSE_DIRECTION_NONE
-				    || (ofts->max_depth != -1 && fts_ent->fts_level > ofts->max_depth)) {
-					fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
-					continue;
-				}
+	switch (ofts->direction) {
 
-				/* limit recursion only to selected file types */
-				switch (fts_ent->fts_info) {
-				case FTS_D:
-					if (!(ofts->recurse & OVAL_RECURSE_DIRS)) {
-						fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
-						continue;
-					}
-					break;
-				case FTS_SL:
-					if (!(ofts->recurse & OVAL_RECURSE_SYMLINKS)) {
-						fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
-						continue;
-					}
-					fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_FOLLOW);
-					break;
-				default:
-					continue;
-				}
-			}
-			if (_oval_fts_is_local(ofts, fts_ent)) {
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
-				continue;
-			}
-			/* don't recurse beyond the initial filesystem */
-			if (ofts->filesystem == OVAL_RECURSE_FS_DEFINED
-			    && (fts_ent->fts_info == FTS_D || fts_ent->fts_info == FTS_SL)
-			    && ofts->ofts_recurse_path_devid != fts_ent->fts_statp->st_dev) {
-				fts_set(ofts->ofts_recurse_path_fts, fts_ent, FTS_SKIP);
-				continue;
-			}
+	case OVAL_RECURSE_DIRECTION_DOWN:
+	case OVAL_RECURSE_DIRECTION_NONE:
+		if (ofts->direction == OVAL_RECURSE_DIRECTION_NONE
+		    && collect_dirs) {
+			/* the target is the directory itself */
+			out_fts_ent = ofts->ofts_match_path_fts_ent;
+			ofts->ofts_match_path_fts_ent = NULL;
+			break;
 		}
 
-		break;
+		return oval_fts_walk_recurse_path(ofts, collect_dirs);
 	case OVAL_RECURSE_DIRECTION_UP:
 		if (ofts->ofts_recurse_path_pthcpy == NULL) {
 			ofts->ofts_recurse_path_pthcpy = \
@@ -1279,12 +1058,12 @@ static FTSENT *oval_fts_read_recurse_path(OVAL_FTS *ofts)
 		break;
 	}
 
-	return out_fts_ent;
+	return out_fts_ent != NULL ? OVAL_FTSENT_from_fts(ofts, out_fts_ent) : NULL;
 }
 
 OVAL_FTSENT *oval_fts_read(OVAL_FTS *ofts)
 {
-	FTSENT *fts_ent;
+	OVAL_FTSENT *ofts_ent;
 
 #if defined(OSCAP_FTS_DEBUG)
 	dI("ofts: %p.", ofts);
@@ -1301,12 +1080,12 @@ OVAL_FTSENT *oval_fts_read(OVAL_FTS *ofts)
 		}
 
 		if (ofts->ofts_sfilepath) {
-			fts_ent = ofts->ofts_match_path_fts_ent;
+			ofts_ent = OVAL_FTSENT_from_fts(ofts, ofts->ofts_match_path_fts_ent);
 			ofts->ofts_match_path_fts_ent = NULL;
 			break;
 		} else {
-			fts_ent = oval_fts_read_recurse_path(ofts);
-			if (fts_ent != NULL)
+			ofts_ent = oval_fts_read_recurse_path(ofts);
+			if (ofts_ent != NULL)
 				break;
 
 			ofts->ofts_match_path_fts_ent = NULL;
@@ -1318,7 +1097,7 @@ OVAL_FTSENT *oval_fts_read(OVAL_FTS *ofts)
 		}
 	}
 
-	return OVAL_FTSENT_new(ofts, fts_ent);
+	return ofts_ent;
 }
 
 void oval_ftsent_free(OVAL_FTSENT *ofts_ent)
@@ -1331,11 +1110,6 @@ int oval_fts_close(OVAL_FTS *ofts)
 	if (ofts->ofts_recurse_path_pthcpy != NULL)
 		oscap_free(ofts->ofts_recurse_path_pthcpy);
 
-	if (ofts->ofts_path_regex)
-		pcre_free(ofts->ofts_path_regex);
-	if (ofts->ofts_path_regex_extra)
-		pcre_free(ofts->ofts_path_regex_extra);
-
 	if (ofts->ofts_spath != NULL)
 		SEXP_free(ofts->ofts_spath);
 	if (ofts->ofts_sfilename != NULL)
@@ -1343,7 +1117,7 @@ int oval_fts_close(OVAL_FTS *ofts)
 	if (ofts->ofts_sfilepath != NULL)
 		SEXP_free(ofts->ofts_sfilepath);
 
-	fsdev_free(ofts->localdevs);
+	oval_fts_mounts_put(ofts->localdevs);
 
 	OVAL_FTS_free(ofts);
 #if defined(__SVR4) && defined(__sun)
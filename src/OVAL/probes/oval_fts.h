@@ -28,8 +28,10 @@
 #else
 #include <fts.h>
 #endif
-#include <pcre.h>
-#include "fsdev.h"
+#include "oval_fts_walk.h"
+#include "oval_fts_pattern.h"
+#include "oval_fts_mounts.h"
+#include "oval_fts_snapshot.h"
 
 #define ENT_GET_AREF(ent, dst, attr_name, mandatory)			\
 	do {								\
@@ -75,9 +77,13 @@ typedef struct {
 	char *ofts_recurse_path_pthcpy;
 	char *ofts_recurse_path_curpth;
 	dev_t ofts_recurse_path_devid;
+	/* downward recursion, see oval_fts_walk.h */
+	OVAL_FTS_WALK *ofts_recurse_path_walk;
+	OVAL_FTS_SNAPSHOT *ofts_recurse_path_snapshot;
+	unsigned int ofts_recurse_path_walk_jobs;
+	bool ofts_recurse_path_walk_ordered;
 
-	pcre       *ofts_path_regex;
-	pcre_extra *ofts_path_regex_extra;
+	OVAL_FTS_PATTERN *ofts_path_pattern;
 	uint32_t ofts_path_op;
 
 	SEXP_t *ofts_spath;
@@ -90,9 +96,15 @@ typedef struct {
 	int recurse;
 	int filesystem;
 
-	fsdev_t *localdevs;
+	OVAL_FTS_MOUNTS *localdevs;
 } OVAL_FTS;
 
+/* Number of threads walking a directory tree downwards, 0 means one per CPU,
+   the directories are listed by the reading thread if it isn't set */
+#define OVAL_FTS_JOBS_ENV "OSCAP_PROBE_FTS_JOBS"
+/* Report the entries in the order the threads list them */
+#define OVAL_FTS_UNORDERED_ENV "OSCAP_PROBE_FTS_UNORDERED"
+
 #define OVAL_RECURSE_DIRECTION_NONE 0 /* default */
 #define OVAL_RECURSE_DIRECTION_DOWN 1
 #define OVAL_RECURSE_DIRECTION_UP   2
@@ -114,6 +126,9 @@ typedef struct {
 	char *path;
 	size_t path_len;
 	unsigned int fts_info;
+	/* lstat() of the entry if the walk got it, NULL otherwise */
+	struct stat *fts_statp;
+	struct stat fts_stat;
 } OVAL_FTSENT;
 
 /*
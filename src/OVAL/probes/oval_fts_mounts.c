@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include "alloc.h"
+#include "debug_priv.h"
+#include "fsdev.h"
+#include "oval_fts_mounts.h"
+
+#define MOUNTS_INFO "/proc/self/mountinfo"
+
+struct oval_fts_mounts {
+	int refs; /* the current table and the walks, protected by mounts_lock */
+	size_t mask;
+	dev_t *devs;
+	bool *used;
+};
+
+static pthread_mutex_t mounts_lock = PTHREAD_MUTEX_INITIALIZER;
+static OVAL_FTS_MOUNTS *mounts_current = NULL;
+static int mounts_fd = -1;
+static bool mounts_polled = false;
+
+static size_t mounts_hash(dev_t dev)
+{
+	return (size_t)(((uint64_t)dev * 0x9e3779b97f4a7c15ULL) >> 32);
+}
+
+static OVAL_FTS_MOUNTS *mounts_new(void)
+{
+	OVAL_FTS_MOUNTS *mounts;
+	fsdev_t *lfs;
+	size_t i, size = 16;
+
+	lfs = fsdev_init(NULL, 0);
+	if (lfs == NULL)
+		return NULL;
+
+	/* keep the table at most half full */
+	while (size < 2 * (size_t)lfs->cnt)
+		size *= 2;
+
+	mounts = oscap_talloc(OVAL_FTS_MOUNTS);
+	mounts->refs = 1;
+	mounts->mask = size - 1;
+	mounts->devs = oscap_alloc(size * sizeof(dev_t));
+	mounts->used = oscap_alloc(size * sizeof(bool));
+	memset(mounts->used, 0, size * sizeof(bool));
+
+	for (i = 0; i < lfs->cnt; ++i) {
+		size_t h = mounts_hash(lfs->ids[i]) & mounts->mask;
+
+		while (mounts->used[h] && mounts->devs[h] != lfs->ids[i])
+			h = (h + 1) & mounts->mask;
+		mounts->devs[h] = lfs->ids[i];
+		mounts->used[h] = true;
+	}
+
+	dI("Found %u local filesystems.", (unsigned int)lfs->cnt);
+	fsdev_free(lfs);
+
+	return mounts;
+}
+
+static void mounts_unref(OVAL_FTS_MOUNTS *mounts)
+{
+	if (--mounts->refs > 0)
+		return;
+
+	oscap_free(mounts->devs);
+	oscap_free(mounts->used);
+	oscap_free(mounts);
+}
+
+/* has the mount table changed since it was read the last time */
+static bool mounts_changed(void)
+{
+	struct pollfd pfd;
+
+	if (!mounts_polled) {
+		mounts_polled = true;
+		/* the changes are reported since the file has been opened */
+		mounts_fd = open(MOUNTS_INFO, O_RDONLY | O_CLOEXEC);
+		if (mounts_fd < 0)
+			dI("Can't open '" MOUNTS_INFO "', the mount table will be read by every walk.");
+		return true;
+	}
+	if (mounts_fd < 0)
+		return true;
+
+	/* a poll resets the change */
+	pfd.fd = mounts_fd;
+	pfd.events = POLLPRI;
+	pfd.revents = 0;
+	if (poll(&pfd, 1, 0) == 0)
+		return false;
+
+	return true;
+}
+
+OVAL_FTS_MOUNTS *oval_fts_mounts_get(void)
+{
+	OVAL_FTS_MOUNTS *mounts;
+
+	pthread_mutex_lock(&mounts_lock);
+	if (mounts_changed() || mounts_current == NULL) {
+		mounts = mounts_new();
+		if (mounts == NULL) {
+			/* the change has been reset, read it again next time */
+			if (mounts_current != NULL) {
+				mounts_unref(mounts_current);
+				mounts_current = NULL;
+			}
+			pthread_mutex_unlock(&mounts_lock);
+			return NULL;
+		}
+		if (mounts_current != NULL) {
+			dI("The mount table has changed, using new local filesystems.");
+			mounts_unref(mounts_current);
+		}
+		mounts_current = mounts;
+	}
+	mounts = mounts_current;
+	mounts->refs++;
+	pthread_mutex_unlock(&mounts_lock);
+
+	return mounts;
+}
+
+void oval_fts_mounts_put(OVAL_FTS_MOUNTS *mounts)
+{
+	if (mounts == NULL)
+		return;
+
+	pthread_mutex_lock(&mounts_lock);
+	mounts_unref(mounts);
+	pthread_mutex_unlock(&mounts_lock);
+}
+
+bool oval_fts_mounts_local(const OVAL_FTS_MOUNTS *mounts, dev_t dev)
+{
+	size_t h = mounts_hash(dev) & mounts->mask;
+
+	while (mounts->used[h]) {
+		if (mounts->devs[h] == dev)
+			return true;
+		h = (h + 1) & mounts->mask;
+	}
+
+	return false;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef OVAL_FTS_MOUNTS_H
+#define OVAL_FTS_MOUNTS_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*
+ * The devices of the local filesystems, shared by all the walks of a probe.
+ *
+ * The table is read from the mount table (see fsdev_init()) once and kept
+ * until the mount table changes, which is found out by polling
+ * /proc/self/mountinfo for POLLPRI. Where it can't be polled the table is
+ * read again by every oval_fts_mounts_get().
+ *
+ * A table never changes, a walk holds a reference to the table it got for
+ * its whole life and may look devices up in it from any thread.
+ */
+
+typedef struct oval_fts_mounts OVAL_FTS_MOUNTS;
+
+/* Returns a reference to the current table, NULL on error */
+OVAL_FTS_MOUNTS *oval_fts_mounts_get(void);
+void oval_fts_mounts_put(OVAL_FTS_MOUNTS *mounts);
+
+/* The device belongs to a local filesystem */
+bool oval_fts_mounts_local(const OVAL_FTS_MOUNTS *mounts, dev_t dev);
+
+#endif /* OVAL_FTS_MOUNTS_H */
@@ -0,0 +1,1424 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <limits.h>
+
+#include "alloc.h"
+#include "debug_priv.h"
+#include "oval_fts_pattern.h"
+
+/*
+ * The pattern is parsed to a tree, the tree is compiled to a Thompson NFA
+ * and the NFA is turned to a DFA on the fly, one transition at a time.
+ *
+ * The patterns are matched in UTF-8 mode, so everything which matches a
+ * single character is compiled to a set of ASCII bytes, optionally followed
+ * by an alternative which matches any multibyte UTF-8 sequence. Constructs
+ * which don't fit the automaton are loosened: assertions match the empty
+ * string, back references and recursion match any string, both branches of
+ * a conditional subpattern are allowed, caseless letters match any
+ * multibyte character as well.
+ */
+
+/* A repetition with larger bounds matches any string */
+#define PAT_REPEAT_MAX 64
+/* Larger patterns are not compiled */
+#define PAT_NFA_MAX    16384
+/* The DFA stops pruning when it gets larger */
+#define PAT_DFA_MAX    2048
+#define PAT_DFA_BYTES  (8 * 1024 * 1024)
+
+/* Options of the pattern */
+#define PAT_CASELESS  0x1
+#define PAT_EXTENDED  0x2
+#define PAT_MULTILINE 0x4
+
+/* The DFA states which read anything */
+#define PAT_DFA_TOP   1
+#define PAT_DFA_START 2
+
+typedef struct {
+	uint32_t w[8];
+} pat_set_t;
+
+static inline void set_add(pat_set_t *set, int c)
+{
+	set->w[c >> 5] |= 1u << (c & 31);
+}
+
+static inline bool set_has(const pat_set_t *set, int c)
+{
+	return (set->w[c >> 5] & (1u << (c & 31))) != 0;
+}
+
+static void set_range(pat_set_t *set, int lo, int hi)
+{
+	for (; lo <= hi; lo++)
+		set_add(set, lo);
+}
+
+/* Complement within ASCII */
+static void set_invert(pat_set_t *set)
+{
+	int i;
+
+	for (i = 0; i < 4; i++)
+		set->w[i] = ~set->w[i];
+	for (i = 4; i < 8; i++)
+		set->w[i] = 0;
+}
+
+enum pat_type {
+	PAT_EMPTY,
+	PAT_SET,    /* a byte of the set */
+	PAT_CAT,
+	PAT_ALT,
+	PAT_REPEAT,
+	PAT_ANY,    /* any string */
+	PAT_BOL,    /* ^ at the start of the subject */
+	PAT_EOL,    /* $ */
+	PAT_ACCEPT  /* (*ACCEPT) */
+};
+
+struct pat_node {
+	enum pat_type type;
+	pat_set_t set;
+	struct pat_node **subs;
+	size_t count;
+	int min, max; /* max is -1 if unbounded */
+	struct pat_node *next_node; /* all the nodes of a parser */
+};
+
+struct pat_parser {
+	const unsigned char *s;
+	int flags;          /* PAT_* options */
+	bool quoted;        /* within \Q...\E */
+	bool loose;         /* a (*VERB) has been seen, the classes may be
+			       Unicode and $ may precede other newlines */
+	bool error;
+	struct pat_node *nodes;
+};
+
+static struct pat_node *pat_parse_alt(struct pat_parser *p);
+static struct pat_node *pat_parse_group(struct pat_parser *p);
+
+static struct pat_node *pat_node(struct pat_parser *p, enum pat_type type)
+{
+	struct pat_node *n;
+
+	n = oscap_calloc(1, sizeof(struct pat_node));
+	n->type = type;
+	n->next_node = p->nodes;
+	p->nodes = n;
+
+	return n;
+}
+
+static void pat_push(struct pat_node *n, struct pat_node *sub)
+{
+	n->subs = oscap_realloc(n->subs, (n->count + 1) * sizeof(struct pat_node *));
+	n->subs[n->count++] = sub;
+}
+
+static struct pat_node *pat_repeat(struct pat_parser *p, struct pat_node *sub, int min, int max)
+{
+	struct pat_node *n;
+
+	if (min > PAT_REPEAT_MAX || max > PAT_REPEAT_MAX)
+		return pat_node(p, PAT_ANY);
+	if (max == 0)
+		return pat_node(p, PAT_EMPTY);
+	n = pat_node(p, PAT_REPEAT);
+	pat_push(n, sub);
+	n->min = min;
+	n->max = max;
+
+	return n;
+}
+
+/* A character of the ASCII set or, if multibyte, any non-ASCII character */
+static struct pat_node *pat_char(struct pat_parser *p, const pat_set_t *ascii, bool multibyte)
+{
+	struct pat_node *set, *lead, *cont, *seq, *alt;
+
+	set = pat_node(p, PAT_SET);
+	set->set = *ascii;
+	if (!multibyte)
+		return set;
+
+	lead = pat_node(p, PAT_SET);
+	set_range(&lead->set, 0xc0, 0xf7);
+	cont = pat_node(p, PAT_SET);
+	set_range(&cont->set, 0x80, 0xbf);
+	seq = pat_node(p, PAT_CAT);
+	pat_push(seq, lead);
+	pat_push(seq, pat_repeat(p, cont, 1, 3));
+
+	alt = pat_node(p, PAT_ALT);
+	pat_push(alt, set);
+	pat_push(alt, seq);
+
+	return alt;
+}
+
+static struct pat_node *pat_any_char(struct pat_parser *p)
+{
+	pat_set_t set;
+
+	memset(&set, 0, sizeof set);
+	set_range(&set, 0, 0x7f);
+
+	return pat_char(p, &set, true);
+}
+
+/* A character given by its code point */
+static struct pat_node *pat_literal(struct pat_parser *p, long c)
+{
+	pat_set_t set;
+
+	memset(&set, 0, sizeof set);
+	if (c < 0 || c > 0x7f)
+		return pat_char(p, &set, true);
+	set_add(&set, c);
+	if ((p->flags & PAT_CASELESS) && isalpha(c)) {
+		/* 'k' and 's' have multibyte other cases */
+		set_add(&set, tolower(c));
+		set_add(&set, toupper(c));
+		return pat_char(p, &set, true);
+	}
+
+	return pat_char(p, &set, false);
+}
+
+/* A literal character of the pattern, a multibyte one is matched bytewise */
+static struct pat_node *pat_parse_literal(struct pat_parser *p)
+{
+	struct pat_node *seq;
+	size_t i, len = 1;
+
+	if (*p->s < 0x80)
+		return pat_literal(p, *p->s++);
+	if (*p->s >= 0xc0)
+		while (len < 4 && (p->s[len] & 0xc0) == 0x80)
+			len++;
+	if (p->flags & PAT_CASELESS) {
+		p->s += len;
+		return pat_literal(p, -1);
+	}
+	seq = pat_node(p, PAT_CAT);
+	for (i = 0; i < len; i++) {
+		pat_push(seq, pat_node(p, PAT_SET));
+		set_add(&seq->subs[i]->set, *p->s++);
+	}
+
+	return seq;
+}
+
+static bool pat_skip_past(struct pat_parser *p, int c)
+{
+	while (*p->s != '\0' && *p->s != c)
+		p->s++;
+	if (*p->s == '\0') {
+		p->error = true;
+		return false;
+	}
+	p->s++;
+
+	return true;
+}
+
+static void pat_skip_extended(struct pat_parser *p)
+{
+	if (!(p->flags & PAT_EXTENDED) || p->quoted)
+		return;
+	for (;;) {
+		if (isspace(*p->s))
+			p->s++;
+		else if (*p->s == '#')
+			while (*p->s != '\0' && *p->s != '\n')
+				p->s++;
+		else
+			break;
+	}
+}
+
+static int pat_hex(int c)
+{
+	return isdigit(c) ? c - '0' : tolower(c) - 'a' + 10;
+}
+
+/* The code point of an escaped character, p->s follows the backslash */
+static long pat_parse_escape_char(struct pat_parser *p)
+{
+	long v = 0;
+	int c, n;
+
+	c = *p->s++;
+	switch (c) {
+	case 'a':
+		return 0x07;
+	case 'b': /* in a class */
+		return 0x08;
+	case 'e':
+		return 0x1b;
+	case 'f':
+		return 0x0c;
+	case 'n':
+		return 0x0a;
+	case 'r':
+		return 0x0d;
+	case 't':
+		return 0x09;
+	case 'c':
+		if (*p->s == '\0')
+			return 0;
+		return toupper(*p->s++) ^ 0x40;
+	case 'x':
+		if (*p->s == '{') {
+			for (p->s++; isxdigit(*p->s); p->s++)
+				if (v <= 0x10ffff)
+					v = v * 16 + pat_hex(*p->s);
+			if (*p->s == '}')
+				p->s++;
+			return v;
+		}
+		for (n = 0; n < 2 && isxdigit(*p->s); n++)
+			v = v * 16 + pat_hex(*p->s++);
+		return v;
+	case 'o':
+		if (*p->s == '{') {
+			for (p->s++; *p->s >= '0' && *p->s <= '7'; p->s++)
+				if (v <= 0x10ffff)
+					v = v * 8 + *p->s - '0';
+			if (*p->s == '}')
+				p->s++;
+		}
+		return v;
+	case '0': case '1': case '2': case '3':
+	case '4': case '5': case '6': case '7':
+		v = c - '0';
+		for (n = 0; n < 2 && *p->s >= '0' && *p->s <= '7'; n++)
+			v = v * 8 + *p->s++ - '0';
+		return v;
+	case '\0':
+		p->s--;
+		p->error = true;
+		return 0;
+	default:
+		return c;
+	}
+}
+
+/* Adds a class escape (\d, \w, ...) to the set, p->s follows the backslash */
+static bool pat_parse_class_escape(struct pat_parser *p, pat_set_t *set, bool *multibyte)
+{
+	pat_set_t s;
+	bool mb = p->loose;
+	int c = *p->s;
+
+	memset(&s, 0, sizeof s);
+	switch (tolower(c)) {
+	case 'd':
+		set_range(&s, '0', '9');
+		break;
+	case 'w':
+		set_range(&s, '0', '9');
+		set_range(&s, 'a', 'z');
+		set_range(&s, 'A', 'Z');
+		set_add(&s, '_');
+		break;
+	case 's':
+		set_range(&s, '\t', '\r');
+		set_add(&s, ' ');
+		break;
+	case 'h':
+		set_add(&s, '\t');
+		set_add(&s, ' ');
+		mb = true;
+		break;
+	case 'v':
+		set_range(&s, '\n', '\r');
+		mb = true;
+		break;
+	case 'n':
+		if (c != 'N')
+			return false;
+		set_add(&s, '\n');
+		break;
+	case 'p':
+		p->s++;
+		if (*p->s == '{')
+			pat_skip_past(p, '}');
+		else if (*p->s != '\0')
+			p->s++;
+		set_range(set, 0, 0x7f);
+		*multibyte = true;
+		return true;
+	default:
+		return false;
+	}
+	p->s++;
+	if (isupper(c)) {
+		set_invert(&s);
+		mb = true;
+	}
+	for (c = 0; c < 8; c++)
+		set->w[c] |= s.w[c];
+	*multibyte = *multibyte || mb;
+
+	return true;
+}
+
+static void pat_posix_class(struct pat_parser *p, const char *name, size_t len, pat_set_t *set, bool *multibyte)
+{
+	static const struct {
+		const char *name;
+		int (*is)(int);
+	} classes[] = {
+		{ "alnum", isalnum }, { "alpha", isalpha }, { "blank", isblank },
+		{ "cntrl", iscntrl }, { "digit", isdigit }, { "graph", isgraph },
+		{ "lower", islower }, { "print", isprint }, { "punct", ispunct },
+		{ "space", isspace }, { "upper", isupper }, { "xdigit", isxdigit }
+	};
+	bool negate = false, known = false;
+	pat_set_t s;
+	size_t i;
+	int c;
+
+	memset(&s, 0, sizeof s);
+	if (len > 0 && name[0] == '^') {
+		negate = true;
+		name++;
+		len--;
+	}
+	for (i = 0; i < sizeof classes / sizeof classes[0]; i++) {
+		if (strlen(classes[i].name) == len && strncmp(classes[i].name, name, len) == 0) {
+			for (c = 0; c < 0x80; c++)
+				if (classes[i].is(c))
+					set_add(&s, c);
+			known = true;
+		}
+	}
+	if (len == 4 && strncmp(name, "word", 4) == 0) {
+		for (c = 0; c < 0x80; c++)
+			if (isalnum(c) || c == '_')
+				set_add(&s, c);
+		known = true;
+	}
+	if (!known || (len == 5 && strncmp(name, "ascii", 5) == 0))
+		set_range(&s, 0, 0x7f);
+	if (negate || !known || p->loose) {
+		if (negate)
+			set_invert(&s);
+		*multibyte = true;
+	}
+	for (c = 0; c < 8; c++)
+		set->w[c] |= s.w[c];
+}
+
+/* A literal character of a class, a multibyte one is returned as 0x80 */
+static long pat_parse_class_char(struct pat_parser *p)
+{
+	if (*p->s < 0x80)
+		return *p->s++;
+	if (*p->s++ >= 0xc0)
+		while ((*p->s & 0xc0) == 0x80)
+			p->s++;
+
+	return 0x80;
+}
+
+static void pat_class_range(pat_set_t *set, bool *multibyte, long lo, long hi)
+{
+	if (hi > 0x7f) {
+		*multibyte = true;
+		hi = 0x7f;
+	}
+	if (lo <= hi)
+		set_range(set, lo, hi);
+}
+
+static bool pat_posix_at(const unsigned char *s)
+{
+	if (s[0] != '[' || s[1] != ':')
+		return false;
+	for (s += 2; *s == '^' || islower(*s); s++);
+
+	return s[0] == ':' && s[1] == ']';
+}
+
+static bool pat_class_escape_at(const unsigned char *s)
+{
+	return s[0] == '\\' && s[1] != '\0' && strchr("dDwWsShHvVpPN", s[1]) != NULL;
+}
+
+/* [...], p->s follows the bracket */
+static struct pat_node *pat_parse_class(struct pat_parser *p)
+{
+	pat_set_t set;
+	bool negate = false, multibyte = false, first = true;
+	long lo, hi;
+	int c;
+
+	memset(&set, 0, sizeof set);
+	if (*p->s == '^') {
+		negate = true;
+		p->s++;
+	}
+	for (;; first = false) {
+		if (*p->s == '\0') {
+			p->error = true;
+			return NULL;
+		}
+		if (*p->s == ']' && !first) {
+			p->s++;
+			break;
+		}
+		if (pat_posix_at(p->s)) {
+			const char *name = (const char *) p->s + 2;
+
+			p->s = (const unsigned char *) strchr(name, ':');
+			pat_posix_class(p, name, (const char *) p->s - name, &set, &multibyte);
+			p->s += 2;
+			continue;
+		}
+		if (*p->s == '\\') {
+			p->s++;
+			if (*p->s == 'Q') {
+				for (p->s++; *p->s != '\0' && !(p->s[0] == '\\' && p->s[1] == 'E');) {
+					lo = pat_parse_class_char(p);
+					pat_class_range(&set, &multibyte, lo, lo);
+				}
+				if (*p->s != '\0')
+					p->s += 2;
+				continue;
+			}
+			if (*p->s == 'E') {
+				p->s++;
+				continue;
+			}
+			if (pat_parse_class_escape(p, &set, &multibyte))
+				continue;
+			lo = pat_parse_escape_char(p);
+			if (p->error)
+				return NULL;
+		} else {
+			lo = pat_parse_class_char(p);
+		}
+		hi = lo;
+		if (p->s[0] == '-' && p->s[1] != ']' && p->s[1] != '\0'
+		    && !pat_class_escape_at(p->s + 1) && !pat_posix_at(p->s + 1)) {
+			p->s++;
+			if (*p->s == '\\') {
+				p->s++;
+				hi = pat_parse_escape_char(p);
+			} else {
+				hi = pat_parse_class_char(p);
+			}
+		}
+		pat_class_range(&set, &multibyte, lo, hi);
+	}
+	if (p->flags & PAT_CASELESS) {
+		for (c = 'a'; c <= 'z'; c++) {
+			if (set_has(&set, c) || set_has(&set, toupper(c))) {
+				set_add(&set, c);
+				set_add(&set, toupper(c));
+			}
+		}
+		multibyte = true;
+	}
+	if (negate) {
+		set_invert(&set);
+		multibyte = true;
+	}
+
+	return pat_char(p, &set, multibyte);
+}
+
+/* \g and \k references, p->s follows the letter */
+static void pat_skip_reference(struct pat_parser *p)
+{
+	switch (*p->s) {
+	case '{':
+		pat_skip_past(p, '}');
+		break;
+	case '<':
+		pat_skip_past(p, '>');
+		break;
+	case '\'':
+		p->s++;
+		pat_skip_past(p, '\'');
+		break;
+	default:
+		if (*p->s == '+' || *p->s == '-')
+			p->s++;
+		while (isdigit(*p->s))
+			p->s++;
+	}
+}
+
+/* p->s follows the backslash */
+static struct pat_node *pat_parse_escape(struct pat_parser *p)
+{
+	pat_set_t set;
+	bool multibyte = false;
+	int c = *p->s;
+
+	memset(&set, 0, sizeof set);
+	if (pat_parse_class_escape(p, &set, &multibyte))
+		return pat_char(p, &set, multibyte);
+
+	switch (c) {
+	case 'b': case 'B': case 'A': case 'G': case 'K':
+		p->s++;
+		return pat_node(p, PAT_EMPTY);
+	case 'z': case 'Z':
+		p->s++;
+		return pat_node(p, PAT_EOL);
+	case 'Q':
+		p->s++;
+		p->quoted = true;
+		return NULL;
+	case 'E':
+		p->s++;
+		return NULL;
+	case 'C':
+		p->s++;
+		set_range(&set, 0, 0xff);
+		return pat_char(p, &set, false);
+	case 'R':
+		p->s++;
+		return pat_repeat(p, pat_any_char(p), 1, 2);
+	case 'X':
+		p->s++;
+		return pat_repeat(p, pat_any_char(p), 1, -1);
+	case 'g': case 'k':
+		p->s++;
+		pat_skip_reference(p);
+		return pat_node(p, PAT_ANY);
+	}
+	if (c >= '1' && c <= '9') {
+		/* a back reference, or an octal character */
+		while (isdigit(*p->s))
+			p->s++;
+		return pat_node(p, PAT_ANY);
+	}
+
+	return pat_literal(p, pat_parse_escape_char(p));
+}
+
+static bool pat_parse_bounds(const unsigned char **sp, int *min, int *max)
+{
+	const unsigned char *s = *sp + 1;
+	long lo = 0, hi;
+
+	if (!isdigit(*s))
+		return false;
+	for (; isdigit(*s); s++)
+		if (lo <= INT_MAX / 16)
+			lo = lo * 10 + *s - '0';
+	hi = lo;
+	if (*s == ',') {
+		s++;
+		if (isdigit(*s)) {
+			for (hi = 0; isdigit(*s); s++)
+				if (hi <= INT_MAX / 16)
+					hi = hi * 10 + *s - '0';
+		} else {
+			hi = -1;
+		}
+	}
+	if (*s != '}')
+		return false;
+	*sp = s + 1;
+	*min = lo;
+	*max = hi;
+
+	return true;
+}
+
+static struct pat_node *pat_parse_quantifier(struct pat_parser *p, struct pat_node *atom)
+{
+	const unsigned char *s;
+	int min, max;
+
+	for (;;) {
+		s = p->s;
+		if (p->quoted) {
+			if (s[0] != '\\' || s[1] != 'E')
+				return atom;
+			p->s += 2;
+			p->quoted = false;
+			pat_skip_extended(p);
+			continue;
+		}
+		switch (*s) {
+		case '*':
+			min = 0;
+			max = -1;
+			s++;
+			break;
+		case '+':
+			min = 1;
+			max = -1;
+			s++;
+			break;
+		case '?':
+			min = 0;
+			max = 1;
+			s++;
+			break;
+		case '{':
+			if (pat_parse_bounds(&s, &min, &max))
+				break;
+			/* fall through */
+		default:
+			return atom;
+		}
+		/* lazy and possessive quantifiers match the same strings */
+		if (*s == '?' || *s == '+')
+			s++;
+		p->s = s;
+		atom = pat_repeat(p, atom, min, max);
+		pat_skip_extended(p);
+	}
+}
+
+static struct pat_node *pat_parse_atom(struct pat_parser *p)
+{
+	struct pat_node *n;
+
+	if (p->quoted) {
+		if (p->s[0] == '\\' && p->s[1] == 'E') {
+			p->s += 2;
+			p->quoted = false;
+			return NULL;
+		}
+		return pat_parse_literal(p);
+	}
+	switch (*p->s) {
+	case '(':
+		p->s++;
+		return pat_parse_group(p);
+	case '[':
+		p->s++;
+		return pat_parse_class(p);
+	case '.':
+		p->s++;
+		return pat_any_char(p);
+	case '^':
+		p->s++;
+		/* in multiline mode ^ matches after a newline too */
+		return pat_node(p, (p->flags & PAT_MULTILINE) ? PAT_EMPTY : PAT_BOL);
+	case '$':
+		p->s++;
+		return pat_node(p, (p->flags & PAT_MULTILINE) ? PAT_EMPTY : PAT_EOL);
+	case '\\':
+		p->s++;
+		n = pat_parse_escape(p);
+		return p->error ? NULL : n;
+	default:
+		return pat_parse_literal(p);
+	}
+}
+
+static struct pat_node *pat_parse_seq(struct pat_parser *p)
+{
+	struct pat_node *seq, *atom;
+
+	seq = pat_node(p, PAT_CAT);
+	for (;;) {
+		pat_skip_extended(p);
+		if (*p->s == '\0' || (!p->quoted && (*p->s == '|' || *p->s == ')')))
+			break;
+		atom = pat_parse_atom(p);
+		if (p->error)
+			return NULL;
+		if (atom == NULL)
+			continue;
+		pat_skip_extended(p);
+		pat_push(seq, pat_parse_quantifier(p, atom));
+	}
+
+	return seq;
+}
+
+static struct pat_node *pat_parse_alt(struct pat_parser *p)
+{
+	struct pat_node *alt, *seq;
+
+	alt = pat_node(p, PAT_ALT);
+	for (;;) {
+		seq = pat_parse_seq(p);
+		if (seq == NULL)
+			return NULL;
+		pat_push(alt, seq);
+		if (*p->s != '|')
+			break;
+		p->s++;
+	}
+
+	return alt;
+}
+
+/* The alternatives of a group up to the closing parenthesis, the options
+   set within the group don't apply after it */
+static struct pat_node *pat_parse_subpattern(struct pat_parser *p)
+{
+	struct pat_node *n;
+	int flags = p->flags;
+
+	n = pat_parse_alt(p);
+	p->flags = flags;
+	if (n == NULL || *p->s != ')') {
+		p->error = true;
+		return NULL;
+	}
+	p->s++;
+
+	return n;
+}
+
+/* Option settings, (?i) applies to the rest of the enclosing group */
+static struct pat_node *pat_parse_options(struct pat_parser *p)
+{
+	struct pat_node *n;
+	int flags = p->flags, opt;
+	bool on = true;
+
+	for (; *p->s != '\0' && *p->s != ')' && *p->s != ':'; p->s++) {
+		switch (*p->s) {
+		case '-':
+			on = false;
+			continue;
+		case 'i':
+			opt = PAT_CASELESS;
+			break;
+		case 'x':
+			opt = PAT_EXTENDED;
+			break;
+		case 'm':
+			opt = PAT_MULTILINE;
+			break;
+		default:
+			continue;
+		}
+		flags = on ? flags | opt : flags & ~opt;
+	}
+	if (*p->s == ')') {
+		p->s++;
+		p->flags = flags;
+		return NULL;
+	}
+	if (*p->s == '\0') {
+		p->error = true;
+		return NULL;
+	}
+	p->s++;
+	opt = p->flags;
+	p->flags = flags;
+	n = pat_parse_subpattern(p);
+	p->flags = opt;
+
+	return n;
+}
+
+/* p->s follows the parenthesis */
+static struct pat_node *pat_parse_group(struct pat_parser *p)
+{
+	struct pat_node *n, *alt;
+	const unsigned char *s = p->s;
+
+	if (*s == '*') {
+		/* (*VERB) */
+		p->s++;
+		if (!pat_skip_past(p, ')'))
+			return NULL;
+		if (p->s - s == 8 && strncmp((const char *) s, "*ACCEPT)", 8) == 0)
+			return pat_node(p, PAT_ACCEPT);
+		p->loose = true;
+		return NULL;
+	}
+	if (*s != '?')
+		return pat_parse_subpattern(p);
+
+	p->s = ++s;
+	switch (*s) {
+	case '#': /* comment */
+	case 'C': /* callout */
+		pat_skip_past(p, ')');
+		return NULL;
+	case ':':
+	case '|':
+	case '>':
+		p->s++;
+		return pat_parse_subpattern(p);
+	case '=':
+	case '!':
+		p->s++;
+		if (pat_parse_subpattern(p) == NULL)
+			return NULL;
+		return pat_node(p, PAT_EMPTY);
+	case '<':
+		if (s[1] == '=' || s[1] == '!') {
+			p->s += 2;
+			if (pat_parse_subpattern(p) == NULL)
+				return NULL;
+			return pat_node(p, PAT_EMPTY);
+		}
+		if (!pat_skip_past(p, '>'))
+			return NULL;
+		return pat_parse_subpattern(p);
+	case '\'':
+		p->s++;
+		if (!pat_skip_past(p, '\''))
+			return NULL;
+		return pat_parse_subpattern(p);
+	case 'P':
+		if (s[1] == '<') {
+			if (!pat_skip_past(p, '>'))
+				return NULL;
+			return pat_parse_subpattern(p);
+		}
+		/* (?P=name) and (?P>name) */
+		if (!pat_skip_past(p, ')'))
+			return NULL;
+		return pat_node(p, PAT_ANY);
+	case '&':
+	case 'R':
+		if (!pat_skip_past(p, ')'))
+			return NULL;
+		return pat_node(p, PAT_ANY);
+	case '(':
+		/* (?(condition)yes|no) */
+		if (s[1] == '?') {
+			p->s++;
+			pat_parse_group(p);
+		} else {
+			pat_skip_past(p, ')');
+		}
+		if (p->error)
+			return NULL;
+		n = pat_parse_subpattern(p);
+		if (n == NULL)
+			return NULL;
+		alt = pat_node(p, PAT_ALT);
+		pat_push(alt, n);
+		pat_push(alt, pat_node(p, PAT_EMPTY));
+		return alt;
+	}
+	if (isdigit(*s) || ((*s == '+' || *s == '-') && isdigit(s[1]))) {
+		/* recursion */
+		if (!pat_skip_past(p, ')'))
+			return NULL;
+		return pat_node(p, PAT_ANY);
+	}
+
+	return pat_parse_options(p);
+}
+
+/* Can the subpattern only match at the start of the subject */
+static bool pat_anchored(const struct pat_node *n)
+{
+	size_t i;
+
+	switch (n->type) {
+	case PAT_BOL:
+		return true;
+	case PAT_CAT:
+		for (i = 0; i < n->count && n->subs[i]->type == PAT_EMPTY; i++);
+		return i < n->count && pat_anchored(n->subs[i]);
+	case PAT_ALT:
+		for (i = 0; i < n->count; i++)
+			if (!pat_anchored(n->subs[i]))
+				return false;
+		return n->count > 0;
+	case PAT_REPEAT:
+		return n->min > 0 && pat_anchored(n->subs[0]);
+	default:
+		return false;
+	}
+}
+
+enum pat_state_type {
+	PAT_STATE_SET,   /* reads a byte of the set */
+	PAT_STATE_SPLIT, /* continues by any of the outs */
+	PAT_STATE_MATCH
+};
+
+struct pat_state {
+	enum pat_state_type type;
+	pat_set_t set;
+	int out;
+	int *outs;
+	size_t outs_count;
+};
+
+struct oval_fts_pattern {
+	struct pat_state *nfa;
+	size_t nfa_count;
+	size_t nfa_size;
+	int nfa_start;
+	int nfa_match;
+	int nfa_accept;  /* any string, then the match */
+	int nfa_eol;     /* $ */
+
+	/* the bytes of a class lead to the same states */
+	unsigned char classes[256];
+	int class_count;
+
+	/* DFA states, as sets of NFA states */
+	size_t words;
+	uint64_t *sets;
+	bool *match;
+	int *trans;      /* by class, -1 if not computed yet */
+	size_t dfa_count;
+	size_t dfa_size;
+	size_t dfa_max;
+	int *hash;
+	size_t hash_size;
+
+	uint64_t *scratch;
+	uint64_t *visited;
+	int *stack;
+};
+
+static int pat_state_new(OVAL_FTS_PATTERN *pat, enum pat_state_type type)
+{
+	struct pat_state *st;
+
+	if (pat->nfa_count == PAT_NFA_MAX)
+		return -1;
+	if (pat->nfa_count == pat->nfa_size) {
+		pat->nfa_size = pat->nfa_size == 0 ? 64 : pat->nfa_size * 2;
+		pat->nfa = oscap_realloc(pat->nfa, pat->nfa_size * sizeof(struct pat_state));
+	}
+	st = &pat->nfa[pat->nfa_count];
+	memset(st, 0, sizeof *st);
+	st->type = type;
+	st->out = -1;
+
+	return pat->nfa_count++;
+}
+
+static int pat_state_set(OVAL_FTS_PATTERN *pat, const pat_set_t *set, int out)
+{
+	int s;
+
+	if (out < 0 || (s = pat_state_new(pat, PAT_STATE_SET)) < 0)
+		return -1;
+	pat->nfa[s].set = *set;
+	pat->nfa[s].out = out;
+
+	return s;
+}
+
+static int pat_state_out(OVAL_FTS_PATTERN *pat, int s, int out)
+{
+	struct pat_state *st;
+
+	if (s < 0 || out < 0)
+		return -1;
+	st = &pat->nfa[s];
+	st->outs = oscap_realloc(st->outs, (st->outs_count + 1) * sizeof(int));
+	st->outs[st->outs_count++] = out;
+
+	return s;
+}
+
+/* Any string, then next */
+static int pat_state_any(OVAL_FTS_PATTERN *pat, int next)
+{
+	pat_set_t set;
+	int loop;
+
+	memset(&set, 0xff, sizeof set);
+	loop = pat_state_new(pat, PAT_STATE_SPLIT);
+	if (pat_state_out(pat, loop, pat_state_set(pat, &set, loop)) < 0)
+		return -1;
+
+	return pat_state_out(pat, loop, next);
+}
+
+/* Compiles the node in front of the next state, returns the first state
+   of the node or -1 if the automaton gets too large */
+static int pat_compile(OVAL_FTS_PATTERN *pat, const struct pat_node *n, int next)
+{
+	int s, tail;
+	size_t i;
+
+	if (next < 0)
+		return -1;
+	switch (n->type) {
+	case PAT_EMPTY:
+	case PAT_BOL:
+		return next;
+	case PAT_SET:
+		return pat_state_set(pat, &n->set, next);
+	case PAT_CAT:
+		for (i = n->count; i > 0 && next >= 0; i--)
+			next = pat_compile(pat, n->subs[i - 1], next);
+		return next;
+	case PAT_ALT:
+		s = pat_state_new(pat, PAT_STATE_SPLIT);
+		for (i = 0; i < n->count && s >= 0; i++)
+			s = pat_state_out(pat, s, pat_compile(pat, n->subs[i], next));
+		return s;
+	case PAT_REPEAT:
+		tail = next;
+		if (n->max == -1) {
+			s = pat_state_new(pat, PAT_STATE_SPLIT);
+			s = pat_state_out(pat, s, pat_compile(pat, n->subs[0], s));
+			next = pat_state_out(pat, s, tail);
+		} else {
+			for (i = n->min; i < (size_t) n->max && next >= 0; i++) {
+				s = pat_state_new(pat, PAT_STATE_SPLIT);
+				s = pat_state_out(pat, s, pat_compile(pat, n->subs[0], next));
+				next = pat_state_out(pat, s, tail);
+			}
+		}
+		for (i = 0; i < (size_t) n->min && next >= 0; i++)
+			next = pat_compile(pat, n->subs[0], next);
+		return next;
+	case PAT_ANY:
+		return pat_state_any(pat, next);
+	case PAT_EOL:
+		return pat->nfa_eol;
+	case PAT_ACCEPT:
+		return pat->nfa_accept;
+	}
+
+	return -1;
+}
+
+/* $ matches at the end or before a newline at the end, a loose one before
+   any of the newline sequences */
+static int pat_compile_eol(OVAL_FTS_PATTERN *pat, bool loose)
+{
+	pat_set_t set;
+	int s, eol = pat->nfa_match, i;
+
+	memset(&set, 0, sizeof set);
+	if (loose)
+		memset(&set, 0xff, sizeof set);
+	else
+		set_add(&set, '\n');
+	for (i = 0; i < (loose ? 3 : 1); i++) {
+		s = pat_state_new(pat, PAT_STATE_SPLIT);
+		pat_state_out(pat, s, pat->nfa_match);
+		eol = pat_state_out(pat, s, pat_state_set(pat, &set, eol));
+	}
+
+	return eol;
+}
+
+static void pat_compile_classes(OVAL_FTS_PATTERN *pat)
+{
+	int remap[2][256], count, b, k;
+	size_t i;
+
+	memset(pat->classes, 0, sizeof pat->classes);
+	pat->class_count = 1;
+	for (i = 0; i < pat->nfa_count; i++) {
+		if (pat->nfa[i].type != PAT_STATE_SET)
+			continue;
+		memset(remap, -1, sizeof remap);
+		count = 0;
+		for (b = 0; b < 256; b++) {
+			k = set_has(&pat->nfa[i].set, b);
+			if (remap[k][pat->classes[b]] < 0)
+				remap[k][pat->classes[b]] = count++;
+			pat->classes[b] = remap[k][pat->classes[b]];
+		}
+		pat->class_count = count;
+	}
+}
+
+/* Adds the states reachable from s by the splits to the set */
+static void pat_closure(OVAL_FTS_PATTERN *pat, int s, uint64_t *set)
+{
+	struct pat_state *st;
+	size_t depth = 0, i;
+
+#define VISIT(s) (pat->visited[(s) / 64] & (UINT64_C(1) << ((s) % 64)))
+	if (VISIT(s))
+		return;
+	pat->visited[s / 64] |= UINT64_C(1) << (s % 64);
+	pat->stack[depth++] = s;
+	while (depth > 0) {
+		st = &pat->nfa[pat->stack[--depth]];
+		if (st->type != PAT_STATE_SPLIT) {
+			s = st - pat->nfa;
+			set[s / 64] |= UINT64_C(1) << (s % 64);
+			continue;
+		}
+		for (i = 0; i < st->outs_count; i++) {
+			s = st->outs[i];
+			if (!VISIT(s)) {
+				pat->visited[s / 64] |= UINT64_C(1) << (s % 64);
+				pat->stack[depth++] = s;
+			}
+		}
+	}
+#undef VISIT
+}
+
+static size_t pat_hash(const OVAL_FTS_PATTERN *pat, const uint64_t *set)
+{
+	uint64_t h = UINT64_C(14695981039346656037);
+	size_t i;
+
+	for (i = 0; i < pat->words; i++)
+		h = (h ^ set[i]) * UINT64_C(1099511628211);
+
+	return (h ^ (h >> 29)) & (pat->hash_size - 1);
+}
+
+/* The DFA state of the set of NFA states, PAT_DFA_TOP if there are too many */
+static int pat_dfa_state(OVAL_FTS_PATTERN *pat, const uint64_t *set)
+{
+	size_t h, i;
+	int s;
+
+	for (i = 0; i < pat->words && set[i] == 0; i++);
+	if (i == pat->words)
+		return OVAL_FTS_PATTERN_DEAD;
+
+	for (h = pat_hash(pat, set); (s = pat->hash[h]) != -1; h = (h + 1) & (pat->hash_size - 1))
+		if (memcmp(pat->sets + s * pat->words, set, pat->words * sizeof(uint64_t)) == 0)
+			return s;
+	if (pat->dfa_count == pat->dfa_max) {
+		dI("The automaton of the path pattern is too large, pruning stopped.");
+		return PAT_DFA_TOP;
+	}
+
+	if (pat->dfa_count == pat->dfa_size) {
+		pat->dfa_size *= 2;
+		pat->sets = oscap_realloc(pat->sets, pat->dfa_size * pat->words * sizeof(uint64_t));
+		pat->match = oscap_realloc(pat->match, pat->dfa_size * sizeof(bool));
+		pat->trans = oscap_realloc(pat->trans, pat->dfa_size * pat->class_count * sizeof(int));
+	}
+	s = pat->dfa_count++;
+	memcpy(pat->sets + s * pat->words, set, pat->words * sizeof(uint64_t));
+	pat->match[s] = (set[pat->nfa_match / 64] & (UINT64_C(1) << (pat->nfa_match % 64))) != 0;
+	for (i = 0; i < (size_t) pat->class_count; i++)
+		pat->trans[s * pat->class_count + i] = -1;
+	pat->hash[h] = s;
+
+	return s;
+}
+
+static int pat_transition(OVAL_FTS_PATTERN *pat, int state, unsigned char b)
+{
+	const uint64_t *set = pat->sets + state * pat->words;
+	struct pat_state *st;
+	int s;
+
+	memset(pat->scratch, 0, pat->words * sizeof(uint64_t));
+	memset(pat->visited, 0, pat->words * sizeof(uint64_t));
+	for (s = 0; s < (int) pat->nfa_count; s++) {
+		if ((set[s / 64] & (UINT64_C(1) << (s % 64))) == 0)
+			continue;
+		st = &pat->nfa[s];
+		if (st->type == PAT_STATE_SET && set_has(&st->set, b))
+			pat_closure(pat, st->out, pat->scratch);
+	}
+
+	return pat_dfa_state(pat, pat->scratch);
+}
+
+static int pat_step_byte(OVAL_FTS_PATTERN *pat, int state, unsigned char b)
+{
+	size_t t = state * pat->class_count + pat->classes[b];
+	int next;
+
+	if (pat->trans[t] < 0) {
+		/* the table may be reallocated by the new state */
+		next = pat_transition(pat, state, b);
+		pat->trans[t] = next;
+	}
+
+	return pat->trans[t];
+}
+
+static bool pat_dfa_init(OVAL_FTS_PATTERN *pat)
+{
+	size_t i;
+
+	pat_compile_classes(pat);
+	pat->words = (pat->nfa_count + 63) / 64;
+	pat->dfa_max = PAT_DFA_BYTES / (pat->words * sizeof(uint64_t) + pat->class_count * sizeof(int));
+	if (pat->dfa_max > PAT_DFA_MAX)
+		pat->dfa_max = PAT_DFA_MAX;
+	if (pat->dfa_max <= PAT_DFA_START)
+		return false;
+	for (pat->hash_size = 1; pat->hash_size < 2 * pat->dfa_max; pat->hash_size *= 2);
+	pat->hash = oscap_alloc(pat->hash_size * sizeof(int));
+	memset(pat->hash, -1, pat->hash_size * sizeof(int));
+
+	pat->dfa_size = 16;
+	pat->sets = oscap_calloc(pat->dfa_size * pat->words, sizeof(uint64_t));
+	pat->match = oscap_alloc(pat->dfa_size * sizeof(bool));
+	pat->trans = oscap_alloc(pat->dfa_size * pat->class_count * sizeof(int));
+	pat->scratch = oscap_alloc(pat->words * sizeof(uint64_t));
+	pat->visited = oscap_alloc(pat->words * sizeof(uint64_t));
+	pat->stack = oscap_alloc(pat->nfa_count * sizeof(int));
+
+	/* the dead state reads nothing, the top state anything */
+	for (i = 0; i < (size_t) pat->class_count; i++) {
+		pat->trans[OVAL_FTS_PATTERN_DEAD * pat->class_count + i] = OVAL_FTS_PATTERN_DEAD;
+		pat->trans[PAT_DFA_TOP * pat->class_count + i] = PAT_DFA_TOP;
+	}
+	pat->match[OVAL_FTS_PATTERN_DEAD] = false;
+	pat->match[PAT_DFA_TOP] = true;
+	pat->dfa_count = PAT_DFA_START;
+
+	memset(pat->scratch, 0, pat->words * sizeof(uint64_t));
+	memset(pat->visited, 0, pat->words * sizeof(uint64_t));
+	pat_closure(pat, pat->nfa_start, pat->scratch);
+
+	return pat_dfa_state(pat, pat->scratch) == PAT_DFA_START;
+}
+
+OVAL_FTS_PATTERN *oval_fts_pattern_new(const char *pattern)
+{
+	OVAL_FTS_PATTERN *pat;
+	struct pat_parser p;
+	struct pat_node *root, *n;
+
+	memset(&p, 0, sizeof p);
+	p.s = (const unsigned char *) pattern;
+	root = pat_parse_alt(&p);
+	if (root != NULL && *p.s != '\0')
+		p.error = true;
+
+	pat = oscap_calloc(1, sizeof(OVAL_FTS_PATTERN));
+	if (!p.error) {
+		pat->nfa_match = pat_state_new(pat, PAT_STATE_MATCH);
+		pat->nfa_accept = pat_state_any(pat, pat->nfa_match);
+		pat->nfa_eol = pat_compile_eol(pat, p.loose);
+		pat->nfa_start = pat_compile(pat, root, pat->nfa_accept);
+		if (!pat_anchored(root))
+			pat->nfa_start = pat_state_any(pat, pat->nfa_start);
+	}
+
+	while ((n = p.nodes) != NULL) {
+		p.nodes = n->next_node;
+		oscap_free(n->subs);
+		oscap_free(n);
+	}
+
+	if (p.error) {
+		dW("Can't parse the pattern '%s' at offset %td.", pattern, (const char *) p.s - pattern);
+		oval_fts_pattern_free(pat);
+		return NULL;
+	}
+	if (pat->nfa_start < 0 || !pat_dfa_init(pat)) {
+		dI("The pattern '%s' is too large to be compiled.", pattern);
+		oval_fts_pattern_free(pat);
+		return NULL;
+	}
+
+	return pat;
+}
+
+void oval_fts_pattern_free(OVAL_FTS_PATTERN *pat)
+{
+	size_t i;
+
+	if (pat == NULL)
+		return;
+	for (i = 0; i < pat->nfa_count; i++)
+		oscap_free(pat->nfa[i].outs);
+	oscap_free(pat->nfa);
+	oscap_free(pat->sets);
+	oscap_free(pat->match);
+	oscap_free(pat->trans);
+	oscap_free(pat->hash);
+	oscap_free(pat->scratch);
+	oscap_free(pat->visited);
+	oscap_free(pat->stack);
+	oscap_free(pat);
+}
+
+char *oval_fts_pattern_prefix(OVAL_FTS_PATTERN *pat)
+{
+	char path[PATH_MAX];
+	size_t len = 0, slash = 0;
+	int state = PAT_DFA_START, b, only;
+
+	/* follow the bytes every matching path has to begin with */
+	while (len < sizeof path - 1 && state != PAT_DFA_TOP && !pat->match[state]) {
+		only = -1;
+		for (b = 1; b < 256; b++) {
+			if (pat_step_byte(pat, state, b) == OVAL_FTS_PATTERN_DEAD)
+				continue;
+			if (only != -1) {
+				only = -1;
+				break;
+			}
+			only = b;
+		}
+		if (only == -1)
+			break;
+		if (only == '/')
+			slash = len;
+		path[len++] = only;
+		state = pat_step_byte(pat, state, only);
+	}
+
+	if (len == 0 || path[0] != '/' || slash == 0)
+		return strdup("/");
+	path[slash] = '\0';
+
+	return strdup(path);
+}
+
+int oval_fts_pattern_start(OVAL_FTS_PATTERN *pat)
+{
+	return PAT_DFA_START;
+}
+
+int oval_fts_pattern_step(OVAL_FTS_PATTERN *pat, int state, const char *str, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len && state != OVAL_FTS_PATTERN_DEAD && state != PAT_DFA_TOP; i++)
+		state = pat_step_byte(pat, state, str[i]);
+
+	return state;
+}
+
+bool oval_fts_pattern_match(OVAL_FTS_PATTERN *pat, int state)
+{
+	return pat->match[state];
+}
+
+bool oval_fts_pattern_descend(OVAL_FTS_PATTERN *pat, int state)
+{
+	return pat_step_byte(pat, state, '/') != OVAL_FTS_PATTERN_DEAD;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef OVAL_FTS_PATTERN_H
+#define OVAL_FTS_PATTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Path patterns compiled for pruning a directory walk.
+ *
+ * A pattern (a PCRE regular expression, as matched against the paths in
+ * UTF-8 mode) is compiled to an automaton which reads a path byte by byte.
+ * Its state tells whether the path read so far can match the pattern and
+ * whether a path below it can, so that a directory none of whose
+ * descendants can match doesn't have to be read at all.
+ *
+ * The automaton accepts a superset of the paths matched by the pattern:
+ * the constructs which don't fit a finite automaton (back references,
+ * lookarounds, recursion, ...) are replaced by looser ones. A path which
+ * isn't accepted never matches the pattern, an accepted one still has to
+ * be matched by the pattern itself.
+ *
+ * The states are small numbers. The state of an entry is computed from the
+ * state of its directory by reading the rest of its path, the states are
+ * built lazily as the tree is walked. A pattern is not thread safe.
+ */
+
+typedef struct oval_fts_pattern OVAL_FTS_PATTERN;
+
+/* No path which begins with what has been read can match */
+#define OVAL_FTS_PATTERN_DEAD 0
+
+/* Returns NULL if the pattern is too large to be compiled */
+OVAL_FTS_PATTERN *oval_fts_pattern_new(const char *pattern);
+void oval_fts_pattern_free(OVAL_FTS_PATTERN *pat);
+
+/* The deepest directory which contains all the matching paths, "/" if
+   there is none. To be freed by the caller. */
+char *oval_fts_pattern_prefix(OVAL_FTS_PATTERN *pat);
+
+/* The state before the first byte of a path */
+int oval_fts_pattern_start(OVAL_FTS_PATTERN *pat);
+int oval_fts_pattern_step(OVAL_FTS_PATTERN *pat, int state, const char *str, size_t len);
+/* The path read so far can match */
+bool oval_fts_pattern_match(OVAL_FTS_PATTERN *pat, int state);
+/* A path below the directory read so far can match */
+bool oval_fts_pattern_descend(OVAL_FTS_PATTERN *pat, int state);
+
+#endif /* OVAL_FTS_PATTERN_H */
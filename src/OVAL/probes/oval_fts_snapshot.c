@@ -0,0 +1,1028 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#if defined(HAVE_SYS_XATTR_H)
+#include <sys/xattr.h>
+#endif
+#if defined(__SVR4) && defined(__sun)
+#include "fts_sun.h"
+#else
+#include <fts.h>
+#endif
+
+#include "alloc.h"
+#include "debug_priv.h"
+#include "oscap.h"
+#include "oval_fts_walk.h"
+#include "oval_fts_snapshot.h"
+
+#define SNAPSHOT_MAGIC   "OSCAPFS"
+#define SNAPSHOT_VERSION 1
+
+#define SNAPSHOT_NONE UINT32_MAX
+
+#define SNAPSHOT_ENT_NS       0x01 /* lstat() failed */
+#define SNAPSHOT_ENT_LISTED   0x02 /* a directory whose entries are stored */
+#define SNAPSHOT_ENT_XATTRS   0x04 /* the extended attributes are stored */
+#define SNAPSHOT_ENT_DANGLING 0x08 /* a symlink which points nowhere */
+
+/*
+ * The file: the header, the entries (a directory is followed by its own
+ * entries after all the entries of its parent), the stat() of the targets
+ * of the symlinks, the hash table of the paths (indices of the entries + 1)
+ * and the strings (the paths and the extended attributes). The root is the
+ * first entry.
+ */
+struct snapshot_hdr {
+	char     magic[8];
+	uint32_t version;
+	uint32_t stat_size;   /* sizeof(struct stat) */
+	int64_t  taken;       /* the start of the walk */
+	uint32_t count;       /* entries */
+	uint32_t targets;
+	uint32_t buckets;     /* a power of two */
+	uint32_t reserved;
+	uint64_t strings_len;
+	char     oscap_version[32];
+};
+
+struct snapshot_ent {
+	struct stat st;
+	uint64_t path;        /* offset in the strings */
+	uint64_t xattrs;      /* offset of the names and of the values */
+	uint32_t path_len;
+	uint32_t name;        /* offset of the name in the path */
+	uint32_t flags;
+	uint32_t target;      /* index of the stat() of a symlink */
+	uint32_t first;       /* the entries of a listed directory */
+	uint32_t count;
+	uint32_t xattrs_list; /* length of the names */
+	uint32_t xattrs_len;  /* length of the names and of the values */
+};
+
+struct oval_fts_snapshot {
+	int refs; /* the probe and the walks, protected by snapshots_lock */
+	struct oval_fts_snapshot *next;
+
+	char *data;
+	size_t size;
+	const struct snapshot_hdr *hdr;
+	const struct snapshot_ent *ents;
+	const struct stat *targets;
+	const uint32_t *buckets;
+	const char *strings;
+	bool verify;
+};
+
+/* the valid snapshots mapped by the probe */
+static pthread_mutex_t snapshots_lock = PTHREAD_MUTEX_INITIALIZER;
+static OVAL_FTS_SNAPSHOT *snapshots = NULL;
+static int64_t snapshots_start = 0;
+/* the start of the scan set by the library */
+static int64_t snapshots_since = 0;
+
+int64_t oval_fts_snapshot_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void oval_fts_snapshot_since(int64_t since)
+{
+	int64_t prev;
+
+	do {
+		prev = snapshots_since;
+		if (since <= prev)
+			return;
+	} while (!__sync_bool_compare_and_swap(&snapshots_since, prev, since));
+}
+
+/* the snapshots taken before are stale */
+static int64_t snapshot_since(void)
+{
+	if (snapshots_since != 0)
+		return snapshots_since;
+
+	/* the first walk of the probe */
+	__sync_bool_compare_and_swap(&snapshots_start, 0, oval_fts_snapshot_now());
+
+	return snapshots_start;
+}
+
+static uint64_t snapshot_hash(const char *path, size_t len)
+{
+	uint64_t h = 14695981039346656037ULL;
+
+	while (len-- > 0) {
+		h ^= (unsigned char)*path++;
+		h *= 1099511628211ULL;
+	}
+
+	return h;
+}
+
+/* the paths below a root like "/" don't repeat its trailing slash */
+static size_t snapshot_trim(const char *path, size_t len)
+{
+	while (len > 1 && path[len - 1] == '/')
+		len--;
+
+	return len;
+}
+
+/* the length of the path of the parent directory, 0 if there's none */
+static size_t snapshot_parent(const char *path, size_t len)
+{
+	while (len > 0 && path[len - 1] != '/')
+		len--;
+	if (len == 0)
+		return 0;
+
+	return snapshot_trim(path, len);
+}
+
+static const char *snapshot_path(const OVAL_FTS_SNAPSHOT *snap, const struct snapshot_ent *ent)
+{
+	return snap->strings + ent->path;
+}
+
+static uint32_t snapshot_lookup(const OVAL_FTS_SNAPSHOT *snap, const char *path, size_t len)
+{
+	uint32_t mask = snap->hdr->buckets - 1;
+	uint32_t h = snapshot_hash(path, len) & mask;
+
+	while (snap->buckets[h] != 0) {
+		const struct snapshot_ent *ent = &snap->ents[snap->buckets[h] - 1];
+
+		if (ent->path_len == len && memcmp(snapshot_path(snap, ent), path, len) == 0)
+			return snap->buckets[h] - 1;
+		h = (h + 1) & mask;
+	}
+
+	return SNAPSHOT_NONE;
+}
+
+static bool snapshot_holds(const OVAL_FTS_SNAPSHOT *snap, const char *path, size_t len)
+{
+	uint32_t idx = snapshot_lookup(snap, path, len);
+
+	return idx != SNAPSHOT_NONE && (snap->ents[idx].flags & SNAPSHOT_ENT_LISTED);
+}
+
+/* the entry was modified since the snapshot was taken */
+static bool snapshot_changed(const struct stat *old, const struct stat *cur)
+{
+	return old->st_dev != cur->st_dev || old->st_ino != cur->st_ino
+		|| old->st_mtim.tv_sec != cur->st_mtim.tv_sec || old->st_mtim.tv_nsec != cur->st_mtim.tv_nsec
+		|| old->st_ctim.tv_sec != cur->st_ctim.tv_sec || old->st_ctim.tv_nsec != cur->st_ctim.tv_nsec;
+}
+
+static void snapshot_file(const char *dir, const char *path, size_t len, char *file, size_t size)
+{
+	snprintf(file, size, "%s/%016" PRIx64 ".snap", dir, snapshot_hash(path, len));
+}
+
+static void snapshot_unmap(OVAL_FTS_SNAPSHOT *snap)
+{
+	munmap(snap->data, snap->size);
+	oscap_free(snap);
+}
+
+/* the names of the extended attributes and their values fit the strings */
+static bool snapshot_check_xattrs(const OVAL_FTS_SNAPSHOT *snap, const struct snapshot_ent *ent)
+{
+	const char *list = snap->strings + ent->xattrs, *nul;
+	uint64_t off;
+	size_t i;
+
+	if (ent->xattrs > snap->hdr->strings_len || ent->xattrs_len > snap->hdr->strings_len - ent->xattrs ||
+	    ent->xattrs_list > ent->xattrs_len || (ent->xattrs_list > 0 && list[ent->xattrs_list - 1] != '\0'))
+		return false;
+
+	off = ent->xattrs_list;
+	for (i = 0; i < ent->xattrs_list; i = nul - list + 1) {
+		uint32_t value_len;
+
+		nul = memchr(list + i, '\0', ent->xattrs_list - i);
+		if (off + sizeof(value_len) > ent->xattrs_len)
+			return false;
+		memcpy(&value_len, list + off, sizeof(value_len));
+		off += sizeof(value_len) + (uint64_t)value_len;
+		if (off > ent->xattrs_len)
+			return false;
+	}
+
+	return true;
+}
+
+/* every offset and index of the file stays within the mapping */
+static bool snapshot_check(const OVAL_FTS_SNAPSHOT *snap)
+{
+	const struct snapshot_hdr *hdr = snap->hdr;
+	uint32_t i, used = 0;
+
+	for (i = 0; i < hdr->count; ++i) {
+		const struct snapshot_ent *ent = &snap->ents[i];
+
+		if (ent->path >= hdr->strings_len || ent->path_len >= hdr->strings_len - ent->path ||
+		    snap->strings[ent->path + ent->path_len] != '\0' ||
+		    ent->name > ent->path_len)
+			return false;
+		if ((ent->flags & SNAPSHOT_ENT_XATTRS) && !snapshot_check_xattrs(snap, ent))
+			return false;
+		if (ent->target != SNAPSHOT_NONE && ent->target >= hdr->targets)
+			return false;
+		if (ent->first > hdr->count || ent->count > hdr->count - ent->first)
+			return false;
+	}
+
+	for (i = 0; i < hdr->buckets; ++i) {
+		if (snap->buckets[i] == 0)
+			continue;
+		/* an empty bucket ends every probe sequence */
+		if (snap->buckets[i] > hdr->count || ++used > hdr->count)
+			return false;
+	}
+
+	return (snap->ents[0].flags & SNAPSHOT_ENT_LISTED) != 0;
+}
+
+/* only the user can replace the snapshots in the directory */
+static bool snapshot_dir_trusted(const char *dir, bool create)
+{
+	struct stat st;
+
+	if (create && mkdir(dir, 0700) != 0 && errno != EEXIST) {
+		dW("Can't create the snapshot directory %s: %s.", dir, strerror(errno));
+		return false;
+	}
+	if (lstat(dir, &st) != 0)
+		return false;
+	if (!S_ISDIR(st.st_mode) || st.st_uid != geteuid() || (st.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+		dW("Snapshot directory %s isn't a directory owned by the user and writable only by the user.", dir);
+		return false;
+	}
+
+	return true;
+}
+
+static OVAL_FTS_SNAPSHOT *snapshot_map(const char *file, const char *path, size_t len, int64_t since)
+{
+	OVAL_FTS_SNAPSHOT *snap;
+	const struct snapshot_hdr *hdr;
+	struct stat st;
+	uint64_t size;
+	char *data;
+	int fd;
+
+	if ((fd = open(file, O_RDONLY | O_CLOEXEC | O_NOFOLLOW)) < 0)
+		return NULL;
+
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid() ||
+	    (size_t)st.st_size < sizeof(*hdr)) {
+		close(fd);
+		return NULL;
+	}
+
+	/* the snapshots are replaced by rename(), never truncated */
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return NULL;
+
+	hdr = (const struct snapshot_hdr *)data;
+	size = sizeof(*hdr) + (uint64_t)hdr->count * sizeof(struct snapshot_ent)
+		+ (uint64_t)hdr->targets * sizeof(struct stat)
+		+ (uint64_t)hdr->buckets * sizeof(uint32_t) + hdr->strings_len;
+
+	if (memcmp(hdr->magic, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC) != 0 ||
+	    hdr->version != SNAPSHOT_VERSION ||
+	    hdr->stat_size != sizeof(struct stat) ||
+	    strncmp(hdr->oscap_version, oscap_get_version(), sizeof hdr->oscap_version) != 0 ||
+	    hdr->count == 0 || hdr->buckets < 2 * (uint64_t)hdr->count || (hdr->buckets & (hdr->buckets - 1)) != 0 ||
+	    hdr->strings_len > (uint64_t)st.st_size || size != (uint64_t)st.st_size)
+	{
+		dD("Snapshot %s: invalid header.", file);
+		munmap(data, st.st_size);
+		return NULL;
+	}
+
+	if (hdr->taken < since) {
+		dD("Snapshot %s: taken before the scan.", file);
+		munmap(data, st.st_size);
+		return NULL;
+	}
+
+	snap = oscap_talloc(OVAL_FTS_SNAPSHOT);
+	memset(snap, 0, sizeof(*snap));
+	snap->data = data;
+	snap->size = st.st_size;
+	snap->hdr = hdr;
+	snap->ents = (const struct snapshot_ent *)(data + sizeof(*hdr));
+	snap->targets = (const struct stat *)(snap->ents + hdr->count);
+	snap->buckets = (const uint32_t *)(snap->targets + hdr->targets);
+	snap->strings = (const char *)(snap->buckets + hdr->buckets);
+	snap->verify = getenv(OVAL_FTS_SNAPSHOT_VERIFY_ENV) != NULL;
+
+	if (!snapshot_check(snap)) {
+		dW("Snapshot %s: invalid entries.", file);
+		snapshot_unmap(snap);
+		return NULL;
+	}
+
+	/* another root with the same hash */
+	if (snap->ents[0].path_len != len || memcmp(snapshot_path(snap, &snap->ents[0]), path, len) != 0) {
+		snapshot_unmap(snap);
+		return NULL;
+	}
+
+	return snap;
+}
+
+/*
+ * Taking a snapshot
+ */
+
+struct snapshot_bent {
+	struct stat st;
+	struct stat target;
+	char *path;
+	size_t path_len;
+	size_t name;
+	uint32_t flags;
+	bool has_target;
+	char *xattrs;
+	size_t xattrs_list;
+	size_t xattrs_len;
+	/* the entries of a directory in the order they were read */
+	uint32_t first;
+	uint32_t last;
+	uint32_t next;
+	/* the entry in the file */
+	uint32_t idx;
+	uint64_t path_off;
+	uint64_t xattrs_off;
+};
+
+struct snapshot_builder {
+	dev_t dev; /* of the root, set before the walker threads start */
+	struct snapshot_bent *ents;
+	size_t count;
+	size_t size;
+	/* the listed directories by their path, indices + 1 */
+	uint32_t *dirs;
+	size_t dirs_mask;
+	size_t dirs_count;
+};
+
+static int snapshot_instr(const OVAL_FTS_WALK_ENT *ent, void *arg)
+{
+	struct snapshot_builder *b = arg;
+
+	if (ent->level == 0) {
+		b->dev = ent->st.st_dev;
+		return 0;
+	}
+	if (ent->followed)
+		return FTS_SKIP;
+	if (ent->info == FTS_SL)
+		return FTS_FOLLOW;
+	/* the other filesystems are read live */
+	if (ent->info == FTS_D && ent->st.st_dev != b->dev)
+		return FTS_SKIP;
+
+	return 0;
+}
+
+static uint32_t snapshot_builder_dir(const struct snapshot_builder *b, const char *path, size_t len)
+{
+	size_t h = snapshot_hash(path, len) & b->dirs_mask;
+
+	while (b->dirs[h] != 0) {
+		const struct snapshot_bent *ent = &b->ents[b->dirs[h] - 1];
+
+		if (ent->path_len == len && memcmp(ent->path, path, len) == 0)
+			return b->dirs[h] - 1;
+		h = (h + 1) & b->dirs_mask;
+	}
+
+	return SNAPSHOT_NONE;
+}
+
+static void snapshot_builder_add_dir(struct snapshot_builder *b, uint32_t idx)
+{
+	size_t h;
+
+	/* keep the table at most half full */
+	if (2 * (b->dirs_count + 1) > b->dirs_mask + 1) {
+		uint32_t *old = b->dirs;
+		size_t i, old_size = b->dirs_mask + 1;
+
+		b->dirs_mask = 2 * old_size - 1;
+		b->dirs = oscap_alloc(2 * old_size * sizeof(uint32_t));
+		memset(b->dirs, 0, 2 * old_size * sizeof(uint32_t));
+		for (i = 0; i < old_size; ++i) {
+			if (old[i] == 0)
+				continue;
+			h = snapshot_hash(b->ents[old[i] - 1].path, b->ents[old[i] - 1].path_len) & b->dirs_mask;
+			while (b->dirs[h] != 0)
+				h = (h + 1) & b->dirs_mask;
+			b->dirs[h] = old[i];
+		}
+		oscap_free(old);
+	}
+
+	h = snapshot_hash(b->ents[idx].path, b->ents[idx].path_len) & b->dirs_mask;
+	while (b->dirs[h] != 0)
+		h = (h + 1) & b->dirs_mask;
+	b->dirs[h] = idx + 1;
+	b->dirs_count++;
+}
+
+#if defined(HAVE_SYS_XATTR_H)
+/* the names like llistxattr() returns them followed by the lengths and the values */
+static bool snapshot_read_xattrs(struct snapshot_bent *ent)
+{
+	ssize_t list_len, value_len;
+	size_t i, size;
+	char *buf;
+
+	list_len = llistxattr(ent->path, NULL, 0);
+	if (list_len <= 0)
+		return list_len == 0;
+
+	size = list_len;
+	buf = oscap_alloc(size);
+	if (llistxattr(ent->path, buf, size) != list_len || buf[list_len - 1] != '\0')
+		goto fail;
+
+	for (i = 0; i < (size_t)list_len; i += strlen(buf + i) + 1) {
+		uint32_t len;
+
+		value_len = lgetxattr(ent->path, buf + i, NULL, 0);
+		if (value_len < 0)
+			goto fail;
+		buf = oscap_realloc(buf, size + sizeof(len) + value_len);
+		if (value_len > 0 && lgetxattr(ent->path, buf + i, buf + size + sizeof(len), value_len) != value_len)
+			goto fail;
+		len = value_len;
+		memcpy(buf + size, &len, sizeof(len));
+		size += sizeof(len) + value_len;
+	}
+
+	ent->xattrs = buf;
+	ent->xattrs_list = list_len;
+	ent->xattrs_len = size;
+
+	return true;
+fail:
+	oscap_free(buf);
+	return false;
+}
+#endif
+
+static void snapshot_builder_add(struct snapshot_builder *b, const OVAL_FTS_WALK_ENT *went)
+{
+	struct snapshot_bent *ent;
+	uint32_t idx, parent = SNAPSHOT_NONE;
+
+	if (went->level > 0) {
+		size_t len = snapshot_parent(went->path, went->name - went->path);
+
+		parent = snapshot_builder_dir(b, went->path, len);
+		if (parent == SNAPSHOT_NONE)
+			return;
+	}
+
+	if (b->count == b->size) {
+		b->size = b->size ? b->size * 2 : 1024;
+		b->ents = oscap_realloc(b->ents, b->size * sizeof(struct snapshot_bent));
+	}
+	idx = b->count++;
+	ent = &b->ents[idx];
+	memset(ent, 0, sizeof(*ent));
+	ent->path_len = snapshot_trim(went->path, went->path_len);
+	ent->path = oscap_alloc(ent->path_len + 1);
+	memcpy(ent->path, went->path, ent->path_len);
+	ent->path[ent->path_len] = '\0';
+	ent->name = went->level > 0 ? (size_t)(went->name - went->path) : 0;
+	ent->first = ent->last = ent->next = SNAPSHOT_NONE;
+
+	if (went->info == FTS_NS) {
+		ent->flags |= SNAPSHOT_ENT_NS;
+	} else {
+		ent->st = went->st;
+#if defined(HAVE_SYS_XATTR_H)
+		if (snapshot_read_xattrs(ent))
+			ent->flags |= SNAPSHOT_ENT_XATTRS;
+#endif
+	}
+
+	if (went->info == FTS_D && went->st.st_dev == b->dev) {
+		ent->flags |= SNAPSHOT_ENT_LISTED;
+		snapshot_builder_add_dir(b, idx);
+	}
+
+	if (parent != SNAPSHOT_NONE) {
+		if (b->ents[parent].last == SNAPSHOT_NONE)
+			b->ents[parent].first = idx;
+		else
+			b->ents[b->ents[parent].last].next = idx;
+		b->ents[parent].last = idx;
+	}
+}
+
+static void snapshot_builder_free(struct snapshot_builder *b)
+{
+	size_t i;
+
+	for (i = 0; i < b->count; ++i) {
+		oscap_free(b->ents[i].path);
+		oscap_free(b->ents[i].xattrs);
+	}
+	oscap_free(b->ents);
+	oscap_free(b->dirs);
+}
+
+/* walk the directory and store what it read */
+static int snapshot_walk(struct snapshot_builder *b, const char *path, unsigned int jobs)
+{
+	OVAL_FTS_WALK *walk;
+	const OVAL_FTS_WALK_ENT *ent;
+	struct snapshot_bent *last = NULL;
+
+	walk = oval_fts_walk_open(path, jobs, false, snapshot_instr, NULL, b, NULL);
+	if (walk == NULL)
+		return -1;
+
+	while ((ent = oval_fts_walk_read(walk)) != NULL) {
+		if (ent->info == FTS_DNR) {
+			uint32_t idx = snapshot_builder_dir(b, ent->path, snapshot_trim(ent->path, ent->path_len));
+
+			if (idx != SNAPSHOT_NONE)
+				b->ents[idx].flags &= ~SNAPSHOT_ENT_LISTED;
+			continue;
+		}
+
+		if (ent->followed) {
+			/* the target follows its symlink */
+			if (ent->level == 0 || last == NULL || strcmp(last->path, ent->path) != 0)
+				continue;
+			if (ent->info == FTS_SLNONE) {
+				last->flags |= SNAPSHOT_ENT_DANGLING;
+			} else if (ent->info != FTS_NS) {
+				last->target = ent->st;
+				last->has_target = true;
+			}
+			continue;
+		}
+
+		if (ent->level == 0 && ent->info != FTS_D)
+			break;
+		snapshot_builder_add(b, ent);
+		last = b->count > 0 ? &b->ents[b->count - 1] : NULL;
+	}
+
+	oval_fts_walk_close(walk);
+
+	return b->count > 0 && (b->ents[0].flags & SNAPSHOT_ENT_LISTED) ? 0 : -1;
+}
+
+static int snapshot_write(struct snapshot_builder *b, const char *file, int64_t taken)
+{
+	struct snapshot_hdr hdr;
+	struct snapshot_ent *ents = NULL;
+	struct stat *targets = NULL;
+	uint32_t *order, *buckets = NULL;
+	size_t i, k, n, ntargets = 0, nbuckets = 16;
+	uint64_t strings_len = 0;
+	char tmp[PATH_MAX + 8];
+	FILE *fp = NULL;
+	int fd, ret = -1;
+
+	/* a directory is followed by its entries after those of its parent */
+	order = oscap_alloc(b->count * sizeof(uint32_t));
+	order[0] = 0;
+	b->ents[0].idx = 0;
+	for (k = 0, n = 1; k < n; ++k) {
+		uint32_t c;
+
+		for (c = b->ents[order[k]].first; c != SNAPSHOT_NONE; c = b->ents[c].next) {
+			b->ents[c].idx = n;
+			order[n++] = c;
+		}
+	}
+
+	while (nbuckets < 2 * n)
+		nbuckets *= 2;
+
+	ents = oscap_alloc(n * sizeof(struct snapshot_ent));
+	targets = oscap_alloc(n * sizeof(struct stat));
+	buckets = oscap_alloc(nbuckets * sizeof(uint32_t));
+	memset(ents, 0, n * sizeof(struct snapshot_ent));
+	memset(buckets, 0, nbuckets * sizeof(uint32_t));
+
+	for (k = 0; k < n; ++k) {
+		struct snapshot_bent *bent = &b->ents[order[k]];
+		struct snapshot_ent *ent = &ents[k];
+		uint32_t h;
+
+		ent->st = bent->st;
+		ent->path = strings_len;
+		ent->path_len = bent->path_len;
+		ent->name = bent->name;
+		ent->flags = bent->flags;
+		strings_len += bent->path_len + 1;
+		ent->xattrs = strings_len;
+		ent->xattrs_list = bent->xattrs_list;
+		ent->xattrs_len = bent->xattrs_len;
+		strings_len += bent->xattrs_len;
+
+		ent->target = SNAPSHOT_NONE;
+		if (bent->has_target) {
+			targets[ntargets] = bent->target;
+			ent->target = ntargets++;
+		}
+
+		ent->first = bent->first != SNAPSHOT_NONE ? b->ents[bent->first].idx : n;
+		ent->count = 0;
+		for (i = bent->first; i != SNAPSHOT_NONE; i = b->ents[i].next)
+			ent->count++;
+
+		h = snapshot_hash(bent->path, bent->path_len) & (nbuckets - 1);
+		while (buckets[h] != 0)
+			h = (h + 1) & (nbuckets - 1);
+		buckets[h] = k + 1;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC);
+	snprintf(hdr.oscap_version, sizeof hdr.oscap_version, "%s", oscap_get_version());
+	hdr.version = SNAPSHOT_VERSION;
+	hdr.stat_size = sizeof(struct stat);
+	hdr.taken = taken;
+	hdr.count = n;
+	hdr.targets = ntargets;
+	hdr.buckets = nbuckets;
+	hdr.strings_len = strings_len;
+
+	snprintf(tmp, sizeof tmp, "%s.XXXXXX", file);
+	if ((fd = mkstemp(tmp)) < 0) {
+		dW("Can't create a snapshot: %s.", strerror(errno));
+		goto out;
+	}
+	if ((fp = fdopen(fd, "w")) == NULL) {
+		close(fd);
+		unlink(tmp);
+		goto out;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    fwrite(ents, sizeof(struct snapshot_ent), n, fp) != n ||
+	    fwrite(targets, sizeof(struct stat), ntargets, fp) != ntargets ||
+	    fwrite(buckets, sizeof(uint32_t), nbuckets, fp) != nbuckets)
+		goto write_failed;
+	for (k = 0; k < n; ++k) {
+		struct snapshot_bent *bent = &b->ents[order[k]];
+
+		if (fwrite(bent->path, 1, bent->path_len + 1, fp) != bent->path_len + 1 ||
+		    fwrite(bent->xattrs, 1, bent->xattrs_len, fp) != bent->xattrs_len)
+			goto write_failed;
+	}
+	if (fclose(fp) != 0) {
+		fp = NULL;
+		goto write_failed;
+	}
+	fp = NULL;
+
+	if (rename(tmp, file) != 0) {
+		dW("Can't rename %s to %s: %s.", tmp, file, strerror(errno));
+		unlink(tmp);
+		goto out;
+	}
+
+	dI("Snapshot of '%s' with %zu entries written to %s.", b->ents[0].path, n, file);
+	ret = 0;
+	goto out;
+
+write_failed:
+	dW("Can't write the snapshot %s: %s.", tmp, strerror(errno));
+	if (fp != NULL)
+		fclose(fp);
+	unlink(tmp);
+out:
+	oscap_free(order);
+	oscap_free(ents);
+	oscap_free(targets);
+	oscap_free(buckets);
+
+	return ret;
+}
+
+/* take a snapshot unless another walker took it meanwhile */
+static OVAL_FTS_SNAPSHOT *snapshot_take(const char *dir, const char *path, size_t len, int64_t since, unsigned int jobs)
+{
+	OVAL_FTS_SNAPSHOT *snap;
+	struct snapshot_builder b;
+	char file[PATH_MAX], lock[PATH_MAX + 8], *root;
+	struct stat st;
+	int64_t taken;
+	int fd;
+
+	if (!snapshot_dir_trusted(dir, true))
+		return NULL;
+
+	snapshot_file(dir, path, len, file, sizeof file);
+	snprintf(lock, sizeof lock, "%s.lock", file);
+	if ((fd = open(lock, O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600)) < 0) {
+		dW("Can't open the snapshot lock %s: %s.", lock, strerror(errno));
+		return NULL;
+	}
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid()) {
+		dW("Snapshot lock %s isn't a regular file owned by the user.", lock);
+		close(fd);
+		return NULL;
+	}
+	while (flock(fd, LOCK_EX) != 0) {
+		if (errno != EINTR) {
+			close(fd);
+			return NULL;
+		}
+	}
+
+	snap = snapshot_map(file, path, len, since);
+	if (snap == NULL) {
+		root = oscap_alloc(len + 1);
+		memcpy(root, path, len);
+		root[len] = '\0';
+		memset(&b, 0, sizeof(b));
+		b.dirs_mask = 1023;
+		b.dirs = oscap_alloc((b.dirs_mask + 1) * sizeof(uint32_t));
+		memset(b.dirs, 0, (b.dirs_mask + 1) * sizeof(uint32_t));
+
+		taken = oval_fts_snapshot_now();
+		dI("Taking a snapshot of '%s'.", root);
+		if (snapshot_walk(&b, root, jobs) == 0 && snapshot_write(&b, file, taken) == 0)
+			snap = snapshot_map(file, path, len, since);
+		snapshot_builder_free(&b);
+		oscap_free(root);
+	}
+
+	flock(fd, LOCK_UN);
+	close(fd);
+
+	return snap;
+}
+
+/*
+ * The snapshots of the probe
+ */
+
+static void snapshot_unref(OVAL_FTS_SNAPSHOT *snap)
+{
+	if (--snap->refs == 0)
+		snapshot_unmap(snap);
+}
+
+/* drop the stale snapshots, snapshots_lock is held */
+static void snapshot_purge(int64_t since)
+{
+	OVAL_FTS_SNAPSHOT **p = &snapshots, *snap;
+
+	while ((snap = *p) != NULL) {
+		if (snap->hdr->taken < since) {
+			*p = snap->next;
+			snapshot_unref(snap);
+		} else {
+			p = &snap->next;
+		}
+	}
+}
+
+static OVAL_FTS_SNAPSHOT *snapshot_register(OVAL_FTS_SNAPSHOT *snap)
+{
+	OVAL_FTS_SNAPSHOT *cur;
+	const struct snapshot_ent *root = &snap->ents[0];
+
+	pthread_mutex_lock(&snapshots_lock);
+	/* another thread mapped it meanwhile */
+	for (cur = snapshots; cur != NULL; cur = cur->next) {
+		if (cur->hdr->taken == snap->hdr->taken
+		    && snapshot_lookup(cur, snapshot_path(snap, root), root->path_len) == 0) {
+			cur->refs++;
+			pthread_mutex_unlock(&snapshots_lock);
+			snapshot_unmap(snap);
+			return cur;
+		}
+	}
+	snap->refs = 2;
+	snap->next = snapshots;
+	snapshots = snap;
+	pthread_mutex_unlock(&snapshots_lock);
+
+	return snap;
+}
+
+OVAL_FTS_SNAPSHOT *oval_fts_snapshot_get(const char *path, bool take, unsigned int jobs)
+{
+	OVAL_FTS_SNAPSHOT *snap;
+	const char *dir = getenv(OVAL_FTS_SNAPSHOT_DIR_ENV);
+	char file[PATH_MAX];
+	int64_t since;
+	size_t len, plen;
+
+	if (dir == NULL || *dir == '\0')
+		return NULL;
+
+	since = snapshot_since();
+	len = snapshot_trim(path, strlen(path));
+
+	pthread_mutex_lock(&snapshots_lock);
+	snapshot_purge(since);
+	for (snap = snapshots; snap != NULL; snap = snap->next) {
+		if (snapshot_holds(snap, path, len)) {
+			snap->refs++;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&snapshots_lock);
+	if (snap != NULL)
+		return snap;
+
+	if (!snapshot_dir_trusted(dir, take))
+		return NULL;
+
+	/* the snapshots of the directory and of its ancestors */
+	for (plen = len; plen > 0; plen = snapshot_parent(path, plen)) {
+		snapshot_file(dir, path, plen, file, sizeof file);
+		snap = snapshot_map(file, path, plen, since);
+		if (snap != NULL) {
+			if (snapshot_holds(snap, path, len))
+				return snapshot_register(snap);
+			snapshot_unmap(snap);
+		}
+		if (plen == 1)
+			break;
+	}
+
+	if (!take)
+		return NULL;
+
+	snap = snapshot_take(dir, path, len, since, jobs);
+
+	return snap != NULL ? snapshot_register(snap) : NULL;
+}
+
+void oval_fts_snapshot_put(OVAL_FTS_SNAPSHOT *snap)
+{
+	if (snap == NULL)
+		return;
+
+	pthread_mutex_lock(&snapshots_lock);
+	snapshot_unref(snap);
+	pthread_mutex_unlock(&snapshots_lock);
+}
+
+bool oval_fts_snapshot_list(const OVAL_FTS_SNAPSHOT *snap, const char *path, size_t path_len,
+			    const struct stat *st, OVAL_FTS_SNAPSHOT_DIR *dir)
+{
+	const struct snapshot_ent *ent;
+	struct stat cur;
+	uint32_t idx;
+
+	idx = snapshot_lookup(snap, path, snapshot_trim(path, path_len));
+	if (idx == SNAPSHOT_NONE || !(snap->ents[idx].flags & SNAPSHOT_ENT_LISTED))
+		return false;
+
+	ent = &snap->ents[idx];
+	if (ent->st.st_dev != st->st_dev || ent->st.st_ino != st->st_ino)
+		return false;
+	if (snap->verify && (stat(path, &cur) != 0 || snapshot_changed(&ent->st, &cur))) {
+		dD("Directory '%s' changed since the snapshot was taken.", path);
+		return false;
+	}
+
+	dir->snap = snap;
+	dir->next = ent->first;
+	dir->end = ent->first + ent->count;
+
+	return true;
+}
+
+bool oval_fts_snapshot_next(OVAL_FTS_SNAPSHOT_DIR *dir, OVAL_FTS_SNAPSHOT_ENT *ent)
+{
+	const OVAL_FTS_SNAPSHOT *snap = dir->snap;
+	const struct snapshot_ent *sent;
+
+	if (dir->next >= dir->end)
+		return false;
+
+	sent = &snap->ents[dir->next++];
+	ent->name = snapshot_path(snap, sent) + sent->name;
+	ent->name_len = sent->path_len - sent->name;
+	ent->st = (sent->flags & SNAPSHOT_ENT_NS) ? NULL : &sent->st;
+	ent->target = sent->target != SNAPSHOT_NONE ? &snap->targets[sent->target] : NULL;
+	ent->target_dangling = (sent->flags & SNAPSHOT_ENT_DANGLING) != 0;
+
+	return true;
+}
+
+bool oval_fts_snapshot_xattrs(const char *path, OVAL_FTS_SNAPSHOT_XATTRS *xattrs)
+{
+	OVAL_FTS_SNAPSHOT *snap;
+	const struct snapshot_ent *ent = NULL;
+	struct stat cur;
+	size_t len = snapshot_trim(path, strlen(path));
+	uint32_t idx;
+
+	pthread_mutex_lock(&snapshots_lock);
+	if (snapshots != NULL)
+		snapshot_purge(snapshot_since());
+	for (snap = snapshots; snap != NULL; snap = snap->next) {
+		idx = snapshot_lookup(snap, path, len);
+		if (idx != SNAPSHOT_NONE && (snap->ents[idx].flags & SNAPSHOT_ENT_XATTRS)) {
+			ent = &snap->ents[idx];
+			snap->refs++;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&snapshots_lock);
+
+	if (snap == NULL)
+		return false;
+
+	if (snap->verify && (lstat(path, &cur) != 0 || snapshot_changed(&ent->st, &cur))) {
+		dD("Entry '%s' changed since the snapshot was taken.", path);
+		oval_fts_snapshot_put(snap);
+		return false;
+	}
+
+	xattrs->snap = snap;
+	xattrs->st = &ent->st;
+	xattrs->list = snap->strings + ent->xattrs;
+	xattrs->list_len = ent->xattrs_list;
+	xattrs->values = xattrs->list + ent->xattrs_list;
+
+	return true;
+}
+
+const char *oval_fts_snapshot_xattr(const OVAL_FTS_SNAPSHOT_XATTRS *xattrs, const char *name, size_t *len)
+{
+	const char *value = xattrs->values;
+	size_t i;
+
+	for (i = 0; i < xattrs->list_len; i += strlen(xattrs->list + i) + 1) {
+		uint32_t value_len;
+
+		memcpy(&value_len, value, sizeof(value_len));
+		if (strcmp(xattrs->list + i, name) == 0) {
+			*len = value_len;
+			return value + sizeof(value_len);
+		}
+		value += sizeof(value_len) + value_len;
+	}
+
+	return NULL;
+}
+
+void oval_fts_snapshot_xattrs_free(OVAL_FTS_SNAPSHOT_XATTRS *xattrs)
+{
+	oval_fts_snapshot_put(xattrs->snap);
+	xattrs->snap = NULL;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef OVAL_FTS_SNAPSHOT_H
+#define OVAL_FTS_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/*
+ * Snapshots of directory trees shared by the walks of the file probes.
+ *
+ * A snapshot of a directory holds the lstat() of every entry below it on
+ * the device of the directory, the stat() of the targets of the symlinks
+ * and the extended attributes of the entries (the POSIX ACLs included).
+ * It is a file in the snapshot directory which the probes map, the entries
+ * of a directory are stored together and every entry can be looked up by
+ * its path in a hash table stored in the file.
+ *
+ * A snapshot is taken by the first downward walk of unlimited depth which
+ * doesn't find one for its root or an ancestor of it, the other probes
+ * wait for it by a lock on a file. The directories which aren't in the
+ * snapshot (other filesystems, symlinked directories) are read live.
+ *
+ * A snapshot is valid if it was taken after the scan started: the library
+ * passes the start of the scan to the probes of a session by the
+ * PROBECMD_FTS_SINCE command when it connects to them, the probes call
+ * oval_fts_snapshot_since(). A probe which didn't get it uses only the
+ * snapshots taken after its first walk.
+ * With OVAL_FTS_SNAPSHOT_VERIFY_ENV set, the directories and the entries
+ * whose attributes are looked up are lstat()-ed again and read live if
+ * they changed since the snapshot was taken.
+ */
+
+/*
+ * The snapshot directory, the snapshots are not used if it isn't set or if
+ * it isn't owned by the user or is writable by others
+ */
+#define OVAL_FTS_SNAPSHOT_DIR_ENV    "OSCAP_PROBE_FTS_SNAPSHOT_DIR"
+/* Check the entries of the snapshots against the filesystem */
+#define OVAL_FTS_SNAPSHOT_VERIFY_ENV "OSCAP_PROBE_FTS_SNAPSHOT_VERIFY"
+
+typedef struct oval_fts_snapshot OVAL_FTS_SNAPSHOT;
+
+typedef struct {
+	const char        *name;
+	size_t             name_len;
+	const struct stat *st;     /* lstat(), NULL if it failed */
+	const struct stat *target; /* stat() of a symlink, NULL if it failed */
+	bool               target_dangling; /* the symlink points nowhere */
+} OVAL_FTS_SNAPSHOT_ENT;
+
+typedef struct {
+	const OVAL_FTS_SNAPSHOT *snap;
+	uint32_t next;
+	uint32_t end;
+} OVAL_FTS_SNAPSHOT_DIR;
+
+typedef struct {
+	OVAL_FTS_SNAPSHOT *snap;
+	const struct stat *st;  /* lstat() of the entry */
+	const char *list;       /* the names like llistxattr() returns them */
+	size_t list_len;
+	const char *values;
+} OVAL_FTS_SNAPSHOT_XATTRS;
+
+/* Nanoseconds since the epoch, the time the snapshots are compared with */
+int64_t oval_fts_snapshot_now(void);
+
+/*
+ * Ignore the snapshots taken before the given time in this process. An
+ * earlier time than the one set before is ignored.
+ */
+void oval_fts_snapshot_since(int64_t since);
+
+/*
+ * Returns a reference to a valid snapshot holding the directory, takes
+ * one by a walk of the given number of jobs if there's none and take is
+ * set. NULL if the snapshots aren't used or there's none.
+ */
+OVAL_FTS_SNAPSHOT *oval_fts_snapshot_get(const char *path, bool take, unsigned int jobs);
+void oval_fts_snapshot_put(OVAL_FTS_SNAPSHOT *snap);
+
+/*
+ * Start listing a directory, st is its stat(). False if the directory
+ * isn't in the snapshot, it wasn't read or it is another one now.
+ */
+bool oval_fts_snapshot_list(const OVAL_FTS_SNAPSHOT *snap, const char *path, size_t path_len,
+			    const struct stat *st, OVAL_FTS_SNAPSHOT_DIR *dir);
+/* The next entry of the directory, false at the end */
+bool oval_fts_snapshot_next(OVAL_FTS_SNAPSHOT_DIR *dir, OVAL_FTS_SNAPSHOT_ENT *ent);
+
+/*
+ * The extended attributes of a path from the snapshots used by the probe,
+ * false if they have to be read live. They are valid until
+ * oval_fts_snapshot_xattrs_free() is called.
+ */
+bool oval_fts_snapshot_xattrs(const char *path, OVAL_FTS_SNAPSHOT_XATTRS *xattrs);
+/* The value of an attribute, NULL if there's no such attribute */
+const char *oval_fts_snapshot_xattr(const OVAL_FTS_SNAPSHOT_XATTRS *xattrs, const char *name, size_t *len);
+void oval_fts_snapshot_xattrs_free(OVAL_FTS_SNAPSHOT_XATTRS *xattrs);
+
+#endif /* OVAL_FTS_SNAPSHOT_H */
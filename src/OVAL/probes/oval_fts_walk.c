@@ -0,0 +1,856 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#if defined(HAVE_STATX)
+#include <sys/sysmacros.h>
+#endif
+#if defined(__SVR4) && defined(__sun)
+#include "fts_sun.h"
+#else
+#include <fts.h>
+#endif
+
+#include "alloc.h"
+#include "debug_priv.h"
+#include "oval_fts_walk.h"
+
+/*
+ * Entries of the directories which have been listed but not read yet. The
+ * walker threads don't start listing another directory when there are more,
+ * the reader then lists the directories it needs by itself.
+ */
+#define WALK_BUFFERED_MAX 65536
+
+#define WALK_DIR_QUEUED  0
+#define WALK_DIR_RUNNING 1
+#define WALK_DIR_DONE    2
+
+struct walk_id {
+	dev_t dev;
+	ino_t ino;
+};
+
+struct walk_dir;
+
+struct walk_item {
+	OVAL_FTS_WALK_ENT  ent;
+	OVAL_FTS_WALK_ENT *followed; /* the target of a followed symlink */
+	struct walk_dir   *child;    /* the directory to descend into */
+};
+
+struct walk_dir {
+	OVAL_FTS_WALK_ENT ent; /* the entry of the directory itself */
+	struct walk_id *ids;   /* the directory and its ancestors */
+	size_t ids_count;
+
+	int state;
+	int refs;   /* the parent item, a deque or the queue of listed directories */
+	int error;  /* errno of opendir() */
+
+	struct walk_item *items;
+	size_t count;
+
+	struct walk_dir *next; /* the queue of listed directories */
+};
+
+struct walk_deque {
+	pthread_mutex_t lock;
+	struct walk_dir **dirs;
+	size_t size;
+	size_t first;
+	size_t count;
+};
+
+struct walk_frame {
+	struct walk_dir *dir;
+	size_t idx;
+	int phase;
+};
+
+struct walk_thread {
+	struct oval_fts_walk *walk;
+	unsigned int idx;
+	pthread_t tid;
+};
+
+struct oval_fts_walk {
+	oval_fts_walk_instr_t instr;
+	oval_fts_walk_filter_t filter;
+	void *arg;
+	bool ordered;
+	const OVAL_FTS_SNAPSHOT *snap;
+
+	unsigned int jobs;
+	unsigned int started;
+	bool spawned;
+	struct walk_thread *threads;
+	struct walk_deque *deques;
+
+	pthread_mutex_t lock;
+	pthread_cond_t work; /* directories to list or space in the buffer */
+	pthread_cond_t done; /* listed directories */
+	size_t queued;
+	size_t running;
+	size_t buffered;
+	bool closing;
+
+	/* the directories listed by the threads of an unordered walk */
+	struct walk_dir *done_first;
+	struct walk_dir *done_last;
+
+	/* the reader: the stack of an ordered walk, the current directory of
+	   an unordered one, both start with a directory holding the root */
+	struct walk_dir *top;
+	struct walk_frame *stack;
+	size_t depth;
+	size_t stack_size;
+	struct walk_dir *current;
+	size_t current_idx;
+	int current_phase;
+	OVAL_FTS_WALK_ENT dnr;
+};
+
+static void walk_deque_push(struct walk_deque *deque, struct walk_dir *dir)
+{
+	if (deque->count == deque->size) {
+		size_t i, size = deque->size ? deque->size * 2 : 64;
+		struct walk_dir **dirs = oscap_alloc(size * sizeof(struct walk_dir *));
+
+		for (i = 0; i < deque->count; ++i)
+			dirs[i] = deque->dirs[(deque->first + i) % deque->size];
+		oscap_free(deque->dirs);
+		deque->dirs = dirs;
+		deque->size = size;
+		deque->first = 0;
+	}
+	deque->dirs[(deque->first + deque->count) % deque->size] = dir;
+	deque->count++;
+}
+
+/* the owner takes the directories from the bottom */
+static struct walk_dir *walk_deque_pop(struct walk_deque *deque)
+{
+	struct walk_dir *dir = NULL;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->count > 0) {
+		deque->count--;
+		dir = deque->dirs[(deque->first + deque->count) % deque->size];
+	}
+	pthread_mutex_unlock(&deque->lock);
+
+	return dir;
+}
+
+/* the others steal them from the top */
+static struct walk_dir *walk_deque_steal(struct walk_deque *deque)
+{
+	struct walk_dir *dir = NULL;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->count > 0) {
+		dir = deque->dirs[deque->first];
+		deque->first = (deque->first + 1) % deque->size;
+		deque->count--;
+	}
+	pthread_mutex_unlock(&deque->lock);
+
+	return dir;
+}
+
+static struct walk_dir *walk_dir_new(const OVAL_FTS_WALK_ENT *ent, const struct walk_dir *parent, int refs)
+{
+	struct walk_dir *dir = oscap_talloc(struct walk_dir);
+
+	memset(dir, 0, sizeof(*dir));
+	dir->ent = *ent;
+	dir->ent.path = strdup(ent->path);
+	dir->ent.name = dir->ent.path + (ent->name - ent->path);
+
+	dir->ids_count = (parent != NULL ? parent->ids_count : 0) + 1;
+	dir->ids = oscap_alloc(dir->ids_count * sizeof(struct walk_id));
+	if (parent != NULL)
+		memcpy(dir->ids, parent->ids, parent->ids_count * sizeof(struct walk_id));
+	dir->ids[dir->ids_count - 1].dev = ent->st.st_dev;
+	dir->ids[dir->ids_count - 1].ino = ent->st.st_ino;
+
+	dir->state = WALK_DIR_QUEUED;
+	dir->refs = refs;
+
+	return dir;
+}
+
+static void walk_dir_unref(struct walk_dir *dir)
+{
+	size_t i;
+
+	if (__sync_sub_and_fetch(&dir->refs, 1) != 0)
+		return;
+
+	for (i = 0; i < dir->count; ++i) {
+		oscap_free(dir->items[i].ent.path);
+		oscap_free(dir->items[i].followed);
+		if (dir->items[i].child != NULL)
+			walk_dir_unref(dir->items[i].child);
+	}
+	oscap_free(dir->items);
+	oscap_free(dir->ent.path);
+	oscap_free(dir->ids);
+	oscap_free(dir);
+}
+
+#if defined(HAVE_STATX)
+/* the fields used by the probes, the others are left zero */
+#define WALK_STATX_MASK (STATX_TYPE | STATX_MODE | STATX_NLINK | STATX_UID | STATX_GID \
+			 | STATX_ATIME | STATX_MTIME | STATX_CTIME | STATX_INO | STATX_SIZE)
+
+static int walk_statx(int dirfd, const char *name, int flags, struct stat *st)
+{
+	struct statx stx;
+
+	if (statx(dirfd, name, flags | AT_NO_AUTOMOUNT, WALK_STATX_MASK, &stx) != 0)
+		return -1;
+
+	memset(st, 0, sizeof(*st));
+	st->st_dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+	st->st_ino = stx.stx_ino;
+	st->st_mode = stx.stx_mode;
+	st->st_nlink = stx.stx_nlink;
+	st->st_uid = stx.stx_uid;
+	st->st_gid = stx.stx_gid;
+	st->st_rdev = makedev(stx.stx_rdev_major, stx.stx_rdev_minor);
+	st->st_size = stx.stx_size;
+	st->st_blksize = stx.stx_blksize;
+	st->st_blocks = stx.stx_blocks;
+	st->st_atim.tv_sec = stx.stx_atime.tv_sec;
+	st->st_atim.tv_nsec = stx.stx_atime.tv_nsec;
+	st->st_mtim.tv_sec = stx.stx_mtime.tv_sec;
+	st->st_mtim.tv_nsec = stx.stx_mtime.tv_nsec;
+	st->st_ctim.tv_sec = stx.stx_ctime.tv_sec;
+	st->st_ctim.tv_nsec = stx.stx_ctime.tv_nsec;
+
+	return 0;
+}
+#endif
+
+/* stat the entry relative to its directory, by its path without one */
+static int walk_stat_at(int dirfd, const OVAL_FTS_WALK_ENT *ent, bool follow, struct stat *st)
+{
+	if (dirfd < 0)
+		return follow ? stat(ent->path, st) : lstat(ent->path, st);
+#if defined(HAVE_STATX)
+	return walk_statx(dirfd, ent->name, follow ? 0 : AT_SYMLINK_NOFOLLOW, st);
+#elif defined(HAVE_FSTATAT)
+	return fstatat(dirfd, ent->name, st, follow ? 0 : AT_SYMLINK_NOFOLLOW);
+#else
+	return follow ? stat(ent->path, st) : lstat(ent->path, st);
+#endif
+}
+
+/* the type of the stat-ed entry like fts_stat() of fts(3) */
+static void walk_info(OVAL_FTS_WALK_ENT *ent, const struct walk_dir *parent)
+{
+	size_t i;
+
+	if (S_ISDIR(ent->st.st_mode)) {
+		ent->info = FTS_D;
+		for (i = 0; parent != NULL && i < parent->ids_count; ++i) {
+			if (parent->ids[i].dev == ent->st.st_dev && parent->ids[i].ino == ent->st.st_ino) {
+				ent->info = FTS_DC;
+				break;
+			}
+		}
+	} else if (S_ISLNK(ent->st.st_mode)) {
+		ent->info = FTS_SL;
+	} else if (S_ISREG(ent->st.st_mode)) {
+		ent->info = FTS_F;
+	} else {
+		ent->info = FTS_DEFAULT;
+	}
+}
+
+/* fts_stat() of fts(3) */
+static void walk_stat(OVAL_FTS_WALK_ENT *ent, int dirfd, const struct walk_dir *parent, bool follow)
+{
+	if (walk_stat_at(dirfd, ent, follow, &ent->st) != 0) {
+		if (follow && errno == ENOENT && walk_stat_at(dirfd, ent, false, &ent->st) == 0) {
+			ent->info = FTS_SLNONE;
+		} else {
+			memset(&ent->st, 0, sizeof(ent->st));
+			ent->info = FTS_NS;
+		}
+		return;
+	}
+
+	walk_info(ent, parent);
+}
+
+/* walk_stat() of an entry of a snapshot */
+static void walk_stat_snapshot(OVAL_FTS_WALK_ENT *ent, const OVAL_FTS_SNAPSHOT_ENT *sent,
+			       const struct walk_dir *parent, bool follow)
+{
+	const struct stat *st = sent->st;
+
+	if (follow && st != NULL && S_ISLNK(st->st_mode)) {
+		if (sent->target == NULL && sent->target_dangling) {
+			ent->st = *st;
+			ent->info = FTS_SLNONE;
+			return;
+		}
+		st = sent->target;
+	}
+	if (st == NULL) {
+		memset(&ent->st, 0, sizeof(ent->st));
+		ent->info = FTS_NS;
+		return;
+	}
+
+	ent->st = *st;
+	walk_info(ent, parent);
+}
+
+/* whether the entry has to be stat-ed and reported */
+static int walk_filter(struct oval_fts_walk *walk, const struct dirent *de)
+{
+#if defined(_DIRENT_HAVE_D_TYPE)
+	if (walk->filter != NULL) {
+		switch (de->d_type) {
+		case DT_DIR:
+		case DT_LNK:
+		case DT_UNKNOWN:
+			break;
+		default:
+			return walk->filter(de->d_name, walk->arg);
+		}
+	}
+#endif
+	return OVAL_FTS_WALK_KEEP;
+}
+
+struct walk_items {
+	struct walk_item *items;
+	size_t size;
+	size_t count;
+};
+
+/* a new entry of the directory, not stat-ed yet */
+static struct walk_item *walk_item_new(struct walk_items *list, const struct walk_dir *dir,
+				       const char *name, size_t nlen, int filter)
+{
+	struct walk_item *item;
+	size_t dlen = dir->ent.path_len;
+
+	/* don't double the slash of the root */
+	if (dlen > 0 && dir->ent.path[dlen - 1] == '/')
+		dlen--;
+
+	if (list->count == list->size) {
+		list->size = list->size ? list->size * 2 : 16;
+		list->items = oscap_realloc(list->items, list->size * sizeof(struct walk_item));
+	}
+	item = &list->items[list->count++];
+	memset(item, 0, sizeof(*item));
+
+	item->ent.path_len = dlen + 1 + nlen;
+	item->ent.path = oscap_alloc(item->ent.path_len + 1);
+	memcpy(item->ent.path, dir->ent.path, dlen);
+	item->ent.path[dlen] = '/';
+	memcpy(item->ent.path + dlen + 1, name, nlen);
+	item->ent.path[dlen + 1 + nlen] = '\0';
+	item->ent.name = item->ent.path + dlen + 1;
+	item->ent.name_len = nlen;
+	item->ent.level = dir->ent.level + 1;
+	item->ent.matched = (filter == OVAL_FTS_WALK_MATCH);
+	item->ent.dir_dev = dir->ent.st.st_dev;
+
+	return item;
+}
+
+/* follow the stat-ed entry and descend into it as instructed */
+static void walk_item_instr(struct oval_fts_walk *walk, struct walk_dir *dir, struct walk_item *item,
+			    int dfd, const OVAL_FTS_SNAPSHOT_ENT *sent)
+{
+	OVAL_FTS_WALK_ENT *target = &item->ent;
+	int instr;
+
+	instr = walk->instr(target, walk->arg);
+	if (instr == FTS_FOLLOW) {
+		item->followed = oscap_talloc(OVAL_FTS_WALK_ENT);
+		*item->followed = item->ent;
+		item->followed->followed = true;
+		if (sent != NULL)
+			walk_stat_snapshot(item->followed, sent, dir, true);
+		else
+			walk_stat(item->followed, dfd, dir, true);
+		target = item->followed;
+		instr = walk->instr(target, walk->arg);
+	}
+	if (target->info == FTS_D && instr != FTS_SKIP)
+		item->child = walk_dir_new(target, dir, walk->jobs > 1 ? 2 : 1);
+}
+
+static void walk_list_dir(struct oval_fts_walk *walk, struct walk_dir *dir, struct walk_items *list)
+{
+	DIR *dp;
+	struct dirent *de;
+	int dfd;
+
+	if ((dp = opendir(dir->ent.path)) == NULL) {
+		dir->error = errno;
+		return;
+	}
+	dfd = dirfd(dp);
+
+	while ((de = readdir(dp)) != NULL) {
+		struct walk_item *item;
+		int filter;
+
+		if (de->d_name[0] == '.' && (de->d_name[1] == '\0'
+		    || (de->d_name[1] == '.' && de->d_name[2] == '\0')))
+			continue;
+
+		if ((filter = walk_filter(walk, de)) == OVAL_FTS_WALK_DROP)
+			continue;
+
+		item = walk_item_new(list, dir, de->d_name, strlen(de->d_name), filter);
+		walk_stat(&item->ent, dfd, dir, false);
+		walk_item_instr(walk, dir, item, dfd, NULL);
+	}
+	closedir(dp);
+}
+
+/* the entries of the directory in the snapshot, false if it doesn't hold it */
+static bool walk_list_snapshot(struct oval_fts_walk *walk, struct walk_dir *dir, struct walk_items *list)
+{
+	OVAL_FTS_SNAPSHOT_DIR sdir;
+	OVAL_FTS_SNAPSHOT_ENT sent;
+
+	if (!oval_fts_snapshot_list(walk->snap, dir->ent.path, dir->ent.path_len, &dir->ent.st, &sdir))
+		return false;
+
+	while (oval_fts_snapshot_next(&sdir, &sent)) {
+		struct walk_item *item;
+		int filter = OVAL_FTS_WALK_KEEP;
+
+		/* the filter sees the same entries as with d_type */
+		if (walk->filter != NULL && sent.st != NULL
+		    && !S_ISDIR(sent.st->st_mode) && !S_ISLNK(sent.st->st_mode)
+		    && (filter = walk->filter(sent.name, walk->arg)) == OVAL_FTS_WALK_DROP)
+			continue;
+
+		item = walk_item_new(list, dir, sent.name, sent.name_len, filter);
+		walk_stat_snapshot(&item->ent, &sent, dir, false);
+		walk_item_instr(walk, dir, item, -1, &sent);
+	}
+
+	return true;
+}
+
+static void walk_list(struct oval_fts_walk *walk, struct walk_dir *dir, unsigned int idx)
+{
+	struct walk_items list = { NULL, 0, 0 };
+	struct walk_item *items;
+	size_t i, count, queued = 0;
+
+	if (walk->snap == NULL || !walk_list_snapshot(walk, dir, &list))
+		walk_list_dir(walk, dir, &list);
+	items = list.items;
+	count = list.count;
+
+	dir->items = items;
+	dir->count = count;
+
+	/* the first subdirectory is taken first */
+	if (count > 0 && walk->jobs > 1) {
+		struct walk_deque *deque = &walk->deques[idx];
+
+		pthread_mutex_lock(&deque->lock);
+		for (i = count; i > 0; --i) {
+			if (items[i - 1].child != NULL) {
+				walk_deque_push(deque, items[i - 1].child);
+				queued++;
+			}
+		}
+		pthread_mutex_unlock(&deque->lock);
+	}
+
+	pthread_mutex_lock(&walk->lock);
+	walk->queued += queued;
+	walk->running--;
+	walk->buffered += count;
+	dir->state = WALK_DIR_DONE;
+	if (!walk->ordered) {
+		/* the reference of the deque is passed to the queue */
+		if (walk->done_last != NULL)
+			walk->done_last->next = dir;
+		else
+			walk->done_first = dir;
+		walk->done_last = dir;
+	}
+	pthread_cond_broadcast(&walk->done);
+	if (queued > 0)
+		pthread_cond_broadcast(&walk->work);
+	pthread_mutex_unlock(&walk->lock);
+}
+
+static bool walk_claim(struct oval_fts_walk *walk, struct walk_dir *dir)
+{
+	if (!__sync_bool_compare_and_swap(&dir->state, WALK_DIR_QUEUED, WALK_DIR_RUNNING))
+		return false;
+
+	pthread_mutex_lock(&walk->lock);
+	/* only the directories in the deques are counted */
+	if (walk->jobs > 1)
+		walk->queued--;
+	walk->running++;
+	pthread_mutex_unlock(&walk->lock);
+
+	return true;
+}
+
+static void *walk_worker(void *arg)
+{
+	struct walk_thread *thread = arg;
+	struct oval_fts_walk *walk = thread->walk;
+	struct walk_dir *dir;
+	unsigned int i;
+
+	for (;;) {
+		pthread_mutex_lock(&walk->lock);
+		while (!walk->closing && (walk->queued == 0 || walk->buffered >= WALK_BUFFERED_MAX))
+			pthread_cond_wait(&walk->work, &walk->lock);
+		if (walk->closing) {
+			pthread_mutex_unlock(&walk->lock);
+			break;
+		}
+		pthread_mutex_unlock(&walk->lock);
+
+		dir = walk_deque_pop(&walk->deques[thread->idx]);
+		for (i = 1; dir == NULL && i < walk->jobs; ++i)
+			dir = walk_deque_steal(&walk->deques[(thread->idx + i) % walk->jobs]);
+		if (dir == NULL)
+			continue;
+
+		/* the reader might have listed it already */
+		if (walk_claim(walk, dir)) {
+			walk_list(walk, dir, thread->idx);
+			if (!walk->ordered)
+				continue;
+		}
+		walk_dir_unref(dir);
+	}
+
+	return NULL;
+}
+
+static void walk_start(struct oval_fts_walk *walk)
+{
+	unsigned int i;
+
+	if (walk->spawned)
+		return;
+	walk->spawned = true;
+	/* the reader lists the directories itself */
+	if (walk->jobs < 2)
+		return;
+
+	for (i = 0; i < walk->jobs; ++i) {
+		walk->threads[i].walk = walk;
+		walk->threads[i].idx = i;
+		if ((errno = pthread_create(&walk->threads[i].tid, NULL, walk_worker, &walk->threads[i])) != 0) {
+			dW("Can't start a walker thread: %s.", strerror(errno));
+			break;
+		}
+	}
+	walk->started = i;
+	dD("Walking '%s' by %u threads.", walk->top->items[0].ent.path, walk->started);
+}
+
+OVAL_FTS_WALK *oval_fts_walk_open(const char *root, unsigned int jobs, bool ordered,
+				  oval_fts_walk_instr_t instr, oval_fts_walk_filter_t filter,
+				  void *arg, const OVAL_FTS_SNAPSHOT *snap)
+{
+	OVAL_FTS_WALK *walk;
+	OVAL_FTS_WALK_ENT ent;
+	struct walk_item *item;
+	unsigned int i;
+	int root_instr;
+
+	memset(&ent, 0, sizeof(ent));
+	ent.path = (char *) root;
+	ent.path_len = strlen(root);
+	/* fts(3) names the root by the last component of its path */
+	ent.name = strrchr(ent.path, '/');
+	if (ent.name == NULL || ent.path_len == 1)
+		ent.name = ent.path;
+	else
+		ent.name++;
+	ent.name_len = ent.path_len - (ent.name - ent.path);
+	walk_stat(&ent, -1, NULL, true);
+	if (ent.info == FTS_NS)
+		return NULL;
+
+	walk = oscap_talloc(OVAL_FTS_WALK);
+	memset(walk, 0, sizeof(*walk));
+	walk->instr = instr;
+	walk->filter = filter;
+	walk->arg = arg;
+	walk->ordered = ordered;
+	walk->snap = snap;
+	walk->jobs = jobs > 0 ? jobs : 1;
+	walk->threads = oscap_calloc(walk->jobs, sizeof(struct walk_thread));
+	walk->deques = oscap_calloc(walk->jobs, sizeof(struct walk_deque));
+	for (i = 0; i < walk->jobs; ++i)
+		pthread_mutex_init(&walk->deques[i].lock, NULL);
+	pthread_mutex_init(&walk->lock, NULL);
+	pthread_cond_init(&walk->work, NULL);
+	pthread_cond_init(&walk->done, NULL);
+
+	/* a directory holding the root */
+	walk->top = oscap_talloc(struct walk_dir);
+	memset(walk->top, 0, sizeof(*walk->top));
+	walk->top->state = WALK_DIR_DONE;
+	walk->top->refs = 1;
+	walk->top->items = item = oscap_talloc(struct walk_item);
+	walk->top->count = 1;
+	memset(item, 0, sizeof(*item));
+	item->ent = ent;
+	item->ent.path = strdup(root);
+	item->ent.name = item->ent.path + (ent.name - ent.path);
+
+	root_instr = instr(&item->ent, arg);
+	if (item->ent.info == FTS_D && root_instr != FTS_SKIP) {
+		if (walk->jobs > 1) {
+			item->child = walk_dir_new(&item->ent, NULL, 2);
+			walk_deque_push(&walk->deques[0], item->child);
+			walk->queued = 1;
+		} else {
+			item->child = walk_dir_new(&item->ent, NULL, 1);
+		}
+	}
+
+	walk->stack_size = 16;
+	walk->stack = oscap_alloc(walk->stack_size * sizeof(struct walk_frame));
+	walk->stack[0].dir = walk->top;
+	walk->stack[0].idx = 0;
+	walk->stack[0].phase = 0;
+	walk->depth = 1;
+	walk->current = walk->top;
+
+	return walk;
+}
+
+static void walk_release(struct oval_fts_walk *walk, struct walk_dir *dir)
+{
+	pthread_mutex_lock(&walk->lock);
+	if (walk->buffered >= WALK_BUFFERED_MAX)
+		pthread_cond_broadcast(&walk->work);
+	walk->buffered -= dir->count;
+	pthread_mutex_unlock(&walk->lock);
+
+	walk_dir_unref(dir);
+}
+
+/* wait for the directory, list it unless a thread took it already */
+static void walk_wait(struct oval_fts_walk *walk, struct walk_dir *dir)
+{
+	if (walk_claim(walk, dir)) {
+		walk_list(walk, dir, 0);
+		return;
+	}
+
+	pthread_mutex_lock(&walk->lock);
+	while (dir->state != WALK_DIR_DONE)
+		pthread_cond_wait(&walk->done, &walk->lock);
+	pthread_mutex_unlock(&walk->lock);
+}
+
+static const OVAL_FTS_WALK_ENT *walk_read_ordered(OVAL_FTS_WALK *walk)
+{
+	struct walk_frame *frame;
+	struct walk_item *item;
+
+	while (walk->depth > 0) {
+		frame = &walk->stack[walk->depth - 1];
+		if (frame->idx == frame->dir->count) {
+			walk->depth--;
+			continue;
+		}
+
+		item = &frame->dir->items[frame->idx];
+		switch (frame->phase++) {
+		case 0:
+			return &item->ent;
+		case 1:
+			if (item->followed != NULL)
+				return item->followed;
+			break;
+		case 2:
+			if (item->child == NULL)
+				break;
+			walk_wait(walk, item->child);
+			/* nothing to walk if the root has no subdirectories */
+			if (!walk->spawned && walk->queued > 0)
+				walk_start(walk);
+			if (walk->depth == walk->stack_size) {
+				walk->stack_size *= 2;
+				walk->stack = oscap_realloc(walk->stack, walk->stack_size * sizeof(struct walk_frame));
+			}
+			frame = &walk->stack[walk->depth++];
+			frame->dir = item->child;
+			frame->idx = 0;
+			frame->phase = 0;
+			break;
+		case 3:
+			if (item->child != NULL && item->child->error != 0) {
+				walk->dnr = item->child->ent;
+				walk->dnr.info = FTS_DNR;
+				return &walk->dnr;
+			}
+			break;
+		default:
+			if (item->child != NULL) {
+				walk_release(walk, item->child);
+				item->child = NULL;
+			}
+			frame->idx++;
+			frame->phase = 0;
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+static const OVAL_FTS_WALK_ENT *walk_read_unordered(OVAL_FTS_WALK *walk)
+{
+	struct walk_item *item;
+
+	for (;;) {
+		if (walk->current == NULL) {
+			pthread_mutex_lock(&walk->lock);
+			while (walk->done_first == NULL && walk->queued + walk->running > 0)
+				pthread_cond_wait(&walk->done, &walk->lock);
+			walk->current = walk->done_first;
+			if (walk->current != NULL) {
+				walk->done_first = walk->current->next;
+				if (walk->done_first == NULL)
+					walk->done_last = NULL;
+			}
+			pthread_mutex_unlock(&walk->lock);
+
+			if (walk->current == NULL)
+				return NULL;
+			walk->current_idx = 0;
+			walk->current_phase = 0;
+
+			if (walk->current->error != 0) {
+				walk->dnr = walk->current->ent;
+				walk->dnr.info = FTS_DNR;
+				return &walk->dnr;
+			}
+		}
+
+		if (walk->current_idx == walk->current->count) {
+			if (walk->current == walk->top) {
+				/* not counted in the buffer */
+				walk_dir_unref(walk->top);
+				walk->top = NULL;
+			} else {
+				walk_release(walk, walk->current);
+			}
+			walk->current = NULL;
+			continue;
+		}
+
+		item = &walk->current->items[walk->current_idx];
+		if (walk->current_phase++ == 0)
+			return &item->ent;
+		walk->current_idx++;
+		walk->current_phase = 0;
+		if (item->followed != NULL)
+			return item->followed;
+	}
+}
+
+const OVAL_FTS_WALK_ENT *oval_fts_walk_read(OVAL_FTS_WALK *walk)
+{
+	if (!walk->ordered && !walk->spawned) {
+		walk_start(walk);
+		/* nobody would list the directories */
+		if (walk->started == 0)
+			walk->ordered = true;
+	}
+
+	return walk->ordered ? walk_read_ordered(walk) : walk_read_unordered(walk);
+}
+
+void oval_fts_walk_close(OVAL_FTS_WALK *walk)
+{
+	struct walk_dir *dir;
+	unsigned int i;
+
+	if (walk == NULL)
+		return;
+
+	pthread_mutex_lock(&walk->lock);
+	walk->closing = true;
+	pthread_cond_broadcast(&walk->work);
+	pthread_mutex_unlock(&walk->lock);
+	for (i = 0; i < walk->started; ++i)
+		pthread_join(walk->threads[i].tid, NULL);
+
+	for (i = 0; i < walk->jobs; ++i) {
+		while ((dir = walk_deque_pop(&walk->deques[i])) != NULL)
+			walk_dir_unref(dir);
+		oscap_free(walk->deques[i].dirs);
+		pthread_mutex_destroy(&walk->deques[i].lock);
+	}
+
+	if (walk->ordered) {
+		walk_dir_unref(walk->stack[0].dir);
+	} else {
+		if (walk->current != NULL && walk->current != walk->top)
+			walk_dir_unref(walk->current);
+		while ((dir = walk->done_first) != NULL) {
+			walk->done_first = dir->next;
+			walk_dir_unref(dir);
+		}
+		if (walk->top != NULL)
+			walk_dir_unref(walk->top);
+	}
+
+	pthread_cond_destroy(&walk->done);
+	pthread_cond_destroy(&walk->work);
+	pthread_mutex_destroy(&walk->lock);
+	oscap_free(walk->stack);
+	oscap_free(walk->deques);
+	oscap_free(walk->threads);
+	oscap_free(walk);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef OVAL_FTS_WALK_H
+#define OVAL_FTS_WALK_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "oval_fts_snapshot.h"
+
+/*
+ * Parallel traversal of a directory tree.
+ *
+ * The directories are listed (and their entries stat-ed) by a pool of
+ * walker threads. Every thread has a deque of directories to list, it
+ * pushes the subdirectories it finds to the bottom of its own deque and
+ * takes the next directory from there, an idle thread steals directories
+ * from the top of the other deques.
+ *
+ * The entries are read in the order of fts(3) with the FTS_PHYSICAL option
+ * (a directory is followed by its entries, a followed symlink is reported
+ * twice, a directory which can't be read is reported again as FTS_DNR), or
+ * in the order in which the directories get listed if the walk is unordered.
+ * Whether to descend into a directory or to follow a symlink is decided by
+ * a callback which is called by the walker threads.
+ *
+ * The entries are stat-ed relative to the descriptor of their directory.
+ * An entry which is neither a directory nor a symlink according to the
+ * d_type of its directory entry is passed by its name to a filter first,
+ * the entries rejected by the filter are neither stat-ed nor reported.
+ * With a single job the directories are listed by the reader.
+ *
+ * With a snapshot the directories it holds are listed from it instead of
+ * the filesystem, see oval_fts_snapshot.h.
+ */
+
+typedef struct {
+	char        *path;
+	size_t       path_len;
+	char        *name; /* points to path */
+	size_t       name_len;
+	int          level;
+	unsigned int info; /* FTS_* */
+	struct stat  st;
+	bool         followed; /* st is the stat() of the target of a symlink,
+				  the root is always stat()-ed */
+	bool         matched;  /* accepted by the filter as matching */
+	dev_t        dir_dev;  /* the device of the directory of the entry,
+				  not set for the root */
+} OVAL_FTS_WALK_ENT;
+
+/* Returns FTS_SKIP, FTS_FOLLOW or 0, must be thread safe */
+typedef int (*oval_fts_walk_instr_t)(const OVAL_FTS_WALK_ENT *ent, void *arg);
+
+#define OVAL_FTS_WALK_DROP  0
+#define OVAL_FTS_WALK_KEEP  1
+#define OVAL_FTS_WALK_MATCH 2
+
+/* Returns OVAL_FTS_WALK_*, must be thread safe */
+typedef int (*oval_fts_walk_filter_t)(const char *name, void *arg);
+
+typedef struct oval_fts_walk OVAL_FTS_WALK;
+
+OVAL_FTS_WALK *oval_fts_walk_open(const char *root, unsigned int jobs, bool ordered,
+				  oval_fts_walk_instr_t instr, oval_fts_walk_filter_t filter,
+				  void *arg, const OVAL_FTS_SNAPSHOT *snap);
+/* The entry is valid until the next call */
+const OVAL_FTS_WALK_ENT *oval_fts_walk_read(OVAL_FTS_WALK *walk);
+void oval_fts_walk_close(OVAL_FTS_WALK *walk);
+
+#endif /* OVAL_FTS_WALK_H */
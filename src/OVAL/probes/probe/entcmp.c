@@ -36,6 +36,7 @@
 #include <string.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <pthread.h>
 #if defined USE_REGEX_PCRE
 #include <pcre.h>
 #elif defined USE_REGEX_POSIX
@@ -89,6 +90,77 @@ oval_result_t probe_ent_cmp_evr(SEXP_t * val1, SEXP_t * val2, oval_operation_t o
 	return result;
 }
 
+/*
+ * The values of an object entity are compared with every collected item,
+ * each thread keeps the last parsed ones.
+ */
+#define PROBE_EVR_CACHE_SIZE 8
+
+struct probe_evr_cache {
+	char           *str[PROBE_EVR_CACHE_SIZE];
+	struct oval_evr evr[PROBE_EVR_CACHE_SIZE];
+	size_t          next;
+};
+
+static pthread_key_t  probe_evr_cache_key;
+static pthread_once_t probe_evr_cache_once = PTHREAD_ONCE_INIT;
+
+static void probe_evr_cache_free(void *arg)
+{
+	struct probe_evr_cache *cache = arg;
+	size_t i;
+
+	for (i = 0; i < PROBE_EVR_CACHE_SIZE; ++i) {
+		if (cache->str[i] != NULL) {
+			oval_evr_clear(&cache->evr[i]);
+			oscap_free(cache->str[i]);
+		}
+	}
+	oscap_free(cache);
+}
+
+static void probe_evr_cache_init(void)
+{
+	(void)pthread_key_create(&probe_evr_cache_key, probe_evr_cache_free);
+}
+
+static const struct oval_evr *probe_evr_cache_get(SEXP_t *val)
+{
+	struct probe_evr_cache *cache;
+	size_t i;
+
+	pthread_once(&probe_evr_cache_once, probe_evr_cache_init);
+
+	cache = pthread_getspecific(probe_evr_cache_key);
+	if (cache == NULL) {
+		cache = oscap_talloc(struct probe_evr_cache);
+		memset(cache, 0, sizeof(struct probe_evr_cache));
+		pthread_setspecific(probe_evr_cache_key, cache);
+	}
+
+	for (i = 0; i < PROBE_EVR_CACHE_SIZE; ++i) {
+		if (cache->str[i] != NULL && SEXP_strcmp(val, cache->str[i]) == 0)
+			return &cache->evr[i];
+	}
+
+	i = cache->next;
+	cache->next = (i + 1) % PROBE_EVR_CACHE_SIZE;
+	if (cache->str[i] != NULL) {
+		oval_evr_clear(&cache->evr[i]);
+		oscap_free(cache->str[i]);
+	}
+	cache->str[i] = SEXP_string_cstr(val);
+	oval_evr_parse(cache->str[i], &cache->evr[i]);
+
+	return &cache->evr[i];
+}
+
+/* Compare a state value with an EVR collected from the system and already parsed */
+static oval_result_t probe_ent_cmp_evr_parsed(SEXP_t *val1, const struct oval_evr *sys_evr, oval_operation_t op)
+{
+	return oval_evr_string_cmp_parsed(probe_evr_cache_get(val1), sys_evr, op);
+}
+
 oval_result_t probe_ent_cmp_debian_evr(SEXP_t * val1, SEXP_t * val2, oval_operation_t op)
 {
 	//TODO: implement Debian's epoch-version-release comparing algorithm
@@ -225,6 +297,8 @@ static oval_result_t probe_ent_cmp(SEXP_t * ent, SEXP_t * val2)
 	int val_cnt, is_var;
 	oval_check_t ochk;
 	oval_result_t ores, result;
+	struct oval_evr sys_evr;
+	bool sys_evr_parsed = false;
 
 	ores = OVAL_RESULT_ERROR;
 	result = OVAL_RESULT_ERROR;
@@ -251,6 +325,15 @@ static oval_result_t probe_ent_cmp(SEXP_t * ent, SEXP_t * val2)
         SEXP_free(stmp);
 	res_lst = SEXP_list_new(NULL);
 
+	/* the collected EVR is parsed once for all values of the state entity */
+	if (dtype == OVAL_DATATYPE_EVR_STRING && SEXP_stringp(val2)) {
+		char *s2 = SEXP_string_cstr(val2);
+
+		oval_evr_parse(s2, &sys_evr);
+		oscap_free(s2);
+		sys_evr_parsed = true;
+	}
+
 	SEXP_list_foreach(val1, vals) {
 		if (SEXP_typeof(val1) != SEXP_typeof(val2)) {
 			dI("Types of values to compare don't match: val1: %d, val2: %d",
@@ -259,11 +342,16 @@ static oval_result_t probe_ent_cmp(SEXP_t * ent, SEXP_t * val2)
                         SEXP_free(vals);
                         SEXP_free(val1);
                         SEXP_free(res_lst);
+			if (sys_evr_parsed)
+				oval_evr_clear(&sys_evr);
 
 			return OVAL_RESULT_ERROR;
 		}
 
-		ores = probe_ent_cmp_single(val1, dtype, val2, op);
+		if (sys_evr_parsed)
+			ores = probe_ent_cmp_evr_parsed(val1, &sys_evr, op);
+		else
+			ores = probe_ent_cmp_single(val1, dtype, val2, op);
 
 		SEXP_list_add(res_lst, r0 = SEXP_number_newi_32(ores));
                 SEXP_free(r0);
@@ -285,6 +373,8 @@ static oval_result_t probe_ent_cmp(SEXP_t * ent, SEXP_t * val2)
 
 	SEXP_free(res_lst);
         SEXP_free(vals);
+	if (sys_evr_parsed)
+		oval_evr_clear(&sys_evr);
 
 	return result;
 }
@@ -35,7 +35,7 @@
 /**
  * Dummy probe_fini function.
  */
-void probe_fini(void *arg)
+__attribute__ ((weak)) void probe_fini(void *arg)
 {
 	(void)arg;
 }
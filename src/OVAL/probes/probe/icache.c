@@ -40,12 +40,13 @@
 
 #include "probe.h"
 #include "icache.h"
+#include "../_probe-api.h"
 
-static volatile uint32_t next_ID = 0;
-
-#if !defined(HAVE_ATOMIC_FUNCTIONS)
-pthread_mutex_t next_ID_mutex = PTHREAD_MUTEX_INITIALIZER;
-#endif
+/*
+ * The item id counter lives in the library. Probe modules running in
+ * the library process share it and don't generate the same ids.
+ */
+extern struct id_desc_t OSCAP_GSYM(id_desc);
 
 static void probe_icache_item_setID(SEXP_t *item, SEXP_ID_t item_ID)
 {
@@ -59,17 +60,17 @@ static void probe_icache_item_setID(SEXP_t *item, SEXP_ID_t item_ID)
         assume_d(SEXP_listp(item), /* void */);
 
 #if defined(HAVE_ATOMIC_FUNCTIONS)
-        local_id = __sync_fetch_and_add(&next_ID, 1);
+        local_id = __sync_fetch_and_add(&OSCAP_GSYM(id_desc).item_id_ctr, 1);
 #else
-        if (pthread_mutex_lock(&next_ID_mutex) != 0) {
-                dE("Can't lock the next_ID_mutex: %u, %s", errno, strerror(errno));
+        if (pthread_mutex_lock(&OSCAP_GSYM(id_desc).item_id_ctr_lock) != 0) {
+                dE("Can't lock the item id counter: %u, %s", errno, strerror(errno));
                 abort();
         }
 
-        local_id = ++next_ID;
+        local_id = ++OSCAP_GSYM(id_desc).item_id_ctr;
 
-        if (pthread_mutex_unlock(&next_ID_mutex) != 0) {
-                dE("Can't unlock the next_ID_mutex: %u, %s", errno, strerror(errno));
+        if (pthread_mutex_unlock(&OSCAP_GSYM(id_desc).item_id_ctr_lock) != 0) {
+                dE("Can't unlock the item id counter: %u, %s", errno, strerror(errno));
                 abort();
         }
 #endif
@@ -85,11 +86,11 @@ static void probe_icache_item_setID(SEXP_t *item, SEXP_ID_t item_ID)
         return;
 }
 
-static int icache_lookup(rbt_t *tree, int64_t item_id, probe_iqpair_t *pair) {
+static int icache_lookup(probe_icache_shard_t *shard, const SEXP_FP_t *item_fp, SEXP_t **item) {
 
 	probe_citem_t *cached = NULL;
 
-	if (rbt_i64_get(tree, item_id, (void**)&cached) != 0) {
+	if (rbt_i64_get(shard->tree, (int64_t)item_fp->lo, (void**)&cached) != 0) {
 		return -1;
 	}
 
@@ -100,8 +101,13 @@ static int icache_lookup(rbt_t *tree, int64_t item_id, probe_iqpair_t *pair) {
 
 	register uint16_t i;
 	for (i = 0; i < cached->count; ++i) {
+		if (!SEXP_ID_fp_eq(item_fp, cached->fp + i))
+			continue;
+		/*
+		 * The fingerprints match, verify the content
+		 */
 		SEXP_t rest1;
-		SEXP_t* rest_r1 = SEXP_list_rest_r(&rest1, pair->p.item);
+		SEXP_t* rest_r1 = SEXP_list_rest_r(&rest1, *item);
 
 		SEXP_t rest2;
 		SEXP_t* rest_r2 = SEXP_list_rest_r(&rest2, cached->item[i]);
@@ -114,6 +120,9 @@ static int icache_lookup(rbt_t *tree, int64_t item_id, probe_iqpair_t *pair) {
 
 		SEXP_free_r(&rest1);
 		SEXP_free_r(&rest2);
+
+		dW("Item fingerprint collision: %016"PRIx64"%016"PRIx64, item_fp->hi, item_fp->lo);
+		++shard->stats.collision;
 	}
 
 	if (i == cached->count) {
@@ -122,36 +131,45 @@ static int icache_lookup(rbt_t *tree, int64_t item_id, probe_iqpair_t *pair) {
 		*/
 		dI("cache MISS");
 
-		cached->item = oscap_realloc(cached->item, sizeof(SEXP_t *) * ++cached->count);
-		cached->item[cached->count - 1] = pair->p.item;
+		++cached->count;
+		cached->item = oscap_realloc(cached->item, sizeof(SEXP_t *) * cached->count);
+		cached->fp   = oscap_realloc(cached->fp, sizeof(SEXP_FP_t) * cached->count);
+		cached->item[cached->count - 1] = *item;
+		cached->fp[cached->count - 1]   = *item_fp;
+		++shard->stats.miss;
 
 		/* Assign an unique item ID */
-		probe_icache_item_setID(pair->p.item, item_id);
+		probe_icache_item_setID(*item, item_fp->lo);
 	} else {
 		/*
 		* Cache HIT
 		*/
 		dI("cache HIT #2 -> real HIT");
-		SEXP_free(pair->p.item);
-		pair->p.item = cached->item[i];
+		SEXP_free(*item);
+		*item = cached->item[i];
+		++shard->stats.hit;
 	}
 	return 0;
 }
 
-static void icache_add_to_tree(rbt_t *tree, int64_t item_id, probe_iqpair_t *pair) {
+static void icache_add_to_tree(probe_icache_shard_t *shard, const SEXP_FP_t *item_fp, SEXP_t *item) {
 
 	probe_citem_t *cached = oscap_talloc(probe_citem_t);
 	cached->item = oscap_talloc(SEXP_t *);
-	cached->item[0] = pair->p.item;
+	cached->item[0] = item;
+	cached->fp = oscap_talloc(SEXP_FP_t);
+	cached->fp[0] = *item_fp;
 	cached->count = 1;
+	++shard->stats.miss;
 
 	/* Assign an unique item ID */
-	probe_icache_item_setID(pair->p.item, item_id);
+	probe_icache_item_setID(item, item_fp->lo);
 
-	if (rbt_i64_add(tree, (int64_t)item_id, (void **)cached, NULL) != 0) {
-		dE("Can't add item (k=%"PRIi64" to the cache (%p)", item_id, tree);
+	if (rbt_i64_add(shard->tree, (int64_t)item_fp->lo, (void **)cached, NULL) != 0) {
+		dE("Can't add item (k=%"PRIu64" to the cache (%p)", item_fp->lo, shard->tree);
 
 		oscap_free(cached->item);
+		oscap_free(cached->fp);
 		oscap_free(cached);
 
 		/* now what? */
@@ -159,300 +177,82 @@ static void icache_add_to_tree(rbt_t *tree, int64_t item_id, probe_iqpair_t *pai
 	}
 }
 
-static void *probe_icache_worker(void *arg)
-{
-        probe_icache_t *cache = (probe_icache_t *)(arg);
-        probe_iqpair_t *pair, pair_mem;
-        SEXP_ID_t       item_ID;
-
-        assume_d(cache != NULL, NULL);
-
-#if defined(HAVE_PTHREAD_SETNAME_NP)
-	pthread_setname_np(pthread_self(), "icache_worker");
-#endif
-
-        if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while locking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                return (NULL);
-        }
-
-	pair = &pair_mem;
-        dD("icache worker ready");
-
-        switch (errno = pthread_barrier_wait(&OSCAP_GSYM(th_barrier)))
-        {
-        case 0:
-        case PTHREAD_BARRIER_SERIAL_THREAD:
-	        break;
-        default:
-	        dE("pthread_barrier_wait: %d, %s.",
-	           errno, strerror(errno));
-	        pthread_mutex_unlock(&cache->queue_mutex);
-	        return (NULL);
-        }
-
-        while(pthread_cond_wait(&cache->queue_notempty, &cache->queue_mutex) == 0) {
-                assume_d(cache->queue_cnt > 0, NULL);
-        do {
-                dI("Extracting item from the cache queue: cnt=%"PRIu16", beg=%"PRIu16"", cache->queue_cnt, cache->queue_beg);
-                /*
-                 * Extract an item from the queue and update queue beg, end & cnt
-                 */
-                pair_mem = cache->queue[cache->queue_beg];
-#ifndef NDEBUG
-		memset(cache->queue + cache->queue_beg, 0, sizeof(probe_iqpair_t));
-#endif
-                --cache->queue_cnt;
-		++cache->queue_beg;
-
-		if (cache->queue_beg == cache->queue_max)
-			cache->queue_beg = 0;
-
-		assume_d(cache->queue_cnt == 0 ?
-			 cache->queue_end == cache->queue_beg :
-			 cache->queue_end != cache->queue_beg, NULL);
-
-
-                dD("Signaling `notfull'");
-
-                if (pthread_cond_signal(&cache->queue_notfull) != 0) {
-                        dE("An error ocured while signaling the `notfull' condition: %u, %s",
-                           errno, strerror(errno));
-                        abort();
-                }
-                /*
-                 * Release the mutex
-                 */
-                if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
-                        dE("An error ocured while unlocking the queue mutex: %u, %s",
-                           errno, strerror(errno));
-                        abort();
-                }
-
-                if (pair->cobj == NULL) {
-                        /*
-                         * Handle NOP case (synchronization)
-                         */
-                        assume_d(pair->p.cond != NULL, NULL);
-
-                        dD("Handling NOP");
-
-                        if (pthread_cond_signal(pair->p.cond) != 0) {
-                                dE("An error ocured while signaling NOP condition: %u, %s",
-                                   errno, strerror(errno));
-                                abort();
-                        }
-                } else {
-
-                        dD("Handling cache request");
-
-                        /*
-                         * Compute item ID
-                         */
-			dD("pair address: %"PRIu64, (uint64_t) pair);
-			dD("item address: %"PRIu64, (uint64_t) pair->p.item);
-                        item_ID = SEXP_ID_v(pair->p.item);
-                        dD("item ID=%"PRIu64"", item_ID);
-
-                        if (icache_lookup(cache->tree, item_ID, pair) != 0) {
-                                /*
-                                 * Cache MISS
-                                 */
-                                dI("cache MISS");
-                                icache_add_to_tree(cache->tree, item_ID, pair);
-                        }
-
-                        if (probe_cobj_add_item(pair->cobj, pair->p.item) != 0) {
-                            dW("An error ocured while adding the item to the collected object");
-                        }
-                }
-
-                if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
-                        dE("An error ocured while re-locking the queue mutex: %u, %s",
-                           errno, strerror(errno));
-                        abort();
-                }
-
-                } while (cache->queue_cnt > 0);
-        }
-
-        return (NULL);
-}
-
 probe_icache_t *probe_icache_new(void)
 {
         probe_icache_t *cache;
+        unsigned int    i;
 
         cache = oscap_talloc(probe_icache_t);
-        cache->tree = rbt_i64_new();
 
-        if (pthread_mutex_init(&cache->queue_mutex, NULL) != 0) {
-                dE("Can't initialize icache mutex: %u, %s", errno, strerror(errno));
-                goto fail;
-        }
-
-        cache->queue_beg = 0;
-        cache->queue_end = 0;
-        cache->queue_cnt = 0;
-        cache->queue_max = PROBE_IQUEUE_CAPACITY;
-
-        if (pthread_cond_init(&cache->queue_notempty, NULL) != 0) {
-                dE("Can't initialize icache queue condition variable (notempty): %u, %s",
-                   errno, strerror(errno));
-                goto fail;
-        }
-
-        if (pthread_cond_init(&cache->queue_notfull, NULL) != 0) {
-                dE("Can't initialize icache queue condition variable (notfull): %u, %s",
-                   errno, strerror(errno));
-                goto fail;
-        }
+        for (i = 0; i < PROBE_ICACHE_SHARDS; ++i) {
+                if (pthread_mutex_init(&cache->shard[i].lock, NULL) != 0) {
+                        dE("Can't initialize icache mutex: %u, %s", errno, strerror(errno));
+                        goto fail;
+                }
 
-        if (pthread_create(&cache->thid, NULL,
-                           probe_icache_worker, (void *)cache) != 0)
-        {
-                dE("Can't start the icache worker: %u, %s", errno, strerror(errno));
-                goto fail;
+                cache->shard[i].tree = rbt_i64_new();
+                memset(&cache->shard[i].stats, 0, sizeof(probe_icache_stats_t));
         }
 
         return (cache);
 fail:
-        if (cache->tree != NULL)
-                rbt_i64_free(cache->tree);
+        while (i > 0) {
+                --i;
+                rbt_i64_free(cache->shard[i].tree);
+                pthread_mutex_destroy(&cache->shard[i].lock);
+        }
 
-        pthread_mutex_destroy(&cache->queue_mutex);
-        pthread_cond_destroy(&cache->queue_notempty);
         oscap_free(cache);
 
         return (NULL);
 }
 
-static int __probe_icache_add_nolock(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item, pthread_cond_t *cond)
-{
-        assume_d((cond == NULL) ^ (item == NULL), -1);
-retry:
-        if (cache->queue_cnt < cache->queue_max) {
-                cache->queue[cache->queue_end].cobj = cobj;
-
-                if (item != NULL) {
-			assume_d(cobj != NULL, -1);
-                        cache->queue[cache->queue_end].p.item = item;
-                } else {
-			assume_d(item == NULL && cobj == NULL, -1);
-                        cache->queue[cache->queue_end].p.cond = cond;
-		}
-
-                ++cache->queue_cnt;
-		++cache->queue_end;
-
-                if (cache->queue_end == cache->queue_max)
-                        cache->queue_end = 0;
-        } else {
-                /*
-                 * The queue is full, we have to wait
-                 */
-                if (pthread_cond_wait(&cache->queue_notfull, &cache->queue_mutex) == 0)
-                        goto retry;
-                else {
-                        dE("An error ocured while waiting for the `notfull' queue condition: %u, %s",
-                           errno, strerror(errno));
-                        return (-1);
-                }
-        }
-
-        return (0);
-}
-
+/**
+ * Deduplicate the item and add it to the collected object. The item
+ * is attached by the calling thread, which owns the collected object.
+ * Only the lookup in the item cache is serialized, per shard.
+ */
 int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item)
 {
-        int ret;
+        probe_icache_shard_t *shard;
+        SEXP_FP_t             item_fp;
 
         if (cache == NULL || cobj == NULL || item == NULL)
                 return (-1); /* XXX: EFAULT */
 
-        if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while locking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                return (-1);
-        }
+        /*
+         * Compute the item fingerprint. The `id' attribute of a new
+         * item is empty, so the fingerprints of equal items match.
+         */
+        SEXP_ID_fp(item, &item_fp);
+        shard = &cache->shard[item_fp.lo % PROBE_ICACHE_SHARDS];
 
-        ret = __probe_icache_add_nolock(cache, cobj, item, NULL);
+        dD("item FP=%016"PRIx64"%016"PRIx64", shard=%u",
+           item_fp.hi, item_fp.lo, (unsigned int)(item_fp.lo % PROBE_ICACHE_SHARDS));
 
-        if (pthread_cond_signal(&cache->queue_notempty) != 0) {
-                dE("An error ocured while signaling the `notempty' condition: %u, %s",
+        if (pthread_mutex_lock(&shard->lock) != 0) {
+                dE("An error ocured while locking the icache shard mutex: %u, %s",
                    errno, strerror(errno));
                 return (-1);
         }
 
-        if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while unlocking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                abort();
-        }
-
-        if (ret != 0)
-                return (-1);
-
-        return (0);
-}
-
-int probe_icache_nop(probe_icache_t *cache)
-{
-        pthread_cond_t cond;
-
-        dD("NOP");
-
-        if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while locking the queue mutex: %u, %s",
-                   errno, strerror(errno));
-                return (-1);
-        }
-
-        if (pthread_cond_init(&cond, NULL) != 0) {
-                dE("Can't initialize icache queue condition variable (NOP): %u, %s",
-                   errno, strerror(errno));
-                return (-1);
-        }
-
-        if (__probe_icache_add_nolock(cache, NULL, NULL, &cond) != 0) {
-                if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
-                        dE("An error ocured while unlocking the queue mutex: %u, %s",
-                           errno, strerror(errno));
-                        abort();
-                }
-
-                pthread_cond_destroy(&cond);
-                return (-1);
-        }
-
-        dD("Signaling `notempty'");
-
-        if (pthread_cond_signal(&cache->queue_notempty) != 0) {
-                dE("An error ocured while signaling the `notempty' condition: %u, %s",
-                   errno, strerror(errno));
-
-                pthread_cond_destroy(&cond);
-                return (-1);
-        }
-
-        dD("Waiting for icache worker to handle the NOP");
-
-        if (pthread_cond_wait(&cond, &cache->queue_mutex) != 0) {
-                dE("An error ocured while waiting for the `NOP' queue condition: %u, %s",
-                   errno, strerror(errno));
-                return (-1);
+        if (icache_lookup(shard, &item_fp, &item) != 0) {
+                /*
+                 * Cache MISS
+                 */
+                dI("cache MISS");
+                icache_add_to_tree(shard, &item_fp, item);
         }
 
-        dD("Sync");
-
-        if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
-                dE("An error ocured while unlocking the queue mutex: %u, %s",
+        if (pthread_mutex_unlock(&shard->lock) != 0) {
+                dE("An error ocured while unlocking the icache shard mutex: %u, %s",
                    errno, strerror(errno));
                 abort();
         }
 
-        pthread_cond_destroy(&cond);
+        if (probe_cobj_add_item(cobj, item) != 0) {
+                dW("An error ocured while adding the item to the collected object");
+        }
 
         return (0);
 }
@@ -463,9 +263,11 @@ int probe_icache_nop(probe_icache_t *cache)
 
 /**
  * Returns 0 if the memory constraints are not reached. Otherwise, 1 is returned.
- * In case of an error, -1 is returned.
+ * In case of an error, -1 is returned. When the constraints are reached, half
+ * of the memory used by the result cache is released first and the check passes
+ * if something could be evicted.
  */
-static int probe_cobj_memcheck(size_t item_cnt)
+static int probe_cobj_memcheck(size_t item_cnt, probe_rcache_t *rcache)
 {
 	if (item_cnt > PROBE_RESULT_MEMCHECK_CTRESHOLD) {
 		struct proc_memusage mu_proc;
@@ -483,19 +285,34 @@ static int probe_cobj_memcheck(size_t item_cnt)
 		if (c_ratio > PROBE_RESULT_MEMCHECK_MAXRATIO) {
 			dW("Memory usage ratio limit reached! limit=%f, current=%f",
 			   PROBE_RESULT_MEMCHECK_MAXRATIO, c_ratio);
-			errno = ENOMEM;
-			return (1);
+			goto evict;
 		}
 
 		if ((mu_sys.mu_realfree / 1024) < PROBE_RESULT_MEMCHECK_MINFREEMEM) {
 			dW("Minimum free memory limit reached! limit=%zu, current=%zu",
 			   PROBE_RESULT_MEMCHECK_MINFREEMEM, mu_sys.mu_realfree / 1024);
-			errno = ENOMEM;
-			return (1);
+			goto evict;
 		}
 	}
 
 	return (0);
+evict:
+	if (rcache != NULL) {
+		probe_rcache_stats_t stats;
+
+		probe_rcache_stats(rcache, &stats);
+
+		if (probe_rcache_evict(rcache, stats.bytes / 2 + 1) > 0)
+			return (0);
+	}
+
+	errno = ENOMEM;
+	return (1);
+}
+
+static void probe_item_free(void *item)
+{
+	SEXP_free((SEXP_t *)item);
 }
 
 /**
@@ -511,7 +328,7 @@ static int probe_cobj_memcheck(size_t item_cnt)
  *-1 ... unexpected/internal error
  *
  * The caller must not free the item, it's freed automatically
- * by this function or by the icache worker thread.
+ * by this function or by the item cache.
  */
 int probe_item_collect(struct probe_ctx *ctx, SEXP_t *item)
 {
@@ -522,11 +339,19 @@ int probe_item_collect(struct probe_ctx *ctx, SEXP_t *item)
 	assume_d(ctx->probe_out != NULL, -1);
 	assume_d(item != NULL, -1);
 
+	/*
+	 * A cancelation point for the worker threads of a probe running
+	 * in the library process, see probe_main_run().
+	 */
+	pthread_cleanup_push(probe_item_free, item);
+	pthread_testcancel();
+	pthread_cleanup_pop(0);
+
 	cobj_content = SEXP_listref_nth(ctx->probe_out, 3);
 	cobj_itemcnt = SEXP_list_length(cobj_content);
 	SEXP_free(cobj_content);
 
-	if (probe_cobj_memcheck(cobj_itemcnt) != 0) {
+	if (probe_cobj_memcheck(cobj_itemcnt, ctx->rcache) != 0) {
 
 		/*
 		 * Don't set the message again if the collected object is
@@ -534,12 +359,6 @@ int probe_item_collect(struct probe_ctx *ctx, SEXP_t *item)
 		 */
 		if (probe_cobj_get_flag(ctx->probe_out) != SYSCHAR_FLAG_INCOMPLETE) {
 			SEXP_t *msg;
-			/*
-			 * Sync with the icache thread before modifying the
-			 * collected object.
-			 */
-			if (probe_icache_nop(ctx->icache) != 0)
-				return -1;
 
 			msg = probe_msg_creat(OVAL_MESSAGE_LEVEL_WARNING,
 			                      "Object is incomplete due to memory constraints.");
@@ -576,21 +395,43 @@ static void probe_icache_free_node(struct rbt_i64_node *n)
 	}
 
         oscap_free(ci->item);
+        oscap_free(ci->fp);
         oscap_free(ci);
         return;
 }
 
+/**
+ * Sum up the hit, miss and collision counters of all shards
+ */
+void probe_icache_stats(probe_icache_t *cache, probe_icache_stats_t *stats)
+{
+        unsigned int i;
+
+        memset(stats, 0, sizeof(probe_icache_stats_t));
+
+        for (i = 0; i < PROBE_ICACHE_SHARDS; ++i) {
+                pthread_mutex_lock(&cache->shard[i].lock);
+                stats->hit       += cache->shard[i].stats.hit;
+                stats->miss      += cache->shard[i].stats.miss;
+                stats->collision += cache->shard[i].stats.collision;
+                pthread_mutex_unlock(&cache->shard[i].lock);
+        }
+}
+
 void probe_icache_free(probe_icache_t *cache)
 {
-        void *ret = NULL;
+        probe_icache_stats_t stats;
+        unsigned int i;
+
+        probe_icache_stats(cache, &stats);
+        dI("icache stats: hit=%"PRIu64", miss=%"PRIu64", collision=%"PRIu64,
+           stats.hit, stats.miss, stats.collision);
 
-        pthread_cancel(cache->thid);
-        pthread_join(cache->thid, &ret);
-        pthread_mutex_destroy(&cache->queue_mutex);
-        pthread_cond_destroy(&cache->queue_notempty);
-        pthread_cond_destroy(&cache->queue_notfull);
+        for (i = 0; i < PROBE_ICACHE_SHARDS; ++i) {
+                rbt_i64_free_cb(cache->shard[i].tree, &probe_icache_free_node);
+                pthread_mutex_destroy(&cache->shard[i].lock);
+        }
 
-        rbt_i64_free_cb(cache->tree, &probe_icache_free_node);
         oscap_free(cache);
         return;
 }
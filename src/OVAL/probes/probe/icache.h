@@ -23,44 +23,43 @@
 #define ICACHE_H
 
 #include <stddef.h>
+#include <pthread.h>
 #include <sexp.h>
 #include "../SEAP/generic/rbt/rbt.h"
 
-#ifndef PROBE_IQUEUE_CAPACITY
-#define PROBE_IQUEUE_CAPACITY 1024
+#ifndef PROBE_ICACHE_SHARDS
+#define PROBE_ICACHE_SHARDS 64 /**< number of independently locked parts of the item cache */
 #endif
 
 typedef struct {
-        SEXP_t *cobj;
-        union {
-                SEXP_t         *item;
-                pthread_cond_t *cond;
-        } p;
-} probe_iqpair_t;
+        uint64_t hit;       /**< item found in the cache */
+        uint64_t miss;      /**< new item added to the cache */
+        uint64_t collision; /**< equal fingerprints, different content */
+} probe_icache_stats_t;
 
+/*
+ * Items are distributed between the shards by their fingerprint,
+ * so lookups of different items rarely contend for the same lock.
+ */
 typedef struct {
-        rbt_t    *tree; /* XXX: rewrite to extensible or linear hashing */
-        pthread_t thid;
+        pthread_mutex_t      lock;
+        rbt_t               *tree; /* XXX: rewrite to extensible or linear hashing */
+        probe_icache_stats_t stats;
+} probe_icache_shard_t;
 
-        pthread_mutex_t queue_mutex;
-        pthread_cond_t  queue_notempty;
-        pthread_cond_t  queue_notfull;
-
-        probe_iqpair_t  queue[PROBE_IQUEUE_CAPACITY];
-        uint16_t        queue_beg;
-        uint16_t        queue_end;
-        uint16_t        queue_cnt;
-        uint16_t        queue_max;
+typedef struct {
+        probe_icache_shard_t shard[PROBE_ICACHE_SHARDS];
 } probe_icache_t;
 
 typedef struct {
-        SEXP_t  **item;
-        uint16_t  count;
+        SEXP_t    **item;
+        SEXP_FP_t  *fp;   /**< content fingerprints of the items */
+        uint16_t    count;
 } probe_citem_t;
 
 probe_icache_t *probe_icache_new(void);
 int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item);
-int probe_icache_nop(probe_icache_t *cache);
+void probe_icache_stats(probe_icache_t *cache, probe_icache_stats_t *stats);
 void probe_icache_free(probe_icache_t *cache);
 
 #endif /* ICACHE_H */
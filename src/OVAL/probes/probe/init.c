@@ -33,9 +33,11 @@
 #include "../_probe-api.h"
 
 /**
- * Dummy probe_fini function.
+ * Dummy probe_init function.
+ * The dummy functions are weak so that the probe's own definitions take
+ * precedence also when the whole library is linked into a probe module.
  */
-void *probe_init(void)
+__attribute__ ((weak)) void *probe_init(void)
 {
 	return (NULL);
 }
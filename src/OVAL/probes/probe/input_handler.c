@@ -39,13 +39,12 @@
 
 /*
  * The input handler waits for incomming eval requests and either returns
- * a result immediately if it is found in the result cache or spawns a new
- * worker thread which takes care of evaluating the request, caching the
- * result and sending it to the requestee.
+ * a result immediately if it is found in the result cache or queues the
+ * request in the worker pool. A worker thread then takes care of evaluating
+ * the request, caching the result and sending it to the requestee.
  */
 void *probe_input_handler(void *arg)
 {
-        pthread_attr_t pth_attr;
         probe_t       *probe = (probe_t *)arg;
 
         int probe_ret, cstate; /* XXX */
@@ -61,16 +60,6 @@ void *probe_input_handler(void *arg)
 
         TH_CANCEL_OFF;
 
-        if (pthread_attr_init(&pth_attr))
-                return (NULL);
-
-        if (pthread_attr_setdetachstate(&pth_attr, PTHREAD_CREATE_JOINABLE)) {
-                pthread_attr_destroy(&pth_attr);
-                return (NULL);
-        }
-
-        pthread_cleanup_push((void(*)(void *))pthread_attr_destroy, (void *)&pth_attr);
-        
         switch (errno = pthread_barrier_wait(&OSCAP_GSYM(th_barrier)))
         {
         case 0:
@@ -86,7 +75,10 @@ void *probe_input_handler(void *arg)
                 TH_CANCEL_ON;
 
 		if (SEAP_recvmsg(probe->SEAP_ctx, probe->sd, &seap_request) == -1) {
-			dE("An error ocured while receiving SEAP message. errno=%u, %s.", errno, strerror(errno));
+			if (errno == ECONNABORTED)
+				dI("The connection was closed by the library.");
+			else
+				dE("An error ocured while receiving SEAP message. errno=%u, %s.", errno, strerror(errno));
 
                         /*
                          * TODO: check for abort request
@@ -144,7 +136,7 @@ void *probe_input_handler(void *arg)
 						cobj_flag = SEXP_number_geti_32(skip_flag);
 						probe_out = probe_cobj_new(cobj_flag, NULL, NULL, obj_mask);
 
-						if (probe_rcache_sexp_add(probe->rcache, oid, probe_out) != 0) {
+						if (probe_rcache_sexp_add(probe->rcache, oid, probe_out, NULL) != 0) {
 							/* TODO */
 							abort();
 						}
@@ -154,53 +146,24 @@ void *probe_input_handler(void *arg)
 	                                        SEXP_free(skip_flag);
 	                                        SEXP_free(obj_mask);
 					} else {
-						probe_pwpair_t *pair;
-
 	                                        SEXP_free(oid);
 						SEXP_free(skip_flag);
 						SEXP_free(obj_mask);
 
-	                                        pair = oscap_talloc(probe_pwpair_t);
-						pair->probe = probe;
-						pair->pth   = probe_worker_new();
-						pair->pth->sid = SEAP_msg_id(seap_request);
-						pair->pth->msg = seap_request;
-						pair->pth->msg_handler = &probe_worker;
-
-						if (rbt_i32_add(probe->workers, pair->pth->sid, pair->pth, NULL) != 0) {
-							/*
-							 * Getting here means that there is already a
-							 * thread handling the message with the given
-							 * ID.
-							 */
-							dW("Attempt to evaluate an object "
-							   "(ID=%u) " // TODO: 64b IDs
-							   "which is already being evaluated by an other thread.", pair->pth->sid);
-
-							oscap_free(pair->pth);
-							oscap_free(pair);
-							SEAP_msg_free(seap_request);
-						} else {
-							/* OK */
-
-							if (pthread_create(&pair->pth->tid, &pth_attr, &probe_worker_runfn, pair))
-							{
-								dE("Cannot start a new worker thread: %d, %s.", errno, strerror(errno));
-
-								if (rbt_i32_del(probe->workers, pair->pth->sid, NULL) != 0)
-									dE("rbt_i32_del: failed to remove worker thread (ID=%u)", pair->pth->sid);
-
-								SEAP_msg_free(pair->pth->msg);
-								oscap_free(pair->pth);
-								oscap_free(pair);
-
-								probe_ret = PROBE_EUNKNOWN;
-								probe_out = NULL;
-
-								goto __error_reply;
-							}
+						SEAP_msgid_t request_id = SEAP_msg_id(seap_request);
+
+						if (probe_wpool_submit(probe->workers, seap_request) != 0) {
+							dE("Cannot queue the request (ID=%u) for evaluation.", request_id);
+
+							probe_ret = PROBE_EUNKNOWN;
+							probe_out = NULL;
+
+							goto __error_reply;
 						}
 
+						dD("queued request ID=%u, queue depth=%u",
+						   request_id, probe_wpool_queue_depth(probe->workers));
+
 						seap_request = NULL;
 						continue;
 					}
@@ -254,6 +217,5 @@ void *probe_input_handler(void *arg)
 		SEAP_msg_free(seap_request);
 	} /* main loop */
 
-        pthread_cleanup_pop(1);
         return (NULL);
 }
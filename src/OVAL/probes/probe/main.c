@@ -27,6 +27,7 @@
 # endif
 #endif
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <signal.h>
 #include <pthread.h>
@@ -43,6 +44,8 @@
 #include "input_handler.h"
 #include "probe-api.h"
 #include "option.h"
+#include "../oval_fts_snapshot.h"
+#include "../../results/oval_regex_cache_impl.h"
 #include <oscap_debug.h>
 #include "debug_priv.h"
 static int fail(int err, const char *who, int line)
@@ -58,6 +61,11 @@ size_t OSCAP_GSYM(no_varref_ents_cnt) = 0;
 probe_offline_flags OSCAP_GSYM(offline_mode) = PROBE_OFFLINE_NONE;
 probe_offline_flags OSCAP_GSYM(offline_mode_supported) = PROBE_OFFLINE_NONE;
 int OSCAP_GSYM(offline_mode_cobjflag) = SYSCHAR_FLAG_NOT_APPLICABLE;
+size_t OSCAP_GSYM(rcache_max_count) = 0;
+size_t OSCAP_GSYM(rcache_max_bytes) = 0;
+bool   OSCAP_GSYM(multithreaded)      = false;
+uint32_t OSCAP_GSYM(max_threads)      = PROBE_WORKER_DEFAULT_MAX_THREADS;
+uint32_t OSCAP_GSYM(max_chdepth)      = PROBE_WORKER_DEFAULT_MAX_CHDEPTH;
 
 pthread_barrier_t OSCAP_GSYM(th_barrier);
 
@@ -75,14 +83,32 @@ static SEXP_t *probe_reset(SEXP_t *arg0, void *arg1)
          * FIXME: implement main loop locking & worker waiting
          */
 	probe_rcache_free(probe->rcache);
-        probe_ncache_free(probe->ncache);
-
         probe->rcache = probe_rcache_new();
-        probe->ncache = probe_ncache_new();
+
+        /* a probe running in the library process uses the library's cache */
+        if (probe->ncache != NULL) {
+                probe_ncache_free(probe->ncache);
+                probe->ncache = probe_ncache_new();
+        }
+
+        probe_rcache_setlimits(probe->rcache,
+                               OSCAP_GSYM(rcache_max_count), OSCAP_GSYM(rcache_max_bytes));
 
         return(NULL);
 }
 
+/*
+ * The library passes the start of the scan, the snapshots of the file
+ * probes taken before it are stale.
+ */
+static SEXP_t *probe_fts_since(SEXP_t *arg0, void *arg1)
+{
+	if (arg0 != NULL && SEXP_numberp(arg0))
+		oval_fts_snapshot_since(SEXP_number_geti_64(arg0));
+
+	return (NULL);
+}
+
 static int probe_opthandler_varref(int option, int op, va_list args)
 {
 	bool  o_switch;
@@ -117,8 +143,27 @@ static int probe_opthandler_varref(int option, int op, va_list args)
 	return (0);
 }
 
+/*
+ * PROBEOPT_RESULT_CACHING
+ *  SET: size_t max_count, size_t max_bytes (0 = unlimited)
+ *  GET: size_t *max_count, size_t *max_bytes
+ * The limits are overridden by OSCAP_PROBE_RCACHE_MAX_COUNT and
+ * OSCAP_PROBE_RCACHE_MAX_BYTES when the probe starts.
+ */
 static int probe_opthandler_rcache(int option, int op, va_list args)
 {
+	if (op == PROBE_OPTION_SET) {
+		OSCAP_GSYM(rcache_max_count) = va_arg(args, size_t);
+		OSCAP_GSYM(rcache_max_bytes) = va_arg(args, size_t);
+	} else if (op == PROBE_OPTION_GET) {
+		size_t *max_count = va_arg(args, size_t *);
+		size_t *max_bytes = va_arg(args, size_t *);
+
+		if (max_count != NULL)
+			*max_count = OSCAP_GSYM(rcache_max_count);
+		if (max_bytes != NULL)
+			*max_bytes = OSCAP_GSYM(rcache_max_bytes);
+	}
 	return (0);
 }
 
@@ -161,6 +206,52 @@ static int probe_opthandler_offlinemode(int option, int op, va_list args)
 	return 0;
 }
 
+static int probe_opthandler_multithreaded(int option, int op, va_list args)
+{
+	if (op == PROBE_OPTION_SET) {
+		OSCAP_GSYM(multithreaded) = va_arg(args, int) ? true : false;
+	} else if (op == PROBE_OPTION_GET) {
+		bool *multithreaded = va_arg(args, bool *);
+
+		if (multithreaded != NULL)
+			*multithreaded = OSCAP_GSYM(multithreaded);
+	}
+	return (0);
+}
+
+/*
+ * PROBEOPT_WORKER_LIMITS
+ *  SET: uint32_t max_threads, uint32_t max_chdepth (0 = keep the current value,
+ *       at most PROBE_WORKER_THREADS_LIMIT and PROBE_WORKER_CHDEPTH_LIMIT)
+ *  GET: uint32_t *max_threads, uint32_t *max_chdepth
+ * The limits are overridden by OSCAP_PROBE_MAX_THREADS and
+ * OSCAP_PROBE_MAX_CHDEPTH when the probe starts.
+ */
+static int probe_opthandler_wlimits(int option, int op, va_list args)
+{
+	if (op == PROBE_OPTION_SET) {
+		uint32_t max_threads = va_arg(args, uint32_t);
+		uint32_t max_chdepth = va_arg(args, uint32_t);
+
+		if (max_threads > PROBE_WORKER_THREADS_LIMIT
+		    || max_chdepth > PROBE_WORKER_CHDEPTH_LIMIT)
+			return (-1);
+		if (max_threads > 0)
+			OSCAP_GSYM(max_threads) = max_threads;
+		if (max_chdepth > 0)
+			OSCAP_GSYM(max_chdepth) = max_chdepth;
+	} else if (op == PROBE_OPTION_GET) {
+		uint32_t *max_threads = va_arg(args, uint32_t *);
+		uint32_t *max_chdepth = va_arg(args, uint32_t *);
+
+		if (max_threads != NULL)
+			*max_threads = OSCAP_GSYM(max_threads);
+		if (max_chdepth != NULL)
+			*max_chdepth = OSCAP_GSYM(max_chdepth);
+	}
+	return (0);
+}
+
 // Dummy pthread routine
 static void * dummy_routine(void *dummy_param)
 {
@@ -177,12 +268,165 @@ static void preload_libraries_before_chroot()
 	pthread_join(t, NULL);
 }
 
+/*
+ * Set up the caches and the option & command handlers of a probe
+ * whose SEAP descriptor is already open.
+ */
+static int probe_setup(probe_t *probe)
+{
+	if (SEAP_cmd_register(probe->SEAP_ctx, PROBECMD_RESET, 0, &probe_reset) != 0)
+		return (-1);
+	if (SEAP_cmd_register(probe->SEAP_ctx, PROBECMD_FTS_SINCE, 0, &probe_fts_since) != 0)
+		return (-1);
+
+	/*
+	 * Initialize result & item caching
+	 */
+	probe->rcache = probe_rcache_new();
+        probe->icache = probe_icache_new();
+
+	/*
+	 * Initialize probe option handlers
+	 */
+#define PROBE_OPTION_INITCOUNT 5
+
+	probe->option = oscap_alloc(sizeof(probe_option_t) * PROBE_OPTION_INITCOUNT);
+	probe->optcnt = PROBE_OPTION_INITCOUNT;
+
+	probe->option[0].option  = PROBEOPT_VARREF_HANDLING;
+	probe->option[0].handler = &probe_opthandler_varref;
+	probe->option[1].option  = PROBEOPT_RESULT_CACHING;
+	probe->option[1].handler = &probe_opthandler_rcache;
+	probe->option[2].option  = PROBEOPT_OFFLINE_MODE_SUPPORTED;
+	probe->option[2].handler = &probe_opthandler_offlinemode;
+	probe->option[3].option  = PROBEOPT_MULTITHREADED;
+	probe->option[3].handler = &probe_opthandler_multithreaded;
+	probe->option[4].option  = PROBEOPT_WORKER_LIMITS;
+	probe->option[4].handler = &probe_opthandler_wlimits;
+
+	OSCAP_GSYM(probe_optdef) = probe->option;
+	OSCAP_GSYM(probe_optdef_count) = probe->optcnt;
+
+	/*
+	 * The library may have several requests for the probe in flight.
+	 * Unless the probe declares otherwise, its main function is not
+	 * run concurrently.
+	 */
+	pthread_mutex_init(&probe->main_lock, NULL);
+
+	return (0);
+}
+
+/*
+ * Read a limit from the environment. The limit is left unchanged if
+ * the variable isn't set or its value isn't a number in [min, max].
+ */
+static void probe_envlimit(const char *name, unsigned long long min, unsigned long long max,
+                           unsigned long long *limit)
+{
+	const char *value = getenv(name);
+	char *end;
+	unsigned long long n;
+
+	if (value == NULL || *value == '\0')
+		return;
+
+	errno = 0;
+	n = strtoull(value, &end, 10);
+
+	if (errno != 0 || *end != '\0' || n < min || n > max) {
+		dW("Ignoring %s=%s: not a number in [%llu, %llu]", name, value, min, max);
+		return;
+	}
+
+	*limit = n;
+}
+
+static void probe_rcache_envlimit(const char *name, size_t *limit)
+{
+	unsigned long long n = *limit;
+
+	probe_envlimit(name, 0, SIZE_MAX, &n);
+	*limit = (size_t)n;
+}
+
+static void probe_wpool_envlimit(const char *name, uint32_t max, uint32_t *limit)
+{
+	unsigned long long n = *limit;
+
+	probe_envlimit(name, 1, max, &n);
+	*limit = (uint32_t)n;
+}
+
+/*
+ * Start the worker pool and the input handler. The offline mode
+ * has to be set up at this point.
+ */
+static int probe_start(probe_t *probe)
+{
+	pthread_attr_t th_attr;
+
+        /*
+         * probe_init() may set the worker limits, the pool is created
+         * afterwards.
+         */
+        probe->probe_arg   = probe_init();
+
+        probe_wpool_envlimit(PROBE_WORKER_MAX_THREADS_ENV, PROBE_WORKER_THREADS_LIMIT,
+                             &OSCAP_GSYM(max_threads));
+        probe_wpool_envlimit(PROBE_WORKER_MAX_CHDEPTH_ENV, PROBE_WORKER_CHDEPTH_LIMIT,
+                             &OSCAP_GSYM(max_chdepth));
+        probe->max_threads = OSCAP_GSYM(max_threads);
+        probe->max_chdepth = OSCAP_GSYM(max_chdepth);
+        probe->workers     = probe_wpool_new(probe, probe->max_threads, probe->max_chdepth);
+
+        probe_rcache_envlimit(PROBE_RCACHE_MAX_COUNT_ENV, &OSCAP_GSYM(rcache_max_count));
+        probe_rcache_envlimit(PROBE_RCACHE_MAX_BYTES_ENV, &OSCAP_GSYM(rcache_max_bytes));
+        probe_rcache_setlimits(probe->rcache,
+                               OSCAP_GSYM(rcache_max_count), OSCAP_GSYM(rcache_max_bytes));
+
+	pthread_attr_init(&th_attr);
+	errno = pthread_create(&probe->th_input, &th_attr, &probe_input_handler, probe);
+	pthread_attr_destroy(&th_attr);
+
+	return (errno == 0 ? 0 : -1);
+}
+
+/*
+ * Returns -1 if some of the worker threads didn't finish. They may still
+ * use the probe, so nothing is freed then.
+ */
+static int probe_cleanup(probe_t *probe)
+{
+        if (probe_wpool_free(probe->workers) != 0)
+                return (-1);
+
+        probe_fini(probe->probe_arg);
+
+	if (probe->ncache != NULL)
+		probe_ncache_free(probe->ncache);
+
+	probe_rcache_free(probe->rcache);
+        probe_icache_free(probe->icache);
+#if defined USE_REGEX_PCRE
+	/* the probe's own copy, the library frees its cache by oscap_cleanup() */
+	oval_regex_cache_free();
+#endif
+        oscap_free(probe->option);
+        pthread_mutex_destroy(&probe->main_lock);
+
+        return (0);
+}
+
 int main(int argc, char *argv[])
 {
 	pthread_attr_t th_attr;
 	sigset_t       sigmask;
 	probe_t        probe;
 	char *rootdir = NULL;
+	char *shm_fds = NULL;
+	uint32_t seap_flags = 0;
+	int i;
 
 	/* Turn on verbose mode */
 	char *verbosity_level = getenv("OSCAP_PROBE_VERBOSITY_LEVEL");
@@ -192,10 +436,9 @@ int main(int argc, char *argv[])
 	if ((errno = pthread_barrier_init(&OSCAP_GSYM(th_barrier), NULL,
 	                                  1 + // signal thread
 	                                  1 + // input thread
-	                                  1 + // icache thread
 	                                  0)) != 0)
 	{
-		fail(errno, "pthread_barrier_init", __LINE__ - 6);
+		fail(errno, "pthread_barrier_init", __LINE__ - 5);
 	}
 
 	/*
@@ -222,41 +465,35 @@ int main(int argc, char *argv[])
 	/*
 	 * Initialize SEAP stuff
 	 */
+	for (i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], SEAP_WIRE_BINARY_ARG) == 0)
+			seap_flags |= SEAP_OPENFD_WIRE_BINARY;
+		else if (strncmp(argv[i], SEAP_SHM_ARG, strlen(SEAP_SHM_ARG)) == 0)
+			shm_fds = argv[i] + strlen(SEAP_SHM_ARG);
+	}
+
 	probe.SEAP_ctx = SEAP_CTX_new();
-	probe.sd       = SEAP_openfd2(probe.SEAP_ctx, STDIN_FILENO, STDOUT_FILENO, 0);
 
-	if (probe.sd < 0)
-		fail(errno, "SEAP_openfd2", __LINE__ - 3);
+	if (shm_fds != NULL) {
+		probe.sd = SEAP_openshm(probe.SEAP_ctx, STDIN_FILENO, STDOUT_FILENO, shm_fds, seap_flags);
+
+		if (probe.sd < 0)
+			fail(errno, "SEAP_openshm", __LINE__ - 3);
+	} else {
+		probe.sd = SEAP_openfd2(probe.SEAP_ctx, STDIN_FILENO, STDOUT_FILENO, seap_flags);
 
-	if (SEAP_cmd_register(probe.SEAP_ctx, PROBECMD_RESET, 0, &probe_reset) != 0)
-		fail(errno, "SEAP_cmd_register", __LINE__ - 1);
+		if (probe.sd < 0)
+			fail(errno, "SEAP_openfd2", __LINE__ - 3);
+	}
 
 	/*
-	 * Initialize result & name caching
+	 * The probe has its own element name cache
 	 */
-	probe.rcache = probe_rcache_new();
 	probe.ncache = probe_ncache_new();
-        probe.icache = probe_icache_new();
-
         OSCAP_GSYM(ncache) = probe.ncache;
 
-	/*
-	 * Initialize probe option handlers
-	 */
-#define PROBE_OPTION_INITCOUNT 3
-
-	probe.option = oscap_alloc(sizeof(probe_option_t) * PROBE_OPTION_INITCOUNT);
-	probe.optcnt = PROBE_OPTION_INITCOUNT;
-
-	probe.option[0].option  = PROBEOPT_VARREF_HANDLING;
-	probe.option[0].handler = &probe_opthandler_varref;
-	probe.option[1].option  = PROBEOPT_RESULT_CACHING;
-	probe.option[1].handler = &probe_opthandler_rcache;
-	probe.option[2].option  = PROBEOPT_OFFLINE_MODE_SUPPORTED;
-	probe.option[2].handler = &probe_opthandler_offlinemode;
-
-	OSCAP_GSYM(probe_optdef) = probe.option;
-	OSCAP_GSYM(probe_optdef_count) = probe.optcnt;
+	if (probe_setup(&probe) != 0)
+		fail(errno, "probe_setup", __LINE__ - 1);
 
 	/*
 	 * Create signal handler
@@ -314,16 +551,9 @@ int main(int argc, char *argv[])
 	/*
 	 * Create input handler (detached)
 	 */
-        probe.workers   = rbt_i32_new();
-        probe.probe_arg = probe_init();
-
-	pthread_attr_init(&th_attr);
-
-	if (pthread_create(&probe.th_input, &th_attr, &probe_input_handler, &probe))
+	if (probe_start(&probe) != 0)
 		fail(errno, "pthread_create(probe_input_handler)", __LINE__ - 1);
 
-	pthread_attr_destroy(&th_attr);
-
 	/*
 	 * Wait until the signal handler exits
 	 */
@@ -352,19 +582,134 @@ int main(int argc, char *argv[])
 	/*
 	 * Cleanup
 	 */
-        probe_fini(probe.probe_arg);
-
-	probe_ncache_free(probe.ncache);
-	probe_rcache_free(probe.rcache);
-        probe_icache_free(probe.icache);
-
-        rbt_i32_free(probe.workers);
+	probe_cleanup(&probe);
 
         if (probe.sd != -1)
                 SEAP_close(probe.SEAP_ctx, probe.sd);
 
 	SEAP_CTX_free(probe.SEAP_ctx);
-        oscap_free(probe.option);
 
 	return (probe.probe_exitcode);
 }
+
+/*
+ * Entry points of a probe module (see the thread scheme of SEAP). The
+ * probe runs in the threads of the library process, which owns the SEAP
+ * context, so there's no signal handler and the process state (signal
+ * mask, root directory, ...) isn't touched. The library runs offline
+ * scans with the probe executables.
+ */
+void *probe_thread_start(SEAP_CTX_t *ctx, int sd, const char *name)
+{
+	probe_t *probe;
+	size_t   i;
+
+	if (getenv("OSCAP_PROBE_ROOT") != NULL || getenv("OSCAP_PROBE_RPMDB_PATH") != NULL) {
+		dE("%s: offline mode is not supported in the library process", name);
+		errno = EOPNOTSUPP;
+		return (NULL);
+	}
+
+	/*
+	 * The module may have been started before, reset the global
+	 * state to the defaults.
+	 */
+	for (i = 0; i < OSCAP_GSYM(no_varref_ents_cnt); ++i)
+		free(OSCAP_GSYM(no_varref_ents)[i]);
+
+	oscap_free(OSCAP_GSYM(no_varref_ents));
+	OSCAP_GSYM(no_varref_ents)     = NULL;
+	OSCAP_GSYM(no_varref_ents_cnt) = 0;
+	OSCAP_GSYM(varref_handling)    = true;
+	OSCAP_GSYM(offline_mode)       = PROBE_OFFLINE_NONE;
+	OSCAP_GSYM(offline_mode_supported) = PROBE_OFFLINE_NONE;
+	OSCAP_GSYM(offline_mode_cobjflag)  = SYSCHAR_FLAG_NOT_APPLICABLE;
+	OSCAP_GSYM(rcache_max_count) = 0;
+	OSCAP_GSYM(rcache_max_bytes) = 0;
+	OSCAP_GSYM(multithreaded)    = false;
+	OSCAP_GSYM(max_threads)      = PROBE_WORKER_DEFAULT_MAX_THREADS;
+	OSCAP_GSYM(max_chdepth)      = PROBE_WORKER_DEFAULT_MAX_CHDEPTH;
+
+	if ((errno = pthread_barrier_init(&OSCAP_GSYM(th_barrier), NULL, 1)) != 0)
+		return (NULL);
+
+	probe = oscap_talloc(probe_t);
+	probe->flags    = PROBE_FLAG_INPROCESS;
+	probe->pid      = getpid();
+	probe->name     = (char *)name;
+	probe->probe_exitcode = 0;
+	probe->SEAP_ctx = ctx;
+	probe->sd       = sd;
+
+	/*
+	 * The element name cache of the library is used
+	 */
+	probe->ncache = NULL;
+
+	if (probe_setup(probe) != 0) {
+		protect_errno {
+			pthread_barrier_destroy(&OSCAP_GSYM(th_barrier));
+			oscap_free(probe);
+		}
+		return (NULL);
+	}
+
+	probe_offline_mode();
+
+	if (probe_start(probe) != 0) {
+		protect_errno {
+			dE("%s: can't start the input handler: %d, %s", name, errno, strerror(errno));
+			probe_cleanup(probe);
+			pthread_barrier_destroy(&OSCAP_GSYM(th_barrier));
+			oscap_free(probe);
+		}
+		return (NULL);
+	}
+
+	dI("%s: started in the library process", name);
+
+	return (probe);
+}
+
+int probe_thread_stop(void *arg)
+{
+	probe_t *probe = (probe_t *)arg;
+
+	/*
+	 * The library closed its side of the channel. The input handler
+	 * returns once it reads the end of the input, the idle workers
+	 * are canceled.
+	 */
+	if ((errno = pthread_join(probe->th_input, NULL)) != 0)
+		dE("%s: pthread_join: %d, %s", probe->name, errno, strerror(errno));
+
+	if (probe_cleanup(probe) != 0) {
+		dW("%s: the probe is still running, leaving it loaded", probe->name);
+		return (-1);
+	}
+
+	pthread_barrier_destroy(&OSCAP_GSYM(th_barrier));
+	oscap_free(probe);
+
+	return (0);
+}
+
+int probe_thread_abort(void *arg)
+{
+	probe_t *probe = (probe_t *)arg;
+
+	/*
+	 * The same as SIGUSR1 does in a probe process, but the threads are
+	 * only canceled here. The probe is stopped and freed when the library
+	 * closes the channel.
+	 */
+	dI("%s: aborting", probe->name);
+
+	probe->probe_exitcode = ECONNABORTED;
+	pthread_cancel(probe->th_input);
+
+	/* cancel the worker threads and wait for them */
+	probe_wpool_cancel(probe->workers);
+
+	return (0);
+}
@@ -32,7 +32,7 @@
 /**
  * In this function can be set supported type of offline mode
  */
-void probe_offline_mode(void)
+__attribute__ ((weak)) void probe_offline_mode(void)
 {
 	return;
 }
@@ -4,6 +4,13 @@
 #define PROBEOPT_VARREF_HANDLING 0
 #define PROBEOPT_RESULT_CACHING  1
 #define PROBEOPT_OFFLINE_MODE_SUPPORTED 2
+/*
+ * The library pipelines the requests, so a probe may have several of them
+ * in flight. Unless this option is set the probe_main() calls are serialized,
+ * as most probes use non-reentrant interfaces (getpwent, getspent, rpmlib, ...).
+ */
+#define PROBEOPT_MULTITHREADED   3
+#define PROBEOPT_WORKER_LIMITS   4
 
 #define PROBE_OPTION_SET 0
 #define PROBE_OPTION_GET 1
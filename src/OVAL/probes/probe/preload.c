@@ -35,7 +35,7 @@
  * It should load all dynamic libraries what can by used by probe
  * after chroot.
  */
-void probe_preload(void)
+__attribute__ ((weak)) void probe_preload(void)
 {
 	return;
 }
@@ -25,6 +25,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdarg.h>
 #include <pthread.h>
@@ -36,6 +37,8 @@
 #include "option.h"
 #include "common/util.h"
 
+#define PROBE_FLAG_INPROCESS 0x00000001 /**< the probe runs in the library process */
+
 typedef struct {
 	pthread_rwlock_t rwlock;
 	uint32_t         flags;
@@ -52,7 +55,7 @@ typedef struct {
 	pthread_t th_input;
 	pthread_t th_signal;
 
-        rbt_t    *workers;
+        struct probe_wpool *workers; /**< worker thread pool */
         uint32_t  max_threads;
         uint32_t  max_chdepth;
 
@@ -62,6 +65,8 @@ typedef struct {
 
 	probe_option_t *option; /**< probe option handlers */
 	size_t          optcnt; /**< number of defined options */
+
+	pthread_mutex_t main_lock; /**< serializes probe_main() calls of probes which aren't thread-safe */
 } probe_t;
 
 struct probe_ctx {
@@ -69,6 +74,7 @@ struct probe_ctx {
         SEXP_t         *probe_out; /**< collected object */
         SEXP_t         *filters;   /**< object filters (OVAL 5.8 and higher) */
         probe_icache_t *icache;    /**< item cache */
+        probe_rcache_t *rcache;    /**< result cache, evicted under memory pressure */
 };
 
 typedef enum {
@@ -83,5 +89,13 @@ extern pthread_barrier_t OSCAP_GSYM(th_barrier);
 extern probe_offline_flags OSCAP_GSYM(offline_mode);
 extern probe_offline_flags OSCAP_GSYM(offline_mode_supported);
 extern int OSCAP_GSYM(offline_mode_cobjflag);
+extern bool OSCAP_GSYM(multithreaded);
+
+/*
+ * Entry points of a probe module (see sch_thread.h)
+ */
+void *probe_thread_start(SEAP_CTX_t *ctx, int sd, const char *name);
+int probe_thread_stop(void *arg);
+int probe_thread_abort(void *arg);
 
 #endif /* PROBE_H */
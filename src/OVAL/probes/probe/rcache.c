@@ -25,10 +25,14 @@
 #endif
 
 #include <stddef.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
 #include <sexp.h>
 
 #include "common/alloc.h"
 #include "common/assume.h"
+#include "common/debug_priv.h"
 #include "../SEAP/generic/rbt/rbt.h"
 
 #include "rcache.h"
@@ -39,41 +43,185 @@ probe_rcache_t *probe_rcache_new(void)
 
 	cache = oscap_talloc(probe_rcache_t);
 	cache->tree = rbt_str_new();
+	cache->lru_head  = NULL;
+	cache->lru_tail  = NULL;
+	cache->max_count = 0;
+	cache->max_bytes = 0;
+	memset(&cache->stats, 0, sizeof cache->stats);
+
+	if (pthread_mutex_init(&cache->lock, NULL) != 0) {
+		dE("Can't initialize rcache mutex");
+		rbt_str_free(cache->tree);
+		oscap_free(cache);
+		return (NULL);
+	}
 
 	return (cache);
 }
 
 static void probe_rcache_free_node(struct rbt_str_node *n)
 {
+        probe_rcache_entry_t *e = (probe_rcache_entry_t *)n->data;
+
         oscap_free(n->key);
-        SEXP_free(n->data);
+        SEXP_free(e->item);
+        SEXP_free(e->src);
+        oscap_free(e);
 }
 
 void probe_rcache_free(probe_rcache_t *cache)
 {
+        dI("rcache: hit=%"PRIu64", miss=%"PRIu64", evicted=%"PRIu64", count=%zu, bytes=%zu",
+           cache->stats.hit, cache->stats.miss, cache->stats.evicted,
+           cache->stats.count, cache->stats.bytes);
+
         rbt_str_free_cb(cache->tree, &probe_rcache_free_node);
+        pthread_mutex_destroy(&cache->lock);
 	oscap_free(cache);
 	return;
 }
 
-int probe_rcache_sexp_add(probe_rcache_t *cache, const SEXP_t *id, SEXP_t *item)
+void probe_rcache_setlimits(probe_rcache_t *cache, size_t max_count, size_t max_bytes)
 {
-        SEXP_t *r;
-        char   *k;
+        pthread_mutex_lock(&cache->lock);
+        cache->max_count = max_count;
+        cache->max_bytes = max_bytes;
+        pthread_mutex_unlock(&cache->lock);
+}
+
+static void probe_rcache_lru_unlink(probe_rcache_t *cache, probe_rcache_entry_t *e)
+{
+        if (e->prev != NULL)
+                e->prev->next = e->next;
+        else
+                cache->lru_head = e->next;
+
+        if (e->next != NULL)
+                e->next->prev = e->prev;
+        else
+                cache->lru_tail = e->prev;
+
+        e->prev = e->next = NULL;
+}
+
+static void probe_rcache_lru_push(probe_rcache_t *cache, probe_rcache_entry_t *e)
+{
+        e->prev = NULL;
+        e->next = cache->lru_head;
+
+        if (cache->lru_head != NULL)
+                cache->lru_head->prev = e;
+        else
+                cache->lru_tail = e;
+
+        cache->lru_head = e;
+}
+
+/*
+ * Release the S-exp of the least recently used entry. Entries without
+ * a source object are removed from the tree, the others are kept so
+ * that the source object can be looked up later. Must be called with
+ * the cache lock held.
+ */
+static size_t probe_rcache_evict_tail(probe_rcache_t *cache)
+{
+        probe_rcache_entry_t *e = cache->lru_tail;
+        size_t size;
+
+        _A(e != NULL && e->item != NULL);
+
+        probe_rcache_lru_unlink(cache, e);
+        size = e->size;
+
+        cache->stats.count -= 1;
+        cache->stats.bytes -= size;
+        cache->stats.evicted++;
+
+        dD("rcache: evicting %s (%zu bytes)", e->key, size);
+
+        SEXP_free(e->item);
+        e->item = NULL;
+        e->size = 0;
+
+        if (e->src == NULL) {
+                void *data = NULL;
+
+                rbt_str_del(cache->tree, e->key, &data);
+                _A(data == e);
+                oscap_free(e->key);
+                oscap_free(e);
+        }
+
+        return (size);
+}
+
+/*
+ * Evict entries until the cache fits into its limits. The most recently
+ * used entry is always kept. Must be called with the cache lock held.
+ */
+static void probe_rcache_enforce_limits(probe_rcache_t *cache)
+{
+        while (cache->lru_tail != cache->lru_head &&
+               ((cache->max_count > 0 && cache->stats.count > cache->max_count) ||
+                (cache->max_bytes > 0 && cache->stats.bytes > cache->max_bytes)))
+        {
+                probe_rcache_evict_tail(cache);
+        }
+}
+
+int probe_rcache_sexp_add(probe_rcache_t *cache, const SEXP_t *id, SEXP_t *item, SEXP_t *src)
+{
+        probe_rcache_entry_t *e;
+        char *k;
 
 	assume_d(cache != NULL, -1);
 	assume_d(id    != NULL, -1);
 	assume_d(item  != NULL, -1);
 
         k = SEXP_string_cstr(id);
-        r = SEXP_ref(item);
 
-        if (rbt_str_add(cache->tree, k, (void *)r) != 0) {
-                SEXP_free(r);
-                oscap_free(k);
+        if (k == NULL)
                 return (-1);
+
+        pthread_mutex_lock(&cache->lock);
+
+        if (rbt_str_get(cache->tree, k, (void *)&e) == 0) {
+                oscap_free(k);
+
+                if (e->item != NULL) {
+                        /* already cached */
+                        pthread_mutex_unlock(&cache->lock);
+                        return (-1);
+                }
+                /* revive an evicted entry */
+        } else {
+                e = oscap_talloc(probe_rcache_entry_t);
+                e->key  = k;
+                e->src  = NULL;
+                e->prev = e->next = NULL;
+
+                if (rbt_str_add(cache->tree, k, (void *)e) != 0) {
+                        pthread_mutex_unlock(&cache->lock);
+                        oscap_free(e);
+                        oscap_free(k);
+                        return (-1);
+                }
         }
 
+        e->item = SEXP_ref(item);
+        e->size = SEXP_sizeof(item);
+
+        if (e->src == NULL && src != NULL)
+                e->src = SEXP_ref(src);
+
+        probe_rcache_lru_push(cache, e);
+
+        cache->stats.count += 1;
+        cache->stats.bytes += e->size;
+
+        probe_rcache_enforce_limits(cache);
+        pthread_mutex_unlock(&cache->lock);
+
 	return (0);
 }
 
@@ -92,10 +240,34 @@ int probe_rcache_cstr_del(probe_rcache_t *cache, const char *id)
 	return (-1);
 }
 
+SEXP_t *probe_rcache_cstr_get(probe_rcache_t *cache, const char *k)
+{
+        probe_rcache_entry_t *e = NULL;
+        SEXP_t *r = NULL;
+
+        pthread_mutex_lock(&cache->lock);
+
+        if (rbt_str_get(cache->tree, k, (void *)&e) == 0 && e->item != NULL) {
+                /* move the entry to the front of the LRU list */
+                if (cache->lru_head != e) {
+                        probe_rcache_lru_unlink(cache, e);
+                        probe_rcache_lru_push(cache, e);
+                }
+
+                r = SEXP_ref(e->item);
+                cache->stats.hit++;
+        } else
+                cache->stats.miss++;
+
+        pthread_mutex_unlock(&cache->lock);
+
+        return (r);
+}
+
 SEXP_t *probe_rcache_sexp_get(probe_rcache_t *cache, const SEXP_t * id)
 {
         char    b[128], *k = b;
-        SEXP_t *r = NULL;
+        SEXP_t *r;
 
         if (SEXP_string_cstr_r(id, k, sizeof b) == ((size_t)-1))
                 k = SEXP_string_cstr(id);
@@ -103,19 +275,61 @@ SEXP_t *probe_rcache_sexp_get(probe_rcache_t *cache, const SEXP_t * id)
         if (k == NULL)
                 return(NULL);
 
-        rbt_str_get(cache->tree, k, (void *)&r);
+        r = probe_rcache_cstr_get(cache, k);
 
         if (k != b)
                 oscap_free(k);
 
-        return (r != NULL ? SEXP_ref(r) : NULL);
+        return (r);
 }
 
-SEXP_t *probe_rcache_cstr_get(probe_rcache_t *cache, const char *k)
+SEXP_t *probe_rcache_sexp_getsrc(probe_rcache_t *cache, const SEXP_t *id)
 {
+        probe_rcache_entry_t *e = NULL;
+        char    b[128], *k = b;
         SEXP_t *r = NULL;
 
-        rbt_str_get(cache->tree, k, (void *)&r);
+        if (SEXP_string_cstr_r(id, k, sizeof b) == ((size_t)-1))
+                k = SEXP_string_cstr(id);
 
-        return (r != NULL ? SEXP_ref(r) : NULL);
+        if (k == NULL)
+                return(NULL);
+
+        pthread_mutex_lock(&cache->lock);
+
+        if (rbt_str_get(cache->tree, k, (void *)&e) == 0 && e->src != NULL)
+                r = SEXP_ref(e->src);
+
+        pthread_mutex_unlock(&cache->lock);
+
+        if (k != b)
+                oscap_free(k);
+
+        return (r);
+}
+
+size_t probe_rcache_evict(probe_rcache_t *cache, size_t bytes)
+{
+        size_t count = 0, released = 0;
+
+        pthread_mutex_lock(&cache->lock);
+
+        while (cache->lru_tail != NULL && released < bytes) {
+                released += probe_rcache_evict_tail(cache);
+                ++count;
+        }
+
+        pthread_mutex_unlock(&cache->lock);
+
+        if (count > 0)
+                dI("rcache: evicted %zu results, ~%zu bytes released", count, released);
+
+        return (count);
+}
+
+void probe_rcache_stats(probe_rcache_t *cache, probe_rcache_stats_t *stats)
+{
+        pthread_mutex_lock(&cache->lock);
+        *stats = cache->stats;
+        pthread_mutex_unlock(&cache->lock);
 }
@@ -23,14 +23,57 @@
 #define RCACHE_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
 #include <sexp.h>
 #include "../SEAP/generic/rbt/rbt.h"
 
+/*
+ * Environment variables limiting the number of cached results and their
+ * estimated size in bytes. They override the limits set by the probe.
+ */
+#define PROBE_RCACHE_MAX_COUNT_ENV "OSCAP_PROBE_RCACHE_MAX_COUNT"
+#define PROBE_RCACHE_MAX_BYTES_ENV "OSCAP_PROBE_RCACHE_MAX_BYTES"
+
+/**
+ * Probe cache entry. Entries are kept on a LRU list ordered from the most
+ * recently used one. When an entry is evicted, the cached S-exp is released
+ * but the entry itself is kept if the source object is known so that the
+ * result can be collected again.
+ */
+typedef struct probe_rcache_entry probe_rcache_entry_t;
+
+struct probe_rcache_entry {
+        char   *key;  /**< id of the cached S-exp */
+        SEXP_t *item; /**< cached S-exp or NULL if it was evicted */
+        SEXP_t *src;  /**< object for which the S-exp was collected (optional) */
+        size_t  size; /**< estimated memory usage of the cached S-exp */
+        probe_rcache_entry_t *prev; /**< LRU list: more recently used entry */
+        probe_rcache_entry_t *next; /**< LRU list: less recently used entry */
+};
+
+/**
+ * Probe cache statistics.
+ */
+typedef struct {
+        uint64_t hit;     /**< number of lookups that found a cached S-exp */
+        uint64_t miss;    /**< number of lookups that didn't */
+        uint64_t evicted; /**< number of evicted S-exps */
+        size_t   count;   /**< number of currently cached S-exps */
+        size_t   bytes;   /**< estimated memory usage of the cached S-exps */
+} probe_rcache_stats_t;
+
 /**
  * Probe cache structure.
  */
 typedef struct {
+        pthread_mutex_t lock;  /**< protects the LRU list, limits & stats */
         rbt_t *tree; /**< red-black tree used to store the items */
+        probe_rcache_entry_t *lru_head; /**< most recently used entry */
+        probe_rcache_entry_t *lru_tail; /**< least recently used entry */
+        size_t max_count; /**< maximal number of cached S-exps, 0 = unlimited */
+        size_t max_bytes; /**< maximal memory usage of the cached S-exps, 0 = unlimited */
+        probe_rcache_stats_t stats;
 } probe_rcache_t;
 
 /**
@@ -46,15 +89,27 @@ probe_rcache_t *probe_rcache_new(void);
  */
 void probe_rcache_free(probe_rcache_t *cache);
 
+/**
+ * Set the size limits of the cache. Least recently used S-exps are
+ * evicted when the limits are exceeded.
+ * @param cache probe cache
+ * @param max_count maximal number of cached S-exps, 0 = unlimited
+ * @param max_bytes maximal estimated memory usage of the cached S-exps, 0 = unlimited
+ */
+void probe_rcache_setlimits(probe_rcache_t *cache, size_t max_count, size_t max_bytes);
+
 /**
  * Add a new S-exp to the cache identified by an S-exp string.
  * @param cache probe cache
  * @param id S-exp string object containing the id
  * @param item the S-exp (item) to be stored in the cache
+ * @param src the object for which the item was collected or NULL. The object
+ *            is kept in the cache even if the item gets evicted, see
+ *            probe_rcache_sexp_getsrc().
  * @retval 0 on success
  * @retval -1 on failure
  */
-int probe_rcache_sexp_add(probe_rcache_t *cache, const SEXP_t *id, SEXP_t *item);
+int probe_rcache_sexp_add(probe_rcache_t *cache, const SEXP_t *id, SEXP_t *item, SEXP_t *src);
 
 /**
  * Add a new S-exp to the cache identified by a C string.
@@ -105,4 +160,29 @@ SEXP_t *probe_rcache_sexp_get(probe_rcache_t *cache, const SEXP_t *id);
  */
 SEXP_t *probe_rcache_cstr_get(probe_rcache_t *cache, const char *id);
 
+/**
+ * Get a reference to the source object of an S-exp identified by an S-exp
+ * string. The source object is available also after the S-exp was evicted.
+ * @param cache probe cache
+ * @param id S-exp string object containing the id
+ * @retval S-exp reference to the source object or NULL if it's not known
+ */
+SEXP_t *probe_rcache_sexp_getsrc(probe_rcache_t *cache, const SEXP_t *id);
+
+/**
+ * Evict least recently used S-exps until at least the specified amount of
+ * memory is released or the cache is empty.
+ * @param cache probe cache
+ * @param bytes the amount of memory (estimate) to release
+ * @return the number of evicted S-exps
+ */
+size_t probe_rcache_evict(probe_rcache_t *cache, size_t bytes);
+
+/**
+ * Get the cache statistics.
+ * @param cache probe cache
+ * @param stats where to store the statistics
+ */
+void probe_rcache_stats(probe_rcache_t *cache, probe_rcache_stats_t *stats);
+
 #endif /* PROBE_RCACHE_H */
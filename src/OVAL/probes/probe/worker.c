@@ -40,72 +40,57 @@
 extern bool  OSCAP_GSYM(varref_handling);
 extern void *OSCAP_GSYM(probe_arg);
 
-void *probe_worker_runfn(void *arg)
+/*
+ * Evaluate a single request, store the result in the result cache and
+ * send the reply to the library.
+ */
+static void probe_worker_handle(probe_wpool_t *pool, SEAP_msg_t *msg)
 {
-	probe_pwpair_t *pair = (probe_pwpair_t *)arg;
+	probe_t *probe = pool->probe;
+	SEXP_t  *probe_res, *obj, *oid, *items;
+	int      probe_ret;
 
-	SEXP_t *probe_res, *obj, *oid;
-	int     probe_ret;
-
-#if defined(HAVE_PTHREAD_SETNAME_NP)
-	pthread_setname_np(pthread_self(), "probe_worker");
-#endif
-	dD("handling SEAP message ID %u", pair->pth->sid);
+	dD("handling SEAP message ID %u", SEAP_msg_id(msg));
 	//
 	probe_ret = -1;
-	probe_res = pair->pth->msg_handler(pair->probe, pair->pth->msg, &probe_ret);
+	probe_res = pool->msg_handler(probe, msg, &probe_ret);
 	//
 	dD("handler result = %p, return code = %d", probe_res, probe_ret);
 
-	/* Assuming that the red-black tree API is doing locking for us... */
-	if (rbt_i32_del(pair->probe->workers, pair->pth->sid, NULL) != 0) {
-		dW("thread not found in the probe thread tree, probably canceled by an external signal");
-		/*
-		 * XXX: this is a possible deadlock; we can't send anything from
-		 * here because the signal handler replied to the message
-		 */
-		arg = NULL;
+	obj   = SEAP_msg_get(msg);
+	oid   = probe_obj_getattrval(obj, "id");
+	items = probe_cobj_get_items(probe_res);
 
-                SEAP_msg_free(pair->pth->msg);
-                SEXP_free(probe_res);
-                oscap_free(pair);
-
-                return (NULL);
-	} else {
-                SEXP_t *items;
-
-		dD("probe thread deleted");
-
-		obj = SEAP_msg_get(pair->pth->msg);
-		oid = probe_obj_getattrval(obj, "id");
-                items = probe_cobj_get_items(probe_res);
-
-                if (items != NULL) {
-                        SEXP_list_sort(items, SEXP_refcmp);
-                        SEXP_free(items);
-                }
+	if (items != NULL) {
+		SEXP_list_sort(items, SEXP_refcmp);
+		SEXP_free(items);
+	}
 
-		if (probe_rcache_sexp_add(pair->probe->rcache, oid, probe_res) != 0) {
-			/* TODO */
-			abort();
-		}
+	if (probe_rcache_sexp_add(probe->rcache, oid, probe_res, obj) != 0) {
+		dE("Can't add the result of the object to the result cache");
 
-		SEXP_vfree(obj, oid, NULL);
+		/* don't report a collected object which the probe can't serve later */
+		if (probe_ret == 0)
+			probe_ret = PROBE_EUNKNOWN;
 	}
 
+	SEXP_vfree(obj, oid, NULL);
+
 	if (probe_ret != 0) {
 		/*
 		 * Something bad happened. A hint of the cause is stored as a error code in
 		 * probe_ret (should be). We'll send it to the library using a SEAP error packet.
 		 */
-		if (SEAP_replyerr(pair->probe->SEAP_ctx, pair->probe->sd, pair->pth->msg, probe_ret) == -1) {
+		if (SEAP_replyerr(probe->SEAP_ctx, probe->sd, msg, probe_ret) == -1) {
 			int ret = errno;
 
 			dE("An error ocured while sending error status. errno=%u, %s.", errno, strerror(errno));
-			SEXP_free(probe_res);
 
 			/* FIXME */
-			exit(ret);
+			if (!(probe->flags & PROBE_FLAG_INPROCESS)) {
+				SEXP_free(probe_res);
+				exit(ret);
+			}
 		}
 		SEXP_free(probe_res);
 	} else {
@@ -116,37 +101,426 @@ void *probe_worker_runfn(void *arg)
 		seap_reply = SEAP_msg_new();
 		SEAP_msg_set(seap_reply, probe_res);
 
-		if (SEAP_reply(pair->probe->SEAP_ctx, pair->probe->sd, seap_reply, pair->pth->msg) == -1) {
+		if (SEAP_reply(probe->SEAP_ctx, probe->sd, seap_reply, msg) == -1) {
 			int ret = errno;
 
 			SEAP_msg_free(seap_reply);
 			SEXP_free(probe_res);
 
+			/* the library closed the probe, don't take it down */
+			if (probe->flags & PROBE_FLAG_INPROCESS) {
+				dE("An error ocured while sending the reply. errno=%u, %s.", ret, strerror(ret));
+				return;
+			}
+
 			exit(ret);
 		}
 
 		SEAP_msg_free(seap_reply);
-                SEXP_free(probe_res);
+		SEXP_free(probe_res);
 	}
+}
+
+/*
+ * Free a request and its message. Also a cleanup handler of a worker
+ * thread canceled while it handles the request.
+ */
+static void probe_wqitem_free(void *arg)
+{
+	probe_wqitem_t *item = (probe_wqitem_t *)arg;
+
+	SEAP_msg_free(item->msg);
+	oscap_free(item);
+}
+
+static void probe_wpool_unlock(void *arg)
+{
+	pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+static void probe_wdeque_push(probe_wdeque_t *dq, probe_wqitem_t *item)
+{
+	pthread_mutex_lock(&dq->lock);
+
+	item->next = NULL;
+	item->prev = dq->tail;
+
+	if (dq->tail != NULL)
+		dq->tail->next = item;
+	else
+		dq->head = item;
+
+	dq->tail = item;
+	++dq->count;
+
+	pthread_mutex_unlock(&dq->lock);
+}
+
+/*
+ * Take the oldest request from the deque. Used by the owner thread.
+ */
+static probe_wqitem_t *probe_wdeque_pop(probe_wdeque_t *dq)
+{
+	probe_wqitem_t *item;
+
+	pthread_mutex_lock(&dq->lock);
+
+	if ((item = dq->head) != NULL) {
+		dq->head = item->next;
+
+		if (dq->head != NULL)
+			dq->head->prev = NULL;
+		else
+			dq->tail = NULL;
+
+		--dq->count;
+	}
+
+	pthread_mutex_unlock(&dq->lock);
+
+	return (item);
+}
+
+/*
+ * Take the newest request from the deque. Used by idle threads.
+ */
+static probe_wqitem_t *probe_wdeque_steal(probe_wdeque_t *dq)
+{
+	probe_wqitem_t *item;
+
+	pthread_mutex_lock(&dq->lock);
 
-        SEAP_msg_free(pair->pth->msg);
-        oscap_free(pair->pth);
-	oscap_free(pair);
-	pthread_detach(pthread_self());
+	if ((item = dq->tail) != NULL) {
+		dq->tail = item->prev;
+
+		if (dq->tail != NULL)
+			dq->tail->next = NULL;
+		else
+			dq->head = NULL;
+
+		--dq->count;
+	}
+
+	pthread_mutex_unlock(&dq->lock);
+
+	return (item);
+}
+
+/*
+ * Take a request for the calling thread, either from its own deque or
+ * from the deque of another thread. Must be called with pool->lock held
+ * so that queue_depth always matches the number of queued requests.
+ */
+static probe_wqitem_t *probe_wpool_take(probe_wthread_t *self)
+{
+	probe_wpool_t  *pool = self->pool;
+	probe_wqitem_t *item;
+	uint32_t        i, cnt;
+
+	if ((item = probe_wdeque_pop(&self->deque)) != NULL)
+		goto taken;
+
+	cnt = pool->thread_cnt;
+
+	for (i = 1; i < cnt; ++i) {
+		probe_wthread_t *victim = pool->thread[(self->index + i) % cnt];
+
+		if ((item = probe_wdeque_steal(&victim->deque)) != NULL) {
+			dD("thread #%u: stole a request from thread #%u", self->index, victim->index);
+			goto taken;
+		}
+	}
+
+	return (NULL);
+taken:
+	--pool->queue_depth;
+	return (item);
+}
+
+static void probe_wpool_handle(probe_wpool_t *pool, probe_wqitem_t *item)
+{
+	pthread_cleanup_push(probe_wqitem_free, item);
+	probe_worker_handle(pool, item->msg);
+	pthread_cleanup_pop(1);
+}
+
+static void *probe_wpool_worker(void *arg)
+{
+	probe_wthread_t *self = (probe_wthread_t *)arg;
+	probe_wpool_t   *pool = self->pool;
+	probe_wqitem_t  *item;
+
+#if defined(HAVE_PTHREAD_SETNAME_NP)
+	pthread_setname_np(pthread_self(), "probe_worker");
+#endif
+	dD("worker thread #%u ready", self->index);
+
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		pthread_cleanup_push(probe_wpool_unlock, &pool->lock);
+
+		++pool->idle_cnt;
+
+		while ((item = probe_wpool_take(self)) == NULL)
+			pthread_cond_wait(&pool->wakeup, &pool->lock);
+
+		--pool->idle_cnt;
+
+		pthread_cleanup_pop(1);
+
+		probe_wpool_handle(pool, item);
+	}
 
 	return (NULL);
 }
 
-probe_worker_t *probe_worker_new(void)
+/*
+ * Start a new worker thread. Must be called with pool->lock held.
+ */
+static int probe_wpool_spawn(probe_wpool_t *pool)
+{
+	probe_wthread_t *thr;
+
+	if (pool->thread_cnt >= pool->thread_cap)
+		return (-1);
+
+	thr = oscap_talloc(probe_wthread_t);
+	thr->pool   = pool;
+	thr->index  = pool->thread_cnt;
+	thr->joined = false;
+	thr->deque.head  = NULL;
+	thr->deque.tail  = NULL;
+	thr->deque.count = 0;
+
+	pthread_mutex_init(&thr->deque.lock, NULL);
+
+	if ((errno = pthread_create(&thr->tid, NULL, &probe_wpool_worker, thr)) != 0) {
+		dE("Cannot start a new worker thread: %d, %s.", errno, strerror(errno));
+		pthread_mutex_destroy(&thr->deque.lock);
+		oscap_free(thr);
+		return (-1);
+	}
+
+	pool->thread[pool->thread_cnt++] = thr;
+	dD("started worker thread #%u", thr->index);
+
+	return (0);
+}
+
+probe_wpool_t *probe_wpool_new(probe_t *probe, uint32_t max_threads, uint32_t max_chdepth)
+{
+	probe_wpool_t *pool;
+
+	assume_d(max_threads > 0, NULL);
+
+	pool = oscap_talloc(probe_wpool_t);
+	pool->probe = probe;
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->wakeup, NULL);
+
+	/*
+	 * Threads blocked in a set evaluation wait for the library, which may
+	 * send new requests to this probe. Every thread may be blocked up to
+	 * max_chdepth levels deep, so reserve room for spare threads.
+	 */
+	pool->thread_max = max_threads;
+	pool->thread_cap = max_threads * (max_chdepth > 0 ? max_chdepth : 1);
+	pool->thread     = oscap_alloc(sizeof(probe_wthread_t *) * pool->thread_cap);
+	pool->thread_cnt = 0;
+	pool->idle_cnt    = 0;
+	pool->blocked_cnt = 0;
+	pool->next_push   = 0;
+	pool->queue_depth     = 0;
+	pool->queue_depth_max = 0;
+	pool->msg_handler = &probe_worker;
+
+	dD("worker pool: max. threads=%u, max. chain depth=%u", max_threads, max_chdepth);
+
+	return (pool);
+}
+
+/**
+ * Queue a request for evaluation. On success, the pool takes ownership
+ * of the message.
+ */
+int probe_wpool_submit(probe_wpool_t *pool, SEAP_msg_t *msg)
+{
+	probe_wqitem_t  *item;
+	probe_wthread_t *thr;
+
+	item = oscap_talloc(probe_wqitem_t);
+	item->msg = msg;
+
+	pthread_mutex_lock(&pool->lock);
+
+	/*
+	 * Start a new thread only if there isn't an idle one which would
+	 * take the request and the number of running threads allows it.
+	 */
+	if (pool->idle_cnt <= pool->queue_depth
+	    && pool->thread_cnt - pool->blocked_cnt < pool->thread_max)
+	{
+		if (probe_wpool_spawn(pool) != 0 && pool->thread_cnt == 0) {
+			pthread_mutex_unlock(&pool->lock);
+			oscap_free(item);
+			return (-1);
+		}
+	}
+
+	thr = pool->thread[pool->next_push++ % pool->thread_cnt];
+	probe_wdeque_push(&thr->deque, item);
+
+	if (++pool->queue_depth > pool->queue_depth_max)
+		pool->queue_depth_max = pool->queue_depth;
+
+	pthread_cond_signal(&pool->wakeup);
+	pthread_mutex_unlock(&pool->lock);
+
+	return (0);
+}
+
+/**
+ * Get the number of queued requests which weren't taken by a thread yet.
+ */
+uint32_t probe_wpool_queue_depth(probe_wpool_t *pool)
+{
+	uint32_t depth;
+
+	pthread_mutex_lock(&pool->lock);
+	depth = pool->queue_depth;
+	pthread_mutex_unlock(&pool->lock);
+
+	return (depth);
+}
+
+/**
+ * Mark the calling worker thread as waiting for the library. If all threads
+ * are waiting, a spare thread is started so that requests sent by the library
+ * in the meantime (e.g. objects referenced by a set) are handled.
+ */
+void probe_wpool_block(probe_wpool_t *pool)
 {
-	probe_worker_t *pth = oscap_talloc(probe_worker_t);
+	pthread_mutex_lock(&pool->lock);
 
-	pth->sid = 0;
-	pth->tid = 0;
-	pth->msg_handler = NULL;
-	pth->msg = NULL;
+	if (++pool->blocked_cnt >= pool->thread_cnt) {
+		if (probe_wpool_spawn(pool) != 0)
+			dW("All %u worker threads are blocked and no spare thread can be started.",
+			   pool->thread_cnt);
+	}
+
+	pthread_mutex_unlock(&pool->lock);
+}
 
-	return (pth);
+void probe_wpool_unblock(probe_wpool_t *pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	--pool->blocked_cnt;
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Cancel all worker threads and wait until they finish (they may temporarily
+ * disable cancelability), but at most 60 seconds per thread.
+ */
+void probe_wpool_cancel(probe_wpool_t *pool)
+{
+	uint32_t i, cnt;
+
+	pthread_mutex_lock(&pool->lock);
+	cnt = pool->thread_cnt;
+	pthread_mutex_unlock(&pool->lock);
+
+	for (i = 0; i < cnt; ++i) {
+		if (!pool->thread[i]->joined)
+			pthread_cancel(pool->thread[i]->tid);
+	}
+
+	for (i = 0; i < cnt; ++i) {
+		probe_wthread_t *thr = pool->thread[i];
+
+		if (thr->joined)
+			continue;
+#if defined(HAVE_PTHREAD_TIMEDJOIN_NP) && defined(HAVE_CLOCK_GETTIME)
+		struct timespec j_tm;
+
+		if (clock_gettime(CLOCK_REALTIME, &j_tm) == -1) {
+			dE("clock_gettime(CLOCK_REALTIME): %d, %s.", errno, strerror(errno));
+			continue;
+		}
+
+		j_tm.tv_sec += 60;
+
+		if ((errno = pthread_timedjoin_np(thr->tid, NULL, &j_tm)) != 0) {
+			dE("[#%u] pthread_timedjoin_np: %d, %s.", thr->index, errno, strerror(errno));
+			/*
+			 * Memory will be leaked here by continuing to the next thread. However, we are in the
+			 * process of shutting down the whole probe. We're just nice and gave the probe_main()
+			 * thread a chance to finish it's critical section which shouldn't take that long...
+			 */
+			continue;
+		}
+#else
+		if ((errno = pthread_join(thr->tid, NULL)) != 0) {
+			dE("pthread_join: %d, %s.", errno, strerror(errno));
+			continue;
+		}
+#endif
+		thr->joined = true;
+	}
+}
+
+/**
+ * Cancel the worker threads and free the pool. Returns -1 if some of the
+ * threads didn't finish, the pool is left allocated then.
+ */
+int probe_wpool_free(probe_wpool_t *pool)
+{
+	probe_wqitem_t *item;
+	uint32_t i, running;
+
+	if (pool == NULL)
+		return (0);
+
+	probe_wpool_cancel(pool);
+
+	dD("worker pool: threads=%u, max. queue depth=%u", pool->thread_cnt, pool->queue_depth_max);
+
+	for (i = 0; i < pool->thread_cnt; ++i) {
+		probe_wthread_t *thr = pool->thread[i];
+
+		while ((item = probe_wdeque_pop(&thr->deque)) != NULL)
+			probe_wqitem_free(item);
+	}
+
+	for (running = 0, i = 0; i < pool->thread_cnt; ++i) {
+		if (!pool->thread[i]->joined)
+			++running;
+	}
+
+	if (running > 0) {
+		/*
+		 * The threads which didn't finish still use the pool (they steal
+		 * from the deques of the other threads and wait on its condition),
+		 * so leak it rather than free memory they may touch.
+		 */
+		dW("%u worker thread(s) didn't finish, leaking the worker pool.", running);
+		return (-1);
+	}
+
+	for (i = 0; i < pool->thread_cnt; ++i) {
+		probe_wthread_t *thr = pool->thread[i];
+
+		pthread_mutex_destroy(&thr->deque.lock);
+		oscap_free(thr);
+	}
+
+	oscap_free(pool->thread);
+	pthread_cond_destroy(&pool->wakeup);
+	pthread_mutex_destroy(&pool->lock);
+	oscap_free(pool);
+
+	return (0);
 }
 
 struct probe_varref_ctx {
@@ -338,7 +712,7 @@ static SEXP_t *probe_ste_fetch(probe_t *probe, SEXP_t *id_list)
 		_A(id != NULL);
 		_A(ste != NULL);
 
-		if (probe_rcache_sexp_add(probe->rcache, id, ste) != 0) {
+		if (probe_rcache_sexp_add(probe->rcache, id, ste, NULL) != 0) {
 
 			SEXP_free(res);
 			SEXP_free(ste);
@@ -354,29 +728,79 @@ static SEXP_t *probe_ste_fetch(probe_t *probe, SEXP_t *id_list)
 	return (res);
 }
 
+/**
+ * Collect an object again in the calling thread. This is used when the
+ * result of the object was evicted from the probe cache. The library
+ * won't send the object again because it already has its result.
+ * @param id the id of the OVAL object
+ * @param obj the OVAL object
+ * @return the result of the evaluation of the object
+ */
+static SEXP_t *probe_obj_recollect(probe_t *probe, SEXP_t *id, SEXP_t *obj)
+{
+	SEAP_msg_t *msg;
+	SEXP_t *res, *items;
+	int ret = -1;
+
+	msg = SEAP_msg_new();
+	SEAP_msg_set(msg, obj);
+
+	res = probe_worker(probe, msg, &ret);
+	SEAP_msg_free(msg);
+
+	if (res == NULL)
+		return (NULL);
+
+	items = probe_cobj_get_items(res);
+
+	if (items != NULL) {
+		SEXP_list_sort(items, SEXP_refcmp);
+		SEXP_free(items);
+	}
+	/*
+	 * Another thread might have collected the same object in the
+	 * meantime. The result is used anyway.
+	 */
+	if (probe_rcache_sexp_add(probe->rcache, id, res, obj) != 0)
+		dD("The result is already cached");
+
+	return (res);
+}
+
 /**
  * Evaluate an OVAL object identified by its id. Using a remote
  * synchronous SEAP command, this function executes evaluation of an
  * OVAL object which results weren't found in the probe cache. This
- * indirectly spawns a new thread in the probe process which evaluates
+ * indirectly queues a new request in the probe's worker pool which evaluates
  * the object and stores the result in the probe cache. That result is
  * not send to the library because it doesn't know how to handle
  * it. Instead, the result is fetched by this function from the cache
- * and returned to the caller.
+ * and returned to the caller. If the result was evicted from the cache,
+ * the object is collected again.
  * @param id the id of the OVAL object to be evaluated
  * @return the result of the evaluation of the object or NULL on failure
  */
 static SEXP_t *probe_obj_eval(probe_t *probe, SEXP_t *id)
 {
-	SEXP_t *res, *rid;
+	SEXP_t *res, *rid, *obj;
 
+	probe_wpool_block(probe->workers);
 	res = SEAP_cmd_exec(probe->SEAP_ctx, probe->sd, 0, PROBECMD_OBJ_EVAL, id, SEAP_CMDTYPE_SYNC, NULL, NULL);
+	probe_wpool_unblock(probe->workers);
 
 	rid = SEXP_list_first(res);
 	assume_r(SEXP_string_cmp(id, rid) == 0, NULL);
 	SEXP_vfree(res, rid, NULL);
 
-	return probe_rcache_sexp_get(probe->rcache, id);
+	res = probe_rcache_sexp_get(probe->rcache, id);
+
+	if (res == NULL && (obj = probe_rcache_sexp_getsrc(probe->rcache, id)) != NULL) {
+		dD("The result was evicted from the cache, collecting the object again");
+		res = probe_obj_recollect(probe, id, obj);
+		SEXP_free(obj);
+	}
+
+	return (res);
 }
 
 static SEXP_t *probe_prepare_filters(probe_t *probe, SEXP_t *obj)
@@ -628,6 +1052,7 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
 
 	SEXP_t *op_val;
 	int op_num;
+	uint32_t i;
 
 	SEXP_t *r0, *r1, *result, *Omsg = NULL;
 
@@ -800,20 +1225,24 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
 					"%s: Can't get unavailable filters.", __FUNCTION__);
 		goto eval_fail;
 	}
-	SEXP_vfree(filters_req, result, NULL);
+	SEXP_free(filters_req);
 
+	/*
+	 * Use the fetched states directly, they might have been already
+	 * evicted from the cache.
+	 */
+	i = 1;
 	SEXP_list_foreach(member, filters_u) {
-		SEXP_t *id, *act, *ste;
+		SEXP_t *act, *ste;
 
 		act = SEXP_list_first(member);
-		id = SEXP_list_nth(member, 2);
-		ste = probe_rcache_sexp_get(probe->rcache, id);
+		ste = SEXP_list_nth(result, i++);
 		r0 = SEXP_list_new(act, ste, NULL);
 		SEXP_list_add(filters_a, r0);
-		SEXP_vfree(act, id, ste, r0, NULL);
+		SEXP_vfree(act, ste, r0, NULL);
 	}
 
-	SEXP_free(filters_u);
+	SEXP_vfree(filters_u, result, NULL);
 
 	_A((s_subset_i > 0 && o_subset_i == 0) || (s_subset_i == 0 && o_subset_i > 0));
 
@@ -888,6 +1317,48 @@ static SEXP_t *probe_set_eval(probe_t *probe, SEXP_t *set, size_t depth)
 	return result;
 }
 
+static void probe_main_unlock(void *arg)
+{
+	if (arg != NULL)
+		pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+/*
+ * Run the main function of the probe implementation. The library
+ * may have several requests for the probe in flight, so the calls
+ * are serialized unless the probe set the PROBEOPT_MULTITHREADED
+ * option. With `async' set the thread cancelation type is switched
+ * to ASYNC to prevent the code in probe_main to defer the cancelation
+ * for too long. This is done only in a probe process: a probe in the
+ * library process shares the heap & locks of the library, there the
+ * cancelation is deferred to probe_item_collect() and the start of
+ * probe_main.
+ */
+static int probe_main_run(probe_t *probe, struct probe_ctx *pctx, bool async)
+{
+	int ret, __unused_oldstate;
+	bool locked = !OSCAP_GSYM(multithreaded);
+
+	if (locked)
+		pthread_mutex_lock(&probe->main_lock);
+
+	pthread_cleanup_push(probe_main_unlock, locked ? &probe->main_lock : NULL);
+
+	if (async)
+		pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, &__unused_oldstate);
+	else
+		pthread_testcancel();
+
+	ret = probe_main(pctx, probe->probe_arg);
+
+	if (async)
+		pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, &__unused_oldstate);
+
+	pthread_cleanup_pop(locked);
+
+	return (ret);
+}
+
 /**
  * Worker thread function. This functions handles the evalution of objects and sets.
  * @param msg_in SEAP message with the request which contains the object to be evaluated
@@ -924,6 +1395,7 @@ SEXP_t *probe_worker(probe_t *probe, SEAP_msg_t *msg_in, int *ret)
 
 		/* simple object */
                 pctx.icache  = probe->icache;
+                pctx.rcache  = probe->rcache;
 		pctx.filters = probe_prepare_filters(probe, probe_in);
                 mask = probe_obj_getmask(probe_in);
 
@@ -942,20 +1414,7 @@ SEXP_t *probe_worker(probe_t *probe, SEAP_msg_t *msg_in, int *ret)
                         pctx.probe_in  = probe_in;
                         pctx.probe_out = probe_out;
 
-                        /*
-                         * Run the main function of the probe implementation. Set thread
-			 * cancelation type to ASYNC to prevent the code in probe_main to
-			 * defer the cancelation for too long.
-                         */
-			int __unused_oldstate;
-			pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, &__unused_oldstate);
-			*ret = probe_main(&pctx, probe->probe_arg);
-			pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, &__unused_oldstate);
-
-                        /*
-                         * Synchronize
-                         */
-                        probe_icache_nop(probe->icache);
+			*ret = probe_main_run(probe, &pctx, !(probe->flags & PROBE_FLAG_INPROCESS));
 
 			probe_cobj_compute_flag(probe_out);
 		} else {
@@ -987,12 +1446,7 @@ SEXP_t *probe_worker(probe_t *probe, SEAP_msg_t *msg_in, int *ret)
                                 /*
                                  * Run the main function of the probe implementation
                                  */
-				*ret = probe_main(&pctx, probe->probe_arg);
-
-                                /*
-                                 * Synchronize
-                                 */
-                                probe_icache_nop(probe->icache);
+				*ret = probe_main_run(probe, &pctx, false);
 
 				probe_cobj_compute_flag(cobj);
 				r0 = probe_out;
@@ -25,6 +25,8 @@
 #include <seap.h>
 #include <sexp.h>
 #include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include "probe.h"
 
 #ifndef PROBE_WORKER_DEFAULT_MAX_THREADS
@@ -35,20 +37,71 @@
 # define PROBE_WORKER_DEFAULT_MAX_CHDEPTH 8 /**< maximum depth of a worker thread chain */
 #endif
 
+/*
+ * Environment variables overriding the worker limits set by the probe,
+ * and the highest values accepted for the limits.
+ */
+#define PROBE_WORKER_MAX_THREADS_ENV "OSCAP_PROBE_MAX_THREADS"
+#define PROBE_WORKER_MAX_CHDEPTH_ENV "OSCAP_PROBE_MAX_CHDEPTH"
+#define PROBE_WORKER_THREADS_LIMIT 1024
+#define PROBE_WORKER_CHDEPTH_LIMIT 64
+
+typedef struct probe_wqitem probe_wqitem_t;
+
+struct probe_wqitem {
+	SEAP_msg_t     *msg;  /**< queued request */
+	probe_wqitem_t *next;
+	probe_wqitem_t *prev;
+};
+
+/*
+ * Per-thread work deque. The owner takes requests from the head,
+ * idle threads steal from the tail.
+ */
 typedef struct {
-	SEAP_msgid_t sid; /**< SEAP message handled by this thread */
-	pthread_t    tid; /**< thread ID */
-	SEXP_t * (*msg_handler)(probe_t *, SEAP_msg_t *, int *); /**< input message (object) handler */
-	SEAP_msg_t  *msg; /**< the message being handled */
-} probe_worker_t;
+	pthread_mutex_t lock;
+	probe_wqitem_t *head;
+	probe_wqitem_t *tail;
+	uint32_t        count;
+} probe_wdeque_t;
+
+typedef struct probe_wpool probe_wpool_t;
 
 typedef struct {
-	probe_t        *probe;
-	probe_worker_t *pth;
-} probe_pwpair_t;
+	probe_wpool_t  *pool;   /**< the pool this thread belongs to */
+	pthread_t       tid;    /**< thread ID */
+	uint32_t        index;  /**< index in the pool's thread array */
+	bool            joined; /**< set after the thread was canceled & joined */
+	probe_wdeque_t  deque;  /**< requests assigned to this thread */
+} probe_wthread_t;
+
+struct probe_wpool {
+	probe_t          *probe;
+	pthread_mutex_t   lock;     /**< protects the counters below & the thread array */
+	pthread_cond_t    wakeup;   /**< signaled when a new request is queued */
+
+	probe_wthread_t **thread;   /**< worker threads, preallocated to thread_cap */
+	uint32_t          thread_cnt;
+	uint32_t          thread_max; /**< max. number of threads processing requests */
+	uint32_t          thread_cap; /**< thread_max + spare threads for blocked set evaluations */
+	uint32_t          idle_cnt;   /**< number of threads waiting for a request */
+	uint32_t          blocked_cnt;/**< number of threads waiting for the library */
+	uint32_t          next_push;  /**< round-robin index for new requests */
+
+	uint32_t          queue_depth;     /**< number of requests not yet taken by a thread */
+	uint32_t          queue_depth_max; /**< highest queue depth observed */
+
+	SEXP_t * (*msg_handler)(probe_t *, SEAP_msg_t *, int *); /**< input message (object) handler */
+};
+
+probe_wpool_t *probe_wpool_new(probe_t *probe, uint32_t max_threads, uint32_t max_chdepth);
+int probe_wpool_submit(probe_wpool_t *pool, SEAP_msg_t *msg);
+uint32_t probe_wpool_queue_depth(probe_wpool_t *pool);
+void probe_wpool_block(probe_wpool_t *pool);
+void probe_wpool_unblock(probe_wpool_t *pool);
+void probe_wpool_cancel(probe_wpool_t *pool);
+int probe_wpool_free(probe_wpool_t *pool);
 
-probe_worker_t *probe_worker_new(void);
-void *probe_worker_runfn(void *arg);
 SEXP_t *probe_worker(probe_t *probe, SEAP_msg_t *msg_in, int *ret);
 
 #endif /* WORKER_H */
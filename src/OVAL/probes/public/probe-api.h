@@ -467,6 +467,7 @@ void probe_tfc54behaviors_canonicalize(SEXP_t **behaviors);
 #define PROBECMD_STE_FETCH 1 /**< State fetch command code */
 #define PROBECMD_OBJ_EVAL  2 /**< Object eval command code */
 #define PROBECMD_RESET     3 /**< Reset command code */
+#define PROBECMD_FTS_SINCE 4 /**< Start of the scan for the file probe snapshots */
 
 
 void probe_offline_mode(void);
@@ -251,10 +251,39 @@ static SEXP_t *get_size(struct stat *st, SEXP_t *sexp)
 
 #define MODEP(statp, bit) ((statp)->st_mode & (bit) ? gr_true : gr_false)
 
+#if defined(HAVE_ACL_EXTENDED_FILE)
+/* acl_extended_file() from a snapshot: an access ACL with more entries
+   than the header and the owner, group and other ones or a default ACL */
+static bool snapshot_extended_acl(const OVAL_FTS_SNAPSHOT_XATTRS *sx)
+{
+	size_t len;
+
+	if (oval_fts_snapshot_xattr(sx, "system.posix_acl_access", &len) != NULL && len > 4 + 3 * 8)
+		return true;
+	if (oval_fts_snapshot_xattr(sx, "system.posix_acl_default", &len) != NULL && len >= 4)
+		return true;
+
+	return false;
+}
+#endif
+
 static SEXP_t *has_extended_acl(const char *path)
 {
 #if defined(HAVE_ACL_EXTENDED_FILE)
-	int has_acl = acl_extended_file(path);
+	OVAL_FTS_SNAPSHOT_XATTRS sx;
+	int has_acl;
+
+	/* acl_extended_file() follows symlinks */
+	if (oval_fts_snapshot_xattrs(path, &sx)) {
+		if (!S_ISLNK(sx.st->st_mode)) {
+			has_acl = snapshot_extended_acl(&sx);
+			oval_fts_snapshot_xattrs_free(&sx);
+			return has_acl ? gr_true : gr_false;
+		}
+		oval_fts_snapshot_xattrs_free(&sx);
+	}
+
+	has_acl = acl_extended_file(path);
 	if (has_acl == -1) {
 		dD("Getting extended ACL for file '%s' has failed, %s", path, strerror(errno));
 		return NULL;
@@ -267,7 +296,7 @@ static SEXP_t *has_extended_acl(const char *path)
 #endif
 }
 
-static int file_cb (const char *p, const char *f, void *ptr)
+static int file_cb (const char *p, const char *f, const struct stat *statp, void *ptr)
 {
         char path_buffer[PATH_MAX];
         SEXP_t *item;
@@ -282,7 +311,11 @@ static int file_cb (const char *p, const char *f, void *ptr)
 		st_path = path_buffer;
 	}
 
-        if (lstat (st_path, &st) == -1) {
+	/* the walk got the lstat() already */
+	if (statp != NULL)
+		st = *statp;
+
+        if (statp == NULL && lstat (st_path, &st) == -1) {
                 dI("lstat failed when processing %s: errno=%u, %s.", st_path, errno, strerror (errno));
 		return strncmp(st_path, "/proc", 4) == 0 ? 0 : -1;
         } else {
@@ -506,7 +539,7 @@ int probe_main (probe_ctx *ctx, void *mutex)
 
 	if ((ofts = oval_fts_open(path, filename, filepath, behaviors, probe_ctx_getresult(ctx))) != NULL) {
 		while ((ofts_ent = oval_fts_read(ofts)) != NULL) {
-			if (file_cb(ofts_ent->path, ofts_ent->file, &cbargs) != 0) {
+			if (file_cb(ofts_ent->path, ofts_ent->file, ofts_ent->fts_statp, &cbargs) != 0) {
 				oval_ftsent_free(ofts_ent);
 				break;
 			}
@@ -83,6 +83,58 @@ struct cbargs {
         SEXP_t    *attr_ent;
 };
 
+/* the value of the attribute with a trailing '\0', NULL on error */
+static char *xattr_value(const char *st_path, const char *name, const OVAL_FTS_SNAPSHOT_XATTRS *sx)
+{
+        ssize_t xattr_vallen = -1;
+        char   *xattr_val = NULL;
+
+        if (sx != NULL) {
+                const char *value;
+                size_t value_len;
+
+                value = oval_fts_snapshot_xattr(sx, name, &value_len);
+                if (value == NULL) {
+                        errno = ENODATA;
+                        return (NULL);
+                }
+                xattr_val = oscap_alloc(value_len + 1);
+                memcpy(xattr_val, value, value_len);
+                xattr_val[value_len] = '\0';
+
+                return (xattr_val);
+        }
+
+        xattr_vallen = lgetxattr(st_path, name, NULL, 0);
+retry_value:
+        if (xattr_vallen >= 0) {
+		// Check possible buffer overflow
+		if (sizeof(char) * (xattr_vallen + 1) <= sizeof(char) * xattr_vallen) {
+			dE("Attribute is too long.");
+			abort();
+		}
+
+		// Allocate buffer, '+1' is for trailing '\0'
+		xattr_val    = oscap_realloc(xattr_val, sizeof(char) * (xattr_vallen + 1));
+
+		// we don't want to override space for '\0' by call of 'lgetxattr'
+		// we pass only 'xattr_vallen' instead of 'xattr_vallen + 1'
+                xattr_vallen = lgetxattr(st_path, name, xattr_val, xattr_vallen);
+
+                if (xattr_vallen < 0 || errno == ERANGE)
+                        goto retry_value;
+
+		xattr_val[xattr_vallen] = '\0';
+
+                return (xattr_val);
+        }
+
+        if (xattr_val != NULL)
+                oscap_free(xattr_val);
+
+        return (NULL);
+}
+
 static int file_cb (const char *p, const char *f, void *ptr)
 {
         char path_buffer[PATH_MAX];
@@ -93,6 +145,8 @@ static int file_cb (const char *p, const char *f, void *ptr)
         ssize_t xattr_count = -1;
         char   *xattr_buf = NULL;
         size_t  xattr_buflen = 0, i;
+        OVAL_FTS_SNAPSHOT_XATTRS sx;
+        bool snapshot;
 
 	if (f == NULL) {
 		st_path = p;
@@ -103,7 +157,17 @@ static int file_cb (const char *p, const char *f, void *ptr)
 
         SEXP_init(&xattr_name);
 
-	do {
+	snapshot = oval_fts_snapshot_xattrs(st_path, &sx);
+	if (snapshot) {
+		if (sx.list_len == 0) {
+			oval_fts_snapshot_xattrs_free(&sx);
+			return (0);
+		}
+
+		xattr_buflen = xattr_count = sx.list_len;
+		xattr_buf    = oscap_alloc(sizeof(char) * xattr_buflen);
+		memcpy(xattr_buf, sx.list, xattr_buflen);
+	} else do {
 		/* estimate the size of the buffer */
 		xattr_count = llistxattr(st_path, NULL, 0);
 
@@ -145,30 +209,9 @@ static int file_cb (const char *p, const char *f, void *ptr)
                 SEXP_string_new_r(&xattr_name, xattr_buf + i, strlen(xattr_buf +i));
 
                 if (probe_entobj_cmp(args->attr_ent, &xattr_name) == OVAL_RESULT_TRUE) {
-                        ssize_t xattr_vallen = -1;
-                        char   *xattr_val = NULL;
-
-                        xattr_vallen = lgetxattr(st_path, xattr_buf + i, NULL, 0);
-                retry_value:
-                        if (xattr_vallen >= 0) {
-				// Check possible buffer overflow
-				if (sizeof(char) * (xattr_vallen + 1) <= sizeof(char) * xattr_vallen) {
-					dE("Attribute is too long.");
-					abort();
-				}
-
-				// Allocate buffer, '+1' is for trailing '\0'
- 				xattr_val    = oscap_realloc(xattr_val, sizeof(char) * (xattr_vallen + 1));
-
-				// we don't want to override space for '\0' by call of 'lgetxattr'
-				// we pass only 'xattr_vallen' instead of 'xattr_vallen + 1'
-                                xattr_vallen = lgetxattr(st_path, xattr_buf + i, xattr_val, xattr_vallen);
-
-                                if (xattr_vallen < 0 || errno == ERANGE)
-                                        goto retry_value;
-
-				xattr_val[xattr_vallen] = '\0';
+                        char *xattr_val = xattr_value(st_path, xattr_buf + i, snapshot ? &sx : NULL);
 
+                        if (xattr_val != NULL) {
                                 item = probe_item_create(OVAL_UNIX_FILEEXTENDEDATTRIBUTE, NULL,
                                                          "filepath", OVAL_DATATYPE_STRING, f == NULL ? NULL : st_path,
                                                          "path",     OVAL_DATATYPE_SEXP,  &gr_lastpath,
@@ -183,9 +226,6 @@ static int file_cb (const char *p, const char *f, void *ptr)
 
                                 item = probe_item_create(OVAL_UNIX_FILEEXTENDEDATTRIBUTE, NULL, NULL);
                                 probe_item_setstatus(item, SYSCHAR_STATUS_ERROR);
-
-                                if (xattr_val != NULL)
-                                        oscap_free(xattr_val);
                         }
 
                         probe_item_collect(args->ctx, item); /* XXX: handle ENOMEM */
@@ -200,6 +240,8 @@ static int file_cb (const char *p, const char *f, void *ptr)
         } while (xattr_buf + i < xattr_buf + xattr_buflen - 1);
 
         oscap_free(xattr_buf);
+        if (snapshot)
+                oval_fts_snapshot_xattrs_free(&sx);
 
         return (0);
 }
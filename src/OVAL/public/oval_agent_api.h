@@ -100,6 +100,15 @@ int oval_agent_reset_session(oval_agent_session_t * ag_sess);
  */
 int oval_agent_abort_session(oval_agent_session_t *ag_sess);
 
+/**
+ * Set the number of jobs evaluating definitions in parallel. Definitions which
+ * don't share any tests, objects, states or variables are evaluated concurrently;
+ * the results and the order of the callback calls stay the same as with one job.
+ * The default is 1, or the value of the OSCAP_OVAL_JOBS environment variable.
+ * @param jobs the number of jobs, 0 means one job per CPU
+ */
+void oval_agent_set_jobs(oval_agent_session_t *ag_sess, unsigned int jobs);
+
 typedef int (*agent_reporter)(const struct oval_result_definition * res_def, void *arg);
 
 /**
@@ -623,6 +623,44 @@ struct oval_definition_model *oval_definition_model_new(void);
  */
 struct oval_definition_model *oval_definition_model_import_source(struct oscap_source *source);
 
+/**
+ * Import only the given definitions from the oscap_source into a new oval_definition_model,
+ * together with the tests, objects, states and variables they depend on. The other
+ * entities of the document are indexed by their IDs only and never parsed, so the
+ * model is as big as the selection rather than the whole document.
+ * @memberof oval_definition_model
+ * @param source The oscap_source to import from
+ * @param definitions IDs of the definitions to import, unknown IDs are ignored
+ * @returns newly build oval_definition_model, or NULL if something went wrong
+ */
+struct oval_definition_model *oval_definition_model_import_source_selected(struct oscap_source *source, struct oscap_stringlist *definitions);
+
+/**
+ * Store the oval_definition_model to a binary image in the given directory.
+ * The image is named by the fingerprint of the document the model was
+ * imported from. Once it exists, oval_definition_model_import_source (and
+ * oval_definition_model_import_image) builds the model of the same document
+ * from the image instead of parsing the document, if the directory is named
+ * by the OSCAP_OVAL_IMAGE_DIR environment variable.
+ * @memberof oval_definition_model
+ * @param model The model to store, as imported from the source
+ * @param source The oscap_source the model was imported from, it has to originate
+ * from a file or a memory buffer
+ * @param dir The image directory, created if it doesn't exist
+ * @returns 0 on success, -1 on failure
+ */
+int oval_definition_model_export_image(struct oval_definition_model *model, struct oscap_source *source, const char *dir);
+
+/**
+ * Import the oval_definition_model of the oscap_source from its binary image
+ * in the given directory, see oval_definition_model_export_image.
+ * @memberof oval_definition_model
+ * @param source The oscap_source to import the model of
+ * @param dir The image directory
+ * @returns newly build oval_definition_model, or NULL if there is no valid image
+ */
+struct oval_definition_model *oval_definition_model_import_image(struct oscap_source *source, const char *dir);
+
 /**
  * Import the content from the file into an oval_definition_model.
  * @param file filename
@@ -676,6 +714,15 @@ void oval_definition_model_set_generator(struct oval_definition_model *model, st
 int oval_definition_model_bind_variable_model(struct oval_definition_model *, struct oval_variable_model *);
 
 void oval_definition_model_clear_external_variables(struct oval_definition_model *);
+/**
+ * Limit the number of values a function of a local variable may produce.
+ * Functions combining several arguments (concat, arithmetic) produce one value
+ * for each combination of argument values; a function exceeding the limit
+ * makes the variable evaluate with an error. Zero means no limit. The default
+ * is taken from the OSCAP_OVAL_VALUES_MAX environment variable, or 1000000.
+ * @memberof oval_definition_model
+ */
+void oval_definition_model_set_component_values_max(struct oval_definition_model *model, size_t max);
 /** @} */
 
 /**
@@ -63,6 +63,26 @@ int oval_probe_query_sysinfo(oval_probe_session_t *sess, struct oval_sysinfo **o
  */
 int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *object, int flags, struct oval_syschar **out_syschar) __attribute__ ((nonnull(1, 2)));
 
+/**
+ * Submit an object for evaluation without waiting for the result. Many
+ * objects can be submitted at once; the probes work on them while the
+ * caller does something else. The results are collected in the order
+ * they are completed by @ref oval_probe_query_wait, or when the object
+ * is queried by @ref oval_probe_query_object.
+ * @param sess probe session
+ * @param object the object to evaluate
+ * @return 0 on success; -1 on error; 1 if the object is not supported
+ */
+int oval_probe_query_object_async(oval_probe_session_t *psess, struct oval_object *object, int flags) __attribute__ ((nonnull(1, 2)));
+
+/**
+ * Wait for the result of an object submitted by @ref oval_probe_query_object_async
+ * @param sess probe session
+ * @param out_syschar address of a pointer to hold the completed syschar or NULL
+ * @return 0 on success; -1 on error; 1 if there is no submitted object
+ */
+int oval_probe_query_wait(oval_probe_session_t *psess, struct oval_syschar **out_syschar) __attribute__ ((nonnull(1)));
+
 /**
  * Probe objects required for the evalatuation of the specified definition and update the system characteristics model associated with the session
  * @param sess probe session
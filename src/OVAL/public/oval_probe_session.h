@@ -84,6 +84,17 @@ int oval_probe_session_abort(oval_probe_session_t *sess);
  */
 int oval_probe_session_sethandler(oval_probe_session_t *sess, oval_subtype_t type, oval_probe_handler_t handler, void *ptr);
 
+/**
+ * Select how the probes of the session are run. The scheme is used for
+ * the probes started after the call.
+ * @param sess pointer to the probe session structure
+ * @param scheme "pipe" or "shm" to run the probes in separate processes,
+ * "thread" to load the probes which support it into the calling process
+ * (the others are run in separate processes), NULL for the default
+ * @return 0 on success, -1 if the scheme is not known
+ */
+int oval_probe_session_set_scheme(oval_probe_session_t *sess, const char *scheme);
+
 /**
  * Get system characteristics model from probe session.
  * @param sess pointer to the probe session structure
@@ -242,6 +242,32 @@ void oval_session_set_export_system_characteristics(struct oval_session *session
  */
 void oval_session_set_remote_resources(struct oval_session *session, bool allowed, download_progress_calllback_t callback);
 
+/**
+ * Set the number of jobs evaluating the definitions in parallel.
+ * @memberof oval_session
+ * @param session an \ref oval_session
+ * @param jobs the number of jobs, 0 means one job per CPU (see \ref oval_agent_set_jobs)
+ */
+void oval_session_set_jobs(struct oval_session *session, unsigned int jobs);
+
+/**
+ * Export the binary image of the loaded OVAL Definitions to the given
+ * directory, see \ref oval_definition_model_export_image. The next sessions
+ * of the same file load the definitions from the image, without parsing the
+ * file, if the directory is named by the OSCAP_OVAL_IMAGE_DIR environment
+ * variable. The validation of the file is skipped too if it was validated
+ * when the image was built.
+ *
+ * @memberof oval_session
+ * @param session an \ref oval_session loaded by \ref oval_session_load
+ * @param dir the image directory
+ *
+ * @retval 0 on success
+ * @retval 1 on an internal error (use \ref oscap_err_desc or \ref
+ * oscap_err_get_full_error to get more details)
+ */
+int oval_session_export_image(struct oval_session *session, const char *dir);
+
 /**
  * Destructor of an \ref oval_session.
  * @memberof oval_session
@@ -31,6 +31,9 @@
 #include <string.h>
 #include <inttypes.h>
 #include <arpa/inet.h>
+#if defined USE_REGEX_PCRE
+#include <pcre.h>
+#endif
 
 #include "oval_types.h"
 #include "oval_system_characteristics.h"
@@ -161,3 +164,146 @@ oval_result_t oval_ent_cmp_str(char *state_data, oval_datatype_t state_data_type
 	const char *sys_data = oval_sysent_get_value(sysent);
 	return oval_str_cmp_str(state_data, state_data_type, sys_data, operation);
 }
+
+void oval_cmp_value_init(struct oval_cmp_value *value, char *text, oval_datatype_t datatype, oval_operation_t operation)
+{
+	value->text = text;
+	value->datatype = datatype;
+	value->operation = operation;
+	value->parsed = false;
+
+	/* values which fail to parse are left to oval_str_cmp_str() which reports the error */
+	switch (datatype) {
+	case OVAL_DATATYPE_STRING:
+#if defined USE_REGEX_PCRE
+		if (operation == OVAL_OPERATION_PATTERN_MATCH) {
+			const char *err;
+			int errofs;
+
+			value->u.regex = oval_regex_get(text, PCRE_UTF8, &err, &errofs);
+			value->parsed = value->u.regex != NULL;
+		}
+#endif
+		break;
+	case OVAL_DATATYPE_INTEGER:
+		value->parsed = cstr_to_intmax(text, &value->u.integer);
+		break;
+	case OVAL_DATATYPE_FLOAT:
+		value->parsed = cstr_to_double(text, &value->u.fp);
+		break;
+	case OVAL_DATATYPE_BOOLEAN:
+		value->u.boolean = strcmp(text, "true") == 0 || strcmp(text, "1") == 0;
+		value->parsed = true;
+		break;
+	case OVAL_DATATYPE_EVR_STRING:
+	case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+		oval_evr_parse(text, &value->u.evr);
+		value->parsed = true;
+		break;
+	case OVAL_DATATYPE_VERSION:
+		oval_versiontype_parse(text, &value->u.version);
+		value->parsed = true;
+		break;
+	case OVAL_DATATYPE_IPV4ADDR:
+		value->parsed = oval_ipaddr_parse(AF_INET, text, &value->u.ipaddr) == 0;
+		break;
+	case OVAL_DATATYPE_IPV6ADDR:
+		value->parsed = oval_ipaddr_parse(AF_INET6, text, &value->u.ipaddr) == 0;
+		break;
+	default:
+		break;
+	}
+}
+
+void oval_cmp_value_clear(struct oval_cmp_value *value)
+{
+	if (!value->parsed)
+		return;
+
+	switch (value->datatype) {
+#if defined USE_REGEX_PCRE
+	case OVAL_DATATYPE_STRING:
+		oval_regex_put(value->u.regex);
+		break;
+#endif
+	case OVAL_DATATYPE_EVR_STRING:
+	case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+		oval_evr_clear(&value->u.evr);
+		break;
+	case OVAL_DATATYPE_VERSION:
+		oval_versiontype_clear(&value->u.version);
+		break;
+	default:
+		break;
+	}
+
+	value->parsed = false;
+}
+
+oval_result_t oval_cmp_value_cmp(struct oval_cmp_value *value, const char *sys_data)
+{
+	if (!value->parsed)
+		return oval_str_cmp_str(value->text, value->datatype, sys_data, value->operation);
+
+	switch (value->datatype) {
+#if defined USE_REGEX_PCRE
+	case OVAL_DATATYPE_STRING:
+		return oval_string_cmp_regex(value->u.regex, sys_data);
+#endif
+	case OVAL_DATATYPE_INTEGER: {
+		intmax_t syschar_val;
+
+		if (!cstr_to_intmax(sys_data, &syschar_val)) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL,
+				"Conversion of the string \"%s\" to an integer (%u bits) failed: %s",
+				sys_data, sizeof(intmax_t)*8, strerror(errno));
+			return OVAL_RESULT_ERROR;
+		}
+		return oval_int_cmp(value->u.integer, syschar_val, value->operation);
+	}
+	case OVAL_DATATYPE_FLOAT: {
+		double sys_val;
+
+		if (!cstr_to_double(sys_data, &sys_val)) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL,
+				"Conversion of the string \"%s\" to a floating type (double) failed: %s",
+				sys_data, strerror(errno));
+			return OVAL_RESULT_ERROR;
+		}
+		return oval_float_cmp(value->u.fp, sys_val, value->operation);
+	}
+	case OVAL_DATATYPE_BOOLEAN: {
+		bool sys_val;
+
+		sys_val = strcmp(sys_data, "true") == 0 || strcmp(sys_data, "1") == 0;
+		return oval_boolean_cmp(value->u.boolean, sys_val, value->operation);
+	}
+	case OVAL_DATATYPE_EVR_STRING:
+	case OVAL_DATATYPE_DEBIAN_EVR_STRING: {
+		struct oval_evr sys_evr;
+		oval_result_t result;
+
+		oval_evr_parse(sys_data, &sys_evr);
+		result = oval_evr_string_cmp_parsed(&value->u.evr, &sys_evr, value->operation);
+		oval_evr_clear(&sys_evr);
+
+		return result;
+	}
+	case OVAL_DATATYPE_VERSION: {
+		struct oval_versiontype sys_ver;
+		oval_result_t result;
+
+		oval_versiontype_parse(sys_data, &sys_ver);
+		result = oval_versiontype_cmp_parsed(&value->u.version, &sys_ver, value->operation);
+		oval_versiontype_clear(&sys_ver);
+
+		return result;
+	}
+	case OVAL_DATATYPE_IPV4ADDR:
+		return oval_ipaddr_cmp_parsed(AF_INET, &value->u.ipaddr, sys_data, value->operation);
+	case OVAL_DATATYPE_IPV6ADDR:
+		return oval_ipaddr_cmp_parsed(AF_INET6, &value->u.ipaddr, sys_data, value->operation);
+	default:
+		return oval_str_cmp_str(value->text, value->datatype, sys_data, value->operation);
+	}
+}
@@ -124,35 +124,44 @@ static int istrcmp(const char *st1, const char *st2)
 	return strcasecmp(st1, st2);
 }
 
-static oval_result_t strregcomp(const char *pattern, const char *test_str)
+#if defined USE_REGEX_PCRE
+oval_result_t oval_string_cmp_regex(const oval_regex_t *re, const char *syschar)
 {
 	int ret;
+
+	syschar = syschar ? syschar : "";
+	ret = oval_regex_exec(re, syschar, strlen(syschar), 0, NULL, 0);
+	if (ret > -1 ) {
+		return OVAL_RESULT_TRUE;
+	} else if (ret == -1) {
+		return OVAL_RESULT_FALSE;
+	} else {
+		dE("Unable to match regex pattern, "
+			       "pcre_exec() returned error: %d.\n", ret);
+		return OVAL_RESULT_ERROR;
+	}
+}
+#endif
+
+static oval_result_t strregcomp(const char *pattern, const char *test_str)
+{
 	oval_result_t result = OVAL_RESULT_ERROR;
 #if defined USE_REGEX_PCRE
-	pcre *re;
+	oval_regex_t *re;
 	const char *err;
 	int errofs;
 
-	re = pcre_compile(pattern, PCRE_UTF8, &err, &errofs, NULL);
+	re = oval_regex_get(pattern, PCRE_UTF8, &err, &errofs);
 	if (re == NULL) {
 		dE("Unable to compile regex pattern, "
 			       "pcre_compile() returned error (offset: %d): '%s'.\n", errofs, err);
 		return OVAL_RESULT_ERROR;
 	}
 
-	ret = pcre_exec(re, NULL, test_str, strlen(test_str), 0, 0, NULL, 0);
-	if (ret > -1 ) {
-		result = OVAL_RESULT_TRUE;
-	} else if (ret == -1) {
-		result = OVAL_RESULT_FALSE;
-	} else {
-		dE("Unable to match regex pattern, "
-			       "pcre_exec() returned error: %d.\n", ret);
-		result = OVAL_RESULT_ERROR;
-	}
-
-	pcre_free(re);
+	result = oval_string_cmp_regex(re, test_str);
+	oval_regex_put(re);
 #elif defined USE_REGEX_POSIX
+	int ret;
 	regex_t re;
 
 	ret = regcomp(&re, pattern, REG_EXTENDED);
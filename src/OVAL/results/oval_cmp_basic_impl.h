@@ -26,6 +26,7 @@
 #include "../common/util.h"
 #include "oval_definitions.h"
 #include "oval_types.h"
+#include "oval_regex_cache_impl.h"
 
 OSCAP_HIDDEN_START;
 
@@ -37,6 +38,13 @@ oval_result_t oval_float_cmp(const double state_val, const double sys_val, oval_
 
 oval_result_t oval_string_cmp(const char *state, const char *syschar, oval_operation_t operation);
 
+#if defined USE_REGEX_PCRE
+/**
+ * Pattern match of a string with an already compiled pattern.
+ */
+oval_result_t oval_string_cmp_regex(const oval_regex_t *re, const char *syschar);
+#endif
+
 oval_result_t oval_binary_cmp(const char *state, const char *syschar, oval_operation_t operation);
 
 OSCAP_HIDDEN_END;
@@ -35,28 +35,21 @@
 #include "oval_types.h"
 
 #include "common/_error.h"
+#include "common/alloc.h"
 
 #ifdef HAVE_RPMVERCMP
 #include <rpm/rpmlib.h>
-#else
-#if !defined(__FreeBSD__)
-#include <alloca.h>
 #endif
-static int rpmvercmp(const char *a, const char *b);
+
 static int risdigit(int c) {
 	// locale independent
 	return (c >= '0' && c <= '9');
 }
-#endif
 
-static inline int rpmevrcmp(const char *a, const char *b);
-static int compare_values(const char *str1, const char *str2);
 static void parseEVR(char *evr, const char **ep, const char **vp, const char **rp);
 
-oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation)
+static oval_result_t evr_result(int result, oval_operation_t operation)
 {
-	int result = rpmevrcmp(sys, state);
-
 	if (operation == OVAL_OPERATION_EQUALS) {
 		return ((result == 0) ? OVAL_RESULT_TRUE : OVAL_RESULT_FALSE);
 	} else if (operation == OVAL_OPERATION_NOT_EQUAL) {
@@ -75,45 +68,248 @@ oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_opera
 	return OVAL_RESULT_ERROR;
 }
 
-static inline int rpmevrcmp(const char *a, const char *b)
+oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation)
 {
-	/* This mimics rpmevrcmp which is not exported by rpmlib version 4.
-	 * Code inspired by rpm.labelCompare() from rpm4/python/header-py.c
-	 */
-	const char *a_epoch, *a_version, *a_release;
-	const char *b_epoch, *b_version, *b_release;
-	char *a_copy, *b_copy;
-	int result;
+	struct oval_evr state_evr, sys_evr;
+	oval_result_t result;
 
-	a_copy = oscap_strdup(a);
-	b_copy = oscap_strdup(b);
-	parseEVR(a_copy, &a_epoch, &a_version, &a_release);
-	parseEVR(b_copy, &b_epoch, &b_version, &b_release);
+	oval_evr_parse(state, &state_evr);
+	oval_evr_parse(sys, &sys_evr);
+	result = oval_evr_string_cmp_parsed(&state_evr, &sys_evr, operation);
+	oval_evr_clear(&sys_evr);
+	oval_evr_clear(&state_evr);
 
-	result = compare_values(a_epoch, b_epoch);
-	if (!result) {
-		result = compare_values(a_version, b_version);
-		if (!result)
-			result = compare_values(a_release, b_release);
+	return result;
+}
+
+oval_result_t oval_evr_string_cmp_parsed(const struct oval_evr *state, const struct oval_evr *sys, oval_operation_t operation)
+{
+	return evr_result(oval_evr_cmp(sys, state), operation);
+}
+
+void oval_evr_string_cmp_batch(const struct oval_evr *const *states, size_t count, const struct oval_evr *sys,
+                               oval_operation_t operation, oval_result_t *results)
+{
+	size_t i;
+
+	for (i = 0; i < count; ++i)
+		results[i] = evr_result(oval_evr_cmp(sys, states[i]), operation);
+}
+
+#ifndef HAVE_RPMVERCMP
+/* '~' sorts before anything, '^' after the end of the version only */
+static bool is_ordered_sep(char c)
+{
+	return c == '~' || c == '^';
+}
+
+/*
+ * The segments are the runs of digits or letters which rpmvercmp()
+ * compares one by one and the '~' and '^' separators, anything else
+ * only separates them.
+ */
+static const char *next_segment(const char *s, const char **end, bool *numeric)
+{
+	while (*s && !isalnum((unsigned char)*s) && !is_ordered_sep(*s))
+		s++;
+
+	if (*s == '\0')
+		return NULL;
+
+	*end = s;
+	*numeric = isdigit((unsigned char)*s);
+
+	if (is_ordered_sep(*s)) {
+		(*end)++;
+		return s;
 	}
 
-	oscap_free(a_copy);
-	oscap_free(b_copy);
-	return result;
+	if (*numeric) {
+		while (**end && isdigit((unsigned char)**end))
+			(*end)++;
+	} else {
+		while (**end && isalpha((unsigned char)**end))
+			(*end)++;
+	}
+
+	return s;
 }
 
-static int compare_values(const char *str1, const char *str2)
+static size_t count_segments(const char *s)
+{
+	const char *end;
+	bool numeric;
+	size_t count = 0;
+
+	if (s == NULL)
+		return 0;
+
+	while ((s = next_segment(s, &end, &numeric)) != NULL) {
+		++count;
+		s = end;
+	}
+
+	return count;
+}
+
+static void split_segments(const char *s, struct oval_evr_part *part, struct oval_evr_segment *segs)
+{
+	const char *seg, *end;
+	bool numeric;
+
+	part->str = s;
+	part->segs = segs;
+	part->count = 0;
+	part->trailing = false;
+
+	if (s == NULL)
+		return;
+
+	end = s;
+	while ((seg = next_segment(end, &end, &numeric)) != NULL) {
+		segs[part->count].sep = is_ordered_sep(*seg) ? *seg : '\0';
+		/* leading zeros don't count, it's a number */
+		if (numeric) {
+			while (*seg == '0')
+				seg++;
+		}
+		segs[part->count].str = seg;
+		segs[part->count].len = end - seg;
+		segs[part->count].numeric = numeric;
+		++part->count;
+	}
+	part->trailing = (*end != '\0');
+}
+#endif
+
+void oval_evr_parse(const char *evr, struct oval_evr *out)
+{
+	const char *epoch, *version, *release;
+
+	out->buf = oscap_strdup(evr);
+	parseEVR(out->buf, &epoch, &version, &release);
+
+#ifdef HAVE_RPMVERCMP
+	/* librpm's rpmvercmp() may know more than the segments (~, ^), let it compare the parts */
+	out->segs = NULL;
+	out->part[0] = (struct oval_evr_part) { .str = epoch };
+	out->part[1] = (struct oval_evr_part) { .str = version };
+	out->part[2] = (struct oval_evr_part) { .str = release };
+#else
+	size_t count = count_segments(epoch) + count_segments(version) + count_segments(release);
+	out->segs = oscap_alloc((count > 0 ? count : 1) * sizeof(struct oval_evr_segment));
+
+	split_segments(epoch, &out->part[0], out->segs);
+	split_segments(version, &out->part[1], out->segs + out->part[0].count);
+	split_segments(release, &out->part[2], out->segs + out->part[0].count + out->part[1].count);
+#endif
+}
+
+void oval_evr_clear(struct oval_evr *evr)
+{
+	oscap_free(evr->segs);
+	oscap_free(evr->buf);
+	evr->segs = NULL;
+	evr->buf = NULL;
+}
+
+/*
+ * Same result as rpmvercmp() from http://rpm.org/api/4.4.2.2/rpmvercmp_8c-source.html
+ * for the strings the parts were split from:
+ *
+ *  1: a is newer than b
+ *  0: a and b are the same version
+ * -1: b is newer than a
+ */
+static int compare_parts(const struct oval_evr_part *a, const struct oval_evr_part *b)
 {
 	/*
 	 * Code copied from rpm4/python/header-py.c
 	 */
-	if (!str1 && !str2)
+	if (!a->str && !b->str)
 		return 0;
-	else if (str1 && !str2)
+	else if (a->str && !b->str)
 		return 1;
-	else if (!str1 && str2)
+	else if (!a->str && b->str)
 		return -1;
-	return rpmvercmp(str1, str2);
+
+#ifdef HAVE_RPMVERCMP
+	return rpmvercmp(a->str, b->str);
+#else
+	size_t i, n = a->count > b->count ? a->count : b->count;
+
+	for (i = 0; i < n; ++i) {
+		const struct oval_evr_segment *sa = i < a->count ? &a->segs[i] : NULL;
+		const struct oval_evr_segment *sb = i < b->count ? &b->segs[i] : NULL;
+		int rc;
+
+		/* a tilde sorts before everything else, even the end of the version */
+		if ((sa != NULL && sa->sep == '~') || (sb != NULL && sb->sep == '~')) {
+			if (sa == NULL || sa->sep != '~')
+				return 1;
+			if (sb == NULL || sb->sep != '~')
+				return -1;
+			continue;
+		}
+
+		/* a caret sorts after the end of the version, before anything else */
+		if ((sa != NULL && sa->sep == '^') || (sb != NULL && sb->sep == '^')) {
+			if (sa == NULL)
+				return -1;
+			if (sb == NULL)
+				return 1;
+			if (sa->sep != '^')
+				return 1;
+			if (sb->sep != '^')
+				return -1;
+			continue;
+		}
+
+		if (sa == NULL || sb == NULL)
+			break;
+
+		/* numeric segments are always newer than alpha segments */
+		if (sa->numeric != sb->numeric)
+			return (sa->numeric ? 1 : -1);
+
+		/* whichever number has more digits wins */
+		if (sa->numeric && sa->len != sb->len)
+			return (sa->len > sb->len ? 1 : -1);
+
+		rc = memcmp(sa->str, sb->str, sa->len < sb->len ? sa->len : sb->len);
+		if (rc)
+			return (rc < 0 ? -1 : 1);
+		if (sa->len != sb->len)
+			return (sa->len > sb->len ? 1 : -1);
+	}
+
+	/* whichever version still has segments left over wins */
+	if (a->count != b->count)
+		return (a->count > b->count ? 1 : -1);
+
+	/* the segments are the same, but one version has separators left over */
+	if (a->trailing != b->trailing)
+		return (a->trailing ? 1 : -1);
+
+	return 0;
+#endif
+}
+
+int oval_evr_cmp(const struct oval_evr *a, const struct oval_evr *b)
+{
+	/* This mimics rpmevrcmp which is not exported by rpmlib version 4.
+	 * Code inspired by rpm.labelCompare() from rpm4/python/header-py.c
+	 */
+	int result;
+
+	result = compare_parts(&a->part[0], &b->part[0]);
+	if (!result) {
+		result = compare_parts(&a->part[1], &b->part[1]);
+		if (!result)
+			result = compare_parts(&a->part[2], &b->part[2]);
+	}
+
+	return result;
 }
 
 static void parseEVR(char *evr, const char **ep, const char **vp, const char **rp)
@@ -152,203 +348,96 @@ static void parseEVR(char *evr, const char **ep, const char **vp, const char **r
 	if (rp) *rp = release;
 }
 
-#ifndef HAVE_RPMVERCMP
 /*
- * code from http://rpm.org/api/4.4.2.2/rpmvercmp_8c-source.html
+ * The fields are the numbers atoi() finds at the beginning of the string
+ * and after each separator, missing fields compare as 0.
  */
-
-/* compare alpha and numeric segments of two versions */
-/* return 1: a is newer than b */
-/*        0: a and b are the same version */
-/*       -1: b is newer than a */
-static int rpmvercmp(const char *a, const char *b)
+void oval_versiontype_parse(const char *version, struct oval_versiontype *out)
 {
-	char oldch1, oldch2;
-	char *str1, *str2;
-	char *one, *two;
-	int rc;
-	int isnum;
-
-	/* easy comparison to see if versions are identical */
-	if (!strcmp(a, b))
-		return 0;
-
-	/* TODO: make new oscap_alloca */
-	str1 = alloca(strlen(a) + 1);
-	str2 = alloca(strlen(b) + 1);
-
-	strcpy(str1, a);
-	strcpy(str2, b);
-
-	one = str1;
-	two = str2;
-
-	/* loop through each version segment of str1 and str2 and compare them */
-	while (*one && *two) {
-		while (*one && !isalnum(*one))
-			one++;
-		while (*two && !isalnum(*two))
-			two++;
-
-		/* If we ran to the end of either, we are finished with the loop */
-		if (!(*one && *two))
-			break;
-
-		str1 = one;
-		str2 = two;
-
-		/* grab first completely alpha or completely numeric segment */
-		/* leave one and two pointing to the start of the alpha or numeric */
-		/* segment and walk str1 and str2 to end of segment */
-		if (isdigit(*str1)) {
-			while (*str1 && isdigit(*str1))
-				str1++;
-			while (*str2 && isdigit(*str2))
-				str2++;
-			isnum = 1;
-		} else {
-			while (*str1 && isalpha(*str1))
-				str1++;
-			while (*str2 && isalpha(*str2))
-				str2++;
-			isnum = 0;
-		}
+	size_t idx = 0;
 
-		/* save character at the end of the alpha or numeric segment */
-		/* so that they can be restored after the comparison */
-		oldch1 = *str1;
-		*str1 = '\0';
-		oldch2 = *str2;
-		*str2 = '\0';
+	out->count = 0;
+	out->fields = oscap_alloc((strlen(version) + 1) * sizeof(int));
 
-		/* this cannot happen, as we previously tested to make sure that */
-		/* the first string has a non-null segment */
-		if (one == str1)
-			return -1;	/* arbitrary */
+	while (version[idx]) {
+		out->fields[out->count++] = atoi(&version[idx]);
 
-		/* take care of the case where the two version segments are */
-		/* different types: one numeric, the other alpha (i.e. empty) */
-		/* numeric segments are always newer than alpha segments */
-		/* result_test See patch #60884 (and details) from bugzilla #50977. */
-		if (two == str2)
-			return (isnum ? 1 : -1);
-
-		if (isnum) {
-			/* this used to be done by converting the digit segments */
-			/* to ints using atoi() - it's changed because long  */
-			/* digit segments can overflow an int - this should fix that. */
-
-			/* throw away any leading zeros - it's a number, right? */
-			while (*one == '0')
-				one++;
-			while (*two == '0')
-				two++;
-
-			/* whichever number has more digits wins */
-			if (strlen(one) > strlen(two))
-				return 1;
-			if (strlen(two) > strlen(one))
-				return -1;
-		}
-
-		/* strcmp will return which one is greater - even if the two */
-		/* segments are alpha or if they are numeric.  don't return  */
-		/* if they are equal because there might be more segments to */
-		/* compare */
-		rc = strcmp(one, two);
-		if (rc)
-			return (rc < 1 ? -1 : 1);
-
-		/* restore character that was replaced by null above */
-		*str1 = oldch1;
-		one = str1;
-		*str2 = oldch2;
-		two = str2;
+		++idx;
+		/* move to the next field within the version string (if there is one) */
+		while ((version[idx]) && (isdigit(version[idx])))
+			++idx;
+		if ((version[idx]) && (!isdigit(version[idx])))
+			++idx;
 	}
-	/* this catches the case where all numeric and alpha segments have */
-	/* compared identically but the segment sepparating characters were */
-	/* different */
-	if ((!*one) && (!*two))
-		return 0;
-
-	/* whichever version still has characters left over wins */
-	if (!*one)
-		return -1;
-	else
-		return 1;
 }
-#endif
 
+void oval_versiontype_clear(struct oval_versiontype *version)
+{
+	oscap_free(version->fields);
+	version->fields = NULL;
+	version->count = 0;
+}
 
 oval_result_t oval_versiontype_cmp(const char *state, const char *syschar, oval_operation_t operation)
 {
-	int state_idx = 0;
-	int sys_idx = 0;
-	int result = -1;
-	/* int is_equal = 1; */
-	for (state_idx = 0, sys_idx = 0; (((state[state_idx]) || (syschar[sys_idx])) && (result == -1));) {	// keep going as long as there is data in either the state or sysitem
-		int tmp_state_int, tmp_sys_int;
-		tmp_state_int = atoi(&state[state_idx]);	// look at the current data field (if we're at the end, atoi should return 0)
-		tmp_sys_int = atoi(&syschar[sys_idx]);
-                /* o rly?
-		if (tmp_state_int != tmp_sys_int)
-			is_equal = 0;	// we might need this later (if we don't terminate early)
-                */
-		if (operation == OVAL_OPERATION_EQUALS) {
-			if (tmp_state_int != tmp_sys_int)
-				return (OVAL_RESULT_FALSE);
-		} else if (operation == OVAL_OPERATION_NOT_EQUAL) {
-			if (tmp_state_int != tmp_sys_int)
-				return (OVAL_RESULT_TRUE);
-		} else if ((operation == OVAL_OPERATION_GREATER_THAN)
-			   || (operation == OVAL_OPERATION_GREATER_THAN_OR_EQUAL)) {
-			if (tmp_sys_int > tmp_state_int)
-				return (OVAL_RESULT_TRUE);
-			if (tmp_sys_int < tmp_state_int)
-				return (OVAL_RESULT_FALSE);
-		} else if ((operation == OVAL_OPERATION_LESS_THAN)
-			   || (operation == OVAL_OPERATION_LESS_THAN_OR_EQUAL)) {
-			if (tmp_sys_int < tmp_state_int)
-				return (OVAL_RESULT_TRUE);
-			if (tmp_sys_int > tmp_state_int)
-				return (OVAL_RESULT_FALSE);
-		} else {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "Invalid type of operation in version comparison: %d.", operation);
-			return OVAL_RESULT_ERROR;
-		}
+	struct oval_versiontype state_ver, sys_ver;
+	oval_result_t result;
 
-		if (state[state_idx])
-			++state_idx;
-		/* move to the next field within the version string (if there is one) */
-		while ((state[state_idx]) && (isdigit(state[state_idx])))
-			++state_idx;
-		if ((state[state_idx]) && (!isdigit(state[state_idx])))
-			++state_idx;
+	oval_versiontype_parse(state, &state_ver);
+	oval_versiontype_parse(syschar, &sys_ver);
+	result = oval_versiontype_cmp_parsed(&state_ver, &sys_ver, operation);
+	oval_versiontype_clear(&sys_ver);
+	oval_versiontype_clear(&state_ver);
 
-		if (syschar[sys_idx])
-			++sys_idx;
-		/* move to the next field within the version string (if there is one) */
-		while ((syschar[sys_idx]) && (isdigit(syschar[sys_idx])))
-			++sys_idx;
-		if ((syschar[sys_idx]) && (!isdigit(syschar[sys_idx])))
-			++sys_idx;
+	return result;
+}
+
+oval_result_t oval_versiontype_cmp_parsed(const struct oval_versiontype *state, const struct oval_versiontype *sys, oval_operation_t operation)
+{
+	size_t i, n;
+
+	switch (operation) {
+	case OVAL_OPERATION_EQUALS:
+	case OVAL_OPERATION_NOT_EQUAL:
+	case OVAL_OPERATION_GREATER_THAN:
+	case OVAL_OPERATION_GREATER_THAN_OR_EQUAL:
+	case OVAL_OPERATION_LESS_THAN:
+	case OVAL_OPERATION_LESS_THAN_OR_EQUAL:
+		break;
+	default:
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "Invalid type of operation in version comparison: %d.", operation);
+		return OVAL_RESULT_ERROR;
+	}
+
+	n = state->count > sys->count ? state->count : sys->count;
+
+	for (i = 0; i < n; ++i) {
+		int tmp_state_int = i < state->count ? state->fields[i] : 0;
+		int tmp_sys_int = i < sys->count ? sys->fields[i] : 0;
+
+		if (tmp_state_int == tmp_sys_int)
+			continue;
+
+		switch (operation) {
+		case OVAL_OPERATION_EQUALS:
+			return (OVAL_RESULT_FALSE);
+		case OVAL_OPERATION_NOT_EQUAL:
+			return (OVAL_RESULT_TRUE);
+		case OVAL_OPERATION_GREATER_THAN:
+		case OVAL_OPERATION_GREATER_THAN_OR_EQUAL:
+			return (tmp_sys_int > tmp_state_int ? OVAL_RESULT_TRUE : OVAL_RESULT_FALSE);
+		default:
+			return (tmp_sys_int < tmp_state_int ? OVAL_RESULT_TRUE : OVAL_RESULT_FALSE);
+		}
 	}
 
 	// OK, we did not terminate early, and we're out of data, so we now know what to return
-	if (operation == OVAL_OPERATION_EQUALS) {
+	switch (operation) {
+	case OVAL_OPERATION_EQUALS:
+	case OVAL_OPERATION_GREATER_THAN_OR_EQUAL:
+	case OVAL_OPERATION_LESS_THAN_OR_EQUAL:
 		return (OVAL_RESULT_TRUE);
-	} else if (operation == OVAL_OPERATION_NOT_EQUAL) {
-		return (OVAL_RESULT_FALSE);
-	} else if (operation == OVAL_OPERATION_GREATER_THAN) {
+	default:
 		return (OVAL_RESULT_FALSE);
-	} else if (operation == OVAL_OPERATION_GREATER_THAN_OR_EQUAL) {
-		return (OVAL_RESULT_TRUE);
-	} else if (operation == OVAL_OPERATION_LESS_THAN) {
-		return (OVAL_RESULT_FALSE);
-	} else if (operation == OVAL_OPERATION_LESS_THAN_OR_EQUAL) {
-		return (OVAL_RESULT_TRUE);
-	}		// we have already filtered out the invalid ones
-	assert(0);
-	return OVAL_RESULT_ERROR;
-
+	}
 }
@@ -30,6 +30,8 @@
 #ifndef OSCAP_OVAL_EVR_STRING_IMPL_H_
 #define OSCAP_OVAL_EVR_STRING_IMPL_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include "../common/util.h"
 
 #include "oval_definitions.h"
@@ -48,8 +50,83 @@ OSCAP_HIDDEN_START;
  */
 oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation);
 
+/**
+ * Run of digits or letters of a version compared as a whole by rpmvercmp(),
+ * or a '~' or '^' separator which rpmvercmp() orders too.
+ * Numeric segments don't include their leading zeros.
+ */
+struct oval_evr_segment {
+	const char *str;
+	size_t      len;
+	bool        numeric;
+	char        sep;     /* '~' or '^' for a separator, '\0' otherwise */
+};
+
+/**
+ * Epoch, version or release of an EVR string split into segments.
+ * The string is NULL if the part is missing.
+ */
+struct oval_evr_part {
+	const char                    *str;
+	const struct oval_evr_segment *segs;
+	size_t                         count;
+	bool                           trailing; /* separators after the last segment */
+};
+
+/**
+ * EVR string parsed by oval_evr_parse(). Parsed EVRs are compared without
+ * copying or rescanning the strings.
+ */
+struct oval_evr {
+	char                    *buf;
+	struct oval_evr_segment *segs;
+	struct oval_evr_part     part[3]; /* epoch, version, release */
+};
+
+void oval_evr_parse(const char *evr, struct oval_evr *out);
+void oval_evr_clear(struct oval_evr *evr);
+
+/**
+ * Compare two parsed EVR strings like rpmevrcmp().
+ * @returns 1 if a is newer than b, 0 if they are the same, -1 if b is newer than a
+ */
+int oval_evr_cmp(const struct oval_evr *a, const struct oval_evr *b);
+
+/**
+ * Same as oval_evr_string_cmp() with both EVR strings already parsed.
+ */
+oval_result_t oval_evr_string_cmp_parsed(const struct oval_evr *state, const struct oval_evr *sys, oval_operation_t operation);
+
+/**
+ * Compare one EVR collected from the system with several state values
+ * (e.g. the values of a variable) using the same operation.
+ * @param results array of count results, results[i] is the result for states[i]
+ */
+void oval_evr_string_cmp_batch(const struct oval_evr *const *states, size_t count, const struct oval_evr *sys,
+                               oval_operation_t operation, oval_result_t *results);
+
+/**
+ * Compare two values of the version datatype. The fields of the versions
+ * are compared as integers, missing fields are considered to be 0.
+ */
 oval_result_t oval_versiontype_cmp(const char *state, const char *syschar, oval_operation_t operation);
 
+/**
+ * Value of the version datatype split into its fields by oval_versiontype_parse().
+ */
+struct oval_versiontype {
+	int    *fields;
+	size_t  count;
+};
+
+void oval_versiontype_parse(const char *version, struct oval_versiontype *out);
+void oval_versiontype_clear(struct oval_versiontype *version);
+
+/**
+ * Same as oval_versiontype_cmp() with both versions already parsed.
+ */
+oval_result_t oval_versiontype_cmp_parsed(const struct oval_versiontype *state, const struct oval_versiontype *sys, oval_operation_t operation);
+
 OSCAP_HIDDEN_END;
 
 #endif
@@ -27,6 +27,9 @@
 #include "oval_definitions.h"
 #include "oval_types.h"
 #include "oval_system_characteristics.h"
+#include "oval_cmp_evr_string_impl.h"
+#include "oval_cmp_ip_address_impl.h"
+#include "oval_regex_cache_impl.h"
 
 OSCAP_HIDDEN_START;
 
@@ -51,6 +54,46 @@ oval_result_t oval_ent_cmp_str(char *state_data, oval_datatype_t state_data_type
  */
 oval_result_t oval_str_cmp_str(char *state_data, oval_datatype_t state_data_type, const char *sys_data, oval_operation_t operation);
 
+/**
+ * State value (or variable value) prepared for repeated comparisons by
+ * oval_cmp_value_init(). Integers, floats, booleans, EVR strings, versions,
+ * IP addresses and patterns are parsed only once, other values are compared
+ * by oval_str_cmp_str().
+ */
+struct oval_cmp_value {
+	char             *text;
+	oval_datatype_t   datatype;
+	oval_operation_t  operation;
+	bool              parsed;
+	union {
+		intmax_t                 integer;
+		double                   fp;
+		bool                     boolean;
+		struct oval_evr          evr;
+		struct oval_versiontype  version;
+		struct oval_ipaddr       ipaddr;
+#if defined USE_REGEX_PCRE
+		oval_regex_t            *regex;
+#endif
+	} u;
+};
+
+/**
+ * Prepare a value for oval_cmp_value_cmp(). The text isn't copied and has
+ * to outlive the prepared value.
+ */
+void oval_cmp_value_init(struct oval_cmp_value *value, char *text, oval_datatype_t datatype, oval_operation_t operation);
+
+/**
+ * Free the resources held by a value prepared by oval_cmp_value_init().
+ */
+void oval_cmp_value_clear(struct oval_cmp_value *value);
+
+/**
+ * Same as oval_str_cmp_str() with the state value prepared by oval_cmp_value_init().
+ */
+oval_result_t oval_cmp_value_cmp(struct oval_cmp_value *value, const char *sys_data);
+
 OSCAP_HIDDEN_END;
 
 #endif
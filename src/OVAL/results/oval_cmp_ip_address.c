@@ -79,14 +79,33 @@ static inline int ipaddr_parse(int af, const char *oval_ip_string, uint32_t *mas
 	return ipv6addr_parse(oval_ip_string, mask_out, ip_out);
 }
 
+int oval_ipaddr_parse(int af, const char *s, struct oval_ipaddr *ip)
+{
+	ip->mask = 0;
+	return ipaddr_parse(af, s, &ip->mask, &ip->addr);
+}
+
 oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_operation_t op)
+{
+	struct oval_ipaddr ip1;
+
+	if (oval_ipaddr_parse(af, s1, &ip1))
+		return OVAL_RESULT_ERROR;
+
+	return oval_ipaddr_cmp_parsed(af, &ip1, s2, op);
+}
+
+oval_result_t oval_ipaddr_cmp_parsed(int af, const struct oval_ipaddr *ip1, const char *s2, oval_operation_t op)
 {
 	oval_result_t result = OVAL_RESULT_ERROR;
-	uint32_t mask1 = 0, mask2 = 0;
+	uint32_t mask1 = ip1->mask, mask2 = 0;
 	char addr1[INET6_ADDRSTRLEN];
 	char addr2[INET6_ADDRSTRLEN];
 
-	if (ipaddr_parse(af, s1, &mask1, &addr1) || ipaddr_parse(af, s2, &mask2, &addr2)) {
+	/* the addresses are masked below, work on a copy */
+	memcpy(addr1, &ip1->addr, sizeof(ip1->addr));
+
+	if (ipaddr_parse(af, s2, &mask2, &addr2)) {
 		return result;
 	}
 
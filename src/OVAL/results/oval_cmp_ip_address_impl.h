@@ -31,6 +31,9 @@
 #ifndef OSCAP_OVAL_IP_ADDRESS_IMPL_H_
 #define OSCAP_OVAL_IP_ADDRESS_IMPL_H_
 
+#include <stdint.h>
+#include <netinet/in.h>
+
 #include "common/util.h"
 
 #include "oval_definitions.h"
@@ -50,6 +53,25 @@ OSCAP_HIDDEN_START;
  */
 oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_operation_t op);
 
+/**
+ * IP address or address set parsed by oval_ipaddr_parse().
+ */
+struct oval_ipaddr {
+	uint32_t        mask; ///< netmask (IPv4) or prefix length (IPv6)
+	struct in6_addr addr; ///< struct in_addr for IPv4
+};
+
+/**
+ * Parse an IP address or address set (CIDR) for oval_ipaddr_cmp_parsed().
+ * @returns 0 on success, -1 if the string isn't a valid address
+ */
+int oval_ipaddr_parse(int af, const char *s, struct oval_ipaddr *ip);
+
+/**
+ * Same as oval_ipaddr_cmp() with the first operand already parsed.
+ */
+oval_result_t oval_ipaddr_cmp_parsed(int af, const struct oval_ipaddr *ip1, const char *s2, oval_operation_t op);
+
 OSCAP_HIDDEN_END;
 
 #endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#if defined USE_REGEX_PCRE
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <pcre.h>
+
+#include "common/alloc.h"
+#include "common/debug_priv.h"
+#include "oval_regex_cache_impl.h"
+
+/*
+ * The same patterns are matched against a lot of items (all files found by
+ * a file object, all packages, ...), so compiled patterns are kept until
+ * oval_regex_cache_free(). Compiled patterns are never changed once they
+ * are in the cache and PCRE allows to use them from several threads at once,
+ * the lock only protects the table. The number of cached patterns is limited,
+ * patterns which don't fit are compiled for each use like before.
+ */
+#define OVAL_REGEX_CACHE_BUCKETS 1021
+#define OVAL_REGEX_CACHE_MAX     4096
+#define OVAL_REGEX_CACHE_MAX_ENV "OSCAP_REGEX_CACHE_MAX"
+
+struct oval_regex {
+	pcre              *re;
+	pcre_extra        *extra;
+	int                options;
+	bool               cached;
+	char              *pattern;
+	struct oval_regex *next;
+};
+
+static struct {
+	pthread_mutex_t    lock;
+	struct oval_regex *table[OVAL_REGEX_CACHE_BUCKETS];
+	size_t             count;
+	size_t             max;
+	size_t             hits;
+	size_t             misses;
+} regex_cache = {
+	.lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+static pthread_once_t regex_cache_once = PTHREAD_ONCE_INIT;
+
+static void oval_regex_free(struct oval_regex *re)
+{
+	if (re->extra != NULL)
+#ifdef PCRE_STUDY_JIT_COMPILE
+		pcre_free_study(re->extra);
+#else
+		pcre_free(re->extra);
+#endif
+	pcre_free(re->re);
+	oscap_free(re->pattern);
+	oscap_free(re);
+}
+
+void oval_regex_cache_free(void)
+{
+	size_t i, total;
+
+	pthread_mutex_lock(&regex_cache.lock);
+
+	total = regex_cache.hits + regex_cache.misses;
+	if (total > 0)
+		dI("Regex cache: %zu patterns, %zu hits, %zu misses, hit ratio %.1f%%.",
+		   regex_cache.count, regex_cache.hits, regex_cache.misses,
+		   100.0 * regex_cache.hits / total);
+
+	for (i = 0; i < OVAL_REGEX_CACHE_BUCKETS; ++i) {
+		struct oval_regex *re, *next;
+
+		for (re = regex_cache.table[i]; re != NULL; re = next) {
+			next = re->next;
+			oval_regex_free(re);
+		}
+		regex_cache.table[i] = NULL;
+	}
+	regex_cache.count  = 0;
+	regex_cache.hits   = 0;
+	regex_cache.misses = 0;
+
+	pthread_mutex_unlock(&regex_cache.lock);
+}
+
+static void oval_regex_cache_init(void)
+{
+	const char *max = getenv(OVAL_REGEX_CACHE_MAX_ENV);
+	char *end;
+
+	regex_cache.max = OVAL_REGEX_CACHE_MAX;
+	if (max != NULL && *max != '\0') {
+		unsigned long val = strtoul(max, &end, 10);
+
+		if (*end == '\0' && val <= OVAL_REGEX_CACHE_MAX)
+			regex_cache.max = val;
+		else
+			dW("Ignoring %s=%s, it has to be a number up to %d.",
+			   OVAL_REGEX_CACHE_MAX_ENV, max, OVAL_REGEX_CACHE_MAX);
+	}
+}
+
+static size_t oval_regex_hash(const char *pattern, int options)
+{
+	uint32_t h = 2166136261U ^ (uint32_t)options;
+
+	while (*pattern != '\0') {
+		h ^= (unsigned char)*pattern++;
+		h *= 16777619U;
+	}
+
+	return h % OVAL_REGEX_CACHE_BUCKETS;
+}
+
+static struct oval_regex *oval_regex_compile(const char *pattern, int options, const char **errptr, int *erroffset)
+{
+	struct oval_regex *re;
+	const char *study_err = NULL;
+
+	re = oscap_talloc(struct oval_regex);
+	re->re = pcre_compile(pattern, options, errptr, erroffset, NULL);
+
+	if (re->re == NULL) {
+		oscap_free(re);
+		return NULL;
+	}
+
+#ifdef PCRE_STUDY_JIT_COMPILE
+	re->extra = pcre_study(re->re, PCRE_STUDY_JIT_COMPILE, &study_err);
+#else
+	re->extra = pcre_study(re->re, 0, &study_err);
+#endif
+	if (study_err != NULL)
+		dW("pcre_study() failed for pattern '%s': %s.", pattern, study_err);
+
+	re->options = options;
+	re->cached  = false;
+	re->pattern = oscap_strdup(pattern);
+	re->next    = NULL;
+
+	return re;
+}
+
+oval_regex_t *oval_regex_get(const char *pattern, int options, const char **errptr, int *erroffset)
+{
+	struct oval_regex *re;
+	size_t h;
+
+	pthread_once(&regex_cache_once, oval_regex_cache_init);
+	h = oval_regex_hash(pattern, options);
+
+	pthread_mutex_lock(&regex_cache.lock);
+
+	for (re = regex_cache.table[h]; re != NULL; re = re->next) {
+		if (re->options == options && strcmp(re->pattern, pattern) == 0) {
+			++regex_cache.hits;
+			pthread_mutex_unlock(&regex_cache.lock);
+			return re;
+		}
+	}
+
+	++regex_cache.misses;
+	pthread_mutex_unlock(&regex_cache.lock);
+
+	/* compile without holding the lock, other threads may use the cache meanwhile */
+	re = oval_regex_compile(pattern, options, errptr, erroffset);
+
+	if (re == NULL)
+		return NULL;
+
+	pthread_mutex_lock(&regex_cache.lock);
+
+	if (regex_cache.count < regex_cache.max) {
+		struct oval_regex *other;
+
+		/* another thread might have compiled the same pattern */
+		for (other = regex_cache.table[h]; other != NULL; other = other->next) {
+			if (other->options == options && strcmp(other->pattern, pattern) == 0)
+				break;
+		}
+
+		if (other == NULL) {
+			re->cached = true;
+			re->next = regex_cache.table[h];
+			regex_cache.table[h] = re;
+			++regex_cache.count;
+		} else {
+			oval_regex_free(re);
+			re = other;
+		}
+	}
+
+	pthread_mutex_unlock(&regex_cache.lock);
+
+	return re;
+}
+
+void oval_regex_put(oval_regex_t *re)
+{
+	if (re != NULL && !re->cached)
+		oval_regex_free(re);
+}
+
+int oval_regex_exec(const oval_regex_t *re, const char *subject, int length,
+                    int options, int *ovector, int ovecsize)
+{
+	return pcre_exec(re->re, re->extra, subject, length, 0, options, ovector, ovecsize);
+}
+
+#endif /* USE_REGEX_PCRE */
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OSCAP_OVAL_REGEX_CACHE_IMPL_H_
+#define OSCAP_OVAL_REGEX_CACHE_IMPL_H_
+
+#include "../common/util.h"
+
+#if defined USE_REGEX_PCRE
+
+OSCAP_HIDDEN_START;
+
+typedef struct oval_regex oval_regex_t;
+
+/**
+ * Get the compiled form of a pattern. Patterns are compiled (and studied,
+ * using the JIT where available) only once per process and shared by all
+ * threads. At most OSCAP_REGEX_CACHE_MAX (4096 by default, 0 turns the
+ * cache off) patterns are kept. The returned regex has to be released with oval_regex_put().
+ * @return NULL if the pattern can't be compiled, errptr and erroffset
+ * are set like by pcre_compile() in that case
+ */
+oval_regex_t *oval_regex_get(const char *pattern, int options, const char **errptr, int *erroffset);
+
+/**
+ * Release a regex returned by oval_regex_get().
+ */
+void oval_regex_put(oval_regex_t *re);
+
+/**
+ * Log the statistics of the cache and free the cached patterns. No regex
+ * returned by oval_regex_get() may be in use, the cache can be used again
+ * afterwards. Called by oscap_cleanup() and by a probe when it ends.
+ */
+void oval_regex_cache_free(void);
+
+/**
+ * pcre_exec() with a regex returned by oval_regex_get().
+ */
+int oval_regex_exec(const oval_regex_t *re, const char *subject, int length,
+                    int options, int *ovector, int ovecsize);
+
+OSCAP_HIDDEN_END;
+
+#endif /* USE_REGEX_PCRE */
+
+#endif
@@ -43,6 +43,7 @@
 #include "oval_probe_impl.h"
 #include "results/oval_results_impl.h"
 #include "oval_directives_impl.h"
+#include "oval_xml_stream_impl.h"
 
 #include "common/util.h"
 #include "common/debug_priv.h"
@@ -273,6 +274,7 @@ static xmlNode *oval_results_to_dom(struct oval_results_model *results_model,
 
 	xmlSetNs(root_node, ns_common);
 	xmlSetNs(root_node, ns_results);
+	oval_xml_stream_open(doc, root_node);
 
 	/* Report generator */
 	oval_generator_to_dom(results_model->generator, doc, root_node);
@@ -291,13 +293,16 @@ static xmlNode *oval_results_to_dom(struct oval_results_model *results_model,
 	}
 
 	xmlNode *results_node = xmlNewTextChild(root_node, ns_results, BAD_CAST "results", NULL);
+	oval_xml_stream_open(doc, results_node);
 	struct oval_result_system_iterator *systems = oval_results_model_get_systems(results_model);
 	while (oval_result_system_iterator_has_more(systems)) {
 		struct oval_result_system *sys = oval_result_system_iterator_next(systems);
 		oval_result_system_to_dom(sys, results_model, dirs_model, doc, results_node);
 	}
 	oval_result_system_iterator_free(systems);
+	oval_xml_stream_close(doc, results_node);
 
+	oval_xml_stream_close(doc, root_node);
 	return root_node;
 }
 
@@ -319,12 +324,23 @@ int oval_results_model_export(struct oval_results_model *results_model,
 			      struct oval_directives_model *directives_model,
 			      const char *file)
 {
-	struct oscap_source *source = oval_results_model_export_source(results_model, directives_model, file);
-	if (source == NULL) {
+	__attribute__nonnull__(results_model);
+
+	/* The results are written as they are serialized, the whole document
+	 * with all the collected items is never held in memory. */
+	xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+	if (doc == NULL) {
+		oscap_setxmlerr(xmlGetLastError());
 		return -1;
 	}
-	int ret = oscap_source_save_as(source, NULL);
-	oscap_source_free(source);
+	if (oval_xml_stream_start(doc, file) != 0) {
+		xmlFreeDoc(doc);
+		return -1;
+	}
+
+	oval_results_to_dom(results_model, directives_model, doc, NULL);
+	int ret = oval_xml_stream_finish(doc);
+	xmlFreeDoc(doc);
 	return ret;
 }
 
@@ -46,6 +46,7 @@
 #include "adt/oval_smc_iterator_impl.h"
 #include "adt/oval_string_map_impl.h"
 #include "oval_parser_impl.h"
+#include "oval_xml_stream_impl.h"
 
 #include "common/debug_priv.h"
 #include "common/_error.h"
@@ -423,10 +424,12 @@ xmlNode *oval_result_system_to_dom(struct oval_result_system * sys,
 
 	xmlNs *ns_results = xmlSearchNsByHref(doc, parent, OVAL_RESULTS_NAMESPACE);
 	xmlNode *system_node = xmlNewTextChild(parent, ns_results, BAD_CAST "system", NULL);
+	oval_xml_stream_open(doc, system_node);
 
 	struct oval_smc *tstmap = oval_smc_new();
 
 	xmlNode *definitions_node = xmlNewTextChild(system_node, ns_results, BAD_CAST "definitions", NULL);
+	oval_xml_stream_open(doc, definitions_node);
 	struct oval_definition_model *definition_model = oval_results_model_get_definition_model(results_model);
 	struct oval_definition_iterator *oval_definitions = oval_definition_model_get_definitions(definition_model);
 	while(oval_definition_iterator_has_more(oval_definitions)) {
@@ -452,8 +455,10 @@ xmlNode *oval_result_system_to_dom(struct oval_result_system * sys,
 				_oval_result_definition_to_dom_based_on_directives(rslt_definition, directives, doc, definitions_node, tstmap);
 			}
 		}
+		oval_xml_stream_flush(doc, definitions_node);
 	}
 	oval_definition_iterator_free(oval_definitions);
+	oval_xml_stream_close(doc, definitions_node);
 
 	struct oval_syschar_model *syschar_model = oval_result_system_get_syschar_model(sys);
 	struct oval_string_map *sysmap = oval_string_map_new();
@@ -464,11 +469,13 @@ xmlNode *oval_result_system_to_dom(struct oval_result_system * sys,
 	struct oval_smc_iterator *result_tests = oval_smc_iterator_new(tstmap);
 	if (oval_smc_iterator_has_more(result_tests)) {
 		xmlNode *tests_node = xmlNewTextChild(system_node, ns_results, BAD_CAST "tests", NULL);
+		oval_xml_stream_open(doc, tests_node);
 		while (oval_smc_iterator_has_more(result_tests)) {
 			struct oval_state_iterator *ste_itr;
 			struct oval_result_test *result_test = oval_smc_iterator_next(result_tests);
 			/* report the test */
 			oval_result_test_to_dom(result_test, doc, tests_node);
+			oval_xml_stream_flush(doc, tests_node);
 			struct oval_test *oval_test = oval_result_test_get_test(result_test);
 			/* collect the objects that are referenced from reported test */
 			/* look for objects in path: test->object ...  */
@@ -503,6 +510,7 @@ xmlNode *oval_result_system_to_dom(struct oval_result_system * sys,
 			}
 			oval_state_iterator_free(ste_itr);
 		}
+		oval_xml_stream_close(doc, tests_node);
 	}
 	oval_smc_iterator_free(result_tests);
 
@@ -516,6 +524,7 @@ xmlNode *oval_result_system_to_dom(struct oval_result_system * sys,
 	oval_string_map_free(varmap, NULL);
 	oval_smc_free0(tstmap);
 
+	oval_xml_stream_close(doc, system_node);
 	return system_node;
 }
 
@@ -471,131 +471,469 @@ static inline oval_result_t _evaluate_sysent(struct oval_syschar_model *syschar_
 	}
 }
 
-static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct oval_sysitem *cur_sysitem, struct oval_state *state)
+/*
+ * The states of a test are compared with every item collected for the test,
+ * so they are prepared once per test evaluation. The contents of a state are
+ * gathered into an array with the name, operation and checks of their
+ * entities, and the values of the entities (or the values of the variables
+ * they refer to) are parsed by oval_cmp_value_init(). Entities which can't
+ * be prepared are evaluated by _evaluate_sysent() for every item, which
+ * reports the problem the same way as before.
+ *
+ * The entity names of all states are put to a small hash table, so the
+ * entities of an item are matched with the state entities in a single pass
+ * over the item. The positions of the matching item entities are stored in
+ * the state entities.
+ */
+struct ste_ent {
+	struct oval_state_content *content;
+	struct oval_entity *entity;
+	const char *name;
+	oval_operation_t operation;
+	oval_check_t ent_check;
+	oval_check_t var_check;
+	oval_existence_t check_existence;
+	bool mask;
+	bool is_variable;
+	bool resolved;   /* the values were resolved, variables are resolved when needed first */
+	bool prepared;   /* the values can be used, _evaluate_sysent() is used otherwise */
+	bool null_value; /* a value of the variable without text follows the values */
+	size_t nvals;
+	struct oval_cmp_value *vals;
+	const struct oval_evr **evrs;  /* the parsed values if all of them are EVR strings */
+	oval_result_t *evr_results;
+	size_t *slots;   /* positions of the matching entities of the current item */
+	size_t nslots;
+	size_t slots_size;
+};
+
+struct ste_eval {
+	struct oval_state *state;
+	size_t count;
+	struct ste_ent *ents;
+	const char *error; /* internal error found after the entities */
+};
+
+struct ste_name {
+	const char *name;
+	uint32_t hash;
+	size_t count;
+	struct ste_ent **ents;
+};
+
+struct tst_eval {
+	bool compiled;
+	size_t ste_cnt;
+	struct ste_eval *stes;
+	size_t names_size;
+	struct ste_name *names;
+	/* the item being evaluated */
+	size_t item_cnt;
+	struct oval_sysent * const *item_ents;
+	bool item_invalid;
+	struct oval_status_counter counter;
+};
+
+static void _ste_ent_add_value(struct ste_ent *ent, char *text, oval_datatype_t datatype)
 {
-	struct oval_state_content_iterator *state_contents_itr;
-	struct oresults ste_ores;
-	oval_operator_t operator;
-	oval_result_t result = OVAL_RESULT_ERROR;
+	ent->vals = oscap_realloc(ent->vals, (ent->nvals + 1) * sizeof(struct oval_cmp_value));
+	oval_cmp_value_init(&ent->vals[ent->nvals++], text, datatype, ent->operation);
+}
 
-	ores_clear(&ste_ores);
+static void _ste_ent_resolve_variable(struct oval_syschar_model *syschar_model, struct ste_ent *ent)
+{
+	struct oval_variable *var;
+	struct oval_value_iterator *val_itr;
+	oval_syschar_collection_flag_t flag;
+
+	ent->resolved = true;
+
+	var = oval_entity_get_variable(ent->entity);
+	if (var == NULL || oval_syschar_model_compute_variable(syschar_model, var) != 0)
+		return;
+
+	flag = oval_variable_get_collection_flag(var);
+	if (flag != SYSCHAR_FLAG_COMPLETE && flag != SYSCHAR_FLAG_INCOMPLETE)
+		return;
+
+	val_itr = oval_variable_get_values(var);
+	while (oval_value_iterator_has_more(val_itr)) {
+		struct oval_value *var_val;
+		char *text;
+
+		var_val = oval_value_iterator_next(val_itr);
+		text = oval_value_get_text(var_val);
+		if (text == NULL) {
+			ent->null_value = true;
+			break;
+		}
+		_ste_ent_add_value(ent, text, oval_value_get_datatype(var_val));
+	}
+	oval_value_iterator_free(val_itr);
+
+	ent->prepared = true;
+
+	if (ent->nvals > 1) {
+		size_t i;
+
+		for (i = 0; i < ent->nvals; ++i) {
+			if (!ent->vals[i].parsed || (ent->vals[i].datatype != OVAL_DATATYPE_EVR_STRING
+			                             && ent->vals[i].datatype != OVAL_DATATYPE_DEBIAN_EVR_STRING))
+				break;
+		}
+		if (i == ent->nvals) {
+			ent->evrs = oscap_alloc(ent->nvals * sizeof(struct oval_evr *));
+			ent->evr_results = oscap_alloc(ent->nvals * sizeof(oval_result_t));
+			for (i = 0; i < ent->nvals; ++i)
+				ent->evrs[i] = &ent->vals[i].u.evr;
+		}
+	}
+}
+
+static void _ste_ent_init(struct ste_ent *ent, struct oval_state *state, struct oval_state_content *content, struct oval_entity *state_entity, const char *state_entity_name)
+{
+	memset(ent, 0, sizeof(*ent));
+
+	if (oscap_streq(state_entity_name, "line") &&
+		oval_state_get_subtype(state) == (oval_subtype_t) OVAL_INDEPENDENT_TEXT_FILE_CONTENT) {
+		/* Hack: textfilecontent_state/line shall be compared against textfilecontent_item/text.
+		 *
+		 * textfilecontent_test and textfilecontent54_test share the same syschar
+		 * (textfilecontent_item). In OVAL 5.3 and below this syschar did not hold any usable
+		 * information ('text' ent). In OVAL 5.4 textfilecontent_test was deprecated. But the
+		 * 'text' ent has been added to textfilecontent_item, making it potentially usable. */
+		oval_schema_version_t over = oval_state_get_platform_schema_version(state);
+		if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.4)) >= 0) {
+			/* The OVAL-5.3 does not have textfilecontent_item/text */
+			state_entity_name = "text";
+		}
+	}
+
+	ent->content = content;
+	ent->entity = state_entity;
+	ent->name = state_entity_name;
+	ent->operation = oval_entity_get_operation(state_entity);
+	ent->ent_check = oval_state_content_get_ent_check(content);
+	ent->var_check = oval_state_content_get_var_check(content);
+	ent->check_existence = oval_state_content_get_check_existence(content);
+	ent->mask = oval_entity_get_mask(state_entity);
+
+	if (oval_entity_get_varref_type(state_entity) == OVAL_ENTITY_VARREF_ATTRIBUTE) {
+		ent->is_variable = true;
+	} else {
+		struct oval_value *state_entity_val;
+		char *state_entity_val_text;
+
+		ent->resolved = true;
+		state_entity_val = oval_entity_get_value(state_entity);
+		if (state_entity_val == NULL)
+			return;
+		state_entity_val_text = oval_value_get_text(state_entity_val);
+		if (state_entity_val_text == NULL)
+			return;
+		_ste_ent_add_value(ent, state_entity_val_text, oval_value_get_datatype(state_entity_val));
+		ent->prepared = true;
+	}
+}
+
+static void _ste_eval_compile(struct ste_eval *ste)
+{
+	struct oval_state_content_iterator *state_contents_itr;
+	size_t size = 0;
 
-	state_contents_itr = oval_state_get_contents(state);
+	state_contents_itr = oval_state_get_contents(ste->state);
 	while (oval_state_content_iterator_has_more(state_contents_itr)) {
 		struct oval_state_content *content;
 		struct oval_entity *state_entity;
 		char *state_entity_name;
-		oval_operation_t state_entity_operation;
-		oval_check_t entity_check;
-		oval_existence_t check_existence;
-		oval_result_t ste_ent_res;
-		struct oval_sysent_iterator *item_entities_itr;
-		struct oresults ent_ores;
-		struct oval_status_counter counter;
-		bool found_matching_item;
 
 		if ((content = oval_state_content_iterator_next(state_contents_itr)) == NULL) {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL state content");
-			goto fail;
+			ste->error = "OVAL internal error: found NULL state content";
+			break;
 		}
 		if ((state_entity = oval_state_content_get_entity(content)) == NULL) {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity");
-			goto fail;
+			ste->error = "OVAL internal error: found NULL entity";
+			break;
 		}
 		if ((state_entity_name = oval_entity_get_name(state_entity)) == NULL) {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity name");
-			goto fail;
+			ste->error = "OVAL internal error: found NULL entity name";
+			break;
 		}
 
-		if (oscap_streq(state_entity_name, "line") &&
-			oval_state_get_subtype(state) == (oval_subtype_t) OVAL_INDEPENDENT_TEXT_FILE_CONTENT) {
-			/* Hack: textfilecontent_state/line shall be compared against textfilecontent_item/text.
-			 *
-			 * textfilecontent_test and textfilecontent54_test share the same syschar
-			 * (textfilecontent_item). In OVAL 5.3 and below this syschar did not hold any usable
-			 * information ('text' ent). In OVAL 5.4 textfilecontent_test was deprecated. But the
-			 * 'text' ent has been added to textfilecontent_item, making it potentially usable. */
-			oval_schema_version_t over = oval_state_get_platform_schema_version(state);
-			if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.4)) >= 0) {
-				/* The OVAL-5.3 does not have textfilecontent_item/text */
-				state_entity_name = "text";
-			}
+		if (ste->count == size) {
+			size = size ? 2 * size : 8;
+			ste->ents = oscap_realloc(ste->ents, size * sizeof(struct ste_ent));
 		}
+		_ste_ent_init(&ste->ents[ste->count++], ste->state, content, state_entity, state_entity_name);
+	}
+	oval_state_content_iterator_free(state_contents_itr);
+}
 
-		entity_check = oval_state_content_get_ent_check(content);
-		check_existence = oval_state_content_get_check_existence(content);
-		state_entity_operation = oval_entity_get_operation(state_entity);
+static void _ste_eval_clear(struct ste_eval *ste)
+{
+	for (size_t i = 0; i < ste->count; ++i) {
+		struct ste_ent *ent = &ste->ents[i];
+
+		for (size_t j = 0; j < ent->nvals; ++j)
+			oval_cmp_value_clear(&ent->vals[j]);
+		oscap_free(ent->vals);
+		oscap_free(ent->evrs);
+		oscap_free(ent->evr_results);
+		oscap_free(ent->slots);
+	}
+	oscap_free(ste->ents);
+}
 
-		ores_clear(&ent_ores);
-		found_matching_item = false;
-		oval_status_counter_clear(&counter);
+static uint32_t _ste_name_hash(const char *name)
+{
+	uint32_t h = 2166136261U;
 
-		item_entities_itr = oval_sysitem_get_sysents(cur_sysitem);
-		while (oval_sysent_iterator_has_more(item_entities_itr)) {
-			struct oval_sysent *item_entity;
-			oval_result_t ent_val_res;
-			char *item_entity_name;
-			oval_syschar_status_t item_status;
-
-			item_entity = oval_sysent_iterator_next(item_entities_itr);
-			if (item_entity == NULL) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL sysent");
-				oval_sysent_iterator_free(item_entities_itr);
-				goto fail;
+	while (*name != '\0') {
+		h ^= (unsigned char)*name++;
+		h *= 16777619U;
+	}
+
+	return h;
+}
+
+static struct ste_name *_tst_eval_lookup(struct tst_eval *tst, const char *name, uint32_t hash)
+{
+	size_t i = hash & (tst->names_size - 1);
+
+	while (tst->names[i].name != NULL) {
+		if (tst->names[i].hash == hash && strcmp(tst->names[i].name, name) == 0)
+			return &tst->names[i];
+		i = (i + 1) & (tst->names_size - 1);
+	}
+
+	return &tst->names[i];
+}
+
+static void _tst_eval_compile(struct tst_eval *tst)
+{
+	size_t i, j, total = 0;
+
+	tst->compiled = true;
+
+	for (i = 0; i < tst->ste_cnt; ++i) {
+		_ste_eval_compile(&tst->stes[i]);
+		total += tst->stes[i].count;
+	}
+
+	tst->names_size = 8;
+	while (tst->names_size < 2 * total)
+		tst->names_size *= 2;
+	tst->names = oscap_calloc(tst->names_size, sizeof(struct ste_name));
+
+	for (i = 0; i < tst->ste_cnt; ++i) {
+		for (j = 0; j < tst->stes[i].count; ++j) {
+			struct ste_ent *ent = &tst->stes[i].ents[j];
+			uint32_t hash = _ste_name_hash(ent->name);
+			struct ste_name *n = _tst_eval_lookup(tst, ent->name, hash);
+
+			n->name = ent->name;
+			n->hash = hash;
+			n->ents = oscap_realloc(n->ents, (n->count + 1) * sizeof(struct ste_ent *));
+			n->ents[n->count++] = ent;
+		}
+	}
+}
+
+static void _tst_eval_free(struct tst_eval *tst)
+{
+	size_t i;
+
+	for (i = 0; i < tst->ste_cnt; ++i)
+		_ste_eval_clear(&tst->stes[i]);
+	oscap_free(tst->stes);
+
+	for (i = 0; i < tst->names_size; ++i)
+		oscap_free(tst->names[i].ents);
+	oscap_free(tst->names);
+}
+
+/* Match the entities of an item with the entities of the states */
+static void _tst_eval_set_item(struct tst_eval *tst, struct oval_sysitem *cur_sysitem)
+{
+	size_t i, j;
+
+	if (!tst->compiled)
+		_tst_eval_compile(tst);
+
+	for (i = 0; i < tst->ste_cnt; ++i) {
+		for (j = 0; j < tst->stes[i].count; ++j)
+			tst->stes[i].ents[j].nslots = 0;
+	}
+
+	tst->item_cnt = oval_sysitem_get_sysent_array(cur_sysitem, &tst->item_ents);
+	tst->item_invalid = false;
+	oval_status_counter_clear(&tst->counter);
+
+	for (i = 0; i < tst->item_cnt; ++i) {
+		struct oval_sysent *item_entity = tst->item_ents[i];
+		const char *item_entity_name;
+		struct ste_name *n;
+
+		if (item_entity == NULL) {
+			tst->item_invalid = true;
+			tst->item_cnt = i;
+			break;
+		}
+		oval_status_counter_add_status(&tst->counter, oval_sysent_get_status(item_entity));
+
+		item_entity_name = oval_sysent_get_name(item_entity);
+		n = _tst_eval_lookup(tst, item_entity_name, _ste_name_hash(item_entity_name));
+
+		for (j = 0; j < n->count; ++j) {
+			struct ste_ent *ent = n->ents[j];
+
+			if (ent->nslots == ent->slots_size) {
+				ent->slots_size = ent->slots_size ? 2 * ent->slots_size : 4;
+				ent->slots = oscap_realloc(ent->slots, ent->slots_size * sizeof(size_t));
 			}
-			item_status = oval_sysent_get_status(item_entity);
-			oval_status_counter_add_status(&counter, item_status);
+			ent->slots[ent->nslots++] = i;
+		}
+	}
+}
 
-			item_entity_name = oval_sysent_get_name(item_entity);
-			if (strcmp(item_entity_name, state_entity_name))
-				continue;
+/* EVR strings and versions collected from the system are parsed once and kept by the sysent */
+static oval_result_t _ste_value_cmp(struct oval_cmp_value *value, struct oval_sysent *item_entity)
+{
+	if (value->parsed) {
+		switch (value->datatype) {
+		case OVAL_DATATYPE_EVR_STRING:
+		case OVAL_DATATYPE_DEBIAN_EVR_STRING: {
+			const struct oval_evr *sys_evr = oval_sysent_get_evr(item_entity);
+
+			if (sys_evr != NULL)
+				return oval_evr_string_cmp_parsed(&value->u.evr, sys_evr, value->operation);
+			break;
+		}
+		case OVAL_DATATYPE_VERSION: {
+			const struct oval_versiontype *sys_ver = oval_sysent_get_versiontype(item_entity);
+
+			if (sys_ver != NULL)
+				return oval_versiontype_cmp_parsed(&value->u.version, sys_ver, value->operation);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	return oval_cmp_value_cmp(value, oval_sysent_get_value(item_entity));
+}
+
+static oval_result_t _evaluate_ste_ent(struct oval_syschar_model *syschar_model, struct ste_ent *ent, struct oval_sysent *item_entity)
+{
+	struct oresults var_ores;
+	const struct oval_evr *sys_evr;
+
+	if (oval_sysent_get_status(item_entity) == SYSCHAR_STATUS_DOES_NOT_EXIST)
+		return OVAL_RESULT_FALSE;
+
+	if (!ent->resolved)
+		_ste_ent_resolve_variable(syschar_model, ent);
+
+	if (!ent->prepared)
+		return _evaluate_sysent(syschar_model, item_entity, ent->entity, ent->operation, ent->content);
+
+	if (!ent->is_variable)
+		return _ste_value_cmp(&ent->vals[0], item_entity);
+
+	ores_clear(&var_ores);
+
+	if (ent->evrs != NULL && (sys_evr = oval_sysent_get_evr(item_entity)) != NULL) {
+		/* all values of the variable are thresholds for the same collected EVR */
+		oval_evr_string_cmp_batch(ent->evrs, ent->nvals, sys_evr, ent->operation, ent->evr_results);
+		for (size_t i = 0; i < ent->nvals; ++i)
+			ores_add_res(&var_ores, ent->evr_results[i]);
+		goto done;
+	}
 
-			found_matching_item = true;
+	for (size_t i = 0; i < ent->nvals; ++i) {
+		oval_result_t var_val_res;
+
+		var_val_res = _ste_value_cmp(&ent->vals[i], item_entity);
+		if (var_val_res == OVAL_RESULT_ERROR) {
+			dE("Error occured when comparing a variable '%s' value '%s' with collected item entity = '%s'",
+				oval_variable_get_id(oval_entity_get_variable(ent->entity)), ent->vals[i].text,
+				oval_sysent_get_value(item_entity));
+		}
+		ores_add_res(&var_ores, var_val_res);
+	}
+done:
+	if (ent->null_value) {
+		dE("Found NULL variable value text.");
+		ores_add_res(&var_ores, OVAL_RESULT_ERROR);
+	}
+
+	return ores_get_result_bychk(&var_ores, ent->var_check);
+}
+
+static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct oval_sysitem *cur_sysitem, struct tst_eval *tst, struct ste_eval *ste)
+{
+	struct oresults ste_ores;
+	oval_operator_t operator;
+	oval_result_t result = OVAL_RESULT_ERROR;
+
+	ores_clear(&ste_ores);
+
+	for (size_t i = 0; i < ste->count; ++i) {
+		struct ste_ent *ent = &ste->ents[i];
+		oval_result_t ste_ent_res;
+		struct oresults ent_ores;
+
+		if (tst->item_invalid) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL sysent");
+			return OVAL_RESULT_ERROR;
+		}
+
+		ores_clear(&ent_ores);
+
+		for (size_t j = 0; j < ent->nslots; ++j) {
+			struct oval_sysent *item_entity = tst->item_ents[ent->slots[j]];
+			oval_result_t ent_val_res;
 
 			/* copy mask attribute from state to item */
-			if (oval_entity_get_mask(state_entity))
+			if (ent->mask)
 				oval_sysent_set_mask(item_entity,1);
 
-			ent_val_res = _evaluate_sysent(syschar_model, item_entity, state_entity,
-					state_entity_operation, content);
+			ent_val_res = _evaluate_ste_ent(syschar_model, ent, item_entity);
 			if (ent_val_res == OVAL_RESULT_TRUE) {
 				dI("Entity '%s'='%s' of item '%s' matches corresponding entity in state '%s'.",
 						oval_sysent_get_name(item_entity),
 						oval_sysent_get_value(item_entity),
-						oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state));
-			}
-			if (((signed) ent_val_res) == -1) {
-				oval_sysent_iterator_free(item_entities_itr);
-				goto fail;
+						oval_sysitem_get_id(cur_sysitem), oval_state_get_id(ste->state));
 			}
+			if (((signed) ent_val_res) == -1)
+				return OVAL_RESULT_ERROR;
 
 			ores_add_res(&ent_ores, ent_val_res);
 		}
-		oval_sysent_iterator_free(item_entities_itr);
 
-		if (!found_matching_item)
+		if (ent->nslots == 0)
 			dW("Entity name '%s' from state (id: '%s') not found in item (id: '%s').",
-			   state_entity_name, oval_state_get_id(state), oval_sysitem_get_id(cur_sysitem));
+			   ent->name, oval_state_get_id(ste->state), oval_sysitem_get_id(cur_sysitem));
 
-		ste_ent_res = ores_get_result_bychk(&ent_ores, entity_check);
+		ste_ent_res = ores_get_result_bychk(&ent_ores, ent->ent_check);
 		ores_add_res(&ste_ores, ste_ent_res);
-		oval_result_t cres = oval_status_counter_get_result(&counter, check_existence);
+		oval_result_t cres = oval_status_counter_get_result(&tst->counter, ent->check_existence);
 		ores_add_res(&ste_ores, cres);
 	}
-	oval_state_content_iterator_free(state_contents_itr);
 
-	operator = oval_state_get_operator(state);
+	if (ste->error != NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "%s", ste->error);
+		return OVAL_RESULT_ERROR;
+	}
+
+	operator = oval_state_get_operator(ste->state);
 	result = ores_get_result_byopr(&ste_ores, operator);
 	dI("Item '%s' compared to state '%s' with result %s.",
-			   oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state),
+			   oval_sysitem_get_id(cur_sysitem), oval_state_get_id(ste->state),
 			   oval_result_get_text(result));
 
 	return result;
-
- fail:
-	oval_state_content_iterator_free(state_contents_itr);
-
-	return OVAL_RESULT_ERROR;
 }
 
 #define ITEMMAP (struct oval_string_map    *)args[2]
@@ -618,10 +956,12 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 {
 	struct oval_syschar_model *syschar_model;
 	struct oval_result_item_iterator *ritems_itr;
+	struct oval_state_iterator *ste_itr;
 	struct oresults item_ores;
 	oval_result_t result;
 	oval_check_t ste_check;
 	oval_operator_t ste_opr;
+	struct tst_eval tst;
 
 	ste_check = oval_test_get_check(test);
 	ste_opr = oval_test_get_state_operator(test);
@@ -635,13 +975,22 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 		oscap_free(state_names);
 	}
 
+	/* the states are compiled when the first item is evaluated */
+	memset(&tst, 0, sizeof(tst));
+	ste_itr = oval_test_get_states(test);
+	while (oval_state_iterator_has_more(ste_itr)) {
+		tst.stes = oscap_realloc(tst.stes, (tst.ste_cnt + 1) * sizeof(struct ste_eval));
+		memset(&tst.stes[tst.ste_cnt], 0, sizeof(struct ste_eval));
+		tst.stes[tst.ste_cnt++].state = oval_state_iterator_next(ste_itr);
+	}
+	oval_state_iterator_free(ste_itr);
+
 	ritems_itr = oval_result_test_get_items(TEST);
 	while (oval_result_item_iterator_has_more(ritems_itr)) {
 		struct oval_result_item *ritem;
 		struct oval_sysitem *item;
 		oval_syschar_status_t item_status;
 		struct oresults ste_ores;
-		struct oval_state_iterator *ste_itr;
 		oval_result_t item_res;
 
 		ritem = oval_result_item_iterator_next(ritems_itr);
@@ -665,17 +1014,14 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 		}
 
 		ores_clear(&ste_ores);
+		_tst_eval_set_item(&tst, item);
 
-		ste_itr = oval_test_get_states(test);
-		while (oval_state_iterator_has_more(ste_itr)) {
-			struct oval_state *ste;
+		for (size_t i = 0; i < tst.ste_cnt; ++i) {
 			oval_result_t ste_res;
 
-			ste = oval_state_iterator_next(ste_itr);
-			ste_res = eval_item(syschar_model, item, ste);
+			ste_res = eval_item(syschar_model, item, &tst, &tst.stes[i]);
 			ores_add_res(&ste_ores, ste_res);
 		}
-		oval_state_iterator_free(ste_itr);
 
 		item_res = ores_get_result_byopr(&ste_ores, ste_opr);
 		ores_add_res(&item_ores, item_res);
@@ -683,6 +1029,8 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 	}
 	oval_result_item_iterator_free(ritems_itr);
 
+	_tst_eval_free(&tst);
+
 	result = ores_get_result_bychk(&item_ores, ste_check);
 
 	return result;
@@ -207,6 +207,20 @@ void xccdf_session_set_custom_oval_files(struct xccdf_session *session, char **o
  */
 void xccdf_session_set_custom_oval_eval_fn(struct xccdf_session *session, xccdf_policy_engine_eval_fn eval_fn);
 
+/**
+ * Set whether only the OVAL definitions referenced by the selected rules shall be loaded.
+ * When enabled, @ref xccdf_session_load_oval only locates and validates the OVAL files
+ * and the definitions are loaded by @ref xccdf_session_evaluate for the selected profile,
+ * together with the tests, objects, states and variables they depend on. Files referenced
+ * by a rule without a definition name are loaded completely. The OVAL results then
+ * contain only the loaded definitions. This function shall be called before OVAL files
+ * are parsed.
+ * @memberof xccdf_session
+ * @param session XCCDF Session
+ * @param selective true to load only the selected definitions, default is false
+ */
+void xccdf_session_set_oval_selective_loading(struct xccdf_session *session, bool selective);
+
 /**
  * Set custom product CPE name.
  * @memberof xccdf_session
@@ -86,6 +86,8 @@ struct xccdf_session {
 		struct oval_content_resource **resources;///< OVAL files referenced from XCCDF
 		struct oval_agent_session **agents;	///< OVAL Agent Session
 		xccdf_policy_engine_eval_fn user_eval_fn;///< Custom OVAL engine callback
+		bool selective_loading;			///< Load only the definitions referenced by the selected rules
+		struct xccdf_policy *agents_policy;	///< Policy the agents were selectively loaded for
 		char *product_cpe;			///< CPE of scanner product.
 		struct oscap_source* arf_report;	///< ARF report
 		struct oscap_htable *result_sources;    ///< mapping 'filepath' to oscap_source for OVAL results
@@ -363,6 +365,11 @@ void xccdf_session_set_custom_oval_eval_fn(struct xccdf_session *session, xccdf_
 	session->oval.user_eval_fn = eval_fn;
 }
 
+void xccdf_session_set_oval_selective_loading(struct xccdf_session *session, bool selective)
+{
+	session->oval.selective_loading = selective;
+}
+
 bool xccdf_session_set_product_cpe(struct xccdf_session *session, const char *product_cpe)
 {
 	oscap_free(session->oval.product_cpe);
@@ -871,42 +878,110 @@ static void _xccdf_session_free_oval_agents(struct xccdf_session *session)
 		}
 		free(session->oval.agents);
 		session->oval.agents = NULL;
+		session->oval.agents_policy = NULL;
 	}
 }
 
-int xccdf_session_load_oval(struct xccdf_session *session)
+static void _xccdf_check_collect_oval_names(struct xccdf_check *check, const char *href, struct oscap_stringlist *names, bool *whole_file)
 {
-	struct oval_content_resource **contents = NULL;
+	if (xccdf_check_get_complex(check)) {
+		struct xccdf_check_iterator *child_it = xccdf_check_get_children(check);
+		while (xccdf_check_iterator_has_more(child_it))
+			_xccdf_check_collect_oval_names(xccdf_check_iterator_next(child_it), href, names, whole_file);
+		xccdf_check_iterator_free(child_it);
+		return;
+	}
+	if (oscap_strcmp(xccdf_check_get_system(check), oval_sysname) != 0)
+		return;
 
-	_xccdf_session_free_oval_agents(session);
+	struct xccdf_check_content_ref_iterator *ref_it = xccdf_check_get_content_refs(check);
+	while (xccdf_check_content_ref_iterator_has_more(ref_it)) {
+		struct xccdf_check_content_ref *ref = xccdf_check_content_ref_iterator_next(ref_it);
+		if (oscap_strcmp(xccdf_check_content_ref_get_href(ref), href) != 0)
+			continue;
+		const char *name = xccdf_check_content_ref_get_name(ref);
+		if (name == NULL)
+			*whole_file = true;  // all the definitions are evaluated
+		else
+			oscap_stringlist_add_string(names, name);
+	}
+	xccdf_check_content_ref_iterator_free(ref_it);
+}
 
-	/* Locate all OVAL files */
-	if (session->oval.custom_resources == NULL) {
-		/* Use OVAL files from policy model */
-		if (_xccdf_session_get_oval_from_model(session) != 0)
-			return 1;
+static void _xccdf_item_collect_oval_names(struct xccdf_policy *policy, struct xccdf_item *item, const char *href, struct oscap_stringlist *names, bool *whole_file)
+{
+	struct xccdf_item_iterator *child_it;
+	struct xccdf_check_iterator *check_it;
+
+	switch (xccdf_item_get_type(item)) {
+	case XCCDF_RULE:
+		if (!xccdf_policy_is_item_selected(policy, xccdf_item_get_id(item)))
+			break;
+		check_it = xccdf_rule_get_checks(xccdf_item_to_rule(item));
+		while (xccdf_check_iterator_has_more(check_it))
+			_xccdf_check_collect_oval_names(xccdf_check_iterator_next(check_it), href, names, whole_file);
+		xccdf_check_iterator_free(check_it);
+		break;
+	case XCCDF_BENCHMARK:
+	case XCCDF_GROUP:
+		child_it = xccdf_item_get_type(item) == XCCDF_GROUP ?
+			xccdf_group_get_content(xccdf_item_to_group(item)) :
+			xccdf_benchmark_get_content(xccdf_item_to_benchmark(item));
+		while (xccdf_item_iterator_has_more(child_it))
+			_xccdf_item_collect_oval_names(policy, xccdf_item_iterator_next(child_it), href, names, whole_file);
+		xccdf_item_iterator_free(child_it);
+		break;
+	default:
+		break;
 	}
+}
 
-	contents = session->oval.custom_resources != NULL ? session->oval.custom_resources : session->oval.resources;
+/**
+ * Import the OVAL definitions of the file, only those referenced by the rules
+ * selected in the policy if it is given.
+ */
+static struct oval_definition_model *_xccdf_session_import_oval(struct xccdf_session *session, struct xccdf_policy *policy, struct oval_content_resource *content)
+{
+	if (policy == NULL)
+		return oval_definition_model_import_source(content->source);
 
-	/* Validate OVAL files. Only validate if the file doesn't come from a datastream
-	 * or if full validation was explicitly requested.
-	 */
-	if (session->validate && (!xccdf_session_is_sds(session) || session->full_validation)) {
-		for (int idx=0; contents[idx]; idx++) {
-			if (oscap_source_validate(contents[idx]->source, _reporter, NULL) != 0) {
-				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
-						oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
-						oscap_source_get_schema_version(session->source),
-						contents[idx]->href);
-				return 1;
-			}
-		}
+	struct oscap_stringlist *names = oscap_stringlist_new();
+	bool whole_file = false;
+	struct xccdf_benchmark *benchmark = xccdf_policy_model_get_benchmark(session->xccdf.policy_model);
+	_xccdf_item_collect_oval_names(policy, (struct xccdf_item *) benchmark, content->href, names, &whole_file);
+
+	struct oval_definition_model *def_model;
+	if (whole_file) {
+		dI("Loading all OVAL definitions from '%s'.", content->href);
+		def_model = oval_definition_model_import_source(content->source);
+	} else {
+		dI("Loading %d OVAL definitions referenced by the selected rules from '%s'.",
+			oscap_list_get_itemcount((struct oscap_list *) names), content->href);
+		def_model = oval_definition_model_import_source_selected(content->source, names);
 	}
+	oscap_stringlist_free(names);
+	return def_model;
+}
+
+/**
+ * Create the OVAL agent sessions and register them with the policy model.
+ * @param policy evaluated policy to load only the selected definitions for, or NULL to load all
+ */
+static int _xccdf_session_load_oval_agents(struct xccdf_session *session, struct xccdf_policy *policy)
+{
+	struct oval_content_resource **contents = session->oval.custom_resources != NULL ?
+		session->oval.custom_resources : session->oval.resources;
+
+	if (session->oval.agents != NULL) {
+		/* selected definitions are reloaded for another policy */
+		xccdf_policy_model_unregister_engines(session->xccdf.policy_model, oval_sysname);
+		_xccdf_session_free_oval_agents(session);
+	}
+	session->oval.agents_policy = policy;
 
 	for (int idx=0; contents[idx]; idx++) {
 		/* file -> def_model */
-		struct oval_definition_model *tmp_def_model = oval_definition_model_import_source(contents[idx]->source);
+		struct oval_definition_model *tmp_def_model = _xccdf_session_import_oval(session, policy, contents[idx]);
 		if (tmp_def_model == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Failed to create OVAL definition model from: '%s'.",
 				oscap_source_readable_origin(contents[idx]->source));
@@ -954,6 +1029,43 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 	return 0;
 }
 
+int xccdf_session_load_oval(struct xccdf_session *session)
+{
+	struct oval_content_resource **contents = NULL;
+
+	_xccdf_session_free_oval_agents(session);
+
+	/* Locate all OVAL files */
+	if (session->oval.custom_resources == NULL) {
+		/* Use OVAL files from policy model */
+		if (_xccdf_session_get_oval_from_model(session) != 0)
+			return 1;
+	}
+
+	contents = session->oval.custom_resources != NULL ? session->oval.custom_resources : session->oval.resources;
+
+	/* Validate OVAL files. Only validate if the file doesn't come from a datastream
+	 * or if full validation was explicitly requested.
+	 */
+	if (session->validate && (!xccdf_session_is_sds(session) || session->full_validation)) {
+		for (int idx=0; contents[idx]; idx++) {
+			if (oscap_source_validate(contents[idx]->source, _reporter, NULL) != 0) {
+				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Invalid %s (%s) content in %s",
+						oscap_document_type_to_string(oscap_source_get_scap_type(session->source)),
+						oscap_source_get_schema_version(session->source),
+						contents[idx]->href);
+				return 1;
+			}
+		}
+	}
+
+	/* With selective loading, the agents are created for the policy being evaluated */
+	if (session->oval.selective_loading)
+		return 0;
+
+	return _xccdf_session_load_oval_agents(session, NULL);
+}
+
 int xccdf_session_load_check_engine_plugin2(struct xccdf_session *session, const char *plugin_name, bool quiet)
 {
 	struct check_engine_plugin_def *plugin = check_engine_plugin_load2(plugin_name, quiet);
@@ -1075,6 +1187,12 @@ int xccdf_session_evaluate(struct xccdf_session *session)
 		return 1;
 	}
 
+	if (session->oval.selective_loading &&
+	    (session->oval.agents == NULL || session->oval.agents_policy != policy)) {
+		if (_xccdf_session_load_oval_agents(session, policy) != 0)
+			return 1;
+	}
+
 	session->xccdf.result = xccdf_policy_evaluate(policy);
 	if (session->xccdf.result == NULL)
 		return 1;
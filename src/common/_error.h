@@ -57,4 +57,19 @@ struct oscap_err_t {
  */
 void __oscap_seterr(const char *file, uint32_t line, const char *func, oscap_errfamily_t family, ...);
 
+struct err_queue;
+
+/**
+ * Take the errors of the calling thread. The errors are no longer
+ * visible to the thread and shall be passed to oscap_err_attach().
+ * @returns the error queue or NULL if there are no errors
+ */
+struct err_queue *oscap_err_detach(void);
+
+/**
+ * Append errors taken from another thread by oscap_err_detach()
+ * to the errors of the calling thread. The queue is disposed.
+ */
+void oscap_err_attach(struct err_queue *q);
+
 #endif				/* _OSCAP_ERROR_H */
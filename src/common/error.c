@@ -133,6 +133,40 @@ void oscap_clearerr(void)
 	err_queue_free(q, (oscap_destruct_func) oscap_err_free);
 }
 
+struct err_queue *oscap_err_detach(void)
+{
+	struct err_queue *q;
+
+	(void)pthread_once(&__once, oscap_errkey_init);
+
+	q = pthread_getspecific(__key);
+	(void)pthread_setspecific(__key, NULL);
+
+	if (q != NULL && err_queue_is_empty(q)) {
+		err_queue_free(q, NULL);
+		q = NULL;
+	}
+
+	return (q);
+}
+
+void oscap_err_attach(struct err_queue *q)
+{
+	struct oscap_err_t *err;
+
+	if (q == NULL)
+		return;
+
+	(void)pthread_once(&__once, oscap_errkey_init);
+
+	while (!err_queue_is_empty(q)) {
+		err = err_queue_pop_first(q);
+		_push_err(err);
+	}
+
+	err_queue_free(q, NULL);
+}
+
 bool oscap_err(void)
 {
 	(void)pthread_once(&__once, oscap_errkey_init);
@@ -48,6 +48,7 @@
 #include "source/schematron_priv.h"
 #include "source/validate_priv.h"
 #include "source/xslt_priv.h"
+#include "OVAL/results/oval_regex_cache_impl.h"
 
 #ifndef OSCAP_DEFAULT_SCHEMA_PATH
 const char * const OSCAP_SCHEMA_PATH = "/usr/local/share/openscap/schemas";
@@ -110,6 +111,9 @@ void oscap_init(void)
 void oscap_cleanup(void)
 {
 	oscap_clearerr();
+#if defined USE_REGEX_PCRE
+	oval_regex_cache_free();
+#endif
 	xsltCleanupGlobals();
 	xmlCleanupParser();
 }
@@ -24,9 +24,11 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <libxml/parser.h>
 #include <libxml/xmlreader.h>
 #include <libxml/xmlerror.h>
@@ -441,3 +443,50 @@ int oscap_source_get_raw_memory(struct oscap_source *source, char **buffer, size
 		return 0;
 	}
 }
+
+int oscap_source_get_origin_memory(struct oscap_source *source, char **buffer, size_t *size)
+{
+	struct stat st;
+	size_t len = 0;
+	char *mem;
+	int fd;
+
+	switch (source->origin.type) {
+	case OSCAP_SRC_FROM_USER_MEMORY:
+		mem = malloc(source->origin.memory_size + 1);
+		memcpy(mem, source->origin.memory, source->origin.memory_size);
+		*buffer = mem;
+		*size = source->origin.memory_size;
+		return 0;
+	case OSCAP_SRC_FROM_USER_XML_FILE:
+		break;
+	default:
+		return -1;
+	}
+
+	if ((fd = open(source->origin.filepath, O_RDONLY)) < 0)
+		return -1;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	mem = malloc(st.st_size + 1);
+	while (len < (size_t) st.st_size) {
+		ssize_t n = read(fd, mem + len, st.st_size - len);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0) {
+			free(mem);
+			close(fd);
+			return -1;
+		}
+		len += n;
+	}
+	close(fd);
+
+	*buffer = mem;
+	*size = len;
+	return 0;
+}
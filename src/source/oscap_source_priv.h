@@ -77,6 +77,19 @@ xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source);
  */
 xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source);
 
+/**
+ * Get a copy of the original content of the resource, as it was read from
+ * the file or given in the memory buffer. Unlike oscap_source_get_raw_memory
+ * the content is never serialized from the DOM.
+ * @memberof oscap_source
+ * @param source Resource to get the content of
+ * @param buffer The content, to be freed by the caller
+ * @param size Size of the content
+ * @returns 0 on success, -1 if the resource didn't originate from a file
+ * or memory, or the file can't be read
+ */
+int oscap_source_get_origin_memory(struct oscap_source *source, char **buffer, size_t *size);
+
 OSCAP_HIDDEN_END;
 
 #endif
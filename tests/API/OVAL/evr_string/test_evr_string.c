@@ -0,0 +1,217 @@
+/*
+ * Copyright 2026 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "OVAL/results/oval_cmp_evr_string_impl.h"
+
+/* Test vectors, the versions are those of the rpmvercmp() tests of rpm */
+struct evr_test {
+	const char *a;
+	const char *b;
+	int         result; /* rpmvercmp(a, b) */
+};
+
+static const struct evr_test versions[] = {
+	{ "1.0", "1.0", 0 },
+	{ "1.0", "2.0", -1 },
+	{ "2.0", "1.0", 1 },
+	{ "2.0.1", "2.0.1", 0 },
+	{ "2.0", "2.0.1", -1 },
+	{ "2.0.1", "2.0", 1 },
+	{ "2.0.1a", "2.0.1a", 0 },
+	{ "2.0.1a", "2.0.1", 1 },
+	{ "2.0.1", "2.0.1a", -1 },
+	{ "5.5p1", "5.5p1", 0 },
+	{ "5.5p1", "5.5p2", -1 },
+	{ "5.5p2", "5.5p1", 1 },
+	{ "5.5p10", "5.5p10", 0 },
+	{ "5.5p1", "5.5p10", -1 },
+	{ "5.5p10", "5.5p1", 1 },
+	{ "10xyz", "10.1xyz", -1 },
+	{ "10.1xyz", "10xyz", 1 },
+	{ "xyz10", "xyz10", 0 },
+	{ "xyz10", "xyz10.1", -1 },
+	{ "xyz10.1", "xyz10", 1 },
+	{ "xyz.4", "xyz.4", 0 },
+	{ "xyz.4", "8", -1 },
+	{ "8", "xyz.4", 1 },
+	{ "xyz.4", "2", -1 },
+	{ "2", "xyz.4", 1 },
+	{ "5.5p2", "5.6p1", -1 },
+	{ "5.6p1", "5.5p2", 1 },
+	{ "5.6p1", "6.5p1", -1 },
+	{ "6.5p1", "5.6p1", 1 },
+	{ "6.0.rc1", "6.0", 1 },
+	{ "6.0", "6.0.rc1", -1 },
+	{ "10b2", "10a1", 1 },
+	{ "10a2", "10b2", -1 },
+	{ "1.0aa", "1.0aa", 0 },
+	{ "1.0a", "1.0aa", -1 },
+	{ "1.0aa", "1.0a", 1 },
+	/* leading zeros */
+	{ "10.0001", "10.0001", 0 },
+	{ "10.0001", "10.1", 0 },
+	{ "10.1", "10.0001", 0 },
+	{ "10.0001", "10.0039", -1 },
+	{ "10.0039", "10.0001", 1 },
+	{ "4.999.9", "5.0", -1 },
+	{ "5.0", "4.999.9", 1 },
+	{ "20101121", "20101121", 0 },
+	{ "20101121", "20101122", -1 },
+	{ "20101122", "20101121", 1 },
+	/* separators */
+	{ "2_0", "2_0", 0 },
+	{ "2.0", "2_0", 0 },
+	{ "2_0", "2.0", 0 },
+	{ "a", "a", 0 },
+	{ "a+", "a+", 0 },
+	{ "a+", "a_", 0 },
+	{ "a_", "a+", 0 },
+	{ "+a", "+a", 0 },
+	{ "+a", "_a", 0 },
+	{ "_a", "+a", 0 },
+	{ "+_", "+_", 0 },
+	{ "_+", "+_", 0 },
+	{ "_+", "_", 0 },
+	{ "_", "_+", 0 },
+	{ "+", "_", 0 },
+	{ "_", "+", 0 },
+	/* tilde */
+	{ "1.0~rc1", "1.0~rc1", 0 },
+	{ "1.0~rc1", "1.0", -1 },
+	{ "1.0", "1.0~rc1", 1 },
+	{ "1.0~rc1", "1.0~rc2", -1 },
+	{ "1.0~rc2", "1.0~rc1", 1 },
+	{ "1.0~rc1~git123", "1.0~rc1~git123", 0 },
+	{ "1.0~rc1~git123", "1.0~rc1", -1 },
+	{ "1.0~rc1", "1.0~rc1~git123", 1 },
+	/* caret */
+	{ "1.0^", "1.0^", 0 },
+	{ "1.0^", "1.0", 1 },
+	{ "1.0", "1.0^", -1 },
+	{ "1.0^git1", "1.0^git1", 0 },
+	{ "1.0^git1", "1.0", 1 },
+	{ "1.0", "1.0^git1", -1 },
+	{ "1.0^git1", "1.0^git2", -1 },
+	{ "1.0^git2", "1.0^git1", 1 },
+	{ "1.0^git1", "1.01", -1 },
+	{ "1.01", "1.0^git1", 1 },
+	{ "1.0^20160101", "1.0^20160101", 0 },
+	{ "1.0^20160101", "1.0.1", -1 },
+	{ "1.0.1", "1.0^20160101", 1 },
+	{ "1.0^20160101^git1", "1.0^20160101^git1", 0 },
+	{ "1.0^20160102", "1.0^20160101^git1", 1 },
+	{ "1.0^20160101^git1", "1.0^20160102", -1 },
+	/* tilde and caret */
+	{ "1.0~rc1^git1", "1.0~rc1^git1", 0 },
+	{ "1.0~rc1^git1", "1.0~rc1", 1 },
+	{ "1.0~rc1", "1.0~rc1^git1", -1 },
+	{ "1.0^git1~pre", "1.0^git1~pre", 0 },
+	{ "1.0^git1", "1.0^git1~pre", 1 },
+	{ "1.0^git1~pre", "1.0^git1", -1 },
+};
+
+/* Epoch, version and release */
+static const struct evr_test evrs[] = {
+	{ "0:1.0-1", "0:1.0-1", 0 },
+	{ "1:1.0-1", "0:2.0-1", 1 },
+	{ "0:2.0-1", "1:1.0-1", -1 },
+	{ "2:1.0-1", "10:1.0-1", -1 },
+	{ ":1.0-1", "0:1.0-1", 0 },
+	{ "1.0-1", "1.0-1", 0 },
+	{ "1.0-2", "1.0-10", -1 },
+	{ "1.0-10", "1.0-2", 1 },
+	{ "1.0-1.el7", "1.0-1.el7_2", -1 },
+	{ "1.01-1", "1.1-1", 0 },
+	{ "1.0~rc1-5", "1.0-1", -1 },
+	{ "1.0^git1-1", "1.0-5", 1 },
+	{ "0:0.4.20.1-6", "0:0.4.20-33.el5_5.2", 1 },
+};
+
+static int test_evr_cmp(const struct evr_test *test)
+{
+	struct oval_evr a, b;
+	int result;
+
+	oval_evr_parse(test->a, &a);
+	oval_evr_parse(test->b, &b);
+	result = oval_evr_cmp(&a, &b);
+	oval_evr_clear(&a);
+	oval_evr_clear(&b);
+
+	printf("\t%s\t%s\t%s\t%d\t%d\n", result == test->result ? "PASS" : "FAIL",
+	       test->a, test->b, result, test->result);
+
+	return result == test->result;
+}
+
+/* The operations give the same result as the comparison */
+static int test_evr_string_cmp(const struct evr_test *test)
+{
+	static const struct {
+		oval_operation_t op;
+		int              cmp[3]; /* true for -1, 0, 1 */
+	} ops[] = {
+		{ OVAL_OPERATION_EQUALS,                { 0, 1, 0 } },
+		{ OVAL_OPERATION_NOT_EQUAL,             { 1, 0, 1 } },
+		{ OVAL_OPERATION_GREATER_THAN,          { 0, 0, 1 } },
+		{ OVAL_OPERATION_GREATER_THAN_OR_EQUAL, { 0, 1, 1 } },
+		{ OVAL_OPERATION_LESS_THAN,             { 1, 0, 0 } },
+		{ OVAL_OPERATION_LESS_THAN_OR_EQUAL,    { 1, 1, 0 } },
+	};
+	size_t i;
+	int ret = 1;
+
+	for (i = 0; i < sizeof ops / sizeof ops[0]; ++i) {
+		/* the system value compared with the state value */
+		oval_result_t expected = ops[i].cmp[test->result + 1] ? OVAL_RESULT_TRUE : OVAL_RESULT_FALSE;
+
+		if (oval_evr_string_cmp(test->b, test->a, ops[i].op) != expected) {
+			printf("\tFAIL\t%s\t%s\toperation %d\n", test->a, test->b, ops[i].op);
+			ret = 0;
+		}
+	}
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t i;
+	int retval = 0;
+
+	printf("Result\tA\tB\tResult\tExpected\n");
+	printf("versions:\n");
+	for (i = 0; i < sizeof versions / sizeof versions[0]; ++i) {
+		if (!test_evr_cmp(&versions[i]) || !test_evr_string_cmp(&versions[i]))
+			retval = 1;
+	}
+	printf("evr strings:\n");
+	for (i = 0; i < sizeof evrs / sizeof evrs[0]; ++i) {
+		if (!test_evr_cmp(&evrs[i]) || !test_evr_string_cmp(&evrs[i]))
+			retval = 1;
+	}
+
+	return retval;
+}
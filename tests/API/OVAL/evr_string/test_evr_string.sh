@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# OpenScap Test Suite
+
+. ../../../test_common.sh
+
+# Test cases.
+
+function test_evr_string {
+    ./test_evr_string
+}
+
+# Testing.
+
+test_init "test_evr_string.log"
+test_run "test_evr_string" test_evr_string
+test_exit
@@ -35,6 +35,10 @@ function test_api_oval_directives {
     cmp $srcdir/directives.xml exported-directives.xml
 }
 
+function test_api_oval_adt {
+    ./test_api_oval_adt ${srcdir}/scap-rhel5-oval.xml
+}
+
 # Testing.
 
 test_init "test_api_oval.log"
@@ -43,5 +47,6 @@ test_run "test_api_oval_definition" test_api_oval_definition
 test_run "test_api_oval_syschar" test_api_oval_syschar
 test_run "test_api_oval_results" test_api_oval_results
 test_run "test_api_oval_directives" test_api_oval_directives
+test_run "test_api_oval_adt" test_api_oval_adt
 
 test_exit
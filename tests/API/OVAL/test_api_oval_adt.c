@@ -0,0 +1,214 @@
+/*
+ * test_api_oval_adt.c
+ *
+ * Checks the semantics of the OVAL string map and collection and times them.
+ * With an OVAL definitions file (and optionally system characteristics) the
+ * load and evaluation of that content is timed as well, which is how a
+ * vendor feed is benchmarked:
+ *
+ *   test_api_oval_adt [<oval_definitions.xml> [<system_characteristics.xml>]]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "oval_agent_api.h"
+#include "oscap.h"
+#include "oscap_error.h"
+#include "oscap_source.h"
+#include "adt/oval_collection_impl.h"
+#include "adt/oval_string_map_impl.h"
+
+#define ADT_KEYS 100000
+#define ADT_LOOKUPS 10
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			exit(1); \
+		} \
+	} while (0)
+
+static double _now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _report(const char *what, double start)
+{
+	printf("%-32s %10.3f ms\n", what, (_now() - start) * 1e3);
+}
+
+static void _test_string_map(void)
+{
+	struct oval_string_map *map = oval_string_map_new();
+	struct oval_iterator *it;
+	char key[32];
+	const char *prev = NULL;
+	size_t i, n;
+	double start;
+
+	/* empty map */
+	CHECK(oval_string_map_get_value(map, "oval:x:def:1") == NULL);
+	it = oval_string_map_keys(map);
+	CHECK(!oval_collection_iterator_has_more(it));
+	oval_collection_iterator_free(it);
+
+	start = _now();
+	for (i = 0; i < ADT_KEYS; ++i) {
+		snprintf(key, sizeof key, "oval:x:def:%zu", (i * 7919) % ADT_KEYS);
+		oval_string_map_put_string(map, key, key);
+	}
+	_report("string map insert", start);
+
+	/* an existing key keeps its value */
+	oval_string_map_put_string(map, "oval:x:def:0", "other");
+	CHECK(strcmp(oval_string_map_get_value(map, "oval:x:def:0"), "oval:x:def:0") == 0);
+
+	start = _now();
+	for (n = 0; n < ADT_LOOKUPS; ++n) {
+		for (i = 0; i < ADT_KEYS; ++i) {
+			const char *val;
+
+			snprintf(key, sizeof key, "oval:x:def:%zu", i);
+			val = oval_string_map_get_value(map, key);
+			CHECK(val != NULL && strcmp(val, key) == 0);
+		}
+	}
+	_report("string map lookup", start);
+	CHECK(oval_string_map_get_value(map, "oval:x:def:") == NULL);
+	CHECK(oval_string_map_get_value(map, "oval:x:tst:1") == NULL);
+
+	/* keys come out in descending key order */
+	start = _now();
+	it = oval_string_map_keys(map);
+	for (n = 0; oval_collection_iterator_has_more(it); ++n) {
+		const char *k = oval_collection_iterator_next(it);
+
+		CHECK(prev == NULL || strcmp(prev, k) > 0);
+		prev = k;
+	}
+	oval_collection_iterator_free(it);
+	_report("string map keys", start);
+	CHECK(n == ADT_KEYS);
+
+	start = _now();
+	oval_string_map_free_string(map);
+	_report("string map free", start);
+}
+
+static void _test_collection(void)
+{
+	struct oval_collection *col = oval_collection_new();
+	struct oval_iterator *it;
+	void **array;
+	size_t i, n;
+	double start;
+
+	CHECK(oval_collection_is_empty(col));
+
+	start = _now();
+	for (i = 1; i <= ADT_KEYS; ++i)
+		oval_collection_add(col, (void *) i);
+	_report("collection add", start);
+	CHECK(!oval_collection_is_empty(col));
+
+	/* items are iterated in the order they were added */
+	start = _now();
+	for (n = 0; n < ADT_LOOKUPS; ++n) {
+		it = oval_collection_iterator(col);
+		CHECK(oval_collection_iterator_remaining(it) == ADT_KEYS);
+		for (i = 1; oval_collection_iterator_has_more(it); ++i)
+			CHECK(oval_collection_iterator_next(it) == (void *) i);
+		CHECK(i == ADT_KEYS + 1);
+		CHECK(oval_collection_iterator_next(it) == NULL);
+		oval_collection_iterator_free(it);
+	}
+	_report("collection iterate", start);
+
+	/* while an iterator being filled gives the last added item first */
+	it = oval_collection_iterator_new();
+	oval_collection_iterator_add(it, (void *) 1);
+	oval_collection_iterator_add(it, (void *) 2);
+	CHECK(oval_collection_iterator_next(it) == (void *) 2);
+	CHECK(oval_collection_iterator_next(it) == (void *) 1);
+	CHECK(!oval_collection_iterator_has_more(it));
+	oval_collection_iterator_free(it);
+
+	array = NULL;
+	CHECK(oval_collection_to_array(col, &array, &n) == ADT_KEYS);
+	CHECK(n == ADT_KEYS && array[0] == (void *) 1 && array[n - 1] == (void *) ADT_KEYS);
+	free(array);
+
+	oval_collection_free(col);
+}
+
+static int _bench_content(const char *definitions, const char *syschar)
+{
+	struct oscap_source *source;
+	struct oval_definition_model *def_model;
+	struct oval_syschar_model *sys_models[2] = { NULL, NULL };
+	struct oval_results_model *res_model;
+	double start;
+
+	start = _now();
+	source = oscap_source_new_from_file(definitions);
+	def_model = oval_definition_model_import_source(source);
+	oscap_source_free(source);
+	if (def_model == NULL) {
+		fprintf(stderr, "Failed to import %s: %s\n", definitions, oscap_err_desc());
+		return 1;
+	}
+	_report("definitions import", start);
+
+	if (syschar != NULL) {
+		start = _now();
+		sys_models[0] = oval_syschar_model_new(def_model);
+		source = oscap_source_new_from_file(syschar);
+		if (oval_syschar_model_import_source(sys_models[0], source) < 0) {
+			fprintf(stderr, "Failed to import %s: %s\n", syschar, oscap_err_desc());
+			oscap_source_free(source);
+			oval_syschar_model_free(sys_models[0]);
+			oval_definition_model_free(def_model);
+			return 1;
+		}
+		oscap_source_free(source);
+		_report("system characteristics import", start);
+
+		start = _now();
+		res_model = oval_results_model_new(def_model, sys_models);
+		oval_results_model_eval(res_model);
+		_report("evaluation", start);
+
+		start = _now();
+		oval_results_model_free(res_model);
+		oval_syschar_model_free(sys_models[0]);
+		_report("results free", start);
+	}
+
+	start = _now();
+	oval_definition_model_free(def_model);
+	_report("definitions free", start);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int ret = 0;
+
+	_test_string_map();
+	_test_collection();
+	if (argc > 1)
+		ret = _bench_content(argv[1], argc > 2 ? argv[2] : NULL);
+	oscap_cleanup();
+	return ret;
+}
@@ -0,0 +1,27 @@
+#!/bin/bash
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+result=$(mktemp ${name}.out.XXXXXX)
+stdout=$(mktemp ${name}.stdout.XXXXXX)
+stderr=$(mktemp ${name}.err.XXXXXX)
+echo "Result file: $result"
+
+echo "Evaluating content."
+$OSCAP oval eval --results $result $srcdir/${name}.xml
+$OSCAP oval validate-xml --results $result
+[ "$($XPATH $result 'string(/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:1"]/@result)')" == "true" ]
+assert_exists 64 '/oval_results/results/system/oval_system_characteristics/system_data/*[local-name()="variable_item"][*[local-name()="var_ref"]="oval:x:var:10"]/*[local-name()="value"]'
+assert_exists 16 '/oval_results/results/system/oval_system_characteristics/system_data/*[local-name()="variable_item"][*[local-name()="var_ref"]="oval:x:var:11"]/*[local-name()="value"]'
+
+echo "Evaluating content with a limit on the number of values."
+rm $result
+ret=0
+OSCAP_OVAL_VALUES_MAX=8 $OSCAP oval eval --results $result $srcdir/${name}.xml > $stdout 2> $stderr || ret=$?
+[ $ret == 1 ]
+[ ! -e $result ]
+grep -q "more than 8 values" $stderr
+grep -q "^Definition oval:x:def:1: error$" $stdout
+
+rm $stdout $stderr
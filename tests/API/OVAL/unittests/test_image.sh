@@ -0,0 +1,42 @@
+#!/bin/bash
+
+# Definitions loaded from a binary image have to be evaluated the same way as
+# the parsed ones. The image must not be used once the document changes.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+imgdir=$(mktemp -d ${name}.img.XXXXXX)
+parsed=$(mktemp ${name}.parsed.XXXXXX)
+image=$(mktemp ${name}.image.XXXXXX)
+changed=$(mktemp ${name}.changed.XXXXXX)
+log=$(mktemp ${name}.log.XXXXXX)
+
+function normalize {
+	grep -v "<oval:timestamp>" $1 | sed -E 's/(item_id|item_ref|id)="[0-9]+"/\1="0"/g'
+}
+
+function compare_results {
+	$OSCAP oval build-image --image-dir $imgdir $1
+	[ "$(ls $imgdir | wc -l)" -ge 1 ]
+	$OSCAP oval eval --results $parsed $1
+	: > $log
+	OSCAP_OVAL_IMAGE_DIR=$imgdir $OSCAP oval eval --verbose INFO --verbose-log-file $log --results $image $1
+	grep -q "from the image of input file" $log
+	diff <(normalize $parsed) <(normalize $image)
+}
+
+compare_results $srcdir/test_component_values_max.xml
+compare_results $srcdir/test_object_component_type.oval.xml
+compare_results $srcdir/test_platform_version.xml
+
+# a changed document has another image
+sed 's/<\/oval_definitions>/<!-- changed --><\/oval_definitions>/' $srcdir/test_platform_version.xml > $changed
+: > $log
+OSCAP_OVAL_IMAGE_DIR=$imgdir $OSCAP oval eval --verbose INFO --verbose-log-file $log --results $image $changed
+if grep -q "from the image of input file" $log; then
+	echo "The image of another document was used" >&2
+	exit 1
+fi
+
+rm -rf $imgdir $parsed $image $changed $log
@@ -0,0 +1,76 @@
+#!/bin/bash
+
+# The states are prepared once per test: their values are parsed to the
+# datatype of the entity and the entities are matched to the item entities
+# by name. Check each datatype and operation, entity_check, var_ref with
+# var_check and the check_existence of state entities.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+result=$(mktemp ${name}.out.XXXXXX)
+echo "result file: $result"
+stderr=$(mktemp ${name}.err.XXXXXX)
+echo "stderr file: $stderr"
+
+echo "Analysing syschar content."
+$OSCAP oval analyse --results $result $srcdir/$name.oval.xml $srcdir/$name.syschar.xml 2> $stderr
+grep -q 'Conversion of the string "ten" to an integer' $stderr
+[ "$(grep -c 'OpenSCAP Error' $stderr)" == "1" ]; rm $stderr
+[ -f $result ]
+
+assert_exists 52 '/oval_results/results/system/definitions/definition'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:1"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:2"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:3"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:4"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:5"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:6"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:7"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:8"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:9"][@result="error"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:10"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:11"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:12"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:13"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:14"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:15"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:16"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:17"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:18"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:19"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:20"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:21"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:22"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:23"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:24"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:25"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:26"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:27"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:28"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:29"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:30"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:31"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:32"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:33"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:34"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:35"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:36"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:37"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:38"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:39"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:40"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:41"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:42"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:43"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:44"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:45"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:46"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:47"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:48"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:49"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:50"][@result="false"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:51"][@result="true"]'
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:52"][@result="true"]'
+
+rm $result
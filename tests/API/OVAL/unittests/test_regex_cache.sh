@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Pattern match states which repeat their patterns, with an invalid
+# pattern among them, give the same results with the compiled patterns
+# cached and compiled for every comparison.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+cached=$(mktemp ${name}.cached.XXXXXX)
+uncached=$(mktemp ${name}.uncached.XXXXXX)
+log=$(mktemp ${name}.log.XXXXXX)
+echo "result files: $cached $uncached"
+
+$OSCAP oval analyse --verbose INFO --verbose-log-file $log --results $cached \
+	$srcdir/$name.oval.xml $srcdir/$name.syschar.xml
+grep -q "Regex cache: 4 patterns, [1-9][0-9]* hits" $log
+
+OSCAP_REGEX_CACHE_MAX=0 $OSCAP oval analyse --verbose INFO --verbose-log-file $log --results $uncached \
+	$srcdir/$name.oval.xml $srcdir/$name.syschar.xml
+grep -q "Regex cache: 0 patterns, 0 hits" $log
+
+result=$cached
+for def in 2 3 4 8; do
+	assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:'$def'"][@result="true"]'
+done
+for def in 1 5 7; do
+	assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:'$def'"][@result="false"]'
+done
+assert_exists 1 '/oval_results/results/system/definitions/definition[@definition_id="oval:x:def:6"][@result="error"]'
+
+diff <(grep -v '<oval:timestamp>' $cached) <(grep -v '<oval:timestamp>' $uncached)
+
+rm $cached $uncached $log
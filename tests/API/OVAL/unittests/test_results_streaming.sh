@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# OVAL Results are streamed to the file unless the whole document is needed
+# for the full validation. Both ways have to produce the same document, except
+# for the timestamp and the item ids which differ between the evaluations.
+# The documents are compared line by line in their order and the streamed
+# document is validated.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+dom=$(mktemp ${name}.dom.XXXXXX)
+stream=$(mktemp ${name}.stream.XXXXXX)
+
+function normalize {
+	grep -v "<oval:timestamp>" $1 | sed -E 's/(item_id|item_ref|id)="[0-9]+"/\1="0"/g'
+}
+
+function compare_results {
+	OSCAP_FULL_VALIDATION=1 $OSCAP oval eval "$@" --results $dom $srcdir/test_component_values_max.xml
+	$OSCAP oval eval --skip-valid "$@" --results $stream $srcdir/test_component_values_max.xml
+	$OSCAP oval validate --results $stream
+	diff <(normalize $dom) <(normalize $stream)
+}
+
+compare_results
+compare_results --without-syschar
+compare_results --directives $srcdir/test_directives.xml
+
+# the results replace the file once they are complete, a failed evaluation
+# leaves the file and no temporary file behind
+dir=$(mktemp -d ${name}.dir.XXXXXX)
+echo "previous results" > $dir/results.xml
+chmod 640 $dir/results.xml
+$OSCAP oval eval --skip-valid --results $dir/results.xml $srcdir/test_component_values_max.xml
+[ "$(ls $dir)" == "results.xml" ]
+[ "$(stat -c %a $dir/results.xml)" == "640" ]
+grep -q "</oval_results>" $dir/results.xml
+
+cp $dir/results.xml $dir/previous.xml
+! $OSCAP oval eval --skip-valid --results $dir/results.xml $srcdir/missing.xml
+[ "$(ls $dir)" == "$(printf 'previous.xml\nresults.xml')" ]
+cmp $dir/results.xml $dir/previous.xml
+
+# a symlink and a pipe are written directly
+[ $($OSCAP oval eval --skip-valid --results /dev/stdout $srcdir/test_component_values_max.xml \
+	| grep -c "</oval_results>") == 1 ]
+
+rm -r $dom $stream $dir
@@ -480,6 +480,81 @@ function test_api_strto {
     ./test_api_strto
 }
 
+function test_api_sexp_ID {
+    local ret_val=0;
+    local fp1 fp2;
+
+    # the fingerprints of all the arguments, one per line
+    function fp {
+	./test_api_sexp_ID "$@" | sed -n 's/^FP= //p'
+    }
+
+    # stable within a process and between processes
+    [ "$(fp '(a b)' '(a b)' | sort -u | wc -l)" == 1 ] || ret_val=1
+    fp1=$(fp '(a (b c) 1 -2 3.5)')
+    fp2=$(fp '(a (b c) 1 -2 3.5)')
+    [ -n "$fp1" ] && [ "$fp1" == "$fp2" ] || ret_val=1
+
+    # equal S-exps written differently
+    ARGS=(
+	"( abc  b )" \
+	"(\"abc\" \"b\")" \
+	"(3:abc 1:b)" \
+	"(4|YWJj| b)"
+    )
+
+    fp1=$(fp '(abc b)')
+    for I in "${ARGS[@]}"; do
+	fp2=$(fp "$I")
+	echo "$I: $fp2"
+	[ -n "$fp2" ] && [ "$fp1" == "$fp2" ] || ret_val=1
+    done
+
+    # different S-exps
+    ARGS=(
+	"(a b)" \
+	"(ab)" \
+	"((a) b)" \
+	"(a (b))" \
+	"(b a)" \
+	"ab" \
+	"()" \
+	"(())" \
+	"(() ())" \
+	"(\"\")" \
+	"1" \
+	"(1)" \
+	"\"1\""
+    )
+
+    fp "${ARGS[@]}" > sexp_ID.out
+    cat sexp_ID.out
+    [ "$(wc -l < sexp_ID.out)" == ${#ARGS[@]} ] || ret_val=1
+    [ "$(sort -u sexp_ID.out | wc -l)" == ${#ARGS[@]} ] || ret_val=1
+
+    return $ret_val
+}
+
+function test_api_seap_wire {
+    local ret_val=0;
+
+    ARGS=(
+	"(4[type]3:123)" \
+	"(a (b (c (d))) () 1 -2 3.5)" \
+	"(4|TWFu|4|TWFu|)"
+    )
+
+    # the S-exps must arrive the same in both formats
+    SEAP_WIRE_FORMAT=binary ./test_api_seap_wire "${ARGS[@]}" > wire.binary.out
+    ret_val=$[$ret_val+$?]
+    SEAP_WIRE_FORMAT=text ./test_api_seap_wire "${ARGS[@]}" > wire.text.out
+    ret_val=$[$ret_val+$?]
+    diff wire.text.out wire.binary.out
+    ret_val=$[$ret_val+$?]
+
+    return $ret_val
+}
+
 # Testing.
 
 test_init "test_api_seap.log"
@@ -494,5 +569,7 @@ test_run "test_api_seap_number_expression"    ./test_api_seap_number
 test_run "test_api_seap_string_expression"    ./test_api_seap_string
 test_run "test_api_SEXP_deepcmp"              ./test_api_SEXP_deepcmp
 test_run "test_api_strto"                     ./test_api_strto
+test_run "test_api_sexp_ID"                   test_api_sexp_ID
+test_run "test_api_seap_wire"                 test_api_seap_wire
 
 test_exit
@@ -0,0 +1,235 @@
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <seap.h>
+#include <sexp.h>
+#include <strbuf.h>
+
+/*
+ * Sends S-exps from one SEAP context to another over a pair of pipes and
+ * checks that they arrive unchanged. The wire format is chosen by the
+ * SEAP_WIRE_FORMAT variable like in the library, the transport form of the received S-exps
+ * is printed so that the runs with the text and the binary format can be
+ * compared: the binary format has to deliver what the text format does,
+ * e.g. doubles printed by %g and integral doubles as integers. The
+ * arguments are additional S-exps in the text form.
+ */
+
+static const uint8_t empty_frame[] = { 0xb5, 0x00, 0x00, 0x00, 0x00 };
+
+static char *sexp_text (SEXP_t *s_exp, size_t *len)
+{
+	strbuf_t *sb;
+	char *str;
+
+	sb   = strbuf_new (8);
+	SEXP_sbprintf_t (s_exp, sb);
+	*len = strbuf_length (sb);
+	str  = malloc (*len + 1);
+	strbuf_copy (sb, str, *len);
+	str[*len] = '\0';
+	strbuf_free (sb);
+
+	return (str);
+}
+
+static void print_text (const char *str, size_t len)
+{
+	size_t i;
+
+	printf ("t> ");
+
+	for (i = 0; i < len; ++i) {
+		if (str[i] >= 0x20 && str[i] < 0x7f)
+			putchar (str[i]);
+		else
+			printf ("\\x%02x", (uint8_t)str[i]);
+	}
+
+	printf ("\n");
+}
+
+static SEXP_t *sexp_nested (void)
+{
+	SEXP_t *e, *l1, *l2, *l3, *s, *n;
+
+	e  = SEXP_list_new (NULL);
+	l1 = SEXP_list_new (e, NULL);
+	s  = SEXP_string_newf ("nested");
+	n  = SEXP_number_newi_32 (-42);
+	l2 = SEXP_list_new (l1, s, e, NULL);
+	l3 = SEXP_list_new (l2, n, l1, e, NULL);
+
+	SEXP_vfree (e, l1, l2, s, n, NULL);
+
+	return (l3);
+}
+
+static SEXP_t *sexp_binary_string (void)
+{
+	char   buf[300];
+	size_t i;
+
+	for (i = 0; i < sizeof buf; ++i)
+		buf[i] = (char)(i * 7);
+
+	return (SEXP_string_new (buf, sizeof buf));
+}
+
+static SEXP_t *sexp_typed (void)
+{
+	SEXP_t *n, *s, *l;
+
+	n = SEXP_number_newu_32 (123);
+	s = SEXP_string_newf ("abc");
+	SEXP_datatype_set (n, "int");
+	SEXP_datatype_set (s, "string");
+	l = SEXP_list_new (n, s, NULL);
+	SEXP_datatype_set (l, "item");
+
+	SEXP_vfree (n, s, NULL);
+
+	return (l);
+}
+
+int main (int argc, char *argv[])
+{
+	const double doubles[] = { 0.1, 1.0 / 3.0, -2.5e-300, 1.7976931348623157e308, 2.0, -3.0 };
+	const char *wire;
+	bool binary;
+	int  p1[2], p2[2], i, ret;
+	int  sd_s, sd_r;
+	SEAP_CTX_t *ctx_s, *ctx_r;
+	SEXP_t *cases[32];
+	int     ncases;
+	SEXP_psetup_t *psetup;
+	SEXP_pstate_t *pstate;
+
+	setbuf (stdout, NULL);
+
+	wire   = getenv ("SEAP_WIRE_FORMAT");
+	binary = (wire == NULL || strcmp (wire, "binary") == 0);
+
+	if (pipe (p1) != 0 || pipe (p2) != 0) {
+		perror ("pipe");
+		return (1);
+	}
+
+	ctx_s = SEAP_CTX_new ();
+	sd_s  = SEAP_openfd2 (ctx_s, p2[0], p1[1], binary ? SEAP_OPENFD_WIRE_BINARY : 0);
+
+	if (sd_s < 0) {
+		perror ("SEAP_openfd2");
+		return (1);
+	}
+
+	if (binary) {
+		uint8_t hello[sizeof empty_frame];
+		/*
+		 * The sender offers the binary format by an empty frame
+		 */
+		if (read (p1[0], hello, sizeof hello) != sizeof hello
+		    || memcmp (hello, empty_frame, sizeof hello) != 0)
+		{
+			printf ("no handshake frame\n");
+			return (1);
+		}
+	}
+
+	ctx_r = SEAP_CTX_new ();
+	sd_r  = SEAP_openfd2 (ctx_r, p1[0], p2[1], 0);
+
+	if (sd_r < 0) {
+		perror ("SEAP_openfd2");
+		return (1);
+	}
+
+	ncases = 0;
+	cases[ncases++] = SEXP_string_newf ("abc");
+	cases[ncases++] = SEXP_string_new ("a\0b\n\"c\xff", 7);
+	cases[ncases++] = sexp_binary_string ();
+	cases[ncases++] = SEXP_number_newu_32 (0);
+	cases[ncases++] = SEXP_number_newi_32 (-1);
+	cases[ncases++] = SEXP_number_newi_64 ((int64_t)INT32_MIN - 1);
+	cases[ncases++] = SEXP_number_newu_64 (UINT64_MAX);
+	cases[ncases++] = SEXP_number_newb (true);
+	cases[ncases++] = SEXP_number_newb (false);
+
+	for (i = 0; i < (int)(sizeof doubles / sizeof doubles[0]); ++i)
+		cases[ncases++] = SEXP_number_newf (doubles[i]);
+
+	cases[ncases++] = SEXP_list_new (NULL);
+	cases[ncases++] = sexp_nested ();
+	cases[ncases++] = sexp_typed ();
+
+	psetup = SEXP_psetup_new ();
+
+	for (i = 1; i < argc && ncases < (int)(sizeof cases / sizeof cases[0]); ++i) {
+		pstate = NULL;
+		cases[ncases] = SEXP_parse (psetup, argv[i], strlen (argv[i]), &pstate);
+
+		if (cases[ncases] == NULL || pstate != NULL) {
+			printf ("can't parse: %s\n", argv[i]);
+			return (1);
+		}
+		++ncases;
+	}
+
+	SEXP_psetup_free (psetup);
+
+	ret = 0;
+
+	for (i = 0; i < ncases; ++i) {
+		SEXP_t *recv = NULL;
+		char   *sent_str, *recv_str;
+		size_t  sent_len, recv_len;
+
+		/*
+		 * Empty frames may appear between the S-exps
+		 */
+		if (binary && write (p1[1], empty_frame, sizeof empty_frame) != sizeof empty_frame) {
+			perror ("write");
+			return (1);
+		}
+
+		if (SEAP_sendsexp (ctx_s, sd_s, cases[i]) != 0
+		    || SEAP_recvsexp (ctx_r, sd_r, &recv) != 0 || recv == NULL)
+		{
+			printf ("#%d: not received\n", i);
+			ret = 1;
+			continue;
+		}
+
+		sent_str = sexp_text (cases[i], &sent_len);
+		recv_str = sexp_text (recv, &recv_len);
+
+		print_text (recv_str, recv_len);
+
+		if (sent_len != recv_len || memcmp (sent_str, recv_str, sent_len) != 0) {
+			printf ("#%d: sent ", i);
+			print_text (sent_str, sent_len);
+			ret = 1;
+		}
+
+		free (sent_str);
+		free (recv_str);
+		SEXP_free (recv);
+	}
+
+	for (i = 0; i < ncases; ++i)
+		SEXP_free (cases[i]);
+
+	SEAP_close (ctx_r, sd_r);
+	SEAP_close (ctx_s, sd_s);
+	SEAP_CTX_free (ctx_r);
+	SEAP_CTX_free (ctx_s);
+
+	return (ret);
+}
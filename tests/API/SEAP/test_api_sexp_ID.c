@@ -13,6 +13,8 @@
 
 static int print_sexp (SEXP_t *s_exp)
 {
+        SEXP_FP_t fp;
+
         /*
          * print the S-exp in advanced format
          */
@@ -21,6 +23,9 @@ static int print_sexp (SEXP_t *s_exp)
 
         fprintf(stdout, "ID= 0x%"PRIx64"\n", SEXP_ID_v(s_exp));
 
+        SEXP_ID_fp(s_exp, &fp);
+        fprintf(stdout, "FP= 0x%016"PRIx64"%016"PRIx64"\n", fp.hi, fp.lo);
+
         return (0);
 }
 
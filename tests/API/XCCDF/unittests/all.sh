@@ -58,6 +58,7 @@ test_run "inherit selector for xccdf value" $srcdir/test_inherit_selector.sh
 test_run "incorrect selector for xccdf value" $srcdir/test_xccdf_refine_value_bad.sh
 test_run "test xccdf resolve" $srcdir/test_xccdf_resolve.sh
 test_run "Exported arf results from xccdf without reference to oval" $srcdir/test_xccdf_results_arf_no_oval.sh
+test_run "Load only OVAL definitions of the selected rules" $srcdir/test_xccdf_selective_oval.sh
 test_run "XCCDF Substitute within Title" $srcdir/test_xccdf_sub_title.sh
 test_run "TestResult element should contain test-system attribute" $srcdir/test_xccdf_test_system.sh
 
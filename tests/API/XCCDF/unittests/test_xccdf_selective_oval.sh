@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Only the OVAL definitions referenced by the rules selected in the profile
+# and what they depend on are loaded with --selective-oval.
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+
+result=$name.oval.xml.result.xml
+stdout=$(mktemp -t ${name}.out.XXXXXX)
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+
+for options in "" "--selective-oval"; do
+	$OSCAP xccdf eval --profile xccdf_moc.elpmaxe.www_profile_1 $options --oval-results \
+		$srcdir/${name}.xccdf.xml > $stdout 2> $stderr
+
+	echo "Stdout file = $stdout"
+	echo "Stderr file = $stderr"
+	echo "Result file = $result"
+	[ -f $stderr ]; [ ! -s $stderr ]
+	grep -q '^Rule.*xccdf_moc.elpmaxe.www_rule_1$' $stdout
+	[ "$(grep -c '^Result.*pass$' $stdout)" == 1 ]
+
+	assert_exists 1 '//definitions/definition[@id="oval:x:def:1"]'
+	assert_exists 1 '//definitions/definition[@id="oval:x:def:3"]'
+	assert_exists 1 '//tests/*[@id="oval:x:tst:1"]'
+	assert_exists 1 '//tests/*[@id="oval:x:tst:3"]'
+	assert_exists 1 '//objects/*[@id="oval:x:obj:1"]'
+	assert_exists 1 '//objects/*[@id="oval:x:obj:3"]'
+	assert_exists 1 '//states/*[@id="oval:x:ste:1"]'
+	assert_exists 1 '//variables/*[@id="oval:x:var:1"]'
+	assert_exists 1 '//variables/*[@id="oval:x:var:3"]'
+	assert_exists 1 '//variables/*[@id="oval:x:var:4"]'
+	assert_exists 2 '//results//definition[@result="true"]'
+done
+
+# the definitions nobody selected are not there
+assert_exists 2 '//oval_definitions/definitions/definition'
+assert_exists 0 '//*[@id="oval:x:def:2" or @id="oval:x:tst:2" or @id="oval:x:obj:2" or @id="oval:x:ste:2" or @id="oval:x:var:2"]'
+
+rm $stdout $stderr $result
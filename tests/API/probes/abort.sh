@@ -0,0 +1,24 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Aborts the probes of a session between two evaluations which need the
+# same probe started by the thread scheme. The abort has to cancel the
+# threads of the probe module, so the second evaluation starts it again.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+printf 'key=value\n' > $tmpdir/before
+printf 'key=value\n' > $tmpdir/after
+sed "s;<!--injected-path -->;${tmpdir};" $srcdir/abort.xml > $tmpdir/defs.xml
+
+OSCAP_PROBE_SCHEME=thread ./test_api_probes_abort $tmpdir/defs.xml $tmpdir/thread.log
+[ $(grep -c "started in the library process" $tmpdir/thread.log) == 2 ]
+grep -q "aborting" $tmpdir/thread.log
+
+rm -rf $tmpdir
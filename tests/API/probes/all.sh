@@ -4,5 +4,15 @@
 
 test_init "test_api_probes.log"
 test_run "fts test" $srcdir/fts.sh
+test_run "item cache" $srcdir/icache.sh
+test_run "probe result cache eviction" $srcdir/rcache.sh
+test_run "persistent probe cache" $srcdir/dcache.sh
+test_run "probe schemes" $srcdir/schemes.sh
+test_run "probe abort" $srcdir/abort.sh
+test_run "parallel evaluation" $srcdir/jobs.sh
+test_run "request order" $srcdir/order.sh
+test_run "objects with the same content" $srcdir/cobj.sh
+test_run "fts pattern pruning" $srcdir/fts_pattern.sh
+test_run "local filesystems" $srcdir/fts_local.sh
 test_run "probe api smoke test" ./test_api_probes_smoke
 test_exit
@@ -0,0 +1,52 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Objects which differ only in their id are collected once, both when they
+# are submitted together and when they are queried one by one. Objects with
+# other values of their entities or variables are collected on their own.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+tree=$tmpdir/tree
+mkdir -p $tree/a $tree/b
+touch $tree/a/f1 $tree/a/f2 $tree/b/f4 $tree/b/g5
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/cobj.xml > $tmpdir/defs.xml
+
+function check_shared {
+	local log=$1 result=$2
+
+	# either object of a pair may be collected first
+	grep -Eq "Object 'oval:1:obj:(1' .* 'oval:1:obj:2|2' .* 'oval:1:obj:1)'" $log
+	grep -Eq "Object 'oval:1:obj:(3' .* 'oval:1:obj:4|4' .* 'oval:1:obj:3)'" $log
+	grep -q "2 objects were not collected again" $log
+	[ $(grep -c "has the same content" $log) == 2 ]
+
+	for obj in 1:2 2:2 3:2 4:2 5:1 6:1; do
+		assert_exists ${obj#*:} "//collected_objects/object[@id=\"oval:1:obj:${obj%:*}\"]/reference"
+	done
+	[ $(grep -c '>f4</unix-sys:filename>' $result) == 1 ]
+	[ $(grep -c '>g5</unix-sys:filename>' $result) == 1 ]
+}
+
+# submitted together, the copies wait for the reply to the first object
+$OSCAP oval eval --verbose INFO --verbose-log-file $tmpdir/eval.log \
+	--results $tmpdir/results.xml $tmpdir/defs.xml
+$OSCAP oval validate --results $tmpdir/results.xml
+check_shared $tmpdir/eval.log $tmpdir/results.xml
+for def in 1 2 3 4 5 6; do
+	grep -q "definition_id=\"oval:1:def:$def\"[^>]*result=\"true\"" $tmpdir/results.xml
+done
+
+# queried one by one, the copies get the collected object
+$OSCAP oval collect --verbose INFO --verbose-log-file $tmpdir/collect.log \
+	--syschar $tmpdir/syschar.xml $tmpdir/defs.xml
+check_shared $tmpdir/collect.log $tmpdir/syschar.xml
+
+rm -rf $tmpdir
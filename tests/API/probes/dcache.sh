@@ -0,0 +1,86 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Evaluates objects of a single file with the persistent probe cache. The
+# second run has to use the cached objects, the later ones have to collect
+# them again because the file was touched or changed. A cache directory
+# which others could write to and a symlinked entry aren't used. A cached
+# object which the probe needs for sets is sent to the probe only once.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+tree=$tmpdir/tree
+mkdir -p $tree $tmpdir/cache
+printf 'key=value1\n' > $tree/text
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/dcache.xml > $tmpdir/defs.xml
+
+function cache_hits {
+	grep -c "Probe cache hit" $tmpdir/$1.log || true
+}
+
+function eval_cached {
+	OSCAP_PROBE_CACHE_DIR=${2:-$tmpdir/cache} $OSCAP oval eval --verbose INFO --verbose-log-file $tmpdir/$1.log \
+		--results $tmpdir/$1.xml $tmpdir/defs.xml
+	$OSCAP oval validate --results $tmpdir/$1.xml
+}
+
+eval_cached first
+[ "$(cache_hits first)" == 0 ]
+[ -n "$(ls $tmpdir/cache)" ]
+
+eval_cached second
+[ "$(cache_hits second)" == 2 ]
+grep -q '<ind-sys:subexpression>value1<' $tmpdir/second.xml
+
+touch -d '1 hour ago' $tree/text
+
+eval_cached third
+[ "$(cache_hits third)" == 0 ]
+grep -q '<ind-sys:subexpression>value1<' $tmpdir/third.xml
+
+printf 'key=value2\n' >> $tree/text
+
+eval_cached fourth
+[ "$(cache_hits fourth)" == 0 ]
+grep -q '<ind-sys:subexpression>value2<' $tmpdir/fourth.xml
+grep -q '<unix-sys:size datatype="int">22<' $tmpdir/fourth.xml
+
+eval_cached fifth
+[ "$(cache_hits fifth)" == 2 ]
+
+ln -s cache $tmpdir/link
+eval_cached symlink $tmpdir/link
+[ "$(cache_hits symlink)" == 0 ]
+grep -q "Can't use the probe cache directory" $tmpdir/symlink.log
+
+chmod g+w $tmpdir/cache
+eval_cached writable
+[ "$(cache_hits writable)" == 0 ]
+chmod g-w $tmpdir/cache
+
+mkdir $tmpdir/entries
+for entry in $tmpdir/cache/*; do
+	mv $entry $tmpdir/entries/
+	ln -s $tmpdir/entries/$(basename $entry) $entry
+done
+eval_cached entries
+[ "$(cache_hits entries)" == 0 ]
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/dcache_set.xml > $tmpdir/set.xml
+mkdir $tmpdir/setcache
+for run in set1 set2; do
+	OSCAP_PROBE_CACHE_DIR=$tmpdir/setcache $OSCAP oval eval --verbose INFO --verbose-log-file $tmpdir/$run.log \
+		--results $tmpdir/$run.xml $tmpdir/set.xml
+done
+[ "$(cache_hits set2)" == 1 ]
+[ $(grep -c "wasn't collected by the probe, sending it" $tmpdir/set2.log) == 1 ]
+grep -q 'definition_id="oval:1:def:1"[^>]*result="true"' $tmpdir/set2.xml
+
+rm -rf $tmpdir
@@ -0,0 +1,49 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# A downward walk with recurse_file_system="local" doesn't descend into a
+# filesystem mounted from another host and looks up only the directories
+# which are on another device than their parent. The filesystem is mounted
+# in a user and mount namespace.
+
+set -e -o pipefail
+
+if ! unshare -rm true 2>/dev/null; then
+	echo "Can't create a user and mount namespace."
+	exit 255
+fi
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+tree=$tmpdir/tree
+mkdir -p $tree/a/b/c $tree/r
+touch $tree/f1 $tree/a/f2 $tree/a/b/f3 $tree/a/b/c/f4
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/fts_local.xml > $tmpdir/defs.xml
+
+# the fsname of a NFS export makes the filesystem remote
+unshare -rm /bin/bash -e -c "
+	mount -t tmpfs remote:/export $tree/r
+	mkdir $tree/r/s
+	touch $tree/r/f5 $tree/r/s/f6
+	$OSCAP oval collect --verbose DEVEL --verbose-log-file $tmpdir/collect.log \
+		--syschar $tmpdir/syschar.xml $tmpdir/defs.xml
+"
+
+result=$tmpdir/syschar.xml
+assert_exists 4 '//collected_objects/object[@id="oval:1:obj:1"]/reference'
+assert_exists 6 '//collected_objects/object[@id="oval:1:obj:2"]/reference'
+for file in f5 f6; do
+	[ $(grep -c ">$file</unix-sys:filename>" $result) == 1 ]
+done
+
+grep -q "Looking up the filesystem of '$tree/r'" $tmpdir/collect.log
+for dir in a a/b a/b/c; do
+	[ $(grep -c "Looking up the filesystem of '$tree/$dir'" $tmpdir/collect.log) == 0 ]
+done
+
+rm -rf $tmpdir
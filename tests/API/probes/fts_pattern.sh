@@ -0,0 +1,71 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Compares the entries visited by the pattern match walks of a synthetic
+# tree, see oval_fts_pattern_bench.c.
+
+function gen_tree {
+	echo "Generating tree for traversal" >&2
+
+	mkdir -p $ROOT/d{0..7}/d{0..7}/d{0..7}
+	touch $ROOT/d{0..7}/d{0..7}/{f0,f1} $ROOT/d{0..7}/d{0..7}/d{0..7}/f{0..3}
+	mkdir -p $ROOT/D3/d1/d5 $ROOT/ü/ž $ROOT/日本 $ROOT/q+1 $ROOT/q11
+	touch $ROOT/D3/d1/d5/F1 $ROOT/ü/ž/f0 $ROOT/日本/f0 $ROOT/q+1/f0 $ROOT/q11/f0
+}
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+ROOT=${tmpdir}/ftsroot
+echo "Temp dir: ${tmpdir}."
+gen_tree $ROOT
+
+# the path patterns are anchored by the probes
+PROOT=$(echo "$ROOT" | sed 's/\./\\./g')
+
+./oval_fts_pattern_bench \
+	"^$PROOT/d3/d[0-7]/d5/f1\$" \
+	"^$PROOT/d[1-2]/(d3|d6)/.*" \
+	"^$PROOT/d[0-7]/d2/d[4-7]/f[12]\$" \
+	"^$PROOT/d4/[^/]*/f0\$" \
+	"^$PROOT/.*/d7/f3\$" \
+	"^$PROOT/d5/d\\d/(d1/f2|f1)\$" \
+	"^$PROOT/d[0-7]/d[0-7]\$" \
+	"^$PROOT/d6/d6/"
+
+# caseless matching, quoting, word boundaries, an alternation of the roots
+# and multibyte characters
+./oval_fts_pattern_bench \
+	"^$PROOT/(?i)D3/d[0-7]/D5/F1\$" \
+	"^$PROOT/\\Qq+1\\E/f0\$" \
+	"^$PROOT/d2\\b/d\\d\\b/f1\$" \
+	"^(?:$PROOT/d1/d2|$PROOT/d6|$PROOT/q\\d+)/f[01]\$" \
+	"^$PROOT/[^/]/ž/f0\$" \
+	"^$PROOT/日本/f0\$" \
+	"^$PROOT/(?i)Ü/Ž/f0\$"
+
+# the automaton matches any string for a back reference and the empty
+# string for an assertion, so it may descend further than a partial match
+./oval_fts_pattern_bench -l \
+	"^$PROOT/(d[0-7])/\\1/d2/f0\$" \
+	"^$PROOT/d(?=[1-3])\\d/d(?!4)\\d/f0\$" \
+	"^$PROOT/d1/(?<=d1/)d5/.*f3\$"
+
+# an unanchored pattern, and a pattern too large for the automaton, which
+# oval_fts_pattern_new() doesn't compile and the walk isn't pruned for
+./oval_fts_pattern_bench -r $ROOT \
+	"$PROOT/d5/d5/f[0-3]\$" \
+	"^$PROOT/([^/]{0,63}/){0,63}f0\$" | tee $tmpdir/fallback.out
+[ $(grep -c "automaton  not compiled" $tmpdir/fallback.out) == 1 ]
+
+# a partial match can't tell that the directory name ended, so it descends
+# into all of d0..d7 for the d\d\d branch, the automaton only into d2
+./oval_fts_pattern_bench "^$PROOT/(d\\d\\d|d2/d2)/f[01]\$" | tee $tmpdir/boundary.out
+partial=$(awk '$1 == "partial" && $2 == "visited" { print $3 + 0 }' $tmpdir/boundary.out)
+automaton=$(awk '$1 == "automaton" && $2 == "visited" { print $3 + 0 }' $tmpdir/boundary.out)
+[ "$automaton" -lt "$partial" ]
+
+rm -rf $tmpdir
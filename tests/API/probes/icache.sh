@@ -0,0 +1,53 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Collects objects which share items. The item cache of the probe has to
+# store every item once, spread over its shards, and the collected objects
+# have to refer to the same item for the same file.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+tree=$tmpdir/tree
+mkdir -p $tree
+for i in $(seq 0 299); do
+	touch $(printf "$tree/f%03d" $i)
+done
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/icache.xml > $tmpdir/defs.xml
+
+$OSCAP oval eval --verbose DEVEL --verbose-log-file $tmpdir/icache.log \
+	--results $tmpdir/results.xml $tmpdir/defs.xml
+$OSCAP oval validate --results $tmpdir/results.xml
+
+# the references of a collected object
+function object_refs {
+	sed -n "/<object id=\"oval:1:obj:$1\"/,/<\/object>/p" $tmpdir/results.xml \
+		| grep -o 'item_ref="[0-9]*"' | sort
+}
+
+for obj in 1 2 3; do
+	object_refs $obj > $tmpdir/obj$obj.refs
+done
+
+[ $(wc -l < $tmpdir/obj1.refs) == 300 ]
+[ $(wc -l < $tmpdir/obj2.refs) == 200 ]
+[ $(wc -l < $tmpdir/obj3.refs) == 200 ]
+
+# the items of the other objects are the items of the first one
+[ -z "$(comm -13 $tmpdir/obj1.refs $tmpdir/obj2.refs)" ]
+[ -z "$(comm -13 $tmpdir/obj1.refs $tmpdir/obj3.refs)" ]
+
+# one item per file, each with its own id
+[ $(grep -c '<unix-sys:file_item ' $tmpdir/results.xml) == 300 ]
+[ $(grep -o '<unix-sys:file_item [^>]*id="[0-9]*"' $tmpdir/results.xml | sort -u | wc -l) == 300 ]
+
+grep -q "icache stats: hit=400, miss=300, collision=0" $tmpdir/icache.log
+[ $(grep -o 'shard=[0-9]*' $tmpdir/icache.log | sort -u | wc -l) -gt 1 ]
+
+rm -rf $tmpdir
@@ -0,0 +1,48 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Evaluates definitions which share tests, objects and variables, extend
+# each other or fail by parallel jobs and by a single one and compares the
+# results.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+tree=$tmpdir/tree
+mkdir -p $tree/a $tree/b
+touch $tree/a/f1 $tree/a/f2 $tree/b/f4
+printf 'content\n' > $tree/b/g5
+printf 'key=value1\nother\nkey=value2\n' > $tree/text
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/jobs.xml > $tmpdir/defs.xml
+
+# the item ids and the generator differ between the runs
+function normalize {
+	sed -e 's/ id="[0-9]*"//g' \
+	    -e 's/ item_\(ref\|id\)="[0-9]*"//g' \
+	    -e '/<oval:timestamp>/d' \
+	    -e '/<[a-z_-]*:\?generator>/,/<\/[a-z_-]*:\?generator>/d' \
+	    -e '/<unix-sys:a_time/d' "$1" \
+		| grep -v '^\s*$' | sort
+}
+
+for jobs in 1 4; do
+	OSCAP_OVAL_JOBS=$jobs $OSCAP oval eval --verbose INFO --verbose-log-file $tmpdir/$jobs.log \
+		--results $tmpdir/$jobs.xml $tmpdir/defs.xml
+	$OSCAP oval validate --results $tmpdir/$jobs.xml
+	normalize $tmpdir/$jobs.xml > $tmpdir/$jobs.norm
+done
+
+grep -q "Evaluating 8 definitions in [2-8] groups by [2-4] jobs" $tmpdir/4.log
+diff $tmpdir/1.norm $tmpdir/4.norm
+
+for def in 1:true 2:false 3:true 4:true 5:true 6:error 7:true 8:false; do
+	grep -q "definition_id=\"oval:1:def:${def%:*}\"[^>]*result=\"${def#*:}\"" $tmpdir/4.xml
+done
+
+rm -rf $tmpdir
@@ -0,0 +1,53 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Evaluates definitions whose objects depend on the values of other objects
+# and checks that the objects submitted in the request order are collected
+# the same way as by querying the objects one by one.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+tree=$tmpdir/tree
+mkdir -p $tree/a $tree/b
+touch $tree/a/f1 $tree/a/f2 $tree/b/f4
+printf 'content\n' > $tree/b/g5
+printf 'a\nb\n' > $tree/dirs
+printf 'g5\n' > $tree/exclude
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/order.xml > $tmpdir/defs.xml
+
+# the item ids, the generator and the placement of the syschars differ
+function normalize {
+	sed -n '/<oval_system_characteristics/,/<\/oval_system_characteristics>/p' "$1" \
+		| sed -e 's/ id="[0-9]*"//g' \
+		      -e 's/ item_\(ref\|id\)="[0-9]*"//g' \
+		      -e '/<oval:timestamp>/d' \
+		      -e '/<[a-z_-]*:\?generator>/,/<\/[a-z_-]*:\?generator>/d' \
+		      -e '/<oval_system_characteristics/d' \
+		      -e '/<unix-sys:a_time/d' \
+		| grep -v '^\s*$' | sed 's/^\s*//' | sort
+}
+
+$OSCAP oval eval --verbose INFO --verbose-log-file $tmpdir/eval.log \
+	--results $tmpdir/results.xml $tmpdir/defs.xml
+$OSCAP oval collect --syschar $tmpdir/syschar.xml $tmpdir/defs.xml
+$OSCAP oval validate --results $tmpdir/results.xml
+
+grep -q "Request order: 7 objects, 2 stages" $tmpdir/eval.log
+grep -q "Stage 1, file_object: 2 requests" $tmpdir/eval.log
+
+normalize $tmpdir/results.xml > $tmpdir/results.norm
+normalize $tmpdir/syschar.xml > $tmpdir/syschar.norm
+diff $tmpdir/syschar.norm $tmpdir/results.norm
+
+for def in 1:true 2:true 3:true 4:true 5:true 6:true; do
+	grep -q "definition_id=\"oval:1:def:${def%:*}\"[^>]*result=\"${def#*:}\"" $tmpdir/results.xml
+done
+
+rm -rf $tmpdir
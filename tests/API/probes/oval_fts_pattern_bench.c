@@ -0,0 +1,241 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+/*
+ * Walks a tree for the paths matching a pattern three ways: without pruning,
+ * pruned by a partial match of the pattern on the directories (PCRE_PARTIAL)
+ * and pruned by the path pattern automaton, and prints the number of entries
+ * visited, the number of regex evaluations and the number of matches.
+ *
+ * Fails if the walks don't find the same paths or if the automaton visits
+ * more entries than the partial match.
+ *
+ * The walks start at the fixed prefix of the pattern, or at the root given
+ * by -r for the following patterns. Where no automaton can be compiled for
+ * a pattern, the probes don't prune the walk, so only the walks without it
+ * and by the partial match are done and a root is needed.
+ *
+ * A partial match can't tell that an unanchored pattern matches further
+ * below a directory, so the partial walk isn't compared for those. The
+ * automaton loosens some constructs, back references and assertions, and
+ * may visit more entries for the patterns following -l.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fts.h>
+#include <pcre.h>
+#include "oval_fts_pattern.h"
+
+enum {
+	WALK_FULL,
+	WALK_PARTIAL,
+	WALK_AUTOMATON
+};
+
+static const char *walk_names[] = { "full", "partial", "automaton" };
+
+struct walk_stats {
+	unsigned long visited;
+	unsigned long evaluated;
+	unsigned long matched;
+	uint64_t      digest; /* of the matched paths, independent of the order */
+};
+
+static uint64_t path_digest(const char *path, size_t len)
+{
+	uint64_t h = 14695981039346656037ULL;
+
+	while (len-- > 0) {
+		h ^= (unsigned char)*path++;
+		h *= 1099511628211ULL;
+	}
+
+	return h;
+}
+
+/* the paths below a root like "/" don't repeat its trailing slash */
+static size_t dir_pathlen(const FTSENT *ent)
+{
+	size_t len = ent->fts_pathlen;
+
+	if (len > 0 && ent->fts_path[len - 1] == '/')
+		len--;
+
+	return len;
+}
+
+static int walk(int mode, const char *root, pcre *regex, OVAL_FTS_PATTERN *pat, struct walk_stats *stats)
+{
+	char * const paths[2] = { (char *)root, NULL };
+	FTS *fts;
+	FTSENT *ent;
+
+	memset(stats, 0, sizeof(*stats));
+
+	fts = fts_open(paths, FTS_PHYSICAL | FTS_NOCHDIR, NULL);
+	if (fts == NULL) {
+		perror(root);
+		return -1;
+	}
+
+	while ((ent = fts_read(fts)) != NULL) {
+		int ret, ovec[3];
+
+		if (ent->fts_info == FTS_DP)
+			continue;
+
+		++stats->visited;
+
+		if (mode == WALK_PARTIAL && ent->fts_info == FTS_D) {
+			++stats->evaluated;
+			ret = pcre_exec(regex, NULL, ent->fts_path, ent->fts_pathlen, 0,
+					PCRE_PARTIAL, ovec, 3);
+			if (ret == PCRE_ERROR_NOMATCH) {
+				fts_set(fts, ent, FTS_SKIP);
+				continue;
+			}
+			if (ret == PCRE_ERROR_PARTIAL)
+				continue;
+		} else {
+			if (mode == WALK_AUTOMATON) {
+				size_t len = dir_pathlen(ent);
+				int state;
+
+				if (ent->fts_level == FTS_ROOTLEVEL)
+					state = oval_fts_pattern_step(pat, oval_fts_pattern_start(pat),
+								      ent->fts_path, len);
+				else
+					state = oval_fts_pattern_step(pat, ent->fts_parent->fts_number,
+								      ent->fts_path + dir_pathlen(ent->fts_parent),
+								      len - dir_pathlen(ent->fts_parent));
+				ent->fts_number = state;
+
+				if (ent->fts_info == FTS_D && !oval_fts_pattern_descend(pat, state))
+					fts_set(fts, ent, FTS_SKIP);
+				if (len < (size_t)ent->fts_pathlen)
+					state = oval_fts_pattern_step(pat, state, "/", 1);
+				if (!oval_fts_pattern_match(pat, state))
+					continue;
+			}
+
+			++stats->evaluated;
+			ret = pcre_exec(regex, NULL, ent->fts_path, ent->fts_pathlen, 0, 0, ovec, 3);
+		}
+
+		if (ret >= 0) {
+			++stats->matched;
+			stats->digest += path_digest(ent->fts_path, ent->fts_pathlen);
+		} else if (ret != PCRE_ERROR_NOMATCH) {
+			fprintf(stderr, "pcre_exec() error: %d.\n", ret);
+			fts_close(fts);
+			return -1;
+		}
+	}
+
+	fts_close(fts);
+	return 0;
+}
+
+static int bench(const char *pattern, const char *walk_root, bool loose)
+{
+	struct walk_stats stats[3];
+	OVAL_FTS_PATTERN *pat;
+	pcre *regex;
+	const char *errptr;
+	char *root;
+	int erroffset, mode, last, ret = 0;
+	unsigned long options;
+
+	regex = pcre_compile(pattern, PCRE_UTF8, &errptr, &erroffset, NULL);
+	if (regex == NULL) {
+		fprintf(stderr, "pcre_compile() failed at offset %d: %s.\n", erroffset, errptr);
+		return 1;
+	}
+
+	pat = oval_fts_pattern_new(pattern);
+	if (pat == NULL && walk_root == NULL) {
+		fprintf(stderr, "Can't compile the path pattern '%s'.\n", pattern);
+		pcre_free(regex);
+		return 1;
+	}
+
+	root = walk_root != NULL ? strdup(walk_root) : oval_fts_pattern_prefix(pat);
+	printf("%s (from %s)\n", pattern, root);
+
+	for (mode = WALK_FULL; mode <= WALK_AUTOMATON; ++mode) {
+		if (mode == WALK_AUTOMATON && pat == NULL) {
+			printf("  %-10s not compiled\n", walk_names[mode]);
+			break;
+		}
+		if (walk(mode, root, regex, pat, &stats[mode]) != 0) {
+			ret = 1;
+			goto cleanup;
+		}
+		printf("  %-10s visited %8lu, evaluated %8lu, matched %8lu\n", walk_names[mode],
+		       stats[mode].visited, stats[mode].evaluated, stats[mode].matched);
+	}
+
+	if (pcre_fullinfo(regex, NULL, PCRE_INFO_OPTIONS, &options) != 0)
+		options = 0;
+	if (!(options & PCRE_ANCHORED)) {
+		printf("  %-10s not compared, the pattern isn't anchored\n", walk_names[WALK_PARTIAL]);
+		mode = WALK_AUTOMATON;
+	} else {
+		mode = WALK_PARTIAL;
+	}
+	last = pat != NULL ? WALK_AUTOMATON : WALK_PARTIAL;
+
+	for (; mode <= last; ++mode) {
+		if (stats[mode].matched != stats[WALK_FULL].matched
+		    || stats[mode].digest != stats[WALK_FULL].digest) {
+			printf("  %s walk doesn't match the same paths as the full walk\n", walk_names[mode]);
+			ret = 1;
+		}
+	}
+
+	if (pat != NULL && (options & PCRE_ANCHORED) && !loose
+	    && stats[WALK_AUTOMATON].visited > stats[WALK_PARTIAL].visited) {
+		printf("  automaton walk visits more entries than the partial walk\n");
+		ret = 1;
+	}
+
+cleanup:
+	free(root);
+	oval_fts_pattern_free(pat);
+	pcre_free(regex);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *root = NULL;
+	bool loose = false;
+	int i, ret = 0;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s [-l] [-r <root>] <pattern>...\n", argv[0]);
+		return 2;
+	}
+
+	for (i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			root = argv[++i];
+			continue;
+		}
+		if (strcmp(argv[i], "-l") == 0) {
+			loose = true;
+			continue;
+		}
+		ret |= bench(argv[i], root, loose);
+	}
+
+	return ret;
+}
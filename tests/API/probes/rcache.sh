@@ -0,0 +1,45 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Evaluates a set of objects whose results were evicted from the result
+# cache of the probe. The probe has to collect the objects again and get
+# the same items as with an unlimited cache.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+tree=$tmpdir/tree
+mkdir -p $tree/a $tree/b
+touch $tree/a/f1 $tree/a/f2 $tree/a/g3 $tree/b/f4 $tree/b/f5
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/rcache.xml > $tmpdir/defs.xml
+
+# the items of the set object
+function set_items {
+	sed -n '/<collected_objects>/,/<\/collected_objects>/p' "$1" \
+		| sed -n '/<object id="oval:1:obj:3"/,/<\/object>/p' | grep -c '<reference '
+}
+
+$OSCAP oval eval --results $tmpdir/unlimited.xml $tmpdir/defs.xml
+[ "$(set_items $tmpdir/unlimited.xml)" == 4 ]
+
+# only the last result fits into the cache, a single worker collects the
+# objects in the order they were requested, the set object last
+OSCAP_PROBE_RCACHE_MAX_COUNT=1 OSCAP_PROBE_MAX_THREADS=1 $OSCAP oval eval --verbose DEVEL --verbose-log-file $tmpdir/limited.log \
+	--results $tmpdir/limited.xml $tmpdir/defs.xml
+$OSCAP oval validate --results $tmpdir/limited.xml
+
+grep -q "The result was evicted from the cache, collecting the object again" $tmpdir/limited.log
+grep -q "rcache: .*evicted=[1-9]" $tmpdir/limited.log
+
+grep -q 'definition_id="oval:1:def:1"[^>]*result="true"' $tmpdir/limited.xml
+grep -o '<unix-sys:filepath>[^<]*' $tmpdir/unlimited.xml | sort > $tmpdir/unlimited.paths
+grep -o '<unix-sys:filepath>[^<]*' $tmpdir/limited.xml | sort | diff $tmpdir/unlimited.paths -
+[ "$(set_items $tmpdir/limited.xml)" == 4 ]
+
+rm -rf $tmpdir
@@ -0,0 +1,72 @@
+#!/bin/bash
+#
+# Copyright 2026 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Evaluates the same content with the probes started by the pipe, shm and
+# thread schemes, and by the pipe scheme with the text wire format, and
+# compares the results. The thread scheme has to load the probe modules
+# and start the probes without a module by a pipe. The results must not
+# change when the probes are limited to one worker thread.
+
+set -e -o pipefail
+
+name=$(basename $0 .sh)
+tmpdir=$(mktemp -t -d "${name}.XXXXXX")
+echo "Temp dir: ${tmpdir}."
+
+# the results are written next to the tree, not into it
+tree=$tmpdir/tree
+mkdir -p $tree/a/x $tree/b
+touch $tree/a/f1 $tree/a/f2 $tree/a/x/f3 $tree/b/f4 $tree/b/g5
+printf 'key=value1\nother\nkey=value2\n' > $tree/text
+
+sed "s;<!--injected-path -->;${tree};" $srcdir/schemes.xml > $tmpdir/defs.xml
+
+# the item ids, the generator and the access time of the text file
+# read by the first run differ between the runs
+function normalize {
+	sed -e 's/ id="[0-9]*"//g' \
+	    -e 's/ item_\(ref\|id\)="[0-9]*"//g' \
+	    -e '/<oval:timestamp>/d' \
+	    -e '/<unix-sys:a_time/d' \
+	    -e '/<[a-z_-]*:\?generator>/,/<\/[a-z_-]*:\?generator>/d' "$1" \
+		| grep -v '^\s*$' | sort
+}
+
+for scheme in pipe shm thread; do
+	SEAP_WIRE_FORMAT=binary OSCAP_PROBE_SCHEME=$scheme $OSCAP oval eval --verbose INFO --verbose-log-file $tmpdir/$scheme.log \
+		--results $tmpdir/$scheme.xml $tmpdir/defs.xml
+	$OSCAP oval validate --results $tmpdir/$scheme.xml
+	normalize $tmpdir/$scheme.xml > $tmpdir/$scheme.norm
+done
+
+grep -q 'definition_id="oval:1:def:1"[^>]*result="true"' $tmpdir/pipe.xml
+grep -q 'definition_id="oval:1:def:2"' $tmpdir/pipe.xml
+
+diff $tmpdir/pipe.norm $tmpdir/shm.norm
+diff $tmpdir/pipe.norm $tmpdir/thread.norm
+
+# the same with the text wire format
+SEAP_WIRE_FORMAT=text OSCAP_PROBE_SCHEME=pipe $OSCAP oval eval --verbose INFO \
+	--verbose-log-file $tmpdir/text.log --results $tmpdir/text.xml $tmpdir/defs.xml
+normalize $tmpdir/text.xml > $tmpdir/text.norm
+diff $tmpdir/pipe.norm $tmpdir/text.norm
+grep -q "Using the binary wire format" $tmpdir/pipe.log
+[ $(grep -c "Using the binary wire format" $tmpdir/text.log) == 0 ]
+
+# one worker thread per probe gives the same results
+OSCAP_PROBE_MAX_THREADS=1 OSCAP_PROBE_MAX_CHDEPTH=4 $OSCAP oval eval \
+	--verbose DEVEL --verbose-log-file $tmpdir/serial.log \
+	--results $tmpdir/serial.xml $tmpdir/defs.xml
+normalize $tmpdir/serial.xml > $tmpdir/serial.norm
+diff $tmpdir/pipe.norm $tmpdir/serial.norm
+grep -q "worker pool: max. threads=1, max. chain depth=4" $tmpdir/serial.log
+[ $(grep -c "worker pool: max. threads=64," $tmpdir/serial.log) == 0 ]
+
+# modules where there are some, a pipe for the runlevel probe
+grep -q "Starting probe on URI 'thread://.*/probe_file\.so'" $tmpdir/thread.log
+grep -q "Starting probe on URI 'pipe://.*/probe_runlevel'" $tmpdir/thread.log
+grep -q "Starting probe on URI 'shm://.*/probe_file'" $tmpdir/shm.log
+
+rm -rf $tmpdir
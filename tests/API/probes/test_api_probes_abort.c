@@ -0,0 +1,78 @@
+/*
+ * Evaluates a definition, aborts the probes of the session and evaluates
+ * another definition which needs the same probe. The aborted probe has to
+ * be started again:
+ *
+ *   test_api_probes_abort <oval_definitions.xml> <verbose log>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <oscap.h>
+#include <oscap_debug.h>
+#include <oscap_error.h>
+#include <oscap_source.h>
+#include <oval_agent_api.h>
+
+#define FAIL(ret, ...)                                        \
+        do {                                                  \
+                fprintf (stderr, "FAIL: " __VA_ARGS__);       \
+                exit (ret);                                   \
+        } while (0)
+
+static void eval_true (oval_agent_session_t *sess, const char *id)
+{
+        oval_result_t result;
+
+        if (oval_agent_eval_definition (sess, id) != 0)
+                FAIL(1, "eval %s: %s\n", id, oscap_err_desc ());
+
+        if (oval_agent_get_definition_result (sess, id, &result) != 0)
+                FAIL(1, "result %s: %s\n", id, oscap_err_desc ());
+
+        if (result != OVAL_RESULT_TRUE)
+                FAIL(1, "result %s: %s != true\n", id, oval_result_get_text (result));
+}
+
+int main (int argc, char *argv[])
+{
+        struct oscap_source *source;
+        struct oval_definition_model *model;
+        oval_agent_session_t *sess;
+
+        if (argc != 3) {
+                fprintf (stderr, "Usage: %s <oval_definitions.xml> <verbose log>\n", argv[0]);
+                return (2);
+        }
+
+        oscap_set_verbose ("INFO", argv[2], false);
+
+        source = oscap_source_new_from_file (argv[1]);
+        model  = oval_definition_model_import_source (source);
+        oscap_source_free (source);
+
+        if (model == NULL)
+                FAIL(1, "import: %s\n", oscap_err_desc ());
+
+        sess = oval_agent_new_session (model, "abort");
+
+        if (sess == NULL)
+                FAIL(1, "session: %s\n", oscap_err_desc ());
+
+        eval_true (sess, "oval:1:def:1");
+
+        if (oval_agent_abort_session (sess) != 0)
+                FAIL(1, "abort: %s\n", oscap_err_desc ());
+
+        eval_true (sess, "oval:1:def:2");
+
+        oval_agent_destroy_session (sess);
+        oval_definition_model_free (model);
+        oscap_cleanup ();
+
+        return (0);
+}
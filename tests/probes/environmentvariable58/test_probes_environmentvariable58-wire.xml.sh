@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+
+cat <<EOF
+<?xml version="1.0"?>
+<oval_definitions xmlns:oval-def="http://oval.mitre.org/XMLSchema/oval-definitions-5" xmlns:oval="http://oval.mitre.org/XMLSchema/oval-common-5" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xmlns:ind-def="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5" xsi:schemaLocation="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent independent-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-definitions-5 oval-definitions-schema.xsd http://oval.mitre.org/XMLSchema/oval-common-5 oval-common-schema.xsd">
+
+  <generator>
+    <oval:product_name>environmentvariable58</oval:product_name>
+    <oval:product_version>1.0</oval:product_version>
+    <oval:schema_version>5.9</oval:schema_version>
+    <oval:timestamp>2026-10-17T00:00:00-00:00</oval:timestamp>
+  </generator>
+
+  <!-- the variables used by the library to set up a probe must not be
+       visible in the environment of the probe -->
+  <definitions>
+    <definition class="compliance" version="1" id="oval:1:def:1">  <!-- comment="true" -->
+      <metadata>
+        <title></title>
+        <description></description>
+      </metadata>
+      <criteria operator="AND">
+        <criterion test_ref="oval:1:tst:1"/>
+        <criterion test_ref="oval:1:tst:2"/>
+      </criteria>
+    </definition>
+  </definitions>
+
+  <tests>
+    <environmentvariable58_test version="1" id="oval:1:tst:1" check="all" check_existence="none_exist" comment="true" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+      <object object_ref="oval:1:obj:1"/>
+    </environmentvariable58_test>
+    <environmentvariable_test version="1" id="oval:1:tst:2" check="all" check_existence="none_exist" comment="true" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+      <object object_ref="oval:1:obj:2"/>
+    </environmentvariable_test>
+  </tests>
+
+  <objects>
+    <environmentvariable58_object version="1" id="oval:1:obj:1" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+      <pid datatype="int" xsi:nil="true" />
+      <name operation="pattern match">^(SEAP_|OSCAP_PROBE_FTS_SNAPSHOT_SINCE$)</name>
+    </environmentvariable58_object>
+    <environmentvariable_object version="1" id="oval:1:obj:2" xmlns="http://oval.mitre.org/XMLSchema/oval-definitions-5#independent">
+      <name operation="pattern match">^(SEAP_|OSCAP_PROBE_FTS_SNAPSHOT_SINCE$)</name>
+    </environmentvariable_object>
+  </objects>
+
+</oval_definitions>
+EOF
@@ -42,6 +42,31 @@ function test_probes_environmentvariable58 {
     return $ret_val
 }
 
+# The binary wire format, the shared memory of the shm scheme and the start
+# of the scan for the snapshots of the file probes are passed without the
+# environment of the probe
+function test_probes_environmentvariable58_wire {
+
+    probecheck "environmentvariable58" || return 255
+    probecheck "environmentvariable" || return 255
+
+    local DF="$1.xml"
+    local RF="$1.$2.results.xml"
+    local LF="$1.$2.verbose.log"
+    local SD=$(mktemp -d)
+
+    [ -f $RF ] && rm -f $RF
+
+    bash ${srcdir}/$1.xml.sh > $DF
+
+    env -u SEAP_WIRE_FORMAT OSCAP_PROBE_SCHEME=$2 OSCAP_PROBE_FTS_SNAPSHOT_DIR=$SD $OSCAP oval eval \
+        --verbose INFO --verbose-log-file $LF --results $RF $DF || return 1
+    rm -rf $SD
+
+    grep -q "Using the binary wire format" $LF || return 1
+    verify_results "def" $DF $RF 1
+}
+
 # Testing.
 
 test_init "test_probes_environmentvariable58.log"
@@ -50,5 +75,9 @@ test_run "test_probes_environmentvariable58" test_probes_environmentvariable58 \
     test_probes_environmentvariable58
 test_run "test_probes_environmentvariable58-fail" \
     test_probes_environmentvariable58 test_probes_environmentvariable58-fail
+test_run "test_probes_environmentvariable58-wire" \
+    test_probes_environmentvariable58_wire test_probes_environmentvariable58-wire pipe
+test_run "test_probes_environmentvariable58-wire-shm" \
+    test_probes_environmentvariable58_wire test_probes_environmentvariable58-wire shm
 
 test_exit
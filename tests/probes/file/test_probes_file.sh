@@ -120,6 +120,118 @@ function test_probes_file_invalid_utf8 {
 	return $ret_val
 }
 
+function test_probes_file_parallel {
+
+	probecheck "file" || return 255
+
+	local ret_val=0
+	local DF="$srcdir/test_probes_file_recurse.xml"
+	result="results.xml"
+	files_dir=$(mktemp -d)
+	DF_INJECTED=$(mktemp)
+
+	echo "Files dir:	${files_dir}"
+	echo "Content file:	${DF_INJECTED}"
+
+	# a tree with symlinks to a directory, to a file, to an ancestor
+	# and a dangling one
+	for a in a b c d; do
+		for b in 1 2 3; do
+			mkdir -p "$files_dir/$a/$b/x" "$files_dir/$a/$b/y"
+			touch "$files_dir/$a/$b/f" "$files_dir/$a/$b/x/f" "$files_dir/$a/$b/y/f"
+		done
+	done
+	ln -s ../b "$files_dir/a/to_b"
+	ln -s .. "$files_dir/a/1/loop"
+	ln -s ../f "$files_dir/c/2/x/to_f"
+	ln -s nowhere "$files_dir/d/broken"
+
+	# inject real path to content
+	sed "s;<!--injected-path -->;${files_dir};" "$DF" > $DF_INJECTED
+
+	# the walker threads must find the same files as the reader alone
+	$OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	grep -o '<unix-sys:filepath>[^<]*' $result | sort -u > filepaths.serial
+	[ -s filepaths.serial ] || ret_val=1
+
+	OSCAP_PROBE_FTS_JOBS=4 $OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	$OSCAP oval validate $result || ret_val=1
+	assert_exists 1 '//results//definition[@result="true"]' || ret_val=1
+	grep -o '<unix-sys:filepath>[^<]*' $result | sort -u | diff filepaths.serial - || ret_val=1
+
+	OSCAP_PROBE_FTS_JOBS=4 OSCAP_PROBE_FTS_UNORDERED=1 $OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	assert_exists 1 '//results//definition[@result="true"]' || ret_val=1
+	grep -o '<unix-sys:filepath>[^<]*' $result | sort -u | diff filepaths.serial - || ret_val=1
+
+	rm filepaths.serial
+	rm $DF_INJECTED
+	rm -rf "$files_dir"
+
+	return $ret_val
+}
+
+function test_probes_file_snapshot {
+
+	probecheck "file" || return 255
+
+	local ret_val=0
+	local DF="$srcdir/test_probes_file_recurse.xml"
+	result="results.xml"
+	files_dir=$(mktemp -d)
+	snapshot_dir=$(mktemp -d)
+	DF_INJECTED=$(mktemp)
+
+	echo "Files dir:	${files_dir}"
+	echo "Snapshot dir:	${snapshot_dir}"
+	echo "Content file:	${DF_INJECTED}"
+
+	for a in a b c; do
+		for b in 1 2 3; do
+			mkdir -p "$files_dir/$a/$b/x"
+			touch "$files_dir/$a/$b/f" "$files_dir/$a/$b/x/f"
+		done
+	done
+	ln -s ../b "$files_dir/a/to_b"
+	ln -s .. "$files_dir/a/1/loop"
+	ln -s nowhere "$files_dir/c/broken"
+
+	sed "s;<!--injected-path -->;${files_dir};" "$DF" > $DF_INJECTED
+
+	$OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	grep -o '<unix-sys:filepath>[^<]*' $result | sort -u > filepaths.live
+	[ -s filepaths.live ] || ret_val=1
+
+	# the walks read the tree from the snapshot taken by the first one
+	OSCAP_PROBE_FTS_SNAPSHOT_DIR="$snapshot_dir" $OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	ls "$snapshot_dir"/*.snap > /dev/null || ret_val=1
+	grep -o '<unix-sys:filepath>[^<]*' $result | sort -u | diff filepaths.live - || ret_val=1
+
+	# a snapshot directory writable by others isn't used
+	chmod 0777 "$snapshot_dir"
+	rm -f "$snapshot_dir"/*
+	OSCAP_PROBE_FTS_SNAPSHOT_DIR="$snapshot_dir" $OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	[ -z "$(ls "$snapshot_dir")" ] || ret_val=1
+	grep -o '<unix-sys:filepath>[^<]*' $result | sort -u | diff filepaths.live - || ret_val=1
+	chmod 0700 "$snapshot_dir"
+
+	# the snapshot taken by an earlier scan is stale, a file added since
+	# then is found
+	touch "$files_dir/b/2/x/g"
+	$OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	grep -o '<unix-sys:filepath>[^<]*' $result | sort -u > filepaths.added
+	grep -q "<unix-sys:filepath>$files_dir/b/2/x/g\$" filepaths.added || ret_val=1
+
+	OSCAP_PROBE_FTS_SNAPSHOT_DIR="$snapshot_dir" OSCAP_PROBE_FTS_SNAPSHOT_VERIFY=1 OSCAP_PROBE_FTS_JOBS=4 \
+		$OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	grep -o '<unix-sys:filepath>[^<]*' $result | sort -u | diff filepaths.added - || ret_val=1
+
+	rm filepaths.live filepaths.added
+	rm $DF_INJECTED
+	rm -rf "$files_dir" "$snapshot_dir"
+
+	return $ret_val
+}
+
 # Testing.
 
 test_init "test_probes_file.log"
@@ -128,5 +240,7 @@ test_run "test_probes_file with verbose mode" test_probes_file verbose
 test_run "test_probes_file" test_probes_file
 test_run "test_probes_file_filenames" test_probes_file_filenames
 test_run "test_probes_file_invalid_utf8" test_probes_file_invalid_utf8
+test_run "test_probes_file_parallel" test_probes_file_parallel
+test_run "test_probes_file_snapshot" test_probes_file_snapshot
 
 test_exit
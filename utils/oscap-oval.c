@@ -46,6 +46,7 @@ static int app_oval_validate(const struct oscap_action *action);
 static int app_oval_xslt(const struct oscap_action *action);
 static int app_oval_list_probes(const struct oscap_action *action);
 static int app_analyse_oval(const struct oscap_action *action);
+static int app_oval_build_image(const struct oscap_action *action);
 
 static bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action);
 static bool getopt_oval_collect(int argc, char **argv, struct oscap_action *action);
@@ -53,6 +54,7 @@ static bool getopt_oval_analyse(int argc, char **argv, struct oscap_action *acti
 static bool getopt_oval_list_probes(int argc, char **argv, struct oscap_action *action);
 static bool getopt_oval_validate(int argc, char **argv, struct oscap_action *action);
 static bool getopt_oval_report(int argc, char **argv, struct oscap_action *action);
+static bool getopt_oval_build_image(int argc, char **argv, struct oscap_action *action);
 
 
 static bool valid_inputs(const struct oscap_action *action);
@@ -118,6 +120,8 @@ static struct oscap_module OVAL_EVAL = {
         "   --oval-id <id> \r\t\t\t\t - ID of the OVAL component ref in the datastream to use.\n"
         "                  \r\t\t\t\t   (only applicable for source datastreams)\n"
 	"   --probe-root <dir>\r\t\t\t\t - Change the root directory before scanning the system.\n"
+	"   --jobs <n>\r\t\t\t\t - Evaluate independent definitions by n parallel jobs.\n"
+	"             \r\t\t\t\t   (0 means one job per CPU, the default is 1)\n"
 	"   --verbose <verbosity_level>\r\t\t\t\t - Turn on verbose mode at specified verbosity level.\n"
 	"   --verbose-log-file <file>\r\t\t\t\t - Write verbose information into file.\n",
     .opt_parser = getopt_oval_eval,
@@ -191,6 +195,22 @@ static struct oscap_module OVAL_LIST_PROBES = {
     .func = app_oval_list_probes
 };
 
+static struct oscap_module OVAL_BUILD_IMAGE = {
+    .name = "build-image",
+    .parent = &OSCAP_OVAL_MODULE,
+    .summary = "Build the binary image of OVAL Definitions",
+    .usage = "[options] oval-definitions.xml",
+    .help =
+        "Options:\n"
+        "   --image-dir <dir>\r\t\t\t\t - Store the image into directory.\n"
+        "                    \r\t\t\t\t   (the default is $OSCAP_OVAL_IMAGE_DIR)\n"
+        "   --skip-valid\r\t\t\t\t - Skip validation.\n"
+	"   --verbose <verbosity_level>\r\t\t\t\t - Turn on verbose mode at specified verbosity level.\n"
+	"   --verbose-log-file <file>\r\t\t\t\t - Write verbose information into file.\n",
+    .opt_parser = getopt_oval_build_image,
+    .func = app_oval_build_image
+};
+
 static struct oscap_module* OVAL_GEN_SUBMODULES[] = {
     &OVAL_REPORT,
     NULL
@@ -203,6 +223,7 @@ static struct oscap_module* OVAL_SUBMODULES[] = {
     &OVAL_VALIDATE_XML,
     &OVAL_GENERATE,
     &OVAL_LIST_PROBES,
+    &OVAL_BUILD_IMAGE,
     NULL
 };
 
@@ -371,6 +392,8 @@ int app_evaluate_oval(const struct oscap_action *action)
 	oval_session_set_variables(session, action->f_variables);
 
 	oval_session_set_remote_resources(session, action->remote_resources, download_reporting_callback);
+	if (action->jobs >= 0)
+		oval_session_set_jobs(session, action->jobs);
 	/* load all necesary OVAL Definitions and bind OVAL Variables if provided */
 	if ((oval_session_load(session)) != 0)
 		goto cleanup;
@@ -403,6 +426,38 @@ cleanup:
 	return ret;
 }
 
+static int app_oval_build_image(const struct oscap_action *action)
+{
+	struct oval_session *session = NULL;
+	int ret = OSCAP_ERROR;
+
+	/* Turn on verbosity */
+	if (!oscap_set_verbose(action->verbosity_level, action->f_verbose_log, false)) {
+		goto cleanup;
+	}
+
+	if ((session = oval_session_new(action->f_oval)) == NULL) {
+		oscap_print_error();
+		return ret;
+	}
+
+	oval_session_set_validation(session, action->validate, getenv("OSCAP_FULL_VALIDATION"));
+	oval_session_set_xml_reporter(session, reporter);
+
+	if (oval_session_load(session) != 0)
+		goto cleanup;
+
+	if (oval_session_export_image(session, action->image_dir) != 0)
+		goto cleanup;
+
+	ret = OSCAP_OK;
+
+cleanup:
+	oscap_print_error();
+	oval_session_free(session);
+	return ret;
+}
+
 static int app_analyse_oval(const struct oscap_action *action) {
 	struct oval_definition_model	*def_model = NULL;
 	struct oval_syschar_model	*sys_model = NULL;
@@ -545,13 +600,16 @@ enum oval_opt {
     OVAL_OPT_OUTPUT = 'o',
 	OVAL_OPT_PROBE_ROOT,
 	OVAL_OPT_VERBOSE,
-	OVAL_OPT_VERBOSE_LOG_FILE
+	OVAL_OPT_VERBOSE_LOG_FILE,
+	OVAL_OPT_JOBS,
+	OVAL_OPT_IMAGE_DIR
 };
 
 bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action)
 {
 	action->doctype = OSCAP_DOCUMENT_OVAL_DEFINITIONS;
 	action->probe_root = NULL;
+	action->jobs = -1;
 
 	/* Command-options */
 	struct option long_options[] = {
@@ -565,6 +623,7 @@ bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action)
 		{ "oval-id",    required_argument, NULL, OVAL_OPT_OVAL_ID},
 		{ "skip-valid",	no_argument, &action->validate, 0 },
 		{ "probe-root", required_argument, NULL, OVAL_OPT_PROBE_ROOT},
+		{ "jobs",       required_argument, NULL, OVAL_OPT_JOBS},
 		{ "verbose", required_argument, NULL, OVAL_OPT_VERBOSE },
 		{ "verbose-log-file", required_argument, NULL, OVAL_OPT_VERBOSE_LOG_FILE },
 		{ "fetch-remote-resources", no_argument, &action->remote_resources, 1},
@@ -582,6 +641,10 @@ bool getopt_oval_eval(int argc, char **argv, struct oscap_action *action)
 		case OVAL_OPT_DATASTREAM_ID: action->f_datastream_id = optarg;	break;
 		case OVAL_OPT_OVAL_ID: action->f_oval_id = optarg;	break;
 		case OVAL_OPT_PROBE_ROOT: action->probe_root = optarg; break;
+		case OVAL_OPT_JOBS:
+			if (sscanf(optarg, "%d", &action->jobs) != 1 || action->jobs < 0)
+				return oscap_module_usage(action->module, stderr, "Invalid number of jobs: %s", optarg);
+			break;
 		case OVAL_OPT_VERBOSE:
 			action->verbosity_level = optarg;
 			break;
@@ -701,6 +764,49 @@ bool getopt_oval_analyse(int argc, char **argv, struct oscap_action *action)
 	return true;
 }
 
+bool getopt_oval_build_image(int argc, char **argv, struct oscap_action *action)
+{
+	action->doctype = OSCAP_DOCUMENT_OVAL_DEFINITIONS;
+	action->image_dir = getenv("OSCAP_OVAL_IMAGE_DIR");
+
+	/* Command-options */
+	struct option long_options[] = {
+		{ "image-dir",	required_argument, NULL, OVAL_OPT_IMAGE_DIR },
+		{ "skip-valid",	no_argument, &action->validate, 0 },
+		{ "verbose", required_argument, NULL, OVAL_OPT_VERBOSE },
+		{ "verbose-log-file", required_argument, NULL, OVAL_OPT_VERBOSE_LOG_FILE },
+		{ 0, 0, 0, 0 }
+	};
+
+	int c;
+	while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+		switch (c) {
+		case OVAL_OPT_IMAGE_DIR: action->image_dir = optarg; break;
+		case OVAL_OPT_VERBOSE:
+			action->verbosity_level = optarg;
+			break;
+		case OVAL_OPT_VERBOSE_LOG_FILE:
+			action->f_verbose_log = optarg;
+			break;
+		case 0: break;
+		default: return oscap_module_usage(action->module, stderr, NULL);
+		}
+	}
+	if (!check_verbose_options(action)) {
+		return false;
+	}
+
+	if (action->image_dir == NULL || *action->image_dir == '\0')
+		return oscap_module_usage(action->module, stderr, "Image directory is not specified (--image-dir or OSCAP_OVAL_IMAGE_DIR)!");
+
+	/* We should have Definitions file here */
+	if (optind >= argc)
+		return oscap_module_usage(action->module, stderr, "Definitions file is not specified!");
+	action->f_oval = argv[optind];
+
+	return true;
+}
+
 bool getopt_oval_report(int argc, char **argv, struct oscap_action *action)
 {
 	action->doctype = OSCAP_DOCUMENT_OVAL_DEFINITIONS;
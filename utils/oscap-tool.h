@@ -146,13 +146,16 @@ struct oscap_action {
 	int oval_results;
 	int without_sys_chars;
 	int thin_results;
+	int selective_oval;
 	int remediate;
 	char *sce_template;
 	int check_engine_results;
 	int export_variables;
         int list_dynamic;
 	char *probe_root;
+	char *image_dir;
 	char *verbosity_level;
+	int jobs;
 };
 
 int app_xslt(const char *infile, const char *xsltfile, const char *outfile, const char **params);
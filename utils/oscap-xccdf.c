@@ -152,6 +152,7 @@ static struct oscap_module XCCDF_EVAL = {
         "   --thin-results\r\t\t\t\t - Thin Results provides only minimal amount of information in OVAL/ARF results.\n"
         "                 \r\t\t\t\t   The option --without-syschar is automatically enabled when you use Thin Results.\n"
         "   --without-syschar \r\t\t\t\t - Don't provide system characteristic in OVAL/ARF result files.\n"
+        "   --selective-oval \r\t\t\t\t - Load only the OVAL definitions referenced by the selected rules.\n"
         "   --report <file>\r\t\t\t\t - Write HTML report into file.\n"
         "   --skip-valid \r\t\t\t\t - Skip validation.\n"
 	"   --fetch-remote-resources \r\t\t\t\t - Download remote content referenced by XCCDF.\n"
@@ -468,6 +469,7 @@ int app_evaluate_xccdf(const struct oscap_action *action)
 		xccdf_session_set_thin_results(session, true);
 		xccdf_session_set_without_sys_chars_export(session, true);
 	}
+	xccdf_session_set_oval_selective_loading(session, action->selective_oval);
 	if (xccdf_session_is_sds(session)) {
 		xccdf_session_set_datastream_id(session, action->f_datastream_id);
 		xccdf_session_set_component_id(session, action->f_xccdf_id);
@@ -976,6 +978,7 @@ bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
 		{"schematron",          no_argument, &action->schematron, 1},
 		{"without-syschar",    no_argument, &action->without_sys_chars, 1},
 		{"thin-results",        no_argument, &action->thin_results, 1},
+		{"selective-oval",      no_argument, &action->selective_oval, 1},
 	// end
 		{0, 0, 0, 0}
 	};